@@ -0,0 +1,520 @@
+// CompressionBenchmark.cpp
+//
+// Measures the BC encoder (BlockCompressor) for 1K and 2K images with all mips, each on
+// one thread and with the JobSystem, and the texture cache (TextureCache): 16 PNGs
+// 512x512 cold (decode, mips, compress, store) and warm (map only).
+// Reported are MPix/s (pixels of all levels), PSNR against the original and the
+// memory compared to RGBA8.
+//
+// Checked:
+//   - XXH64 test vectors, the key changes with content and settings
+//   - minimum PSNR per format, BC7 better than BC1/BC3
+//   - solid blocks (BC1 +-2, BC7 +-1), alpha 0/255 exact in BC3
+//   - the result is bit-identical with and without the JobSystem
+//   - cache hits return the same bytes as a fresh encode, second run hits only
+//   - truncated/foreign/modified entries are rejected and replaced
+//   - sizes that are not a multiple of 4 end up in the cache as RGBA8
+//   - several threads fill the same cache without half-written entries
+// On errors exit code 1.
+//
+// Usage: CompressionBenchmark [output directory]  (default: working directory;
+// cbench_src/ and cbench_cache/ are created there and cleared on every start)
+// No window, no D3D11 - build as a console program.
+#include "BlockCompressor.h"
+#include "TextureCache.h"
+#include "JobSystem.h"
+#include "../third_party/stb_image.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static bool g_failed = false;
+
+static void Check(bool condition, const char* what)
+{
+    if (!condition) {
+        printf("  FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static bool WriteFile(const std::string& path, const void* data, size_t size)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+static std::vector<uint8_t> ReadFile(const std::string& path)
+{
+    std::vector<uint8_t> data;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return data;
+    uint8_t buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + read);
+    fclose(file);
+    return data;
+}
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBE(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(uint8_t(value >> shift));
+}
+
+static void PutChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+    PutBE(out, static_cast<uint32_t>(data.size()));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBE(out, Crc32(out.data() + start, out.size() - start));
+}
+
+// RGBA8 PNG with sub filter and uncompressed deflate blocks
+static std::vector<uint8_t> EncodePng(const std::vector<uint8_t>& rgba, int width, int height)
+{
+    std::vector<uint8_t> raw;
+    raw.reserve(size_t(width * 4 + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = rgba.data() + size_t(y) * width * 4;
+        raw.push_back(1);
+        for (int x = 0; x < width * 4; ++x)
+            raw.push_back(uint8_t(row[x] - (x >= 4 ? row[x - 4] : 0)));
+    }
+
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+        const size_t length = (std::min)(raw.size() - offset, size_t(65535));
+        zlib.push_back(offset + length == raw.size() ? 1 : 0);
+        zlib.push_back(uint8_t(length));
+        zlib.push_back(uint8_t(length >> 8));
+        zlib.push_back(uint8_t(~length));
+        zlib.push_back(uint8_t(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t value : raw) {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBE(zlib, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    PutBE(ihdr, width);
+    PutBE(ihdr, height);
+    ihdr.insert(ihdr.end(), { 8, 6, 0, 0, 0 });
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    PutChunk(png, "IHDR", ihdr);
+    PutChunk(png, "IDAT", zlib);
+    PutChunk(png, "IEND", {});
+    return png;
+}
+
+// Smooth color gradients with light noise and hard edges; alpha: smooth gradient
+// with punched-out holes (0) and solid areas (255), otherwise 255
+static std::vector<uint8_t> CreateImage(uint32_t width, uint32_t height, bool alpha, std::mt19937& rng)
+{
+    std::vector<uint8_t> image(size_t(width) * height * 4);
+    std::uniform_int_distribution<int> noise(-4, 4);
+    for (uint32_t y = 0; y < height; ++y)
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* p = &image[(size_t(y) * width + x) * 4];
+            const float u = float(x) / width, v = float(y) / height;
+            const bool checker = ((x / 37) ^ (y / 23)) & 1;
+            p[0] = uint8_t((std::min)(255, (std::max)(0, int(255 * u) + noise(rng))));
+            p[1] = uint8_t((std::min)(255, (std::max)(0, int(128 + 120 * std::sin(u * 20.0f + v * 7.0f)) + noise(rng))));
+            p[2] = checker ? 200 : 40;
+            p[3] = 255;
+            if (alpha) {
+                const int cell = int((x / 64 + y / 64) % 3);
+                p[3] = cell == 0 ? 0 : cell == 1 ? 255 : uint8_t(255 * v);
+            }
+        }
+    return image;
+}
+
+static double Psnr(double squaredError, size_t count)
+{
+    const double mse = squaredError / double(count);
+    return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+// PSNR over RGB and over alpha, level 0 against the original
+static void Measure(const std::vector<uint8_t>& image, const uint8_t* blocks, uint32_t width, uint32_t height,
+    BlockCompressor::Format format, double& rgb, double& alpha)
+{
+    std::vector<uint8_t> decoded(image.size());
+    BlockCompressor::Decompress(blocks, width, height, format, decoded.data());
+    double colorError = 0.0, alphaError = 0.0;
+    for (size_t i = 0; i < image.size(); i += 4) {
+        for (int c = 0; c < 3; ++c)
+            colorError += double(image[i + c] - decoded[i + c]) * (image[i + c] - decoded[i + c]);
+        alphaError += double(image[i + 3] - decoded[i + 3]) * (image[i + 3] - decoded[i + 3]);
+    }
+    rgb = Psnr(colorError, image.size() / 4 * 3);
+    alpha = Psnr(alphaError, image.size() / 4);
+}
+
+// Solid images: largest deviation per channel over many random colors
+static int CheckFlat(BlockCompressor::Format format, std::mt19937& rng)
+{
+    const uint32_t size = 8;
+    std::vector<uint8_t> image(size * size * 4), decoded(image.size());
+    std::vector<uint8_t> blocks(BlockCompressor::CompressedSize(format, size, size));
+    std::uniform_int_distribution<int> value(0, 255);
+    int maxError = 0;
+    for (int run = 0; run < 2000; ++run) {
+        const uint8_t color[4] = { uint8_t(value(rng)), uint8_t(value(rng)), uint8_t(value(rng)),
+            uint8_t(format == BlockCompressor::Format::BC1 ? 255 : value(rng)) };
+        for (size_t i = 0; i < image.size(); ++i)
+            image[i] = color[i % 4];
+        BlockCompressor::Compress(image.data(), size, size, format, blocks.data());
+        BlockCompressor::Decompress(blocks.data(), size, size, format, decoded.data());
+        for (size_t i = 0; i < image.size(); ++i)
+            maxError = (std::max)(maxError, std::abs(image[i] - decoded[i]));
+    }
+    return maxError;
+}
+
+static bool SameBytes(const CookedTexture& a, const CookedTexture& b)
+{
+    if (a.format != b.format || a.width != b.width || a.height != b.height || a.levels.size() != b.levels.size())
+        return false;
+    for (size_t i = 0; i < a.levels.size(); ++i)
+        if (a.levels[i].size != b.levels[i].size || std::memcmp(a.GetLevel(i), b.GetLevel(i), a.levels[i].size) != 0)
+            return false;
+    return true;
+}
+
+static void CheckHash()
+{
+    const char* text = "Nobody inspects the spammish repetition";
+    Check(TextureCache::Hash("", 0) == 0xEF46DB3751D8E999ull &&
+        TextureCache::Hash("abc", 3) == 0x44BC2CF5AD770999ull &&
+        TextureCache::Hash(text, strlen(text)) == 0xFBCEA83C8A378BF1ull, "XXH64 test vectors");
+
+    std::vector<uint8_t> data(1000, 7);
+    MipGenerator::Options options;
+    const uint64_t key = TextureCache::MakeKey(data.data(), data.size(), TextureCompression::BC1, options);
+    Check(key == TextureCache::MakeKey(data.data(), data.size(), TextureCompression::BC1, options), "key not stable");
+    Check(key != TextureCache::MakeKey(data.data(), data.size(), TextureCompression::BC7, options), "key ignores compression");
+    MipGenerator::Options kaiser = options;
+    kaiser.filter = MipGenerator::Filter::Kaiser;
+    Check(key != TextureCache::MakeKey(data.data(), data.size(), TextureCompression::BC1, kaiser), "key ignores mip options");
+    data[999] ^= 1;
+    Check(key != TextureCache::MakeKey(data.data(), data.size(), TextureCompression::BC1, options), "key ignores content");
+}
+
+// Encode all levels; result in blocks (level 0 first)
+static double EncodeChain(const std::vector<uint8_t>& image, uint32_t size, const MipGenerator::MipChain& mips,
+    BlockCompressor::Format format, std::vector<uint8_t>& blocks, JobSystem* jobs)
+{
+    size_t total = BlockCompressor::CompressedSize(format, size, size);
+    for (const MipGenerator::Level& level : mips.levels)
+        total += BlockCompressor::CompressedSize(format, level.width, level.height);
+    blocks.assign(total, 0);
+
+    Clock::time_point t0 = Clock::now();
+    BlockCompressor::Compress(image.data(), size, size, format, blocks.data(), jobs);
+    size_t offset = BlockCompressor::CompressedSize(format, size, size);
+    for (size_t l = 0; l < mips.levels.size(); ++l) {
+        const MipGenerator::Level& level = mips.levels[l];
+        BlockCompressor::Compress(mips.GetLevel(l), level.width, level.height, format, blocks.data() + offset, jobs);
+        offset += BlockCompressor::CompressedSize(format, level.width, level.height);
+    }
+    return Ms(t0, Clock::now());
+}
+
+static void RunEncoder(JobSystem& jobs, std::mt19937& rng)
+{
+    const uint32_t SIZES[] = { 1024, 2048 };
+    const BlockCompressor::Format FORMATS[] = { BlockCompressor::Format::BC1, BlockCompressor::Format::BC3, BlockCompressor::Format::BC7 };
+    const char* NAMES[] = { "BC1", "BC3", "BC7" };
+    const double MIN_PSNR[] = { 34.0, 34.0, 40.0 };
+
+    printf("\n%-5s %-4s | %9s %8s | %9s %8s | %7s %7s %s\n", "size", "fmt", "serial", "MPix/s", "jobs", "MPix/s", "rgb dB", "a dB", "");
+    for (uint32_t size : SIZES) {
+        const std::vector<uint8_t> image = CreateImage(size, size, true, rng);
+        MipGenerator::MipChain mips;
+        MipGenerator::Generate(image.data(), size, size, mips);
+        const double megapixels = (double(size) * size + mips.data.size() / 4) / 1e6;
+
+        double psnr[3] = {};
+        for (int f = 0; f < 3; ++f) {
+            std::vector<uint8_t> serial, parallel;
+            const double serialMs = EncodeChain(image, size, mips, FORMATS[f], serial, nullptr);
+            const double jobsMs = EncodeChain(image, size, mips, FORMATS[f], parallel, &jobs);
+            double alpha = 0.0;
+            Measure(image, serial.data(), size, size, FORMATS[f], psnr[f], alpha);
+
+            const bool mismatch = serial != parallel;
+            char alphaText[16] = "      -";   // BC1: no alpha
+            if (FORMATS[f] != BlockCompressor::Format::BC1)
+                snprintf(alphaText, sizeof(alphaText), "%7.2f", alpha);
+            printf("%4uK  %-4s | %7.1fms %8.1f | %7.1fms %8.1f | %7.2f %s %s\n", size / 1024, NAMES[f],
+                serialMs, megapixels / serialMs * 1000.0, jobsMs, megapixels / jobsMs * 1000.0,
+                psnr[f], alphaText, mismatch ? "  MISMATCH" : "");
+            Check(!mismatch, "serial and parallel encode differ");
+            Check(psnr[f] >= MIN_PSNR[f], "PSNR below minimum");
+        }
+        Check(psnr[2] > psnr[0] && psnr[2] > psnr[1], "BC7 not better than BC1/BC3");
+    }
+}
+
+// Write the source images: 16 x 512x512 (even ones opaque, odd ones with alpha)
+static bool WriteSources(const std::string& dir, std::vector<std::string>& files, std::mt19937& rng)
+{
+    bool written = true;
+    for (int i = 0; i < 16; ++i) {
+        const std::string path = dir + "tex_" + std::to_string(i) + ".png";
+        const std::vector<uint8_t> png = EncodePng(CreateImage(512, 512, i % 2 == 1, rng), 512, 512);
+        written = written && WriteFile(path, png.data(), png.size());
+        files.push_back(path);
+    }
+    return written;
+}
+
+static void RunCache(const std::string& dir, JobSystem& jobs, std::mt19937& rng)
+{
+    std::error_code ec;
+    const std::string sourceDir = dir + "cbench_src/", cacheDir = dir + "cbench_cache";
+    std::filesystem::remove_all(sourceDir, ec);
+    std::filesystem::remove_all(cacheDir, ec);
+    std::filesystem::create_directories(sourceDir, ec);
+
+    std::vector<std::string> files;
+    if (!WriteSources(sourceDir, files, rng)) {
+        Check(false, "cannot write the test images");
+        return;
+    }
+
+    MipGenerator::Options options;
+    std::vector<CookedTexture> cold(files.size());
+
+    // Cold: encode and store everything anew
+    TextureCache cache;
+    cache.SetDirectory(cacheDir);
+    size_t rawBytes = 0, cookedBytes = 0;
+    Clock::time_point t0 = Clock::now();
+    for (size_t i = 0; i < files.size(); ++i)
+        Check(cache.Load(files[i].c_str(), TextureCompression::Auto, options, cold[i], &jobs), "cold load");
+    Clock::time_point t1 = Clock::now();
+    for (size_t i = 0; i < files.size(); ++i) {
+        rawBytes += size_t(512) * 512 * 4 * 4 / 3;
+        cookedBytes += cold[i].GetDataSize();
+        Check(!cold[i].IsMapped() && cold[i].format == (i % 2 == 0 ? TextureFormat::BC1 : TextureFormat::BC3), "auto format");
+    }
+    TextureCacheStats stats = cache.GetStats();
+    Check(stats.misses == files.size() && stats.stored == files.size() && stats.hits == 0, "cold stats");
+
+    // Warm: new instance, hits only, bytes as freshly encoded
+    TextureCache warmCache;
+    warmCache.SetDirectory(cacheDir);
+    std::vector<CookedTexture> warm(files.size());
+    Clock::time_point t2 = Clock::now();
+    for (size_t i = 0; i < files.size(); ++i)
+        Check(warmCache.Load(files[i].c_str(), TextureCompression::Auto, options, warm[i], &jobs), "warm load");
+    Clock::time_point t3 = Clock::now();
+    bool same = true;
+    for (size_t i = 0; i < files.size(); ++i)
+        same = same && warm[i].IsMapped() && SameBytes(cold[i], warm[i]);
+    stats = warmCache.GetStats();
+    Check(same, "cache hit differs from fresh encode");
+    Check(stats.hits == files.size() && stats.misses == 0, "warm run not all hits");
+
+    printf("\n%zu textures 512x512 (Auto: BC1/BC3), %d threads\n", files.size(), int(jobs.GetThreadCount()));
+    printf("  cold: %8.1f ms   warm: %6.1f ms   (%.0fx)   memory: %.1f MB -> %.1f MB (RGBA8 -> BC)\n",
+        Ms(t0, t1), Ms(t2, t3), Ms(t0, t1) / (std::max)(Ms(t2, t3), 1e-3), rawBytes / 1048576.0, cookedBytes / 1048576.0);
+    warm.clear();
+
+    // Broken entries: truncated, foreign key, modified header bit
+    const std::vector<uint8_t> source = ReadFile(files[0]);
+    const uint64_t key = TextureCache::MakeKey(source.data(), source.size(), TextureCompression::Auto, options);
+    const std::string entry = cache.GetPath(key);
+    const std::vector<uint8_t> good = ReadFile(entry);
+    std::vector<std::vector<uint8_t>> broken(3, good);
+    broken[0].resize(good.size() - 100);
+    broken[1][16] ^= 0xFF;                      // Header::key
+    broken[2][offsetof(TextureFile::Header, width)] ^= 0x04;
+    for (size_t b = 0; b < broken.size(); ++b) {
+        TextureCache check;
+        check.SetDirectory(cacheDir);
+        CookedTexture texture;
+        WriteFile(entry, broken[b].data(), broken[b].size());
+        Check(!check.Find(key, texture) && check.GetStats().rejected == 1, "broken entry accepted");
+        Check(check.Load(files[0].c_str(), TextureCompression::Auto, options, texture) && SameBytes(cold[0], texture), "broken entry not replaced");
+        Check(check.Find(key, texture) && SameBytes(cold[0], texture), "replaced entry not found");
+    }
+
+    // Not a multiple of 4: RGBA8 with mips, hits afterwards
+    {
+        const std::string path = sourceDir + "npot.png";
+        const std::vector<uint8_t> png = EncodePng(CreateImage(250, 130, false, rng), 250, 130);
+        WriteFile(path, png.data(), png.size());
+        TextureCache check;
+        check.SetDirectory(cacheDir);
+        CookedTexture first, second;
+        Check(check.Load(path.c_str(), TextureCompression::BC7, options, first) && first.format == TextureFormat::RGBA8 &&
+            first.levels.size() == MipGenerator::CountLevels(250, 130), "non multiple of 4 not stored as RGBA8");
+        Check(check.Load(path.c_str(), TextureCompression::BC7, options, second) && second.IsMapped() && SameBytes(first, second), "RGBA8 entry not hit");
+    }
+
+    // Missing file, not an image, not a directory
+    {
+        const std::string garbage = sourceDir + "garbage.png";
+        WriteFile(garbage, "not an image", 12);
+        TextureCache check;
+        CookedTexture texture;
+        std::string error;
+        Check(!check.Load((sourceDir + "missing.png").c_str(), TextureCompression::Auto, options, texture, nullptr, &error) && !error.empty(), "missing file");
+        Check(!check.Load(garbage.c_str(), TextureCompression::Auto, options, texture), "garbage file");
+        Check(check.Load(files[1].c_str(), TextureCompression::Auto, options, texture) && check.Load(files[1].c_str(), TextureCompression::Auto, options, texture) &&
+            check.GetStats().misses == 3 && check.GetStats().stored == 0, "cache without directory");
+    }
+
+    // Several loader threads, empty cache, all load the same files
+    {
+        const std::string sharedDir = dir + "cbench_cache/shared";
+        TextureCache shared;
+        shared.SetDirectory(sharedDir);
+        bool ok[4] = { true, true, true, true };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t]() {
+                for (size_t i = 0; i < 4; ++i) {
+                    CookedTexture texture;
+                    ok[t] = ok[t] && shared.Load(files[i].c_str(), TextureCompression::BC7, options, texture) &&
+                        texture.format == TextureFormat::BC7;
+                }
+            });
+        for (std::thread& thread : threads)
+            thread.join();
+
+        size_t entries = 0, temporary = 0;
+        for (const auto& item : std::filesystem::directory_iterator(sharedDir, ec)) {
+            entries += item.path().extension() == ".gdxt";
+            temporary += item.path().extension() == ".tmp";
+        }
+        Check(ok[0] && ok[1] && ok[2] && ok[3], "parallel load");
+        Check(entries == 4 && temporary == 0, "parallel store left partial entries");
+        TextureCache check;
+        check.SetDirectory(sharedDir);
+        CookedTexture texture;
+        for (size_t i = 0; i < 4; ++i)
+            Check(check.Load(files[i].c_str(), TextureCompression::BC7, options, texture) && texture.IsMapped(), "parallel entry not hit");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string dir = argc > 1 ? argv[1] : "";
+    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\')
+        dir += '/';
+
+    JobSystem jobs;
+    jobs.Init();
+
+    std::mt19937 rng(1234);
+
+    printf("checks\n");
+    CheckHash();
+    {
+        const int bc1 = CheckFlat(BlockCompressor::Format::BC1, rng);
+        const int bc3 = CheckFlat(BlockCompressor::Format::BC3, rng);
+        const int bc7 = CheckFlat(BlockCompressor::Format::BC7, rng);
+        printf("  flat blocks: max error BC1 %d, BC3 %d, BC7 %d\n", bc1, bc3, bc7);
+        Check(bc1 <= 2 && bc3 <= 2 && bc7 <= 1, "flat block error");
+    }
+    {
+        // Punched out: alpha only 0 or 255, BC3 must hit both values exactly
+        std::vector<uint8_t> image = CreateImage(256, 256, true, rng);
+        for (size_t i = 3; i < image.size(); i += 4)
+            image[i] = image[i] >= 128 ? 255 : 0;
+        std::vector<uint8_t> blocks(BlockCompressor::CompressedSize(BlockCompressor::Format::BC3, 256, 256)), decoded(image.size());
+        BlockCompressor::Compress(image.data(), 256, 256, BlockCompressor::Format::BC3, blocks.data());
+        BlockCompressor::Decompress(blocks.data(), 256, 256, BlockCompressor::Format::BC3, decoded.data());
+        bool exact = true;
+        for (size_t i = 3; i < image.size(); i += 4)
+            exact = exact && image[i] == decoded[i];
+        Check(exact, "BC3 cutout alpha not exact");
+        Check(BlockCompressor::IsOpaque(CreateImage(64, 64, false, rng).data(), 64 * 64) && !BlockCompressor::IsOpaque(image.data(), 256 * 256), "IsOpaque");
+    }
+    {
+        // Small levels (1x3, 2x4, 3x5, 6x9): edge blocks like a 4x4 image with repeated edge pixels
+        bool padded = true;
+        for (uint32_t size : { 1u, 2u, 3u, 6u }) {
+            const uint32_t width = size, height = size + 2 + size / 2;
+            const std::vector<uint8_t> image = CreateImage(width, height, true, rng);
+            for (BlockCompressor::Format format : { BlockCompressor::Format::BC1, BlockCompressor::Format::BC3, BlockCompressor::Format::BC7 }) {
+                std::vector<uint8_t> blocks(BlockCompressor::CompressedSize(format, width, height)), decoded(image.size());
+                BlockCompressor::Compress(image.data(), width, height, format, blocks.data());
+                BlockCompressor::Decompress(blocks.data(), width, height, format, decoded.data());
+
+                // Last block (bottom right) on its own with the edge written out
+                const uint32_t bx = (width - 1) / 4 * 4, by = (height - 1) / 4 * 4;
+                std::vector<uint8_t> block(16 * 4), single(BlockCompressor::BlockBytes(format)), reference(16 * 4);
+                for (uint32_t y = 0; y < 4; ++y)
+                    for (uint32_t x = 0; x < 4; ++x)
+                        std::memcpy(&block[(y * 4 + x) * 4], &image[(size_t((std::min)(by + y, height - 1)) * width + (std::min)(bx + x, width - 1)) * 4], 4);
+                BlockCompressor::Compress(block.data(), 4, 4, format, single.data());
+                BlockCompressor::Decompress(single.data(), 4, 4, format, reference.data());
+                for (uint32_t y = by; y < height; ++y)
+                    for (uint32_t x = bx; x < width; ++x)
+                        padded = padded && std::memcmp(&decoded[(size_t(y) * width + x) * 4], &reference[((y - by) * 4 + x - bx) * 4], 4) == 0;
+            }
+        }
+        Check(padded, "edge blocks not padded like a full block");
+        Check(BlockCompressor::CompressedSize(BlockCompressor::Format::BC1, 1, 1) == 8 &&
+            BlockCompressor::CompressedSize(BlockCompressor::Format::BC7, 6, 9) == 16 * 2 * 3, "compressed size");
+    }
+
+    RunEncoder(jobs, rng);
+    RunCache(dir, jobs, rng);
+
+    jobs.Shutdown();
+
+    if (g_failed) {
+        printf("FAILED: compression or cache checks failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -84,6 +84,9 @@ static void CreateWaveGrid(LPENTITY* mesh,
         }
     }
 
+    // Rewritten every frame: dynamic streams (only changed ranges are uploaded)
+    Engine::SetSurfaceDynamic(surface);
+
     // Build initial buffers once
     Engine::FillBuffer(surface);
 }
@@ -148,6 +151,8 @@ static void UpdateGridRadialWave(LPENTITY mesh,
         }
     }
 
+    // Dynamic surface: AddVertex/VertexNormal have reported the ranges,
+    // positions and normals go up with the next RenderWorld
     Engine::UpdateVertexBuffer(surface);
 }
 
@@ -256,6 +261,15 @@ int main()
         Engine::RenderWorld();
         Engine::Flip();
 
+        // Uploaded vertex bytes once per second
+        frameCount++;
+        double sinceLog = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - lastFPSLog).count();
+        if (sinceLog >= 1.0) {
+            const CullStats& stats = Engine::GetCullStats();
+            Debug::Log("GridWave: ", frameCount, " fps, upload ", stats.uploadBytes / 1024, " KB/frame");
+            frameCount = 0;
+            lastFPSLog = std::chrono::high_resolution_clock::now();
+        }
     }
 
     return Windows::ShutDown();
@@ -0,0 +1,365 @@
+// HeadlessBenchmark.cpp
+//
+// Measures the pure CPU cost of frame submission (shadow pass + main pass)
+// without a GPU. The engine runs on the null backend (Engine::CreateHeadlessEngine),
+// all D3D11 calls end up in the GDXCommandLog.
+//
+// Build as a console program (without main.cpp / WinMain), e.g. on CI machines.
+//
+// Also counts the heap allocations per frame (global operator new).
+// After the warmup RenderWorld must not allocate, otherwise the
+// program exits with code 1. With GDX_RENDER_TRACE only the first
+// frames allocate for the trace output.
+//
+// COLLIDE: all cubes with collision mode BOX, Engine::CollideAll() every frame.
+// Up to 5000 meshes the last frame's result is checked against N² EntityCollision.
+//
+// RAYCAST: lines of sight from the camera to up to 4096 cubes per frame (Engine::RaycastBatch).
+// Every ray ends inside a cube and therefore must hit something.
+//
+// OCCLUSION: a wall (scaled cube, EntityOccluder) in front of the lower half of the
+// grid. The cubes behind it drop out of the main pass, not the shadow pass.
+#define NOMINMAX
+#include "gidx.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <algorithm>
+
+// ==================== ALLOCATION COUNTING ====================
+
+static std::atomic<size_t> g_allocCount{ 0 };
+
+void* operator new(size_t size)
+{
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static void CreateBenchCube(LPENTITY* mesh, MATERIAL* material, bool interleaved, bool quantized);
+
+int main()
+{
+    const int MESH_COUNT = 10000;   // 10k .. 100k
+    const int WARMUP_FRAMES = 5;
+    const int FRAMES = 100;
+    const bool ANIMATE = true;      // false = static scene
+    const bool CULLING = true;      // false = draw all meshes
+    const bool TREE_CULLING = true; // false = test every AABB singly instead of the scene tree
+    const bool INSTANCING = true;   // false = every cube gets its own surface (one draw per mesh)
+    const bool INTERLEAVED = false; // true = packed vertex format (one vertex buffer per draw)
+    const bool QUANTIZED = false;   // true = positions as UNORM16 (8 instead of 12 bytes)
+    const bool COLLIDE = false;     // true = broadphase + OBB pairs per frame
+    const bool RAYCAST = false;     // true = rays against the triangles per frame
+    const bool OCCLUSION = false;   // true = wall as occluder in front of the grid
+    const size_t RAY_COUNT = 4096;
+
+    if (Engine::CreateHeadlessEngine(1280, 720) != 0)
+    {
+        printf("CreateHeadlessEngine failed\n");
+        return -1;
+    }
+
+    Engine::Graphics(1280, 720);
+
+    // For very large scenes only count, do not store every command
+    Engine::GetCommandLog().SetKeepCommands(false);
+    Engine::SetFrustumCulling(CULLING);
+    Engine::SetHierarchicalCulling(TREE_CULLING);
+    Engine::SetInstancing(INSTANCING);
+
+    LPMATERIAL material;
+    Engine::CreateMaterial(&material);
+
+    LPENTITY camera;
+    Engine::CreateCamera(&camera);
+    const DirectX::XMFLOAT3 eye(0.0f, 60.0f, -100.0f);
+    Engine::PositionEntity(camera, eye.x, eye.y, eye.z);
+    Engine::RotateEntity(camera, 20.0f, 0.0f, 0.0f);
+
+    LPENTITY light = nullptr;
+    Engine::CreateLight(&light, D3DLIGHT_DIRECTIONAL);
+    Engine::RotateEntity(light, -90, 0, 0);
+    Engine::SetDirectionalLight(light);
+
+    // ==================== SCENE ====================
+    const int SIDE = std::max(1, static_cast<int>(std::cbrt(static_cast<double>(MESH_COUNT))));
+    const float SPACING = 2.5f;
+
+    std::vector<LPENTITY> cubes;
+    cubes.reserve(MESH_COUNT);
+
+    // Rays from the camera to evenly distributed cubes
+    std::vector<Ray> rays;
+    std::vector<RaycastHit> hits;
+    const int RAY_STEP = std::max(1, static_cast<int>(MESH_COUNT / RAY_COUNT));
+
+    auto startCreate = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < MESH_COUNT; ++i)
+    {
+        LPENTITY cube = nullptr;
+        if (INSTANCING && !cubes.empty())
+            Engine::CopyEntity(&cube, cubes.front());
+        else
+            CreateBenchCube(&cube, material, INTERLEAVED, QUANTIZED);
+
+        int x = i % SIDE;
+        int z = (i / SIDE) % SIDE;
+        int y = i / (SIDE * SIDE);
+        Engine::PositionEntity(cube,
+            (x - SIDE / 2.0f) * SPACING,
+            y * SPACING,
+            (z - SIDE / 2.0f) * SPACING);
+
+        if (COLLIDE)
+            Engine::EntityCollisionMode(cube, COLLISION::BOX);
+
+        if (RAYCAST && i % RAY_STEP == 0 && rays.size() < RAY_COUNT)
+        {
+            Ray ray;
+            ray.origin = eye;
+            ray.direction = DirectX::XMFLOAT3(
+                (x - SIDE / 2.0f) * SPACING - eye.x,
+                y * SPACING - eye.y,
+                (z - SIDE / 2.0f) * SPACING - eye.z);
+            rays.push_back(ray);
+        }
+
+        cubes.push_back(cube);
+    }
+
+    if (OCCLUSION)
+    {
+        // Wider than the grid, half as high, right in front of the first row
+        LPENTITY wall = nullptr;
+        CreateBenchCube(&wall, material, INTERLEAVED, QUANTIZED);
+        Engine::PositionEntity(wall, 0.0f, SIDE * SPACING * 0.25f, -(SIDE / 2.0f) * SPACING - 3.0f);
+        Engine::ScaleEntity(wall, SIDE * SPACING, SIDE * SPACING * 0.25f + 1.0f, 1.0f);
+        Engine::EntityOccluder(wall, true);
+    }
+    Engine::SetOcclusionCulling(OCCLUSION);
+    auto endCreate = std::chrono::high_resolution_clock::now();
+
+    printf("Meshes: %d, creation: %.1f ms\n", MESH_COUNT,
+        std::chrono::duration<double, std::milli>(endCreate - startCreate).count());
+
+    // ==================== FRAMES ====================
+    double totalUpdate = 0.0, totalRender = 0.0, totalCollide = 0.0, totalRaycast = 0.0;
+    size_t rayHits = 0;
+    hits.resize(rays.size());
+    double minFrame = 1e30, maxFrame = 0.0;
+    size_t updateAllocs = 0, renderAllocs = 0;
+
+    for (int frame = 0; frame < WARMUP_FRAMES + FRAMES; ++frame)
+    {
+        Engine::GetCommandLog().Reset();
+
+        const size_t a0 = g_allocCount.load(std::memory_order_relaxed);
+        auto t0 = std::chrono::high_resolution_clock::now();
+
+        if (ANIMATE)
+        {
+            for (auto* cube : cubes)
+                Engine::TurnEntity(cube, 0.5f, 0.75f, 0.25f);
+        }
+
+        Engine::Cls(0, 0, 0);
+        Engine::UpdateWorld();
+
+        auto tc = std::chrono::high_resolution_clock::now();
+        if (COLLIDE)
+            Engine::CollideAll();
+
+        auto tr = std::chrono::high_resolution_clock::now();
+        if (RAYCAST)
+            rayHits = Engine::RaycastBatch(rays.data(), rays.size(), hits.data());
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        const size_t a1 = g_allocCount.load(std::memory_order_relaxed);
+
+        Engine::RenderWorld();
+        Engine::Flip();
+
+        const size_t a2 = g_allocCount.load(std::memory_order_relaxed);
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        if (frame < WARMUP_FRAMES)
+            continue;
+
+        updateAllocs += a1 - a0;
+        renderAllocs += a2 - a1;
+
+        double update = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        totalCollide += std::chrono::duration<double, std::milli>(tr - tc).count();
+        totalRaycast += std::chrono::duration<double, std::milli>(t1 - tr).count();
+        double render = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        totalUpdate += update;
+        totalRender += render;
+        minFrame = std::min(minFrame, update + render);
+        maxFrame = std::max(maxFrame, update + render);
+    }
+
+    printf("Frames: %d\n", FRAMES);
+    printf("  Update (avg): %8.3f ms\n", totalUpdate / FRAMES);
+    printf("  Render (avg): %8.3f ms\n", totalRender / FRAMES);
+    printf("  Frame min/max: %8.3f / %8.3f ms\n", minFrame, maxFrame);
+    printf("  Allocations (per frame): update %.2f, render %.2f\n",
+        double(updateAllocs) / FRAMES, double(renderAllocs) / FRAMES);
+
+    const CullStats& cull = Engine::GetCullStats();
+    printf("Culling %s (%s): main %zu / %zu (transparent %zu), shadow %zu / %zu\n", CULLING ? "on" : "off",
+        TREE_CULLING ? "scene tree" : "brute force",
+        cull.visibleMain, cull.candidates, cull.visibleTransparent, cull.visibleShadow, cull.shadowCandidates);
+    printf("Instancing %s: %zu groups, %zu instances\n", INSTANCING ? "on" : "off",
+        cull.instanceGroups, cull.instances);
+    printf("Triangles: main %zu, shadow %zu (%zu LOD draws)\n",
+        cull.trianglesMain, cull.trianglesShadow, cull.lodDraws);
+    printf("Occlusion %s: %zu occluders (%zu triangles), %zu draws occluded\n", OCCLUSION ? "on" : "off",
+        cull.occluders, cull.occluderTriangles, cull.occluded);
+
+    // One cube plus CopyEntity copies: every visible cube must come out of an instance group
+    const bool instancingFailed = INSTANCING && cull.visibleMain > 0 &&
+        (cull.instanceGroups == 0 || cull.instances == 0);
+
+    bool collisionFailed = false;
+    if (COLLIDE)
+    {
+        const CollisionStats& collision = Engine::GetCollisionStats();
+        printf("Collision: %.3f ms (avg, in Update), %zu colliders, %zu candidates, %zu pairs, %zu sort shifts\n",
+            totalCollide / FRAMES, collision.colliders, collision.candidates, collision.pairs, collision.sortShifts);
+
+        if (MESH_COUNT <= 5000)
+        {
+            size_t bruteForce = 0;
+            for (size_t i = 0; i < cubes.size(); ++i)
+                for (size_t j = i + 1; j < cubes.size(); ++j)
+                    if (Engine::EntityCollision(cubes[i], cubes[j]))
+                        ++bruteForce;
+
+            printf("  brute force: %zu pairs\n", bruteForce);
+            collisionFailed = bruteForce != collision.pairs;
+        }
+    }
+
+    bool raycastFailed = false;
+    if (RAYCAST)
+    {
+        const RaycastStats& raycast = Engine::GetRaycastStats();
+        printf("Raycast: %.3f ms (avg, in Update), %zu rays, %zu hits, %zu mesh tests, %zu packets\n",
+            totalRaycast / FRAMES, raycast.rays, rayHits, raycast.meshTests, raycast.packetTests);
+        raycastFailed = rayHits != rays.size();
+    }
+
+    // Commands of the last frame
+    const GDXCommandLog& log = Engine::GetCommandLog();
+    printf("Commands (last frame): %zu\n", log.GetTotalCount());
+    for (size_t t = 0; t < static_cast<size_t>(GDXCommandType::Count); ++t)
+    {
+        GDXCommandType type = static_cast<GDXCommandType>(t);
+        if (log.GetCount(type) > 0)
+            printf("  %-24s %zu\n", GDXCommandLog::GetCommandName(type), log.GetCount(type));
+    }
+
+    Engine::ReleaseEngine();
+
+    if (instancingFailed)
+    {
+        printf("FAILED: instancing is on but no instance group was drawn\n");
+        return 1;
+    }
+
+    if (collisionFailed)
+    {
+        printf("FAILED: CollideAll and EntityCollision disagree\n");
+        return 1;
+    }
+
+    if (raycastFailed)
+    {
+        printf("FAILED: %zu of %zu rays hit nothing\n", rays.size() - rayHits, rays.size());
+        return 1;
+    }
+
+    if (renderAllocs > 0)
+    {
+        printf("FAILED: RenderWorld allocated %zu times in %d frames\n", renderAllocs, FRAMES);
+        return 1;
+    }
+    return 0;
+}
+
+static void CreateBenchCube(LPENTITY* mesh, MATERIAL* material, bool interleaved, bool quantized)
+{
+    Engine::CreateMesh(mesh, material);
+
+    LPSURFACE surface = nullptr;
+    Engine::CreateSurface(&surface, *mesh);
+    Engine::SetSurfaceInterleaved(surface, interleaved);
+    Engine::SetSurfaceQuantized(surface, quantized);
+
+    const float s = 1.0f;
+    const DirectX::XMFLOAT3 corners[8] = {
+        {-s, -s, -s}, {-s, +s, -s}, {+s, +s, -s}, {+s, -s, -s},
+        {-s, -s, +s}, {-s, +s, +s}, {+s, +s, +s}, {+s, -s, +s}
+    };
+    const int faces[6][4] = {
+        {0, 1, 2, 3}, {4, 7, 6, 5}, {0, 4, 5, 1},
+        {3, 2, 6, 7}, {0, 3, 7, 4}, {1, 5, 6, 2}
+    };
+    const float normals[6][3] = {
+        {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}
+    };
+
+    DirectX::XMFLOAT3 positions[24];
+    DirectX::XMFLOAT3 vertexNormals[24];
+    DirectX::XMFLOAT4 colors[24];
+    unsigned int indices[36];
+
+    for (int f = 0; f < 6; ++f)
+    {
+        for (int v = 0; v < 4; ++v)
+        {
+            positions[f * 4 + v] = corners[faces[f][v]];
+            vertexNormals[f * 4 + v] = DirectX::XMFLOAT3(normals[f][0], normals[f][1], normals[f][2]);
+            colors[f * 4 + v] = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+        }
+        const unsigned int quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i = 0; i < 6; ++i)
+            indices[f * 6 + i] = f * 4 + quad[i];
+    }
+
+    // Bulk: one copy per stream
+    Engine::SetSurfacePositions(surface, positions, 24);
+    Engine::SetSurfaceNormals(surface, vertexNormals, 24);
+    Engine::SetSurfaceColors(surface, colors, 24);
+    Engine::SetSurfaceIndices(surface, indices, 36);
+
+    Engine::FillBuffer(surface);
+}
@@ -0,0 +1,641 @@
+// ImportBenchmark.cpp
+//
+// Measures model import (ModelImporter) with and without the JobSystem:
+//   - OBJ: NxN terrain as quads with v/vt/vn, two materials (MTL), plus a cube
+//     with negative (relative) indices and without normals
+//   - glTF 2.0 in three variants with identical content: .gltf with a base64 buffer,
+//     .gltf with an external .bin (name with spaces), .glb
+//     mesh "parts" with three primitives (indexed/normalized UV+color, without indices,
+//     triangle strip), mesh "grid" (interleaved, 32-bit indices), node hierarchy
+//     with TRS and matrix, one mesh instanced twice
+// Prints MB/s and triangles/s (best of several runs).
+//
+// Checked: vertex/triangle counts, positions and world matrices against the
+// generated data (after conversion to left-handed), winding matching the
+// normals, parallel == serial (also with another block size) bit for bit, all three
+// glTF variants equal, broken files are rejected. On errors exit code 1.
+//
+// Usage: ImportBenchmark [output directory]  (default: working directory)
+// No window, no D3D11 - build as a console program.
+#include "ModelImporter.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace DirectX;
+using namespace ModelImporter;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static bool g_failed = false;
+
+static void Check(bool condition, const char* what)
+{
+    if (!condition) {
+        printf("  CHECK FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static bool WriteFile(const std::string& path, const void* data, size_t size)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+static bool WriteFile(const std::string& path, const std::string& text)
+{
+    return WriteFile(path, text.data(), text.size());
+}
+
+static void Append(std::string& out, const char* format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length > 0)
+        out.append(line, (std::min)(static_cast<size_t>(length), sizeof(line) - 1));
+}
+
+// ==================== OBJ ====================
+
+static float TerrainHeight(int x, int z)
+{
+    return 0.5f * std::sin(x * 0.05f) * std::cos(z * 0.07f);
+}
+
+// Terrain: vertex (x, z) = index z * n + x + 1, quads counterclockwise seen from above
+// (right-handed). Left half "grass", right half "rock", then a cube with relative indices.
+static std::string CreateObj(int n)
+{
+    std::string text;
+    text.reserve(static_cast<size_t>(n) * n * 130);
+    text += "# ImportBenchmark terrain\nmtllib bench.mtl\no terrain\n";
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x)
+            Append(text, "v %.4f %.5f %.4f\n", x * 0.25f, TerrainHeight(x, z), z * 0.25f);
+    }
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x)
+            Append(text, "vt %.5f %.5f\n", x / float(n - 1), z / float(n - 1));
+    }
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x)
+            text += "vn 0 1 0\n";
+    }
+
+    const int half = (n - 1) / 2;
+    for (int part = 0; part < 2; ++part) {
+        text += part == 0 ? "usemtl grass\n" : "usemtl rock\n";
+        for (int z = 0; z + 1 < n; ++z) {
+            for (int x = part == 0 ? 0 : half; x < (part == 0 ? half : n - 1); ++x) {
+                const int a = z * n + x + 1, b = (z + 1) * n + x + 1, c = b + 1, d = a + 1;
+                Append(text, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+            }
+        }
+    }
+
+    // Cube: v lines, then faces with -8..-1 (without vt/vn)
+    text += "o cube\nusemtl rock\n";
+    for (int i = 0; i < 8; ++i)
+        Append(text, "v %d %d %d\n", (i & 1) ? 1 : -1, (i & 2) ? 1 : -1, (i & 4) ? 1 : -1);
+    // Corner i -> relative index i - 8; faces counterclockwise seen from outside
+    const int FACES[6][4] = {
+        { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 2, 3, 1 }, { 4, 5, 7, 6 }
+    };
+    for (const auto& face : FACES)
+        Append(text, "f %d %d %d %d\n", face[0] - 8, face[1] - 8, face[2] - 8, face[3] - 8);
+    return text;
+}
+
+static const char* MTL =
+    "newmtl grass\nKd 0.2 0.6 0.1\nKs 0.1 0.1 0.1\nNs 8\nmap_Kd grass.png\n\n"
+    "newmtl rock\nKd 0.5 0.5 0.5\nd 0.5\n";
+
+static void CheckObj(const Model& model, int n)
+{
+    Check(model.meshes.size() == 2, "obj: two meshes (terrain, cube)");
+    Check(model.materials.size() == 2, "obj: two materials");
+    Check(model.nodes.size() == 2, "obj: one node per mesh");
+    if (g_failed)
+        return;
+
+    const MeshData& terrain = model.meshes[0];
+    const MeshData& cube = model.meshes[1];
+    Check(terrain.name == "terrain" && cube.name == "cube", "obj: mesh names");
+    Check(terrain.primitives.size() == 2 && cube.primitives.size() == 1, "obj: primitives per mesh");
+    if (g_failed)
+        return;
+
+    const MaterialData& grass = model.materials[0];
+    const MaterialData& rock = model.materials[1];
+    Check(grass.name == "grass" && grass.texture.size() >= 9 &&
+        grass.texture.compare(grass.texture.size() - 9, 9, "grass.png") == 0, "obj: map_Kd");
+    Check(std::fabs(grass.diffuse.y - 0.6f) < 1e-6f && grass.shininess == 8.0f, "obj: Kd / Ns");
+    Check(rock.blend && rock.transparency == 0.5f, "obj: d < 1 -> blend");
+
+    // The column at the material boundary belongs to both primitives
+    const int half = (n - 1) / 2;
+    const Primitive& left = terrain.primitives[0];
+    const Primitive& right = terrain.primitives[1];
+    Check(left.material == 0 && right.material == 1 && cube.primitives[0].material == 1, "obj: usemtl");
+    Check(left.positions.size() == static_cast<size_t>(half + 1) * n, "obj: welded vertices (left)");
+    Check(right.positions.size() == static_cast<size_t>(n - half) * n, "obj: welded vertices (right)");
+    Check(model.GetTriangleCount() == static_cast<size_t>(2) * (n - 1) * (n - 1) + 12, "obj: triangle count");
+    Check(left.uv1.size() == left.positions.size() && left.normals.size() == left.positions.size(), "obj: uv/normal streams");
+    Check(cube.primitives[0].positions.size() == 8 && cube.primitives[0].uv1.empty() &&
+        cube.primitives[0].normals.size() == 8, "obj: cube (relative indices, generated normals)");
+
+    // Every vertex lies on the grid: z mirrored, v flipped
+    bool positions = true;
+    for (size_t i = 0; i < left.positions.size(); ++i) {
+        const XMFLOAT3& p = left.positions[i];
+        const int x = static_cast<int>(std::lround(p.x / 0.25f));
+        const int z = static_cast<int>(std::lround(-p.z / 0.25f));
+        const float u = x / float(n - 1), v = 1.0f - z / float(n - 1);
+        positions = positions && x >= 0 && x <= half && z >= 0 && z < n &&
+            std::fabs(p.y - TerrainHeight(x, z)) < 1e-4f &&
+            std::fabs(left.uv1[i].x - u) < 1e-4f && std::fabs(left.uv1[i].y - v) < 1e-4f;
+    }
+    Check(positions, "obj: positions/uvs match the generated terrain (left-handed, v flipped)");
+
+    // Cube normals point outward
+    bool outward = true;
+    const Primitive& box = cube.primitives[0];
+    for (size_t i = 0; i < box.positions.size(); ++i) {
+        const XMFLOAT3& p = box.positions[i];
+        const XMFLOAT3& nrm = box.normals[i];
+        outward = outward && p.x * nrm.x + p.y * nrm.y + p.z * nrm.z > 0.5f;
+    }
+    Check(outward, "obj: generated cube normals point outward");
+}
+
+// ==================== GLTF ====================
+
+struct Blob
+{
+    std::vector<uint8_t> data;
+    std::string views;
+    int viewCount = 0;
+
+    // New bufferView; byteStride only for interleaved data
+    int Add(const void* bytes, size_t size, size_t stride = 0)
+    {
+        while (data.size() % 4)
+            data.push_back(0);
+        const size_t offset = data.size();
+        data.insert(data.end(), static_cast<const uint8_t*>(bytes), static_cast<const uint8_t*>(bytes) + size);
+        if (viewCount)
+            views += ",";
+        Append(views, "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu", offset, size);
+        if (stride)
+            Append(views, ",\"byteStride\":%zu", stride);
+        views += "}";
+        return viewCount++;
+    }
+};
+
+struct GltfSource
+{
+    Blob blob;
+    std::string json;       // without "buffers"
+    int grid = 0;
+};
+
+static void AddAccessor(std::string& accessors, int& count, int view, size_t offset, int componentType,
+    size_t elements, const char* type, bool normalized = false)
+{
+    if (count)
+        accessors += ",";
+    Append(accessors, "{\"bufferView\":%d,\"byteOffset\":%zu,\"componentType\":%d,\"count\":%zu,\"type\":\"%s\"%s}",
+        view, offset, componentType, elements, type, normalized ? ",\"normalized\":true" : "");
+    ++count;
+}
+
+// Quad A/B (xz plane), strip C, grid g x g; winding counterclockwise seen from above
+static GltfSource CreateGltf(int g)
+{
+    GltfSource source;
+    source.grid = g;
+    Blob& blob = source.blob;
+    std::string accessors;
+    int accessorCount = 0;
+
+    // A: indexed, normals, UV as normalized UNSIGNED_SHORT, color as normalized UNSIGNED_BYTE
+    const float quadA[] = { 0, 0, 0,  0, 0, 1,  1, 0, 1,  1, 0, 0 };
+    const float normalsA[] = { 0, 1, 0,  0, 1, 0,  0, 1, 0,  0, 1, 0 };
+    const uint16_t uvA[] = { 0, 0,  0, 65535,  65535, 65535,  65535, 0 };
+    const uint8_t colorA[] = { 255, 0, 0, 255,  0, 255, 0, 255,  0, 0, 255, 255,  128, 128, 128, 255 };
+    const uint16_t indicesA[] = { 0, 1, 2,  0, 2, 3 };
+    AddAccessor(accessors, accessorCount, blob.Add(quadA, sizeof(quadA)), 0, 5126, 4, "VEC3");       // 0
+    AddAccessor(accessors, accessorCount, blob.Add(normalsA, sizeof(normalsA)), 0, 5126, 4, "VEC3"); // 1
+    AddAccessor(accessors, accessorCount, blob.Add(uvA, sizeof(uvA)), 0, 5123, 4, "VEC2", true);     // 2
+    AddAccessor(accessors, accessorCount, blob.Add(colorA, sizeof(colorA)), 0, 5121, 4, "VEC4", true); // 3
+    AddAccessor(accessors, accessorCount, blob.Add(indicesA, sizeof(indicesA)), 0, 5123, 6, "SCALAR"); // 4
+
+    // B: the same quad without indices (6 corners -> 4 vertices after welding)
+    const float quadB[] = { 2, 0, 0,  2, 0, 1,  3, 0, 1,  2, 0, 0,  3, 0, 1,  3, 0, 0 };
+    AddAccessor(accessors, accessorCount, blob.Add(quadB, sizeof(quadB)), 0, 5126, 6, "VEC3");       // 5
+
+    // C: triangle strip of 5 vertices (3 triangles), UNSIGNED_BYTE indices
+    const float stripC[] = { 4, 0, 0,  4, 0, 1,  5, 0, 0,  5, 0, 1,  6, 0, 0 };
+    const uint8_t indicesC[] = { 0, 1, 2, 3, 4 };
+    AddAccessor(accessors, accessorCount, blob.Add(stripC, sizeof(stripC)), 0, 5126, 5, "VEC3");     // 6
+    AddAccessor(accessors, accessorCount, blob.Add(indicesC, sizeof(indicesC)), 0, 5121, 5, "SCALAR"); // 7
+
+    // Grid: position + normal interleaved (stride 24), 32-bit indices
+    std::vector<float> vertices;
+    vertices.reserve(static_cast<size_t>(g) * g * 6);
+    for (int z = 0; z < g; ++z) {
+        for (int x = 0; x < g; ++x) {
+            const float v[6] = { x * 0.1f, TerrainHeight(x, z), z * 0.1f, 0.0f, 1.0f, 0.0f };
+            vertices.insert(vertices.end(), v, v + 6);
+        }
+    }
+    std::vector<uint32_t> indices;
+    indices.reserve(static_cast<size_t>(g - 1) * (g - 1) * 6);
+    for (int z = 0; z + 1 < g; ++z) {
+        for (int x = 0; x + 1 < g; ++x) {
+            const uint32_t i = static_cast<uint32_t>(z * g + x);
+            const uint32_t quad[6] = { i, i + g, i + 1,  i + 1, i + g, i + g + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    const int interleaved = blob.Add(vertices.data(), vertices.size() * sizeof(float), 24);
+    AddAccessor(accessors, accessorCount, interleaved, 0, 5126, static_cast<size_t>(g) * g, "VEC3");  // 8
+    AddAccessor(accessors, accessorCount, interleaved, 12, 5126, static_cast<size_t>(g) * g, "VEC3"); // 9
+    AddAccessor(accessors, accessorCount, blob.Add(indices.data(), indices.size() * sizeof(uint32_t)), 0, 5125,
+        indices.size(), "SCALAR");                                                                     // 10
+
+    std::string& json = source.json;
+    json = "\"asset\":{\"version\":\"2.0\",\"generator\":\"ImportBenchmark\"},\"scene\":0,";
+    json += "\"scenes\":[{\"nodes\":[0,3]}],";
+    // Node 0: TRS, children 1 and 2; node 2: matrix (column-major); node 3: second instance of "parts"
+    json += "\"nodes\":["
+        "{\"name\":\"root\",\"translation\":[1,2,3],\"rotation\":[0,0.24740396,0,0.96891242],\"scale\":[2,2,2],\"children\":[1,2]},"
+        "{\"name\":\"parts\",\"mesh\":0,\"translation\":[0,0,-5]},"
+        "{\"name\":\"grid\",\"mesh\":1,\"matrix\":[0.5,0,0,0, 0,0.5,0,0, 0,0,0.5,0, 10,0,0,1]},"
+        "{\"name\":\"parts copy\",\"mesh\":0,\"translation\":[-4,0,0]}],";
+    json += "\"materials\":["
+        "{\"name\":\"paint\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.8,0.2,0.1,1],\"roughnessFactor\":0.5,"
+        "\"baseColorTexture\":{\"index\":0}}},"
+        "{\"name\":\"glass\",\"alphaMode\":\"BLEND\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.6,0.8,1,0.25]}}],";
+    json += "\"textures\":[{\"source\":0}],\"images\":[{\"uri\":\"paint%20color.png\"}],";
+    json += "\"meshes\":["
+        "{\"name\":\"parts\",\"primitives\":["
+        "{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2,\"COLOR_0\":3},\"indices\":4,\"material\":0},"
+        "{\"attributes\":{\"POSITION\":5},\"material\":1},"
+        "{\"attributes\":{\"POSITION\":6},\"indices\":7,\"mode\":5,\"material\":0}]},"
+        "{\"name\":\"grid\",\"primitives\":[{\"attributes\":{\"POSITION\":8,\"NORMAL\":9},\"indices\":10}]}],";
+    json += "\"accessors\":[" + accessors + "],";
+    json += "\"bufferViews\":[" + blob.views + "]";
+    return source;
+}
+
+static std::string Base64(const std::vector<uint8_t>& data)
+{
+    static const char* ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3) {
+        const uint32_t b0 = data[i];
+        const uint32_t b1 = i + 1 < data.size() ? data[i + 1] : 0;
+        const uint32_t b2 = i + 2 < data.size() ? data[i + 2] : 0;
+        const uint32_t bits = (b0 << 16) | (b1 << 8) | b2;
+        out += ALPHABET[(bits >> 18) & 63];
+        out += ALPHABET[(bits >> 12) & 63];
+        out += i + 1 < data.size() ? ALPHABET[(bits >> 6) & 63] : '=';
+        out += i + 2 < data.size() ? ALPHABET[bits & 63] : '=';
+    }
+    return out;
+}
+
+static std::vector<uint8_t> CreateGlb(const GltfSource& source)
+{
+    std::string json = "{" + source.json;
+    Append(json, ",\"buffers\":[{\"byteLength\":%zu}]}", source.blob.data.size());
+    while (json.size() % 4)
+        json += ' ';
+    std::vector<uint8_t> bin = source.blob.data;
+    while (bin.size() % 4)
+        bin.push_back(0);
+
+    const uint32_t header[3] = { 0x46546C67u, 2u, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()) };
+    const uint32_t jsonChunk[2] = { static_cast<uint32_t>(json.size()), 0x4E4F534Au };
+    const uint32_t binChunk[2] = { static_cast<uint32_t>(bin.size()), 0x004E4942u };
+
+    std::vector<uint8_t> glb;
+    auto push = [&](const void* data, size_t size) {
+        glb.insert(glb.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    };
+    push(header, sizeof(header));
+    push(jsonChunk, sizeof(jsonChunk));
+    push(json.data(), json.size());
+    push(binChunk, sizeof(binChunk));
+    push(bin.data(), bin.size());
+    return glb;
+}
+
+// ==================== CHECKS ====================
+
+// Every triangle faces (left-handed, clockwise) in the direction of its vertex normals
+static bool WindingMatchesNormals(const Model& model)
+{
+    for (const MeshData& mesh : model.meshes) {
+        for (const Primitive& p : mesh.primitives) {
+            if (p.normals.size() != p.positions.size())
+                continue;
+            for (size_t i = 0; i + 2 < p.indices.size(); i += 3) {
+                const XMFLOAT3& a = p.positions[p.indices[i]];
+                const XMFLOAT3& b = p.positions[p.indices[i + 1]];
+                const XMFLOAT3& c = p.positions[p.indices[i + 2]];
+                const float ex = b.x - a.x, ey = b.y - a.y, ez = b.z - a.z;
+                const float fx = c.x - a.x, fy = c.y - a.y, fz = c.z - a.z;
+                const float cx = ey * fz - ez * fy, cy = ez * fx - ex * fz, cz = ex * fy - ey * fx;
+                float nx = 0.0f, ny = 0.0f, nz = 0.0f;
+                for (int k = 0; k < 3; ++k) {
+                    const XMFLOAT3& n = p.normals[p.indices[i + k]];
+                    nx += n.x; ny += n.y; nz += n.z;
+                }
+                if (cx * nx + cy * ny + cz * nz <= 0.0f)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename T>
+static bool SameBits(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+static bool SameModel(const Model& a, const Model& b)
+{
+    if (a.meshes.size() != b.meshes.size() || a.materials.size() != b.materials.size() || a.nodes.size() != b.nodes.size())
+        return false;
+    for (size_t m = 0; m < a.meshes.size(); ++m) {
+        const MeshData& ma = a.meshes[m];
+        const MeshData& mb = b.meshes[m];
+        if (ma.name != mb.name || ma.primitives.size() != mb.primitives.size())
+            return false;
+        for (size_t p = 0; p < ma.primitives.size(); ++p) {
+            const Primitive& pa = ma.primitives[p];
+            const Primitive& pb = mb.primitives[p];
+            if (pa.material != pb.material || !SameBits(pa.positions, pb.positions) || !SameBits(pa.normals, pb.normals) ||
+                !SameBits(pa.colors, pb.colors) || !SameBits(pa.uv1, pb.uv1) || !SameBits(pa.uv2, pb.uv2) ||
+                !SameBits(pa.indices, pb.indices))
+                return false;
+        }
+    }
+    for (size_t i = 0; i < a.materials.size(); ++i) {
+        const MaterialData& ma = a.materials[i];
+        const MaterialData& mb = b.materials[i];
+        if (ma.name != mb.name || ma.texture != mb.texture || ma.blend != mb.blend ||
+            memcmp(&ma.diffuse, &mb.diffuse, sizeof(XMFLOAT4)) != 0 || ma.transparency != mb.transparency)
+            return false;
+    }
+    for (size_t i = 0; i < a.nodes.size(); ++i) {
+        if (a.nodes[i].name != b.nodes[i].name || a.nodes[i].mesh != b.nodes[i].mesh ||
+            memcmp(&a.nodes[i].world, &b.nodes[i].world, sizeof(XMFLOAT4X4)) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Point p (right-handed) with the reference matrix, then z mirrored, against the
+// imported point (already left-handed) with the imported world matrix
+static bool SameWorldPoint(const XMFLOAT3& imported, const XMFLOAT4X4& world, const XMFLOAT3& p, const XMMATRIX& reference)
+{
+    XMFLOAT3 a, b;
+    XMStoreFloat3(&a, XMVector3Transform(XMLoadFloat3(&imported), XMLoadFloat4x4(&world)));
+    XMStoreFloat3(&b, XMVector3Transform(XMLoadFloat3(&p), reference));
+    return std::fabs(a.x - b.x) < 1e-4f && std::fabs(a.y - b.y) < 1e-4f && std::fabs(a.z + b.z) < 1e-4f;
+}
+
+static void CheckGltf(const Model& model, int g)
+{
+    Check(model.meshes.size() == 2 && model.materials.size() == 2 && model.nodes.size() == 3, "gltf: meshes/materials/nodes");
+    if (g_failed)
+        return;
+
+    const MeshData& parts = model.meshes[0];
+    const MeshData& grid = model.meshes[1];
+    Check(parts.name == "parts" && parts.primitives.size() == 3 && grid.primitives.size() == 1, "gltf: primitives per mesh");
+    if (g_failed)
+        return;
+
+    const Primitive& a = parts.primitives[0];
+    const Primitive& b = parts.primitives[1];
+    const Primitive& c = parts.primitives[2];
+    const Primitive& d = grid.primitives[0];
+    Check(a.positions.size() == 4 && a.indices.size() == 6 && a.material == 0, "gltf: indexed primitive");
+    Check(a.uv1.size() == 4 && a.uv1[1].x == 0.0f && a.uv1[1].y == 1.0f && a.uv1[2].x == 1.0f, "gltf: normalized UNSIGNED_SHORT uv");
+    Check(a.colors.size() == 4 && a.colors[0].x == 1.0f && a.colors[3].x == 128.0f / 255.0f, "gltf: normalized UNSIGNED_BYTE color");
+    Check(b.positions.size() == 4 && b.indices.size() == 6 && b.normals.size() == 4 && b.material == 1, "gltf: non-indexed primitive welded");
+    Check(c.positions.size() == 5 && c.indices.size() == 9, "gltf: triangle strip");
+    Check(d.positions.size() == static_cast<size_t>(g) * g && d.indices.size() == static_cast<size_t>(g - 1) * (g - 1) * 6 &&
+        d.material == -1, "gltf: interleaved grid");
+
+    const MaterialData& paint = model.materials[0];
+    const MaterialData& glass = model.materials[1];
+    Check(paint.name == "paint" && paint.diffuse.x == 0.8f && !paint.blend && paint.transparency == 1.0f, "gltf: opaque material");
+    Check(paint.texture.size() >= 15 && paint.texture.compare(paint.texture.size() - 15, 15, "paint color.png") == 0, "gltf: image uri");
+    Check(glass.blend && glass.transparency == 0.25f, "gltf: alphaMode BLEND");
+
+    // World matrices: children of root (S * R * T), second instance without parent
+    const XMMATRIX root = XMMatrixMultiply(XMMatrixMultiply(XMMatrixScaling(2, 2, 2), XMMatrixRotationY(0.5f)),
+        XMMatrixTranslation(1, 2, 3));
+    const XMMATRIX partsWorld = XMMatrixMultiply(XMMatrixTranslation(0, 0, -5), root);
+    const XMMATRIX gridWorld = XMMatrixMultiply(XMMatrixMultiply(XMMatrixScaling(0.5f, 0.5f, 0.5f),
+        XMMatrixTranslation(10, 0, 0)), root);
+    const XMMATRIX copyWorld = XMMatrixTranslation(-4, 0, 0);
+
+    const Node* nodes = model.nodes.data();
+    Check(nodes[0].name == "parts" && nodes[0].mesh == 0 && nodes[1].name == "grid" && nodes[1].mesh == 1 &&
+        nodes[2].name == "parts copy" && nodes[2].mesh == 0, "gltf: node order");
+    const XMFLOAT3 corner(1, 0, 1);
+    const XMFLOAT3 gridCorner((g - 1) * 0.1f, TerrainHeight(g - 1, g - 1), (g - 1) * 0.1f);
+    Check(SameWorldPoint(a.positions[2], nodes[0].world, corner, partsWorld), "gltf: TRS hierarchy");
+    Check(SameWorldPoint(d.positions.back(), nodes[1].world, gridCorner, gridWorld), "gltf: matrix node");
+    Check(SameWorldPoint(a.positions[2], nodes[2].world, corner, copyWorld), "gltf: second instance");
+}
+
+static void CheckRejected()
+{
+    Model model;
+    std::string error;
+    const char* obj1 = "v 0 0 0\nv 1 0 0\nf 1 2 3\n";
+    const char* obj2 = "v 0 0\n";
+    const char* obj3 = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 -4\n";
+    Check(!ImportOBJ(obj1, strlen(obj1), "", model, Options(), nullptr, &error), "reject: obj index out of range");
+    Check(!ImportOBJ(obj2, strlen(obj2), "", model, Options(), nullptr, &error), "reject: obj short vertex");
+    Check(!ImportOBJ(obj3, strlen(obj3), "", model, Options(), nullptr, &error), "reject: obj relative index before start");
+
+    const char* json1 = "{\"asset\":";
+    const char* json2 =
+        "{\"asset\":{\"version\":\"2.0\"},"
+        "\"buffers\":[{\"byteLength\":4,\"uri\":\"data:application/octet-stream;base64,AAAAAA==\"}],"
+        "\"bufferViews\":[{\"buffer\":0,\"byteLength\":4}],"
+        "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":2,\"type\":\"VEC3\"}],"
+        "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0}}]}]}";
+    Check(!ImportGLTF(reinterpret_cast<const uint8_t*>(json1), strlen(json1), "", model, Options(), nullptr, &error),
+        "reject: truncated json");
+    Check(!ImportGLTF(reinterpret_cast<const uint8_t*>(json2), strlen(json2), "", model, Options(), nullptr, &error),
+        "reject: accessor outside bufferView");
+
+    const std::vector<uint8_t> glb = CreateGlb(CreateGltf(4));
+    Check(ImportGLTF(glb.data(), glb.size(), "", model, Options(), nullptr, &error), "glb: small file");
+    Check(!ImportGLTF(glb.data(), glb.size() / 2, "", model, Options(), nullptr, &error), "reject: truncated glb");
+}
+
+static void CheckParseFloat()
+{
+    const char* values[] = {
+        "0", "-0.0", "1.5", "-0.000123e-2", "3.4028235e38", "1e-38", "12345678901234567890123",
+        "0.1", "0.30000001192092896", "6.02214076e+23", "+42.", ".5", "7e-320", "1.17549435E-38"
+    };
+    bool ok = true;
+    for (const char* text : values) {
+        float value = 0.0f;
+        const char* end = text + strlen(text);
+        const char* next = ParseFloat(text, end, value);
+        const float reference = strtof(text, nullptr);
+        ok = ok && next == end && (value == reference || std::fabs(value - reference) <= std::fabs(reference) * 1.2e-7f);
+    }
+    float value;
+    ok = ok && ParseFloat("abc", "abc" + 3, value) == nullptr && ParseFloat("-", "-" + 1, value) == nullptr;
+    const char* exponent = "2e";
+    ok = ok && ParseFloat(exponent, exponent + 2, value) == exponent + 1 && value == 2.0f;
+    Check(ok, "ParseFloat matches strtof");
+}
+
+// ==================== MEASUREMENT ====================
+
+struct Run
+{
+    Model model;
+    double ms = 0.0;
+};
+
+// Best of runs imports
+static Run Measure(const std::string& path, JobSystem* jobs, size_t chunkSize, int runs)
+{
+    Run result;
+    result.ms = 1e30;
+    Options options;
+    options.chunkSize = chunkSize;
+    for (int i = 0; i < runs; ++i) {
+        Model model;
+        std::string error;
+        const Clock::time_point t0 = Clock::now();
+        const bool ok = Import(path.c_str(), model, options, jobs, &error);
+        const double ms = Ms(t0, Clock::now());
+        if (!ok) {
+            printf("  %s: %s\n", path.c_str(), error.c_str());
+            g_failed = true;
+            return result;
+        }
+        if (ms < result.ms) {
+            result.ms = ms;
+            result.model = std::move(model);
+        }
+    }
+    return result;
+}
+
+static void PrintRow(const char* name, const Run& serial, const Run& parallel)
+{
+    const Model& model = parallel.model;
+    const double mb = model.sourceBytes / (1024.0 * 1024.0);
+    const double tris = static_cast<double>(model.GetTriangleCount());
+    printf("%-20s %7.1f %9zu %9zu | %8.1fms %8.1fms | %7.1f %7.1f | %6.1f %6.1f | %5.2fx\n",
+        name, mb, model.GetTriangleCount(), model.GetVertexCount(), serial.ms, parallel.ms,
+        mb / (serial.ms / 1000.0), mb / (parallel.ms / 1000.0),
+        tris / (serial.ms * 1000.0), tris / (parallel.ms * 1000.0), serial.ms / parallel.ms);
+}
+
+int main(int argc, char** argv)
+{
+    const std::string dir = argc > 1 ? std::string(argv[1]) + "/" : std::string();
+    const int OBJ_SIZE = 500;
+    const int GRID_SIZE = 600;
+    const int RUNS = 3;
+
+    JobSystem jobs;
+    jobs.Init();
+
+    CheckParseFloat();
+    CheckRejected();
+
+    // Write the files
+    const GltfSource gltf = CreateGltf(GRID_SIZE);
+    std::string embedded = "{" + gltf.json + ",\"buffers\":[{\"byteLength\":";
+    Append(embedded, "%zu", gltf.blob.data.size());
+    embedded += ",\"uri\":\"data:application/octet-stream;base64," + Base64(gltf.blob.data) + "\"}]}";
+    std::string external = "{" + gltf.json;
+    Append(external, ",\"buffers\":[{\"byteLength\":%zu,\"uri\":\"bench%%20data.bin\"}]}", gltf.blob.data.size());
+    const std::vector<uint8_t> glb = CreateGlb(gltf);
+
+    if (!WriteFile(dir + "bench.obj", CreateObj(OBJ_SIZE)) || !WriteFile(dir + "bench.mtl", MTL) ||
+        !WriteFile(dir + "bench_embedded.gltf", embedded) || !WriteFile(dir + "bench_external.gltf", external) ||
+        !WriteFile(dir + "bench data.bin", gltf.blob.data.data(), gltf.blob.data.size()) ||
+        !WriteFile(dir + "bench.glb", glb.data(), glb.size())) {
+        printf("FAILED: cannot write the test files to '%s'\n", dir.empty() ? "." : dir.c_str());
+        jobs.Shutdown();
+        return 1;
+    }
+
+    printf("%d threads\n", int(jobs.GetThreadCount()));
+    printf("%-20s %7s %9s %9s | %10s %10s | %15s | %13s | %s\n", "file", "MB", "tris", "verts",
+        "serial", "jobs", "MB/s ser/jobs", "Mtri/s", "speedup");
+
+    // OBJ: serial with large blocks, parallel with 256 KB - the result must be the same
+    const Run objSerial = Measure(dir + "bench.obj", nullptr, 1 << 20, RUNS);
+    const Run objParallel = Measure(dir + "bench.obj", &jobs, 256 << 10, RUNS);
+    PrintRow("bench.obj", objSerial, objParallel);
+    CheckObj(objParallel.model, OBJ_SIZE);
+    Check(SameModel(objSerial.model, objParallel.model), "obj: parallel == serial");
+    Check(WindingMatchesNormals(objParallel.model), "obj: winding matches normals");
+
+    const char* GLTF_FILES[] = { "bench_embedded.gltf", "bench_external.gltf", "bench.glb" };
+    Model reference;
+    for (const char* file : GLTF_FILES) {
+        const Run serial = Measure(dir + file, nullptr, 1 << 20, RUNS);
+        const Run parallel = Measure(dir + file, &jobs, 1 << 20, RUNS);
+        PrintRow(file, serial, parallel);
+        CheckGltf(parallel.model, GRID_SIZE);
+        Check(SameModel(serial.model, parallel.model), "gltf: parallel == serial");
+        Check(WindingMatchesNormals(parallel.model), "gltf: winding matches normals");
+        if (reference.meshes.empty())
+            reference = parallel.model;
+        else
+            Check(SameModel(reference, parallel.model), "gltf: all variants identical");
+    }
+
+    jobs.Shutdown();
+
+    if (g_failed) {
+        printf("FAILED: import results disagree with the generated data\n");
+        return 1;
+    }
+    return 0;
+}
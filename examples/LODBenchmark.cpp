@@ -0,0 +1,216 @@
+// LODBenchmark.cpp
+//
+// Measures LOD generation (MeshSimplifier) and checks the results:
+//   - terrain (height field grid, open border) with 8k .. 524k triangles
+//   - UV sphere with a seam (duplicate vertices at u = 0/1) and poles
+// One LOD chain per mesh, each level with half the triangles (like GenerateMeshLODs).
+//
+// Checked per level: no degenerate triangles, no flipped triangle
+// (terrain), all seam positions still present and the projected area of the
+// terrain unchanged (the border stays). On errors exit code 1.
+// No window, no D3D11 - build as a console program.
+#include "MeshSimplifier.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+struct Geometry
+{
+    std::vector<float> positions;       // xyz
+    std::vector<uint32_t> indices;
+
+    size_t VertexCount() const { return positions.size() / 3; }
+    const float* Position(uint32_t i) const { return &positions[i * 3]; }
+};
+
+static Geometry CreateTerrain(int side)
+{
+    Geometry g;
+    const float scale = 100.0f / side;
+    for (int z = 0; z <= side; ++z)
+        for (int x = 0; x <= side; ++x)
+        {
+            const float fx = x * scale - 50.0f, fz = z * scale - 50.0f;
+            const float height = 4.0f * std::sin(fx * 0.15f) * std::cos(fz * 0.11f) + 0.5f * std::sin(fx * 0.7f + fz * 0.3f);
+            g.positions.insert(g.positions.end(), { fx, height, fz });
+        }
+
+    for (int z = 0; z < side; ++z)
+        for (int x = 0; x < side; ++x)
+        {
+            const uint32_t i = z * (side + 1) + x;
+            const uint32_t quad[6] = { i, i + side + 1, i + side + 2, i, i + side + 2, i + 1 };
+            g.indices.insert(g.indices.end(), quad, quad + 6);
+        }
+    return g;
+}
+
+// (segments + 1) vertices per ring: columns 0 and segments coincide (UV seam)
+static Geometry CreateSphere(int segments, int rings)
+{
+    Geometry g;
+    const float PI = 3.14159265f;
+    for (int r = 0; r <= rings; ++r)
+    {
+        const float theta = PI * r / rings;
+        for (int s = 0; s <= segments; ++s)
+        {
+            const float phi = 2.0f * PI * (s % segments) / segments;
+            g.positions.insert(g.positions.end(),
+                { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+        }
+    }
+
+    for (int r = 0; r < rings; ++r)
+        for (int s = 0; s < segments; ++s)
+        {
+            const uint32_t i = r * (segments + 1) + s;
+            const uint32_t n = i + segments + 1;
+            if (r > 0)
+                g.indices.insert(g.indices.end(), { i, i + 1, n });
+            if (r < rings - 1)
+                g.indices.insert(g.indices.end(), { i + 1, n + 1, n });
+        }
+    return g;
+}
+
+static void Normal(const Geometry& g, const uint32_t* tri, float n[3])
+{
+    const float* a = g.Position(tri[0]);
+    const float* b = g.Position(tri[1]);
+    const float* c = g.Position(tri[2]);
+    const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+// Sum of the triangle areas projected onto the xz plane
+static double ProjectedArea(const Geometry& g, const std::vector<uint32_t>& indices)
+{
+    double area = 0.0;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        float n[3];
+        Normal(g, &indices[i], n);
+        area += 0.5 * std::fabs(n[1]);
+    }
+    return area;
+}
+
+struct Check
+{
+    bool degenerate = false, flipped = false, seamLost = false, borderMoved = false;
+    bool Failed() const { return degenerate || flipped || seamLost || borderMoved; }
+};
+
+static Check Validate(const Geometry& g, const std::vector<uint32_t>& lod, bool heightfield)
+{
+    Check check;
+
+    // Seam positions: several used indices with the same position. A single
+    // index may drop out (e.g. a pole triangle degenerates), the position itself may not.
+    typedef std::vector<float> Key;
+    auto key = [&g](size_t v) { return Key(g.Position(uint32_t(v)), g.Position(uint32_t(v)) + 3); };
+
+    std::vector<uint8_t> referenced(g.VertexCount(), 0);
+    for (uint32_t index : g.indices)
+        referenced[index] = 1;
+
+    std::map<Key, int> users;
+    for (size_t v = 0; v < g.VertexCount(); ++v)
+        users[key(v)] += referenced[v];
+
+    std::map<Key, int> remaining;
+    for (size_t i = 0; i < lod.size(); i += 3)
+    {
+        const uint32_t* tri = &lod[i];
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+            check.degenerate = true;
+
+        float n[3];
+        Normal(g, tri, n);
+        if (n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f)
+            check.degenerate = true;
+        if (heightfield && n[1] < 0.0f)   // height field: no normal points down
+            check.flipped = true;
+
+        for (int k = 0; k < 3; ++k)
+            remaining[key(tri[k])]++;
+    }
+
+    for (const auto& position : users)
+    {
+        if (position.second > 1 && remaining.find(position.first) == remaining.end())
+            check.seamLost = true;
+    }
+
+    if (heightfield)
+    {
+        const double before = ProjectedArea(g, g.indices);
+        check.borderMoved = std::fabs(ProjectedArea(g, lod) - before) > before * 1e-3;
+    }
+    return check;
+}
+
+static bool Run(const char* name, const Geometry& g, bool heightfield, float targetError)
+{
+    bool failed = false;
+    std::vector<uint32_t> source = g.indices;
+
+    for (int level = 1; level <= 4; ++level)
+    {
+        std::vector<uint32_t> lod(source.size());
+        const size_t target = (source.size() / 2) / 3 * 3;
+        float error = 0.0f;
+
+        auto t0 = Clock::now();
+        const size_t count = MeshSimplifier::Simplify(lod.data(), source.data(), source.size(),
+            g.positions.data(), g.VertexCount(), sizeof(float) * 3, target, targetError, &error);
+        const double ms = Ms(t0, Clock::now());
+        lod.resize(count);
+
+        const Check check = Validate(g, lod, heightfield);
+        printf("%-8s %8zu  LOD%d %8zu tris (%5.1f%%) %8.2fms  error %.5f%s%s%s%s\n",
+            name, g.indices.size() / 3, level, count / 3, 100.0 * count / g.indices.size(), ms, error,
+            check.degenerate ? "  DEGENERATE" : "", check.flipped ? "  FLIPPED" : "",
+            check.seamLost ? "  SEAM LOST" : "", check.borderMoved ? "  BORDER MOVED" : "");
+
+        failed |= check.Failed();
+        if (count >= source.size())
+            break;      // error limit reached
+        source.swap(lod);
+    }
+    return failed;
+}
+
+int main()
+{
+    const int TERRAIN_SIDES[] = { 64, 256, 512 };       // 8k, 131k, 524k triangles
+    const float TARGET_ERROR = 0.02f;
+
+    bool failed = false;
+    for (int side : TERRAIN_SIDES)
+        failed |= Run("terrain", CreateTerrain(side), true, TARGET_ERROR);
+
+    failed |= Run("sphere", CreateSphere(128, 64), false, TARGET_ERROR);
+    failed |= Run("sphere", CreateSphere(512, 256), false, TARGET_ERROR);
+
+    if (failed)
+    {
+        printf("FAILED: simplified meshes violate seams, borders or orientation\n");
+        return 1;
+    }
+    return 0;
+}
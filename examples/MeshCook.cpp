@@ -0,0 +1,360 @@
+// MeshCook.cpp
+//
+// Cooks meshes into the binary format (MeshFile, .gdxm) and measures loading.
+//
+// Per test mesh (terrain with 32-bit indices, UV sphere, cube grid) and vertex format
+// (separate streams, interleaved, interleaved + quantized): set streams,
+// OptimizeSurface, FillBuffer, GenerateMeshLODs, SaveMesh. Then it checks that
+// LoadMesh yields the same mesh:
+//   - every GPU buffer (null backend: system memory) byte for byte as from FillBuffer
+//   - same vertex/index format, quantization, bounds, LOD levels and material
+//   - CPU positions and indices as before saving
+//
+// Load time per MB: LoadMesh (mmap, buffers straight from the file) against building
+// through the surface API (set streams + FillBuffer + AddMeshLOD) from the same, already
+// optimized data in memory. On errors exit code 1.
+//
+// Usage: MeshCook [output directory]  (default: working directory)
+// Headless engine, no window - build as a console program (without main.cpp / WinMain).
+#define NOMINMAX
+#include "gidx.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+struct Geometry
+{
+    std::vector<DirectX::XMFLOAT3> positions;
+    std::vector<DirectX::XMFLOAT3> normals;
+    std::vector<DirectX::XMFLOAT4> colors;
+    std::vector<DirectX::XMFLOAT2> uvs;
+    std::vector<unsigned int> indices;
+};
+
+static Geometry CreateTerrain(int side)
+{
+    Geometry g;
+    const float scale = 200.0f / side;
+    for (int z = 0; z <= side; ++z)
+        for (int x = 0; x <= side; ++x)
+        {
+            const float fx = x * scale - 100.0f, fz = z * scale - 100.0f;
+            const float height = 6.0f * std::sin(fx * 0.07f) * std::cos(fz * 0.05f) + 0.5f * std::sin(fx * 0.6f + fz * 0.3f);
+            g.positions.push_back(DirectX::XMFLOAT3(fx, height, fz));
+            g.normals.push_back(DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f));
+            g.colors.push_back(DirectX::XMFLOAT4(0.3f, 0.6f + height * 0.05f, 0.2f, 1.0f));
+            g.uvs.push_back(DirectX::XMFLOAT2(float(x) / side, float(z) / side));
+        }
+
+    for (int z = 0; z < side; ++z)
+        for (int x = 0; x < side; ++x)
+        {
+            const unsigned int i = z * (side + 1) + x;
+            const unsigned int quad[6] = { i, i + side + 1, i + side + 2, i, i + side + 2, i + 1 };
+            g.indices.insert(g.indices.end(), quad, quad + 6);
+        }
+    return g;
+}
+
+// (segments + 1) vertices per ring: columns 0 and segments coincide (UV seam)
+static Geometry CreateSphere(int segments, int rings)
+{
+    Geometry g;
+    const float PI = 3.14159265f;
+    for (int r = 0; r <= rings; ++r)
+    {
+        const float theta = PI * r / rings;
+        for (int s = 0; s <= segments; ++s)
+        {
+            const float phi = 2.0f * PI * (s % segments) / segments;
+            const DirectX::XMFLOAT3 n(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            g.positions.push_back(DirectX::XMFLOAT3(n.x * 5.0f, n.y * 5.0f, n.z * 5.0f));
+            g.normals.push_back(n);
+            g.colors.push_back(DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+            g.uvs.push_back(DirectX::XMFLOAT2(float(s) / segments, float(r) / rings));
+        }
+    }
+
+    for (int r = 0; r < rings; ++r)
+        for (int s = 0; s < segments; ++s)
+        {
+            const unsigned int i = r * (segments + 1) + s;
+            const unsigned int n = i + segments + 1;
+            if (r > 0)
+                g.indices.insert(g.indices.end(), { i, i + 1, n });
+            if (r < rings - 1)
+                g.indices.insert(g.indices.end(), { i + 1, n + 1, n });
+        }
+    return g;
+}
+
+// side^2 cubes with 24 vertices each (hard edges) in one surface
+static Geometry CreateCubeGrid(int side)
+{
+    static const float corners[8][3] = {
+        {-0.4f,-0.4f,-0.4f}, {0.4f,-0.4f,-0.4f}, {0.4f,0.4f,-0.4f}, {-0.4f,0.4f,-0.4f},
+        {-0.4f,-0.4f, 0.4f}, {0.4f,-0.4f, 0.4f}, {0.4f,0.4f, 0.4f}, {-0.4f,0.4f, 0.4f}
+    };
+    static const int faces[6][4] = {
+        {0, 3, 2, 1}, {4, 5, 6, 7}, {0, 4, 7, 3}, {1, 2, 6, 5}, {0, 1, 5, 4}, {3, 7, 6, 2}
+    };
+    static const float normals[6][3] = {
+        {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}
+    };
+    static const float uvs[4][2] = { {0, 1}, {0, 0}, {1, 0}, {1, 1} };
+
+    Geometry g;
+    for (int c = 0; c < side * side; ++c)
+    {
+        const float ox = float(c % side) - side * 0.5f, oz = float(c / side) - side * 0.5f;
+        for (int f = 0; f < 6; ++f)
+        {
+            const unsigned int base = static_cast<unsigned int>(g.positions.size());
+            for (int v = 0; v < 4; ++v)
+            {
+                const float* p = corners[faces[f][v]];
+                g.positions.push_back(DirectX::XMFLOAT3(p[0] + ox, p[1], p[2] + oz));
+                g.normals.push_back(DirectX::XMFLOAT3(normals[f][0], normals[f][1], normals[f][2]));
+                g.colors.push_back(DirectX::XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f));
+                g.uvs.push_back(DirectX::XMFLOAT2(uvs[v][0], uvs[v][1]));
+            }
+            const unsigned int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+            g.indices.insert(g.indices.end(), quad, quad + 6);
+        }
+    }
+    return g;
+}
+
+static void SetStreams(LPSURFACE surface, const Geometry& g)
+{
+    Engine::SetSurfacePositions(surface, g.positions.data(), g.positions.size());
+    Engine::SetSurfaceNormals(surface, g.normals.data(), g.normals.size());
+    Engine::SetSurfaceColors(surface, g.colors.data(), g.colors.size());
+    Engine::SetSurfaceTexCoords(surface, g.uvs.data(), g.uvs.size());
+    Engine::SetSurfaceIndices(surface, g.indices.data(), g.indices.size());
+}
+
+// CPU streams of a finished surface (input for building through the surface API)
+static Geometry CaptureStreams(const Surface* surface)
+{
+    Geometry g;
+    g.positions = surface->position;
+    g.normals = surface->normal;
+    g.colors = surface->color;
+    g.uvs = surface->uv1;
+    g.indices = surface->indices;
+    return g;
+}
+
+static bool SameBuffer(ID3D11Buffer* a, ID3D11Buffer* b)
+{
+    if (!a || !b)
+        return a == b;
+    const GDXNullBuffer* na = Engine::GetNullBuffer(a);
+    const GDXNullBuffer* nb = Engine::GetNullBuffer(b);
+    if (!na || !nb)
+        return false;
+    return na->GetByteWidth() == nb->GetByteWidth() &&
+        std::memcmp(na->GetData(), nb->GetData(), na->GetByteWidth()) == 0;
+}
+
+static bool SameSurface(const Surface* a, const Surface* b)
+{
+    const DirectX::BoundingBox& boxA = a->GetLocalBox();
+    const DirectX::BoundingBox& boxB = b->GetLocalBox();
+    return SameBuffer(a->vertexBuffer, b->vertexBuffer) &&
+        SameBuffer(a->positionBuffer, b->positionBuffer) &&
+        SameBuffer(a->normalBuffer, b->normalBuffer) &&
+        SameBuffer(a->colorBuffer, b->colorBuffer) &&
+        SameBuffer(a->uv1Buffer, b->uv1Buffer) &&
+        SameBuffer(a->uv2Buffer, b->uv2Buffer) &&
+        SameBuffer(a->indexBuffer, b->indexBuffer) &&
+        a->GetVertexFormat() == b->GetVertexFormat() &&
+        a->vertexStride == b->vertexStride &&
+        a->indexFormat == b->indexFormat &&
+        a->size_listIndex == b->size_listIndex &&
+        std::memcmp(&a->quantization, &b->quantization, sizeof(a->quantization)) == 0 &&
+        std::memcmp(&boxA, &boxB, sizeof(boxA)) == 0 &&
+        a->GetLocalSphere().Radius == b->GetLocalSphere().Radius &&
+        a->position.size() == b->position.size() &&
+        std::memcmp(a->position.data(), b->position.data(), a->position.size() * sizeof(DirectX::XMFLOAT3)) == 0 &&
+        a->indices == b->indices;
+}
+
+static bool SameMesh(Mesh* a, Mesh* b)
+{
+    if (a->pMaterial != b->pMaterial || a->surfaces.size() != b->surfaces.size() || a->lods.size() != b->lods.size())
+        return false;
+    for (size_t i = 0; i < a->surfaces.size(); ++i)
+        if (!SameSurface(a->surfaces[i], b->surfaces[i]))
+            return false;
+    for (size_t l = 0; l < a->lods.size(); ++l)
+    {
+        const MeshLOD& la = a->lods[l];
+        const MeshLOD& lb = b->lods[l];
+        if (la.screenSize != lb.screenSize || la.error != lb.error)
+            return false;
+        for (size_t i = 0; i < la.surfaces.size(); ++i)
+            if (!SameSurface(la.surfaces[i], lb.surfaces[i]))
+                return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const int ITERATIONS = 20;
+    const std::string outDir = argc > 1 ? argv[1] : ".";
+
+    if (Engine::CreateHeadlessEngine(1280, 720) != 0)
+    {
+        printf("CreateHeadlessEngine failed\n");
+        return -1;
+    }
+    Engine::Graphics(1280, 720);
+    Engine::GetCommandLog().SetKeepCommands(false);
+
+    // LoadMesh without a material finds it by the stored name
+    LPMATERIAL material;
+    Engine::CreateMaterial(&material);
+    Engine::MaterialName(material, "MeshCook");
+
+    struct Source { const char* name; Geometry geometry; };
+    std::vector<Source> sources;
+    sources.push_back({ "terrain", CreateTerrain(300) });
+    sources.push_back({ "sphere", CreateSphere(128, 64) });
+    sources.push_back({ "cubes", CreateCubeGrid(40) });
+
+    struct Format { const char* name; bool interleaved; bool quantized; };
+    const Format formats[] = {
+        { "separate", false, false },
+        { "interleaved", true, false },
+        { "packed+quant", true, true },
+    };
+
+    printf("%-8s %-13s %9s %9s %5s %9s %10s %10s %9s %7s\n",
+        "mesh", "format", "vertices", "tris", "lods", "file MB", "load ms", "build ms", "load/MB", "check");
+
+    bool failed = false;
+    for (const Source& source : sources)
+    {
+        for (const Format& format : formats)
+        {
+            // ==================== COOK ====================
+            LPENTITY cooked = nullptr;
+            Engine::CreateMesh(&cooked, material);
+            LPSURFACE surface = nullptr;
+            Engine::CreateSurface(&surface, cooked);
+            Engine::SetSurfaceInterleaved(surface, format.interleaved);
+            Engine::SetSurfaceQuantized(surface, format.quantized);
+            SetStreams(surface, source.geometry);
+            Engine::OptimizeSurface(surface);
+            Engine::FillBuffer(surface);
+            Engine::GenerateMeshLODs(cooked, 3);
+
+            const std::string path = outDir + "/" + source.name + "_" + (format.interleaved ? (format.quantized ? "quant" : "packed") : "separate") + ".gdxm";
+            if (!Engine::SaveMesh(cooked, path.c_str()))
+            {
+                printf("SaveMesh failed: %s\n", path.c_str());
+                failed = true;
+                continue;
+            }
+
+            Mesh* cookedMesh = static_cast<Mesh*>(cooked);
+
+            // Input for the comparison build: the already optimized streams of all levels
+            std::vector<Geometry> levels;
+            levels.push_back(CaptureStreams(cookedMesh->surfaces[0]));
+            for (const MeshLOD& lod : cookedMesh->lods)
+                levels.push_back(CaptureStreams(lod.surfaces[0]));
+
+            // ==================== VERIFY ====================
+            LPENTITY loaded = nullptr;
+            bool ok = Engine::LoadMesh(&loaded, path.c_str()) && SameMesh(cookedMesh, static_cast<Mesh*>(loaded));
+            if (loaded)
+                Engine::engine->GetOM().DeleteMesh(static_cast<Mesh*>(loaded));
+
+            // Without CPU geometry: same buffers, no positions
+            LPENTITY gpuOnly = nullptr;
+            ok = ok && Engine::LoadMesh(&gpuOnly, path.c_str(), material, false) &&
+                SameBuffer(static_cast<Mesh*>(gpuOnly)->surfaces[0]->indexBuffer, cookedMesh->surfaces[0]->indexBuffer) &&
+                static_cast<Mesh*>(gpuOnly)->surfaces[0]->position.empty();
+            if (gpuOnly)
+                Engine::engine->GetOM().DeleteMesh(static_cast<Mesh*>(gpuOnly));
+
+            MeshFile::Reader reader;
+            const double fileMB = reader.Open(path.c_str()) ? reader.GetSize() / (1024.0 * 1024.0) : 0.0;
+            reader.Close();
+
+            // ==================== LOAD ====================
+            double loadMs = 0.0;
+            for (int i = 0; i < ITERATIONS; ++i)
+            {
+                LPENTITY mesh = nullptr;
+                const Clock::time_point t0 = Clock::now();
+                Engine::LoadMesh(&mesh, path.c_str(), material);
+                loadMs += Ms(t0, Clock::now());
+                if (mesh)
+                    Engine::engine->GetOM().DeleteMesh(static_cast<Mesh*>(mesh));
+            }
+            loadMs /= ITERATIONS;
+
+            // Comparison: the same levels through the surface API (packing/quantizing on every build)
+            double buildMs = 0.0;
+            for (int i = 0; i < ITERATIONS; ++i)
+            {
+                const Clock::time_point t0 = Clock::now();
+                LPENTITY mesh = nullptr;
+                Engine::CreateMesh(&mesh, material);
+                LPSURFACE base = nullptr;
+                Engine::CreateSurface(&base, mesh);
+                Engine::SetSurfaceInterleaved(base, format.interleaved);
+                Engine::SetSurfaceQuantized(base, format.quantized);
+                SetStreams(base, levels[0]);
+                Engine::FillBuffer(base);
+
+                for (size_t l = 1; l < levels.size(); ++l)
+                {
+                    LPSURFACE lod = Engine::engine->GetOM().CreateSurface();
+                    lod->pMesh = static_cast<Mesh*>(mesh);
+                    lod->interleaved = format.interleaved;
+                    lod->quantizePositions = format.quantized;
+                    SetStreams(lod, levels[l]);
+                    Engine::FillBuffer(lod);
+                    Engine::AddMeshLOD(mesh, { lod }, cookedMesh->lods[l - 1].screenSize);
+                }
+                buildMs += Ms(t0, Clock::now());
+                Engine::engine->GetOM().DeleteMesh(static_cast<Mesh*>(mesh));
+            }
+            buildMs /= ITERATIONS;
+
+            const Surface* baseSurface = cookedMesh->surfaces[0];
+            printf("%-8s %-13s %9zu %9u %5zu %9.2f %10.3f %10.3f %9.3f %7s\n",
+                source.name, format.name, baseSurface->position.size(), baseSurface->GetTriangleCount(),
+                cookedMesh->lods.size(), fileMB, loadMs, buildMs, fileMB > 0.0 ? loadMs / fileMB : 0.0,
+                ok ? "ok" : "FAIL");
+
+            failed = failed || !ok;
+            Engine::engine->GetOM().DeleteMesh(cookedMesh);
+        }
+    }
+
+    Engine::ReleaseEngine();
+
+    if (failed)
+    {
+        printf("FEHLER: geladenes Mesh weicht vom gekochten ab\n");
+        return 1;
+    }
+    return 0;
+}
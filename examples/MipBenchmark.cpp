@@ -0,0 +1,268 @@
+// MipBenchmark.cpp
+//
+// Measures mip generation (MipGenerator) for 1K, 2K and 4K RGBA8 images with the box
+// and Kaiser filter, each on one thread and with the JobSystem. Reported are
+// milliseconds per chain and MPix/s (pixels of level 0).
+//
+// Checked:
+//   - level sizes, NPOT too (1000x600, 1x300)
+//   - constant images stay constant (all 256 values, sRGB and linear)
+//   - for powers of two, box matches the block mean in double (+-1)
+//   - alpha coverage of "foliage" is kept with preserveCoverage
+//   - the result is bit-identical with and without the JobSystem
+// On errors exit code 1.
+// No window, no D3D11 - build as a console program.
+#include "MipGenerator.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static bool g_failed = false;
+
+static void Check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        printf("  FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+// Smooth color gradients with noise and hard edges
+static std::vector<uint8_t> CreateImage(uint32_t width, uint32_t height, std::mt19937& rng)
+{
+    std::vector<uint8_t> image(size_t(width) * height * 4);
+    std::uniform_int_distribution<int> noise(-12, 12);
+    for (uint32_t y = 0; y < height; ++y)
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint8_t* p = &image[(size_t(y) * width + x) * 4];
+            const float u = float(x) / width, v = float(y) / height;
+            const bool checker = ((x / 37) ^ (y / 23)) & 1;
+            p[0] = uint8_t((std::min)(255, (std::max)(0, int(255 * u) + noise(rng))));
+            p[1] = uint8_t((std::min)(255, (std::max)(0, int(128 + 120 * std::sin(u * 20.0f + v * 7.0f)) + noise(rng))));
+            p[2] = checker ? 230 : 20;
+            p[3] = uint8_t(255 * v);
+        }
+    return image;
+}
+
+static double Decode(uint8_t value)
+{
+    const double c = value / 255.0;
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+static int Encode(double linear)
+{
+    const double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+    return int(std::lround(c * 255.0));
+}
+
+static bool CheckSizes(uint32_t width, uint32_t height)
+{
+    MipGenerator::MipChain chain;
+    std::vector<uint8_t> image(size_t(width) * height * 4, 128);
+    MipGenerator::Generate(image.data(), width, height, chain);
+
+    bool ok = chain.levels.size() + 1 == MipGenerator::CountLevels(width, height);
+    uint32_t w = width, h = height;
+    size_t bytes = 0;
+    for (const MipGenerator::Level& level : chain.levels)
+    {
+        w = (std::max)(w / 2, 1u);
+        h = (std::max)(h / 2, 1u);
+        ok &= level.width == w && level.height == h && level.offset == bytes;
+        bytes += size_t(w) * h * 4;
+    }
+    ok &= w == 1 && h == 1 && chain.data.size() == bytes;
+    return ok;
+}
+
+// Every value, as a constant image, must stay unchanged in all levels
+static bool CheckConstant(MipGenerator::Filter filter, bool srgb)
+{
+    MipGenerator::Options options;
+    options.filter = filter;
+    options.srgb = srgb;
+
+    const uint32_t width = 12, height = 7;
+    std::vector<uint8_t> image(size_t(width) * height * 4);
+    MipGenerator::MipChain chain;
+    for (int value = 0; value < 256; ++value)
+    {
+        for (size_t i = 0; i < image.size(); ++i)
+            image[i] = uint8_t(i % 4 == 3 ? 255 - value : value);
+        MipGenerator::Generate(image.data(), width, height, chain, options);
+        for (size_t i = 0; i < chain.data.size(); ++i)
+            if (chain.data[i] != uint8_t(i % 4 == 3 ? 255 - value : value))
+                return false;
+    }
+    return true;
+}
+
+// Box for powers of two: level k = mean of the 2^k x 2^k blocks (linear, in double)
+static int CheckBoxReference(const std::vector<uint8_t>& image, uint32_t width, uint32_t height)
+{
+    MipGenerator::MipChain chain;
+    MipGenerator::Generate(image.data(), width, height, chain);
+
+    int maxError = 0;
+    for (size_t l = 0; l < chain.levels.size(); ++l)
+    {
+        const MipGenerator::Level& level = chain.levels[l];
+        const uint32_t bw = width / level.width, bh = height / level.height;
+        const uint8_t* out = chain.GetLevel(l);
+        for (uint32_t y = 0; y < level.height; ++y)
+            for (uint32_t x = 0; x < level.width; ++x)
+            {
+                double sum[4] = {};
+                for (uint32_t sy = y * bh; sy < (y + 1) * bh; ++sy)
+                    for (uint32_t sx = x * bw; sx < (x + 1) * bw; ++sx)
+                    {
+                        const uint8_t* p = &image[(size_t(sy) * width + sx) * 4];
+                        for (int c = 0; c < 3; ++c)
+                            sum[c] += Decode(p[c]);
+                        sum[3] += p[3] / 255.0;
+                    }
+                const double n = double(bw) * bh;
+                const uint8_t* o = out + (size_t(y) * level.width + x) * 4;
+                for (int c = 0; c < 3; ++c)
+                    maxError = (std::max)(maxError, std::abs(o[c] - Encode(sum[c] / n)));
+                maxError = (std::max)(maxError, std::abs(o[3] - int(std::lround(sum[3] / n * 255.0))));
+            }
+    }
+    return maxError;
+}
+
+// Foliage: small leaves (discs with a soft edge) on a transparent background
+static void CheckCoverage(MipGenerator::Filter filter, std::mt19937& rng)
+{
+    const uint32_t size = 512;
+    std::vector<uint8_t> image(size_t(size) * size * 4, 0);
+    std::uniform_real_distribution<float> position(0.0f, float(size)), radius(2.0f, 6.0f);
+    for (int leaf = 0; leaf < 2500; ++leaf)
+    {
+        const float cx = position(rng), cy = position(rng), r = radius(rng);
+        for (int y = int(cy - r - 2); y <= int(cy + r + 2); ++y)
+            for (int x = int(cx - r - 2); x <= int(cx + r + 2); ++x)
+            {
+                if (x < 0 || y < 0 || x >= int(size) || y >= int(size))
+                    continue;
+                const float d = std::sqrt((x + 0.5f - cx) * (x + 0.5f - cx) + (y + 0.5f - cy) * (y + 0.5f - cy));
+                const int alpha = int(255.0f * (std::min)(1.0f, (std::max)(0.0f, (r - d) * 0.5f + 0.5f)));
+                uint8_t* p = &image[(size_t(y) * size + x) * 4];
+                p[0] = 60; p[1] = 140; p[2] = 40;
+                p[3] = uint8_t((std::max)(int(p[3]), alpha));
+            }
+    }
+
+    const float cutoff = 0.5f;
+    const float reference = MipGenerator::AlphaCoverage(image.data(), size, size, cutoff);
+
+    MipGenerator::Options options;
+    options.filter = filter;
+    MipGenerator::MipChain plain, preserved;
+    MipGenerator::Generate(image.data(), size, size, plain, options);
+    options.preserveCoverage = true;
+    options.alphaCutoff = cutoff;
+    MipGenerator::Generate(image.data(), size, size, preserved, options);
+
+    float plainError = 0.0f, preservedError = 0.0f;
+    for (size_t l = 0; l < plain.levels.size(); ++l)
+    {
+        const MipGenerator::Level& level = plain.levels[l];
+        // From 16x16 on the coverage is representable to within 1/256
+        if (level.width < 16)
+            break;
+        plainError = (std::max)(plainError, std::fabs(MipGenerator::AlphaCoverage(plain.GetLevel(l), level.width, level.height, cutoff) - reference));
+        preservedError = (std::max)(preservedError, std::fabs(MipGenerator::AlphaCoverage(preserved.GetLevel(l), level.width, level.height, cutoff) - reference));
+    }
+
+    printf("  coverage %-6s  level 0: %5.1f%%   max deviation: plain %5.1f%%, preserved %5.1f%%\n",
+        filter == MipGenerator::Filter::Box ? "box" : "kaiser", reference * 100.0f, plainError * 100.0f, preservedError * 100.0f);
+    Check(preservedError <= 0.01f, "alpha coverage not preserved");
+}
+
+int main()
+{
+    JobSystem jobs;
+    jobs.Init();
+
+    std::mt19937 rng(1234);
+
+    printf("checks\n");
+    Check(MipGenerator::CountLevels(1024, 512) == 11 && MipGenerator::CountLevels(1, 1) == 1, "level count");
+    Check(CheckSizes(1024, 1024) && CheckSizes(1000, 600) && CheckSizes(1, 300) && CheckSizes(7, 3), "level sizes");
+    Check(CheckConstant(MipGenerator::Filter::Box, true) && CheckConstant(MipGenerator::Filter::Box, false), "constant image (box)");
+    Check(CheckConstant(MipGenerator::Filter::Kaiser, true) && CheckConstant(MipGenerator::Filter::Kaiser, false), "constant image (kaiser)");
+    {
+        const std::vector<uint8_t> image = CreateImage(256, 128, rng);
+        const int error = CheckBoxReference(image, 256, 128);
+        printf("  box vs double reference: max error %d\n", error);
+        Check(error <= 1, "box filter differs from reference");
+    }
+    CheckCoverage(MipGenerator::Filter::Box, rng);
+    CheckCoverage(MipGenerator::Filter::Kaiser, rng);
+
+    const uint32_t SIZES[] = { 1024, 2048, 4096 };
+    const MipGenerator::Filter FILTERS[] = { MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser };
+    const int RUNS = 3;
+
+    printf("\n%d threads\n", int(jobs.GetThreadCount()));
+    printf("%-6s %-6s %6s | %9s %9s | %9s %9s %s\n", "size", "filter", "levels", "serial", "MPix/s", "jobs", "MPix/s", "");
+
+    for (uint32_t size : SIZES)
+    {
+        const std::vector<uint8_t> image = CreateImage(size, size, rng);
+        const double megapixels = double(size) * size / 1e6;
+
+        for (MipGenerator::Filter filter : FILTERS)
+        {
+            MipGenerator::Options options;
+            options.filter = filter;
+            MipGenerator::MipChain serial, parallel;
+
+            // Best of RUNS runs
+            double serialMs = 1e30, jobsMs = 1e30;
+            for (int run = 0; run < RUNS; ++run)
+            {
+                Clock::time_point t0 = Clock::now();
+                MipGenerator::Generate(image.data(), size, size, serial, options);
+                Clock::time_point t1 = Clock::now();
+                MipGenerator::Generate(image.data(), size, size, parallel, options, &jobs);
+                Clock::time_point t2 = Clock::now();
+                serialMs = (std::min)(serialMs, Ms(t0, t1));
+                jobsMs = (std::min)(jobsMs, Ms(t1, t2));
+            }
+
+            const bool mismatch = serial.data != parallel.data;
+            printf("%4uK  %-6s %6zu | %7.2fms %9.1f | %7.2fms %9.1f %s\n",
+                size / 1024, filter == MipGenerator::Filter::Box ? "box" : "kaiser", serial.levels.size() + 1,
+                serialMs, megapixels / serialMs * 1000.0, jobsMs, megapixels / jobsMs * 1000.0,
+                mismatch ? "  MISMATCH" : "");
+            g_failed |= mismatch;
+        }
+    }
+
+    jobs.Shutdown();
+
+    if (g_failed)
+    {
+        printf("FAILED: mip chains disagree with the reference\n");
+        return 1;
+    }
+    return 0;
+}
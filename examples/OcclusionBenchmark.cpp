@@ -0,0 +1,297 @@
+// OcclusionBenchmark.cpp
+//
+// Measures software occlusion culling (OcclusionBuffer) in a city:
+//   - 16x16 buildings (boxes as occluders, each side split into 1x1 or 8x8 quads)
+//   - 20000 small boxes (occludees) on streets and inside blocks
+//   - camera at street level and from diagonally above, buffer 256x128 and 512x256
+// Measured are rasterization (1 thread / JobSystem), the test per box and the share
+// of occluded boxes.
+//
+// Checked: the depth buffer is bit-identical with and without the JobSystem, and no
+// box reported as occluded is visible. For that, a ray is shot through every pixel
+// center of each occluded box's screen rectangle and intersected analytically with
+// all buildings and the box. On errors exit code 1.
+// No window, no D3D11 - build as a console program.
+#include "OcclusionBuffer.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace DirectX;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+struct Box
+{
+    XMFLOAT3 center;
+    XMFLOAT3 extents;
+};
+
+struct Geometry
+{
+    std::vector<XMFLOAT3> positions;
+    std::vector<unsigned int> indices;
+};
+
+// Unit cube (-1..1), every side split x split quads. Clockwise from outside (D3D front face).
+static Geometry CreateCube(int split)
+{
+    // normal n = u x v
+    const float FACES[6][3][3] = {
+        { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } }, { { -1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } },
+        { { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 0 } }, { { 0, -1, 0 }, { 1, 0, 0 }, { 0, 0, 1 } },
+        { { 0, 0, 1 }, { 1, 0, 0 }, { 0, 1, 0 } }, { { 0, 0, -1 }, { 0, 1, 0 }, { 1, 0, 0 } },
+    };
+
+    Geometry g;
+    for (const auto& face : FACES)
+    {
+        const unsigned int first = static_cast<unsigned int>(g.positions.size());
+        for (int t = 0; t <= split; ++t)
+            for (int s = 0; s <= split; ++s)
+            {
+                const float a = 2.0f * s / split - 1.0f, b = 2.0f * t / split - 1.0f;
+                g.positions.push_back(XMFLOAT3(face[0][0] + face[1][0] * a + face[2][0] * b,
+                    face[0][1] + face[1][1] * a + face[2][1] * b, face[0][2] + face[1][2] * a + face[2][2] * b));
+            }
+
+        for (int t = 0; t < split; ++t)
+            for (int s = 0; s < split; ++s)
+            {
+                const unsigned int p00 = first + t * (split + 1) + s;
+                const unsigned int p10 = p00 + 1, p01 = p00 + split + 1, p11 = p01 + 1;
+                const unsigned int quad[6] = { p00, p10, p11, p00, p11, p01 };
+                g.indices.insert(g.indices.end(), quad, quad + 6);
+            }
+    }
+    return g;
+}
+
+// Entry distance of the ray into the box (slab test), -1 without a hit
+static double RayBox(const double* origin, const double* direction, const Box& box)
+{
+    const double center[3] = { box.center.x, box.center.y, box.center.z };
+    const double extents[3] = { box.extents.x, box.extents.y, box.extents.z };
+    double enter = 0.0, leave = 1e30;
+    for (int a = 0; a < 3; ++a)
+    {
+        const double lower = center[a] - extents[a] - origin[a];
+        const double upper = center[a] + extents[a] - origin[a];
+        if (direction[a] == 0.0)
+        {
+            if (lower > 0.0 || upper < 0.0)
+                return -1.0;
+            continue;
+        }
+        double t0 = lower / direction[a], t1 = upper / direction[a];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        enter = (std::max)(enter, t0);
+        leave = (std::min)(leave, t1);
+    }
+    return enter <= leave ? enter : -1.0;
+}
+
+struct City
+{
+    std::vector<Box> buildings;
+    std::vector<Box> props;
+};
+
+static City CreateCity(std::mt19937& rng)
+{
+    const int BLOCKS = 16;
+    const float SPACING = 20.0f, FOOTPRINT = 7.0f;
+    std::uniform_real_distribution<float> height(5.0f, 30.0f);
+    std::uniform_real_distribution<float> position(-10.0f, BLOCKS * SPACING);
+    std::uniform_real_distribution<float> size(0.2f, 1.5f);
+
+    City city;
+    for (int z = 0; z < BLOCKS; ++z)
+        for (int x = 0; x < BLOCKS; ++x)
+        {
+            const float h = height(rng);
+            city.buildings.push_back({ XMFLOAT3(x * SPACING + 10.0f, h, z * SPACING + 10.0f), XMFLOAT3(FOOTPRINT, h, FOOTPRINT) });
+        }
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        const float s = size(rng);
+        city.props.push_back({ XMFLOAT3(position(rng), s, position(rng)), XMFLOAT3(s, s, s) });
+    }
+    return city;
+}
+
+struct View
+{
+    const char* name;
+    XMFLOAT3 eye;
+    XMFLOAT3 direction;
+};
+
+struct Result
+{
+    double raster = 0.0, rasterJobs = 0.0, test = 0.0;   // ms
+    size_t triangles = 0, rasterized = 0, culled = 0;
+    size_t falseCulls = 0;
+    bool mismatch = false;
+};
+
+static Result Run(const City& city, const Geometry& cube, const View& view, uint32_t width, uint32_t height, JobSystem& jobs)
+{
+    const XMVECTOR eye = XMLoadFloat3(&view.eye);
+    const XMMATRIX viewMatrix = XMMatrixLookToLH(eye, XMLoadFloat3(&view.direction), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    const XMMATRIX projection = XMMatrixPerspectiveFovLH(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    const XMMATRIX viewProjection = XMMatrixMultiply(viewMatrix, projection);
+
+    OcclusionBuffer buffer;
+    buffer.Resize(width, height);
+
+    auto render = [&](JobSystem* jobSystem)
+        {
+            buffer.Begin(viewProjection);
+            for (const Box& b : city.buildings)
+            {
+                const XMMATRIX world = XMMatrixMultiply(XMMatrixScaling(b.extents.x, b.extents.y, b.extents.z),
+                    XMMatrixTranslation(b.center.x, b.center.y, b.center.z));
+                buffer.AddOccluder(cube.positions.data(), cube.positions.size(), cube.indices.data(), cube.indices.size(), world);
+            }
+            buffer.Rasterize(jobSystem);
+        };
+
+    const int REPEAT = 20;
+    Result result;
+
+    render(nullptr);    // warm up (buffers grow once)
+    auto t0 = Clock::now();
+    for (int i = 0; i < REPEAT; ++i)
+        render(nullptr);
+    result.raster = Ms(t0, Clock::now()) / REPEAT;
+    const std::vector<float> serial(buffer.GetDepth(), buffer.GetDepth() + size_t(buffer.GetWidth()) * buffer.GetHeight());
+
+    render(&jobs);
+    auto t1 = Clock::now();
+    for (int i = 0; i < REPEAT; ++i)
+        render(&jobs);
+    result.rasterJobs = Ms(t1, Clock::now()) / REPEAT;
+    result.mismatch = std::memcmp(serial.data(), buffer.GetDepth(), serial.size() * sizeof(float)) != 0;
+    result.triangles = buffer.GetStats().triangles;
+    result.rasterized = buffer.GetStats().rasterized;
+
+    std::vector<uint8_t> visible(city.props.size());
+    auto t2 = Clock::now();
+    for (size_t i = 0; i < city.props.size(); ++i)
+        visible[i] = buffer.IsVisible(city.props[i].center, city.props[i].extents) ? 1 : 0;
+    result.test = Ms(t2, Clock::now());
+
+    // Reference: rays through the pixel centers of every occluded box
+    const XMMATRIX inverse = XMMatrixInverse(nullptr, viewProjection);
+    XMFLOAT3 origin;
+    XMStoreFloat3(&origin, eye);
+    const double o[3] = { origin.x, origin.y, origin.z };
+
+    for (size_t i = 0; i < city.props.size(); ++i)
+    {
+        if (visible[i])
+            continue;
+        ++result.culled;
+
+        const Box& prop = city.props[i];
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+        for (int c = 0; c < 8; ++c)
+        {
+            const XMVECTOR corner = XMVectorSet(prop.center.x + ((c & 1) ? prop.extents.x : -prop.extents.x),
+                prop.center.y + ((c & 2) ? prop.extents.y : -prop.extents.y),
+                prop.center.z + ((c & 4) ? prop.extents.z : -prop.extents.z), 1.0f);
+            XMFLOAT3 p;
+            XMStoreFloat3(&p, XMVector3TransformCoord(corner, viewProjection));
+            minX = (std::min)(minX, (p.x * 0.5f + 0.5f) * width);
+            maxX = (std::max)(maxX, (p.x * 0.5f + 0.5f) * width);
+            minY = (std::min)(minY, (0.5f - p.y * 0.5f) * height);
+            maxY = (std::max)(maxY, (0.5f - p.y * 0.5f) * height);
+        }
+
+        const int x0 = (std::max)(0, int(std::floor(minX))), x1 = (std::min)(int(width) - 1, int(maxX));
+        const int y0 = (std::max)(0, int(std::floor(minY))), y1 = (std::min)(int(height) - 1, int(maxY));
+        bool seen = false;
+        for (int y = y0; y <= y1 && !seen; ++y)
+            for (int x = x0; x <= x1 && !seen; ++x)
+            {
+                const float ndcX = (x + 0.5f) / width * 2.0f - 1.0f;
+                const float ndcY = 1.0f - (y + 0.5f) / height * 2.0f;
+                XMFLOAT3 target;
+                XMStoreFloat3(&target, XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), inverse));
+                const double d[3] = { target.x - o[0], target.y - o[1], target.z - o[2] };
+
+                const double hit = RayBox(o, d, prop);
+                if (hit < 0.0)
+                    continue;
+
+                double nearest = 1e30;
+                for (const Box& b : city.buildings)
+                {
+                    const double t = RayBox(o, d, b);
+                    if (t >= 0.0)
+                        nearest = (std::min)(nearest, t);
+                }
+                // tolerance for the float interpolation of the depth
+                seen = hit < nearest * (1.0 - 1e-4);
+            }
+        result.falseCulls += seen ? 1 : 0;
+    }
+    return result;
+}
+
+int main()
+{
+    JobSystem jobs;
+    jobs.Init();
+
+    std::mt19937 rng(1234);
+    const City city = CreateCity(rng);
+
+    const View VIEWS[] = {
+        { "street", XMFLOAT3(-5.0f, 1.7f, -5.0f), XMFLOAT3(1.0f, 0.0f, 0.8f) },
+        { "aerial", XMFLOAT3(-40.0f, 60.0f, -40.0f), XMFLOAT3(1.0f, -0.6f, 1.0f) },
+    };
+    const int SPLITS[] = { 1, 8 };
+    const uint32_t SIZES[][2] = { { 256, 128 }, { 512, 256 } };
+
+    printf("%d threads\n", int(jobs.GetThreadCount()));
+    printf("%-7s %9s %8s | %9s %9s | %9s | %15s %s\n", "view", "size", "tris", "raster", "jobs", "test/box", "culled", "");
+
+    bool failed = false;
+    for (const View& view : VIEWS)
+        for (int split : SPLITS)
+            for (const auto& size : SIZES)
+            {
+                const Geometry cube = CreateCube(split);
+                const Result r = Run(city, cube, view, size[0], size[1], jobs);
+                printf("%-7s %4ux%-4u %8zu | %7.3fms %7.3fms | %7.1fns | %6zu (%5.1f%%)%s%s\n",
+                    view.name, size[0], size[1], r.triangles, r.raster, r.rasterJobs,
+                    r.test * 1e6 / city.props.size(), r.culled, 100.0 * r.culled / city.props.size(),
+                    r.mismatch ? "  MISMATCH" : "", r.falseCulls ? "  FALSE CULLS" : "");
+                if (r.falseCulls)
+                    printf("        %zu visible boxes reported as occluded\n", r.falseCulls);
+                failed |= r.mismatch || r.falseCulls > 0;
+            }
+
+    jobs.Shutdown();
+
+    if (failed)
+    {
+        printf("FAILED: occlusion results disagree with the reference\n");
+        return 1;
+    }
+    return 0;
+}
@@ -63,8 +63,13 @@ int main()
     for (int y = 0; y < CUBES_Y; y++) {
         for (int z = 0; z < CUBES_Z; z++) {
             for (int x = 0; x < CUBES_X; x++) {
+                // One cube with geometry, every further cube shares its surface
+                // and material (CopyEntity), so the grid is drawn instanced
                 LPENTITY cube = nullptr;
-                CreateSimpleCube(&cube, material);
+                if (cubes.empty())
+                    CreateSimpleCube(&cube, material);
+                else
+                    Engine::CopyEntity(&cube, cubes.front());
 
                 // Position im Grid
                 float posX = (x - CUBES_X / 2.0f) * SPACING;
@@ -223,63 +228,64 @@ void CreateSimpleCube(LPENTITY* mesh, MATERIAL* material)
     LPSURFACE surface = nullptr;
     Engine::CreateSurface(&surface, *mesh);
 
-    // 8 Eckpunkte des Würfels
-    float size = 1.0f;
-    DirectX::XMFLOAT3 vertices[8] = {
-        {-size, -size, -size},  // 0
-        {-size, +size, -size},  // 1
-        {+size, +size, -size},  // 2
-        {+size, -size, -size},  // 3
-        {-size, -size, +size},  // 4
-        {-size, +size, +size},  // 5
-        {+size, +size, +size},  // 6
-        {+size, -size, +size}   // 7
+    // Build the cube data once, then only copy it per cube
+    struct CubeData
+    {
+        DirectX::XMFLOAT3 positions[24];
+        DirectX::XMFLOAT3 normals[24];
+        DirectX::XMFLOAT4 colors[24];
+        unsigned int indices[36];
+
+        CubeData()
+        {
+            // 8 Eckpunkte des Würfels
+            const float size = 1.0f;
+            const DirectX::XMFLOAT3 vertices[8] = {
+                {-size, -size, -size},  // 0
+                {-size, +size, -size},  // 1
+                {+size, +size, -size},  // 2
+                {+size, -size, -size},  // 3
+                {-size, -size, +size},  // 4
+                {-size, +size, +size},  // 5
+                {+size, +size, +size},  // 6
+                {+size, -size, +size}   // 7
+            };
+
+            // 6 sides, 4 vertices per side = 24 vertices (back face: winding flipped)
+            const int faces[6][4] = {
+                {0, 1, 2, 3},   // Front  (Z-)
+                {4, 7, 6, 5},   // Back   (Z+)
+                {0, 4, 5, 1},   // Left   (X-)
+                {3, 2, 6, 7},   // Right  (X+)
+                {0, 3, 7, 4},   // Bottom (Y-)
+                {1, 5, 6, 2}    // Top    (Y+)
+            };
+            const DirectX::XMFLOAT3 faceNormals[6] = {
+                {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}
+            };
+
+            for (int face = 0; face < 6; face++) {
+                for (int v = 0; v < 4; v++) {
+                    positions[face * 4 + v] = vertices[faces[face][v]];
+                    normals[face * 4 + v] = faceNormals[face];
+                    colors[face * 4 + v] = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+                }
+
+                // 2 triangles per side
+                const unsigned int offset = face * 4;
+                const unsigned int quad[6] = { 0, 1, 2, 0, 2, 3 };
+                for (int i = 0; i < 6; i++)
+                    indices[face * 6 + i] = offset + quad[i];
+            }
+        }
     };
+    static const CubeData cube;
 
-    // 6 Seiten, 4 Vertices pro Seite = 24 Vertices
-    // Front Face (Z-)
-    Engine::AddVertex(surface, vertices[0]); Engine::VertexNormal(surface, 0, 0, -1); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[1]); Engine::VertexNormal(surface, 0, 0, -1); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[2]); Engine::VertexNormal(surface, 0, 0, -1); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[3]); Engine::VertexNormal(surface, 0, 0, -1); Engine::VertexColor(surface, 255, 255, 255);
-
-    // Back Face (Z+)  <-- Winding gedreht
-    Engine::AddVertex(surface, vertices[4]); Engine::VertexNormal(surface, 0, 0, 1); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[7]); Engine::VertexNormal(surface, 0, 0, 1); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[6]); Engine::VertexNormal(surface, 0, 0, 1); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[5]); Engine::VertexNormal(surface, 0, 0, 1); Engine::VertexColor(surface, 255, 255, 255);
-
-    // Left Face (X-)
-    Engine::AddVertex(surface, vertices[0]); Engine::VertexNormal(surface, -1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[4]); Engine::VertexNormal(surface, -1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[5]); Engine::VertexNormal(surface, -1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[1]); Engine::VertexNormal(surface, -1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-
-    // Right Face (X+)
-    Engine::AddVertex(surface, vertices[3]); Engine::VertexNormal(surface, 1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[2]); Engine::VertexNormal(surface, 1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[6]); Engine::VertexNormal(surface, 1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[7]); Engine::VertexNormal(surface, 1, 0, 0); Engine::VertexColor(surface, 255, 255, 255);
-
-    // Bottom Face (Y-)
-    Engine::AddVertex(surface, vertices[0]); Engine::VertexNormal(surface, 0, -1, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[3]); Engine::VertexNormal(surface, 0, -1, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[7]); Engine::VertexNormal(surface, 0, -1, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[4]); Engine::VertexNormal(surface, 0, -1, 0); Engine::VertexColor(surface, 255, 255, 255);
-
-    // Top Face (Y+)
-    Engine::AddVertex(surface, vertices[1]); Engine::VertexNormal(surface, 0, 1, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[5]); Engine::VertexNormal(surface, 0, 1, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[6]); Engine::VertexNormal(surface, 0, 1, 0); Engine::VertexColor(surface, 255, 255, 255);
-    Engine::AddVertex(surface, vertices[2]); Engine::VertexNormal(surface, 0, 1, 0); Engine::VertexColor(surface, 255, 255, 255);
-
-    // Indices für alle 6 Seiten (2 Triangles pro Seite)
-    int offset = 0;
-    for (int face = 0; face < 6; face++) {
-        Engine::AddTriangle(surface, offset + 0, offset + 1, offset + 2);
-        Engine::AddTriangle(surface, offset + 0, offset + 2, offset + 3);
-        offset += 4;
-    }
+    // Bulk setters: one memcpy per stream instead of AddVertex/VertexNormal/VertexColor per vertex
+    Engine::SetSurfacePositions(surface, cube.positions, 24);
+    Engine::SetSurfaceNormals(surface, cube.normals, 24);
+    Engine::SetSurfaceColors(surface, cube.colors, 24);
+    Engine::SetSurfaceIndices(surface, cube.indices, 36);
 
     Engine::FillBuffer(surface);
 }
\ No newline at end of file
@@ -0,0 +1,261 @@
+// RaycastBenchmark.cpp
+//
+// Measures the triangle BVH (TriangleBVH) of a surface:
+//   - terrain (height field grid) and triangle soup with 8k .. 512k triangles
+//   - coherent rays: camera grid 256x144 (picking), as packets of 4 (2x2 pixels)
+//   - incoherent rays: random start and end points
+// Single ray and packet must return the same hits, part of the rays is also
+// checked against brute force (all triangles). On a mismatch exit code 1.
+// No window, no D3D11 - build as a console program.
+#include "TriangleBVH.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace DirectX;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+struct Geometry
+{
+    std::vector<XMFLOAT3> positions;
+    std::vector<unsigned int> indices;
+};
+
+static Geometry CreateTerrain(int side)
+{
+    Geometry g;
+    const float scale = 100.0f / side;
+    for (int z = 0; z <= side; ++z)
+        for (int x = 0; x <= side; ++x)
+        {
+            const float fx = x * scale - 50.0f, fz = z * scale - 50.0f;
+            g.positions.push_back(XMFLOAT3(fx, 4.0f * std::sin(fx * 0.15f) * std::cos(fz * 0.11f), fz));
+        }
+
+    for (int z = 0; z < side; ++z)
+        for (int x = 0; x < side; ++x)
+        {
+            const unsigned int i = z * (side + 1) + x;
+            const unsigned int quad[6] = { i, i + side + 1, i + side + 2, i, i + side + 2, i + 1 };
+            g.indices.insert(g.indices.end(), quad, quad + 6);
+        }
+    return g;
+}
+
+static Geometry CreateSoup(int count, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+    Geometry g;
+    for (int t = 0; t < count; ++t)
+    {
+        const XMFLOAT3 c(position(rng), position(rng) * 0.2f, position(rng));
+        for (int k = 0; k < 3; ++k)
+        {
+            g.positions.push_back(XMFLOAT3(c.x + offset(rng), c.y + offset(rng), c.z + offset(rng)));
+            g.indices.push_back(static_cast<unsigned int>(g.positions.size() - 1));
+        }
+    }
+    return g;
+}
+
+// The same test as TriangleBVH::Intersect, just over all triangles
+static TriangleHit BruteForce(const Geometry& g, const XMFLOAT3& o, const XMFLOAT3& d)
+{
+    TriangleHit hit;
+    for (size_t t = 0; t < g.indices.size() / 3; ++t)
+    {
+        const XMFLOAT3& v0 = g.positions[g.indices[t * 3]];
+        const XMFLOAT3& v1 = g.positions[g.indices[t * 3 + 1]];
+        const XMFLOAT3& v2 = g.positions[g.indices[t * 3 + 2]];
+        const XMFLOAT3 e1(v1.x - v0.x, v1.y - v0.y, v1.z - v0.z);
+        const XMFLOAT3 e2(v2.x - v0.x, v2.y - v0.y, v2.z - v0.z);
+
+        const float px = d.y * e2.z - d.z * e2.y;
+        const float py = d.z * e2.x - d.x * e2.z;
+        const float pz = d.x * e2.y - d.y * e2.x;
+        const float det = e1.x * px + e1.y * py + e1.z * pz;
+        if (det == 0.0f)
+            continue;
+        const float invDet = 1.0f / det;
+
+        const float sx = o.x - v0.x, sy = o.y - v0.y, sz = o.z - v0.z;
+        const float u = (sx * px + sy * py + sz * pz) * invDet;
+        if (!(u >= 0.0f && u <= 1.0f))
+            continue;
+
+        const float qx = sy * e1.z - sz * e1.y;
+        const float qy = sz * e1.x - sx * e1.z;
+        const float qz = sx * e1.y - sy * e1.x;
+        const float v = (d.x * qx + d.y * qy + d.z * qz) * invDet;
+        if (!(v >= 0.0f && u + v <= 1.0f))
+            continue;
+
+        const float dist = (e2.x * qx + e2.y * qy + e2.z * qz) * invDet;
+        if (dist >= 0.0f && dist < hit.distance)
+        {
+            hit.distance = dist;
+            hit.u = u;
+            hit.v = v;
+            hit.triangle = static_cast<uint32_t>(t);
+        }
+    }
+    return hit;
+}
+
+// If a ray hits exactly a shared edge, both triangles return the same
+// distance - which one is reported depends on the test order
+static bool SameHit(const TriangleHit& a, const TriangleHit& b)
+{
+    const bool hitA = a.triangle != TriangleBVH::NO_TRIANGLE;
+    const bool hitB = b.triangle != TriangleBVH::NO_TRIANGLE;
+    return hitA == hitB && (!hitA || a.distance == b.distance);
+}
+
+struct Result
+{
+    double build = 0.0;
+    double coherentSingle = 0.0, coherentPacket = 0.0;
+    double randomSingle = 0.0, randomPacket = 0.0;
+    double bruteRay = 0.0;          // ms per ray
+    size_t hits = 0, nodes = 0, memory = 0;
+    int depth = 0;
+    bool mismatch = false;
+};
+
+static Result Run(const Geometry& g, std::mt19937& rng)
+{
+    Result result;
+    TriangleBVH bvh;
+
+    auto b0 = Clock::now();
+    bvh.Build(g.positions.data(), g.positions.size(), g.indices.data(), g.indices.size());
+    result.build = Ms(b0, Clock::now());
+    result.nodes = bvh.GetNodeCount();
+    result.memory = bvh.GetMemoryUsage();
+    result.depth = bvh.GetDepth();
+
+    // Camera grid, ordered in 2x2 pixel blocks: every packet is spatially coherent
+    const int WIDTH = 256, HEIGHT = 144;
+    std::vector<XMFLOAT3> origins, directions;
+    const XMFLOAT3 eye(0.0f, 30.0f, -70.0f);
+    for (int by = 0; by < HEIGHT; by += 2)
+        for (int bx = 0; bx < WIDTH; bx += 2)
+            for (int i = 0; i < 4; ++i)
+            {
+                const float sx = ((bx + (i & 1)) / float(WIDTH) - 0.5f) * 1.6f;
+                const float sy = ((by + (i >> 1)) / float(HEIGHT) - 0.5f) * 0.9f;
+                origins.push_back(eye);
+                directions.push_back(XMFLOAT3(sx, sy - 0.4f, 1.0f));
+            }
+    const size_t coherentCount = origins.size();
+
+    std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+    for (size_t i = 0; i < coherentCount; ++i)
+    {
+        const XMFLOAT3 from(position(rng), position(rng) * 0.3f, position(rng));
+        const XMFLOAT3 to(position(rng), position(rng) * 0.1f, position(rng));
+        origins.push_back(from);
+        directions.push_back(XMFLOAT3(to.x - from.x, to.y - from.y, to.z - from.z));
+    }
+
+    std::vector<TriangleHit> single(origins.size()), packet(origins.size());
+
+    auto runSingle = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                single[i] = TriangleHit();
+                bvh.Intersect(origins[i], directions[i], single[i]);
+            }
+        };
+    auto runPacket = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i += 4)
+            {
+                RayPacket rays;
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    rays.Set(lane, origins[i + lane], directions[i + lane]);
+                    packet[i + lane] = TriangleHit();
+                }
+                bvh.Intersect4(rays, &packet[i]);
+            }
+        };
+
+    auto t0 = Clock::now();
+    runSingle(0, coherentCount);
+    auto t1 = Clock::now();
+    runPacket(0, coherentCount);
+    auto t2 = Clock::now();
+    runSingle(coherentCount, origins.size());
+    auto t3 = Clock::now();
+    runPacket(coherentCount, origins.size());
+    auto t4 = Clock::now();
+
+    result.coherentSingle = Ms(t0, t1);
+    result.coherentPacket = Ms(t1, t2);
+    result.randomSingle = Ms(t2, t3);
+    result.randomPacket = Ms(t3, t4);
+
+    for (size_t i = 0; i < origins.size(); ++i)
+    {
+        result.hits += single[i].triangle != TriangleBVH::NO_TRIANGLE ? 1 : 0;
+        result.mismatch |= !SameHit(single[i], packet[i]);
+    }
+
+    // Brute force only for every 97th ray (otherwise minutes at 512k triangles)
+    const size_t BRUTE_STEP = 97;
+    size_t bruteCount = 0;
+    auto f0 = Clock::now();
+    for (size_t i = 0; i < origins.size(); i += BRUTE_STEP, ++bruteCount)
+        result.mismatch |= !SameHit(BruteForce(g, origins[i], directions[i]), single[i]);
+    result.bruteRay = Ms(f0, Clock::now()) / bruteCount;
+    return result;
+}
+
+int main()
+{
+    const int TERRAIN_SIDES[] = { 64, 256, 512 };      // 8k, 131k, 524k triangles
+    const int SOUP_COUNTS[] = { 8192, 131072 };
+    const double RAYS = 256.0 * 144.0;
+
+    std::mt19937 rng(1234);
+    bool failed = false;
+
+    printf("%-8s %8s %8s %6s %6s %9s | %-23s | %-23s | %10s %s\n", "scene", "tris", "build", "depth", "MB",
+        "hits", "raster single/packet", "random single/packet", "brute/ray", "(Mrays/s)");
+
+    auto report = [&](const char* name, const Geometry& g)
+        {
+            const Result r = Run(g, rng);
+            printf("%-8s %8zu %6.1fms %6d %6.1f %9zu | %9.2f / %9.2f   | %9.2f / %9.2f   | %8.3fms%s\n",
+                name, g.indices.size() / 3, r.build, r.depth, r.memory / (1024.0 * 1024.0), r.hits,
+                RAYS / r.coherentSingle / 1000.0, RAYS / r.coherentPacket / 1000.0,
+                RAYS / r.randomSingle / 1000.0, RAYS / r.randomPacket / 1000.0,
+                r.bruteRay, r.mismatch ? "  MISMATCH" : "");
+            failed |= r.mismatch;
+        };
+
+    for (int side : TERRAIN_SIDES)
+        report("terrain", CreateTerrain(side));
+    for (int count : SOUP_COUNTS)
+        report("soup", CreateSoup(count, rng));
+
+    if (failed)
+    {
+        printf("FAILED: BVH, packet and brute force disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,211 @@
+// SceneTreeBenchmark.cpp
+//
+// Compares the scene tree (AABBTree) with brute force at 1k/10k/100k boxes:
+//   - Update:  10% of the boxes move per frame, 0.1% jump (teleport)
+//   - Frustum: camera inside the scene, brute force = Frustum::CullAABBs (SIMD, 4 boxes)
+//   - Box/sphere: 100 small queries per frame, brute force = loop over all boxes
+//
+// After the exact test both sides must return the same hits, otherwise the
+// program exits with code 1. No window, no D3D11 - build as a console program.
+#include "AABBTree.h"
+#include "Frustum.h"
+#include <DirectXCollision.h>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace DirectX;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+struct Result
+{
+    double build = 0.0, update = 0.0;
+    double frustumBrute = 0.0, frustumTree = 0.0;
+    double boxBrute = 0.0, boxTree = 0.0;
+    double sphereBrute = 0.0, sphereTree = 0.0;
+    size_t visible = 0;
+    int height = 0;
+    uint32_t rebuilds = 0;
+    bool mismatch = false;
+};
+
+static Result RunScene(int count, int frames)
+{
+    Result result;
+    std::mt19937 rng(1234);
+
+    // Same density at every count: the cube edge grows with cbrt(count)
+    const float side = 4.0f * std::cbrt(static_cast<float>(count));
+    std::uniform_real_distribution<float> position(-side * 0.5f, side * 0.5f);
+    std::uniform_real_distribution<float> extent(0.5f, 1.5f);
+    std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+
+    std::vector<BoundingBox> boxes(count);
+    std::vector<uint32_t> proxies(count);
+    for (auto& box : boxes)
+        box = BoundingBox(XMFLOAT3(position(rng), position(rng), position(rng)),
+            XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+
+    AABBTree tree;
+    auto t0 = Clock::now();
+    for (int i = 0; i < count; ++i)
+        proxies[i] = tree.CreateProxy(boxes[i], &boxes[i]);
+    tree.RebuildIfDegraded();
+    result.build = Ms(t0, Clock::now());
+
+    BoundsSoA bounds;
+    bounds.Reserve(count);
+    std::vector<uint8_t> visible(count);
+    std::vector<uint8_t> proxyFlags;
+
+    const float aspect = 16.0f / 9.0f;
+    const XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, aspect, 0.1f, side * 0.5f);
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        // ---- Update: change the bounds, follow up in the tree ----
+        auto u0 = Clock::now();
+        for (int i = frame % 10; i < count; i += 10)
+        {
+            BoundingBox& box = boxes[i];
+            if ((i / 10 + frame) % 100 == 0)
+                box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+            else
+                box.Center = XMFLOAT3(box.Center.x + step(rng), box.Center.y + step(rng), box.Center.z + step(rng));
+
+            if (tree.NeedsMove(proxies[i], box))
+                tree.MoveProxy(proxies[i], box);
+        }
+        tree.RebuildIfDegraded();
+        result.update += Ms(u0, Clock::now());
+
+        // ---- Frustum: camera turns in the center ----
+        const float angle = frame * 0.05f;
+        const XMMATRIX view = XMMatrixLookToLH(XMVectorZero(),
+            XMVectorSet(std::sin(angle), 0.0f, std::cos(angle), 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        Frustum frustum;
+        frustum.ExtractFromMatrix(XMMatrixMultiply(view, projection));
+
+        // SoA as in the RenderManager (BuildCandidates), not measured
+        bounds.Clear();
+        for (const auto& box : boxes)
+            bounds.Add(box.Center, box.Extents);
+
+        auto f0 = Clock::now();
+        frustum.CullAABBs(bounds, 0, count, visible.data());
+        auto f1 = Clock::now();
+
+        size_t treeVisible = 0;
+        proxyFlags.assign(tree.GetNodeCapacity(), 0);
+        tree.QueryFrustum(frustum, [&](uint32_t proxy, bool inside)
+            {
+                const BoundingBox* box = static_cast<const BoundingBox*>(tree.GetUserData(proxy));
+                if (inside || frustum.IntersectsAABB(box->Center, box->Extents))
+                {
+                    proxyFlags[proxy] = 1;
+                    ++treeVisible;
+                }
+            });
+        auto f2 = Clock::now();
+
+        result.frustumBrute += Ms(f0, f1);
+        result.frustumTree += Ms(f1, f2);
+        result.visible = treeVisible;
+
+        // Check with the scalar test (CullAABBs uses FMA, edge cases may differ)
+        for (int i = 0; i < count; ++i)
+            result.mismatch |= frustum.IntersectsAABB(boxes[i].Center, boxes[i].Extents) != (proxyFlags[proxies[i]] != 0);
+
+        // ---- Box and sphere queries ----
+        std::vector<BoundingBox> queries(100);
+        for (auto& query : queries)
+            query = BoundingBox(XMFLOAT3(position(rng), position(rng), position(rng)), XMFLOAT3(3.0f, 3.0f, 3.0f));
+
+        size_t bruteHits = 0, treeHits = 0;
+        auto b0 = Clock::now();
+        for (const auto& query : queries)
+            for (const auto& box : boxes)
+                bruteHits += box.Intersects(query) ? 1 : 0;
+        auto b1 = Clock::now();
+        for (const auto& query : queries)
+            tree.QueryBox(query, [&](uint32_t proxy)
+                {
+                    treeHits += static_cast<const BoundingBox*>(tree.GetUserData(proxy))->Intersects(query) ? 1 : 0;
+                });
+        auto b2 = Clock::now();
+        result.boxBrute += Ms(b0, b1);
+        result.boxTree += Ms(b1, b2);
+        result.mismatch |= bruteHits != treeHits;
+
+        bruteHits = treeHits = 0;
+        auto s0 = Clock::now();
+        for (const auto& query : queries)
+        {
+            const BoundingSphere sphere(query.Center, 3.0f);
+            for (const auto& box : boxes)
+                bruteHits += box.Intersects(sphere) ? 1 : 0;
+        }
+        auto s1 = Clock::now();
+        for (const auto& query : queries)
+        {
+            const BoundingSphere sphere(query.Center, 3.0f);
+            tree.QuerySphere(sphere, [&](uint32_t proxy)
+                {
+                    treeHits += static_cast<const BoundingBox*>(tree.GetUserData(proxy))->Intersects(sphere) ? 1 : 0;
+                });
+        }
+        auto s2 = Clock::now();
+        result.sphereBrute += Ms(s0, s1);
+        result.sphereTree += Ms(s1, s2);
+        result.mismatch |= bruteHits != treeHits;
+    }
+
+    result.update /= frames;
+    result.frustumBrute /= frames;
+    result.frustumTree /= frames;
+    result.boxBrute /= frames;
+    result.boxTree /= frames;
+    result.sphereBrute /= frames;
+    result.sphereTree /= frames;
+    result.height = tree.GetHeight();
+    result.rebuilds = tree.GetRebuildCount();
+    return result;
+}
+
+int main()
+{
+    const int COUNTS[] = { 1000, 10000, 100000 };
+    const int FRAMES = 20;
+
+    printf("%8s %9s %9s | %-19s | %-19s | %-19s | %6s %8s\n", "boxes", "build", "update",
+        "frustum brute/tree", "100 box brute/tree", "100 sph brute/tree", "height", "rebuilds");
+
+    bool failed = false;
+    for (int count : COUNTS)
+    {
+        const Result r = RunScene(count, FRAMES);
+        printf("%8d %7.2fms %7.3fms | %7.3f / %7.3fms | %7.2f / %7.3fms | %7.2f / %7.3fms | %6d %8u%s\n",
+            count, r.build, r.update,
+            r.frustumBrute, r.frustumTree,
+            r.boxBrute, r.boxTree,
+            r.sphereBrute, r.sphereTree,
+            r.height, r.rebuilds, r.mismatch ? "  MISMATCH" : "");
+        failed |= r.mismatch;
+    }
+
+    if (failed)
+    {
+        printf("FAILED: tree and brute force disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,513 @@
+// StreamingBenchmark.cpp
+//
+// Measures frame times while loading a level: 8 textures 1024x1024 and 24 textures
+// 512x512 (PNG, decoded with stb_image) plus 8 cooked meshes (MeshFile, 64K vertices).
+// Simulates 60 Hz with 2 ms of game work per frame; the level is requested in
+// frame 10. The "upload" copies the pixels/streams into system memory, like the initial data
+// of CreateTexture2D/CreateBuffer.
+//   - sync:   load everything in the frame of the request (like LoadTexture/LoadMesh)
+//   - async:  AssetLoader, upload without a budget
+//   - async:  AssetLoader, 8 MB upload per frame (engine default)
+// Prints the longest frame, frames over 16.7 ms and the time until everything is loaded.
+//
+// Checked: pixels and streams after streaming byte for byte as loaded synchronously,
+// the placeholder stays bound until the upload, the budget is kept (unless a single
+// request is larger), missing/truncated files end as Failed, Shutdown
+// with open requests discards them, without loader threads Submit loads immediately.
+// On errors exit code 1.
+//
+// Usage: StreamingBenchmark [output directory]  (default: working directory)
+// No window, no D3D11 - build as a console program.
+#include "AssetLoader.h"
+#include "MeshFile.h"
+#include "../third_party/stb_image.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static bool g_failed = false;
+
+static void Check(bool condition, const char* what)
+{
+    if (!condition) {
+        printf("  CHECK FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static bool WriteFile(const std::string& path, const void* data, size_t size)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+// ==================== TEST DATA ====================
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBE(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(uint8_t(value >> shift));
+}
+
+static void PutChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+    PutBE(out, static_cast<uint32_t>(data.size()));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBE(out, Crc32(out.data() + start, out.size() - start));
+}
+
+// RGBA8 PNG with the Sub filter and uncompressed deflate blocks: stb_image must unfilter
+// every row, the file size matches the pixels
+static std::vector<uint8_t> EncodePng(const std::vector<uint8_t>& rgba, int width, int height)
+{
+    std::vector<uint8_t> raw;
+    raw.reserve(size_t(width * 4 + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = rgba.data() + size_t(y) * width * 4;
+        raw.push_back(1);
+        for (int x = 0; x < width * 4; ++x)
+            raw.push_back(uint8_t(row[x] - (x >= 4 ? row[x - 4] : 0)));
+    }
+
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+        const size_t length = (std::min)(raw.size() - offset, size_t(65535));
+        zlib.push_back(offset + length == raw.size() ? 1 : 0);
+        zlib.push_back(uint8_t(length));
+        zlib.push_back(uint8_t(length >> 8));
+        zlib.push_back(uint8_t(~length));
+        zlib.push_back(uint8_t(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t value : raw) {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBE(zlib, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    PutBE(ihdr, width);
+    PutBE(ihdr, height);
+    ihdr.insert(ihdr.end(), { 8, 6, 0, 0, 0 });
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    PutChunk(png, "IHDR", ihdr);
+    PutChunk(png, "IDAT", zlib);
+    PutChunk(png, "IEND", {});
+    return png;
+}
+
+static std::vector<uint8_t> MakeImage(int width, int height, uint32_t seed)
+{
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    uint32_t state = seed * 747796405u + 1u;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            uint8_t* p = &rgba[(size_t(y) * width + x) * 4];
+            p[0] = uint8_t(x * 255 / width);
+            p[1] = uint8_t(y * 255 / height);
+            p[2] = uint8_t(seed * 37 + (state >> 28));
+            p[3] = 255;
+        }
+    }
+    return rgba;
+}
+
+// Grid n x n: positions, normals, UVs (separate streams), 32-bit indices
+static bool WriteMesh(const std::string& path, uint32_t n, float height)
+{
+    MeshFile::CookedSurface surface;
+    MeshFile::SurfaceRecord& record = surface.record;
+    record.vertexCount = n * n;
+    record.indexCount = (n - 1) * (n - 1) * 6;
+    record.attributes = 0x0B;           // position, normal, UV1 (value has no meaning for the file)
+    record.indexSize = 4;
+    record.alias = MeshFile::NO_ALIAS;
+    record.boxExtents[0] = record.boxExtents[2] = 0.5f * n;
+    record.boxExtents[1] = height;
+    record.sphereRadius = 0.75f * n;
+
+    std::vector<float> positions, normals, uvs;
+    for (uint32_t z = 0; z < n; ++z) {
+        for (uint32_t x = 0; x < n; ++x) {
+            positions.insert(positions.end(), { float(x) - 0.5f * n, height * float((x * 7 + z * 13) % 17) / 17.0f, float(z) - 0.5f * n });
+            normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+            uvs.insert(uvs.end(), { float(x) / n, float(z) / n });
+        }
+    }
+    std::vector<uint32_t> indices;
+    for (uint32_t z = 0; z + 1 < n; ++z) {
+        for (uint32_t x = 0; x + 1 < n; ++x) {
+            const uint32_t i = z * n + x;
+            indices.insert(indices.end(), { i, i + n, i + 1, i + 1, i + n, i + n + 1 });
+        }
+    }
+
+    auto setStream = [&](MeshFile::Stream stream, const void* data, size_t size, uint32_t stride) {
+        surface.streams[stream].assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        record.streams[stream].stride = stride;
+    };
+    setStream(MeshFile::STREAM_POSITION, positions.data(), positions.size() * sizeof(float), 12);
+    setStream(MeshFile::STREAM_NORMAL, normals.data(), normals.size() * sizeof(float), 12);
+    setStream(MeshFile::STREAM_UV1, uvs.data(), uvs.size() * sizeof(float), 8);
+    setStream(MeshFile::STREAM_INDEX, indices.data(), indices.size() * sizeof(uint32_t), 4);
+
+    MeshFile::Writer writer;
+    writer.SetMaterial("terrain");
+    writer.AddSurface(std::move(surface));
+    return writer.Save(path.c_str());
+}
+
+// ==================== "GPU" ====================
+
+// Stands for texture + view: the upload replaces the 1x1 placeholder
+struct GpuTexture
+{
+    int width = 1;
+    int height = 1;
+    std::vector<uint8_t> pixels = { 255, 255, 255, 255 };
+};
+
+struct GpuMesh
+{
+    std::vector<std::vector<uint8_t>> buffers;     // empty = placeholder, draws nothing
+};
+
+class TextureRequest : public AssetRequest
+{
+public:
+    TextureRequest(GpuTexture* texture, const std::string& path) : m_texture(texture), m_path(path) {}
+    ~TextureRequest() override { stbi_image_free(m_pixels); }
+
+    bool Load() override
+    {
+        int channels;
+        m_pixels = stbi_load(m_path.c_str(), &m_width, &m_height, &channels, 4);
+        if (!m_pixels)
+            error = m_path + ": " + stbi_failure_reason();
+        return m_pixels != nullptr;
+    }
+
+    size_t GetUploadBytes() const override { return size_t(m_width) * m_height * 4; }
+
+    bool Upload() override
+    {
+        m_texture->width = m_width;
+        m_texture->height = m_height;
+        m_texture->pixels.assign(m_pixels, m_pixels + GetUploadBytes());
+        return true;
+    }
+
+private:
+    GpuTexture* m_texture;
+    std::string m_path;
+    unsigned char* m_pixels = nullptr;
+    int m_width = 0;
+    int m_height = 0;
+};
+
+class MeshRequest : public AssetRequest
+{
+public:
+    MeshRequest(GpuMesh* mesh, const std::string& path) : m_mesh(mesh), m_path(path) {}
+
+    bool Load() override
+    {
+        if (!m_reader.Open(m_path.c_str())) {
+            error = m_path + ": " + m_reader.GetError();
+            return false;
+        }
+        uint8_t sum = 0;
+        for (size_t i = 0; i < m_reader.GetSize(); i += 4096)
+            sum += m_reader.GetData()[i];
+        m_touched = sum;
+        return true;
+    }
+
+    size_t GetUploadBytes() const override { return m_reader.GetSize(); }
+
+    bool Upload() override
+    {
+        for (uint32_t i = 0; i < m_reader.GetHeader().surfaceCount; ++i) {
+            const MeshFile::SurfaceRecord& record = m_reader.GetSurface(i);
+            for (uint32_t s = 0; s < MeshFile::STREAM_COUNT; ++s) {
+                const uint8_t* data = static_cast<const uint8_t*>(m_reader.GetStream(record, MeshFile::Stream(s)));
+                if (data)
+                    m_mesh->buffers.emplace_back(data, data + record.streams[s].size);
+            }
+        }
+        return true;
+    }
+
+private:
+    GpuMesh* m_mesh;
+    std::string m_path;
+    MeshFile::Reader m_reader;
+    uint8_t m_touched = 0;
+};
+
+// ==================== FRAMES ====================
+
+struct Level
+{
+    std::vector<std::string> textureFiles;
+    std::vector<std::string> meshFiles;
+};
+
+struct Result
+{
+    double maxFrame = 0.0;
+    int slowFrames = 0;
+    double loadMs = 0.0;
+    int loadFrames = 0;
+    std::vector<GpuTexture> textures;
+    std::vector<GpuMesh> meshes;
+};
+
+static const int LOAD_FRAME = 10;
+static const double FRAME_MS = 1000.0 / 60.0;
+static const double WORK_MS = 2.0;
+
+static void Work(Clock::time_point start)
+{
+    volatile uint32_t x = 0;
+    while (Ms(start, Clock::now()) < WORK_MS)
+        x = x + 1;
+}
+
+// async == false: everything in frame LOAD_FRAME; otherwise Submit there and Update in every frame
+static Result RunLevel(const Level& level, bool async, size_t budget)
+{
+    Result result;
+    result.textures.resize(level.textureFiles.size());
+    result.meshes.resize(level.meshFiles.size());
+
+    AssetLoader loader;
+    if (async)
+        loader.Init();
+
+    std::vector<AssetHandle> handles;
+    Clock::time_point requested;
+    bool loaded = false;
+
+    for (int frame = 0; frame < 2000 && !(loaded && frame > LOAD_FRAME + 30); ++frame) {
+        const Clock::time_point start = Clock::now();
+        Work(start);
+
+        if (frame == LOAD_FRAME) {
+            requested = start;
+            for (size_t i = 0; i < level.textureFiles.size(); ++i) {
+                std::unique_ptr<AssetRequest> request(new TextureRequest(&result.textures[i], level.textureFiles[i]));
+                if (async) {
+                    handles.push_back(loader.Submit(std::move(request)));
+                }
+                else {
+                    request->Load();
+                    request->Upload();
+                }
+            }
+            for (size_t i = 0; i < level.meshFiles.size(); ++i) {
+                std::unique_ptr<AssetRequest> request(new MeshRequest(&result.meshes[i], level.meshFiles[i]));
+                if (async) {
+                    handles.push_back(loader.Submit(std::move(request)));
+                }
+                else {
+                    request->Load();
+                    request->Upload();
+                }
+            }
+            if (async) {
+                Check(result.textures[0].width == 1 && result.meshes[0].buffers.empty(), "placeholder bound after submit");
+                Check(loader.GetState(handles[0]) == AssetState::Pending || loader.GetState(handles[0]) == AssetState::Loaded,
+                    "state after submit");
+            }
+        }
+
+        if (async) {
+            loader.Update(budget);
+            const AssetLoaderStats& stats = loader.GetStats();
+            Check(stats.uploadedFrame <= 1 || stats.bytesFrame <= budget, "upload budget");
+        }
+
+        const Clock::time_point end = Clock::now();
+        const double ms = Ms(start, end);
+        result.maxFrame = (std::max)(result.maxFrame, ms);
+        if (ms > FRAME_MS)
+            ++result.slowFrames;
+
+        if (frame >= LOAD_FRAME && !loaded && (!async || loader.GetPendingCount() == 0)) {
+            loaded = true;
+            result.loadMs = Ms(requested, end);
+            result.loadFrames = frame - LOAD_FRAME + 1;
+        }
+
+        // Sleep for the rest of the frame: the loader threads get the core
+        const double rest = FRAME_MS - Ms(start, Clock::now());
+        if (rest > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(rest));
+    }
+
+    for (AssetHandle handle : handles)
+        Check(loader.GetState(handle) == AssetState::Ready, "all requests ready");
+    loader.Shutdown();
+    return result;
+}
+
+static bool SameResult(const Result& a, const Result& b)
+{
+    for (size_t i = 0; i < a.textures.size(); ++i) {
+        if (a.textures[i].width != b.textures[i].width || a.textures[i].height != b.textures[i].height ||
+            a.textures[i].pixels != b.textures[i].pixels)
+            return false;
+    }
+    for (size_t i = 0; i < a.meshes.size(); ++i) {
+        if (a.meshes[i].buffers != b.meshes[i].buffers)
+            return false;
+    }
+    return true;
+}
+
+static void PrintRow(const char* name, const Result& result)
+{
+    printf("%-22s %9.1fms %8d %11.1fms %8d\n", name, result.maxFrame, result.slowFrames, result.loadMs, result.loadFrames);
+}
+
+// ==================== FAILURE CASES ====================
+
+static void CheckFailures(const Level& level, const std::string& dir)
+{
+    // Missing and truncated files: Failed with an error text, the placeholder stays
+    const std::string truncated = dir + "stream_truncated.gdxm";
+    {
+        FILE* file = fopen(level.meshFiles[0].c_str(), "rb");
+        std::vector<uint8_t> bytes(4096);
+        const size_t size = file ? fread(bytes.data(), 1, bytes.size(), file) : 0;
+        if (file)
+            fclose(file);
+        WriteFile(truncated, bytes.data(), size);
+    }
+
+    AssetLoader loader;
+    loader.Init(2);
+    GpuTexture texture;
+    GpuMesh mesh;
+    const AssetHandle missing = loader.Submit(std::unique_ptr<AssetRequest>(new TextureRequest(&texture, dir + "stream_missing.png")));
+    const AssetHandle cut = loader.Submit(std::unique_ptr<AssetRequest>(new MeshRequest(&mesh, truncated)));
+    Check(loader.Submit(nullptr) == INVALID_ASSET, "submit without request");
+    loader.Flush();
+    Check(loader.GetState(missing) == AssetState::Failed && loader.GetError(missing)[0] != 0, "missing file fails");
+    Check(loader.GetState(cut) == AssetState::Failed && loader.GetError(cut)[0] != 0, "truncated mesh fails");
+    Check(texture.width == 1 && mesh.buffers.empty(), "placeholder kept on failure");
+    Check(loader.GetState(12345) == AssetState::Unknown, "unknown handle");
+    Check(loader.GetStats().failed == 2 && loader.GetPendingCount() == 0, "failure stats");
+
+    // Shutdown with open requests: discarded, no upload
+    std::vector<GpuTexture> textures(level.textureFiles.size());
+    std::vector<AssetHandle> handles;
+    for (size_t i = 0; i < textures.size(); ++i)
+        handles.push_back(loader.Submit(std::unique_ptr<AssetRequest>(new TextureRequest(&textures[i], level.textureFiles[i]))));
+    loader.Shutdown();
+    bool cancelled = loader.GetPendingCount() == 0;
+    for (size_t i = 0; i < handles.size(); ++i)
+        cancelled = cancelled && loader.GetState(handles[i]) == AssetState::Failed && textures[i].width == 1;
+    Check(cancelled, "shutdown cancels pending requests");
+
+    // Without loader threads: Load right in Submit, upload in the next Update
+    GpuTexture direct;
+    const AssetHandle handle = loader.Submit(std::unique_ptr<AssetRequest>(new TextureRequest(&direct, level.textureFiles[0])));
+    Check(loader.GetState(handle) == AssetState::Pending && direct.width == 1, "no threads: upload waits for Update");
+    loader.Update(1);
+    Check(loader.GetState(handle) == AssetState::Ready && direct.width == 1024, "no threads: ready after Update");
+
+    remove(truncated.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    std::string dir = argc > 1 ? argv[1] : "";
+    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\')
+        dir += '/';
+
+    Level level;
+    bool written = true;
+    for (int i = 0; i < 32; ++i) {
+        const int size = i < 8 ? 1024 : 512;
+        const std::string path = dir + "stream_" + std::to_string(i) + ".png";
+        const std::vector<uint8_t> png = EncodePng(MakeImage(size, size, i), size, size);
+        written = written && WriteFile(path, png.data(), png.size());
+        level.textureFiles.push_back(path);
+    }
+    for (int i = 0; i < 8; ++i) {
+        const std::string path = dir + "stream_" + std::to_string(i) + ".gdxm";
+        written = written && WriteMesh(path, 256, 4.0f + i);
+        level.meshFiles.push_back(path);
+    }
+    if (!written) {
+        printf("FAILED: cannot write the test files to '%s'\n", dir.empty() ? "." : dir.c_str());
+        return 1;
+    }
+
+    printf("%zu textures, %zu meshes, %.0f ms work per %.1f ms frame, %u hardware threads\n",
+        level.textureFiles.size(), level.meshFiles.size(), WORK_MS, FRAME_MS, std::thread::hardware_concurrency());
+    printf("%-22s %11s %8s %13s %8s\n", "mode", "max frame", ">16.7ms", "load time", "frames");
+
+    const Result sync = RunLevel(level, false, 0);
+    PrintRow("sync", sync);
+    const Result unlimited = RunLevel(level, true, SIZE_MAX);
+    PrintRow("async (no budget)", unlimited);
+    const Result budgeted = RunLevel(level, true, 8u << 20);
+    PrintRow("async (8 MB/frame)", budgeted);
+
+    Check(SameResult(sync, unlimited), "async (no budget) == sync");
+    Check(SameResult(sync, budgeted), "async (8 MB/frame) == sync");
+    Check(sync.textures[0].width == 1024 && sync.textures[8].width == 512 && sync.meshes[0].buffers.size() == 4,
+        "sync loaded the level");
+
+    CheckFailures(level, dir);
+
+    for (const std::string& path : level.textureFiles)
+        remove(path.c_str());
+    for (const std::string& path : level.meshFiles)
+        remove(path.c_str());
+
+    if (g_failed) {
+        printf("FAILED: streamed assets disagree with the synchronous load\n");
+        return 1;
+    }
+    return 0;
+}
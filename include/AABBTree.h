@@ -0,0 +1,322 @@
+#pragma once
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Frustum.h"
+
+// ============================================================
+// AABBTree - dynamic BVH over world AABBs (scene index)
+//
+// Leaves hold a "fat" AABB (box + margin). As long as the real box
+// stays inside it, a move costs nothing (NeedsMove() == false).
+// When it leaves the margin:
+//   - box overlaps the old fat AABB: reset the leaf and adjust the
+//     parents up to the root (refit, O(depth), structure stays)
+//   - otherwise (teleport): remove the leaf and insert it again
+// Insertion looks for the sibling with the smallest area growth and
+// balances by rotation (AVL, like Box2D b2DynamicTree).
+//
+// Refits degrade the tree over time. The SAH cost (sum of the
+// internal areas / root area) is tracked; RebuildIfDegraded()
+// rebuilds top-down with binned SAH after 50% degradation or many
+// inserts/removals. Proxy ids (leaves) stay the same.
+//
+// Queries report leaves whose fat AABB hits; the exact test against
+// the real box is up to the caller (e.g. ObjectManager::QueryBox).
+// ============================================================
+
+class AABBTree
+{
+public:
+    static constexpr uint32_t NULL_NODE = 0xFFFFFFFFu;
+
+    AABBTree();
+
+    // Margin per axis: absolute + relative * extents of the box
+    void SetFatMargin(float absolute, float relative);
+
+    uint32_t CreateProxy(const DirectX::BoundingBox& box, void* userData);
+    void DestroyProxy(uint32_t proxy);
+
+    // Is box no longer inside the fat AABB? Read-only, may run in parallel
+    bool NeedsMove(uint32_t proxy, const DirectX::BoundingBox& box) const;
+
+    // Reset the fat AABB from box (refit or reinsert, see above)
+    void MoveProxy(uint32_t proxy, const DirectX::BoundingBox& box);
+
+    // Top-down SAH rebuild of all leaves
+    void Rebuild();
+    // Rebuild when the tree has degraded a lot since the last rebuild
+    bool RebuildIfDegraded();
+    void Clear();
+
+    void* GetUserData(uint32_t proxy) const { return m_nodes[proxy].userData; }
+    DirectX::BoundingBox GetFatBox(uint32_t proxy) const;
+    uint32_t GetProxyCount() const { return m_proxyCount; }
+    // Upper bound of all proxy ids (for arrays indexed by proxy)
+    uint32_t GetNodeCapacity() const { return static_cast<uint32_t>(m_nodes.size()); }
+    int GetHeight() const { return m_root == NULL_NODE ? 0 : m_nodes[m_root].height; }
+    // SAH cost: sum of the internal node areas / root area
+    float GetCost() const;
+    uint32_t GetRebuildCount() const { return m_rebuildCount; }
+
+    // fn(proxy) for every leaf whose fat AABB intersects box
+    template<typename Func>
+    void QueryBox(const DirectX::BoundingBox& box, Func&& fn) const;
+
+    // fn(proxy) for every leaf whose fat AABB intersects the sphere
+    template<typename Func>
+    void QuerySphere(const DirectX::BoundingSphere& sphere, Func&& fn) const;
+
+    // fn(proxy) for every leaf whose fat AABB the ray origin + t * direction
+    // hits with t in [0, maxDistance] (slab test, direction need not be normalized)
+    template<typename Func>
+    void QueryRay(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance, Func&& fn) const;
+
+    // fn(proxy, inside) for every leaf in the frustum. Hierarchical: planes that fully
+    // contain a node are no longer tested for its children.
+    // inside = fat AABB completely in the frustum (exact test unnecessary)
+    template<typename Func>
+    void QueryFrustum(const Frustum& frustum, Func&& fn) const;
+
+private:
+    struct Node
+    {
+        DirectX::XMFLOAT3 lower;
+        DirectX::XMFLOAT3 upper;
+        uint32_t parent;        // free: next node of the free list
+        uint32_t child1;
+        uint32_t child2;
+        int32_t height;         // leaf 0, free -1
+        void* userData;
+
+        bool IsLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    // DFS stack: STACK_CAPACITY entries without heap, std::vector beyond that.
+    // Depth <= tree height + 1, the fallback practically never kicks in.
+    static constexpr size_t STACK_CAPACITY = 256;
+
+    template<typename T>
+    struct TraversalStack
+    {
+        T fixed[STACK_CAPACITY];
+        std::vector<T> overflow;
+        size_t count = 0;
+
+        void Push(const T& value)
+        {
+            if (count < STACK_CAPACITY) fixed[count] = value;
+            else overflow.push_back(value);
+            ++count;
+        }
+
+        T Pop()
+        {
+            --count;
+            if (count < STACK_CAPACITY)
+                return fixed[count];
+            T value = overflow.back();
+            overflow.pop_back();
+            return value;
+        }
+
+        bool Empty() const { return count == 0; }
+    };
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t node);
+    void InsertLeaf(uint32_t leaf);
+    void RemoveLeaf(uint32_t leaf);
+    uint32_t Balance(uint32_t node);
+    void RefitParents(uint32_t node);
+
+    // Set a node's box, internal nodes keep m_internalArea up to date
+    void SetBox(uint32_t node, const DirectX::XMFLOAT3& lower, const DirectX::XMFLOAT3& upper);
+    void SetUnion(uint32_t node, uint32_t a, uint32_t b);
+    void FattenBox(const DirectX::BoundingBox& box, DirectX::XMFLOAT3& lower, DirectX::XMFLOAT3& upper) const;
+
+    // Leaf in the SAH build: box and centroid packed, without going through m_nodes
+    struct BuildItem
+    {
+        DirectX::XMFLOAT3 lower;
+        DirectX::XMFLOAT3 upper;
+        DirectX::XMFLOAT3 centroid;
+        uint32_t leaf;
+    };
+
+    uint32_t BuildRange(BuildItem* items, size_t count);
+
+    std::vector<Node> m_nodes;
+    uint32_t m_root;
+    uint32_t m_freeList;
+    uint32_t m_proxyCount;
+
+    float m_marginAbsolute;
+    float m_marginRelative;
+
+    double m_internalArea;              // sum of the areas of all internal nodes
+    float m_rebuildCost;                // GetCost() right after the last rebuild
+    uint32_t m_proxiesAtRebuild;
+    uint32_t m_structureChanges;        // Create/Destroy since the last rebuild
+    uint32_t m_rebuildCount;
+
+    std::vector<BuildItem> m_buildItems;
+};
+
+template<typename Func>
+void AABBTree::QueryBox(const DirectX::BoundingBox& box, Func&& fn) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    const DirectX::XMFLOAT3 lower(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+    const DirectX::XMFLOAT3 upper(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+
+    TraversalStack<uint32_t> stack;
+    stack.Push(m_root);
+
+    while (!stack.Empty())
+    {
+        const uint32_t index = stack.Pop();
+        const Node& node = m_nodes[index];
+
+        if (node.upper.x < lower.x || node.lower.x > upper.x ||
+            node.upper.y < lower.y || node.lower.y > upper.y ||
+            node.upper.z < lower.z || node.lower.z > upper.z)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            fn(index);
+            continue;
+        }
+
+        stack.Push(node.child1);
+        stack.Push(node.child2);
+    }
+}
+
+template<typename Func>
+void AABBTree::QuerySphere(const DirectX::BoundingSphere& sphere, Func&& fn) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    const DirectX::XMFLOAT3& c = sphere.Center;
+    const float radiusSq = sphere.Radius * sphere.Radius;
+
+    TraversalStack<uint32_t> stack;
+    stack.Push(m_root);
+
+    while (!stack.Empty())
+    {
+        const uint32_t index = stack.Pop();
+        const Node& node = m_nodes[index];
+
+        // Distance² from the sphere center to the nearest point of the box
+        const float dx = c.x < node.lower.x ? node.lower.x - c.x : (c.x > node.upper.x ? c.x - node.upper.x : 0.0f);
+        const float dy = c.y < node.lower.y ? node.lower.y - c.y : (c.y > node.upper.y ? c.y - node.upper.y : 0.0f);
+        const float dz = c.z < node.lower.z ? node.lower.z - c.z : (c.z > node.upper.z ? c.z - node.upper.z : 0.0f);
+        if (dx * dx + dy * dy + dz * dz > radiusSq)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            fn(index);
+            continue;
+        }
+
+        stack.Push(node.child1);
+        stack.Push(node.child2);
+    }
+}
+
+template<typename Func>
+void AABBTree::QueryRay(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance, Func&& fn) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    // Axis without a direction component: a large finite number instead of inf, (lower - origin) * inv never becomes NaN
+    auto inverse = [](float d) { return std::fabs(d) > 1e-20f ? 1.0f / d : (d >= 0.0f ? 1e20f : -1e20f); };
+    const float ix = inverse(direction.x);
+    const float iy = inverse(direction.y);
+    const float iz = inverse(direction.z);
+
+    TraversalStack<uint32_t> stack;
+    stack.Push(m_root);
+
+    while (!stack.Empty())
+    {
+        const uint32_t index = stack.Pop();
+        const Node& node = m_nodes[index];
+
+        const float x0 = (node.lower.x - origin.x) * ix, x1 = (node.upper.x - origin.x) * ix;
+        const float y0 = (node.lower.y - origin.y) * iy, y1 = (node.upper.y - origin.y) * iy;
+        const float z0 = (node.lower.z - origin.z) * iz, z1 = (node.upper.z - origin.z) * iz;
+        const float tNear = (std::max)((std::max)((std::min)(x0, x1), (std::min)(y0, y1)), (std::max)((std::min)(z0, z1), 0.0f));
+        const float tFar = (std::min)((std::min)((std::max)(x0, x1), (std::max)(y0, y1)), (std::min)((std::max)(z0, z1), maxDistance));
+        if (tNear > tFar)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            fn(index);
+            continue;
+        }
+
+        stack.Push(node.child1);
+        stack.Push(node.child2);
+    }
+}
+
+template<typename Func>
+void AABBTree::QueryFrustum(const Frustum& frustum, Func&& fn) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    struct Entry
+    {
+        uint32_t node;
+        uint32_t planes;    // planes still to test (one bit per plane)
+    };
+
+    TraversalStack<Entry> stack;
+    stack.Push({ m_root, Frustum::ALL_PLANES });
+
+    while (!stack.Empty())
+    {
+        const Entry entry = stack.Pop();
+        const Node& node = m_nodes[entry.node];
+        uint32_t planes = entry.planes;
+
+        if (planes != 0)
+        {
+            const DirectX::XMFLOAT3 center(
+                (node.lower.x + node.upper.x) * 0.5f,
+                (node.lower.y + node.upper.y) * 0.5f,
+                (node.lower.z + node.upper.z) * 0.5f);
+            const DirectX::XMFLOAT3 extents(
+                (node.upper.x - node.lower.x) * 0.5f,
+                (node.upper.y - node.lower.y) * 0.5f,
+                (node.upper.z - node.lower.z) * 0.5f);
+
+            if (frustum.ClassifyAABB(center, extents, planes) == FrustumTest::Outside)
+                continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            fn(entry.node, planes == 0);
+            continue;
+        }
+
+        stack.Push({ node.child1, planes });
+        stack.Push({ node.child2, planes });
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================
+// AssetLoader - load textures and meshes in the background
+//
+// Per request (AssetRequest):
+//   1. Submit (main thread): returns a handle right away, the caller has already
+//      bound its placeholder (1x1 texture, empty mesh)
+//   2. Load (loader thread): read the file, decode/validate - no D3D
+//   3. finished requests go into a lock-free list (loader threads
+//      push, only the main thread takes them out as a whole)
+//   4. Update (main thread, once per frame): upload the finished requests
+//      until the frame's byte budget is used up; the rest waits for
+//      the next frame. The upload replaces the placeholder.
+//
+// Own threads instead of the JobSystem: JobSystem::Wait runs foreign jobs,
+// so a decode job of several milliseconds would end up in the frame.
+// The loader threads run at a lower priority.
+//
+// Submit, Update, Flush, GetState, Release: main thread only.
+// ============================================================
+
+typedef uint32_t AssetHandle;
+constexpr AssetHandle INVALID_ASSET = 0;
+
+enum class AssetState : uint8_t
+{
+    Unknown,    // handle never issued
+    Pending,    // waiting for / running in Load
+    Loaded,     // decoded, waiting for upload budget
+    Ready,      // uploaded, placeholder replaced
+    Failed      // Load/Upload failed or cancelled, the placeholder stays
+};
+
+class AssetRequest
+{
+public:
+    virtual ~AssetRequest() = default;
+
+    // Loader thread: read and decode the file. false = error (set error)
+    virtual bool Load() = 0;
+
+    // Main thread, after a successful Load: bytes Upload writes to the GPU
+    virtual size_t GetUploadBytes() const = 0;
+
+    // Main thread: create the GPU resources and replace the placeholder. false = error
+    virtual bool Upload() = 0;
+
+    // Main thread: Load or Upload failed, the request is deleted afterwards
+    virtual void Fail() {}
+
+    std::string error;
+};
+
+struct AssetLoaderStats
+{
+    size_t pending = 0;             // submitted, not yet Ready/Failed
+    size_t uploadedFrame = 0;       // requests in the last Update
+    size_t bytesFrame = 0;          // upload bytes in the last Update
+    size_t uploaded = 0;            // in total
+    size_t failed = 0;
+    uint64_t bytes = 0;
+};
+
+class AssetLoader
+{
+public:
+    AssetLoader();
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // threadCount 0 = 2 (I/O + decoding, the cores belong to the JobSystem)
+    void Init(unsigned int threadCount = 0);
+
+    // Stop the threads; unfinished requests are discarded (Failed, without upload)
+    void Shutdown();
+
+    // Without Init: Load runs immediately on the calling thread, upload in the next Update
+    AssetHandle Submit(std::unique_ptr<AssetRequest> request);
+
+    // Upload finished requests until budgetBytes is reached. At least one request per
+    // call, even if it alone is larger than the budget. Returns the uploaded bytes.
+    size_t Update(size_t budgetBytes);
+
+    // Blocks until all requests are Ready/Failed (loading screen). The main thread
+    // helps loading meanwhile, uploads without a budget.
+    void Flush();
+
+    AssetState GetState(AssetHandle handle) const;
+    const char* GetError(AssetHandle handle) const;    // "" without an error
+
+    // State and error of a handle are kept until Release (one entry per Submit). Afterwards
+    // GetState returns Unknown. A pending handle is dropped as soon as it is Ready/Failed.
+    void Release(AssetHandle handle);
+
+    const AssetLoaderStats& GetStats() const { return m_stats; }
+    size_t GetPendingCount() const { return m_stats.pending; }
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_threads.size()); }
+
+private:
+    struct Job
+    {
+        AssetHandle handle;
+        std::unique_ptr<AssetRequest> request;
+        bool loaded;
+        Job* next;
+    };
+
+    void WorkerLoop();
+    void RunLoad(Job* job);
+    void PushCompleted(Job* job);
+    void CollectCompleted();
+    void Finish(Job* job, bool uploaded);
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Job*> m_queue;               // waiting for Load (m_mutex)
+    bool m_stop;
+
+    std::atomic<Job*> m_completed;          // lock-free stack, loader threads -> main thread
+    std::deque<Job*> m_ready;               // main thread: loaded, in order of completion
+
+    AssetHandle m_nextHandle;
+    std::unordered_map<AssetHandle, AssetState> m_states;
+    std::unordered_map<AssetHandle, std::string> m_errors;
+    std::unordered_set<AssetHandle> m_released;     // Release while pending
+    AssetLoaderStats m_stats;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class JobSystem;
+
+// ============================================================
+// BlockCompressor - BC1/BC3/BC7 encoder for RGBA8 on the CPU (no D3D)
+//
+// Every 4x4 block is encoded on its own (edge blocks padded with repeated
+// edge pixels, also for 2x2 and 1x1 mips):
+//   BC1 (8 bytes):  RGB 565, 4 colors on a line, no alpha
+//   BC3 (16 bytes): BC1 color block + alpha with 8 levels between two end values
+//   BC7 (16 bytes): mode 6 only - RGBA endpoints 7 bit + p-bit, 16 levels.
+//                   One subset, but alpha and color together; clearly
+//                   fewer block artifacts than BC1/BC3
+//
+// Endpoints: principal axis of the block colors (covariance, power method, XMVECTOR),
+// projection onto the axis, then least squares twice over the
+// chosen indices; the smallest error after quantizing wins.
+//
+// jobs: block rows in parallel, the result is bit-identical with and without jobs.
+// ============================================================
+
+namespace BlockCompressor
+{
+    enum class Format : uint32_t
+    {
+        BC1,
+        BC3,
+        BC7
+    };
+
+    // Bytes per 4x4 block (8 or 16)
+    size_t BlockBytes(Format format);
+
+    // Row pitch and size of a level (at least one block in each direction)
+    size_t RowPitch(Format format, uint32_t width);
+    size_t CompressedSize(Format format, uint32_t width, uint32_t height);
+
+    // rgba: width * height * 4 bytes without gaps; out: CompressedSize bytes
+    void Compress(const uint8_t* rgba, uint32_t width, uint32_t height, Format format, uint8_t* out,
+        JobSystem* jobs = nullptr);
+
+    // Back to RGBA8 (checks, preview). BC7: mode 6 only, other modes turn black.
+    void Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, Format format, uint8_t* rgba);
+
+    // true if all pixels have alpha 255 (BC1 is enough)
+    bool IsOpaque(const uint8_t* rgba, size_t pixelCount);
+}
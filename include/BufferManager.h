@@ -1,20 +1,20 @@
 #pragma once
 
-#include <d3d11.h>
+#include "gdxplatform.h"
 #include <vector>
 #include "gdxutil.h"
+#include "gdxdevice.h"
 #include "ObjectManager.h"
 
 class BufferManager
 {
 private:
-    ID3D11Device* m_device;
-    ID3D11DeviceContext* m_context;
+    const GDXDevice* m_device;
 
 public:
     BufferManager(); 
         
-    void Init(ID3D11Device* device, ID3D11DeviceContext* context);
+    void Init(const GDXDevice* device);
     
     HRESULT CreateBuffer(const void* data, UINT size, UINT count, D3D11_BIND_FLAG bindFlags, ID3D11Buffer** buffer);
 
@@ -19,7 +19,7 @@ public:
     };
 
 public:
-    Camera();
+    explicit Camera(TransformSystem& transformSystem);
     ~Camera();
 
     // UpdateCamera ist Camera-spezifisch
@@ -0,0 +1,172 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include "Mesh.h"
+
+class AABBTree;
+class JobSystem;
+
+// ============================================================
+// CollisionManager - all overlapping pairs of a frame
+//
+// Every mesh with collision mode != NONE is collidable.
+//   1. Broadphase: sweep and prune on X over the meshes' world AABB
+//      (Mesh::aabb, encloses the OBB). The last frame's ordering is
+//      kept; with coherent motion the insertion sort is ~O(N).
+//   2. Y/Z interval test for every pair with overlapping X intervals
+//   3. Narrowphase: BoundingOrientedBox::Intersects only for these candidates
+//
+// Sweep and narrowphase run block-wise in parallel, every block collects into
+// its own list (merged in block order, deterministic).
+// The bounds come from Mesh::UpdateBounds() -> call after UpdateWorld().
+//
+// Raycasts hit the real triangles of all active meshes (regardless of the
+// collision mode):
+//   1. Candidates: scene tree (fat AABBs), then a slab test against Mesh::aabb
+//   2. Triangle BVH of every surface, built lazily (Surface::GetTriangleBVH) on the
+//      calling thread before the parallel part
+//   3. Ray into the mesh's local space, candidates by entry distance -
+//      as soon as a hit is closer than the next AABB, the ray is done
+// RaycastBatch spreads blocks of rays over the JobSystem. Every 4 consecutive
+// rays run as a packet (TriangleBVH::Intersect4) through meshes that several
+// of them hit - coherent rays (picking grid, lines of sight from one point)
+// should therefore be adjacent.
+// ============================================================
+
+struct CollisionPair
+{
+    Mesh* a;    // a comes before b in ObjectManager::GetMeshes()
+    Mesh* b;
+};
+
+struct CollisionStats
+{
+    size_t colliders = 0;   // meshes with a collision mode
+    size_t candidates = 0;  // AABB overlaps (broadphase)
+    size_t pairs = 0;       // of which OBB overlaps (narrowphase)
+    size_t sortShifts = 0;  // shifts in the insertion sort
+};
+
+struct Ray
+{
+    DirectX::XMFLOAT3 origin = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+    DirectX::XMFLOAT3 direction = DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f);  // gets normalized
+    float maxDistance = FLT_MAX;
+    const Mesh* ignore[2] = { nullptr, nullptr };   // e.g. shooter and target of a line of sight
+};
+
+struct RaycastHit
+{
+    Mesh* mesh = nullptr;               // nullptr = no hit
+    Surface* surface = nullptr;
+    uint32_t triangle = 0;              // triangle of the surface (indices[3 * triangle])
+    float distance = FLT_MAX;           // world units from origin
+    float u = 0.0f, v = 0.0f;           // barycentric in the triangle
+    DirectX::XMFLOAT3 point = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);    // world
+    DirectX::XMFLOAT3 normal = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);   // world, points toward the ray origin
+};
+
+struct RaycastStats
+{
+    size_t rays = 0;
+    size_t meshTests = 0;       // ray against the triangle BVH of a mesh
+    size_t packetTests = 0;     // of which as packets of 4 (counted once per packet and mesh)
+    size_t hits = 0;
+};
+
+class CollisionManager
+{
+public:
+    CollisionManager() = default;
+    ~CollisionManager() = default;
+
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    // meshes: all meshes of the scene (ObjectManager::GetMeshes(), the engine passes them in).
+    // Valid until the next CollideAll() or until a participating mesh is deleted
+    const std::vector<CollisionPair>& CollideAll(const std::vector<Mesh*>& meshes);
+
+    const std::vector<CollisionPair>& GetPairs() const { return m_pairs; }
+    const CollisionStats& GetStats() const { return m_stats; }
+
+    // Closest hit along the ray (anyHit: any one, e.g. for lines of sight).
+    // scene: the scene tree (ObjectManager::GetSceneTree()), its user data are the meshes.
+    // Bounds/matrices as of the last UpdateWorld(). Not from several threads.
+    bool Raycast(const AABBTree& scene, const Ray& ray, RaycastHit& hit, bool anyHit = false);
+
+    // hits[i] belongs to rays[i]. Returns the number of rays with a hit
+    size_t RaycastBatch(const AABBTree& scene, const Ray* rays, size_t count, RaycastHit* hits, bool anyHit = false);
+
+    const RaycastStats& GetRaycastStats() const { return m_rayStats; }
+
+private:
+    // One entry of the sweep list, sorted by minX (32 bytes)
+    struct Proxy
+    {
+        float minX, maxX;
+        float minY, maxY;
+        float minZ, maxZ;
+        uint32_t collider;      // index into m_colliders
+        uint32_t padding;
+    };
+
+    struct Block
+    {
+        std::vector<CollisionPair> pairs;
+        size_t candidates = 0;
+    };
+
+    // Mesh a ray hits according to its AABB
+    struct RayCandidate
+    {
+        Mesh* mesh;
+        float tNear;            // entry distance into Mesh::aabb
+        uint32_t lane;          // ray within its packet of 4
+    };
+
+    // Mesh with all rays of a packet that hit it
+    struct PacketMesh
+    {
+        Mesh* mesh;
+        float tNear[4];
+        float minNear;
+        uint32_t lanes;
+    };
+
+    struct RayBlock
+    {
+        std::vector<RayCandidate> candidates;   // one range per ray (m_rayRanges)
+        std::vector<RayCandidate> scratch;
+        std::vector<PacketMesh> meshes;
+        RaycastStats stats;
+    };
+
+    struct RayRange
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    void GatherColliders(const std::vector<Mesh*>& meshes);
+    void UpdateProxies();
+    void SortProxies();
+    void Sweep(size_t begin, size_t end, Block& block) const;
+
+    void GatherRayCandidates(const AABBTree& scene, const Ray* rays, size_t begin, size_t end, RayBlock& block);
+    void TraceRays(const Ray* rays, size_t begin, size_t end, RaycastHit* hits, bool anyHit, RayBlock& block) const;
+    void TracePacket(const Ray* rays, size_t first, uint32_t laneCount, RaycastHit* hits, bool anyHit, RayBlock& block) const;
+
+    JobSystem* m_jobs = nullptr;
+
+    std::vector<Mesh*> m_colliders;     // same order as the meshes passed to CollideAll()
+    std::vector<Proxy> m_proxies;
+    std::vector<Block> m_blocks;        // one result buffer per ParallelFor block
+    std::vector<CollisionPair> m_pairs;
+    CollisionStats m_stats;
+
+    std::vector<Ray> m_rays;            // normalized copy of a batch's rays
+    std::vector<RayRange> m_rayRanges;  // candidates per ray in the block
+    std::vector<RayBlock> m_rayBlocks;
+    RaycastStats m_rayStats;
+};
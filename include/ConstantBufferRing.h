@@ -0,0 +1,81 @@
+#pragma once
+#include "gdxplatform.h"
+#include <cstdint>
+#include <cstddef>
+
+class GDXDevice;
+
+// ============================================================
+// Per-Frame Constant-Buffer-Ring
+//
+// One large dynamic constant buffer that is mapped once per frame
+// with WRITE_DISCARD. The per-draw data (e.g. MatrixSet) is placed
+// linearly at 256-byte offsets and bound with an offset via
+// VS/PSSetConstantBuffers1 (D3D11.1).
+//
+// The offset bookkeeping lives in UploadRingAllocator and has
+// no D3D dependency, so it can be tested without a device.
+// ============================================================
+
+class UploadRingAllocator
+{
+public:
+    // D3D11.1: firstConstant must be a multiple of 16 constants (256 bytes)
+    static constexpr uint32_t ALIGNMENT = 256;
+    static constexpr uint32_t INVALID_OFFSET = 0xFFFFFFFFu;
+
+    static uint32_t AlignUp(uint32_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    // New frame: everything is free again
+    void Reset(uint32_t capacity) { m_capacity = capacity; m_head = 0; }
+
+    // Byte offset of the block, INVALID_OFFSET when the ring is full
+    uint32_t Allocate(uint32_t size)
+    {
+        const uint32_t aligned = AlignUp(size);
+        if (aligned == 0 || aligned > m_capacity - m_head)
+            return INVALID_OFFSET;
+
+        const uint32_t offset = m_head;
+        m_head += aligned;
+        return offset;
+    }
+
+    uint32_t GetUsed() const { return m_head; }
+    uint32_t GetCapacity() const { return m_capacity; }
+
+private:
+    uint32_t m_capacity = 0;
+    uint32_t m_head = 0;
+};
+
+class ConstantBufferRing
+{
+public:
+    ConstantBufferRing();
+    ~ConstantBufferRing();
+
+    ConstantBufferRing(const ConstantBufferRing&) = delete;
+    ConstantBufferRing& operator=(const ConstantBufferRing&) = delete;
+
+    // Grow the buffer if needed (next power of two) and map it once.
+    // requiredBytes = sum of the frame's aligned blocks.
+    HRESULT BeginFrame(const GDXDevice* device, uint32_t requiredBytes);
+    void EndFrame(const GDXDevice* device);
+
+    // Reserve a block in the mapped memory. Returns nullptr when full.
+    // firstConstant = offset in 16-byte constants for Bind().
+    void* Allocate(uint32_t size, uint32_t& firstConstant);
+
+    // Bind the block to VS and PS (same slot)
+    void Bind(const GDXDevice* device, UINT slot, uint32_t firstConstant, uint32_t size) const;
+
+    bool IsMapped() const { return m_mapped != nullptr; }
+    uint32_t GetCapacity() const { return m_allocator.GetCapacity(); }
+    void Release();
+
+private:
+    ID3D11Buffer* m_buffer;
+    unsigned char* m_mapped;
+    UploadRingAllocator m_allocator;
+};
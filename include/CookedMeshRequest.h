@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "AssetLoader.h"
+#include "MeshFile.h"
+
+class Mesh;
+class ObjectManager;
+class BufferManager;
+
+// ============================================================
+// CookedMeshRequest - AssetRequest behind Engine::LoadMeshAsync
+//
+// Load (loader thread): map the cooked file, validate it and touch every
+// page, so page faults do not hit the main thread.
+// Upload (main thread): resolve the stored material name, check the layout
+// against the shader and build surfaces and buffers (MeshLoader::Build).
+//
+// The request holds the empty placeholder mesh across frames. It keeps its
+// generation too: if the mesh was deleted in the meantime, even when a new
+// mesh got the same address, Upload fails instead of touching it.
+// ============================================================
+
+class CookedMeshRequest : public AssetRequest
+{
+public:
+    // findMaterial: no material at the call, use the one with the stored name if it exists
+    CookedMeshRequest(ObjectManager& objects, BufferManager& buffers, bool nullDevice,
+        Mesh* mesh, const char* path, bool findMaterial, bool keepGeometry);
+
+    bool Load() override;
+    size_t GetUploadBytes() const override { return m_reader.GetSize(); }
+    bool Upload() override;
+
+private:
+    ObjectManager& m_objects;
+    BufferManager& m_buffers;
+    bool m_nullDevice;
+    Mesh* m_mesh;
+    uint32_t m_generation;
+    std::string m_path;
+    bool m_findMaterial;
+    bool m_keepGeometry;
+    MeshFile::Reader m_reader;
+    uint8_t m_touched = 0;
+};
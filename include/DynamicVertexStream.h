@@ -0,0 +1,82 @@
+#pragma once
+#include "gdxplatform.h"
+#include <vector>
+#include <cstdint>
+
+class GDXDevice;
+
+// ============================================================
+// Dynamic vertex stream (one attribute of a dynamic surface)
+//
+// A D3D11_USAGE_DYNAMIC buffer holding SEGMENTS copies of the stream
+// back to back. Each upload writes the next segment with
+// MAP_WRITE_NO_OVERWRITE and then binds it (offset), while the
+// GPU keeps reading from the old segment undisturbed.
+//
+// Every segment remembers the vertex ranges changed since its last
+// upload; only those are uploaded.
+// SEGMENTS is above the DXGI default frame latency (3), so a segment
+// is no longer in use when its turn comes again.
+//
+// DISCARD is not used: the other segments would be undefined
+// afterwards and every following upload would have to write everything.
+// ============================================================
+
+enum DynamicStream : uint32_t
+{
+    DYNAMIC_STREAM_POSITION = 0,
+    DYNAMIC_STREAM_NORMAL,
+    DYNAMIC_STREAM_COLOR,
+    DYNAMIC_STREAM_UV1,
+    DYNAMIC_STREAM_UV2,
+    DYNAMIC_STREAM_COUNT
+};
+
+class DynamicVertexStream
+{
+public:
+    static constexpr UINT SEGMENTS = 4;
+    static constexpr size_t MAX_RANGES = 8;   // more ranges are merged into one
+
+    DynamicVertexStream();
+    ~DynamicVertexStream();
+
+    DynamicVertexStream(const DynamicVertexStream&) = delete;
+    DynamicVertexStream& operator=(const DynamicVertexStream&) = delete;
+
+    // Create the buffer with data in all segments (stride in bytes, count vertices)
+    HRESULT Create(const GDXDevice* device, const void* data, UINT stride, UINT count);
+    void Release();
+    bool IsCreated() const { return m_buffer != nullptr; }
+
+    // Vertices [first, first + count) changed
+    void MarkDirty(UINT first, UINT count);
+    // Everything changed (vertex count too)
+    void MarkAllDirty();
+    bool HasChanges() const { return m_changed; }
+
+    // Write the pending ranges into the next segment and make it active.
+    // Vertex count differs from Create: recreate the buffer.
+    HRESULT Upload(const GDXDevice* device, const void* data, UINT count, UINT& uploadedBytes);
+
+    ID3D11Buffer* GetBuffer() const { return m_buffer; }
+    UINT GetStride() const { return m_stride; }
+    UINT GetOffset() const { return m_current * m_stride * m_count; }   // byte offset of the active segment
+    UINT GetCount() const { return m_count; }
+
+private:
+    struct Range
+    {
+        UINT begin;
+        UINT end;   // exclusive
+    };
+
+    static void AddRange(std::vector<Range>& ranges, UINT begin, UINT end);
+
+    ID3D11Buffer* m_buffer;
+    UINT m_stride;
+    UINT m_count;
+    UINT m_current;
+    bool m_changed;
+    std::vector<Range> m_pending[SEGMENTS];
+};
@@ -1,5 +1,5 @@
 ﻿#pragma once
-#include <d3d11.h>
+#include "gdxplatform.h"
 #include <DirectXMath.h>
 #include "Transform.h"
 #include "gdxutil.h"
@@ -15,7 +15,7 @@ public:
     D3D11_VIEWPORT viewport;
 
 public:
-    Entity();
+    explicit Entity(TransformSystem& transformSystem);
     virtual ~Entity();
 
     // Basis-Update für Transform → Matrix
@@ -0,0 +1,50 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+// ============================================================
+// Frustum Culling
+//
+// BoundsSoA keeps world AABBs (center/extents) split by axis so
+// Frustum::CullAABBs can test four boxes per iteration against all
+// six planes (one XMVECTOR lane per box).
+// ============================================================
+
+struct BoundsSoA
+{
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    void Clear();
+    void Reserve(size_t count);
+    void Add(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents);
+    size_t Size() const { return centerX.size(); }
+};
+
+// Result of Frustum::ClassifyAABB
+enum class FrustumTest { Outside, Intersect, Inside };
+
+class Frustum
+{
+public:
+    static constexpr uint32_t ALL_PLANES = 0x3Fu;
+
+    Frustum();
+
+    // Gribb/Hartmann: planes straight from View*Projection (D3D, depth 0..1)
+    void ExtractFromMatrix(DirectX::FXMMATRIX viewProjection);
+
+    bool IntersectsAABB(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents) const;
+
+    // Hierarchical culling: tests only the planes in planeMask (bit p = plane p) and
+    // removes those that fully contain the box - the box's children no longer need them.
+    FrustumTest ClassifyAABB(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents, uint32_t& planeMask) const;
+
+    // visible[i] = 1 if box i intersects the frustum. Returns the number of visible boxes.
+    // begin/end allow splitting the work over several jobs.
+    size_t CullAABBs(const BoundsSoA& bounds, size_t begin, size_t end, uint8_t* visible) const;
+
+private:
+    DirectX::XMFLOAT4A m_planes[6];     // xyz = normal (pointing inward), w = distance
+};
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <d3d11.h>
-#include <d3dcompiler.h>
+#include "gdxplatform.h"
 #include <vector>
 #include "gdxutil.h"
 #include "ObjectManager.h"
@@ -12,8 +11,19 @@ public:
     ~InputLayoutManager();
     
     void Init(ID3D11Device* device);
-    HRESULT CreateInputLayoutVertex(ID3D11InputLayout** layout, SHADER* shader, DWORD& saveFlags, DWORD flags);
+    // perInstanceWorld: additionally INSTANCE_WORLD0..3 (float4 x 4) per instance in the slot after the vertex streams
+    // positionFormat: R16G16B16A16_UNORM for quantized positions (VERTEX_FORMAT_QUANTIZED)
+    HRESULT CreateInputLayoutVertex(ID3D11InputLayout** layout, SHADER* shader, DWORD& saveFlags, DWORD flags, bool perInstanceWorld = false,
+        DXGI_FORMAT positionFormat = DXGI_FORMAT_R32G32B32_FLOAT);
+    // Interleaved, packed format (VertexPacking): all attributes in slot 0, instance matrix in slot 1
+    HRESULT CreateInputLayoutPacked(ID3D11InputLayout** layout, SHADER* shader, DWORD flags, bool perInstanceWorld = false,
+        bool quantizedPosition = false);
+    // All variants for shader->inputlayoutFormats (interleaved, quantized, both).
+    // Needs blobVS, so call it right after CreateInputLayoutVertex.
+    HRESULT CreateInputLayoutFormats(SHADER* shader, DWORD flags, bool perInstanceWorld = false);
 
 private:
+    static void AppendInstanceWorld(std::vector<D3D11_INPUT_ELEMENT_DESC>& layoutElements, UINT slot);
+
     ID3D11Device* m_device;
 };
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include "gdxplatform.h"
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+#include "RenderQueue.h"
+
+class GDXDevice;
+
+// ============================================================
+// Hardware instancing
+//
+// Collects visible draws with the same sort key
+// (shader | material | surface) into groups and stores the
+// world matrices of all instances back to back. The instance buffer
+// is mapped once per frame, after that every group is one
+// DrawIndexedInstanced with startInstance.
+//
+// Build() needs no device, the CPU side also runs headless.
+// ============================================================
+
+struct InstanceGroup
+{
+    uint32_t candidate;         // draw index of the first member (shader/material/surface)
+    uint32_t startInstance;     // first matrix in the instance buffer
+    uint32_t instanceCount;
+};
+
+class InstanceBatcher
+{
+public:
+    InstanceBatcher();
+    ~InstanceBatcher();
+
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+    // New frame: clear the instance data (capacity is kept)
+    void Clear() { m_instances.clear(); }
+
+    // draws: sorted, equal keys are adjacent.
+    // worldOf(draw.index) returns the world matrix of the instance.
+    // Appends to the instance data, several passes share one buffer.
+    template<typename WorldFunc>
+    void Build(const std::vector<SortedDraw>& draws, std::vector<InstanceGroup>& groups, WorldFunc&& worldOf);
+
+    // Upload all instance data with one Map (the buffer grows to the next power of two)
+    HRESULT Upload(const GDXDevice* device);
+
+    ID3D11Buffer* GetBuffer() const { return m_buffer; }
+    size_t GetInstanceCount() const { return m_instances.size(); }
+    const std::vector<DirectX::XMFLOAT4X4>& GetInstanceData() const { return m_instances; }
+
+    void Release();
+
+private:
+    std::vector<DirectX::XMFLOAT4X4> m_instances;
+    ID3D11Buffer* m_buffer;
+    UINT m_capacity;            // in instances
+};
+
+template<typename WorldFunc>
+void InstanceBatcher::Build(const std::vector<SortedDraw>& draws, std::vector<InstanceGroup>& groups, WorldFunc&& worldOf)
+{
+    groups.clear();
+
+    const size_t count = draws.size();
+    size_t i = 0;
+    while (i < count)
+    {
+        const uint64_t key = draws[i].key;
+
+        InstanceGroup group;
+        group.candidate = draws[i].index;
+        group.startInstance = static_cast<uint32_t>(m_instances.size());
+
+        for (; i < count && draws[i].key == key; ++i)
+        {
+            m_instances.emplace_back();
+            DirectX::XMStoreFloat4x4(&m_instances.back(), worldOf(draws[i].index));
+        }
+
+        group.instanceCount = static_cast<uint32_t>(m_instances.size()) - group.startInstance;
+        groups.push_back(group);
+    }
+}
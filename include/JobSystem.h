@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// ============================================================
+// JobSystem
+//
+// Work-stealing scheduler for the engine's per-frame work.
+// Every thread has its own queue (index 0 = main thread):
+//   - the owner pushes/pops at the back (LIFO, cache-warm)
+//   - other threads steal from the front (FIFO)
+//
+// Dependencies go through JobCounter: Run() increments the counter,
+// the end of the job decrements it. Wait() runs jobs itself until
+// the counter is 0. RunAfter() attaches a continuation to a
+// counter that is only scheduled once it reaches 0.
+// ============================================================
+
+class JobCounter
+{
+public:
+    JobCounter() : m_pending(0) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation
+    {
+        std::function<void()> function;
+        JobCounter* counter;
+    };
+
+    std::atomic<int> m_pending;
+    std::mutex m_mutex;
+    std::vector<Continuation> m_continuations;
+};
+
+class JobSystem
+{
+public:
+    typedef std::function<void()> JobFunction;
+
+    JobSystem();
+    ~JobSystem();
+
+    // workerCount 0 = number of cores - 1 (the main thread helps in Wait())
+    void Init(unsigned int workerCount = 0);
+    void Shutdown();
+
+    // Schedule a job. Without workers it runs immediately on the calling thread.
+    void Run(JobFunction function, JobCounter* counter = nullptr);
+
+    // Continuation: runs only once dependency has dropped to 0
+    void RunAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr);
+
+    // Blocks until counter is 0, running jobs itself meanwhile
+    void Wait(JobCounter& counter);
+
+    // fn(begin, end) for blocks of grainSize elements, returns only after all blocks.
+    // The first block runs on the calling thread.
+    template<typename Func>
+    void ParallelFor(size_t count, size_t grainSize, Func&& fn);
+
+    unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_threads.size()); }
+    unsigned int GetThreadCount() const { return GetWorkerCount() + 1; }
+    bool IsParallel() const { return !m_threads.empty(); }
+
+private:
+    struct Job
+    {
+        JobFunction function;
+        JobCounter* counter;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void WorkerLoop(unsigned int queueIndex);
+    void Push(Job&& job);
+    bool PopOrSteal(unsigned int queueIndex, Job& job);
+    void Execute(Job& job);
+    void Finish(JobCounter* counter);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_queuedJobs;
+    std::atomic<bool> m_running;
+};
+
+template<typename Func>
+void JobSystem::ParallelFor(size_t count, size_t grainSize, Func&& fn)
+{
+    if (count == 0)
+        return;
+
+    if (grainSize == 0)
+        grainSize = 1;
+
+    // Too little work or no workers: run directly
+    if (!IsParallel() || count <= grainSize)
+    {
+        fn(size_t(0), count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = grainSize; begin < count; begin += grainSize)
+    {
+        const size_t end = (std::min)(begin + grainSize, count);
+        Run([&fn, begin, end]() { fn(begin, end); }, &counter);
+    }
+
+    fn(size_t(0), grainSize);
+    Wait(counter);
+}
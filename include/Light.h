@@ -4,8 +4,7 @@
 #include "gdxdevice.h"
 
 
-__declspec(align(16))
-struct LightBufferData
+struct alignas(16) LightBufferData
 {
     DirectX::XMFLOAT4 lightPosition;     // XYZ: Position, W: 0 für direktional, 1 für positional
     DirectX::XMFLOAT4 lightDirection;    // XYZ: Direction (nur für direktionale Lichter)
@@ -23,7 +22,7 @@ enum class LightType
 class Light : public Entity
 {
 public:
-    Light();
+    explicit Light(TransformSystem& transformSystem);
     ~Light();
 
     // Override Entity::Update() - berechnet lightDirection automatisch aus Transform-Rotation
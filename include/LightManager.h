@@ -19,7 +19,7 @@ struct LightArrayBuffer
 class LightManager
 {
 public:
-    LightManager();
+    explicit LightManager(TransformSystem& transforms);
     ~LightManager();
 
     // Neue API: Erstelle ein neues Licht mit modernem LightType
@@ -43,6 +43,7 @@ public:
 private:
     void InitializeLightBuffer(const GDXDevice* device);
 
+    TransformSystem& m_transforms;  // owned by GDXEngine
     std::vector<Light*> m_lights;
     ID3D11Buffer* lightBuffer;
     LightArrayBuffer lightCBData;
@@ -1,6 +1,6 @@
 #pragma once
 #include <vector>
-#include <d3d11.h>
+#include "gdxplatform.h"
 #include <DirectXMath.h>
 #include <string>
 #include "Mesh.h"
@@ -28,7 +28,7 @@ public:
     // ==================== TEXTURE METHODS ====================
     void SetTexture(const GDXDevice* device);
     void SetTexture(ID3D11Texture2D* texture, ID3D11ShaderResourceView* textureView, ID3D11SamplerState* imageSamplerState);
-    void UpdateConstantBuffer(ID3D11DeviceContext* context);
+    void UpdateConstantBuffer(const GDXDevice* device);
 
     // ==================== MATERIAL PROPERTY SETTERS ====================
     void SetDiffuseColor(float r, float g, float b, float a = 1.0f);
@@ -57,8 +57,21 @@ public:
     inline bool GetCastShadows() const { return castShadows; }
     inline bool GetReceiveShadows() const { return receiveShadows; }
 
+    // ==================== RENDER QUEUE ====================
+    // Opaque/AlphaTest: by sort key (shader, material, front-to-back)
+    // Transparent/Additive: after all opaque draws, back-to-front
+    RenderQueueType renderQueue = RenderQueueType::Opaque;
+
+    inline void SetRenderQueue(RenderQueueType queue) { renderQueue = queue; }
+    inline RenderQueueType GetRenderQueue() const { return renderQueue; }
+    inline bool IsTransparent() const
+    {
+        return renderQueue == RenderQueueType::Transparent || renderQueue == RenderQueueType::Additive;
+    }
+
     // ==================== MATERIAL STATE ====================
     bool isActive;
+    std::string name;         // reference in cooked meshes (MeshFile), empty = unnamed
     MaterialData properties;  // Alle Material-Properties hier!
 
     // ==================== TEXTURE DATA ====================
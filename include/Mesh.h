@@ -1,6 +1,6 @@
 ﻿#pragma once
 #include <vector>
-#include <d3d11.h>
+#include "gdxplatform.h"
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
 #include "Entity.h"
@@ -17,30 +17,68 @@ enum COLLISION {
 
 enum class RenderQueueType { Opaque, AlphaTest, Transparent, Additive };
 
+// Simplified level of all surfaces of a mesh (GenerateMeshLODs or built offline)
+struct MeshLOD
+{
+    std::vector<Surface*> surfaces;     // parallel to Mesh::surfaces
+    float screenSize = 0.0f;            // drawn when the sphere is smaller than this fraction of the screen height
+    float error = 0.0f;                 // simplification error relative to the extent (info)
+};
+
 class Mesh : public Entity
 {
 public:
     std::vector<Surface*> surfaces;
     Material* pMaterial = nullptr;
     DirectX::BoundingOrientedBox obb;
+    DirectX::BoundingBox aabb;          // world AABB of all surfaces (frustum culling)
+    DirectX::BoundingSphere sphere;     // world sphere of all surfaces (collision mode only)
+    uint32_t sceneProxy = 0xFFFFFFFFu;  // leaf in the ObjectManager's scene tree
+    uint32_t generation = 0;            // set by ObjectManager::CreateMesh, never reused (ObjectManager::IsMeshAlive)
+
+    // LOD 1..n, from fine to coarse (LOD 0 = surfaces). Maintained through ObjectManager::AddMeshLOD.
+    std::vector<MeshLOD> lods;
+    uint32_t lodLevel = 0;              // last chosen level (hysteresis in the RenderManager)
+
+    // Occluder: base surfaces are rasterized into the RenderManager's occlusion buffer
+    // (opaque materials only). For large, closed meshes with few triangles.
+    bool occluder = false;
 
 public:
-    Mesh();
+    explicit Mesh(TransformSystem& transformSystem);
     ~Mesh();
 
     // 1. Überschreibt Entity::Update() - für einfaches Update
     void Update(const GDXDevice* device) override;
 
     // 2. Rendering-spezifisches Update mit MatrixSet
-    void Update(const GDXDevice* device, const MatrixSet* matrixSet);
+    // localMatrix: applied before the world matrix (e.g. dequantization of a surface)
+    void Update(const GDXDevice* device, const MatrixSet* matrixSet, const DirectX::XMMATRIX* localMatrix = nullptr);
+
+    // 3. MatrixSet unchanged into the constant buffer of the mesh (instance groups)
+    void Upload(const GDXDevice* device, const MatrixSet& matrixSet);
 
     unsigned int NumSurface();
     Surface* GetSurface(unsigned int index);
     void AddSurfaceToMesh(Surface* surface);
 
     void SetCollisionMode(COLLISION collision);
+    COLLISION GetCollisionMode() const { return collisionType; }
     bool CheckCollision(Mesh* mesh);
-    void CalculateOBB(unsigned int index);
+    // OBB/sphere from the local bounds of all surfaces and the world matrix (O(1))
+    void CalculateOBB();
+
+    void CalculateAABB();
+
+    // Recompute AABB/OBB only when the world matrix or the surface geometry changed.
+    // The vertices are never read, only the surfaces' bounds caches.
+    void UpdateBounds();
+    // New surface, different collision mode: recompute the bounds in the next UpdateBounds
+    void InvalidateBounds() { boundsVersion = 0xFFFFFFFFu; geometryRevision = 0xFFFFFFFFu; }
+
+    // Local bounds of all surfaces (as of the last UpdateBounds)
+    const DirectX::BoundingBox& GetLocalBox() const { return localBox; }
+    const DirectX::BoundingSphere& GetLocalSphere() const { return localSphere; }
 
     void* operator new(size_t size) {
         return _aligned_malloc(size, 16);
@@ -50,7 +88,16 @@ public:
     }
 
 private:
+    // Merge the surface bounds when a surface has changed
+    void MergeLocalBounds();
+    uint32_t GetGeometryRevision() const;
+
     COLLISION collisionType;
+    uint32_t boundsVersion;     // transform version the AABB/OBB were computed for
+    uint32_t geometryRevision;  // Hash of surfaces and their revisions at the last MergeLocalBounds
+    DirectX::BoundingBox localBox;
+    DirectX::BoundingSphere localSphere;
+    bool hasLocalBounds;
 };
 
 typedef Mesh* LPMESH;
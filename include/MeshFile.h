@@ -0,0 +1,190 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// MeshFile - cooked binary format for meshes (.gdxm)
+//
+// One file = one mesh: base surfaces, LOD levels, local bounds and the
+// material name. Every surface is stored in exactly the format
+// FillBuffer would produce for its shader (separate float streams,
+// interleaved/packed, quantized positions, 16/32-bit indices), i.e.
+// matching the InputLayoutManager's input layouts.
+//
+// Loading: map the file with mmap, validate header and records, pass the stream
+// pointers straight to BufferManager::CreateBuffer (Engine::LoadMesh).
+// Nothing is copied or repacked in between.
+//
+// Layout (little endian, all streams aligned to ALIGNMENT bytes):
+//   Header | LevelRecord[levelCount] | SurfaceRecord[surfaceCount] | Streams
+// Level 0 holds the base surfaces, every further level has the same number
+// of surfaces (parallel to level 0, like Mesh::lods).
+//
+// Versions: VERSION is bumped on every layout change, older files
+// are rejected (cook again).
+// ============================================================
+
+namespace MeshFile
+{
+    constexpr uint32_t MAGIC = 0x4D584447u;        // "GDXM"
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t ALIGNMENT = 16;
+    constexpr uint32_t MAX_NAME = 64;
+    constexpr uint32_t NO_ALIAS = 0xFFFFFFFFu;
+
+    enum Stream : uint32_t
+    {
+        STREAM_VERTEX,          // interleaved (VertexPacking), stride = layout stride
+        STREAM_POSITION,        // float3 or 4 x UNORM16 (quantized)
+        STREAM_NORMAL,          // float3
+        STREAM_COLOR,           // float4
+        STREAM_UV1,             // float2
+        STREAM_UV2,             // float2
+        STREAM_INDEX,           // uint16 or uint32 (SurfaceRecord::indexSize)
+        STREAM_CPU_POSITION,    // float3, only when the GPU positions are quantized
+        STREAM_COUNT
+    };
+
+    struct StreamRecord
+    {
+        uint64_t offset;        // from the start of the file, 0 = not present
+        uint64_t size;          // bytes
+        uint32_t stride;        // bytes per element
+        uint32_t reserved;
+    };
+
+    struct LevelRecord
+    {
+        uint32_t firstSurface;
+        uint32_t surfaceCount;
+        float screenSize;       // MeshLOD::screenSize (level 0: 0)
+        float error;            // MeshLOD::error
+    };
+
+    struct SurfaceRecord
+    {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t attributes;    // D3DVERTEX_FLAGS of the streams (= the shader's flagsVertex at cook time)
+        uint32_t vertexFormat;  // VertexFormat: VERTEX_FORMAT_INTERLEAVED | VERTEX_FORMAT_QUANTIZED
+        uint32_t indexSize;     // 2 or 4
+        uint32_t alias;         // NO_ALIAS or an earlier surface this level reuses unchanged (no streams)
+        float quantizationOffset[3];
+        float quantizationScale[3];
+        float boxCenter[3];
+        float boxExtents[3];
+        float sphereCenter[3];
+        float sphereRadius;
+        StreamRecord streams[STREAM_COUNT];
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fileSize;
+        uint32_t levelCount;
+        uint32_t surfaceCount;  // all levels
+        uint64_t levelOffset;
+        uint64_t surfaceOffset;
+        float boxCenter[3];     // local box of all base surfaces
+        float boxExtents[3];
+        char material[MAX_NAME];    // Material::name, null-terminated (empty = default material)
+    };
+
+    static_assert(sizeof(StreamRecord) == 24, "MeshFile: StreamRecord layout");
+    static_assert(sizeof(SurfaceRecord) == 24 + 64 + STREAM_COUNT * 24, "MeshFile: SurfaceRecord layout");
+    static_assert(sizeof(Header) == 64 + MAX_NAME, "MeshFile: Header layout");
+
+    // Write side: streams of a surface in the final GPU format (Surface::Cook).
+    // Cook sets record.streams[i].stride, the writer fills in offset and size.
+    struct CookedSurface
+    {
+        SurfaceRecord record = {};
+        std::vector<uint8_t> streams[STREAM_COUNT];
+    };
+
+    class Writer
+    {
+    public:
+        void SetMaterial(const std::string& name) { m_material = name; }
+
+        // New level, then its surfaces. Level 0 (base) is created by the first AddSurface
+        // when no AddLevel came before.
+        void AddLevel(float screenSize, float error);
+        void AddSurface(CookedSurface&& surface);
+        // Reuse surface surfaceIndex (counted over all levels) unchanged
+        void AddAlias(uint32_t surfaceIndex);
+
+        // false: levels with different surface counts, no surfaces or a write error
+        bool Save(const char* path, std::string* error = nullptr) const;
+
+        // Whole file in memory (Save writes exactly these bytes)
+        bool Serialize(std::vector<uint8_t>& out, std::string* error = nullptr) const;
+
+    private:
+        std::string m_material;
+        std::vector<LevelRecord> m_levels;
+        std::vector<CookedSurface> m_surfaces;
+    };
+
+    // Read-only mapped file (Windows: MapViewOfFile, otherwise mmap)
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const char* path);
+        void Close();
+
+        const uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_file = nullptr;         // HANDLE (Windows only; mmap does not need the descriptor)
+        void* m_mapping = nullptr;
+    };
+
+    class Reader
+    {
+    public:
+        // Map and validate: magic, version, file size, all records and streams
+        // inside the file, strides and sizes matching the counts.
+        // The caller checks the attributes against the shader (Engine::LoadMesh). Index values are
+        // not read (raycasts/occlusion skip invalid indices).
+        bool Open(const char* path);
+        // The same for bytes in memory (must stay valid until Close)
+        bool Open(const uint8_t* data, size_t size);
+        void Close();
+
+        const char* GetError() const { return m_error.c_str(); }
+        const uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+        const Header& GetHeader() const { return *m_header; }
+        const LevelRecord& GetLevel(uint32_t level) const { return m_levels[level]; }
+        const SurfaceRecord& GetSurface(uint32_t surface) const { return m_surfaces[surface]; }
+
+        // nullptr if the stream is missing
+        const void* GetStream(const SurfaceRecord& surface, Stream stream) const;
+
+    private:
+        bool Validate();
+        bool Fail(const char* message);
+
+        MappedFile m_file;
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+        const Header* m_header = nullptr;
+        const LevelRecord* m_levels = nullptr;
+        const SurfaceRecord* m_surfaces = nullptr;
+        std::string m_error;
+    };
+}
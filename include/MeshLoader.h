@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "MeshFile.h"
+
+class Mesh;
+class Surface;
+class Shader;
+class ObjectManager;
+class BufferManager;
+
+// ============================================================
+// MeshLoader - cooked meshes (.gdxm, MeshFile) to and from the engine
+//
+// Save cooks the surfaces and LOD levels of a mesh in exactly the format
+// FillBuffer would upload for the shader of its material. Build creates
+// surfaces, GPU buffers, bounds and LOD levels of an empty mesh straight
+// from a mapped file (Engine::LoadMesh, Engine::LoadMeshAsync).
+//
+// nullDevice: the null device has no input layouts, every vertex format
+// counts as available (headless tools and tests).
+// ============================================================
+
+namespace MeshLoader
+{
+    // Does the shader have an input layout for the vertex format
+    bool HasVertexLayout(const Shader* shader, uint32_t format, bool nullDevice);
+
+    // Vertex format (VertexFormat bits) FillBuffer picks for the surface with this shader.
+    // Formats without a matching layout fall back to float / separate streams.
+    uint32_t ResolveVertexFormat(const Surface* surface, const Shader* shader, bool nullDevice);
+
+    // Base surfaces and LOD levels with the material name. Dynamic surfaces are cooked
+    // as static float streams, lines not at all (error).
+    bool Save(const Mesh* mesh, const char* path, bool nullDevice, std::string* error = nullptr);
+
+    // Every cooked surface must have exactly the streams the shader binds
+    bool MatchesLayout(const MeshFile::Reader& reader, const Shader* shader, bool nullDevice);
+
+    // Surfaces, buffers, bounds and LOD levels from the mapped file into a mesh without
+    // surfaces. The layout must match (MatchesLayout).
+    // keepGeometry: positions and indices also on the CPU (raycasts, occlusion, collision).
+    void Build(ObjectManager& objects, BufferManager& buffers, Mesh* mesh,
+        const MeshFile::Reader& reader, const Shader* shader, bool keepGeometry);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================
+// Mesh optimization for index data (pure CPU work, no D3D)
+//
+// Order as in Surface::Optimize():
+//   1. OptimizeVertexCache  - sort triangles for the post-transform
+//                             cache (Forsyth, LRU scoring)
+//   2. OptimizeOverdraw     - sort clusters of the cache result by
+//                             outward-facing direction (Sander et al.)
+//   3. OptimizeVertexFetch  - renumber vertices in order of first
+//                             use (remap for all streams)
+//
+// ACMR = cache misses per triangle (0.5 .. 3), ATVR = misses per vertex (>= 1).
+// ============================================================
+
+namespace MeshOptimizer
+{
+    struct CacheStats
+    {
+        float acmr = 0.0f;      // average cache miss ratio
+        float atvr = 0.0f;      // average transform to vertex ratio
+    };
+
+    struct Report
+    {
+        CacheStats before;
+        CacheStats after;
+    };
+
+    // Simulate a FIFO cache (16 entries matches common hardware)
+    CacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+        unsigned int cacheSize = 16);
+
+    // destination may equal indices
+    void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // indices should already be cache-optimized. threshold: allowed ACMR degradation
+    // (1.05 = 5%) for additional cluster boundaries. positions: 3 floats per vertex, stride in bytes.
+    void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+        const float* positions, size_t vertexCount, size_t positionStride, float threshold = 1.05f);
+
+    // remap[old] = new, in order of first use; unreferenced vertices
+    // go to the end. Returns the number of referenced vertices.
+    size_t OptimizeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // Rewrite indices through remap (destination may equal indices)
+    void RemapIndices(uint32_t* destination, const uint32_t* indices, size_t indexCount, const uint32_t* remap);
+
+    // Reorder an attribute stream through remap (elementSize in bytes), destination != source
+    void RemapVertices(void* destination, const void* vertices, size_t vertexCount, size_t elementSize, const uint32_t* remap);
+}
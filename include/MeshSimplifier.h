@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================
+// Mesh simplification for LOD levels (pure CPU work, no D3D)
+//
+// Edge collapse with the quadric error metric (Garland/Heckbert): every vertex
+// accumulates the planes of its triangles, a collapse v -> t costs the distance
+// of t to the planes of v. Vertices are not moved, so the output references
+// the same vertex streams (run OptimizeVertexFetchRemap afterwards
+// to drop unused vertices).
+//
+// Seams and borders:
+//   - vertices with the same position but their own index (normal/UV seam)
+//     stay, so the attributes on both sides of the seam are preserved
+//   - open borders collapse only along the border, extra planes
+//     perpendicular to the border keep the outline
+//   - a collapse that would flip a triangle is rejected
+//
+// Error relative to the largest extent of the positions (0.01 = 1%).
+// ============================================================
+
+namespace MeshSimplifier
+{
+    // Reduce to at most targetIndexCount indices as long as the error stays below targetError.
+    // destination needs room for indexCount indices (may equal indices).
+    // positions: 3 floats per vertex, stride in bytes. resultError (optional): largest error.
+    // Returns the number of indices in destination.
+    size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+        const float* positions, size_t vertexCount, size_t positionStride,
+        size_t targetIndexCount, float targetError = 0.01f, float* resultError = nullptr);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// ============================================================
+// MipGenerator - mip chain for RGBA8 textures on the CPU (no D3D)
+//
+// Every level is made from the previous one (size halved, rounded down, at least 1),
+// separably: first vertical (whole source rows), then horizontal, four channels per XMVECTOR.
+//   Box:    area share of every source pixel (2x2 for even sizes, for odd ones
+//           three pixels with partial weights - no shift)
+//   Kaiser: Kaiser-windowed sinc, radius 1.5 target pixels, alpha 4 - sharper,
+//           less blur across the levels; overshoots are clamped
+//
+// Gamma: with srgb, RGB is linearized before filtering and encoded again afterwards
+// (alpha is always linear). Without it levels get darker where bright meets dark.
+// Intermediate levels stay float, rounding happens only when writing the bytes.
+//
+// Alpha coverage (cutouts, alpha test): per level alpha is scaled so that the
+// share of pixels with alpha >= alphaCutoff matches that of level 0. Without it
+// fences and foliage "melt" in the distance.
+//
+// jobs: row blocks of every level in parallel (pays off from about 64 rows).
+// The result is bit-identical with and without jobs.
+// ============================================================
+
+namespace MipGenerator
+{
+    enum class Filter
+    {
+        Box,
+        Kaiser
+    };
+
+    struct Options
+    {
+        Filter filter = Filter::Box;
+        bool srgb = true;               // filter RGB gamma-correctly (sRGB)
+        bool wrap = false;              // wrap the edges instead of clamping
+        bool preserveCoverage = false;  // keep the alpha coverage per level
+        float alphaCutoff = 0.5f;       // reference value of the alpha test
+        uint32_t maxLevels = 0;         // 0 = full chain down to 1x1, 1 = no mips
+    };
+
+    // Level 1..n of a chain; level 0 is the input image
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        size_t offset;                  // bytes into MipChain::data
+    };
+
+    struct MipChain
+    {
+        std::vector<uint8_t> data;      // RGBA8, levels back to back without gaps
+        std::vector<Level> levels;      // without level 0
+
+        const uint8_t* GetLevel(size_t i) const { return data.data() + levels[i].offset; }
+    };
+
+    // Number of levels including level 0 (1024x512 -> 11)
+    uint32_t CountLevels(uint32_t width, uint32_t height);
+
+    // rgba: width * height * 4 bytes, rows without gaps
+    void Generate(const uint8_t* rgba, uint32_t width, uint32_t height, MipChain& chain,
+        const Options& options = Options(), JobSystem* jobs = nullptr);
+
+    // Share of pixels with alpha >= cutoff (0..1)
+    float AlphaCoverage(const uint8_t* rgba, uint32_t width, uint32_t height, float cutoff);
+}
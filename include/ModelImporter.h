@@ -0,0 +1,121 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// ============================================================
+// ModelImporter - OBJ and glTF 2.0 into ready surface streams
+//
+// The result is a Model without D3D objects: meshes made of primitives (one surface each),
+// materials and nodes (instances of a mesh with a world matrix). ModelLoader
+// builds Mesh/Surface/Material from it.
+//
+// OBJ (+ MTL):
+//   1. split the file into blocks at line boundaries, parse the blocks in parallel
+//      (v/vt/vn/f, usemtl, o/g, mtllib), numbers with ParseFloat instead of strtof
+//   2. sum up the blocks' vertex counts, resolve indices (negative ones too)
+//   3. per primitive (object + material) in parallel: weld corners v/vt/vn into
+//      vertices through a hash table, split polygons as fans
+//
+// glTF 2.0 (.gltf with data: URIs or files next to it, .glb):
+//   parse the JSON, map/decode the buffers, read the primitives in parallel from the
+//   accessors (all component types, normalized, byteStride; triangle
+//   list/strip/fan). Nodes with TRS or a matrix are chained into world
+//   matrices. Primitives without indices are welded.
+//   Not supported: sparse accessors, morph targets, skinning,
+//   compression (Draco, Meshopt), embedded images.
+//
+// Coordinates: both formats are right-handed, the engine is left-handed (D3D).
+// Default (Options::leftHanded): mirror z and flip the triangles.
+// UVs: OBJ has its origin at the bottom left, v is flipped for D3D (top left).
+// ============================================================
+
+namespace ModelImporter
+{
+    struct Options
+    {
+        bool leftHanded = true;         // mirror z, flip triangles
+        bool generateNormals = true;    // missing normals area-weighted from the triangles
+        size_t chunkSize = 1 << 20;     // OBJ: bytes per block parsed in parallel
+    };
+
+    // Streams like Surface (position/normal/color/uv1/uv2/indices), empty streams are missing
+    struct Primitive
+    {
+        std::vector<DirectX::XMFLOAT3> positions;
+        std::vector<DirectX::XMFLOAT3> normals;
+        std::vector<DirectX::XMFLOAT4> colors;
+        std::vector<DirectX::XMFLOAT2> uv1;
+        std::vector<DirectX::XMFLOAT2> uv2;
+        std::vector<unsigned int> indices;  // triangle list
+        int material = -1;                  // index into Model::materials, -1 = default material
+    };
+
+    struct MeshData
+    {
+        std::string name;
+        std::vector<Primitive> primitives;
+    };
+
+    // Values like Material::MaterialData (transparency = alpha factor, 1 = opaque)
+    struct MaterialData
+    {
+        std::string name;
+        DirectX::XMFLOAT4 diffuse = { 1.0f, 1.0f, 1.0f, 1.0f };
+        DirectX::XMFLOAT4 specular = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float shininess = 32.0f;
+        float transparency = 1.0f;
+        bool blend = false;             // glTF alphaMode BLEND / OBJ d < 1
+        std::string texture;            // diffuse/base color texture, path relative to the working directory
+    };
+
+    // One instance of meshes[mesh]; world as in DirectXMath (row vectors, v * world)
+    struct Node
+    {
+        std::string name;
+        int mesh = -1;
+        DirectX::XMFLOAT4X4 world;
+    };
+
+    struct Model
+    {
+        std::vector<MeshData> meshes;
+        std::vector<MaterialData> materials;
+        std::vector<Node> nodes;        // OBJ: one node per mesh (identity)
+        size_t sourceBytes = 0;         // bytes read (file, MTL, buffers)
+
+        size_t GetTriangleCount() const;
+        size_t GetVertexCount() const;
+    };
+
+    // Format by extension (.obj, .gltf, .glb). jobs == nullptr: everything on the calling thread.
+    bool Import(const char* path, Model& model, const Options& options = Options(),
+        JobSystem* jobs = nullptr, std::string* error = nullptr);
+
+    // From memory; baseDir (with a trailing '/', or empty) for MTL, buffers and textures
+    bool ImportOBJ(const char* text, size_t size, const std::string& baseDir, Model& model,
+        const Options& options = Options(), JobSystem* jobs = nullptr, std::string* error = nullptr);
+    bool ImportGLTF(const uint8_t* data, size_t size, const std::string& baseDir, Model& model,
+        const Options& options = Options(), JobSystem* jobs = nullptr, std::string* error = nullptr);
+
+    // Decimal number at p (sign, fraction, exponent; not "inf"/"nan"), without
+    // locale and without a null terminator. Up to 19 significant digits, scaled with exact
+    // powers of ten. Returns the character after the number, nullptr if there is no number.
+    const char* ParseNumber(const char* p, const char* end, double& value);
+    const char* ParseFloat(const char* p, const char* end, float& value);
+
+    // Area-weighted normals (primitives without normals, before ConvertToLeftHanded)
+    void GenerateNormals(Primitive& primitive);
+
+    // Merge identical vertices (all streams bit-identical), rewrite the indices.
+    // Without indices: every vertex is a corner of the triangle list.
+    void WeldVertices(Primitive& primitive);
+
+    // Right-handed -> left-handed: mirror z, flip triangles or C * world * C
+    void ConvertToLeftHanded(Primitive& primitive);
+    void ConvertToLeftHanded(DirectX::XMFLOAT4X4& world);
+}
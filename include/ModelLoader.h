@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+
+class Entity;
+class Shader;
+
+// ============================================================
+// ModelLoader - imported models (OBJ/glTF, ModelImporter) into the engine
+//
+// One material per material of the model (name, colors, diffuse texture,
+// transparent queue with alpha blending). An engine mesh has exactly one
+// material, so an imported mesh becomes one engine mesh per material,
+// every primitive one surface. Every node becomes an instance: the first
+// uses the created meshes, further ones are CopyEntity copies (same
+// surfaces, instancing). Parsing and OptimizeSurface run on the worker
+// threads of the JobSystem, FillBuffer serially afterwards.
+//
+// Built on the Engine API (gidx.h), like Engine::LoadModel which only
+// delegates here. On failure every mesh, surface and material created so
+// far is deleted again; textures stay in the TextureManager's cache.
+// ============================================================
+
+namespace ModelLoader
+{
+    // entities: all created meshes. shader: for the new materials (nullptr = default shader).
+    // optimize: OptimizeSurface on the worker threads, before FillBuffer.
+    bool Load(std::vector<Entity*>& entities, const char* path, Shader* shader, bool optimize);
+}
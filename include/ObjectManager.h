@@ -9,14 +9,18 @@
 #include "Camera.h"
 #include "Material.h"
 #include "Shader.h"
+#include "RenderQueue.h"
+#include "AABBTree.h"
+#include "Frustum.h"
 
 
 class RenderManager;
+class JobSystem;
 
 class ObjectManager
 {
 public:
-    ObjectManager();
+    explicit ObjectManager(TransformSystem& transforms);
     ~ObjectManager();
     void Init() {}
 
@@ -27,6 +31,9 @@ public:
     Mesh* CreateMesh();
     Surface* CreateSurface();
 
+    // New mesh with the source's transform/material, the surfaces are shared (instancing)
+    Mesh* CopyMesh(Mesh* source);
+
     void RegisterRenderable(Mesh* mesh);
     void UnregisterRenderable(Mesh* mesh);
 
@@ -34,6 +41,13 @@ public:
     void AddSurfaceToMesh(Mesh* mesh, Surface* surface);
     void AddMeshToMaterial(Material* material, Mesh* mesh);
 
+    // Append an LOD level (coarser than the last): surfaces parallel to mesh->surfaces.
+    // The surfaces do not go into the RenderQueue; the RenderManager puts them in place of
+    // the base surface per view. screenSize: fraction of the screen height below which the level applies.
+    void AddMeshLOD(Mesh* mesh, const std::vector<Surface*>& surfaces, float screenSize, float error = 0.0f);
+    // Remove all LOD levels, delete LOD surfaces no longer in use
+    void ClearMeshLODs(Mesh* mesh);
+
     // Assign shader to material and keep buckets in sync
     void AssignShaderToMaterial(Shader* shader, Material* material);
 
@@ -63,12 +77,42 @@ public:
     void ProcessMesh();
     Surface* GetSurface(Mesh* mesh);
     Material* GetStandardMaterial() const;
+    Material* FindMaterial(const std::string& name) const;   // first material with that name, otherwise nullptr
     Shader* GetShader(const Surface& surface) const;
     Shader* GetShader(const Mesh& mesh) const;
     Shader* GetShader(const Material& material) const;
     const std::vector<Shader*>& GetShaders() const { return m_shaders; }
+    const std::vector<Mesh*>& GetMeshes() const { return m_meshes; }
+    // Mesh still exists: known address and same generation (DeleteMesh frees the address,
+    // a later CreateMesh can get it again). For requests that hold a Mesh* across frames.
+    bool IsMeshAlive(const Mesh* mesh, uint32_t generation) const;
+    const std::vector<Material*>& GetMaterials() const { return m_materials; }
+
+    // Kept up to date by all ADD/REMOVE/DELETE operations
+    const RenderQueue& GetRenderQueue() const { return m_renderQueue; }
+
+    // Scene tree: one leaf per mesh (CreateMesh/DeleteMesh), fat world AABBs
+    AABBTree& GetSceneTree() { return m_sceneTree; }
+    const AABBTree& GetSceneTree() const { return m_sceneTree; }
+
+    // Update the bounds of all meshes (in parallel) and follow up the leaves
+    // whose AABB left the fat box. Once per frame from UpdateWorld.
+    void UpdateBounds(JobSystem* jobs);
+
+    // Meshes whose world AABB intersects box / sphere / frustum (tree + exact test).
+    // out is cleared. Returns the number of hits.
+    size_t QueryBox(const DirectX::BoundingBox& box, std::vector<Mesh*>& out) const;
+    size_t QuerySphere(const DirectX::BoundingSphere& sphere, std::vector<Mesh*>& out) const;
+    size_t QueryFrustum(const Frustum& frustum, std::vector<Mesh*>& out) const;
 
 private:
+    // Another mesh still using the surface (new owner), otherwise nullptr
+    Mesh* FindSurfaceUser(Surface* surface, Mesh* except) const;
+    // mesh gives up the surface: with other users only drop the reference, otherwise delete
+    void ReleaseSurface(Mesh* mesh, Surface* surface);
+
+    TransformSystem& m_transforms;  // owned by GDXEngine
+
     std::vector<Entity*> m_entities;
     std::vector<Surface*> m_surfaces;
     std::vector<Mesh*> m_meshes;
@@ -76,5 +120,11 @@ private:
     std::vector<Camera*> m_cameras;
     std::vector<Material*> m_materials;
     std::vector<Shader*> m_shaders;
+    uint32_t m_meshGeneration = 0;
+
+    RenderQueue m_renderQueue;
+
+    AABBTree m_sceneTree;
+    std::vector<std::vector<Mesh*>> m_movedMeshes;  // per UpdateBounds block
 };
 
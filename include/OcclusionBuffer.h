@@ -0,0 +1,126 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// ============================================================
+// OcclusionBuffer - software occlusion culling on the CPU
+//
+// Selected occluders (large, simple meshes: walls, buildings, terrain) are
+// rasterized into a small depth buffer (default 256x128), then the bounds
+// of the remaining objects are tested against a max-depth pyramid (Hi-Z).
+//
+// Per frame:
+//   Begin(viewProjection) -> AddOccluder(...) per surface -> Rasterize(jobs)
+//   -> IsVisible(center, extents) any number of times, in parallel too
+//
+// Rasterize():
+//   1. per occluder (parallel): vertices into clip space, clip triangles at the
+//      near plane, reject back faces (D3D: clockwise = front),
+//      set up edge functions and the depth plane
+//   2. bin triangles into tiles (TILE_WIDTH x TILE_HEIGHT)
+//   3. per tile (parallel): 4 pixels per step (one XMVECTOR lane per pixel),
+//      depth = min(old, new); then the tile's first Hi-Z level
+//   4. remaining Hi-Z levels (2x2 -> max each)
+//
+// Depth as in D3D 0..1 (near..far), sampled at the pixel center. Gaps
+// narrower than a pixel are closed by the buffer - an object that would only be
+// visible through such a gap counts as occluded.
+// ============================================================
+
+struct OcclusionStats
+{
+    size_t occluders = 0;       // AddOccluder calls since Begin
+    size_t triangles = 0;       // triangles passed in
+    size_t rasterized = 0;      // after near clipping, back-face and screen-edge test
+};
+
+class OcclusionBuffer
+{
+public:
+    static constexpr uint32_t TILE_WIDTH = 32;
+    static constexpr uint32_t TILE_HEIGHT = 32;
+
+    OcclusionBuffer();
+
+    // Rounded up to multiples of the tile size
+    void Resize(uint32_t width, uint32_t height);
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+
+    // Size passed to the last Resize, before rounding to whole tiles
+    uint32_t GetRequestedWidth() const { return m_requestedWidth; }
+    uint32_t GetRequestedHeight() const { return m_requestedHeight; }
+
+    // New frame: clear the occluder list, keep viewProjection for occluders and tests
+    void Begin(DirectX::FXMMATRIX viewProjection);
+
+    // Triangle list in the local space of world. The data is only read in Rasterize()
+    // and must stay valid until then. Invalid indices are skipped.
+    void AddOccluder(const DirectX::XMFLOAT3* positions, size_t vertexCount,
+        const unsigned int* indices, size_t indexCount, DirectX::FXMMATRIX world);
+
+    // Rasterize all occluders and build the Hi-Z pyramid. jobs == nullptr: everything serial.
+    void Rasterize(JobSystem* jobs = nullptr);
+
+    // false only if the box lies completely behind the occluders. Boxes that cross the
+    // near plane or lie completely outside the screen count as visible.
+    // Read-only, may be called in parallel.
+    bool IsVisible(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents) const;
+
+    // Depth (0..1) after Rasterize, row by row (debug output, tests)
+    const float* GetDepth() const { return m_depth.data(); }
+    uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+    const OcclusionStats& GetStats() const { return m_stats; }
+
+private:
+    struct Occluder
+    {
+        const DirectX::XMFLOAT3* positions;
+        const unsigned int* indices;
+        size_t vertexCount;
+        size_t indexCount;
+        size_t firstVertex;         // in m_clip
+        size_t firstTriangle;       // in m_triangles (room for 2 per input triangle)
+        size_t triangleCount;       // after setup
+        DirectX::XMFLOAT4X4 worldViewProjection;
+    };
+
+    // Edge functions E = A * x + B * y + C and depth relative to the pixel center (minX, minY).
+    // A pixel is inside the triangle when all three E >= 0.
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthX, depthY, depth;
+        int minX, minY, maxX, maxY;
+    };
+
+    // Hi-Z level k + 1 (level 0 is m_depth)
+    struct Level
+    {
+        size_t offset;
+        uint32_t width, height;
+    };
+
+    void SetupOccluder(Occluder& occluder);
+    void EmitTriangle(Occluder& occluder, const DirectX::XMFLOAT4* clip);
+    void RasterizeTile(uint32_t tile);
+    const float* GetLevel(uint32_t level) const { return level == 0 ? m_depth.data() : m_hiz.data() + m_levels[level - 1].offset; }
+
+    uint32_t m_width = 0, m_height = 0;
+    uint32_t m_requestedWidth = 0, m_requestedHeight = 0;
+    uint32_t m_tilesX = 0, m_tilesY = 0;
+    DirectX::XMFLOAT4X4 m_viewProjection;
+    bool m_ready = false;
+
+    std::vector<Occluder> m_occluders;
+    std::vector<DirectX::XMFLOAT4> m_clip;          // clip-space vertices of all occluders
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_bins;      // triangles per tile
+    std::vector<float> m_depth;
+    std::vector<float> m_hiz;                       // levels 1..n back to back
+    std::vector<Level> m_levels;
+    OcclusionStats m_stats;
+};
@@ -2,8 +2,34 @@
 #include "ObjectManager.h"
 #include "LightManager.h"
 #include "RenderQueue.h"
+#include "Frustum.h"
+#include "ConstantBufferRing.h"
+#include "InstanceBatcher.h"
+#include "OcclusionBuffer.h"
 #include "gdxdevice.h"
-#include <d3d11.h>
+#include "gdxplatform.h"
+
+class JobSystem;
+
+// Result of the culling stage of the last frame
+struct CullStats
+{
+    size_t candidates = 0;          // draws (mesh/surface) of all materials
+    size_t visibleMain = 0;         // after the camera frustum (opaque + transparent)
+    size_t visibleTransparent = 0;  // of which transparent
+    size_t shadowCandidates = 0;    // draws with castShadows
+    size_t visibleShadow = 0;       // after the light frustum
+    size_t instanceGroups = 0;      // DrawIndexedInstanced calls (main + shadow)
+    size_t instances = 0;           // instances drawn by them
+    size_t dynamicUploads = 0;      // dynamic surfaces uploaded this frame
+    size_t uploadBytes = 0;         // vertex bytes written for them
+    size_t trianglesMain = 0;       // triangles drawn after LOD selection (opaque + transparent)
+    size_t trianglesShadow = 0;     // same for the shadow pass
+    size_t lodDraws = 0;            // draws with a simplified surface (LOD > 0, main + shadow)
+    size_t occluders = 0;           // surfaces rasterized into the occlusion buffer
+    size_t occluderTriangles = 0;   // their triangles
+    size_t occluded = 0;            // in the camera frustum but behind occluders (not drawn)
+};
 
 class RenderManager {
 public:
@@ -12,16 +38,124 @@ public:
 
     void SetCamera(LPENTITY camera);
     void SetDirectionalLight(LPENTITY dirLight);
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
     void RenderScene();
 
+    // Frustum culling (default: on). Off = all meshes are drawn.
+    void SetCullingEnabled(bool enabled) { m_cullingEnabled = enabled; }
+    bool IsCullingEnabled() const { return m_cullingEnabled; }
+
+    // Hierarchical culling over the ObjectManager's scene tree (default: on).
+    // Off = SIMD test of every candidate AABB (CullAABBs). The result is the same either way.
+    void SetTreeCullingEnabled(bool enabled) { m_treeCullingEnabled = enabled; }
+    bool IsTreeCullingEnabled() const { return m_treeCullingEnabled; }
+    const CullStats& GetCullStats() const { return m_cullStats; }
+
+    // Hardware instancing for meshes sharing a surface (default: on)
+    void SetInstancingEnabled(bool enabled) { m_instancingEnabled = enabled; }
+    bool IsInstancingEnabled() const { return m_instancingEnabled; }
+
+    // LOD selection per mesh from the projected size of its sphere (default: on).
+    // hysteresis: relative band around every threshold in which the last level stays (0.1 = ±10%).
+    // shadowBias: this many levels coarser in the shadow pass (default: 1).
+    void SetLODEnabled(bool enabled) { m_lodEnabled = enabled; }
+    bool IsLODEnabled() const { return m_lodEnabled; }
+    void SetLODHysteresis(float hysteresis) { m_lodHysteresis = hysteresis < 0.0f ? 0.0f : hysteresis; }
+    void SetShadowLODBias(uint32_t bias) { m_shadowLodBias = bias; }
+
+    // Occlusion culling (default: on, only takes effect with Mesh::occluder and frustum culling).
+    // Occluders are rasterized on the CPU into a small depth buffer every frame,
+    // then main-pass draws behind them drop out. The shadow pass is unchanged.
+    void SetOcclusionCullingEnabled(bool enabled) { m_occlusionEnabled = enabled; }
+    bool IsOcclusionCullingEnabled() const { return m_occlusionEnabled; }
+    OcclusionBuffer& GetOcclusionBuffer() { return m_occlusion; }
+
     // Phase 4: Shadow Mapping 2-Pass
     void RenderShadowPass();
     void RenderNormalPass();
 
 private:
-    RenderQueue m_opaque;
-    std::vector<DrawEntry> m_transCandidates; // registriert, aber nicht sortiert
-    std::vector<std::pair<float, DrawEntry>> m_transFrame; // pro Frame sortiert
+    // Flat copy of the ObjectManager's RenderQueue.
+    // Rebuilt only when the queue version changes.
+    struct DrawItem
+    {
+        Shader* shader;
+        Material* material;
+        Mesh* mesh;
+        Surface* surface;
+        uint32_t shaderIndex;
+        uint32_t materialIndex;
+        uint32_t surfaceIndex;      // dense id of the surface (instancing key)
+        uint32_t proxy;             // Mesh::sceneProxy
+        uint32_t lod;               // 0 = base surface, n = mesh->lods[n - 1] (follow the base directly)
+    };
+
+    // Culling: update the candidates, test against camera and light frustum,
+    // then build the sort keys and sort
+    void CullScene();
+    void BuildCandidates();
+    void CullPass(const Frustum& frustum, std::vector<uint8_t>& flags);
+    void CullTree(const Frustum& frustum, std::vector<uint8_t>& flags);
+    // Rasterize occluders, remove occluded candidates from m_mainFlags. Returns the occluded base draws
+    size_t OcclusionPass(const DirectX::XMMATRIX& viewProjection);
+
+    // Level from screenSize (fraction of the screen height) with hysteresis around mesh.lodLevel, stored in the mesh
+    uint32_t SelectLOD(Mesh& mesh, float screenSize) const;
+
+    std::vector<DrawItem> m_candidates;
+    uint32_t              m_queueVersion = 0xFFFFFFFFu;
+    BoundsSoA             m_bounds;         // world AABBs of the candidates (SoA)
+    std::vector<uint8_t>  m_mainFlags;
+    std::vector<uint8_t>  m_shadowFlags;
+    bool                  m_cullingEnabled = true;
+    bool                  m_treeCullingEnabled = true;
+    std::vector<uint8_t>  m_proxyFlags;     // per tree leaf: 0 outside, 1 edge, 2 fully inside
+    std::vector<uint32_t> m_edgeItems;      // candidates on a leaf at the frustum edge
+    BoundsSoA             m_edgeBounds;     // their AABBs, tested with CullAABBs
+    std::vector<uint8_t>  m_edgeFlags;
+    CullStats             m_cullStats;
+    JobSystem*            m_jobs = nullptr;
+
+    bool                  m_lodEnabled = true;
+    float                 m_lodHysteresis = 0.1f;
+    uint32_t              m_shadowLodBias = 1;
+
+    bool                  m_occlusionEnabled = true;
+    OcclusionBuffer       m_occlusion;
+
+    std::vector<SortedDraw> m_opaqueDraws;  // Main-Pass, front-to-back (Radix-Sort)
+    std::vector<SortedDraw> m_shadowDraws;  // shadow pass, by shader and light depth
+    std::vector<SortedDraw> m_sortScratch;
+    std::vector<std::pair<float, DrawEntry>> m_transFrame; // sorted back-to-front per frame
+
+    // Object matrices of both passes: written into the ring once per frame,
+    // each draw only binds with an offset (fallback: Mesh::Update with a Map per mesh)
+    void UploadObjectConstants();
+
+    // Upload the changed ranges of visible dynamic surfaces (once per frame)
+    void UploadDynamicSurfaces();
+
+    ConstantBufferRing    m_objectRing;
+    std::vector<uint32_t> m_shadowConstants;    // firstConstant per shadow draw
+    std::vector<uint32_t> m_mainConstants;      // firstConstant per main draw (opaque, then transparent)
+    bool                  m_ringActive = false;
+
+    // Instancing: visible draws of shared surfaces, grouped by (shader, material, surface)
+    bool CanInstance(const DrawItem& item) const;
+    void BuildInstanceGroups();
+    void DropInstanceGroups();      // upload failed: draw the groups one by one
+    // Applied to normals before the instance world (dequantize * world): the
+    // inverse dequantization scale of a quantized surface, identity otherwise
+    DirectX::XMMATRIX GroupNormalMatrix(const InstanceGroup& group) const;
+
+    bool                       m_instancingEnabled = true;
+    std::vector<SortedDraw>    m_instanceDraws;        // main pass
+    std::vector<SortedDraw>    m_shadowInstanceDraws;  // shadow pass
+    std::vector<InstanceGroup> m_mainGroups;
+    std::vector<InstanceGroup> m_shadowGroups;
+    InstanceBatcher            m_instances;
+    uint32_t                   m_shadowGroupConstant = 0;      // View/Projection of the light
+    std::vector<uint32_t>      m_mainGroupConstants;           // View/Projection + normal correction per group
 
     // Objekte im 3D Raum
     LPENTITY m_currentCam;
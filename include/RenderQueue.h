@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <unordered_map>
+#include <cstdint>
+#include <cstddef>
 
 class Shader;
 class Material;
@@ -21,8 +23,74 @@ struct ShaderBatch {
     std::unordered_map<Material*, size_t> matIndex;
 };
 
+// Persistent draw list: shader -> material -> (mesh, surface).
+// Maintained incrementally by the ObjectManager on every structural change,
+// so the RenderManager no longer walks pointer chains every frame.
+// version is bumped on every change.
 struct RenderQueue {
     std::vector<ShaderBatch> shaders;
     std::unordered_map<Shader*, size_t> shIndex;
+    uint32_t version = 0;
+
+    // File material (with all meshes/surfaces) under shader; shader == nullptr removes it
+    void AssignMaterial(Shader* shader, Material* material);
+    void RemoveMaterial(Material* material);
+    void RemoveShader(Shader* shader);
+
+    void AddMesh(Material* material, Mesh* mesh);
+    void RemoveMesh(Material* material, Mesh* mesh);
+
+    void AddSurface(Mesh* mesh, Surface* surface);
+    void RemoveSurface(Mesh* mesh, Surface* surface);
+
+    void Clear();
+
+private:
+    MaterialBatch* FindBatch(Material* material);
+    void EraseMaterialBatch(Shader* shader, Material* material);
+
+    std::unordered_map<Material*, Shader*> m_materialShader;   // which shader the material is filed under
 };
 
+// ==================== SORTING ====================
+
+// 64-bit sort key: pass (2) | shader (14) | material (16) | depth (32)
+struct SortedDraw {
+    uint64_t key;
+    uint32_t index;     // index into the RenderManager's flat candidate list
+};
+
+namespace RenderSortKey
+{
+    constexpr uint32_t PASS_OPAQUE = 0;
+    constexpr uint32_t PASS_ALPHATEST = 1;
+
+    // float -> monotonically increasing uint (negative depths too)
+    inline uint32_t DepthBits(float depth)
+    {
+        union { float f; uint32_t u; } v;
+        v.f = depth;
+        return (v.u & 0x80000000u) ? ~v.u : (v.u | 0x80000000u);
+    }
+
+    inline uint64_t Make(uint32_t pass, uint32_t shader, uint32_t material, float depth)
+    {
+        return (uint64_t(pass & 0x3u) << 62) |
+            (uint64_t(shader & 0x3FFFu) << 48) |
+            (uint64_t(material & 0xFFFFu) << 32) |
+            uint64_t(DepthBits(depth));
+    }
+
+    // Instancing: the surface id instead of the depth, equal keys = one group
+    inline uint64_t MakeInstanced(uint32_t pass, uint32_t shader, uint32_t material, uint32_t surface)
+    {
+        return (uint64_t(pass & 0x3u) << 62) |
+            (uint64_t(shader & 0x3FFFu) << 48) |
+            (uint64_t(material & 0xFFFFu) << 32) |
+            uint64_t(surface);
+    }
+}
+
+// LSD radix sort (8 bits per pass, stable). Passes in which all keys
+// share the same byte are skipped. scratch is reused.
+void RadixSortDraws(std::vector<SortedDraw>& draws, std::vector<SortedDraw>& scratch);
@@ -1,11 +1,11 @@
 ﻿// Shader.h
 #pragma once
 #include <vector>
-#include <d3d11.h>
-#include <d3dcompiler.h>
+#include "gdxplatform.h"
 #include <string>
 #include "gdxutil.h"
 #include "Material.h"
+#include "VertexPacking.h"
 
 /// <summary>
 /// Shader-Klasse - Verwaltet Vertex und Pixel Shader mit Blobs und Input Layout
@@ -54,6 +54,12 @@ public:
     // ==================== DIRECTX SHADER OBJEKTE ====================
     /// <summary>Input Layout - definiert Vertex-Struktur für diesen Shader</summary>
     ID3D11InputLayout* inputlayoutVertex;
+    /// <summary>
+    /// Input layouts of the remaining vertex formats (VertexFormat bits: interleaved,
+    /// quantized, both), same flags. [0] stays empty = inputlayoutVertex.
+    /// Created together with inputlayoutVertex while blobVS still exists.
+    /// </summary>
+    ID3D11InputLayout* inputlayoutFormats[VERTEX_FORMAT_COUNT];
     /// <summary>Compiled Vertex Shader</summary>
     ID3D11VertexShader* vertexShader;
     /// <summary>Compiled Pixel Shader</summary>
@@ -78,6 +84,14 @@ public:
     /// </summary>
     ID3D10Blob* blobPS;
 
+    // ==================== INSTANCING ====================
+    /// <summary>
+    /// Variant with a world matrix per instance (VertexShaderInstanced.hlsl).
+    /// Same vertex streams and registers; the RenderManager uses it for
+    /// groups of meshes sharing a surface. nullptr = no instancing.
+    /// </summary>
+    Shader* instancedVariant = nullptr;
+
     // ==================== MATERIAL-VERWALTUNG ====================
     /// <summary>Vector aller Materials die diesen Shader nutzen</summary>
     std::vector<Material*> materials;
@@ -94,6 +108,12 @@ public:
     /// </summary>
     void UpdateShader(const GDXDevice* device, ShaderBindMode mode = ShaderBindMode::VS_PS);
 
+    /// <summary>
+    /// Set the input layout matching the surface's vertex format
+    /// (after UpdateShader VERTEX_FORMAT_SEPARATE is active)
+    /// </summary>
+    void BindLayout(const GDXDevice* device, uint32_t vertexFormat) const;
+
     // ==================== HILFSMETHODEN ====================
     /// <summary>
     /// Gibt Vertex Shader Bytecode zurück (aus Blob)
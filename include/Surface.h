@@ -1,12 +1,19 @@
 #pragma once
 #include <vector>
-#include <d3d11.h>
+#include <memory>
+#include "gdxplatform.h"
 #include <DirectXMath.h>
+#include <DirectXCollision.h>
 #include "gdxutil.h"
 #include "gdxdevice.h"
+#include "MeshOptimizer.h"
+#include "VertexPacking.h"
+#include "DynamicVertexStream.h"
 
 
 class Mesh;    // forward
+class TriangleBVH;
+namespace MeshFile { struct CookedSurface; }
 
 class Surface {
 public:
@@ -19,15 +26,81 @@ public:
     void VertexTexCoords(unsigned int index, float u, float v);
     void AddIndex(UINT index);
 
+    // Bulk: set a whole stream at once (replaces existing data, one memcpy instead of
+    // push_back per vertex). The vector overloads take over the memory (move).
+    void Reserve(size_t vertexCount, size_t indexCount);
+    void SetPositions(const DirectX::XMFLOAT3* data, size_t count);
+    void SetPositions(std::vector<DirectX::XMFLOAT3>&& data);
+    void SetNormals(const DirectX::XMFLOAT3* data, size_t count);
+    void SetNormals(std::vector<DirectX::XMFLOAT3>&& data);
+    void SetColors(const DirectX::XMFLOAT4* data, size_t count);
+    void SetColors(std::vector<DirectX::XMFLOAT4>&& data);
+    void SetTexCoords(const DirectX::XMFLOAT2* data, size_t count);
+    void SetTexCoords(std::vector<DirectX::XMFLOAT2>&& data);
+    void SetTexCoords2(const DirectX::XMFLOAT2* data, size_t count);
+    void SetTexCoords2(std::vector<DirectX::XMFLOAT2>&& data);
+    void SetIndices(const unsigned int* data, size_t count);
+    void SetIndices(std::vector<unsigned int>&& data);
+
+    // Dynamic surface: vertices [first, first + count) of the attributes (D3DVERTEX_FLAGS)
+    // were changed directly in the streams. The setters above report their changes themselves.
+    // Positions also recompute the local bounds and bump the bounds revision, so
+    // mesh bounds, the scene tree and the triangle BVH see the new geometry.
+    void MarkDirty(DWORD attributes, UINT first, UINT count);
+
+    // Upload the changed ranges of all dynamic streams (once per frame, RenderManager)
+    HRESULT UploadDynamic(const GDXDevice* device, UINT& uploadedBytes);
+
+    // Reorder triangles for vertex cache and overdraw, vertices in order of use
+    // (all streams). Call before FillBuffer. overdrawThreshold <= 0: no overdraw step.
+    MeshOptimizer::Report Optimize(float overdrawThreshold = 1.05f);
+
+    // LOD: simplified copy of source (MeshSimplifier) with at most targetIndexCount
+    // indices and only the vertices still used in all streams. Takes over interleaved/
+    // quantizePositions; FillBuffer afterwards. false: lines, dynamic or no reduction.
+    bool SimplifyFrom(const Surface& source, size_t targetIndexCount, float targetError = 0.02f, float* resultError = nullptr);
+
+    // Pack the streams for the cooked format (MeshFile) exactly as FillBuffer would upload
+    // them for a shader with flagsVertex and vertexFormat (VertexFormat bits); missing
+    // attributes get the defaults of VertexPacking::Pack. Bounds are recomputed.
+    // false: lines or no triangles.
+    bool Cook(DWORD flagsVertex, uint32_t vertexFormat, MeshFile::CookedSurface& out) const;
+
     void Draw(const GDXDevice* m_device, const DWORD flags);
 
+    // Hardware instancing: world matrices come from instanceBuffer (slot after the vertex streams)
+    void DrawInstanced(const GDXDevice* device, const DWORD flags, ID3D11Buffer* instanceBuffer, UINT instanceCount, UINT startInstance);
+
     // Getter
     float GetVertexX(unsigned int index) const;
     float GetVertexY(unsigned int index) const;
     float GetVertexZ(unsigned int index) const;
+    unsigned int GetTriangleCount() const { return test ? 0u : size_listIndex / 3; }
 
     void CalculateSize(DirectX::XMMATRIX roationMatrix, DirectX::XMFLOAT3& minSize, DirectX::XMFLOAT3& maxSize);
 
+    // Recompute the local box/sphere once per geometry change (FillBuffer, UpdateVertexBuffer).
+    // The getters only read the cache: surfaces are read by several meshes in parallel.
+    void UpdateLocalBounds();
+    // Single vertices moved (AddVertex): the revision is already bumped, the box/sphere is
+    // recomputed here once for all edits. Serial only (ObjectManager::UpdateBounds, GetTriangleBVH).
+    void RefreshLocalBounds() { if (boundsDirty) UpdateLocalBounds(); }
+    void GetLocalBounds(DirectX::XMFLOAT3& minSize, DirectX::XMFLOAT3& maxSize) const;
+    // Bounds from outside (cooked file without CPU positions), bumps the revision
+    void SetLocalBounds(const DirectX::BoundingBox& box, const DirectX::BoundingSphere& sphere);
+    const DirectX::BoundingBox& GetLocalBox() const { return localBox; }
+    const DirectX::BoundingSphere& GetLocalSphere() const { return localSphere; }
+    bool HasLocalBounds() const { return hasLocalBounds; }
+    // Incremented on every recompute (meshes use it to detect changed geometry)
+    uint32_t GetBoundsRevision() const { return boundsRevision; }
+
+    // Triangle BVH for raycasts: built from position/indices on the first call after a
+    // geometry change (new bounds revision), cached otherwise. nullptr for lines
+    // or without triangles. Builds on the calling thread -> do not call in parallel.
+    const TriangleBVH* GetTriangleBVH();
+    // Read-only (parallel allowed): the BVH if it matches the current geometry
+    const TriangleBVH* GetCachedTriangleBVH() const;
+
 public:
     bool isActive = false;
 
@@ -61,10 +134,58 @@ public:
     ID3D11Buffer* uv2Buffer;
     ID3D11Buffer* indexBuffer;
 
-    Mesh* pMesh = nullptr;               
+    // Interleaved/packed (VertexPacking): set interleaved before FillBuffer,
+    // then one vertexBuffer instead of the per-attribute buffers
+    bool interleaved = false;
+    ID3D11Buffer* vertexBuffer;
+    UINT vertexStride;
+    DWORD vertexFlags;                   // attributes in the packed buffer (shader flags at FillBuffer)
+
+    // Quantized positions (UNORM16 against the surface AABB): set quantizePositions before
+    // FillBuffer. The dequantization goes before the world matrix (GetDequantizeMatrix).
+    bool quantizePositions = false;
+    bool positionsQuantized = false;
+    VertexPacking::Quantization quantization;
+
+    // Dynamic (set before FillBuffer): DYNAMIC buffer with a segment ring instead of DEFAULT,
+    // changes are recorded as ranges and uploaded with the next RenderWorld.
+    // Always separate float streams (interleaved/quantizePositions are ignored).
+    bool dynamic = false;
+    DynamicVertexStream dynamicStreams[DYNAMIC_STREAM_COUNT];
+
+    // FillBuffer: R16_UINT as long as all indices fit in 16 bits
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+
+    bool IsPacked() const { return vertexBuffer != nullptr; }
+    bool IsDynamic() const { return dynamicStreams[DYNAMIC_STREAM_POSITION].IsCreated(); }
+    bool IsQuantized() const { return positionsQuantized; }
+    uint32_t GetVertexFormat() const
+    {
+        return (IsPacked() ? VERTEX_FORMAT_INTERLEAVED : 0u) | (positionsQuantized ? VERTEX_FORMAT_QUANTIZED : 0u);
+    }
+    DirectX::XMMATRIX GetDequantizeMatrix() const { return VertexPacking::DequantizeMatrix(quantization); }
+    DirectX::XMMATRIX GetNormalMatrix() const { return VertexPacking::NormalMatrix(quantization); }
+
+    Mesh* pMesh = nullptr;               // owner (first mesh)
+    unsigned int userCount = 0;          // number of meshes using this surface (> 1: instancing group)
     DirectX::XMFLOAT3 minPoint;
     DirectX::XMFLOAT3 maxPoint;
 
+private:
+    DirectX::BoundingBox localBox;
+    DirectX::BoundingSphere localSphere;
+    bool hasLocalBounds = false;
+    bool boundsDirty = false;
+    uint32_t boundsRevision = 0;
+
+    std::unique_ptr<TriangleBVH> triangleBVH;
+    uint32_t triangleBVHRevision = 0;
+
+    unsigned int BindVertexStreams(const GDXDevice* device, const DWORD flags);
+
+    // Take size_list*/size_* from the streams after a bulk set
+    void UpdateStreamSizes();
+
 public:
     // ist daf�r gemacht um Linien zu rendern!
     bool test;
@@ -3,6 +3,9 @@
 #include <vector>
 #include <string>
 #include "gdxutil.h"
+#include "AssetLoader.h"
+#include "MipGenerator.h"
+#include "TextureCache.h"
 
 class Texture
 {
@@ -11,6 +14,10 @@ private:
 	D3D11_TEXTURE2D_DESC m_desc;
 	bool m_isLocked;
 
+	// Texture (all levels as initial data), view over the whole chain, sampler
+	HRESULT CreateResources(ID3D11Device* device, DXGI_FORMAT format, int width, int height,
+		const D3D11_SUBRESOURCE_DATA* subresourceData, UINT mipLevels);
+
 public:
 	Texture();
 	~Texture();
@@ -19,8 +26,21 @@ public:
 	ID3D11Texture2D* m_texture;
 	ID3D11ShaderResourceView* m_textureView;
 	ID3D11SamplerState* m_imageSamplerState;
-
-	HRESULT AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const wchar_t* filename);
+	AssetHandle m_asset;	// LoadTextureAsync: request at the AssetLoader, otherwise INVALID_ASSET
+
+	// With a full mip chain (MipGenerator, default: box, sRGB); jobs splits up the rows
+	HRESULT AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const wchar_t* filename,
+		const MipGenerator::Options& mipOptions = MipGenerator::Options(), JobSystem* jobs = nullptr);
+	// AddTexture in two steps (asynchronous loading, TextureManager::LoadTextureAsync):
+	// LoadPixels decodes as RGBA8 and needs no device (any thread), CreateFromPixels
+	// replaces texture/view/sampler (main thread)
+	static unsigned char* LoadPixels(const wchar_t* filename, int& width, int& height, std::string* error = nullptr);
+	static void FreePixels(unsigned char* pixels);
+	// mips: levels 1..n as initial data, the view covers all levels (nullptr = level 0 only)
+	HRESULT CreateFromPixels(ID3D11Device* device, const void* pixels, int width, int height,
+		const MipGenerator::MipChain* mips = nullptr);
+	// All levels from TextureCache::Load (RGBA8 or BC1/BC3/BC7)
+	HRESULT CreateFromCooked(ID3D11Device* device, const CookedTexture& cooked);
 	HRESULT CreateTexture(ID3D11Device* device, int width, int height);
 	HRESULT LockBuffer(ID3D11DeviceContext* deviceContext);
 	void UnlockBuffer(ID3D11DeviceContext* deviceContext);
@@ -0,0 +1,164 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BlockCompressor.h"
+#include "MeshFile.h"
+#include "MipGenerator.h"
+
+// ============================================================
+// TextureCache - fully encoded textures (all mips) on disk (.gdxt)
+//
+// Key: 64-bit hash (XXH64) over the bytes of the source file and all
+// settings that change the result (compression, mip options,
+// encoder version). File name = key in hex. Copied or renamed
+// images hit the same entry, modified ones get a new one; old
+// entries stay behind (delete the directory = clear the cache).
+//
+// Load(source file):
+//   hit:         map the entry (mmap) and validate it, the levels point directly
+//                into the mapping - nothing is decoded or copied
+//   no hit:      decode (stb_image), mips (MipGenerator), compress
+//                (BlockCompressor), store
+// Stores go through a temporary file and a rename: parallel
+// loader threads and aborted runs leave no half-written entries behind.
+// Broken or foreign entries (magic, version, key, sizes) count as
+// no hit and are overwritten.
+//
+// In D3D11, BC formats need the width and height of level 0 to be a multiple of 4.
+// Other sizes are stored as RGBA8 with mips (still saves the
+// decoding and the mips).
+//
+// Load/Find/Store are thread-safe, SetDirectory only before loading.
+// ============================================================
+
+enum class TextureCompression : uint32_t
+{
+    None,       // RGBA8 (TextureManager: without cache, as before)
+    Auto,       // BC1 without alpha, otherwise BC3
+    BC1,        // 0.5 bytes/pixel, alpha is lost
+    BC3,        // 1 byte/pixel
+    BC7         // 1 byte/pixel, best quality, requires feature level 11.0
+};
+
+enum class TextureFormat : uint32_t
+{
+    RGBA8,
+    BC1,
+    BC3,
+    BC7
+};
+
+namespace TextureFile
+{
+    constexpr uint32_t MAGIC = 0x54584447u;        // "GDXT"
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t ALIGNMENT = 16;
+
+    struct LevelRecord
+    {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;        // from the start of the file
+        uint64_t size;          // bytes
+        uint32_t rowPitch;      // bytes per row (BC: per block row)
+        uint32_t reserved;
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fileSize;
+        uint64_t key;           // TextureCache::MakeKey
+        uint32_t format;        // TextureFormat
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;    // including level 0
+        uint64_t levelOffset;
+    };
+
+    static_assert(sizeof(LevelRecord) == 32, "TextureFile: LevelRecord layout");
+    static_assert(sizeof(Header) == 48, "TextureFile: Header layout");
+}
+
+// Texture with all levels, in memory (freshly encoded) or mapped (cache hit)
+class CookedTexture
+{
+public:
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t rowPitch;
+        size_t offset;
+        size_t size;
+    };
+
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<Level> levels;          // level 0 first
+
+    const uint8_t* GetLevel(size_t i) const { return m_data + levels[i].offset; }
+    size_t GetDataSize() const;         // all levels
+    bool IsMapped() const { return m_file.GetData() != nullptr; }
+
+    // level 0 (rgba) and mips back to back, compressed unless RGBA8
+    void Build(const uint8_t* rgba, uint32_t width, uint32_t height, const MipGenerator::MipChain& mips,
+        TextureFormat format, JobSystem* jobs = nullptr);
+    void Reset();
+
+private:
+    friend class TextureCache;
+
+    std::vector<uint8_t> m_storage;
+    MeshFile::MappedFile m_file;
+    const uint8_t* m_data = nullptr;
+};
+
+struct TextureCacheStats
+{
+    size_t hits = 0;
+    size_t misses = 0;          // newly encoded
+    size_t stored = 0;
+    size_t rejected = 0;        // existing entries that failed validation
+};
+
+class TextureCache
+{
+public:
+    // Empty = no directory: still encodes, but anew on every load
+    void SetDirectory(const std::string& directory) { m_directory = directory; }
+    const std::string& GetDirectory() const { return m_directory; }
+
+    // Load a source file: hit from the cache, or encode anew and store.
+    // jobs: mips and compression in parallel (do not pass on the loader threads).
+    // false: the file is missing or is not a readable image (error)
+    bool Load(const char* path, TextureCompression compression, const MipGenerator::Options& mipOptions,
+        CookedTexture& out, JobSystem* jobs = nullptr, std::string* error = nullptr);
+
+    // XXH64
+    static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+    static uint64_t MakeKey(const void* source, size_t size, TextureCompression compression,
+        const MipGenerator::Options& mipOptions);
+
+    // Format for an image: RGBA8 for None or sizes that are not a multiple of 4
+    static TextureFormat ChooseFormat(TextureCompression compression, const uint8_t* rgba, uint32_t width, uint32_t height);
+
+    std::string GetPath(uint64_t key) const;
+    bool Find(uint64_t key, CookedTexture& out);
+    bool Store(uint64_t key, const CookedTexture& texture, std::string* error = nullptr);
+
+    TextureCacheStats GetStats() const;
+
+private:
+    std::string m_directory;
+    std::atomic<size_t> m_hits{ 0 };
+    std::atomic<size_t> m_misses{ 0 };
+    std::atomic<size_t> m_stored{ 0 };
+    std::atomic<size_t> m_rejected{ 0 };
+    std::atomic<uint32_t> m_storeCounter{ 0 };     // unique temporary file per Store call
+};
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <functional>
 #include "gdxutil.h"
 
 #include "Texture.h"
@@ -12,8 +13,14 @@ class TextureManager
 private:
 	typedef std::vector<LPTEXTURE> TextureContainer;
 	TextureContainer tc;
+	JobSystem* m_jobSystem;
+	MipGenerator::Options m_mipOptions;
+	TextureCompression m_compression;
+	TextureCache m_cache;
 
 	int  CheckTexture(std::wstring sFilename);
+	HRESULT LoadCooked(ID3D11Device* device, const wchar_t* filename, LPTEXTURE texture);
+	TextureCompression EffectiveCompression(ID3D11Device* device) const;
 
 	void ReleaseTexture(void);
 
@@ -24,7 +31,32 @@ public:
 
 	static TextureManager& Instance(void);
 
+	// LoadTexture builds the mip chain in parallel; LoadTextureAsync on the loader thread (without jobs)
+	void SetJobSystem(JobSystem* jobs) { m_jobSystem = jobs; }
+
+	// Applies to all textures loaded afterwards (maxLevels = 1: no mips)
+	void SetMipOptions(const MipGenerator::Options& options) { m_mipOptions = options; }
+	const MipGenerator::Options& GetMipOptions() const { return m_mipOptions; }
+
+	// Block compression for all textures loaded afterwards (default: None = RGBA8 as before).
+	// Encoding happens on the first load, afterwards the texture comes from the cache directory
+	// (GetCache().SetDirectory). Below feature level 11.0, BC7 becomes Auto.
+	void SetCompression(TextureCompression compression) { m_compression = compression; }
+	TextureCompression GetCompression() const { return m_compression; }
+	TextureCache& GetCache() { return m_cache; }
+
 	HRESULT LoadTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const wchar_t* filename, LPLPTEXTURE lpTexture);
+
+	// After the upload: rebind materials that have the placeholder bound
+	typedef std::function<void(Texture* texture, ID3D11ShaderResourceView* placeholder)> TextureReadyCallback;
+
+	// Returns right away with a 1x1 texture as placeholder (placeholder = R8G8B8A8 pixel, little
+	// endian 0xAABBGGRR, default white); decoding
+	// on the loader threads, upload in AssetLoader::Update. Same file name = same texture
+	// and same handle (INVALID_ASSET if it was loaded synchronously).
+	// device == nullptr (null backend): only decode, no GPU resources.
+	AssetHandle LoadTextureAsync(ID3D11Device* device, const wchar_t* filename, LPLPTEXTURE lpTexture,
+		AssetLoader& loader, TextureReadyCallback onReady, UINT32 placeholder = 0xFFFFFFFF);
 };
 typedef TextureManager* LPTEXTUREMANAGER;
 
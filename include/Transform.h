@@ -1,54 +1,47 @@
 #pragma once
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
-#include "gdxutil.h"
+#include "TransformSystem.h"
 
 enum class Space {
     Local,
     World
 };
 
+// A Transform is only a handle into the TransformSystem pools
+// (position, quaternion, scale, cached world matrix).
+// The public API is unchanged.
 class Transform
 {
 private:
-    // INTERNE SPEICHERUNG MIT QUATERNIONEN
-    DirectX::XMVECTOR position;          // W=1.0f
-    DirectX::XMVECTOR rotationQuat;      // Quaternion (X, Y, Z, W)
-    DirectX::XMVECTOR scale;             // W=0.0f
-
-    // GECACHTE MATRIZEN (mutable fr const Getter)
-    mutable DirectX::XMMATRIX rotationMatrix;
-    mutable DirectX::XMMATRIX translationMatrix;
-    mutable DirectX::XMMATRIX scalingMatrix;
-    mutable bool matricesDirty;
+    // HANDLE INTO THE SOA POOLS
+    TransformSystem::Handle handle;
+    TransformSystem* system;    // owner of the handle (GDXEngine::GetTransformSystem)
 
     // EXTERNE REFERENZ (nicht mutable - nur zum Schreiben)
     DirectX::XMMATRIX* worldMatrix;
 
-    // CACHED DIRECTION VECTORS (mutable fr const Getter)
-    mutable DirectX::XMVECTOR lookAt;
-    mutable DirectX::XMVECTOR up;
-    mutable DirectX::XMVECTOR right;
-    mutable bool vectorsDirty;
-
     // PRIVATE METHODEN
-    void UpdateMatrices() const;
-    void UpdateDirectionVectors() const;
     DirectX::XMVECTOR EulerToQuaternion(float pitch, float yaw, float roll) const;
     void QuaternionToEuler(const DirectX::XMVECTOR& quat, float& pitch, float& yaw, float& roll) const;
 
+    TransformSystem& System() const { return *system; }
+
 public:
     // =========== KONSTRUKTOREN ===========
-    Transform();
-    explicit Transform(DirectX::XMMATRIX* world);
+    explicit Transform(TransformSystem& transformSystem);
+    Transform(TransformSystem& transformSystem, DirectX::XMMATRIX* world);
+    Transform(const Transform& other);
+    Transform(Transform&& other) noexcept;
+    Transform& operator=(const Transform& other);
     ~Transform();
 
     // =========== EXISTIERENDE API ===========
-    void SetWorldMatrix(DirectX::XMMATRIX* world) { worldMatrix = world; matricesDirty = true; }
+    void SetWorldMatrix(DirectX::XMMATRIX* world) { worldMatrix = world; System().MarkDirty(handle); }
 
     DirectX::XMMATRIX GetLocalTransformationMatrix() const;
     DirectX::XMMATRIX* GetWorldTransformationMatrix() const { return worldMatrix; }
-    DirectX::XMVECTOR GetPosition() const { return position; }
+    DirectX::XMVECTOR GetPosition() const { return System().LoadPosition(handle); }
     DirectX::XMVECTOR GetLookAt() const;
     DirectX::XMVECTOR GetUp() const;
     DirectX::XMVECTOR GetRight() const;
@@ -67,7 +60,7 @@ public:
     // =========== NEUE FEATURES ===========
 
     // 1. QUATERNION-METHODEN
-    DirectX::XMVECTOR GetRotationQuaternion() const { return rotationQuat; }
+    DirectX::XMVECTOR GetRotationQuaternion() const { return System().LoadRotation(handle); }
     void SetRotationQuaternion(const DirectX::XMVECTOR& quaternion);
     void RotateQuaternion(const DirectX::XMVECTOR& quaternion, Space space = Space::Local);
 
@@ -77,7 +70,7 @@ public:
     float GetRoll() const;      // In Grad
 
     // 3. SKALIERUNG GETTER/SETTER
-    DirectX::XMVECTOR GetScaleVector() const { return scale; }
+    DirectX::XMVECTOR GetScaleVector() const { return System().LoadScale(handle); }
     void SetScale(float x, float y, float z);
     void SetScale(float uniformScale);
 
@@ -90,9 +83,15 @@ public:
     void Slerp(const Transform& target, float t);
 
     // 6. HELPER
-    bool HasChanged() const { return matricesDirty; }
-    void SetChanged(bool changed = true) { matricesDirty = changed; if (changed) vectorsDirty = true; }
+    bool HasChanged() const { return System().IsDirty(handle); }
+    void SetChanged(bool changed = true);
     DirectX::XMMATRIX GetWorldMatrix() const;
+    TransformSystem::Handle GetHandle() const { return handle; }
+    TransformSystem& GetSystem() const { return *system; }
+
+    // false after the Transform was moved from; every accessor then works on
+    // identity values and setters are ignored until it is assigned again
+    bool IsValid() const { return handle != TransformSystem::INVALID_HANDLE; }
 
     // 7. TRANSFORM COMBINATIONS
     Transform Combine(const Transform& other) const;
@@ -0,0 +1,86 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+class JobSystem;
+
+// ============================================================
+// TransformSystem
+//
+// Central structure-of-arrays pools for all transforms.
+// A Transform is only a handle (index) into these pools:
+//
+//   positions[i]  XMFLOAT3     (12 bytes)
+//   rotations[i]  XMFLOAT4A    (quaternion, 16 bytes)
+//   scales[i]     XMFLOAT3     (12 bytes)
+//   world[i]      XMFLOAT4X4A  (cached S*R*T, 64 bytes)
+//
+// Changes mark the entry as dirty. UpdateWorldMatrices() then
+// rebuilds only the dirty entries in one linear pass.
+// Every rebuild bumps the entry's version; dependent caches
+// (e.g. the OBB of a mesh) only compare the version.
+// Not thread-safe: call Allocate/Release from the game thread only.
+//
+// Owned by GDXEngine (GDXEngine::GetTransformSystem); every Transform
+// keeps a pointer to the system it was allocated from. Accessors accept
+// INVALID_HANDLE (moved-from Transform) and return identity values.
+// ============================================================
+class TransformSystem
+{
+public:
+    typedef uint32_t Handle;
+    static constexpr Handle INVALID_HANDLE = 0xFFFFFFFFu;
+
+    TransformSystem() = default;
+
+    Handle Allocate();
+    void Release(Handle handle);
+
+    // ==================== POOL ACCESS ====================
+    DirectX::XMVECTOR LoadPosition(Handle handle) const;   // W = 1
+    DirectX::XMVECTOR LoadRotation(Handle handle) const;
+    DirectX::XMVECTOR LoadScale(Handle handle) const;      // W = 0
+
+    void StorePosition(Handle handle, DirectX::FXMVECTOR position);
+    void StoreRotation(Handle handle, DirectX::FXMVECTOR rotation);
+    void StoreScale(Handle handle, DirectX::FXMVECTOR scale);
+
+    // ==================== DIRTY TRACKING ====================
+    void MarkDirty(Handle handle);
+    bool IsDirty(Handle handle) const { return IsValid(handle) && m_dirty[handle] != 0; }
+    uint32_t GetVersion(Handle handle) const { return IsValid(handle) ? m_versions[handle] : 0; }
+
+    // false for INVALID_HANDLE and handles this system never handed out
+    bool IsValid(Handle handle) const { return handle < m_positions.size(); }
+
+    // Returns the world matrix; a dirty entry is recomputed immediately
+    DirectX::XMMATRIX GetWorldMatrix(Handle handle);
+
+    // Rebuilds all dirty world matrices. Returns the number of recomputed entries.
+    // With a JobSystem, large dirty sets are spread over all cores.
+    size_t UpdateWorldMatrices(JobSystem* jobs = nullptr);
+
+    // S*R*T from position, quaternion and scale
+    static DirectX::XMMATRIX ComposeWorld(DirectX::FXMVECTOR position, DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR scale);
+
+    size_t GetCount() const { return m_positions.size() - m_freeList.size(); }
+    size_t GetCapacity() const { return m_positions.size(); }
+    size_t GetDirtyCount() const { return m_dirtyList.size(); }
+
+private:
+    TransformSystem(const TransformSystem&) = delete;
+    TransformSystem& operator=(const TransformSystem&) = delete;
+
+    void UpdateEntry(Handle handle);
+
+    std::vector<DirectX::XMFLOAT3>     m_positions;
+    std::vector<DirectX::XMFLOAT4A>    m_rotations;
+    std::vector<DirectX::XMFLOAT3>     m_scales;
+    std::vector<DirectX::XMFLOAT4X4A>  m_worldMatrices;
+
+    std::vector<uint8_t>  m_dirty;      // 1 = world matrix out of date
+    std::vector<uint32_t> m_versions;   // bumped on every rebuild
+    std::vector<Handle>  m_dirtyList;   // candidates for the next sweep
+    std::vector<Handle>  m_freeList;    // reusable slots
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cfloat>
+#include <vector>
+
+// ============================================================
+// TriangleBVH - static BVH over the triangles of a surface (raycasts)
+//
+// Built top-down with binned SAH, leaves with up to LEAF_SIZE triangles
+// (more only if a split would cost more or the maximum depth is reached).
+// Nodes: 32 bytes, both children are adjacent (first, first + 1).
+// Triangles are copied in leaf order as v0/e1/e2, so the query reads
+// no indices and no vertex streams. The hit's face normal also comes from
+// this copy: it matches the geometry the BVH was built from, even when the
+// surface's arrays have changed since.
+//
+// Queries in the local space of the positions:
+//   - Intersect():  one ray, closest hit or any hit (anyHit)
+//   - Intersect4(): 4 rays as a SIMD packet (one lane per ray). A node is
+//     visited when at least one active lane hits it; the triangle test
+//     runs for all 4 lanes at once. Pays off for coherent rays.
+// Both paths compute the triangle test (Möller-Trumbore, two-sided) in the same
+// order and return the same hits.
+// ============================================================
+
+struct TriangleHit
+{
+    float distance = FLT_MAX;   // in: maximum distance, out: distance of the hit
+    float u = 0.0f;             // barycentric: p = v0 + u * (v1 - v0) + v * (v2 - v0)
+    float v = 0.0f;
+    uint32_t triangle = 0xFFFFFFFFu;    // triangle in the index list (indices[3 * triangle])
+    DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 0.0f };   // face normal e1 x e2 (local, not normalized)
+};
+
+// 4 rays SoA, lane i = ray i
+struct RayPacket
+{
+    alignas(16) float origin[3][4];
+    alignas(16) float direction[3][4];
+    alignas(16) float inverse[3][4];    // 1 / direction (slab test), never infinite
+
+    void Set(int lane, const DirectX::XMFLOAT3& rayOrigin, const DirectX::XMFLOAT3& rayDirection);
+};
+
+class TriangleBVH
+{
+public:
+    static constexpr uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+    static constexpr uint32_t LEAF_SIZE = 4;
+
+    TriangleBVH() = default;
+
+    // indices == nullptr: every three consecutive positions form a triangle.
+    // Triangles with invalid indices or without area are skipped.
+    void Build(const DirectX::XMFLOAT3* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount);
+    void Clear();
+
+    bool Empty() const { return m_nodes.empty(); }
+
+    // Closest hit with a distance in [0, hit.distance). direction need not be normalized,
+    // the distance counts in multiples of direction. anyHit: stop at the first hit.
+    bool Intersect(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, TriangleHit& hit, bool anyHit = false) const;
+
+    // Like Intersect() for the lanes in activeMask (bit i = lane i). Returns the lanes with a hit
+    uint32_t Intersect4(const RayPacket& packet, TriangleHit hits[4], uint32_t activeMask = 0xF, bool anyHit = false) const;
+
+    size_t GetTriangleCount() const { return m_triangles.size(); }
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    size_t GetMemoryUsage() const;
+    int GetDepth() const { return m_depth; }
+
+private:
+    struct Node
+    {
+        DirectX::XMFLOAT3 lower;
+        uint32_t first;             // internal node: left child, leaf: first triangle
+        DirectX::XMFLOAT3 upper;
+        uint32_t count;             // 0 = internal node
+    };
+
+    struct Triangle
+    {
+        DirectX::XMFLOAT3 v0;
+        DirectX::XMFLOAT3 e1;       // v1 - v0
+        DirectX::XMFLOAT3 e2;       // v2 - v0
+    };
+
+    struct BuildItem
+    {
+        DirectX::XMFLOAT3 lower;
+        DirectX::XMFLOAT3 upper;
+        DirectX::XMFLOAT3 centroid;
+        uint32_t triangle;
+    };
+
+    // Deeper nodes become leaves -> the traversal stack has a fixed size
+    static constexpr int MAX_DEPTH = 60;
+    static constexpr int STACK_SIZE = MAX_DEPTH + 4;
+
+    // SAH split of a node: reorders items, returns the count on the left (0: stay a leaf)
+    static size_t SplitRange(BuildItem* items, size_t count, const Node& node);
+
+    std::vector<Node> m_nodes;              // root = 0
+    std::vector<Triangle> m_triangles;      // leaf order
+    std::vector<uint32_t> m_triangleIds;    // leaf order -> triangle of the index list
+    int m_depth = 0;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "gdxplatform.h"
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+#include "gdxutil.h"
+#include "VertexQuantization.h"
+
+class Surface;
+
+// ============================================================
+// Interleaved, packed vertex format (opt-in per surface)
+//
+// One vertex buffer instead of one per attribute, layout built once from
+// the shader's D3DVERTEX_FLAGS mask. Compressed attributes:
+//
+//   POSITION  R32G32B32_FLOAT     12 bytes
+//   NORMAL    R16G16B16A16_SNORM   8 bytes (w = 0)
+//   COLOR     R8G8B8A8_UNORM       4 bytes
+//   TEXCOORD  R16G16_FLOAT         4 bytes (UV1, UV2)
+//
+// The shader still reads float3/float4/float2, the input assembler
+// unpacks. Position+normal+color+UV1: 28 instead of 48 bytes per vertex.
+//
+// Optionally the position quantized (R16G16B16A16_UNORM, 8 bytes)
+// relative to the surface AABB, see VertexQuantization.h.
+// ============================================================
+
+// Vertex format of a surface (bits), index into Shader::inputlayoutFormats
+enum VertexFormat : uint32_t
+{
+    VERTEX_FORMAT_SEPARATE = 0,         // one buffer per attribute, float
+    VERTEX_FORMAT_INTERLEAVED = 1 << 0, // one packed buffer
+    VERTEX_FORMAT_QUANTIZED = 1 << 1,   // position UNORM16 against the surface AABB
+    VERTEX_FORMAT_COUNT = 4
+};
+
+namespace VertexPacking
+{
+    constexpr UINT NOT_PRESENT = 0xFFFFFFFFu;
+
+    struct Layout
+    {
+        DWORD flags = 0;
+        bool quantizedPosition = false;
+        UINT stride = 0;
+        UINT offsetPosition = NOT_PRESENT;
+        UINT offsetNormal = NOT_PRESENT;
+        UINT offsetColor = NOT_PRESENT;
+        UINT offsetUV1 = NOT_PRESENT;
+        UINT offsetUV2 = NOT_PRESENT;
+    };
+
+    // Offsets in the order of the separate streams (position, normal, color, UV1, UV2)
+    Layout MakeLayout(DWORD flags, bool quantizedPosition = false);
+
+    // Input elements for slot (all attributes in one stream)
+    void MakeInputElements(const Layout& layout, UINT slot, std::vector<D3D11_INPUT_ELEMENT_DESC>& elements);
+
+    // Pack the surface's vertices into out (size = stride * vertex count).
+    // Missing attributes: normal (0,0,1), color white, UV 0.
+    // A quantized position uses surface.quantization.
+    void Pack(const Surface& surface, const Layout& layout, std::vector<uint8_t>& out);
+    // The same with its own quantization (Surface::Cook, without changing the surface)
+    void Pack(const Surface& surface, const Layout& layout, const Quantization& quantization, std::vector<uint8_t>& out);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================
+// Quantized positions (R16G16B16A16_UNORM against the surface AABB)
+//
+// Position = q * scale + offset with q in [0, 1]. The dequantization is
+// multiplied in front of the world matrix, so the shader reads plain
+// float positions. Normals must not see that scale: they use
+// MatrixSet::normalMatrix (the pure world matrix), instance groups
+// multiply with NormalMatrix() before the per-instance world matrix.
+//
+// Extents are clamped to MIN_EXTENT: a planar surface (one axis of
+// size 0) keeps an invertible dequantization matrix.
+//
+// Platform-neutral (no D3D11 headers); VertexPacking builds the vertex
+// buffers on top of it.
+// ============================================================
+
+namespace VertexPacking
+{
+    constexpr float MIN_EXTENT = 1e-6f;
+
+    struct Quantization
+    {
+        DirectX::XMFLOAT3 offset = { 0.0f, 0.0f, 0.0f };
+        DirectX::XMFLOAT3 scale = { 1.0f, 1.0f, 1.0f };
+    };
+
+    Quantization ComputeQuantization(const DirectX::XMFLOAT3* positions, size_t count);
+
+    // 4 x uint16 per vertex (w = 0), matching R16G16B16A16_UNORM
+    void QuantizePositions(const DirectX::XMFLOAT3* positions, size_t count, const Quantization& quantization, std::vector<uint16_t>& out);
+
+    // In front of the world matrix (row vectors: v * Dequantize * World)
+    DirectX::XMMATRIX DequantizeMatrix(const Quantization& quantization);
+
+    // Inverse scale of DequantizeMatrix: a normal multiplied with it and then
+    // with Dequantize * World ends up as normal * World
+    DirectX::XMMATRIX NormalMatrix(const Quantization& quantization);
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <mutex>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <unordered_set>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+// ============================================================
+// Debug (header-only), thread-safe
+//
+// Platform-neutral so the CPU modules (JobSystem, loaders, texture
+// cache ...) can log without pulling in the D3D11 headers of
+// gdxutil.h. On Windows every line additionally goes to
+// OutputDebugStringA; LogWin32 exists only there.
+// ============================================================
+
+class Debug
+{
+public:
+    static inline bool s_outputDebugString = true;
+
+    template<typename... Args>
+    static void Log(Args&&... args) { Write("[LOG] ", std::cout, std::forward<Args>(args)...); }
+
+    template<typename... Args>
+    static void LogWarning(Args&&... args) { Write("[WARNING] ", std::cout, std::forward<Args>(args)...); }
+
+    template<typename... Args>
+    static void LogError(Args&&... args) { Write("[ERROR] ", std::cerr, std::forward<Args>(args)...); }
+
+    // Once in total (without arguments)
+    static void LogOnce()
+    {
+        constexpr const char* key = "__Debug_LogOnce_NoArgs__";
+        if (!TryMarkSeen(key)) return;
+        Log("LogOnce() fired");
+    }
+
+    // Once per key, without further arguments: the key is logged as message
+    static void LogOnce(const char* key)
+    {
+        if (!TryMarkSeen(key)) return;
+        Log(key);
+    }
+
+    // Once per key, with arguments: the arguments are logged
+    template<typename... Args>
+    static void LogOnce(const char* key, Args&&... args)
+    {
+        if (!TryMarkSeen(key)) return;
+        Log(std::forward<Args>(args)...);
+    }
+
+#ifdef _WIN32
+    static void LogHr(const char* file, int line, HRESULT hr)
+    {
+        if (SUCCEEDED(hr)) return;
+        LogError(file, ":", line, " -> ", FormatWin32Message((DWORD)hr),
+            " (HRESULT=0x", std::hex, std::uppercase, (DWORD)hr, ")");
+    }
+
+    static void LogWin32(const char* file, int line)
+    {
+        DWORD err = GetLastError();
+        if (err == 0) return;
+        LogError(file, ":", line, " -> ", FormatWin32Message(err),
+            " (Win32=0x", std::hex, std::uppercase, err, ")");
+    }
+#else
+    // HRESULT as in gdxplatform.h
+    static void LogHr(const char* file, int line, int32_t hr)
+    {
+        if (hr >= 0) return;
+        LogError(file, ":", line, " -> HRESULT=0x", std::hex, std::uppercase, static_cast<uint32_t>(hr));
+    }
+#endif
+
+private:
+    inline static std::mutex s_mutex;
+
+    // Shared once-state
+    inline static std::unordered_set<std::string> s_seenOnce;
+    inline static std::mutex s_onceMutex;
+
+    static bool TryMarkSeen(const char* key)
+    {
+        if (!key) key = "__null__";
+
+        std::lock_guard<std::mutex> lock(s_onceMutex);
+        return s_seenOnce.emplace(key).second;
+    }
+
+    static std::string Now()
+    {
+        using namespace std::chrono;
+        const auto now = system_clock::now();
+        const auto t = system_clock::to_time_t(now);
+
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+
+        const auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
+
+        std::ostringstream oss;
+        oss << std::setfill('0')
+            << std::setw(2) << tm.tm_hour << ":"
+            << std::setw(2) << tm.tm_min << ":"
+            << std::setw(2) << tm.tm_sec << "."
+            << std::setw(3) << ms.count();
+        return oss.str();
+    }
+
+#ifdef _WIN32
+    static std::string FormatWin32Message(DWORD code)
+    {
+        if (code == 0) return "OK";
+
+        LPSTR buf = nullptr;
+        DWORD len = FormatMessageA(
+            FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+            nullptr, code, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+            (LPSTR)&buf, 0, nullptr);
+
+        std::string msg = "Unknown error";
+        if (len && buf)
+        {
+            msg.assign(buf, buf + len);
+            while (!msg.empty() && (msg.back() == '\n' || msg.back() == '\r')) msg.pop_back();
+        }
+        if (buf) LocalFree(buf);
+        return msg;
+    }
+#endif
+
+    // UTF-16 (Windows) or UTF-32 (elsewhere) to UTF-8
+    static std::string WideToUtf8(const wchar_t* wstr)
+    {
+        if (!wstr) return {};
+#ifdef _WIN32
+        int needed = WideCharToMultiByte(CP_UTF8, 0, wstr, -1, nullptr, 0, nullptr, nullptr);
+        if (needed <= 0) return {};
+        std::string out;
+        out.resize(static_cast<size_t>(needed - 1));
+        WideCharToMultiByte(CP_UTF8, 0, wstr, -1, out.data(), needed, nullptr, nullptr);
+        return out;
+#else
+        std::string out;
+        for (; *wstr; ++wstr)
+        {
+            const uint32_t c = static_cast<uint32_t>(*wstr);
+            if (c < 0x80)
+            {
+                out += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (c >> 6));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (c >> 12));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (c >> 18));
+                out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return out;
+#endif
+    }
+
+    template<typename T>
+    static void Append(std::ostringstream& oss, const T& t) { oss << t; }
+
+    static void Append(std::ostringstream& oss, const wchar_t* w) { oss << WideToUtf8(w); }
+    static void Append(std::ostringstream& oss, const std::wstring& w) { oss << WideToUtf8(w.c_str()); }
+
+    template<typename T, typename... Args>
+    static void AppendAll(std::ostringstream& oss, const T& t, Args&&... args)
+    {
+        Append(oss, t);
+        if constexpr (sizeof...(args) > 0) AppendAll(oss, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    static void Write(const char* prefix, std::ostream& stream, Args&&... args)
+    {
+        std::ostringstream oss;
+        oss << Now() << " " << prefix;
+        AppendAll(oss, std::forward<Args>(args)...);
+
+        const std::string line = oss.str();
+
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            stream << line << "\n";
+            stream.flush();
+        }
+#ifdef _WIN32
+        if (s_outputDebugString)
+            OutputDebugStringA((line + "\n").c_str());
+#endif
+    }
+};
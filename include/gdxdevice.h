@@ -1,9 +1,17 @@
 ﻿#pragma once
 
-#include <d3d11.h>
-#include <dxgi.h>
+#include "gdxplatform.h"
 #include <vector>
 #include "gdxutil.h"  // ← WICHTIG: War vorher nicht included!
+#include "gdxnulldevice.h"
+
+// Which backend sits behind GDXDevice.
+// Null: no D3D11, every context call goes to GDXNullDevice (headless / profiling)
+enum class GDXBackend
+{
+	D3D11,
+	Null
+};
 
 
 struct GXDEVICE
@@ -68,9 +76,18 @@ private:
 	// Initialization state
 	bool m_bInitialized;
 
+	// Backend (D3D11 or Null). The null device is internally synchronized,
+	// so the const context wrappers may record into it.
+	GDXBackend m_backend;
+	mutable GDXNullDevice m_nullDevice;
+	UINT m_nullShadowWidth;
+	UINT m_nullShadowHeight;
+
 	// Device and context
 	ID3D11Device* m_pd3dDevice;
 	ID3D11DeviceContext* m_pContext;
+	ID3D11DeviceContext1* m_pContext1;		// D3D11.1, nullptr if not available
+	bool m_constantBufferOffsets;			// *SSetConstantBuffers1 with offsets usable
 
 	// Swap chain and render target
 	IDXGISwapChain* m_pSwapChain;
@@ -122,8 +139,13 @@ public:
 
 	// Initialization
 	HRESULT Init();
+	HRESULT InitNull();
 	void Release();
 
+	// Null backend: creates the CPU-side stand-ins for the GPU resources
+	// the frame loop needs (shadow matrix buffer, shadow map size).
+	HRESULT CreateNullResources(UINT shadowWidth, UINT shadowHeight);
+
 	// Device initialization
 	HRESULT InitializeDirectX(IDXGIAdapter* adapter, D3D_FEATURE_LEVEL* featureLevel);
 
@@ -149,6 +171,45 @@ public:
 	// Presentation
 	HRESULT Flip(int syncInterval);
 
+	// ==================== RESOURCE / CONTEXT WRAPPERS ====================
+	// All per-frame calls go through these functions so the null backend
+	// can record them. The D3D11 backend forwards them 1:1.
+	HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Buffer** buffer) const;
+
+	HRESULT Map(ID3D11Buffer* buffer, D3D11_MAP mapType, D3D11_MAPPED_SUBRESOURCE* mapped) const;
+	void Unmap(ID3D11Buffer* buffer) const;
+	void UpdateSubresource(ID3D11Buffer* buffer, const void* data, UINT rowPitch = 0) const;
+
+	void IASetInputLayout(ID3D11InputLayout* layout) const;
+	void IASetVertexBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets) const;
+	void IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset) const;
+	void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) const;
+
+	void VSSetShader(ID3D11VertexShader* shader) const;
+	void PSSetShader(ID3D11PixelShader* shader) const;
+	void VSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers) const;
+	void PSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers) const;
+
+	// D3D11.1: bind a range of a large constant buffer.
+	// firstConstant/numConstants in 16-byte constants, each a multiple of 16.
+	// Call only when SupportsConstantBufferOffsets() returns true.
+	void VSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) const;
+	void PSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) const;
+	void VSSetShaderResources(UINT startSlot, UINT numViews, ID3D11ShaderResourceView* const* views) const;
+	void PSSetShaderResources(UINT startSlot, UINT numViews, ID3D11ShaderResourceView* const* views) const;
+	void PSSetSamplers(UINT startSlot, UINT numSamplers, ID3D11SamplerState* const* samplers) const;
+
+	void OMSetRenderTargets(UINT numViews, ID3D11RenderTargetView* const* rtvs, ID3D11DepthStencilView* dsv) const;
+	void RSSetState(ID3D11RasterizerState* state) const;
+	void RSSetViewports(UINT numViewports, const D3D11_VIEWPORT* viewports) const;
+
+	void ClearRenderTargetView(ID3D11RenderTargetView* rtv, const float color[4]) const;
+	void ClearDepthStencilView(ID3D11DepthStencilView* dsv, UINT clearFlags, float depth, UINT8 stencil) const;
+
+	void Draw(UINT vertexCount, UINT startVertex) const;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) const;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) const;
+
 	// Getters
 	ID3D11Device* GetDevice() const
 	{
@@ -222,6 +283,12 @@ public:
 	{
 		outWidth = 0;
 		outHeight = 0;
+		if (m_backend == GDXBackend::Null)
+		{
+			outWidth = m_nullShadowWidth;
+			outHeight = m_nullShadowHeight;
+			return;
+		}
 		if (!m_pShadowMap) return;
 		D3D11_TEXTURE2D_DESC desc{};
 		m_pShadowMap->GetDesc(&desc);
@@ -233,4 +300,35 @@ public:
 	{
 		return m_bInitialized;
 	}
+
+	GDXBackend GetBackend() const
+	{
+		return m_backend;
+	}
+
+	bool IsNull() const
+	{
+		return m_backend == GDXBackend::Null;
+	}
+
+	// Null backend: always true (recording only)
+	bool SupportsConstantBufferOffsets() const
+	{
+		return m_backend == GDXBackend::Null || m_constantBufferOffsets;
+	}
+
+	// Recorded commands (only filled by the null backend)
+	GDXCommandLog& GetCommandLog() const
+	{
+		return m_nullDevice.GetCommandLog();
+	}
+
+	GDXNullDevice& GetNullDevice() const
+	{
+		return m_nullDevice;
+	}
+
+	// System memory behind a buffer created by the null backend.
+	// nullptr for D3D11 buffers and for buffers of any other origin.
+	const GDXNullBuffer* GetNullBuffer(ID3D11Buffer* buffer) const;
 };
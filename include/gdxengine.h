@@ -1,8 +1,10 @@
 #pragma once
 
-#include <Windows.h>
+#include "gdxplatform.h"
+#ifdef _WIN32
 #include "core.h"
 #include "gdxwin.h"
+#endif
 #include "gdxutil.h"
 #include "gdxinterface.h"
 #include "gdxdevice.h"
@@ -11,11 +13,14 @@
 #include "BufferManager.h"
 #include "ShaderManager.h"
 #include "RenderManager.h"
+#include "CollisionManager.h"
 #include "LightManager.h"
 #include "TextureManager.h"
 #include "CameraManager.h"
 #include "Transform.h"
 #include "Timer.h"
+#include "JobSystem.h"
+#include "AssetLoader.h"
 #include <thread>
 
 #define VERTEX_SHADER_FILE L"shaders/VertexShader.hlsl" 
@@ -28,6 +33,7 @@ namespace Engine
 	extern GDXEngine* engine;
 
 	int  CreateEngine(HWND hwnd, HINSTANCE hInst, int bpp, int width, int height);
+	int  CreateHeadlessEngine(int width, int height);	// null backend, no window / no D3D11
 	void ReleaseEngine();
 }
 
@@ -47,16 +53,25 @@ class GDXEngine {
 
 		std::wstring vs;
 		std::wstring ps;
+		std::wstring vsInstanced;	// vertex shader variant with a world matrix per instance
+
+		// Transform data of all entities; declared before the managers that
+		// create entities so it outlives them
+		TransformSystem		m_transformSystem;
 
 		// Manager classes
 		ObjectManager       m_objectManager;
 		RenderManager		m_renderManager;
+		CollisionManager	m_collisionManager;	// broadphase + OBB pairs (CollideAll)
 		ShaderManager		m_shaderManager;
 		InputLayoutManager	m_inputLayoutManager;
 		BufferManager		m_bufferManager;
 		LightManager		m_lightManager;
 		TextureManager		m_texturManager;
 		CameraManager		m_cameraManager;
+		JobSystem			m_jobSystem;		// worker threads for per-frame work
+		AssetLoader			m_assetLoader;		// loader threads, upload in UpdateWorld
+		size_t				m_uploadBudget;		// bytes per frame for AssetLoader::Update
 
 		int m_vsyncInterval = 1; // 1=ON, 0=OFF
 
@@ -64,7 +79,8 @@ class GDXEngine {
 		GDXDevice m_device;		// Device Manager, not to be confused with DirectXDevice
 		GDXInterface m_interface;	// Interface Manager
 
-		GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int screenX, unsigned int screenY, int* result);
+		GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int screenX, unsigned int screenY, int* result,
+			GDXBackend backend = GDXBackend::D3D11);
 		~GDXEngine();
 
 		static GDXEngine* GetInstance() { return s_instance; }
@@ -75,6 +91,8 @@ class GDXEngine {
 
 		// 
 		HRESULT Graphic(unsigned int width, unsigned int height, bool windowed);
+		HRESULT GraphicNull(unsigned int width, unsigned int height);
+		HRESULT CreateInstancedShader();	// instancing variant of the default shader
 		HRESULT Cls(float r, float g, float b, float a);
 		int FindBestAdapter();
 		
@@ -93,6 +111,10 @@ class GDXEngine {
 		InputLayoutManager& GetILM();	// InputManager
 		TextureManager& GetTM();		// TextureManager
 		CameraManager& GetCam();		// KameraManager
+		JobSystem& GetJS();				// JobSystem
+		AssetLoader& GetAL();			// AssetLoader
+		RenderManager& GetRM();			// RenderManager
+		CollisionManager& GetCM();		// CollisionManager
 
 		// Setter-Funktionen fÃ¼r private Variablen
 		void SetAdapter(unsigned int index);
@@ -101,10 +123,13 @@ class GDXEngine {
 		void SetGlobalAmbient(const DirectX::XMFLOAT4& ambient) { m_globalAmbient = ambient; }
 		void SetCamera(LPENTITY mesh);		
 		void SetVSyncInterval(int interval) noexcept;
+		void SetUploadBudget(size_t bytesPerFrame) { m_uploadBudget = bytesPerFrame; }
 
+		TransformSystem& GetTransformSystem();
 
 		DirectX::XMFLOAT4 GetGlobalAmbient() const { return m_globalAmbient; }
 		int GetVSyncInterval() const noexcept;
+		size_t GetUploadBudget() const { return m_uploadBudget; }
 
 
 	private:
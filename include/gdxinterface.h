@@ -3,6 +3,7 @@
 
 #include "gdxutil.h"
 #include <algorithm>
+#include <vector>
 
 
 struct GXFREQUENCY {
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================
+// Null device backend
+//
+// Used by GDXDevice when it runs with GDXBackend::Null. No GPU
+// and no D3D11 runtime is touched: every context call is appended
+// to an in-memory command log and buffers live in system memory.
+// This makes the whole frame loop (shadow pass + main pass)
+// runnable on headless machines to measure CPU submission cost.
+//
+// This header is platform-neutral (no Windows or D3D11 headers).
+// GDXDevice translates its D3D11 wrapper calls into GDXNullDevice,
+// so the engine (CreateHeadlessEngine) and HeadlessBenchmark run on
+// every platform.
+//
+// Not synchronized, like the D3D11 immediate context it replaces:
+// a context belongs to the one thread that submits (the render
+// thread). A lock per recorded call would distort exactly the
+// submission cost this backend is there to measure. Threads that
+// want to record in parallel each use their own GDXNullDevice.
+// ============================================================
+
+enum class GDXCommandType : uint8_t
+{
+    Map,
+    Unmap,
+    UpdateSubresource,
+    IASetInputLayout,
+    IASetVertexBuffers,
+    IASetIndexBuffer,
+    IASetPrimitiveTopology,
+    VSSetShader,
+    PSSetShader,
+    VSSetConstantBuffers,
+    PSSetConstantBuffers,
+    VSSetConstantBuffers1,
+    PSSetConstantBuffers1,
+    VSSetShaderResources,
+    PSSetShaderResources,
+    PSSetSamplers,
+    OMSetRenderTargets,
+    RSSetState,
+    RSSetViewports,
+    ClearRenderTargetView,
+    ClearDepthStencilView,
+    Draw,
+    DrawIndexed,
+    DrawIndexedInstanced,
+    Count
+};
+
+struct GDXCommand
+{
+    GDXCommandType type;
+    uint32_t slot;          // Start slot / register (0 if not applicable)
+    uint32_t count;         // Number of bound elements, vertices or indices
+    const void* object;     // First bound object (buffer, shader, view ...)
+};
+
+// Per context, see above: no locking.
+class GDXCommandLog
+{
+public:
+    GDXCommandLog();
+
+    // Clears the recorded commands and all counters (call once per frame)
+    void Reset();
+
+    void Record(GDXCommandType type, uint32_t slot, uint32_t count, const void* object);
+
+    // false = only count commands, do not store them (very large scenes)
+    void SetKeepCommands(bool keep);
+
+    const std::vector<GDXCommand>& GetCommands() const { return m_commands; }
+    size_t GetCount(GDXCommandType type) const;
+    size_t GetTotalCount() const;
+
+    static const char* GetCommandName(GDXCommandType type);
+
+private:
+    std::vector<GDXCommand> m_commands;
+    size_t m_counts[static_cast<size_t>(GDXCommandType::Count)];
+    size_t m_totalCount;
+    bool m_keepCommands;
+};
+
+// System memory buffer that stands in for a GPU buffer.
+class GDXNullBuffer
+{
+public:
+    GDXNullBuffer(uint32_t byteWidth, const void* initData);
+
+    uint8_t* GetData() { return m_data.data(); }
+    const uint8_t* GetData() const { return m_data.data(); }
+    uint32_t GetByteWidth() const { return static_cast<uint32_t>(m_data.size()); }
+    bool IsMapped() const { return m_mapped; }
+
+private:
+    friend class GDXNullDevice;
+
+    std::vector<uint8_t> m_data;
+    bool m_mapped;
+};
+
+// Context of the null backend. Buffer calls are validated the way the
+// D3D11 debug layer would (double Map, Unmap without Map, update while
+// mapped, null buffer); violations are counted, not fatal.
+class GDXNullDevice
+{
+public:
+    GDXNullDevice();
+
+    // object: handle that appears in the log (the engine passes its
+    // ID3D11Buffer*, so binds and maps of the same buffer match).
+    // nullptr records the GDXNullBuffer itself.
+    void* Map(GDXNullBuffer* buffer, const void* object = nullptr);
+    void Unmap(GDXNullBuffer* buffer, const void* object = nullptr);
+    void UpdateSubresource(GDXNullBuffer* buffer, const void* data, const void* object = nullptr);
+
+    void Record(GDXCommandType type, uint32_t slot, uint32_t count, const void* object)
+    {
+        m_commandLog.Record(type, slot, count, object);
+    }
+
+    // Clears log and validation errors
+    void Reset();
+
+    GDXCommandLog& GetCommandLog() { return m_commandLog; }
+    const GDXCommandLog& GetCommandLog() const { return m_commandLog; }
+    uint32_t GetErrorCount() const { return m_errorCount; }
+
+private:
+    void ReportError(const char* message);
+
+    GDXCommandLog m_commandLog;
+    uint32_t m_errorCount;
+};
@@ -5,26 +5,25 @@
 
 #define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
-
-#include <wrl/client.h>
+#include "gdxplatform.h"
 using Microsoft::WRL::ComPtr;
 
 #include <string>
 #include <sstream>
 #include <iostream>
 #include <mutex>
+#include <atomic>
 #include <iomanip>
 #include <chrono>
 
-#include <d3d11.h>
-#include <dxgi.h>
 #include <DirectXMath.h>
 
 #include <unordered_set>
 
 #include <cstdint>
 
+#include "gdxdebug.h"
+
 inline std::string Ptr(const void* p)
 {
     std::ostringstream oss;
@@ -80,12 +79,14 @@ inline GXFORMAT& operator|=(GXFORMAT& a, GXFORMAT b)
 // Common structs
 // ============================================================
 
-__declspec(align(16))
-struct MatrixSet
+struct alignas(16) MatrixSet
 {
     DirectX::XMMATRIX viewMatrix;
     DirectX::XMMATRIX projectionMatrix;
     DirectX::XMMATRIX worldMatrix;
+    // Normals (3x3 part): the world matrix without the dequantization of
+    // quantized positions, in instance groups the per-surface correction
+    DirectX::XMMATRIX normalMatrix;
 };
 
 // ============================================================
@@ -106,176 +107,117 @@ namespace GXUTIL
     D3D_FEATURE_LEVEL GetFeatureLevelFromDirectXVersion(int version);
     std::wstring  GetFeatureLevelName(D3D_FEATURE_LEVEL featureLevel);
 
-    // -------- UTF helpers (header-only, kein <codecvt>) --------
+    // -------- UTF helpers (header-only, no <codecvt>) --------
     inline std::string WideToUtf8(const wchar_t* wstr)
     {
         if (!wstr) return {};
+#ifdef _WIN32
         int needed = WideCharToMultiByte(CP_UTF8, 0, wstr, -1, nullptr, 0, nullptr, nullptr);
         if (needed <= 0) return {};
         std::string out;
         out.resize(static_cast<size_t>(needed - 1));
         WideCharToMultiByte(CP_UTF8, 0, wstr, -1, out.data(), needed, nullptr, nullptr);
         return out;
+#else
+        // wchar_t is UTF-32 here
+        std::string out;
+        for (; *wstr; ++wstr)
+        {
+            const uint32_t c = static_cast<uint32_t>(*wstr);
+            if (c < 0x80)
+            {
+                out += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (c >> 6));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (c >> 12));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (c >> 18));
+                out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return out;
+#endif
     }
 
     inline std::wstring Utf8ToWide(const std::string& str)
     {
         if (str.empty()) return {};
+#ifdef _WIN32
         int needed = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
         if (needed <= 0) return {};
         std::wstring out;
         out.resize(static_cast<size_t>(needed - 1));
         MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, out.data(), needed);
         return out;
-    }
-}
-
-// ============================================================
-// Debug (header-only) � getrennt HR / Win32, thread-safe
-// ============================================================
-
-class Debug
-{
-public:
-    static inline bool s_outputDebugString = true;
-
-    template<typename... Args>
-    static void Log(Args&&... args) { Write("[LOG] ", std::cout, std::forward<Args>(args)...); }
-
-    template<typename... Args>
-    static void LogWarning(Args&&... args) { Write("[WARNING] ", std::cout, std::forward<Args>(args)...); }
-
-    template<typename... Args>
-    static void LogError(Args&&... args) { Write("[ERROR] ", std::cerr, std::forward<Args>(args)...); }
-
-    // Einmal insgesamt (ohne Argumente)
-    static void LogOnce()
-    {
-        constexpr const char* key = "__Debug_LogOnce_NoArgs__";
-        if (!TryMarkSeen(key)) return;
-        Log("LogOnce() fired"); // <- deine Message
-    }
-
-    // Einmal pro key, ohne weitere Args: key wird als Message geloggt
-    static void LogOnce(const char* key)
-    {
-        if (!TryMarkSeen(key)) return;
-        Log(key);
-    }
-
-    // Einmal pro key, mit Args: du entscheidest, was geloggt wird
-    template<typename... Args>
-    static void LogOnce(const char* key, Args&&... args)
-    {
-        if (!TryMarkSeen(key)) return;
-        Log(std::forward<Args>(args)...);
-    }
-
-    static void LogHr(const char* file, int line, HRESULT hr)
-    {
-        if (SUCCEEDED(hr)) return;
-        LogError(file, ":", line, " -> ", FormatWin32Message((DWORD)hr),
-            " (HRESULT=0x", std::hex, std::uppercase, (DWORD)hr, ")");
-    }
-
-    static void LogWin32(const char* file, int line)
-    {
-        DWORD err = GetLastError();
-        if (err == 0) return;
-        LogError(file, ":", line, " -> ", FormatWin32Message(err),
-            " (Win32=0x", std::hex, std::uppercase, err, ")");
-    }
-
-private:
-    inline static std::mutex s_mutex;
-
-    // Shared once-state
-    inline static std::unordered_set<std::string> s_seenOnce;
-    inline static std::mutex s_onceMutex;
-
-    static bool TryMarkSeen(const char* key)
-    {
-        if (!key) key = "__null__";
-
-        std::lock_guard<std::mutex> lock(s_onceMutex);
-        return s_seenOnce.emplace(key).second;
-    }
-
-    static std::string Now()
-    {
-        using namespace std::chrono;
-        const auto now = system_clock::now();
-        const auto t = system_clock::to_time_t(now);
-
-        std::tm tm{};
-        localtime_s(&tm, &t);
-
-        const auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
-
-        std::ostringstream oss;
-        oss << std::setfill('0')
-            << std::setw(2) << tm.tm_hour << ":"
-            << std::setw(2) << tm.tm_min << ":"
-            << std::setw(2) << tm.tm_sec << "."
-            << std::setw(3) << ms.count();
-        return oss.str();
-    }
-
-    static std::string FormatWin32Message(DWORD code)
-    {
-        if (code == 0) return "OK";
-
-        LPSTR buf = nullptr;
-        DWORD len = FormatMessageA(
-            FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-            nullptr, code, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-            (LPSTR)&buf, 0, nullptr);
-
-        std::string msg = "Unknown error";
-        if (len && buf)
-        {
-            msg.assign(buf, buf + len);
-            while (!msg.empty() && (msg.back() == '\n' || msg.back() == '\r')) msg.pop_back();
-        }
-        if (buf) LocalFree(buf);
-        return msg;
-    }
-
-    template<typename T>
-    static void Append(std::ostringstream& oss, const T& t) { oss << t; }
-
-    static void Append(std::ostringstream& oss, const wchar_t* w) { oss << GXUTIL::WideToUtf8(w); }
-    static void Append(std::ostringstream& oss, const std::wstring& w) { oss << GXUTIL::WideToUtf8(w.c_str()); }
-
-    template<typename T, typename... Args>
-    static void AppendAll(std::ostringstream& oss, const T& t, Args&&... args)
-    {
-        Append(oss, t);
-        if constexpr (sizeof...(args) > 0) AppendAll(oss, std::forward<Args>(args)...);
-    }
-
-    template<typename... Args>
-    static void Write(const char* prefix, std::ostream& stream, Args&&... args)
-    {
-        std::ostringstream oss;
-        oss << Now() << " " << prefix;
-        AppendAll(oss, std::forward<Args>(args)...);
-
-        const std::string line = oss.str();
-
+#else
+        std::wstring out;
+        out.reserve(str.size());
+        for (size_t i = 0; i < str.size();)
         {
-            std::lock_guard<std::mutex> lock(s_mutex);
-            stream << line << "\n";
-            stream.flush();
+            const uint8_t b = static_cast<uint8_t>(str[i]);
+            uint32_t c = b;
+            size_t extra = 0;
+            if      (b >= 0xF0) { c = b & 0x07; extra = 3; }
+            else if (b >= 0xE0) { c = b & 0x0F; extra = 2; }
+            else if (b >= 0xC0) { c = b & 0x1F; extra = 1; }
+            ++i;
+            for (; extra > 0 && i < str.size(); --extra, ++i)
+                c = (c << 6) | (static_cast<uint8_t>(str[i]) & 0x3F);
+            out += static_cast<wchar_t>(c);
         }
-        if (s_outputDebugString)
-            OutputDebugStringA((line + "\n").c_str());
+        return out;
+#endif
     }
-};
+}
 
 #define GDX_HR(x)   do { HRESULT _hr=(x); Debug::LogHr(__FILE__, __LINE__, _hr); } while(0)
 #define GDX_WIN32() do { Debug::LogWin32(__FILE__, __LINE__); } while(0)
 
+// ============================================================
+// Render trace (active at compile time only)
+//
+// For diagnostics in the draw path instead of Debug::LogOnce: the key is a
+// static counter per call site (no string building, no mutex, no set
+// lookup). The arguments are evaluated only when something is logged.
+// Without GDX_RENDER_TRACE the macros disappear completely.
+//
+//   GDX_TRACE_ONCE(...)       once per call site
+//   GDX_TRACE_FIRST(n, ...)   the first n hits per call site
+// ============================================================
+
+#ifndef GDX_RENDER_TRACE
+#if defined(_DEBUG)
+#define GDX_RENDER_TRACE 1
+#else
+#define GDX_RENDER_TRACE 0
+#endif
+#endif
+
+#if GDX_RENDER_TRACE
+#define GDX_TRACE_FIRST(n, ...) do { \
+        static std::atomic<unsigned int> _gdxTraceHits{ 0 }; \
+        if (_gdxTraceHits.load(std::memory_order_relaxed) < (unsigned int)(n) && \
+            _gdxTraceHits.fetch_add(1, std::memory_order_relaxed) < (unsigned int)(n)) \
+            Debug::Log(__VA_ARGS__); \
+    } while(0)
+#else
+#define GDX_TRACE_FIRST(n, ...) do { } while(0)
+#endif
+
+#define GDX_TRACE_ONCE(...) GDX_TRACE_FIRST(1, __VA_ARGS__)
+
 // ============================================================
 // Memory helpers
 // ============================================================
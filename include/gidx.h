@@ -1,10 +1,17 @@
 ﻿#pragma once
 
-#include <windows.h>
+#include "gdxplatform.h"
 #include <DirectXMath.h>
 #include <fstream>  
+#include <filesystem>
 
 #include "gdxengine.h"
+#include "VertexPacking.h"
+#include "MeshFile.h"
+#include "MeshLoader.h"
+#include "CookedMeshRequest.h"
+#include "ModelImporter.h"
+#include "ModelLoader.h"
 
 extern Timer Time;
 
@@ -394,6 +401,45 @@ namespace Engine
         *mesh = m;
     }
 
+    // Copy of a mesh: own transform, same material, same surfaces.
+    // The RenderManager draws copies of the same surface as one instancing group.
+    inline void CopyEntity(LPENTITY* copy, LPENTITY source)
+    {
+        if (copy == nullptr) {
+            Debug::Log("ERROR: CopyEntity - copy pointer is nullptr");
+            return;
+        }
+
+        Mesh* mesh = dynamic_cast<Mesh*>(source);
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: CopyEntity - source is not a Mesh");
+            return;
+        }
+
+        Mesh* m = engine->GetOM().CopyMesh(mesh);
+        if (m == nullptr) {
+            Debug::Log("ERROR: CopyEntity - Failed to copy mesh");
+            return;
+        }
+
+        // The fallback path without the constant buffer ring needs its own matrix buffer
+        HRESULT hr = engine->GetBM().CreateBuffer(
+            &m->matrixSet,
+            sizeof(MatrixSet),
+            1,
+            D3D11_BIND_CONSTANT_BUFFER,
+            &m->constantBuffer
+        );
+        if (FAILED(hr))
+        {
+            Debug::LogHr(__FILE__, __LINE__, hr);
+            engine->GetOM().DeleteMesh(m);
+            return;
+        }
+
+        *copy = m;
+    }
+
     // ==================== SHADER ====================
 
     inline HRESULT CreateShader(LPSHADER* shader,
@@ -428,6 +474,12 @@ namespace Engine
             return E_OUTOFMEMORY;
         }
 
+        // Headless: nothing to compile, only remember the vertex format
+        if (engine->m_device.IsNull()) {
+            (*shader)->flagsVertex = flags;
+            return S_OK;
+        }
+
         // 3. Compiliere Vertex und Pixel Shader
         hr = engine->GetSM().CreateShader(*shader,
             vertexShaderFile,
@@ -459,6 +511,9 @@ namespace Engine
             return hr;
         }
 
+        // Layouts for interleaved/quantized surfaces, also need blobVS
+        engine->GetILM().CreateInputLayoutFormats(*shader, flags);
+
         // 6. Freigeben der Blobs nach Input Layout Creation
         if ((*shader)->blobVS != nullptr) {
             (*shader)->blobVS->Release();
@@ -562,6 +617,77 @@ namespace Engine
         return engine->GetOM().GetSurface(mesh);
     }
 
+    // Interleaved, packed vertex format (one vertex buffer, about half the memory).
+    // Call before FillBuffer; UVs as half float, normals SNORM16, color RGBA8.
+    inline void SetSurfaceInterleaved(LPSURFACE surface, bool enabled = true)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceInterleaved - surface is nullptr");
+            return;
+        }
+        surface->interleaved = enabled;
+    }
+
+    // Vertex data changes constantly (e.g. every frame): DYNAMIC buffer, only changed
+    // ranges are uploaded. Call before FillBuffer.
+    inline void SetSurfaceDynamic(LPSURFACE surface, bool enabled = true)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceDynamic - surface is nullptr");
+            return;
+        }
+        surface->dynamic = enabled;
+    }
+
+    // Dynamic surface: vertices changed directly in surface->position etc.
+    // D3DVERTEX_POSITION also refreshes the local bounds (culling, collision, raycasts).
+    inline void MarkSurfaceDirty(LPSURFACE surface, DWORD attributes, unsigned int first, unsigned int count)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: MarkSurfaceDirty - surface is nullptr");
+            return;
+        }
+        surface->MarkDirty(attributes, first, count);
+    }
+
+    // Store positions as 4 x UNORM16 relative to the surface box (8 instead of 12 bytes).
+    // Set before FillBuffer; the dequantization runs through the world matrix.
+    inline void SetSurfaceQuantized(LPSURFACE surface, bool enabled = true)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceQuantized - surface is nullptr");
+            return;
+        }
+        surface->quantizePositions = enabled;
+    }
+
+    // Optimize index/vertex order for post-transform cache, overdraw and fetch.
+    // Call before FillBuffer; ACMR/ATVR before and after go to the log.
+    inline MeshOptimizer::Report OptimizeSurface(LPSURFACE surface, float overdrawThreshold = 1.05f)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: OptimizeSurface - surface is nullptr");
+            return {};
+        }
+
+        MeshOptimizer::Report report = surface->Optimize(overdrawThreshold);
+        Debug::Log("OptimizeSurface: ACMR ", report.before.acmr, " -> ", report.after.acmr,
+            ", ATVR ", report.before.atvr, " -> ", report.after.atvr);
+        return report;
+    }
+
+    // Does the shader have an input layout for the vertex format (null device: all)
+    inline bool HasVertexLayout(const Shader* shader, uint32_t format)
+    {
+        return MeshLoader::HasVertexLayout(shader, format, engine->m_device.IsNull());
+    }
+
+    // Vertex format (VertexFormat bits) FillBuffer picks for the surface with this shader
+    inline uint32_t ResolveVertexFormat(const Surface* surface, const Shader* shader)
+    {
+        return MeshLoader::ResolveVertexFormat(surface, shader, engine->m_device.IsNull());
+    }
+
     inline void FillBuffer(LPSURFACE surface)
     {
         if (!surface) { Debug::Log("ERROR: FillBuffer - surface is nullptr"); return; }
@@ -572,33 +698,304 @@ namespace Engine
 
         if (!shader) { Debug::Log("ERROR: FillBuffer - cannot resolve shader"); return; }
 
-        if (!shader) { Debug::Log("ERROR: FillBuffer - cannot resolve shader"); return; }
+        const uint32_t format = ResolveVertexFormat(surface, shader);
+        const bool dynamic = surface->dynamic;
+        const bool interleaved = (format & VERTEX_FORMAT_INTERLEAVED) != 0;
+        const bool quantized = (format & VERTEX_FORMAT_QUANTIZED) != 0;
+
+        surface->positionsQuantized = quantized;
+        if (quantized)
+            surface->quantization = VertexPacking::ComputeQuantization(surface->position.data(), surface->position.size());
+
+        // Dynamic: one DYNAMIC buffer with a segment ring per attribute
+        if (dynamic) {
+            const DWORD streamFlags[DYNAMIC_STREAM_COUNT] = {
+                D3DVERTEX_POSITION, D3DVERTEX_NORMAL, D3DVERTEX_COLOR, D3DVERTEX_TEX1, D3DVERTEX_TEX2
+            };
+            const void* data[DYNAMIC_STREAM_COUNT] = {
+                surface->position.data(), surface->normal.data(), surface->color.data(), surface->uv1.data(), surface->uv2.data()
+            };
+            const UINT stride[DYNAMIC_STREAM_COUNT] = {
+                sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT4), sizeof(DirectX::XMFLOAT2), sizeof(DirectX::XMFLOAT2)
+            };
+            const UINT count[DYNAMIC_STREAM_COUNT] = {
+                surface->size_listPosition, surface->size_listNormal, surface->size_listColor, surface->size_listUV1, surface->size_listUV2
+            };
+
+            for (UINT i = 0; i < DYNAMIC_STREAM_COUNT; ++i) {
+                if (shader->flagsVertex & streamFlags[i])
+                    surface->dynamicStreams[i].Create(&engine->m_device, data[i], stride[i], count[i]);
+            }
+        }
+        // Interleaved: all of the shader's attributes in one packed buffer
+        else if (interleaved) {
+            const VertexPacking::Layout layout = VertexPacking::MakeLayout(shader->flagsVertex, quantized);
+            std::vector<uint8_t> packed;
+            VertexPacking::Pack(*surface, layout, packed);
+
+            engine->GetBM().CreateBuffer(packed.data(), layout.stride,
+                surface->size_listPosition, D3D11_BIND_VERTEX_BUFFER, &surface->vertexBuffer);
+            surface->vertexStride = layout.stride;
+            surface->vertexFlags = layout.flags;
+        }
+        // Vertex buffers (one buffer per attribute)
+        else {
+            if (quantized) {
+                std::vector<uint16_t> positions;
+                VertexPacking::QuantizePositions(surface->position.data(), surface->position.size(),
+                    surface->quantization, positions);
+                engine->GetBM().CreateBuffer(positions.data(), 4 * sizeof(uint16_t),
+                    surface->size_listPosition, D3D11_BIND_VERTEX_BUFFER, &surface->positionBuffer);
+            }
+            else if (shader->flagsVertex & D3DVERTEX_POSITION) {
+                engine->GetBM().CreateBuffer(surface->position.data(), surface->size_position,
+                    surface->size_listPosition, D3D11_BIND_VERTEX_BUFFER, &surface->positionBuffer);
+            }
+            if (shader->flagsVertex & D3DVERTEX_NORMAL) {
+                engine->GetBM().CreateBuffer(surface->normal.data(), surface->size_normal,
+                    surface->size_listNormal, D3D11_BIND_VERTEX_BUFFER, &surface->normalBuffer);
+            }
+            if (shader->flagsVertex & D3DVERTEX_COLOR) {
+                engine->GetBM().CreateBuffer(surface->color.data(), surface->size_color,
+                    surface->size_listColor, D3D11_BIND_VERTEX_BUFFER, &surface->colorBuffer);
+            }
+            if (shader->flagsVertex & D3DVERTEX_TEX1) {
+                engine->GetBM().CreateBuffer(surface->uv1.data(), surface->size_uv1,
+                    surface->size_listUV1, D3D11_BIND_VERTEX_BUFFER, &surface->uv1Buffer);
+            }
+            if (shader->flagsVertex & D3DVERTEX_TEX2) {
+                engine->GetBM().CreateBuffer(surface->uv2.data(), surface->size_uv2,
+                    surface->size_listUV2, D3D11_BIND_VERTEX_BUFFER, &surface->uv2Buffer);
+            }
+        }
+
+        // Index buffer: 16 bits as long as every vertex is addressable (half the memory/bandwidth)
+        if (surface->position.size() <= 0xFFFF) {
+            std::vector<uint16_t> indices16(surface->indices.begin(), surface->indices.end());
+            engine->GetBM().CreateBuffer(indices16.data(), sizeof(uint16_t),
+                surface->size_listIndex, D3D11_BIND_INDEX_BUFFER, &surface->indexBuffer);
+            surface->indexFormat = DXGI_FORMAT_R16_UINT;
+        }
+        else {
+            engine->GetBM().CreateBuffer(surface->indices.data(), sizeof(UINT),
+                surface->size_listIndex, D3D11_BIND_INDEX_BUFFER, &surface->indexBuffer);
+            surface->indexFormat = DXGI_FORMAT_R32_UINT;
+        }
+
+        // Local box/sphere (minPoint/maxPoint too) once here, not per frame
+        surface->UpdateLocalBounds();
+
+        // New geometry: recompute the mesh's culling bounds
+        surface->pMesh->InvalidateBounds();
+    }
+
+    // LOD chain by edge collapse (MeshSimplifier), call after FillBuffer of the surfaces.
+    // Every level has about reduction * the triangles of the previous one; normal/UV seams and open
+    // borders stay, maxError limits the deviation (relative to the extent).
+    // LOD 1 applies below screenSize (fraction of the screen height), every further level at sqrt(reduction)
+    // of that - the triangle density on screen thus stays about the same.
+    // Returns the number of levels created (fewer once nothing can be reduced anymore).
+    inline unsigned int GenerateMeshLODs(LPENTITY entity, unsigned int levels = 3, float reduction = 0.5f,
+        float screenSize = 0.5f, float maxError = 0.02f)
+    {
+        Mesh* mesh = dynamic_cast<Mesh*>(entity);
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: GenerateMeshLODs - entity is not a Mesh");
+            return 0;
+        }
 
-        // Vertexbuffer
-        if (shader->flagsVertex & D3DVERTEX_POSITION) {
-            engine->GetBM().CreateBuffer(surface->position.data(), surface->size_position,
-                surface->size_listPosition, D3D11_BIND_VERTEX_BUFFER, &surface->positionBuffer);
+        ObjectManager& om = engine->GetOM();
+        om.ClearMeshLODs(mesh);
+
+        std::vector<Surface*> previous = mesh->surfaces;
+        float threshold = screenSize;
+        unsigned int created = 0;
+
+        for (unsigned int level = 0; level < levels; ++level)
+        {
+            std::vector<Surface*> surfaces(previous.size(), nullptr);
+            float levelError = 0.0f;
+            bool reduced = false;
+
+            for (size_t slot = 0; slot < previous.size(); ++slot)
+            {
+                Surface* source = previous[slot];
+                surfaces[slot] = source;
+                if (!source)
+                    continue;
+
+                // Each time the previous level is simplified (errors add up, the work halves)
+                Surface* lod = om.CreateSurface();
+                lod->pMesh = mesh;
+
+                float error = 0.0f;
+                const size_t target = static_cast<size_t>(source->indices.size() * reduction) / 3 * 3;
+                if (!lod->SimplifyFrom(*source, target, maxError, &error)) {
+                    lod->pMesh = nullptr;
+                    om.DeleteSurface(lod);
+                    continue;
+                }
+
+                FillBuffer(lod);
+                surfaces[slot] = lod;
+                levelError = (std::max)(levelError, error);
+                reduced = true;
+            }
+
+            if (!reduced)
+                break;
+
+            om.AddMeshLOD(mesh, surfaces, threshold, levelError);
+            previous = surfaces;
+            threshold *= std::sqrt(reduction);
+            ++created;
+        }
+
+        Debug::Log("GenerateMeshLODs: ", created, " levels");
+        return created;
+    }
+
+    // Append a custom (offline built) LOD level: one surface per surface of the mesh,
+    // from fine to coarse. screenSize: fraction of the screen height below which the level is drawn.
+    inline void AddMeshLOD(LPENTITY entity, const std::vector<LPSURFACE>& surfaces, float screenSize)
+    {
+        Mesh* mesh = dynamic_cast<Mesh*>(entity);
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: AddMeshLOD - entity is not a Mesh");
+            return;
+        }
+        engine->GetOM().AddMeshLOD(mesh, surfaces, screenSize);
+    }
+
+    inline void ClearMeshLODs(LPENTITY entity)
+    {
+        Mesh* mesh = dynamic_cast<Mesh*>(entity);
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: ClearMeshLODs - entity is not a Mesh");
+            return;
+        }
+        engine->GetOM().ClearMeshLODs(mesh);
+    }
+
+    // Save the mesh cooked (.gdxm, MeshFile): base surfaces and LOD levels in the format
+    // FillBuffer uploads for the shader of the material, plus bounds and material name.
+    // Dynamic surfaces are cooked as static float streams, lines not at all.
+    inline bool SaveMesh(LPENTITY entity, const char* path)
+    {
+        Mesh* mesh = dynamic_cast<Mesh*>(entity);
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: SaveMesh - entity is not a Mesh");
+            return false;
+        }
+        if (path == nullptr) {
+            Debug::Log("ERROR: SaveMesh - path is nullptr");
+            return false;
+        }
+
+        std::string error;
+        if (!MeshLoader::Save(mesh, path, engine->m_device.IsNull(), &error)) {
+            Debug::Log("ERROR: SaveMesh - ", error.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Every cooked surface must have exactly the streams the shader binds (LoadMesh, LoadMeshAsync)
+    inline bool MatchesCookedLayout(const MeshFile::Reader& reader, Shader* shader)
+    {
+        return MeshLoader::MatchesLayout(reader, shader, engine->m_device.IsNull());
+    }
+
+    // Surfaces, GPU buffers, bounds and LOD levels from the mapped file into a mesh without
+    // surfaces. The layout must match (MatchesCookedLayout).
+    inline void BuildCookedMesh(Mesh* m, const MeshFile::Reader& reader, Shader* shader, bool keepGeometry)
+    {
+        MeshLoader::Build(engine->GetOM(), engine->GetBM(), m, reader, shader, keepGeometry);
+    }
+
+    // Load a cooked mesh: map the file with mmap, create the vertex/index buffers straight from the
+    // mapped streams (no repacking, no intermediate copy), take bounds and LOD levels
+    // from the file.
+    // material == nullptr: the material with the stored name (MaterialName), otherwise the default.
+    // keepGeometry: positions and indices also on the CPU (raycasts, occlusion, collision);
+    // normals/colors/UVs exist only on the GPU, the Update*Buffer functions do not apply.
+    // If the cooked format does not match the shader, nothing is created (cook the file again).
+    inline bool LoadMesh(LPENTITY* mesh, const char* path, MATERIAL* material = nullptr, bool keepGeometry = true)
+    {
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: LoadMesh - mesh pointer is nullptr");
+            return false;
         }
-        if (shader->flagsVertex & D3DVERTEX_NORMAL) {
-            engine->GetBM().CreateBuffer(surface->normal.data(), surface->size_normal,
-                surface->size_listNormal, D3D11_BIND_VERTEX_BUFFER, &surface->normalBuffer);
+        *mesh = nullptr;
+
+        MeshFile::Reader reader;
+        if (path == nullptr || !reader.Open(path)) {
+            Debug::Log("ERROR: LoadMesh - ", path ? path : "(null)", ": ", reader.GetError());
+            return false;
         }
-        if (shader->flagsVertex & D3DVERTEX_COLOR) {
-            engine->GetBM().CreateBuffer(surface->color.data(), surface->size_color,
-                surface->size_listColor, D3D11_BIND_VERTEX_BUFFER, &surface->colorBuffer);
+
+        ObjectManager& om = engine->GetOM();
+        const MeshFile::Header& header = reader.GetHeader();
+
+        if (material == nullptr)
+            material = om.FindMaterial(header.material);
+        if (material == nullptr)
+            material = om.GetStandardMaterial();
+        Shader* shader = material ? material->pRenderShader : nullptr;
+        if (!shader) { Debug::Log("ERROR: LoadMesh - cannot resolve shader"); return false; }
+
+        if (!MatchesCookedLayout(reader, shader)) {
+            Debug::Log("ERROR: LoadMesh - ", path, ": cooked vertex layout does not match the shader (recook)");
+            return false;
         }
-        if (shader->flagsVertex & D3DVERTEX_TEX1) {
-            engine->GetBM().CreateBuffer(surface->uv1.data(), surface->size_uv1,
-                surface->size_listUV1, D3D11_BIND_VERTEX_BUFFER, &surface->uv1Buffer);
+
+        CreateMesh(mesh, material);
+        if (*mesh == nullptr)
+            return false;
+
+        BuildCookedMesh(static_cast<Mesh*>(*mesh), reader, shader, keepGeometry);
+        return true;
+    }
+
+    // Like LoadMesh, but returns right away: *mesh is a mesh without surfaces (draws nothing)
+    // until the upload in UpdateWorld creates the surfaces. Transform, material etc. can be set
+    // right away. material == nullptr: default material, at upload the material with the
+    // stored name if there is one. Errors (file, format): the mesh stays empty, Failed.
+    inline AssetHandle LoadMeshAsync(LPENTITY* mesh, const char* path, MATERIAL* material = nullptr, bool keepGeometry = true)
+    {
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: LoadMeshAsync - mesh pointer is nullptr");
+            return INVALID_ASSET;
         }
-        if (shader->flagsVertex & D3DVERTEX_TEX2) {
-            engine->GetBM().CreateBuffer(surface->uv2.data(), surface->size_uv2,
-                surface->size_listUV2, D3D11_BIND_VERTEX_BUFFER, &surface->uv2Buffer);
+        *mesh = nullptr;
+        if (path == nullptr) {
+            Debug::Log("ERROR: LoadMeshAsync - path is nullptr");
+            return INVALID_ASSET;
         }
 
-        // Indexbuffer
-        engine->GetBM().CreateBuffer(surface->indices.data(), sizeof(UINT),
-            surface->size_listIndex, D3D11_BIND_INDEX_BUFFER, &surface->indexBuffer);
+        CreateMesh(mesh, material ? material : engine->GetOM().GetStandardMaterial());
+        if (*mesh == nullptr)
+            return INVALID_ASSET;
+
+        return engine->GetAL().Submit(std::make_unique<CookedMeshRequest>(engine->GetOM(), engine->GetBM(),
+            engine->m_device.IsNull(), static_cast<Mesh*>(*mesh), path, material == nullptr, keepGeometry));
+    }
+
+    // Import OBJ/glTF into materials, meshes and instances (ModelLoader).
+    // entities: all created meshes. shader: for the new materials (nullptr = default shader).
+    // optimize: OptimizeSurface on the worker threads, before FillBuffer.
+    // On failure nothing of the model is left in the scene.
+    inline bool LoadModel(std::vector<LPENTITY>& entities, const char* path, SHADER* shader = nullptr, bool optimize = true)
+    {
+        return ModelLoader::Load(entities, path, shader, optimize);
+    }
+
+    // Interleaved: one attribute changed = rewrite the whole packed buffer
+    inline void RepackVertexBuffer(LPSURFACE surface)
+    {
+        std::vector<uint8_t> packed;
+        VertexPacking::Pack(*surface, VertexPacking::MakeLayout(surface->vertexFlags, surface->positionsQuantized), packed);
+        engine->GetBM().UpdateBuffer(surface->vertexBuffer, packed.data(), static_cast<UINT>(packed.size()));
     }
 
     inline void UpdateColorBuffer(LPSURFACE surface)
@@ -607,7 +1004,15 @@ namespace Engine
             Debug::Log("ERROR: UpdateColorBuffer - surface is nullptr");
             return;
         }
-        engine->GetBM().UpdateBuffer(surface->colorBuffer, surface->color.data(), surface->size_color);
+        // Dynamic: the setters have already reported the ranges, upload at render time
+        if (surface->IsDynamic())
+            return;
+        if (surface->IsPacked()) {
+            RepackVertexBuffer(surface);
+            return;
+        }
+        engine->GetBM().UpdateBuffer(surface->colorBuffer, surface->color.data(),
+            surface->size_color * surface->size_listColor);
     }
 
     inline void UpdateVertexBuffer(LPSURFACE surface)
@@ -616,6 +1021,27 @@ namespace Engine
             Debug::Log("ERROR: UpdateVertexBuffer - surface is nullptr");
             return;
         }
+        // Positions changed: new bounds cache, all meshes of the surface see the new revision
+        surface->UpdateLocalBounds();
+
+        if (surface->IsDynamic())
+            return;
+        // Quantized: recompute the box, the positions may have left it
+        if (surface->positionsQuantized)
+            surface->quantization = VertexPacking::ComputeQuantization(surface->position.data(), surface->position.size());
+
+        if (surface->IsPacked()) {
+            RepackVertexBuffer(surface);
+            return;
+        }
+        if (surface->positionsQuantized) {
+            std::vector<uint16_t> positions;
+            VertexPacking::QuantizePositions(surface->position.data(), surface->position.size(),
+                surface->quantization, positions);
+            engine->GetBM().UpdateBuffer(surface->positionBuffer, positions.data(),
+                static_cast<UINT>(positions.size() * sizeof(uint16_t)));
+            return;
+        }
         engine->GetBM().UpdateBuffer(surface->positionBuffer, surface->position.data(),
             surface->size_position * surface->size_listPosition);
     }
@@ -721,6 +1147,108 @@ namespace Engine
         surface->AddIndex(c);
     }
 
+    // ==================== BULK GEOMETRY ====================
+    // Whole streams from contiguous arrays (replaces existing data).
+    // Pass std::vector with std::move to avoid the copy.
+
+    inline void SetSurfacePositions(LPSURFACE surface, const DirectX::XMFLOAT3* positions, size_t count)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfacePositions - surface is nullptr");
+            return;
+        }
+        surface->SetPositions(positions, count);
+    }
+
+    inline void SetSurfacePositions(LPSURFACE surface, std::vector<DirectX::XMFLOAT3>&& positions)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfacePositions - surface is nullptr");
+            return;
+        }
+        surface->SetPositions(std::move(positions));
+    }
+
+    inline void SetSurfaceNormals(LPSURFACE surface, const DirectX::XMFLOAT3* normals, size_t count)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceNormals - surface is nullptr");
+            return;
+        }
+        surface->SetNormals(normals, count);
+    }
+
+    inline void SetSurfaceNormals(LPSURFACE surface, std::vector<DirectX::XMFLOAT3>&& normals)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceNormals - surface is nullptr");
+            return;
+        }
+        surface->SetNormals(std::move(normals));
+    }
+
+    // Colors as float RGBA (0..1), unlike VertexColor (0..255)
+    inline void SetSurfaceColors(LPSURFACE surface, const DirectX::XMFLOAT4* colors, size_t count)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceColors - surface is nullptr");
+            return;
+        }
+        surface->SetColors(colors, count);
+    }
+
+    inline void SetSurfaceColors(LPSURFACE surface, std::vector<DirectX::XMFLOAT4>&& colors)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceColors - surface is nullptr");
+            return;
+        }
+        surface->SetColors(std::move(colors));
+    }
+
+    // set 0 = UV1, set 1 = UV2
+    inline void SetSurfaceTexCoords(LPSURFACE surface, const DirectX::XMFLOAT2* uvs, size_t count, unsigned int set = 0)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceTexCoords - surface is nullptr");
+            return;
+        }
+        if (set == 0)
+            surface->SetTexCoords(uvs, count);
+        else
+            surface->SetTexCoords2(uvs, count);
+    }
+
+    inline void SetSurfaceTexCoords(LPSURFACE surface, std::vector<DirectX::XMFLOAT2>&& uvs, unsigned int set = 0)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceTexCoords - surface is nullptr");
+            return;
+        }
+        if (set == 0)
+            surface->SetTexCoords(std::move(uvs));
+        else
+            surface->SetTexCoords2(std::move(uvs));
+    }
+
+    inline void SetSurfaceIndices(LPSURFACE surface, const unsigned int* indices, size_t count)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceIndices - surface is nullptr");
+            return;
+        }
+        surface->SetIndices(indices, count);
+    }
+
+    inline void SetSurfaceIndices(LPSURFACE surface, std::vector<unsigned int>&& indices)
+    {
+        if (surface == nullptr) {
+            Debug::Log("ERROR: SetSurfaceIndices - surface is nullptr");
+            return;
+        }
+        surface->SetIndices(std::move(indices));
+    }
+
     // ==================== RENDERING ====================
 
     inline int Cls(int r, int g, int b, int a = 255)
@@ -759,13 +1287,69 @@ namespace Engine
         engine->UpdateWorld();
     }
 
+    // Only filled by the headless engine (CreateHeadlessEngine)
+    inline GDXCommandLog& GetCommandLog()
+    {
+        return engine->m_device.GetCommandLog();
+    }
+
+    // Headless engine: CPU copy behind a buffer (nullptr with D3D11)
+    inline const GDXNullBuffer* GetNullBuffer(ID3D11Buffer* buffer)
+    {
+        return engine->m_device.GetNullBuffer(buffer);
+    }
+
+    // Frustum culling for main and shadow pass (default: on)
+    inline void SetFrustumCulling(bool enabled)
+    {
+        engine->GetRM().SetCullingEnabled(enabled);
+    }
+
+    // Frustum culling hierarchically over the scene tree (default: on), off = every AABB singly
+    inline void SetHierarchicalCulling(bool enabled)
+    {
+        engine->GetRM().SetTreeCullingEnabled(enabled);
+    }
+
+    // Hardware instancing for meshes sharing a surface (CopyEntity), default: on
+    inline void SetInstancing(bool enabled)
+    {
+        engine->GetRM().SetInstancingEnabled(enabled);
+    }
+
+    // LOD selection per mesh from the screen size (default: on). hysteresis: band around every
+    // threshold without a switch (0.1 = ±10%), shadowBias: levels coarser in the shadow pass
+    inline void SetLOD(bool enabled, float hysteresis = 0.1f, unsigned int shadowBias = 1)
+    {
+        engine->GetRM().SetLODEnabled(enabled);
+        engine->GetRM().SetLODHysteresis(hysteresis);
+        engine->GetRM().SetShadowLODBias(shadowBias);
+    }
+
+    // Occlusion culling via occluder meshes (EntityOccluder), default: on.
+    // width/height: resolution of the CPU depth buffer (rounded to multiples of 32)
+    inline void SetOcclusionCulling(bool enabled, unsigned int width = 256, unsigned int height = 128)
+    {
+        engine->GetRM().SetOcclusionCullingEnabled(enabled);
+        OcclusionBuffer& buffer = engine->GetRM().GetOcclusionBuffer();
+        // GetWidth/GetHeight are rounded up to whole tiles, compare the requested size
+        if (buffer.GetRequestedWidth() != width || buffer.GetRequestedHeight() != height)
+            buffer.Resize(width, height);
+    }
+
+    // Candidates/visible meshes and triangles of the last RenderWorld()
+    inline const CullStats& GetCullStats()
+    {
+        return engine->GetRM().GetCullStats();
+    }
+
     // ==================== TEXTURE ====================
 
     inline void LoadTexture(LPLPTEXTURE texture, const wchar_t* filename)
     {
 
-        // Prüfe ob Datei existiert
-        std::wifstream file(filename);
+        // Check whether the file exists
+        std::ifstream file{ std::filesystem::path(filename) };
         if (!file.good()) {
             Debug::Log("ERROR: File not found!");
             return;
@@ -773,6 +1357,12 @@ namespace Engine
 
         *texture = new TEXTURE;
 
+        // Headless: empty texture, the material then binds nothing
+        if (engine->m_device.IsNull()) {
+            Debug::Log("gidx.h: LoadTexture skipped (null device)");
+            return;
+        }
+
         HRESULT hr = engine->GetTM().LoadTexture(
             engine->m_device.GetDevice(),
             engine->m_device.GetDeviceContext(),
@@ -785,6 +1375,86 @@ namespace Engine
         }
     }
 
+    // Like LoadTexture, but returns right away: *texture is a 1x1 texture (white) and can
+    // be bound with MaterialTexture at once. Decoding happens on the loader threads, the upload
+    // in UpdateWorld (SetUploadBudget); afterwards all materials with the placeholder point to the
+    // loaded texture. Error: the placeholder stays, GetAssetState returns Failed.
+    inline AssetHandle LoadTextureAsync(LPLPTEXTURE texture, const wchar_t* filename)
+    {
+        if (texture == nullptr || filename == nullptr) {
+            Debug::Log("ERROR: LoadTextureAsync - texture or filename is nullptr");
+            return INVALID_ASSET;
+        }
+
+        auto rebind = [](Texture* loaded, ID3D11ShaderResourceView* placeholder) {
+            if (placeholder == nullptr)
+                return;
+            for (Material* material : engine->GetOM().GetMaterials()) {
+                if (material->m_textureView != placeholder)
+                    continue;
+                material->SetTexture(loaded->m_texture, loaded->m_textureView, loaded->m_imageSamplerState);
+                material->UpdateConstantBuffer(&engine->m_device);
+            }
+        };
+
+        // Headless: only decode, the material binds nothing
+        ID3D11Device* device = engine->m_device.IsNull() ? nullptr : engine->m_device.GetDevice();
+        return engine->GetTM().LoadTextureAsync(device, filename, texture, engine->GetAL(), rebind);
+    }
+
+    // Mip chain for all textures loaded afterwards (default: box, sRGB, full chain).
+    // Cutouts (foliage, fences): preserveCoverage with the shader's alphaCutoff; maxLevels = 1: no mips
+    inline void SetTextureMipOptions(const MipGenerator::Options& options)
+    {
+        engine->GetTM().SetMipOptions(options);
+    }
+
+    // Load textures block-compressed from now on (BC1 = 1/8, BC3/BC7 = 1/4 of the memory).
+    // The first load encodes and puts the result into cacheDirectory, every later
+    // start reads it straight from there. cacheDirectory nullptr/"": no cache, always encode anew.
+    inline void SetTextureCompression(TextureCompression compression, const char* cacheDirectory = "texcache")
+    {
+        engine->GetTM().SetCompression(compression);
+        engine->GetTM().GetCache().SetDirectory(cacheDirectory ? cacheDirectory : "");
+    }
+
+    inline TextureCacheStats GetTextureCacheStats()
+    {
+        return engine->GetTM().GetCache().GetStats();
+    }
+
+    // ==================== STREAMING ====================
+
+    // Pending (loading), Loaded (waiting for upload budget), Ready, Failed
+    inline AssetState GetAssetState(AssetHandle handle)
+    {
+        return engine->GetAL().GetState(handle);
+    }
+
+    // State and error of the handle are no longer needed: GetAssetState returns Unknown afterwards.
+    // The loaded asset itself stays. Pending handles are dropped once they are Ready/Failed.
+    inline void ReleaseAsset(AssetHandle handle)
+    {
+        engine->GetAL().Release(handle);
+    }
+
+    // Bytes UpdateWorld uploads per frame (default 8 MB). At least one request per frame.
+    inline void SetUploadBudget(size_t bytesPerFrame)
+    {
+        engine->SetUploadBudget(bytesPerFrame);
+    }
+
+    // Blocks until all LoadTextureAsync/LoadMeshAsync requests are done (loading screen)
+    inline void WaitForAssets()
+    {
+        engine->GetAL().Flush();
+    }
+
+    inline const AssetLoaderStats& GetAssetStats()
+    {
+        return engine->GetAL().GetStats();
+    }
+
     inline void MaterialTexture(LPMATERIAL material, LPTEXTURE texture)
     {
         if (material == nullptr) {
@@ -798,7 +1468,21 @@ namespace Engine
         }
 
         material->SetTexture(texture->m_texture, texture->m_textureView, texture->m_imageSamplerState);
-        material->UpdateConstantBuffer(engine->m_device.GetDeviceContext());
+        material->UpdateConstantBuffer(&engine->m_device);
+    }
+
+    // Opaque (default), AlphaTest, Transparent or Additive
+    inline void MaterialRenderQueue(LPMATERIAL material, RenderQueueType queue)
+    {
+        if (!material) { Debug::Log("ERROR: MaterialRenderQueue - material is nullptr"); return; }
+        material->SetRenderQueue(queue);
+    }
+
+    // Name for cooked meshes: LoadMesh without a material looks up the material with this name
+    inline void MaterialName(LPMATERIAL material, const char* name)
+    {
+        if (!material) { Debug::Log("ERROR: MaterialName - material is nullptr"); return; }
+        material->name = name ? name : "";
     }
 
     inline void EntityMaterial(LPENTITY entity, LPMATERIAL material)
@@ -913,6 +1597,24 @@ namespace Engine
         mesh->SetCollisionMode(mode);
     }
 
+    // Mesh occludes other meshes (occlusion culling): large, closed, opaque
+    // meshes with few triangles - walls, buildings, terrain
+    inline void EntityOccluder(LPENTITY entity, bool enable)
+    {
+        if (entity == nullptr) {
+            Debug::Log("ERROR: EntityOccluder - entity is nullptr");
+            return;
+        }
+
+        Mesh* mesh = dynamic_cast<Mesh*>(entity);
+        if (mesh == nullptr) {
+            Debug::Log("ERROR: EntityOccluder - Entity is not a Mesh!");
+            return;
+        }
+
+        mesh->occluder = enable;
+    }
+
     inline LPSURFACE EntitySurface(LPENTITY entity, unsigned int index = 0)
     {
         if (entity == nullptr) {
@@ -947,6 +1649,128 @@ namespace Engine
         return mesh1->CheckCollision(mesh2);
     }
 
+    // All overlapping pairs (OBB) of the meshes with a collision mode, broadphase instead of N² EntityCollision.
+    // Call after UpdateWorld(); valid until the next call.
+    inline const std::vector<CollisionPair>& CollideAll()
+    {
+        return engine->GetCM().CollideAll(engine->GetOM().GetMeshes());
+    }
+
+    // Colliders/candidates/pairs of the last CollideAll()
+    inline const CollisionStats& GetCollisionStats()
+    {
+        return engine->GetCM().GetStats();
+    }
+
+    // Meshes whose world AABB intersects the box (scene tree, as of the last UpdateWorld)
+    inline size_t EntitiesInBox(const DirectX::BoundingBox& box, std::vector<LPMESH>& out)
+    {
+        return engine->GetOM().QueryBox(box, out);
+    }
+
+    // Meshes whose world AABB intersects the sphere
+    inline size_t EntitiesInSphere(const DirectX::BoundingSphere& sphere, std::vector<LPMESH>& out)
+    {
+        return engine->GetOM().QuerySphere(sphere, out);
+    }
+
+    // Meshes in the camera's view (view * projection of the last UpdateWorld)
+    inline size_t EntitiesInView(LPENTITY camera, std::vector<LPMESH>& out)
+    {
+        out.clear();
+        if (camera == nullptr) {
+            Debug::Log("ERROR: EntitiesInView - camera is nullptr");
+            return 0;
+        }
+
+        Frustum frustum;
+        frustum.ExtractFromMatrix(DirectX::XMMatrixMultiply(
+            camera->matrixSet.viewMatrix, camera->matrixSet.projectionMatrix));
+        return engine->GetOM().QueryFrustum(frustum, out);
+    }
+
+    // Closest mesh along the ray - the triangles are hit, not the OBB.
+    // Bounds/matrices as of the last UpdateWorld. hit (optional): point, normal, triangle
+    inline LPENTITY RaycastEntity(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction,
+        float maxDistance = FLT_MAX, RaycastHit* hit = nullptr, LPENTITY ignore = nullptr)
+    {
+        Ray ray;
+        ray.origin = origin;
+        ray.direction = direction;
+        ray.maxDistance = maxDistance;
+        ray.ignore[0] = dynamic_cast<Mesh*>(ignore);
+
+        RaycastHit result;
+        if (!engine->GetCM().Raycast(engine->GetOM().GetSceneTree(), ray, result))
+            return nullptr;
+        if (hit)
+            *hit = result;
+        return result.mesh;
+    }
+
+    // Mesh under the screen point (pixel in the camera's viewport), e.g. the mouse position
+    inline LPENTITY PickEntity(LPENTITY camera, float x, float y, RaycastHit* hit = nullptr)
+    {
+        if (camera == nullptr) {
+            Debug::Log("ERROR: PickEntity - camera is nullptr");
+            return nullptr;
+        }
+
+        const D3D11_VIEWPORT& viewport = camera->viewport;
+        const DirectX::XMMATRIX& view = camera->matrixSet.viewMatrix;
+        const DirectX::XMMATRIX& projection = camera->matrixSet.projectionMatrix;
+
+        // Point on the near and far plane back in world coordinates
+        const DirectX::XMVECTOR nearPoint = DirectX::XMVector3Unproject(DirectX::XMVectorSet(x, y, viewport.MinDepth, 0.0f),
+            viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth,
+            projection, view, DirectX::XMMatrixIdentity());
+        const DirectX::XMVECTOR farPoint = DirectX::XMVector3Unproject(DirectX::XMVectorSet(x, y, viewport.MaxDepth, 0.0f),
+            viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth,
+            projection, view, DirectX::XMMatrixIdentity());
+
+        Ray ray;
+        DirectX::XMStoreFloat3(&ray.origin, nearPoint);
+        DirectX::XMStoreFloat3(&ray.direction, DirectX::XMVectorSubtract(farPoint, nearPoint));
+        ray.maxDistance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(farPoint, nearPoint)));
+
+        RaycastHit result;
+        if (!engine->GetCM().Raycast(engine->GetOM().GetSceneTree(), ray, result))
+            return nullptr;
+        if (hit)
+            *hit = result;
+        return result.mesh;
+    }
+
+    // Clear line of sight from from to to? ignoreA/ignoreB (e.g. viewer and target) do not occlude
+    inline bool LineOfSight(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to,
+        LPENTITY ignoreA = nullptr, LPENTITY ignoreB = nullptr)
+    {
+        Ray ray;
+        ray.origin = from;
+        ray.direction = DirectX::XMFLOAT3(to.x - from.x, to.y - from.y, to.z - from.z);
+        ray.maxDistance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMLoadFloat3(&ray.direction)));
+        ray.ignore[0] = dynamic_cast<Mesh*>(ignoreA);
+        ray.ignore[1] = dynamic_cast<Mesh*>(ignoreB);
+        if (ray.maxDistance <= 0.0f)
+            return true;
+
+        RaycastHit hit;
+        return !engine->GetCM().Raycast(engine->GetOM().GetSceneTree(), ray, hit, true);
+    }
+
+    // Many rays at once (JobSystem, packets of 4), e.g. lines of sight of all AI agents.
+    // hits[i] belongs to rays[i]; anyHit is enough for lines of sight. Returns the number of hits
+    inline size_t RaycastBatch(const Ray* rays, size_t count, RaycastHit* hits, bool anyHit = false)
+    {
+        return engine->GetCM().RaycastBatch(engine->GetOM().GetSceneTree(), rays, count, hits, anyHit);
+    }
+
+    // Rays/mesh tests/packets/hits of the last raycast
+    inline const RaycastStats& GetRaycastStats()
+    {
+        return engine->GetCM().GetRaycastStats();
+    }
+
     inline DirectX::BoundingOrientedBox* EntityOBB(LPENTITY entity)
     {
         if (entity == nullptr) {
@@ -10,6 +10,7 @@ cbuffer ConstantBuffer : register(b0)
     row_major float4x4 _viewMatrix;
     row_major float4x4 _projectionMatrix;
     row_major float4x4 _worldMatrix;
+    row_major float4x4 _normalMatrix;   // World without the dequantization of quantized positions
 };
 
 // Struktur fuer ein einzelnes Licht (muss mit C++ LightBufferData kompatibel sein!)
@@ -83,7 +84,7 @@ VS_OUTPUT main(VS_INPUT input)
     o.position = mul(o.position, _projectionMatrix);
 
     // Normale in den Welt-Raum transformieren (ohne Translation)
-    o.normal = normalize(mul(input.normal, (float3x3) _worldMatrix));
+    o.normal = normalize(mul(input.normal, (float3x3) _normalMatrix));
 
     // Vertex-Attribute kopieren
     o.color = input.color;
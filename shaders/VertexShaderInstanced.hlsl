@@ -0,0 +1,121 @@
+// VertexShaderInstanced.hlsl - giDX Engine
+// Like VertexShader.hlsl, but the world matrix comes per instance from the
+// instance buffer (INSTANCE_WORLD0..3). _worldMatrix in b0 is ignored,
+// _normalMatrix corrects the normals of quantized surfaces.
+// Registers: b0 (Matrices), b1 (Lights), b2 (Material), b3 (Shadow Matrices)
+
+// ==================== CONSTANT BUFFERS ====================
+
+cbuffer ConstantBuffer : register(b0)
+{
+    row_major float4x4 _viewMatrix;
+    row_major float4x4 _projectionMatrix;
+    row_major float4x4 _worldMatrix;
+    row_major float4x4 _normalMatrix;   // Per group: inverse dequantization scale (identity unless quantized)
+};
+
+// Structure for a single light (must match C++ LightBufferData!)
+struct LightData
+{
+    float4 lightPosition; // XYZ: position, W: 0 for directional, 1 for positional
+    float4 lightDirection; // XYZ: direction
+    float4 lightDiffuseColor; // RGB: diffuse color
+    float4 lightAmbientColor; // RGB: ambient color (only relevant for the first light)
+};
+
+// Light array buffer (IN SYNC with the pixel shader)
+cbuffer LightBuffer : register(b1)
+{
+    LightData lights[32]; // array of up to 32 lights
+    uint lightCount; // current number of lights
+    float3 lightPadding; // padding for 16-byte alignment
+};
+
+cbuffer MaterialBuffer : register(b2)
+{
+    float4 diffuseColor;
+    float4 specularColor;
+    float shininess;
+    float transparency;
+    float2 padding;
+};
+
+// ==================== SHADOW MAPPING BUFFER ====================
+
+cbuffer ShadowMatrixBuffer : register(b3)
+{
+    row_major float4x4 lightViewMatrix;
+    row_major float4x4 lightProjectionMatrix;
+};
+
+// ==================== INPUT / OUTPUT STRUCTURES ====================
+
+struct VS_INPUT
+{
+    float3 position : POSITION;
+    float3 normal : NORMAL;
+    float4 color : COLOR;
+    float2 texCoord : TEXCOORD0;
+
+    // Per instance (row_major, rows like XMFLOAT4X4)
+    float4 world0 : INSTANCE_WORLD0;
+    float4 world1 : INSTANCE_WORLD1;
+    float4 world2 : INSTANCE_WORLD2;
+    float4 world3 : INSTANCE_WORLD3;
+};
+
+struct VS_OUTPUT
+{
+    float4 position : SV_POSITION; // clip-space position
+    float3 normal : NORMAL; // normal in world space
+    float3 worldPosition : TEXCOORD1; // position in world space
+    float4 color : COLOR; // vertex color
+    float2 texCoord : TEXCOORD0; // texture coordinates
+    float4 positionLightSpace : TEXCOORD2; // shadow mapping: position in light space
+    float3 viewDirection : TEXCOORD3; // direction to the camera (for specular)
+};
+
+// ==================== MAIN VERTEX SHADER ====================
+
+VS_OUTPUT main(VS_INPUT input)
+{
+    VS_OUTPUT o;
+
+    float4x4 worldMatrix = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+    // Compute the world position
+    float4 tempPosition = float4(input.position, 1.0f);
+    float4 worldPos = mul(tempPosition, worldMatrix);
+    o.worldPosition = worldPos.xyz;
+
+    // Clip-space position
+    o.position = mul(worldPos, _viewMatrix);
+    o.position = mul(o.position, _projectionMatrix);
+
+    // Transform the normal into world space (without translation)
+    // The instance matrix contains the dequantization, _normalMatrix undoes its scale
+    o.normal = normalize(mul(mul(input.normal, (float3x3) _normalMatrix), (float3x3) worldMatrix));
+
+    // Copy the vertex attributes
+    o.color = input.color;
+    o.texCoord = input.texCoord;
+
+    // Shadow mapping: transform the world position into light space
+    float4 lightViewPos = mul(worldPos, lightViewMatrix);
+    o.positionLightSpace = mul(lightViewPos, lightProjectionMatrix);
+
+    // Extract the camera position from the view matrix (row_major LookToLH)
+    // The view matrix stores: rows 0-2 = rotation, row 3 = -R*eye
+    // Camera position = -transpose(R) * translation
+    float3 vt = float3(_viewMatrix[3][0], _viewMatrix[3][1], _viewMatrix[3][2]);
+    float3 cameraPosition = float3(
+        -dot(float3(_viewMatrix[0][0], _viewMatrix[0][1], _viewMatrix[0][2]), vt),
+        -dot(float3(_viewMatrix[1][0], _viewMatrix[1][1], _viewMatrix[1][2]), vt),
+        -dot(float3(_viewMatrix[2][0], _viewMatrix[2][1], _viewMatrix[2][2]), vt)
+    );
+
+    o.viewDirection = normalize(cameraPosition - worldPos.xyz);
+
+    return o;
+}
+
@@ -0,0 +1,633 @@
+#include "AABBTree.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace DirectX;
+
+// Binned SAH build: bins per split, degradation until rebuild
+static constexpr int SAH_BINS = 16;
+static constexpr size_t SAH_MIN_COUNT = 8;
+static constexpr float REBUILD_COST_RATIO = 1.5f;
+
+static float SurfaceArea(const XMFLOAT3& lower, const XMFLOAT3& upper)
+{
+    const float dx = upper.x - lower.x;
+    const float dy = upper.y - lower.y;
+    const float dz = upper.z - lower.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void Union(const XMFLOAT3& lowerA, const XMFLOAT3& upperA, const XMFLOAT3& lowerB, const XMFLOAT3& upperB,
+    XMFLOAT3& lower, XMFLOAT3& upper)
+{
+    lower = XMFLOAT3((std::min)(lowerA.x, lowerB.x), (std::min)(lowerA.y, lowerB.y), (std::min)(lowerA.z, lowerB.z));
+    upper = XMFLOAT3((std::max)(upperA.x, upperB.x), (std::max)(upperA.y, upperB.y), (std::max)(upperA.z, upperB.z));
+}
+
+static float Axis(const XMFLOAT3& v, int axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+AABBTree::AABBTree() :
+    m_root(NULL_NODE),
+    m_freeList(NULL_NODE),
+    m_proxyCount(0),
+    m_marginAbsolute(0.1f),
+    m_marginRelative(0.1f),
+    m_internalArea(0.0),
+    m_rebuildCost(0.0f),
+    m_proxiesAtRebuild(0),
+    m_structureChanges(0),
+    m_rebuildCount(0)
+{
+}
+
+void AABBTree::SetFatMargin(float absolute, float relative)
+{
+    m_marginAbsolute = (std::max)(absolute, 0.0f);
+    m_marginRelative = (std::max)(relative, 0.0f);
+}
+
+void AABBTree::Clear()
+{
+    m_nodes.clear();
+    m_root = NULL_NODE;
+    m_freeList = NULL_NODE;
+    m_proxyCount = 0;
+    m_internalArea = 0.0;
+    m_rebuildCost = 0.0f;
+    m_proxiesAtRebuild = 0;
+    m_structureChanges = 0;
+}
+
+// ==================== NODES ====================
+
+uint32_t AABBTree::AllocateNode()
+{
+    uint32_t index;
+    if (m_freeList != NULL_NODE)
+    {
+        index = m_freeList;
+        m_freeList = m_nodes[index].parent;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& node = m_nodes[index];
+    node.lower = node.upper = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    node.userData = nullptr;
+    return index;
+}
+
+void AABBTree::FreeNode(uint32_t index)
+{
+    Node& node = m_nodes[index];
+    if (node.height > 0)
+        m_internalArea -= SurfaceArea(node.lower, node.upper);
+
+    node.parent = m_freeList;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = -1;
+    node.userData = nullptr;
+    m_freeList = index;
+}
+
+void AABBTree::SetBox(uint32_t index, const XMFLOAT3& lower, const XMFLOAT3& upper)
+{
+    Node& node = m_nodes[index];
+    if (node.height > 0)
+        m_internalArea += SurfaceArea(lower, upper) - SurfaceArea(node.lower, node.upper);
+    node.lower = lower;
+    node.upper = upper;
+}
+
+void AABBTree::SetUnion(uint32_t index, uint32_t a, uint32_t b)
+{
+    XMFLOAT3 lower, upper;
+    Union(m_nodes[a].lower, m_nodes[a].upper, m_nodes[b].lower, m_nodes[b].upper, lower, upper);
+    SetBox(index, lower, upper);
+}
+
+void AABBTree::FattenBox(const BoundingBox& box, XMFLOAT3& lower, XMFLOAT3& upper) const
+{
+    const XMFLOAT3& c = box.Center;
+    const XMFLOAT3& e = box.Extents;
+    const float mx = e.x + m_marginAbsolute + e.x * m_marginRelative;
+    const float my = e.y + m_marginAbsolute + e.y * m_marginRelative;
+    const float mz = e.z + m_marginAbsolute + e.z * m_marginRelative;
+    lower = XMFLOAT3(c.x - mx, c.y - my, c.z - mz);
+    upper = XMFLOAT3(c.x + mx, c.y + my, c.z + mz);
+}
+
+BoundingBox AABBTree::GetFatBox(uint32_t proxy) const
+{
+    const Node& node = m_nodes[proxy];
+    return BoundingBox(
+        XMFLOAT3((node.lower.x + node.upper.x) * 0.5f, (node.lower.y + node.upper.y) * 0.5f, (node.lower.z + node.upper.z) * 0.5f),
+        XMFLOAT3((node.upper.x - node.lower.x) * 0.5f, (node.upper.y - node.lower.y) * 0.5f, (node.upper.z - node.lower.z) * 0.5f));
+}
+
+float AABBTree::GetCost() const
+{
+    if (m_root == NULL_NODE)
+        return 0.0f;
+
+    const float rootArea = SurfaceArea(m_nodes[m_root].lower, m_nodes[m_root].upper);
+    return rootArea > 0.0f ? static_cast<float>(m_internalArea / rootArea) : 0.0f;
+}
+
+// ==================== PROXIES ====================
+
+uint32_t AABBTree::CreateProxy(const BoundingBox& box, void* userData)
+{
+    const uint32_t proxy = AllocateNode();
+
+    XMFLOAT3 lower, upper;
+    FattenBox(box, lower, upper);
+    SetBox(proxy, lower, upper);
+    m_nodes[proxy].userData = userData;
+
+    InsertLeaf(proxy);
+    ++m_proxyCount;
+    ++m_structureChanges;
+    return proxy;
+}
+
+void AABBTree::DestroyProxy(uint32_t proxy)
+{
+    if (proxy >= m_nodes.size() || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height != 0)
+        return;
+
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --m_proxyCount;
+    ++m_structureChanges;
+}
+
+bool AABBTree::NeedsMove(uint32_t proxy, const BoundingBox& box) const
+{
+    const Node& node = m_nodes[proxy];
+    const XMFLOAT3& c = box.Center;
+    const XMFLOAT3& e = box.Extents;
+    return c.x - e.x < node.lower.x || c.x + e.x > node.upper.x ||
+           c.y - e.y < node.lower.y || c.y + e.y > node.upper.y ||
+           c.z - e.z < node.lower.z || c.z + e.z > node.upper.z;
+}
+
+void AABBTree::MoveProxy(uint32_t proxy, const BoundingBox& box)
+{
+    XMFLOAT3 lower, upper;
+    FattenBox(box, lower, upper);
+
+    const Node& node = m_nodes[proxy];
+    const XMFLOAT3& c = box.Center;
+    const XMFLOAT3& e = box.Extents;
+    const bool overlapsOld =
+        c.x - e.x <= node.upper.x && c.x + e.x >= node.lower.x &&
+        c.y - e.y <= node.upper.y && c.y + e.y >= node.lower.y &&
+        c.z - e.z <= node.upper.z && c.z + e.z >= node.lower.z;
+
+    if (overlapsOld)
+    {
+        // Small move: keep the structure, only adjust the boxes up to the root
+        SetBox(proxy, lower, upper);
+        RefitParents(proxy);
+        return;
+    }
+
+    // Jump: file it in at the new position
+    RemoveLeaf(proxy);
+    SetBox(proxy, lower, upper);
+    InsertLeaf(proxy);
+}
+
+void AABBTree::RefitParents(uint32_t index)
+{
+    uint32_t parent = m_nodes[index].parent;
+    while (parent != NULL_NODE)
+    {
+        const Node& node = m_nodes[parent];
+        XMFLOAT3 lower, upper;
+        Union(m_nodes[node.child1].lower, m_nodes[node.child1].upper,
+            m_nodes[node.child2].lower, m_nodes[node.child2].upper, lower, upper);
+
+        // Unchanged: the ancestors too
+        if (lower.x == node.lower.x && lower.y == node.lower.y && lower.z == node.lower.z &&
+            upper.x == node.upper.x && upper.y == node.upper.y && upper.z == node.upper.z)
+            break;
+
+        SetBox(parent, lower, upper);
+        parent = node.parent;
+    }
+}
+
+// ==================== INSERT / REMOVE ====================
+
+void AABBTree::InsertLeaf(uint32_t leaf)
+{
+    if (m_root == NULL_NODE)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the sibling with the lowest cost (area + inherited growth)
+    const XMFLOAT3 leafLower = m_nodes[leaf].lower;
+    const XMFLOAT3 leafUpper = m_nodes[leaf].upper;
+
+    uint32_t index = m_root;
+    while (!m_nodes[index].IsLeaf())
+    {
+        const Node& node = m_nodes[index];
+
+        XMFLOAT3 lower, upper;
+        Union(node.lower, node.upper, leafLower, leafUpper, lower, upper);
+        const float area = SurfaceArea(node.lower, node.upper);
+        const float combinedArea = SurfaceArea(lower, upper);
+
+        // New parent for node and leaf
+        const float cost = 2.0f * combinedArea;
+        // Minimum cost of hanging leaf further down
+        const float inheritance = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](uint32_t child)
+            {
+                const Node& c = m_nodes[child];
+                XMFLOAT3 l, u;
+                Union(c.lower, c.upper, leafLower, leafUpper, l, u);
+                const float childArea = SurfaceArea(l, u);
+                return c.IsLeaf() ? childArea + inheritance
+                    : (childArea - SurfaceArea(c.lower, c.upper)) + inheritance;
+            };
+
+        const float cost1 = descendCost(node.child1);
+        const float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const uint32_t sibling = index;
+    const uint32_t oldParent = m_nodes[sibling].parent;
+    const uint32_t newParent = AllocateNode();
+
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[newParent].child1 = sibling;
+    m_nodes[newParent].child2 = leaf;
+    SetUnion(newParent, sibling, leaf);
+
+    if (oldParent != NULL_NODE)
+    {
+        if (m_nodes[oldParent].child1 == sibling)
+            m_nodes[oldParent].child1 = newParent;
+        else
+            m_nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        m_root = newParent;
+    }
+
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    // Heights and boxes up to the root, balancing on the way
+    index = m_nodes[leaf].parent;
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = m_nodes[index];
+        node.height = 1 + (std::max)(m_nodes[node.child1].height, m_nodes[node.child2].height);
+        SetUnion(index, node.child1, node.child2);
+
+        index = m_nodes[index].parent;
+    }
+}
+
+void AABBTree::RemoveLeaf(uint32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    const uint32_t parent = m_nodes[leaf].parent;
+    const uint32_t grandParent = m_nodes[parent].parent;
+    const uint32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    m_nodes[leaf].parent = NULL_NODE;
+
+    if (grandParent == NULL_NODE)
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+        return;
+    }
+
+    // Replace the parent with the sibling
+    if (m_nodes[grandParent].child1 == parent)
+        m_nodes[grandParent].child1 = sibling;
+    else
+        m_nodes[grandParent].child2 = sibling;
+    m_nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    uint32_t index = grandParent;
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = m_nodes[index];
+        node.height = 1 + (std::max)(m_nodes[node.child1].height, m_nodes[node.child2].height);
+        SetUnion(index, node.child1, node.child2);
+
+        index = m_nodes[index].parent;
+    }
+}
+
+uint32_t AABBTree::Balance(uint32_t iA)
+{
+    // Rotation as in an AVL tree when the children's heights differ by more than 1
+    Node& A = m_nodes[iA];
+    if (A.IsLeaf() || A.height < 2)
+        return iA;
+
+    const uint32_t iB = A.child1;
+    const uint32_t iC = A.child2;
+    Node& B = m_nodes[iB];
+    Node& C = m_nodes[iC];
+    const int balance = C.height - B.height;
+
+    // C goes up
+    if (balance > 1)
+    {
+        const uint32_t iF = C.child1;
+        const uint32_t iG = C.child2;
+        Node& F = m_nodes[iF];
+        Node& G = m_nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != NULL_NODE)
+        {
+            if (m_nodes[C.parent].child1 == iA)
+                m_nodes[C.parent].child1 = iC;
+            else
+                m_nodes[C.parent].child2 = iC;
+        }
+        else
+        {
+            m_root = iC;
+        }
+
+        if (F.height > G.height)
+        {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.height = 1 + (std::max)(B.height, G.height);
+            C.height = 1 + (std::max)(A.height, F.height);
+        }
+        else
+        {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.height = 1 + (std::max)(B.height, F.height);
+            C.height = 1 + (std::max)(A.height, G.height);
+        }
+
+        SetUnion(iA, A.child1, A.child2);
+        SetUnion(iC, C.child1, C.child2);
+        return iC;
+    }
+
+    // B goes up
+    if (balance < -1)
+    {
+        const uint32_t iD = B.child1;
+        const uint32_t iE = B.child2;
+        Node& D = m_nodes[iD];
+        Node& E = m_nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != NULL_NODE)
+        {
+            if (m_nodes[B.parent].child1 == iA)
+                m_nodes[B.parent].child1 = iB;
+            else
+                m_nodes[B.parent].child2 = iB;
+        }
+        else
+        {
+            m_root = iB;
+        }
+
+        if (D.height > E.height)
+        {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.height = 1 + (std::max)(C.height, E.height);
+            B.height = 1 + (std::max)(A.height, D.height);
+        }
+        else
+        {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.height = 1 + (std::max)(C.height, D.height);
+            B.height = 1 + (std::max)(A.height, E.height);
+        }
+
+        SetUnion(iA, A.child1, A.child2);
+        SetUnion(iB, B.child1, B.child2);
+        return iB;
+    }
+
+    return iA;
+}
+
+// ==================== SAH REBUILD ====================
+
+bool AABBTree::RebuildIfDegraded()
+{
+    if (m_proxyCount < 2)
+        return false;
+
+    // Many new/deleted leaves (e.g. scene just built) or refits have pushed
+    // the cost well above the level after the last rebuild
+    const bool structure = m_structureChanges > m_proxiesAtRebuild / 2 + 32;
+    const bool degraded = m_rebuildCost > 0.0f && GetCost() > m_rebuildCost * REBUILD_COST_RATIO;
+    if (!structure && !degraded)
+        return false;
+
+    Rebuild();
+    return true;
+}
+
+void AABBTree::Rebuild()
+{
+    // Collect the leaves, free the internal nodes. Leaf indices (= proxy ids) stay.
+    m_buildItems.clear();
+    m_buildItems.reserve(m_proxyCount);
+
+    for (uint32_t i = 0; i < m_nodes.size(); ++i)
+    {
+        Node& node = m_nodes[i];
+        if (node.height < 0)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            node.parent = NULL_NODE;
+            const XMFLOAT3 centroid((node.lower.x + node.upper.x) * 0.5f,
+                (node.lower.y + node.upper.y) * 0.5f, (node.lower.z + node.upper.z) * 0.5f);
+            m_buildItems.push_back({ node.lower, node.upper, centroid, i });
+        }
+        else
+        {
+            FreeNode(i);
+        }
+    }
+
+    m_internalArea = 0.0;
+    m_root = m_buildItems.empty() ? NULL_NODE : BuildRange(m_buildItems.data(), m_buildItems.size());
+    if (m_root != NULL_NODE)
+        m_nodes[m_root].parent = NULL_NODE;
+
+    m_rebuildCost = GetCost();
+    m_proxiesAtRebuild = m_proxyCount;
+    m_structureChanges = 0;
+    ++m_rebuildCount;
+}
+
+uint32_t AABBTree::BuildRange(BuildItem* items, size_t count)
+{
+    if (count == 1)
+        return items[0].leaf;
+
+    // Centroid bounds: the axis with the largest extent is split
+    XMFLOAT3 cMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    XMFLOAT3 cMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < count; ++i)
+        Union(cMin, cMax, items[i].centroid, items[i].centroid, cMin, cMax);
+
+    const XMFLOAT3 size(cMax.x - cMin.x, cMax.y - cMin.y, cMax.z - cMin.z);
+    const int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+    const float axisMin = Axis(cMin, axis);
+    const float axisSize = Axis(size, axis);
+
+    size_t split = count / 2;
+
+    // Few leaves: the median is enough, binning only pays off from a few dozen
+    if (count <= SAH_MIN_COUNT)
+    {
+        std::nth_element(items, items + split, items + count,
+            [axis](const BuildItem& a, const BuildItem& b) { return Axis(a.centroid, axis) < Axis(b.centroid, axis); });
+    }
+    else if (axisSize > 0.0f)
+    {
+        const float scale = SAH_BINS / axisSize;
+        auto binOf = [&](const BuildItem& item)
+            {
+                const int bin = static_cast<int>((Axis(item.centroid, axis) - axisMin) * scale);
+                return (std::min)(bin, SAH_BINS - 1);
+            };
+
+        struct Bin
+        {
+            XMFLOAT3 lower = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+            XMFLOAT3 upper = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+            size_t count = 0;
+        };
+        Bin bins[SAH_BINS];
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Bin& bin = bins[binOf(items[i])];
+            Union(bin.lower, bin.upper, items[i].lower, items[i].upper, bin.lower, bin.upper);
+            ++bin.count;
+        }
+
+        // Cost of each split plane: area left * count left + area right * count right
+        float rightCost[SAH_BINS] = {};
+        {
+            XMFLOAT3 lower(FLT_MAX, FLT_MAX, FLT_MAX), upper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+            size_t n = 0;
+            for (int b = SAH_BINS - 1; b > 0; --b)
+            {
+                if (bins[b].count)
+                    Union(lower, upper, bins[b].lower, bins[b].upper, lower, upper);
+                n += bins[b].count;
+                rightCost[b] = n ? SurfaceArea(lower, upper) * n : 0.0f;
+            }
+        }
+
+        float bestCost = FLT_MAX;
+        int bestBin = -1;
+        XMFLOAT3 lower(FLT_MAX, FLT_MAX, FLT_MAX), upper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        size_t n = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b)
+        {
+            if (bins[b].count)
+                Union(lower, upper, bins[b].lower, bins[b].upper, lower, upper);
+            n += bins[b].count;
+            if (n == 0 || n == count)
+                continue;
+
+            const float cost = SurfaceArea(lower, upper) * n + rightCost[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestBin = b;
+            }
+        }
+
+        // Centroids min and max land in bin 0 and the last bin -> bestBin exists
+        if (bestBin >= 0)
+        {
+            BuildItem* middle = std::partition(items, items + count,
+                [&](const BuildItem& item) { return binOf(item) <= bestBin; });
+            split = static_cast<size_t>(middle - items);
+        }
+    }
+
+    // All centroids equal: take the middle, the tree stays balanced
+    if (split == 0 || split == count)
+        split = count / 2;
+
+    const uint32_t child1 = BuildRange(items, split);
+    const uint32_t child2 = BuildRange(items + split, count - split);
+
+    const uint32_t index = AllocateNode();
+    Node& node = m_nodes[index];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.height = 1 + (std::max)(m_nodes[child1].height, m_nodes[child2].height);
+    m_nodes[child1].parent = index;
+    m_nodes[child2].parent = index;
+    SetUnion(index, child1, child2);
+    return index;
+}
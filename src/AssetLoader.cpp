@@ -0,0 +1,276 @@
+#include "AssetLoader.h"
+#include "gdxdebug.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+AssetLoader::AssetLoader() :
+    m_stop(false),
+    m_completed(nullptr),
+    m_nextHandle(INVALID_ASSET)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    Shutdown();
+}
+
+void AssetLoader::Init(unsigned int threadCount)
+{
+    if (!m_threads.empty())
+        return;
+
+    if (threadCount == 0)
+        threadCount = 2;
+
+    m_stop = false;
+    m_threads.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&AssetLoader::WorkerLoop, this);
+    }
+
+    Debug::Log("AssetLoader.cpp: Init - ", threadCount, " loader threads");
+}
+
+void AssetLoader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+    m_threads.clear();
+
+    // Discard unfinished requests: the placeholder objects may already be gone
+    std::vector<Job*> cancelled(m_queue.begin(), m_queue.end());
+    m_queue.clear();
+    cancelled.insert(cancelled.end(), m_ready.begin(), m_ready.end());
+    m_ready.clear();
+    for (Job* job = m_completed.exchange(nullptr, std::memory_order_acquire); job; job = job->next)
+        cancelled.push_back(job);
+
+    for (Job* job : cancelled)
+    {
+        m_states[job->handle] = AssetState::Failed;
+        m_errors[job->handle] = "cancelled";
+        ++m_stats.failed;
+        if (m_released.erase(job->handle))
+            Release(job->handle);
+        delete job;
+    }
+    m_stats.pending = 0;
+}
+
+AssetHandle AssetLoader::Submit(std::unique_ptr<AssetRequest> request)
+{
+    if (!request)
+        return INVALID_ASSET;
+
+    Job* job = new Job;
+    job->handle = ++m_nextHandle;
+    job->request = std::move(request);
+    job->loaded = false;
+    job->next = nullptr;
+
+    m_states[job->handle] = AssetState::Pending;
+    ++m_stats.pending;
+
+    if (m_threads.empty())
+    {
+        RunLoad(job);
+        return job->handle;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(job);
+    }
+    m_wake.notify_one();
+    return job->handle;
+}
+
+void AssetLoader::WorkerLoop()
+{
+    // Frame work (main thread, JobSystem) takes precedence over decoding
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(SYS_gettid)
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+
+    for (;;)
+    {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_stop)
+                return;
+            job = m_queue.front();
+            m_queue.pop_front();
+        }
+        RunLoad(job);
+    }
+}
+
+void AssetLoader::RunLoad(Job* job)
+{
+    job->loaded = job->request->Load();
+    PushCompleted(job);
+}
+
+void AssetLoader::PushCompleted(Job* job)
+{
+    // Treiber stack: several producers, the main thread always takes the whole list (no ABA)
+    Job* head = m_completed.load(std::memory_order_relaxed);
+    do
+    {
+        job->next = head;
+    } while (!m_completed.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void AssetLoader::CollectCompleted()
+{
+    Job* list = m_completed.exchange(nullptr, std::memory_order_acquire);
+
+    // Reverse the stack: first finished = first uploaded
+    Job* ordered = nullptr;
+    while (list)
+    {
+        Job* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+
+    for (Job* job = ordered; job; )
+    {
+        Job* next = job->next;
+        if (job->loaded)
+        {
+            m_states[job->handle] = AssetState::Loaded;
+            m_ready.push_back(job);
+        }
+        else
+        {
+            Finish(job, false);
+        }
+        job = next;
+    }
+}
+
+size_t AssetLoader::Update(size_t budgetBytes)
+{
+    CollectCompleted();
+
+    size_t bytes = 0;
+    size_t count = 0;
+    while (!m_ready.empty())
+    {
+        Job* job = m_ready.front();
+        const size_t size = job->request->GetUploadBytes();
+        if (count > 0 && (bytes >= budgetBytes || size > budgetBytes - bytes))
+            break;
+
+        m_ready.pop_front();
+        const bool uploaded = job->request->Upload();
+        if (uploaded)
+        {
+            bytes += size;
+            ++count;
+            m_stats.bytes += size;
+        }
+        Finish(job, uploaded);
+    }
+
+    m_stats.uploadedFrame = count;
+    m_stats.bytesFrame = bytes;
+    return bytes;
+}
+
+void AssetLoader::Flush()
+{
+    while (m_stats.pending > 0)
+    {
+        // Help loading instead of only waiting for the loader threads
+        Job* job = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_queue.empty())
+            {
+                job = m_queue.front();
+                m_queue.pop_front();
+            }
+        }
+        if (job)
+            RunLoad(job);
+
+        Update(SIZE_MAX);
+
+        if (!job && m_stats.pending > 0)
+            std::this_thread::yield();
+    }
+}
+
+void AssetLoader::Finish(Job* job, bool uploaded)
+{
+    if (uploaded)
+    {
+        m_states[job->handle] = AssetState::Ready;
+        ++m_stats.uploaded;
+    }
+    else
+    {
+        job->request->Fail();
+        m_states[job->handle] = AssetState::Failed;
+        m_errors[job->handle] = job->request->error;
+        ++m_stats.failed;
+        Debug::Log("AssetLoader.cpp: request ", job->handle, " failed: ", job->request->error.c_str());
+    }
+
+    if (m_released.erase(job->handle))
+        Release(job->handle);
+
+    --m_stats.pending;
+    delete job;
+}
+
+AssetState AssetLoader::GetState(AssetHandle handle) const
+{
+    auto it = m_states.find(handle);
+    return it != m_states.end() ? it->second : AssetState::Unknown;
+}
+
+const char* AssetLoader::GetError(AssetHandle handle) const
+{
+    auto it = m_errors.find(handle);
+    return it != m_errors.end() ? it->second.c_str() : "";
+}
+
+void AssetLoader::Release(AssetHandle handle)
+{
+    auto it = m_states.find(handle);
+    if (it == m_states.end())
+        return;
+
+    // Still loading: Finish drops the entries
+    if (it->second == AssetState::Pending || it->second == AssetState::Loaded)
+    {
+        m_released.insert(handle);
+        return;
+    }
+
+    m_states.erase(it);
+    m_errors.erase(handle);
+}
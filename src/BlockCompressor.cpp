@@ -0,0 +1,678 @@
+#include "BlockCompressor.h"
+#include "JobSystem.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace BlockCompressor
+{
+    namespace
+    {
+        // 16 pixels of a block, row by row: as bytes and as float 0..255
+        struct Block
+        {
+            XMFLOAT4A pixels[16];
+            uint8_t bytes[16][4];
+        };
+
+        void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, Block& block)
+        {
+            for (uint32_t y = 0; y < 4; ++y) {
+                const uint32_t sy = (std::min)(by * 4 + y, height - 1);
+                for (uint32_t x = 0; x < 4; ++x) {
+                    const uint32_t sx = (std::min)(bx * 4 + x, width - 1);
+                    const uint8_t* p = rgba + (size_t(sy) * width + sx) * 4;
+                    const uint32_t i = y * 4 + x;
+                    std::memcpy(block.bytes[i], p, 4);
+                    XMStoreFloat4A(&block.pixels[i], XMVectorSet(p[0], p[1], p[2], p[3]));
+                }
+            }
+        }
+
+        XMVECTOR Mean(const Block& block, XMVECTOR mask)
+        {
+            XMVECTOR sum = XMVectorZero();
+            for (const XMFLOAT4A& p : block.pixels)
+                sum = XMVectorAdd(sum, XMLoadFloat4A(&p));
+            return XMVectorMultiply(XMVectorScale(sum, 1.0f / 16.0f), mask);
+        }
+
+        // Principal axis of the covariance (power method), length 1; zero for a solid block
+        XMVECTOR PrincipalAxis(const Block& block, XMVECTOR mean, XMVECTOR mask)
+        {
+            XMVECTOR rows[4] = { XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero() };
+            for (const XMFLOAT4A& p : block.pixels) {
+                const XMVECTOR d = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&p), mean), mask);
+                rows[0] = XMVectorMultiplyAdd(d, XMVectorSplatX(d), rows[0]);
+                rows[1] = XMVectorMultiplyAdd(d, XMVectorSplatY(d), rows[1]);
+                rows[2] = XMVectorMultiplyAdd(d, XMVectorSplatZ(d), rows[2]);
+                rows[3] = XMVectorMultiplyAdd(d, XMVectorSplatW(d), rows[3]);
+            }
+
+            // Start with the longest row: it surely has a component along the principal axis
+            XMVECTOR axis = rows[0];
+            float longest = XMVectorGetX(XMVector4Dot(rows[0], rows[0]));
+            for (int i = 1; i < 4; ++i) {
+                const float length = XMVectorGetX(XMVector4Dot(rows[i], rows[i]));
+                if (length > longest) {
+                    longest = length;
+                    axis = rows[i];
+                }
+            }
+
+            for (int iteration = 0; iteration < 8; ++iteration) {
+                const float length = XMVectorGetX(XMVector4Dot(axis, axis));
+                if (length < 1e-12f)
+                    return XMVectorZero();
+                axis = XMVectorScale(axis, 1.0f / std::sqrt(length));
+                axis = XMVectorMultiplyAdd(rows[0], XMVectorSplatX(axis),
+                    XMVectorMultiplyAdd(rows[1], XMVectorSplatY(axis),
+                    XMVectorMultiplyAdd(rows[2], XMVectorSplatZ(axis), XMVectorMultiply(rows[3], XMVectorSplatW(axis)))));
+            }
+
+            const float length = XMVectorGetX(XMVector4Dot(axis, axis));
+            return length < 1e-12f ? XMVectorZero() : XMVectorScale(axis, 1.0f / std::sqrt(length));
+        }
+
+        // Endpoints at the outermost projections onto the axis
+        void AxisEndpoints(const Block& block, XMVECTOR mean, XMVECTOR axis, XMVECTOR mask, XMVECTOR& high, XMVECTOR& low)
+        {
+            float minimum = FLT_MAX, maximum = -FLT_MAX;
+            for (const XMFLOAT4A& p : block.pixels) {
+                const float t = XMVectorGetX(XMVector4Dot(XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&p), mean), mask), axis));
+                minimum = (std::min)(minimum, t);
+                maximum = (std::max)(maximum, t);
+            }
+            high = XMVectorMultiplyAdd(axis, XMVectorReplicate(maximum), mean);
+            low = XMVectorMultiplyAdd(axis, XMVectorReplicate(minimum), mean);
+        }
+
+        // Least squares: e0 * a + e1 * (1 - a) should hit the pixels (a per pixel from the index).
+        // false if all pixels have the same weight
+        bool SolveEndpoints(const Block& block, const float* weights, XMVECTOR mask, XMVECTOR& e0, XMVECTOR& e1)
+        {
+            XMVECTOR sumA = XMVectorZero(), sumB = XMVectorZero();
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+            for (int i = 0; i < 16; ++i) {
+                const float a = weights[i], b = 1.0f - a;
+                const XMVECTOR p = XMLoadFloat4A(&block.pixels[i]);
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                sumA = XMVectorMultiplyAdd(p, XMVectorReplicate(a), sumA);
+                sumB = XMVectorMultiplyAdd(p, XMVectorReplicate(b), sumB);
+            }
+
+            const float det = aa * bb - ab * ab;
+            if (std::fabs(det) < 1e-6f)
+                return false;
+
+            const XMVECTOR limit = XMVectorReplicate(255.0f);
+            e0 = XMVectorScale(XMVectorSubtract(XMVectorScale(sumA, bb), XMVectorScale(sumB, ab)), 1.0f / det);
+            e1 = XMVectorScale(XMVectorSubtract(XMVectorScale(sumB, aa), XMVectorScale(sumA, ab)), 1.0f / det);
+            e0 = XMVectorMultiply(XMVectorMin(XMVectorMax(e0, XMVectorZero()), limit), mask);
+            e1 = XMVectorMultiply(XMVectorMin(XMVectorMax(e1, XMVectorZero()), limit), mask);
+            return true;
+        }
+
+        // ==================== BC1 / BC3 ====================
+
+        inline int Expand5(int v) { return (v << 3) | (v >> 2); }
+        inline int Expand6(int v) { return (v << 2) | (v >> 4); }
+
+        uint16_t Pack565(XMVECTOR color)
+        {
+            XMFLOAT4A c;
+            XMStoreFloat4A(&c, XMVectorMin(XMVectorMax(color, XMVectorZero()), XMVectorReplicate(255.0f)));
+            const int r = static_cast<int>(c.x * (31.0f / 255.0f) + 0.5f);
+            const int g = static_cast<int>(c.y * (63.0f / 255.0f) + 0.5f);
+            const int b = static_cast<int>(c.z * (31.0f / 255.0f) + 0.5f);
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        // 4-color mode: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+        void Palette565(uint16_t c0, uint16_t c1, int palette[4][3])
+        {
+            const int a[3] = { Expand5(c0 >> 11), Expand6((c0 >> 5) & 63), Expand5(c0 & 31) };
+            const int b[3] = { Expand5(c1 >> 11), Expand6((c1 >> 5) & 63), Expand5(c1 & 31) };
+            for (int c = 0; c < 3; ++c) {
+                palette[0][c] = a[c];
+                palette[1][c] = b[c];
+                palette[2][c] = (2 * a[c] + b[c]) / 3;
+                palette[3][c] = (a[c] + 2 * b[c]) / 3;
+            }
+        }
+
+        int ColorIndices(const Block& block, const int palette[4][3], uint32_t& indices)
+        {
+            int total = 0;
+            indices = 0;
+            for (int i = 0; i < 16; ++i) {
+                const uint8_t* p = block.bytes[i];
+                int best = INT_MAX, bestIndex = 0;
+                for (int k = 0; k < 4; ++k) {
+                    const int dr = p[0] - palette[k][0], dg = p[1] - palette[k][1], db = p[2] - palette[k][2];
+                    const int error = dr * dr + dg * dg + db * db;
+                    if (error < best) {
+                        best = error;
+                        bestIndex = k;
+                    }
+                }
+                total += best;
+                indices |= uint32_t(bestIndex) << (2 * i);
+            }
+            return total;
+        }
+
+        // Solid blocks: per channel the endpoint pair whose 2/3 mix (index 2) hits the value
+        // best - more accurate than a single endpoint rounded to 565
+        struct SingleColorTable
+        {
+            uint8_t match5[256][2];
+            uint8_t match6[256][2];
+
+            SingleColorTable()
+            {
+                Build(match5, 31, Expand5);
+                Build(match6, 63, Expand6);
+            }
+
+            static void Build(uint8_t table[256][2], int maxValue, int (*expand)(int))
+            {
+                for (int v = 0; v < 256; ++v) {
+                    int best = INT_MAX;
+                    for (int a = 0; a <= maxValue; ++a)
+                        for (int b = 0; b <= maxValue; ++b) {
+                            const int error = std::abs((2 * expand(a) + expand(b)) / 3 - v) * 256 + std::abs(a - b);
+                            if (error < best) {
+                                best = error;
+                                table[v][0] = static_cast<uint8_t>(a);
+                                table[v][1] = static_cast<uint8_t>(b);
+                            }
+                        }
+                }
+            }
+        };
+
+        const SingleColorTable& SingleColor()
+        {
+            static const SingleColorTable table;
+            return table;
+        }
+
+        void WriteColorBlock(uint16_t c0, uint16_t c1, uint32_t indices, uint8_t* out)
+        {
+            // c0 > c1 = 4-color mode (for BC1 otherwise 3 colors + transparent)
+            if (c0 < c1) {
+                std::swap(c0, c1);
+                indices ^= 0x55555555u;     // 0 <-> 1, 2 <-> 3
+            }
+            else if (c0 == c1) {
+                indices = 0;
+            }
+            out[0] = static_cast<uint8_t>(c0);
+            out[1] = static_cast<uint8_t>(c0 >> 8);
+            out[2] = static_cast<uint8_t>(c1);
+            out[3] = static_cast<uint8_t>(c1 >> 8);
+            for (int i = 0; i < 4; ++i)
+                out[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+        }
+
+        void EncodeColorBlock(const Block& block, uint8_t* out)
+        {
+            bool flat = true;
+            for (int i = 1; i < 16 && flat; ++i)
+                flat = std::memcmp(block.bytes[i], block.bytes[0], 3) == 0;
+
+            if (flat) {
+                const SingleColorTable& table = SingleColor();
+                const uint8_t* p = block.bytes[0];
+                const uint16_t c0 = static_cast<uint16_t>((table.match5[p[0]][0] << 11) | (table.match6[p[1]][0] << 5) | table.match5[p[2]][0]);
+                const uint16_t c1 = static_cast<uint16_t>((table.match5[p[0]][1] << 11) | (table.match6[p[1]][1] << 5) | table.match5[p[2]][1]);
+                WriteColorBlock(c0, c1, 0xAAAAAAAAu, out);     // all index 2
+                return;
+            }
+
+            const XMVECTOR mask = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+            const XMVECTOR mean = Mean(block, mask);
+            XMVECTOR e0, e1;
+            AxisEndpoints(block, mean, PrincipalAxis(block, mean, mask), mask, e0, e1);
+
+            static const float WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+            uint16_t bestC0 = 0, bestC1 = 0;
+            uint32_t bestIndices = 0;
+            int bestError = INT_MAX;
+
+            for (int iteration = 0; iteration < 3; ++iteration) {
+                const uint16_t c0 = Pack565(e0), c1 = Pack565(e1);
+                int palette[4][3];
+                Palette565(c0, c1, palette);
+                uint32_t indices;
+                const int error = ColorIndices(block, palette, indices);
+                if (error < bestError) {
+                    bestError = error;
+                    bestC0 = c0;
+                    bestC1 = c1;
+                    bestIndices = indices;
+                }
+                if (iteration == 2 || error == 0)
+                    break;
+
+                float weights[16];
+                for (int i = 0; i < 16; ++i)
+                    weights[i] = WEIGHTS[(indices >> (2 * i)) & 3];
+                if (!SolveEndpoints(block, weights, mask, e0, e1))
+                    break;
+            }
+
+            WriteColorBlock(bestC0, bestC1, bestIndices, out);
+        }
+
+        // Alpha like BC4: 8 levels between max and min, or 6 levels plus 0 and 255
+        void EncodeAlphaBlock(const Block& block, uint8_t* out)
+        {
+            int minimum = 255, maximum = 0;
+            int inner0 = 255, inner1 = 0;       // without 0 and 255
+            bool extremes = false;
+            for (int i = 0; i < 16; ++i) {
+                const int a = block.bytes[i][3];
+                minimum = (std::min)(minimum, a);
+                maximum = (std::max)(maximum, a);
+                if (a == 0 || a == 255) {
+                    extremes = true;
+                }
+                else {
+                    inner0 = (std::min)(inner0, a);
+                    inner1 = (std::max)(inner1, a);
+                }
+            }
+
+            std::memset(out, 0, 8);
+            if (minimum == maximum) {
+                out[0] = out[1] = static_cast<uint8_t>(minimum);
+                return;
+            }
+
+            auto fit = [&](const int* palette, uint64_t& bits) {
+                int total = 0;
+                bits = 0;
+                for (int i = 0; i < 16; ++i) {
+                    const int a = block.bytes[i][3];
+                    int best = INT_MAX, bestIndex = 0;
+                    for (int k = 0; k < 8; ++k) {
+                        const int error = std::abs(a - palette[k]);
+                        if (error < best) {
+                            best = error;
+                            bestIndex = k;
+                        }
+                    }
+                    total += best * best;
+                    bits |= uint64_t(bestIndex) << (3 * i);
+                }
+                return total;
+            };
+
+            int palette[8];
+            int a0 = maximum, a1 = minimum;
+            palette[0] = a0;
+            palette[1] = a1;
+            for (int k = 2; k < 8; ++k)
+                palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+            uint64_t bits;
+            int error = fit(palette, bits);
+
+            // a0 <= a1: 6 levels, index 6 = 0, index 7 = 255 - better for cutout edges
+            if (extremes && inner0 <= inner1) {
+                int palette6[8];
+                palette6[0] = inner0;
+                palette6[1] = inner1;
+                for (int k = 2; k < 6; ++k)
+                    palette6[k] = ((6 - k) * inner0 + (k - 1) * inner1) / 5;
+                palette6[6] = 0;
+                palette6[7] = 255;
+                uint64_t bits6;
+                const int error6 = fit(palette6, bits6);
+                if (error6 < error) {
+                    a0 = inner0;
+                    a1 = inner1;
+                    bits = bits6;
+                    error = error6;
+                }
+            }
+
+            out[0] = static_cast<uint8_t>(a0);
+            out[1] = static_cast<uint8_t>(a1);
+            for (int i = 0; i < 6; ++i)
+                out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+
+        // ==================== BC7 (MODE 6) ====================
+
+        const int WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct Endpoint
+        {
+            int value[4];       // 8 Bit = 7 Bit << 1 | p
+            int p;
+        };
+
+        // Try both p-bits, the one with the smaller error wins
+        Endpoint QuantizeEndpoint(XMVECTOR e)
+        {
+            XMFLOAT4A f;
+            XMStoreFloat4A(&f, XMVectorMin(XMVectorMax(e, XMVectorZero()), XMVectorReplicate(255.0f)));
+            const float channels[4] = { f.x, f.y, f.z, f.w };
+
+            Endpoint best = {};
+            float bestError = FLT_MAX;
+            for (int p = 0; p < 2; ++p) {
+                Endpoint candidate = {};
+                candidate.p = p;
+                float error = 0.0f;
+                for (int c = 0; c < 4; ++c) {
+                    const int q = (std::min)(127, (std::max)(0, static_cast<int>(std::floor((channels[c] - p) * 0.5f + 0.5f))));
+                    candidate.value[c] = (q << 1) | p;
+                    error += (candidate.value[c] - channels[c]) * (candidate.value[c] - channels[c]);
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = candidate;
+                }
+            }
+            return best;
+        }
+
+        int Mode6Indices(const Block& block, const Endpoint& e0, const Endpoint& e1, uint8_t indices[16])
+        {
+            int palette[16][4];
+            for (int k = 0; k < 16; ++k)
+                for (int c = 0; c < 4; ++c)
+                    palette[k][c] = (e0.value[c] * (64 - WEIGHTS4[k]) + e1.value[c] * WEIGHTS4[k] + 32) >> 6;
+
+            int direction[4], length = 0;
+            for (int c = 0; c < 4; ++c) {
+                direction[c] = e1.value[c] - e0.value[c];
+                length += direction[c] * direction[c];
+            }
+
+            int total = 0;
+            for (int i = 0; i < 16; ++i) {
+                const uint8_t* p = block.bytes[i];
+
+                // The projection onto the line estimates the index, the neighbors are checked too
+                int guess = 0;
+                if (length > 0) {
+                    int dot = 0;
+                    for (int c = 0; c < 4; ++c)
+                        dot += (p[c] - e0.value[c]) * direction[c];
+                    guess = (std::min)(15, (std::max)(0, static_cast<int>(std::floor(dot * 15.0f / length + 0.5f))));
+                }
+
+                int best = INT_MAX, bestIndex = guess;
+                for (int k = (std::max)(0, guess - 1); k <= (std::min)(15, guess + 1); ++k) {
+                    int error = 0;
+                    for (int c = 0; c < 4; ++c)
+                        error += (p[c] - palette[k][c]) * (p[c] - palette[k][c]);
+                    if (error < best) {
+                        best = error;
+                        bestIndex = k;
+                    }
+                }
+                indices[i] = static_cast<uint8_t>(bestIndex);
+                total += best;
+            }
+            return total;
+        }
+
+        struct BitWriter
+        {
+            uint8_t* out;
+            uint32_t position;
+
+            void Write(uint32_t value, uint32_t bits)
+            {
+                for (uint32_t i = 0; i < bits; ++i, ++position)
+                    out[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (position & 7));
+            }
+        };
+
+        struct BitReader
+        {
+            const uint8_t* in;
+            uint32_t position;
+
+            uint32_t Read(uint32_t bits)
+            {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < bits; ++i, ++position)
+                    value |= uint32_t((in[position >> 3] >> (position & 7)) & 1) << i;
+                return value;
+            }
+        };
+
+        void EncodeBC7Block(const Block& block, uint8_t* out)
+        {
+            const XMVECTOR mask = XMVectorSplatOne();
+            const XMVECTOR mean = Mean(block, mask);
+            XMVECTOR high, low;
+            AxisEndpoints(block, mean, PrincipalAxis(block, mean, mask), mask, high, low);
+
+            Endpoint best0 = {}, best1 = {};
+            uint8_t bestIndices[16] = {};
+            int bestError = INT_MAX;
+
+            for (int iteration = 0; iteration < 3; ++iteration) {
+                const Endpoint e0 = QuantizeEndpoint(low), e1 = QuantizeEndpoint(high);
+                uint8_t indices[16];
+                const int error = Mode6Indices(block, e0, e1, indices);
+                if (error < bestError) {
+                    bestError = error;
+                    best0 = e0;
+                    best1 = e1;
+                    std::memcpy(bestIndices, indices, 16);
+                }
+                if (iteration == 2 || error == 0)
+                    break;
+
+                float weights[16];
+                for (int i = 0; i < 16; ++i)
+                    weights[i] = (64 - WEIGHTS4[indices[i]]) / 64.0f;
+                if (!SolveEndpoints(block, weights, mask, low, high))
+                    break;
+            }
+
+            // The anchor index (pixel 0) is stored with 3 bits: the top bit must be 0
+            if (bestIndices[0] & 8) {
+                std::swap(best0, best1);
+                for (uint8_t& index : bestIndices)
+                    index = static_cast<uint8_t>(15 - index);
+            }
+
+            std::memset(out, 0, 16);
+            BitWriter writer = { out, 0 };
+            writer.Write(1u << 6, 7);
+            for (int c = 0; c < 4; ++c) {
+                writer.Write(uint32_t(best0.value[c] >> 1), 7);
+                writer.Write(uint32_t(best1.value[c] >> 1), 7);
+            }
+            writer.Write(uint32_t(best0.p), 1);
+            writer.Write(uint32_t(best1.p), 1);
+            writer.Write(bestIndices[0], 3);
+            for (int i = 1; i < 16; ++i)
+                writer.Write(bestIndices[i], 4);
+        }
+
+        // ==================== DECODING ====================
+
+        void DecodeColorBlock(const uint8_t* in, bool allowTransparent, uint8_t pixels[16][4])
+        {
+            const uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+            const uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+            const uint32_t indices = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+
+            int palette[4][4];
+            int rgb[4][3];
+            Palette565(c0, c1, rgb);
+            for (int k = 0; k < 4; ++k) {
+                for (int c = 0; c < 3; ++c)
+                    palette[k][c] = rgb[k][c];
+                palette[k][3] = 255;
+            }
+            if (allowTransparent && c0 <= c1) {
+                for (int c = 0; c < 3; ++c) {
+                    palette[2][c] = (rgb[0][c] + rgb[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+                palette[3][3] = 0;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                const int* color = palette[(indices >> (2 * i)) & 3];
+                for (int c = 0; c < 4; ++c)
+                    pixels[i][c] = static_cast<uint8_t>(color[c]);
+            }
+        }
+
+        void DecodeAlphaBlock(const uint8_t* in, uint8_t pixels[16][4])
+        {
+            const int a0 = in[0], a1 = in[1];
+            int palette[8] = { a0, a1 };
+            if (a0 > a1) {
+                for (int k = 2; k < 8; ++k)
+                    palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+            }
+            else {
+                for (int k = 2; k < 6; ++k)
+                    palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            uint64_t bits = 0;
+            for (int i = 0; i < 6; ++i)
+                bits |= uint64_t(in[2 + i]) << (8 * i);
+            for (int i = 0; i < 16; ++i)
+                pixels[i][3] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+        }
+
+        void DecodeBC7Block(const uint8_t* in, uint8_t pixels[16][4])
+        {
+            std::memset(pixels, 0, 64);
+            // Mode = number of zero bits before the first 1
+            if ((in[0] & 0x7F) != (1u << 6))
+                return;
+
+            BitReader reader = { in, 7 };
+            int e[2][4];
+            for (int c = 0; c < 4; ++c) {
+                e[0][c] = int(reader.Read(7)) << 1;
+                e[1][c] = int(reader.Read(7)) << 1;
+            }
+            const int p0 = int(reader.Read(1)), p1 = int(reader.Read(1));
+            for (int c = 0; c < 4; ++c) {
+                e[0][c] |= p0;
+                e[1][c] |= p1;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                const int w = WEIGHTS4[reader.Read(i == 0 ? 3 : 4)];
+                for (int c = 0; c < 4; ++c)
+                    pixels[i][c] = static_cast<uint8_t>((e[0][c] * (64 - w) + e[1][c] * w + 32) >> 6);
+            }
+        }
+    }
+
+    size_t BlockBytes(Format format)
+    {
+        return format == Format::BC1 ? 8 : 16;
+    }
+
+    size_t RowPitch(Format format, uint32_t width)
+    {
+        return (std::max)(1u, (width + 3) / 4) * BlockBytes(format);
+    }
+
+    size_t CompressedSize(Format format, uint32_t width, uint32_t height)
+    {
+        return RowPitch(format, width) * (std::max)(1u, (height + 3) / 4);
+    }
+
+    void Compress(const uint8_t* rgba, uint32_t width, uint32_t height, Format format, uint8_t* out, JobSystem* jobs)
+    {
+        if (!rgba || !out || width == 0 || height == 0)
+            return;
+
+        const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        const size_t blockBytes = BlockBytes(format);
+
+        auto rows = [&](size_t begin, size_t end) {
+            Block block;
+            for (size_t by = begin; by < end; ++by) {
+                uint8_t* dst = out + by * blocksX * blockBytes;
+                for (uint32_t bx = 0; bx < blocksX; ++bx, dst += blockBytes) {
+                    LoadBlock(rgba, width, height, bx, static_cast<uint32_t>(by), block);
+                    switch (format) {
+                    case Format::BC1:
+                        EncodeColorBlock(block, dst);
+                        break;
+                    case Format::BC3:
+                        EncodeAlphaBlock(block, dst);
+                        EncodeColorBlock(block, dst + 8);
+                        break;
+                    case Format::BC7:
+                        EncodeBC7Block(block, dst);
+                        break;
+                    }
+                }
+            }
+        };
+
+        // A block costs a few microseconds: from about 64 blocks per job it pays off
+        const size_t grain = (std::max)(size_t(1), size_t(64) / blocksX);
+        if (jobs)
+            jobs->ParallelFor(blocksY, grain, rows);
+        else
+            rows(0, blocksY);
+    }
+
+    void Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, Format format, uint8_t* rgba)
+    {
+        const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        const size_t blockBytes = BlockBytes(format);
+
+        uint8_t pixels[16][4];
+        for (uint32_t by = 0; by < blocksY; ++by)
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                const uint8_t* in = blocks + (size_t(by) * blocksX + bx) * blockBytes;
+                switch (format) {
+                case Format::BC1:
+                    DecodeColorBlock(in, true, pixels);
+                    break;
+                case Format::BC3:
+                    DecodeColorBlock(in + 8, false, pixels);
+                    DecodeAlphaBlock(in, pixels);
+                    break;
+                case Format::BC7:
+                    DecodeBC7Block(in, pixels);
+                    break;
+                }
+
+                for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                    for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                        std::memcpy(rgba + ((size_t(by) * 4 + y) * width + bx * 4 + x) * 4, pixels[y * 4 + x], 4);
+            }
+    }
+
+    bool IsOpaque(const uint8_t* rgba, size_t pixelCount)
+    {
+        for (size_t i = 0; i < pixelCount; ++i)
+            if (rgba[i * 4 + 3] != 255)
+                return false;
+        return true;
+    }
+}
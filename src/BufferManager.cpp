@@ -4,12 +4,11 @@
 // InputLayoutManager creates an input layout based on the specified flags and the shader object
 // and returns the HRESULT value to indicate the success or failure of the operation.
 
-BufferManager::BufferManager() : m_device(nullptr), m_context(nullptr) {}
+BufferManager::BufferManager() : m_device(nullptr) {}
 
-void BufferManager::Init(ID3D11Device* device, ID3D11DeviceContext* context)
+void BufferManager::Init(const GDXDevice* device)
 {
     m_device = device;
-    m_context = context;
 }
 
 HRESULT BufferManager::CreateBuffer(const void* data, UINT size, UINT count, D3D11_BIND_FLAG bindFlags, ID3D11Buffer** buffer)
@@ -41,20 +40,20 @@ void BufferManager::UpdateBuffer(ID3D11Buffer* buffer, const void* data, UINT da
         return;
     }
 
-    m_context->UpdateSubresource(buffer, 0, nullptr, data, dataSize, 0);
+    m_device->UpdateSubresource(buffer, data, dataSize);
 }
 
 HRESULT BufferManager::UpdateConstantBuffer(ID3D11Buffer* buffer, const void* data, UINT dataSize)
 {
     // Call this Function, when bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE and bufferDesc.Usage = D3D11_USAGE_DYNAMIC
     D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = m_context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    HRESULT hr = m_device->Map(buffer, D3D11_MAP_WRITE_DISCARD, &mappedResource);
     if (FAILED(hr)) {
         return hr; // gibt echten Fehler zurck
     }
     
     memcpy(mappedResource.pData, data, dataSize);
-    m_context->Unmap(buffer, 0);
+    m_device->Unmap(buffer);
 
     return hr;
 }
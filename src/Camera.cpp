@@ -1,7 +1,7 @@
 #include "Camera.h"
 using namespace DirectX;
 
-Camera::Camera() : Entity()
+Camera::Camera(TransformSystem& transformSystem) : Entity(transformSystem)
 {
     // Matrizen werden in Entity::Entity() initialisiert
 }
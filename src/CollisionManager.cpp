@@ -0,0 +1,425 @@
+#include "CollisionManager.h"
+#include "AABBTree.h"
+#include "JobSystem.h"
+#include "TriangleBVH.h"
+#include <algorithm>
+#include <functional>
+
+using namespace DirectX;
+
+// Proxies per ParallelFor block (sweep + narrowphase)
+static constexpr size_t SWEEP_GRAIN = 256;
+// Rays per ParallelFor block, a multiple of 4: no packet straddles a block boundary
+static constexpr size_t RAY_GRAIN = 64;
+
+const std::vector<CollisionPair>& CollisionManager::CollideAll(const std::vector<Mesh*>& meshes)
+{
+    GatherColliders(meshes);
+    UpdateProxies();
+    SortProxies();
+
+    const size_t count = m_proxies.size();
+    m_blocks.resize((count + SWEEP_GRAIN - 1) / SWEEP_GRAIN);
+    for (Block& block : m_blocks)
+    {
+        block.pairs.clear();
+        block.candidates = 0;
+    }
+
+    // Every block writes only into its own list
+    auto sweep = [this](size_t begin, size_t end)
+        {
+            Sweep(begin, end, m_blocks[begin / SWEEP_GRAIN]);
+        };
+
+    if (m_jobs)
+        m_jobs->ParallelFor(count, SWEEP_GRAIN, sweep);
+    else
+        sweep(0, count);
+
+    m_pairs.clear();
+    m_stats.candidates = 0;
+    for (const Block& block : m_blocks)
+    {
+        m_pairs.insert(m_pairs.end(), block.pairs.begin(), block.pairs.end());
+        m_stats.candidates += block.candidates;
+    }
+
+    m_stats.colliders = m_colliders.size();
+    m_stats.pairs = m_pairs.size();
+    return m_pairs;
+}
+
+void CollisionManager::GatherColliders(const std::vector<Mesh*>& meshes)
+{
+    m_colliders.clear();
+    for (Mesh* mesh : meshes)
+    {
+        if (mesh && mesh->GetCollisionMode() != COLLISION::NONE)
+            m_colliders.push_back(mesh);
+    }
+
+    // New or deleted colliders: recreate the proxies. With the same count the old
+    // order stays, even if an index now refers to a different mesh -
+    // SortProxies() restores the ordering in any case.
+    if (m_proxies.size() != m_colliders.size())
+    {
+        m_proxies.resize(m_colliders.size());
+        for (size_t i = 0; i < m_proxies.size(); ++i)
+            m_proxies[i].collider = static_cast<uint32_t>(i);
+    }
+}
+
+void CollisionManager::UpdateProxies()
+{
+    // World AABB from the meshes' bounds cache, no matrix math
+    auto update = [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                Proxy& proxy = m_proxies[i];
+                const BoundingBox& box = m_colliders[proxy.collider]->aabb;
+                proxy.minX = box.Center.x - box.Extents.x;
+                proxy.maxX = box.Center.x + box.Extents.x;
+                proxy.minY = box.Center.y - box.Extents.y;
+                proxy.maxY = box.Center.y + box.Extents.y;
+                proxy.minZ = box.Center.z - box.Extents.z;
+                proxy.maxZ = box.Center.z + box.Extents.z;
+            }
+        };
+
+    if (m_jobs)
+        m_jobs->ParallelFor(m_proxies.size(), 1024, update);
+    else
+        update(0, m_proxies.size());
+}
+
+void CollisionManager::SortProxies()
+{
+    // Insertion sort on the last frame's order: with coherent motion every
+    // proxy moves only a few places. Too many shifts (new scene,
+    // teleports) -> std::sort, so the worst case does not become O(N²).
+    const size_t count = m_proxies.size();
+    const size_t limit = count * 8 + 64;
+    size_t shifts = 0;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        const Proxy proxy = m_proxies[i];
+        size_t j = i;
+        while (j > 0 && m_proxies[j - 1].minX > proxy.minX)
+        {
+            m_proxies[j] = m_proxies[j - 1];
+            --j;
+        }
+        m_proxies[j] = proxy;
+
+        shifts += i - j;
+        if (shifts > limit)
+        {
+            std::sort(m_proxies.begin(), m_proxies.end(),
+                [](const Proxy& a, const Proxy& b) { return a.minX < b.minX; });
+            break;
+        }
+    }
+
+    m_stats.sortShifts = shifts;
+}
+
+void CollisionManager::Sweep(size_t begin, size_t end, Block& block) const
+{
+    const size_t count = m_proxies.size();
+    const Proxy* proxies = m_proxies.data();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const Proxy& p = proxies[i];
+
+        // Sorted by minX: once a minX lies beyond p.maxX, nothing overlaps anymore
+        for (size_t j = i + 1; j < count && proxies[j].minX <= p.maxX; ++j)
+        {
+            const Proxy& q = proxies[j];
+            if (q.maxY < p.minY || q.minY > p.maxY || q.maxZ < p.minZ || q.minZ > p.maxZ)
+                continue;
+
+            ++block.candidates;
+
+            const uint32_t first = (std::min)(p.collider, q.collider);
+            const uint32_t second = (std::max)(p.collider, q.collider);
+            Mesh* a = m_colliders[first];
+            Mesh* b = m_colliders[second];
+            if (a->obb.Intersects(b->obb))
+                block.pairs.push_back({ a, b });
+        }
+    }
+}
+
+bool CollisionManager::Raycast(const AABBTree& scene, const Ray& ray, RaycastHit& hit, bool anyHit)
+{
+    return RaycastBatch(scene, &ray, 1, &hit, anyHit) == 1;
+}
+
+size_t CollisionManager::RaycastBatch(const AABBTree& scene, const Ray* rays, size_t count, RaycastHit* hits, bool anyHit)
+{
+    m_rayStats = RaycastStats();
+    if (rays == nullptr || hits == nullptr || count == 0)
+        return 0;
+
+    // Normalized direction: distances count in world units, in local space too
+    m_rays.assign(rays, rays + count);
+    for (Ray& ray : m_rays)
+    {
+        const XMVECTOR direction = XMLoadFloat3(&ray.direction);
+        const float length = XMVectorGetX(XMVector3Length(direction));
+        if (length > 0.0f)
+            XMStoreFloat3(&ray.direction, XMVectorScale(direction, 1.0f / length));
+        else
+            ray.maxDistance = -1.0f;    // no direction: hits nothing
+    }
+
+    m_rayRanges.resize(count);
+    m_rayBlocks.resize((count + RAY_GRAIN - 1) / RAY_GRAIN);
+    for (RayBlock& block : m_rayBlocks)
+    {
+        block.candidates.clear();
+        block.stats = RaycastStats();
+    }
+
+    // Both passes split the same way: block b reads its own candidates in TraceRays
+    const bool parallel = m_jobs != nullptr && count > RAY_GRAIN;
+
+    auto gather = [this, &scene](size_t begin, size_t end)
+        {
+            GatherRayCandidates(scene, m_rays.data(), begin, end, m_rayBlocks[begin / RAY_GRAIN]);
+        };
+
+    if (parallel)
+        m_jobs->ParallelFor(count, RAY_GRAIN, gather);
+    else
+        gather(0, count);
+
+    // Update the candidates' triangle BVHs and world matrices here, TraceRays only reads
+    for (const RayBlock& block : m_rayBlocks)
+    {
+        for (const RayCandidate& candidate : block.candidates)
+        {
+            candidate.mesh->transform.GetWorldMatrix();
+            for (Surface* surface : candidate.mesh->surfaces)
+            {
+                if (surface)
+                    surface->GetTriangleBVH();
+            }
+        }
+    }
+
+    auto trace = [this, hits, anyHit](size_t begin, size_t end)
+        {
+            TraceRays(m_rays.data(), begin, end, hits, anyHit, m_rayBlocks[begin / RAY_GRAIN]);
+        };
+
+    if (parallel)
+        m_jobs->ParallelFor(count, RAY_GRAIN, trace);
+    else
+        trace(0, count);
+
+    m_rayStats.rays = count;
+    for (const RayBlock& block : m_rayBlocks)
+    {
+        m_rayStats.meshTests += block.stats.meshTests;
+        m_rayStats.packetTests += block.stats.packetTests;
+        m_rayStats.hits += block.stats.hits;
+    }
+    return m_rayStats.hits;
+}
+
+void CollisionManager::GatherRayCandidates(const AABBTree& tree, const Ray* rays, size_t begin, size_t end, RayBlock& block)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        const Ray& ray = rays[i];
+        const uint32_t first = static_cast<uint32_t>(block.candidates.size());
+
+        if (ray.maxDistance >= 0.0f)
+        {
+            const XMVECTOR origin = XMLoadFloat3(&ray.origin);
+            const XMVECTOR direction = XMLoadFloat3(&ray.direction);
+
+            // The scene tree returns fat AABBs, the slab test against Mesh::aabb is exact
+            tree.QueryRay(ray.origin, ray.direction, ray.maxDistance, [&](uint32_t proxy)
+                {
+                    Mesh* mesh = static_cast<Mesh*>(tree.GetUserData(proxy));
+                    if (!mesh->IsActive() || mesh->surfaces.empty() || mesh == ray.ignore[0] || mesh == ray.ignore[1])
+                        return;
+
+                    float tNear = 0.0f;
+                    if (!mesh->aabb.Intersects(origin, direction, tNear) || tNear > ray.maxDistance)
+                        return;
+
+                    block.candidates.push_back({ mesh, tNear, 0 });
+                });
+
+            // Closest mesh first: TracePacket stops as soon as a hit lies in front
+            std::sort(block.candidates.begin() + first, block.candidates.end(),
+                [](const RayCandidate& a, const RayCandidate& b) { return a.tNear < b.tNear; });
+        }
+
+        m_rayRanges[i] = { first, static_cast<uint32_t>(block.candidates.size()) };
+    }
+}
+
+void CollisionManager::TraceRays(const Ray* rays, size_t begin, size_t end, RaycastHit* hits, bool anyHit, RayBlock& block) const
+{
+    for (size_t first = begin; first < end; first += 4)
+        TracePacket(rays, first, static_cast<uint32_t>((std::min)(end - first, size_t(4))), hits, anyHit, block);
+}
+
+void CollisionManager::TracePacket(const Ray* rays, size_t first, uint32_t laneCount, RaycastHit* hits, bool anyHit, RayBlock& block) const
+{
+    // Group the candidates of all lanes by mesh: a mesh hit by several rays
+    // of the packet is tested once with Intersect4
+    block.scratch.clear();
+    for (uint32_t lane = 0; lane < laneCount; ++lane)
+    {
+        hits[first + lane] = RaycastHit();
+        const RayRange range = m_rayRanges[first + lane];
+        for (uint32_t i = range.begin; i < range.end; ++i)
+        {
+            RayCandidate candidate = block.candidates[i];
+            candidate.lane = lane;
+            block.scratch.push_back(candidate);
+        }
+    }
+
+    std::sort(block.scratch.begin(), block.scratch.end(),
+        [](const RayCandidate& a, const RayCandidate& b) { return std::less<Mesh*>()(a.mesh, b.mesh); });
+
+    block.meshes.clear();
+    for (const RayCandidate& candidate : block.scratch)
+    {
+        if (block.meshes.empty() || block.meshes.back().mesh != candidate.mesh)
+            block.meshes.push_back({ candidate.mesh, { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX }, FLT_MAX, 0u });
+
+        PacketMesh& entry = block.meshes.back();
+        entry.tNear[candidate.lane] = candidate.tNear;
+        entry.minNear = (std::min)(entry.minNear, candidate.tNear);
+        entry.lanes |= 1u << candidate.lane;
+    }
+
+    std::sort(block.meshes.begin(), block.meshes.end(),
+        [](const PacketMesh& a, const PacketMesh& b) { return a.minNear < b.minNear; });
+
+    float best[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+    for (uint32_t lane = 0; lane < laneCount; ++lane)
+        best[lane] = rays[first + lane].maxDistance;
+    uint32_t done = 0;      // anyHit: lanes with a hit
+
+    for (const PacketMesh& entry : block.meshes)
+    {
+        // Lanes whose best hit lies in front of the mesh's AABB are done here
+        uint32_t lanes = 0;
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if ((entry.lanes & (1u << lane)) && !(done & (1u << lane)) && entry.tNear[lane] <= best[lane])
+                lanes |= 1u << lane;
+        }
+        if (lanes == 0)
+            continue;
+
+        XMVECTOR determinant;
+        const XMMATRIX inverse = XMMatrixInverse(&determinant, entry.mesh->transform.GetWorldMatrix());
+        if (XMVectorGetX(determinant) == 0.0f)
+            continue;
+
+        // Do not normalize the direction after the transform: t stays in world units
+        XMFLOAT3 localOrigin[4], localDirection[4];
+        uint32_t firstLane = 4;
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if (!(lanes & (1u << lane)))
+                continue;
+            const Ray& ray = rays[first + lane];
+            XMStoreFloat3(&localOrigin[lane], XMVector3TransformCoord(XMLoadFloat3(&ray.origin), inverse));
+            XMStoreFloat3(&localDirection[lane], XMVector3TransformNormal(XMLoadFloat3(&ray.direction), inverse));
+            firstLane = (std::min)(firstLane, lane);
+        }
+
+        const bool packetTest = (lanes & (lanes - 1)) != 0;
+        RayPacket packet;
+        if (packetTest)
+        {
+            // Inactive lanes get a valid ray, Intersect4 masks them out
+            for (uint32_t lane = 0; lane < 4; ++lane)
+            {
+                const uint32_t source = (lanes & (1u << lane)) ? lane : firstLane;
+                packet.Set(static_cast<int>(lane), localOrigin[source], localDirection[source]);
+            }
+            ++block.stats.packetTests;
+        }
+
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+            block.stats.meshTests += (lanes >> lane) & 1u;
+
+        for (Surface* surface : entry.mesh->surfaces)
+        {
+            const TriangleBVH* bvh = surface ? surface->GetCachedTriangleBVH() : nullptr;
+            const uint32_t active = lanes & ~done;
+            if (bvh == nullptr || active == 0)
+                continue;
+
+            TriangleHit triangleHits[4];
+            uint32_t hitLanes = 0;
+            if (packetTest)
+            {
+                for (uint32_t lane = 0; lane < 4; ++lane)
+                    triangleHits[lane].distance = best[lane];
+                hitLanes = bvh->Intersect4(packet, triangleHits, active, anyHit);
+            }
+            else
+            {
+                triangleHits[firstLane].distance = best[firstLane];
+                if (bvh->Intersect(localOrigin[firstLane], localDirection[firstLane], triangleHits[firstLane], anyHit))
+                    hitLanes = 1u << firstLane;
+            }
+
+            for (uint32_t lane = 0; lane < laneCount; ++lane)
+            {
+                if (!(hitLanes & (1u << lane)))
+                    continue;
+
+                const TriangleHit& triangleHit = triangleHits[lane];
+                RaycastHit& hit = hits[first + lane];
+                hit.mesh = entry.mesh;
+                hit.surface = surface;
+                hit.triangle = triangleHit.triangle;
+                hit.distance = triangleHit.distance;
+                hit.u = triangleHit.u;
+                hit.v = triangleHit.v;
+                hit.normal = triangleHit.normal;   // local until the end of the packet
+                best[lane] = triangleHit.distance;
+                if (anyHit)
+                    done |= 1u << lane;
+            }
+        }
+    }
+
+    // Compute point and normal only for the hits
+    for (uint32_t lane = 0; lane < laneCount; ++lane)
+    {
+        RaycastHit& hit = hits[first + lane];
+        if (hit.mesh == nullptr)
+            continue;
+
+        const Ray& ray = rays[first + lane];
+        const XMVECTOR direction = XMLoadFloat3(&ray.direction);
+        XMStoreFloat3(&hit.point, XMVectorAdd(XMLoadFloat3(&ray.origin), XMVectorScale(direction, hit.distance)));
+
+        // Normal with the inverse transpose (non-uniform scale)
+        const XMMATRIX inverse = XMMatrixInverse(nullptr, hit.mesh->transform.GetWorldMatrix());
+        XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&hit.normal), XMMatrixTranspose(inverse)));
+        if (XMVectorGetX(XMVector3Dot(normal, direction)) > 0.0f)
+            normal = XMVectorNegate(normal);
+        XMStoreFloat3(&hit.normal, normal);
+
+        ++block.stats.hits;
+    }
+}
@@ -0,0 +1,106 @@
+#include "ConstantBufferRing.h"
+#include "gdxdevice.h"
+
+// D3D11: a bound range may be at most 4096 constants
+static constexpr uint32_t MAX_BIND_CONSTANTS = D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT;
+static constexpr uint32_t MIN_CAPACITY = 64 * 1024;
+
+ConstantBufferRing::ConstantBufferRing() :
+    m_buffer(nullptr),
+    m_mapped(nullptr)
+{
+}
+
+ConstantBufferRing::~ConstantBufferRing()
+{
+    Release();
+}
+
+void ConstantBufferRing::Release()
+{
+    Memory::SafeRelease(m_buffer);
+    m_mapped = nullptr;
+    m_allocator.Reset(0);
+}
+
+HRESULT ConstantBufferRing::BeginFrame(const GDXDevice* device, uint32_t requiredBytes)
+{
+    if (!device)
+        return E_INVALIDARG;
+
+    if (m_mapped)
+        EndFrame(device);
+
+    // Too small: recreate, doubling the size instead of growing exactly each time
+    if (!m_buffer || requiredBytes > m_allocator.GetCapacity())
+    {
+        uint32_t capacity = m_allocator.GetCapacity() ? m_allocator.GetCapacity() : MIN_CAPACITY;
+        while (capacity < requiredBytes)
+            capacity *= 2;
+
+        Memory::SafeRelease(m_buffer);
+
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = capacity;
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        HRESULT hr = device->CreateBuffer(&desc, nullptr, &m_buffer);
+        if (FAILED(hr))
+        {
+            Debug::LogHr(__FILE__, __LINE__, hr);
+            m_allocator.Reset(0);
+            return hr;
+        }
+
+        m_allocator.Reset(capacity);
+        Debug::Log("ConstantBufferRing.cpp: capacity ", capacity / 1024, " KB");
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    HRESULT hr = device->Map(m_buffer, D3D11_MAP_WRITE_DISCARD, &mapped);
+    if (FAILED(hr))
+    {
+        Debug::LogHr(__FILE__, __LINE__, hr);
+        return hr;
+    }
+
+    m_mapped = static_cast<unsigned char*>(mapped.pData);
+    m_allocator.Reset(m_allocator.GetCapacity());
+    return S_OK;
+}
+
+void ConstantBufferRing::EndFrame(const GDXDevice* device)
+{
+    if (!m_mapped || !device)
+        return;
+
+    device->Unmap(m_buffer);
+    m_mapped = nullptr;
+}
+
+void* ConstantBufferRing::Allocate(uint32_t size, uint32_t& firstConstant)
+{
+    if (!m_mapped)
+        return nullptr;
+
+    const uint32_t offset = m_allocator.Allocate(size);
+    if (offset == UploadRingAllocator::INVALID_OFFSET)
+        return nullptr;
+
+    firstConstant = offset / 16;
+    return m_mapped + offset;
+}
+
+void ConstantBufferRing::Bind(const GDXDevice* device, UINT slot, uint32_t firstConstant, uint32_t size) const
+{
+    // numConstants must be a multiple of 16 as well
+    UINT numConstants = UploadRingAllocator::AlignUp(size) / 16;
+    if (numConstants > MAX_BIND_CONSTANTS)
+        numConstants = MAX_BIND_CONSTANTS;
+
+    UINT first = firstConstant;
+    device->VSSetConstantBuffers1(slot, 1, &m_buffer, &first, &numConstants);
+    device->PSSetConstantBuffers1(slot, 1, &m_buffer, &first, &numConstants);
+}
@@ -0,0 +1,63 @@
+#include "CookedMeshRequest.h"
+#include "MeshLoader.h"
+#include "ObjectManager.h"
+#include "Mesh.h"
+#include "Material.h"
+#include "Shader.h"
+
+CookedMeshRequest::CookedMeshRequest(ObjectManager& objects, BufferManager& buffers, bool nullDevice,
+    Mesh* mesh, const char* path, bool findMaterial, bool keepGeometry) :
+    m_objects(objects),
+    m_buffers(buffers),
+    m_nullDevice(nullDevice),
+    m_mesh(mesh),
+    m_generation(mesh ? mesh->generation : 0),
+    m_path(path),
+    m_findMaterial(findMaterial),
+    m_keepGeometry(keepGeometry)
+{
+}
+
+bool CookedMeshRequest::Load()
+{
+    if (!m_reader.Open(m_path.c_str())) {
+        error = m_path + ": " + m_reader.GetError();
+        return false;
+    }
+
+    // Page faults here instead of in CreateBuffer on the main thread
+    const uint8_t* data = m_reader.GetData();
+    uint8_t sum = 0;
+    for (size_t i = 0; i < m_reader.GetSize(); i += 4096)
+        sum += data[i];
+    m_touched = sum;
+    return true;
+}
+
+bool CookedMeshRequest::Upload()
+{
+    if (!m_objects.IsMeshAlive(m_mesh, m_generation)) {
+        error = m_path + ": mesh was deleted before the upload";
+        return false;
+    }
+
+    // No material at the call: now that the name is known, resolve it like LoadMesh
+    if (m_findMaterial) {
+        Material* material = m_objects.FindMaterial(m_reader.GetHeader().material);
+        if (material && material != m_mesh->pMaterial)
+            m_objects.AddMeshToMaterial(material, m_mesh);
+    }
+
+    Shader* shader = m_mesh->pMaterial ? m_mesh->pMaterial->pRenderShader : nullptr;
+    if (!shader) {
+        error = m_path + ": cannot resolve shader";
+        return false;
+    }
+    if (!MeshLoader::MatchesLayout(m_reader, shader, m_nullDevice)) {
+        error = m_path + ": cooked vertex layout does not match the shader (recook)";
+        return false;
+    }
+
+    MeshLoader::Build(m_objects, m_buffers, m_mesh, m_reader, shader, m_keepGeometry);
+    return true;
+}
@@ -0,0 +1,164 @@
+#include "DynamicVertexStream.h"
+#include "gdxdevice.h"
+#include <algorithm>
+#include <cstring>
+
+DynamicVertexStream::DynamicVertexStream() :
+    m_buffer(nullptr),
+    m_stride(0),
+    m_count(0),
+    m_current(0),
+    m_changed(false)
+{
+}
+
+DynamicVertexStream::~DynamicVertexStream()
+{
+    Release();
+}
+
+void DynamicVertexStream::Release()
+{
+    Memory::SafeRelease(m_buffer);
+    m_count = 0;
+    m_current = 0;
+    m_changed = false;
+    for (std::vector<Range>& ranges : m_pending)
+        ranges.clear();
+}
+
+HRESULT DynamicVertexStream::Create(const GDXDevice* device, const void* data, UINT stride, UINT count)
+{
+    if (!device || !data || stride == 0 || count == 0)
+        return E_INVALIDARG;
+
+    Release();
+
+    // Initial data into every segment, afterwards all segments are valid
+    const size_t segmentBytes = static_cast<size_t>(stride) * count;
+    std::vector<unsigned char> initial(segmentBytes * SEGMENTS);
+    for (UINT s = 0; s < SEGMENTS; ++s)
+        memcpy(initial.data() + s * segmentBytes, data, segmentBytes);
+
+    D3D11_BUFFER_DESC desc{};
+    desc.ByteWidth = static_cast<UINT>(initial.size());
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    D3D11_SUBRESOURCE_DATA initData{};
+    initData.pSysMem = initial.data();
+
+    HRESULT hr = device->CreateBuffer(&desc, &initData, &m_buffer);
+    if (FAILED(hr))
+    {
+        Debug::LogHr(__FILE__, __LINE__, hr);
+        return hr;
+    }
+
+    m_stride = stride;
+    m_count = count;
+    return S_OK;
+}
+
+void DynamicVertexStream::AddRange(std::vector<Range>& ranges, UINT begin, UINT end)
+{
+    // Overlapping or adjacent: extend the existing range. Vertex-by-vertex
+    // writes almost always hit the last one, so search backwards.
+    for (size_t i = ranges.size(); i-- > 0;)
+    {
+        Range& range = ranges[i];
+        if (begin <= range.end && end >= range.begin)
+        {
+            range.begin = (std::min)(range.begin, begin);
+            range.end = (std::max)(range.end, end);
+            return;
+        }
+    }
+
+    if (ranges.size() < MAX_RANGES)
+    {
+        ranges.push_back({ begin, end });
+        return;
+    }
+
+    // Too many scattered ranges: one enclosing range
+    Range bounds = { begin, end };
+    for (const Range& range : ranges)
+    {
+        bounds.begin = (std::min)(bounds.begin, range.begin);
+        bounds.end = (std::max)(bounds.end, range.end);
+    }
+    ranges.assign(1, bounds);
+}
+
+void DynamicVertexStream::MarkDirty(UINT first, UINT count)
+{
+    m_changed = true;
+
+    // New vertices (first >= m_count) are handled by the rebuild in Upload()
+    if (first >= m_count || count == 0)
+        return;
+
+    const UINT end = (std::min)(m_count, first + count);
+    for (std::vector<Range>& ranges : m_pending)
+        AddRange(ranges, first, end);
+}
+
+void DynamicVertexStream::MarkAllDirty()
+{
+    m_changed = true;
+    for (std::vector<Range>& ranges : m_pending)
+        ranges.assign(1, Range{ 0, m_count });
+}
+
+HRESULT DynamicVertexStream::Upload(const GDXDevice* device, const void* data, UINT count, UINT& uploadedBytes)
+{
+    uploadedBytes = 0;
+
+    if (!m_changed)
+        return S_OK;
+
+    if (!device || !data)
+        return E_INVALIDARG;
+
+    // Vertex count changed: recreate, the initial data is then the upload
+    if (count != m_count)
+    {
+        HRESULT hr = Create(device, data, m_stride, count);
+        if (SUCCEEDED(hr))
+            uploadedBytes = m_stride * count * SEGMENTS;
+        return hr;
+    }
+
+    const UINT next = (m_current + 1) % SEGMENTS;
+    std::vector<Range>& ranges = m_pending[next];
+
+    if (!ranges.empty())
+    {
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        HRESULT hr = device->Map(m_buffer, D3D11_MAP_WRITE_NO_OVERWRITE, &mapped);
+        if (FAILED(hr))
+        {
+            Debug::LogHr(__FILE__, __LINE__, hr);
+            return hr;
+        }
+
+        unsigned char* segment = static_cast<unsigned char*>(mapped.pData) + next * m_stride * m_count;
+        const unsigned char* source = static_cast<const unsigned char*>(data);
+        for (const Range& range : ranges)
+        {
+            const UINT offset = range.begin * m_stride;
+            const UINT bytes = (range.end - range.begin) * m_stride;
+            memcpy(segment + offset, source + offset, bytes);
+            uploadedBytes += bytes;
+        }
+
+        device->Unmap(m_buffer);
+        ranges.clear();
+    }
+
+    m_current = next;
+    m_changed = false;
+    return S_OK;
+}
@@ -1,9 +1,10 @@
 ﻿#include "Entity.h"
 #include "gdxdevice.h"
-#include "Memory.h"
+#include <cstring>
 using namespace DirectX;
 
-Entity::Entity() :
+Entity::Entity(TransformSystem& transformSystem) :
+    transform(transformSystem),
     constantBuffer(nullptr),
     isActive(true)
 {
@@ -12,6 +13,7 @@ Entity::Entity() :
     matrixSet.worldMatrix = DirectX::XMMatrixIdentity();
     matrixSet.viewMatrix = DirectX::XMMatrixIdentity();
     matrixSet.projectionMatrix = DirectX::XMMatrixIdentity();
+    matrixSet.normalMatrix = DirectX::XMMatrixIdentity();
 
     viewport = { 0 };  // ← Initialisiere Viewport
 }
@@ -26,14 +28,12 @@ void Entity::Update(const GDXDevice* device) {
     HRESULT hr = S_OK;
     D3D11_MAPPED_SUBRESOURCE mappedResource;
 
-    matrixSet.worldMatrix = transform.GetScaling() *
-        transform.GetRotation() *
-        transform.GetTranslation();
+    // Cached world matrix from the TransformSystem (recomputed only when dirty)
+    matrixSet.worldMatrix = transform.GetLocalTransformationMatrix();
+    matrixSet.normalMatrix = matrixSet.worldMatrix;
 
     if (constantBuffer != nullptr) {
-        hr = device->GetDeviceContext()->Map(constantBuffer, 0,
-            D3D11_MAP_WRITE_DISCARD, 0,
-            &mappedResource);
+        hr = device->Map(constantBuffer, D3D11_MAP_WRITE_DISCARD, &mappedResource);
         if (FAILED(hr))
         {
             Debug::LogHr(__FILE__, __LINE__, hr);
@@ -41,9 +41,9 @@ void Entity::Update(const GDXDevice* device) {
         }
 
         memcpy(mappedResource.pData, &matrixSet, sizeof(MatrixSet));
-        device->GetDeviceContext()->Unmap(constantBuffer, 0);
-        device->GetDeviceContext()->VSSetConstantBuffers(0, 1, &constantBuffer);
-        device->GetDeviceContext()->PSSetConstantBuffers(0, 1, &constantBuffer);
+        device->Unmap(constantBuffer);
+        device->VSSetConstantBuffers(0, 1, &constantBuffer);
+        device->PSSetConstantBuffers(0, 1, &constantBuffer);
     }
 }
 
@@ -0,0 +1,145 @@
+#include "Frustum.h"
+#include <cmath>
+using namespace DirectX;
+
+// ==================== BOUNDS SOA ====================
+
+void BoundsSoA::Clear()
+{
+    centerX.clear(); centerY.clear(); centerZ.clear();
+    extentX.clear(); extentY.clear(); extentZ.clear();
+}
+
+void BoundsSoA::Reserve(size_t count)
+{
+    centerX.reserve(count); centerY.reserve(count); centerZ.reserve(count);
+    extentX.reserve(count); extentY.reserve(count); extentZ.reserve(count);
+}
+
+void BoundsSoA::Add(const XMFLOAT3& center, const XMFLOAT3& extents)
+{
+    centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+    extentX.push_back(extents.x); extentY.push_back(extents.y); extentZ.push_back(extents.z);
+}
+
+// ==================== FRUSTUM ====================
+
+Frustum::Frustum()
+{
+    for (auto& plane : m_planes)
+        plane = XMFLOAT4A(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void Frustum::ExtractFromMatrix(FXMMATRIX viewProjection)
+{
+    // Row vectors (v * M): the planes follow from the columns of M
+    XMMATRIX m = XMMatrixTranspose(viewProjection);
+
+    XMVECTOR planes[6] = {
+        XMVectorAdd(m.r[3], m.r[0]),        // left
+        XMVectorSubtract(m.r[3], m.r[0]),   // right
+        XMVectorAdd(m.r[3], m.r[1]),        // bottom
+        XMVectorSubtract(m.r[3], m.r[1]),   // top
+        m.r[2],                             // near (D3D: 0 <= z)
+        XMVectorSubtract(m.r[3], m.r[2])    // far
+    };
+
+    for (int i = 0; i < 6; ++i)
+        XMStoreFloat4A(&m_planes[i], XMPlaneNormalize(planes[i]));
+}
+
+bool Frustum::IntersectsAABB(const XMFLOAT3& center, const XMFLOAT3& extents) const
+{
+    for (const auto& p : m_planes)
+    {
+        float dist = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+        float radius = fabsf(p.x) * extents.x + fabsf(p.y) * extents.y + fabsf(p.z) * extents.z;
+        if (dist + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+FrustumTest Frustum::ClassifyAABB(const XMFLOAT3& center, const XMFLOAT3& extents, uint32_t& planeMask) const
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        const uint32_t bit = 1u << i;
+        if (!(planeMask & bit))
+            continue;
+
+        const XMFLOAT4A& p = m_planes[i];
+        float dist = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+        float radius = fabsf(p.x) * extents.x + fabsf(p.y) * extents.y + fabsf(p.z) * extents.z;
+        if (dist + radius < 0.0f)
+            return FrustumTest::Outside;
+        if (dist - radius >= 0.0f)
+            planeMask &= ~bit;
+    }
+    return planeMask ? FrustumTest::Intersect : FrustumTest::Inside;
+}
+
+size_t Frustum::CullAABBs(const BoundsSoA& bounds, size_t begin, size_t end, uint8_t* visible) const
+{
+    // Splat the planes once per call
+    XMVECTOR nx[6], ny[6], nz[6], ax[6], ay[6], az[6], d[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        XMVECTOR plane = XMLoadFloat4A(&m_planes[p]);
+        nx[p] = XMVectorSplatX(plane);
+        ny[p] = XMVectorSplatY(plane);
+        nz[p] = XMVectorSplatZ(plane);
+        d[p] = XMVectorSplatW(plane);
+        ax[p] = XMVectorAbs(nx[p]);
+        ay[p] = XMVectorAbs(ny[p]);
+        az[p] = XMVectorAbs(nz[p]);
+    }
+
+    const XMVECTOR zero = XMVectorZero();
+    size_t count = 0;
+    size_t i = begin;
+
+    // 4 boxes per iteration
+    for (; i + 4 <= end; i += 4)
+    {
+        XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.centerX[i]));
+        XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.centerY[i]));
+        XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.centerZ[i]));
+        XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extentX[i]));
+        XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extentY[i]));
+        XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extentZ[i]));
+
+        XMVECTOR outside = XMVectorFalseInt();
+        for (int p = 0; p < 6; ++p)
+        {
+            XMVECTOR dist = XMVectorMultiplyAdd(nx[p], cx, d[p]);
+            dist = XMVectorMultiplyAdd(ny[p], cy, dist);
+            dist = XMVectorMultiplyAdd(nz[p], cz, dist);
+
+            XMVECTOR radius = XMVectorMultiply(ax[p], ex);
+            radius = XMVectorMultiplyAdd(ay[p], ey, radius);
+            radius = XMVectorMultiplyAdd(az[p], ez, radius);
+
+            outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(dist, radius), zero));
+        }
+
+        XMUINT4 mask;
+        XMStoreUInt4(&mask, outside);
+        visible[i + 0] = mask.x ? 0 : 1;
+        visible[i + 1] = mask.y ? 0 : 1;
+        visible[i + 2] = mask.z ? 0 : 1;
+        visible[i + 3] = mask.w ? 0 : 1;
+        count += visible[i + 0] + visible[i + 1] + visible[i + 2] + visible[i + 3];
+    }
+
+    // Remainder one by one
+    for (; i < end; ++i)
+    {
+        XMFLOAT3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+        XMFLOAT3 extents(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+        visible[i] = IntersectsAABB(center, extents) ? 1 : 0;
+        count += visible[i];
+    }
+
+    return count;
+}
@@ -0,0 +1,1085 @@
+#include "ModelImporter.h"
+#include "JobSystem.h"
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+using namespace DirectX;
+
+// glTF 2.0 / GLB -> ModelImporter::Model (see ModelImporter.h)
+
+namespace ModelImporter
+{
+    static bool SetError(std::string* error, const std::string& message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    }
+
+    // ==================== JSON ====================
+
+    namespace
+    {
+        struct JsonValue
+        {
+            enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+            Type type = JSON_NULL;
+            bool boolean = false;
+            double number = 0.0;
+            std::string string;
+            std::vector<std::string> keys;      // JSON_OBJECT, parallel to items
+            std::vector<JsonValue> items;       // JSON_ARRAY and JSON_OBJECT
+
+            const JsonValue* Find(const char* key) const
+            {
+                if (type != JSON_OBJECT)
+                    return nullptr;
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    if (keys[i] == key)
+                        return &items[i];
+                }
+                return nullptr;
+            }
+
+            // Arrays: number of elements, otherwise 0
+            size_t Size() const { return type == JSON_ARRAY ? items.size() : 0; }
+
+            double Number(const char* key, double fallback) const
+            {
+                const JsonValue* value = Find(key);
+                return value && value->type == JSON_NUMBER ? value->number : fallback;
+            }
+
+            // Non-negative integer (indices, offsets), otherwise fallback
+            int64_t Index(const char* key, int64_t fallback = -1) const
+            {
+                const JsonValue* value = Find(key);
+                if (!value || value->type != JSON_NUMBER || value->number < 0.0 || value->number > 9007199254740992.0)
+                    return fallback;
+                return static_cast<int64_t>(value->number);
+            }
+
+            const std::string* String(const char* key) const
+            {
+                const JsonValue* value = Find(key);
+                return value && value->type == JSON_STRING ? &value->string : nullptr;
+            }
+
+            // Array of count numbers into out; false if missing or of the wrong length
+            bool Numbers(const char* key, float* out, size_t count) const
+            {
+                const JsonValue* value = Find(key);
+                if (!value || value->Size() != count)
+                    return false;
+                for (size_t i = 0; i < count; ++i) {
+                    if (value->items[i].type != JSON_NUMBER)
+                        return false;
+                    out[i] = static_cast<float>(value->items[i].number);
+                }
+                return true;
+            }
+        };
+
+        class JsonParser
+        {
+        public:
+            JsonParser(const char* begin, const char* end) : m_p(begin), m_end(end) {}
+
+            bool Parse(JsonValue& root)
+            {
+                if (!ParseValue(root, 0))
+                    return false;
+                SkipSpaces();
+                if (m_p != m_end)
+                    return Fail("json: trailing characters");
+                return true;
+            }
+
+            const std::string& GetError() const { return m_error; }
+
+        private:
+            static constexpr int MAX_DEPTH = 64;
+
+            bool Fail(const char* message)
+            {
+                if (m_error.empty())
+                    m_error = message;
+                return false;
+            }
+
+            void SkipSpaces()
+            {
+                while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r'))
+                    ++m_p;
+            }
+
+            bool Literal(const char* word)
+            {
+                const size_t length = strlen(word);
+                if (static_cast<size_t>(m_end - m_p) < length || memcmp(m_p, word, length) != 0)
+                    return Fail("json: invalid literal");
+                m_p += length;
+                return true;
+            }
+
+            static int Hex(char c)
+            {
+                if (c >= '0' && c <= '9') return c - '0';
+                if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+                return -1;
+            }
+
+            bool ParseHex4(uint32_t& value)
+            {
+                if (m_end - m_p < 4)
+                    return Fail("json: invalid \\u escape");
+                value = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = Hex(*m_p++);
+                    if (digit < 0)
+                        return Fail("json: invalid \\u escape");
+                    value = (value << 4) | static_cast<uint32_t>(digit);
+                }
+                return true;
+            }
+
+            static void AppendUtf8(std::string& out, uint32_t code)
+            {
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                }
+                else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000) {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            bool ParseString(std::string& out)
+            {
+                ++m_p;  // "
+                for (;;) {
+                    const char* start = m_p;
+                    while (m_p < m_end && *m_p != '"' && *m_p != '\\')
+                        ++m_p;
+                    out.append(start, m_p);
+                    if (m_p >= m_end)
+                        return Fail("json: unterminated string");
+                    if (*m_p++ == '"')
+                        return true;
+
+                    if (m_p >= m_end)
+                        return Fail("json: unterminated string");
+                    const char escape = *m_p++;
+                    switch (escape) {
+                    case '"':  out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/':  out += '/'; break;
+                    case 'b':  out += '\b'; break;
+                    case 'f':  out += '\f'; break;
+                    case 'n':  out += '\n'; break;
+                    case 'r':  out += '\r'; break;
+                    case 't':  out += '\t'; break;
+                    case 'u': {
+                        uint32_t code;
+                        if (!ParseHex4(code))
+                            return false;
+                        // surrogate pair
+                        if (code >= 0xD800 && code < 0xDC00) {
+                            uint32_t low;
+                            if (m_end - m_p < 2 || m_p[0] != '\\' || m_p[1] != 'u')
+                                return Fail("json: invalid surrogate pair");
+                            m_p += 2;
+                            if (!ParseHex4(low) || low < 0xDC00 || low >= 0xE000)
+                                return Fail("json: invalid surrogate pair");
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        AppendUtf8(out, code);
+                        break;
+                    }
+                    default:
+                        return Fail("json: invalid escape");
+                    }
+                }
+            }
+
+            bool ParseValue(JsonValue& value, int depth)
+            {
+                if (depth > MAX_DEPTH)
+                    return Fail("json: nesting too deep");
+
+                SkipSpaces();
+                if (m_p >= m_end)
+                    return Fail("json: unexpected end");
+
+                switch (*m_p) {
+                case '{': {
+                    value.type = JsonValue::JSON_OBJECT;
+                    ++m_p;
+                    SkipSpaces();
+                    if (m_p < m_end && *m_p == '}') {
+                        ++m_p;
+                        return true;
+                    }
+                    for (;;) {
+                        SkipSpaces();
+                        if (m_p >= m_end || *m_p != '"')
+                            return Fail("json: expected key");
+                        value.keys.emplace_back();
+                        if (!ParseString(value.keys.back()))
+                            return false;
+                        SkipSpaces();
+                        if (m_p >= m_end || *m_p != ':')
+                            return Fail("json: expected ':'");
+                        ++m_p;
+                        value.items.emplace_back();
+                        if (!ParseValue(value.items.back(), depth + 1))
+                            return false;
+                        SkipSpaces();
+                        if (m_p < m_end && *m_p == ',') {
+                            ++m_p;
+                            continue;
+                        }
+                        if (m_p < m_end && *m_p == '}') {
+                            ++m_p;
+                            return true;
+                        }
+                        return Fail("json: expected ',' or '}'");
+                    }
+                }
+                case '[': {
+                    value.type = JsonValue::JSON_ARRAY;
+                    ++m_p;
+                    SkipSpaces();
+                    if (m_p < m_end && *m_p == ']') {
+                        ++m_p;
+                        return true;
+                    }
+                    for (;;) {
+                        value.items.emplace_back();
+                        if (!ParseValue(value.items.back(), depth + 1))
+                            return false;
+                        SkipSpaces();
+                        if (m_p < m_end && *m_p == ',') {
+                            ++m_p;
+                            continue;
+                        }
+                        if (m_p < m_end && *m_p == ']') {
+                            ++m_p;
+                            return true;
+                        }
+                        return Fail("json: expected ',' or ']'");
+                    }
+                }
+                case '"':
+                    value.type = JsonValue::JSON_STRING;
+                    return ParseString(value.string);
+                case 't':
+                    value.type = JsonValue::JSON_BOOL;
+                    value.boolean = true;
+                    return Literal("true");
+                case 'f':
+                    value.type = JsonValue::JSON_BOOL;
+                    return Literal("false");
+                case 'n':
+                    return Literal("null");
+                default: {
+                    const char* next = ParseNumber(m_p, m_end, value.number);
+                    if (!next)
+                        return Fail("json: invalid value");
+                    value.type = JsonValue::JSON_NUMBER;
+                    m_p = next;
+                    return true;
+                }
+                }
+            }
+
+            const char* m_p;
+            const char* m_end;
+            std::string m_error;
+        };
+    }
+
+    // ==================== BUFFER ====================
+
+    namespace
+    {
+        struct GltfBuffer
+        {
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+            std::vector<uint8_t> decoded;                   // data: URI
+            std::unique_ptr<MeshFile::MappedFile> file;     // external file
+        };
+
+        struct GltfView
+        {
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+            size_t stride = 0;      // 0 = tightly packed
+        };
+
+        // Read view of an accessor; data == nullptr: zeros only (accessor without bufferView)
+        struct GltfAccessor
+        {
+            const uint8_t* data = nullptr;
+            size_t count = 0;
+            size_t stride = 0;
+            int componentType = 0;
+            int components = 0;
+            bool normalized = false;
+        };
+
+        struct GltfContext
+        {
+            JsonValue json;
+            std::vector<GltfBuffer> buffers;
+            std::vector<GltfView> views;
+            std::string baseDir;
+        };
+
+        enum ComponentType
+        {
+            COMPONENT_BYTE = 5120,
+            COMPONENT_UNSIGNED_BYTE = 5121,
+            COMPONENT_SHORT = 5122,
+            COMPONENT_UNSIGNED_SHORT = 5123,
+            COMPONENT_UNSIGNED_INT = 5125,
+            COMPONENT_FLOAT = 5126,
+        };
+
+        enum PrimitiveMode
+        {
+            MODE_TRIANGLES = 4,
+            MODE_TRIANGLE_STRIP = 5,
+            MODE_TRIANGLE_FAN = 6,
+        };
+    }
+
+    static size_t ComponentSize(int componentType)
+    {
+        switch (componentType) {
+        case COMPONENT_BYTE:
+        case COMPONENT_UNSIGNED_BYTE:   return 1;
+        case COMPONENT_SHORT:
+        case COMPONENT_UNSIGNED_SHORT:  return 2;
+        case COMPONENT_UNSIGNED_INT:
+        case COMPONENT_FLOAT:           return 4;
+        default:                        return 0;
+        }
+    }
+
+    static int ComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        if (type == "MAT2") return 4;
+        if (type == "MAT3") return 9;
+        if (type == "MAT4") return 16;
+        return 0;
+    }
+
+    // Character -> 6 bits, -1 = not a base64 character
+    struct Base64Table
+    {
+        int8_t values[256];
+
+        constexpr Base64Table() : values()
+        {
+            for (int i = 0; i < 256; ++i)
+                values[i] = -1;
+            for (int i = 0; i < 26; ++i) {
+                values['A' + i] = static_cast<int8_t>(i);
+                values['a' + i] = static_cast<int8_t>(26 + i);
+            }
+            for (int i = 0; i < 10; ++i)
+                values['0' + i] = static_cast<int8_t>(52 + i);
+            values['+'] = 62;
+            values['/'] = 63;
+        }
+    };
+
+    static constexpr Base64Table BASE64 = Base64Table();
+
+    static bool DecodeBase64(const char* p, const char* end, std::vector<uint8_t>& out)
+    {
+        while (end > p && end[-1] == '=')
+            --end;
+        const size_t length = static_cast<size_t>(end - p);
+        if (length % 4 == 1)
+            return false;
+
+        out.resize(length / 4 * 3 + (length % 4 ? length % 4 - 1 : 0));
+        uint8_t* o = out.data();
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(p);
+
+        // Groups of four -> 3 bytes; an invalid character (-1) makes the OR negative
+        for (const uint8_t* last = s + length / 4 * 4; s < last; s += 4, o += 3) {
+            const int32_t a = BASE64.values[s[0]], b = BASE64.values[s[1]];
+            const int32_t c = BASE64.values[s[2]], d = BASE64.values[s[3]];
+            if ((a | b | c | d) < 0)
+                return false;
+            const int32_t bits = (a << 18) | (b << 12) | (c << 6) | d;
+            o[0] = static_cast<uint8_t>(bits >> 16);
+            o[1] = static_cast<uint8_t>(bits >> 8);
+            o[2] = static_cast<uint8_t>(bits);
+        }
+
+        // Remainder: 2 or 3 characters -> 1 or 2 bytes
+        const size_t rest = length % 4;
+        if (rest) {
+            int32_t bits = 0;
+            for (size_t i = 0; i < rest; ++i) {
+                if (BASE64.values[s[i]] < 0)
+                    return false;
+                bits = (bits << 6) | BASE64.values[s[i]];
+            }
+            if (rest == 2) {
+                o[0] = static_cast<uint8_t>(bits >> 4);
+            }
+            else {
+                o[0] = static_cast<uint8_t>(bits >> 10);
+                o[1] = static_cast<uint8_t>(bits >> 2);
+            }
+        }
+        return true;
+    }
+
+    // URIs are percent-encoded ("my%20mesh.bin")
+    static std::string DecodeUri(const std::string& uri)
+    {
+        auto hex = [](char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        std::string out;
+        out.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); ++i) {
+            if (uri[i] == '%' && i + 2 < uri.size() && hex(uri[i + 1]) >= 0 && hex(uri[i + 2]) >= 0) {
+                out += static_cast<char>(hex(uri[i + 1]) * 16 + hex(uri[i + 2]));
+                i += 2;
+            }
+            else {
+                out += uri[i];
+            }
+        }
+        return out;
+    }
+
+    static bool LoadBuffers(GltfContext& context, const uint8_t* bin, size_t binSize, Model& model, std::string* error)
+    {
+        const JsonValue* buffers = context.json.Find("buffers");
+        const size_t count = buffers ? buffers->Size() : 0;
+        context.buffers.resize(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            const JsonValue& json = buffers->items[i];
+            GltfBuffer& buffer = context.buffers[i];
+            const int64_t byteLength = json.Index("byteLength");
+            if (byteLength < 0)
+                return SetError(error, "gltf: buffer without byteLength");
+
+            const std::string* uri = json.String("uri");
+            if (!uri) {
+                // GLB: the first buffer without a URI is the BIN chunk
+                if (i != 0 || !bin)
+                    return SetError(error, "gltf: buffer without uri");
+                buffer.data = bin;
+                buffer.size = binSize;
+            }
+            else if (uri->compare(0, 5, "data:") == 0) {
+                const size_t comma = uri->find(',');
+                if (comma == std::string::npos || uri->rfind(";base64", comma) == std::string::npos)
+                    return SetError(error, "gltf: unsupported data uri");
+                if (!DecodeBase64(uri->data() + comma + 1, uri->data() + uri->size(), buffer.decoded))
+                    return SetError(error, "gltf: invalid base64 data");
+                buffer.data = buffer.decoded.data();
+                buffer.size = buffer.decoded.size();
+            }
+            else {
+                const std::string path = context.baseDir + DecodeUri(*uri);
+                buffer.file.reset(new MeshFile::MappedFile());
+                if (!buffer.file->Open(path.c_str()))
+                    return SetError(error, "gltf: cannot open buffer " + path);
+                buffer.data = buffer.file->GetData();
+                buffer.size = buffer.file->GetSize();
+                model.sourceBytes += buffer.size;
+            }
+
+            if (buffer.size < static_cast<size_t>(byteLength))
+                return SetError(error, "gltf: buffer shorter than byteLength");
+            buffer.size = static_cast<size_t>(byteLength);
+        }
+
+        const JsonValue* views = context.json.Find("bufferViews");
+        const size_t viewCount = views ? views->Size() : 0;
+        context.views.resize(viewCount);
+        for (size_t i = 0; i < viewCount; ++i) {
+            const JsonValue& json = views->items[i];
+            const int64_t buffer = json.Index("buffer");
+            const int64_t offset = json.Index("byteOffset", 0);
+            const int64_t length = json.Index("byteLength");
+            const int64_t stride = json.Index("byteStride", 0);
+            if (buffer < 0 || static_cast<size_t>(buffer) >= context.buffers.size() || offset < 0 || length < 0 || stride < 0)
+                return SetError(error, "gltf: invalid bufferView");
+            const GltfBuffer& source = context.buffers[static_cast<size_t>(buffer)];
+            if (static_cast<uint64_t>(offset) + static_cast<uint64_t>(length) > source.size)
+                return SetError(error, "gltf: bufferView outside buffer");
+            context.views[i].data = source.data + offset;
+            context.views[i].size = static_cast<size_t>(length);
+            context.views[i].stride = static_cast<size_t>(stride);
+        }
+        return true;
+    }
+
+    static bool ResolveAccessor(const GltfContext& context, int64_t index, GltfAccessor& accessor, std::string& error)
+    {
+        const JsonValue* accessors = context.json.Find("accessors");
+        if (!accessors || index < 0 || static_cast<size_t>(index) >= accessors->Size()) {
+            error = "gltf: invalid accessor index";
+            return false;
+        }
+        const JsonValue& json = accessors->items[static_cast<size_t>(index)];
+        if (json.Find("sparse")) {
+            error = "gltf: sparse accessors are not supported";
+            return false;
+        }
+
+        const std::string* type = json.String("type");
+        accessor.componentType = static_cast<int>(json.Index("componentType", 0));
+        accessor.components = type ? ComponentCount(*type) : 0;
+        accessor.normalized = json.Find("normalized") && json.Find("normalized")->boolean;
+        const int64_t count = json.Index("count");
+        const size_t componentSize = ComponentSize(accessor.componentType);
+        if (accessor.components == 0 || componentSize == 0 || count < 0) {
+            error = "gltf: invalid accessor";
+            return false;
+        }
+        accessor.count = static_cast<size_t>(count);
+
+        const int64_t view = json.Index("bufferView");
+        if (view < 0) {
+            accessor.data = nullptr;
+            return true;
+        }
+        if (static_cast<size_t>(view) >= context.views.size()) {
+            error = "gltf: invalid bufferView index";
+            return false;
+        }
+
+        const GltfView& source = context.views[static_cast<size_t>(view)];
+        const size_t elementSize = componentSize * static_cast<size_t>(accessor.components);
+        const int64_t offset = json.Index("byteOffset", 0);
+        accessor.stride = source.stride ? source.stride : elementSize;
+        if (offset < 0 || accessor.stride < elementSize) {
+            error = "gltf: invalid accessor layout";
+            return false;
+        }
+
+        // the last element must lie completely inside the view
+        const uint64_t needed = accessor.count
+            ? static_cast<uint64_t>(offset) + static_cast<uint64_t>(accessor.stride) * (accessor.count - 1) + elementSize
+            : 0;
+        if (needed > source.size) {
+            error = "gltf: accessor outside bufferView";
+            return false;
+        }
+        accessor.data = source.data + offset;
+        return true;
+    }
+
+    // Element i as floats (normalized per the glTF rules), at most count components
+    static void ReadFloats(const GltfAccessor& accessor, size_t i, float* out, int count)
+    {
+        const int components = (std::min)(count, accessor.components);
+        if (!accessor.data) {
+            for (int c = 0; c < components; ++c)
+                out[c] = 0.0f;
+            return;
+        }
+
+        const uint8_t* p = accessor.data + accessor.stride * i;
+        const bool normalized = accessor.normalized;
+        for (int c = 0; c < components; ++c) {
+            switch (accessor.componentType) {
+            case COMPONENT_FLOAT: {
+                memcpy(&out[c], p + c * 4, 4);
+                break;
+            }
+            case COMPONENT_BYTE: {
+                const float value = static_cast<float>(static_cast<int8_t>(p[c]));
+                out[c] = normalized ? (std::max)(value / 127.0f, -1.0f) : value;
+                break;
+            }
+            case COMPONENT_UNSIGNED_BYTE: {
+                const float value = static_cast<float>(p[c]);
+                out[c] = normalized ? value / 255.0f : value;
+                break;
+            }
+            case COMPONENT_SHORT: {
+                int16_t raw;
+                memcpy(&raw, p + c * 2, 2);
+                const float value = static_cast<float>(raw);
+                out[c] = normalized ? (std::max)(value / 32767.0f, -1.0f) : value;
+                break;
+            }
+            case COMPONENT_UNSIGNED_SHORT: {
+                uint16_t raw;
+                memcpy(&raw, p + c * 2, 2);
+                const float value = static_cast<float>(raw);
+                out[c] = normalized ? value / 65535.0f : value;
+                break;
+            }
+            case COMPONENT_UNSIGNED_INT: {
+                uint32_t raw;
+                memcpy(&raw, p + c * 4, 4);
+                out[c] = static_cast<float>(raw);
+                break;
+            }
+            }
+        }
+    }
+
+    static bool ReadIndices(const GltfAccessor& accessor, std::vector<unsigned int>& out, std::string& error)
+    {
+        if (accessor.components != 1 || !accessor.data ||
+            (accessor.componentType != COMPONENT_UNSIGNED_BYTE &&
+             accessor.componentType != COMPONENT_UNSIGNED_SHORT &&
+             accessor.componentType != COMPONENT_UNSIGNED_INT)) {
+            error = "gltf: invalid index accessor";
+            return false;
+        }
+
+        out.resize(accessor.count);
+        const uint8_t* p = accessor.data;
+        for (size_t i = 0; i < accessor.count; ++i, p += accessor.stride) {
+            switch (accessor.componentType) {
+            case COMPONENT_UNSIGNED_BYTE:
+                out[i] = *p;
+                break;
+            case COMPONENT_UNSIGNED_SHORT: {
+                uint16_t value;
+                memcpy(&value, p, 2);
+                out[i] = value;
+                break;
+            }
+            default: {
+                uint32_t value;
+                memcpy(&value, p, 4);
+                out[i] = value;
+                break;
+            }
+            }
+        }
+        return true;
+    }
+
+    template<typename T, int N>
+    static bool ReadAttribute(const GltfContext& context, const JsonValue& attributes, const char* name,
+        size_t expectedCount, std::vector<T>& out, std::string& error)
+    {
+        const int64_t index = attributes.Index(name);
+        if (index < 0)
+            return true;    // attribute missing
+
+        GltfAccessor accessor;
+        if (!ResolveAccessor(context, index, accessor, error))
+            return false;
+        if (accessor.components < N || (expectedCount != SIZE_MAX && accessor.count != expectedCount)) {
+            error = std::string("gltf: invalid ") + name + " accessor";
+            return false;
+        }
+
+        out.resize(accessor.count);
+        for (size_t i = 0; i < accessor.count; ++i)
+            ReadFloats(accessor, i, reinterpret_cast<float*>(&out[i]), N);
+        return true;
+    }
+
+    // One glTF primitive -> Primitive (triangle list)
+    static bool ReadPrimitive(const GltfContext& context, const JsonValue& json, const Options& options,
+        Primitive& primitive, std::string& error)
+    {
+        const int64_t mode = json.Index("mode", MODE_TRIANGLES);
+        if (mode != MODE_TRIANGLES && mode != MODE_TRIANGLE_STRIP && mode != MODE_TRIANGLE_FAN)
+            return true;    // points/lines: stays empty, gets skipped
+
+        const JsonValue* attributes = json.Find("attributes");
+        if (!attributes || attributes->type != JsonValue::JSON_OBJECT || attributes->Index("POSITION") < 0) {
+            error = "gltf: primitive without POSITION";
+            return false;
+        }
+
+        if (!ReadAttribute<XMFLOAT3, 3>(context, *attributes, "POSITION", SIZE_MAX, primitive.positions, error))
+            return false;
+        const size_t vertexCount = primitive.positions.size();
+        if (vertexCount > UINT32_MAX) {
+            error = "gltf: too many vertices";
+            return false;
+        }
+
+        if (!ReadAttribute<XMFLOAT3, 3>(context, *attributes, "NORMAL", vertexCount, primitive.normals, error) ||
+            !ReadAttribute<XMFLOAT2, 2>(context, *attributes, "TEXCOORD_0", vertexCount, primitive.uv1, error) ||
+            !ReadAttribute<XMFLOAT2, 2>(context, *attributes, "TEXCOORD_1", vertexCount, primitive.uv2, error))
+            return false;
+
+        // COLOR_0 is VEC3 or VEC4
+        const int64_t colorIndex = attributes->Index("COLOR_0");
+        if (colorIndex >= 0) {
+            GltfAccessor accessor;
+            if (!ResolveAccessor(context, colorIndex, accessor, error))
+                return false;
+            if (accessor.components < 3 || accessor.count != vertexCount) {
+                error = "gltf: invalid COLOR_0 accessor";
+                return false;
+            }
+            primitive.colors.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i) {
+                float rgba[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+                ReadFloats(accessor, i, rgba, 4);
+                primitive.colors[i] = XMFLOAT4(rgba[0], rgba[1], rgba[2], rgba[3]);
+            }
+        }
+
+        std::vector<unsigned int> corners;
+        const int64_t indexAccessor = json.Index("indices");
+        const bool indexed = indexAccessor >= 0;
+        if (indexed) {
+            GltfAccessor accessor;
+            if (!ResolveAccessor(context, indexAccessor, accessor, error) || !ReadIndices(accessor, corners, error))
+                return false;
+            for (unsigned int index : corners) {
+                if (index >= vertexCount) {
+                    error = "gltf: index out of range";
+                    return false;
+                }
+            }
+        }
+        else {
+            corners.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i)
+                corners[i] = static_cast<unsigned int>(i);
+        }
+
+        if (mode == MODE_TRIANGLES) {
+            corners.resize(corners.size() / 3 * 3);
+            primitive.indices = std::move(corners);
+        }
+        else if (mode == MODE_TRIANGLE_STRIP) {
+            // Triangle i: (i, i+1, i+2), odd i with swapped order
+            for (size_t i = 0; i + 2 < corners.size(); ++i) {
+                const size_t odd = i & 1;
+                primitive.indices.push_back(corners[i]);
+                primitive.indices.push_back(corners[i + 1 + odd]);
+                primitive.indices.push_back(corners[i + 2 - odd]);
+            }
+        }
+        else {
+            for (size_t i = 1; i + 1 < corners.size(); ++i) {
+                primitive.indices.push_back(corners[i]);
+                primitive.indices.push_back(corners[i + 1]);
+                primitive.indices.push_back(corners[0]);
+            }
+        }
+
+        // Without indices every corner is stored separately
+        if (!indexed)
+            WeldVertices(primitive);
+
+        if (primitive.normals.empty() && options.generateNormals)
+            GenerateNormals(primitive);
+        if (options.leftHanded)
+            ConvertToLeftHanded(primitive);
+        return true;
+    }
+
+    static void ReadMaterials(const GltfContext& context, Model& model)
+    {
+        const JsonValue* materials = context.json.Find("materials");
+        const JsonValue* textures = context.json.Find("textures");
+        const JsonValue* images = context.json.Find("images");
+        const size_t count = materials ? materials->Size() : 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            const JsonValue& json = materials->items[i];
+            MaterialData material;
+            if (const std::string* name = json.String("name"))
+                material.name = *name;
+
+            float roughness = 1.0f;
+            if (const JsonValue* pbr = json.Find("pbrMetallicRoughness")) {
+                float color[4];
+                if (pbr->Numbers("baseColorFactor", color, 4)) {
+                    material.diffuse = XMFLOAT4(color[0], color[1], color[2], 1.0f);
+                    material.transparency = color[3];
+                }
+                roughness = static_cast<float>(pbr->Number("roughnessFactor", 1.0));
+
+                // baseColorTexture -> textures[].source -> images[].uri (files only)
+                const JsonValue* texture = pbr->Find("baseColorTexture");
+                const int64_t textureIndex = texture ? texture->Index("index") : -1;
+                if (textures && textureIndex >= 0 && static_cast<size_t>(textureIndex) < textures->Size()) {
+                    const int64_t source = textures->items[static_cast<size_t>(textureIndex)].Index("source");
+                    if (images && source >= 0 && static_cast<size_t>(source) < images->Size()) {
+                        const std::string* uri = images->items[static_cast<size_t>(source)].String("uri");
+                        if (uri && uri->compare(0, 5, "data:") != 0)
+                            material.texture = context.baseDir + DecodeUri(*uri);
+                    }
+                }
+            }
+
+            // Blinn-Phong approximation: exponent from the roughness (2 / a^2 - 2 with a = r^2),
+            // rough surfaces without a highlight
+            roughness = (std::max)(0.05f, (std::min)(1.0f, roughness));
+            const float a = roughness * roughness;
+            material.shininess = (std::max)(2.0f, (std::min)(256.0f, 2.0f / (a * a) - 2.0f));
+            const float specular = 1.0f - roughness;
+            material.specular = XMFLOAT4(specular, specular, specular, 1.0f);
+
+            const std::string* alphaMode = json.String("alphaMode");
+            material.blend = alphaMode && *alphaMode == "BLEND";
+            if (!material.blend)
+                material.transparency = 1.0f;
+
+            model.materials.push_back(material);
+        }
+    }
+
+    static XMMATRIX NodeMatrix(const JsonValue& node)
+    {
+        // glTF stores column-vector matrices column by column; read row by row this gives
+        // exactly the transpose, i.e. the DirectXMath form (v * M)
+        float values[16];
+        if (node.Numbers("matrix", values, 16)) {
+            XMFLOAT4X4 matrix;
+            memcpy(matrix.m, values, sizeof(values));
+            return XMLoadFloat4x4(&matrix);
+        }
+
+        float t[3] = { 0.0f, 0.0f, 0.0f };
+        float r[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float s[3] = { 1.0f, 1.0f, 1.0f };
+        node.Numbers("translation", t, 3);
+        node.Numbers("rotation", r, 4);
+        node.Numbers("scale", s, 3);
+        return XMMatrixMultiply(XMMatrixMultiply(
+            XMMatrixScaling(s[0], s[1], s[2]),
+            XMMatrixRotationQuaternion(XMVectorSet(r[0], r[1], r[2], r[3]))),
+            XMMatrixTranslation(t[0], t[1], t[2]));
+    }
+
+    static void ReadNodes(const GltfContext& context, const Options& options, Model& model)
+    {
+        const JsonValue* nodes = context.json.Find("nodes");
+        const size_t count = nodes ? nodes->Size() : 0;
+        if (count == 0) {
+            // No scene: every mesh once at the origin
+            XMFLOAT4X4 identity;
+            XMStoreFloat4x4(&identity, XMMatrixIdentity());
+            for (size_t i = 0; i < model.meshes.size(); ++i)
+                model.nodes.push_back({ model.meshes[i].name, static_cast<int>(i), identity });
+            return;
+        }
+
+        // Roots: the scene (scene or the first one), otherwise all nodes without a parent
+        std::vector<size_t> roots;
+        const JsonValue* scenes = context.json.Find("scenes");
+        const int64_t scene = context.json.Index("scene", 0);
+        if (scenes && static_cast<size_t>(scene) < scenes->Size()) {
+            if (const JsonValue* sceneNodes = scenes->items[static_cast<size_t>(scene)].Find("nodes")) {
+                for (const JsonValue& node : sceneNodes->items) {
+                    if (node.type == JsonValue::JSON_NUMBER && node.number >= 0.0 && node.number < static_cast<double>(count))
+                        roots.push_back(static_cast<size_t>(node.number));
+                }
+            }
+        }
+        else {
+            std::vector<bool> isChild(count, false);
+            for (const JsonValue& node : nodes->items) {
+                if (const JsonValue* children = node.Find("children")) {
+                    for (const JsonValue& child : children->items) {
+                        if (child.type == JsonValue::JSON_NUMBER && child.number >= 0.0 && child.number < static_cast<double>(count))
+                            isChild[static_cast<size_t>(child.number)] = true;
+                    }
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (!isChild[i])
+                    roots.push_back(i);
+            }
+        }
+
+        // Depth-first search with an explicit stack; every node at most once (guards against cycles)
+        struct Pending { size_t node; XMFLOAT4X4 parent; };
+        std::vector<Pending> stack;
+        std::vector<bool> visited(count, false);
+        XMFLOAT4X4 identity;
+        XMStoreFloat4x4(&identity, XMMatrixIdentity());
+        for (size_t i = roots.size(); i-- > 0;)
+            stack.push_back({ roots[i], identity });
+
+        while (!stack.empty()) {
+            const Pending pending = stack.back();
+            stack.pop_back();
+            if (visited[pending.node])
+                continue;
+            visited[pending.node] = true;
+
+            const JsonValue& json = nodes->items[pending.node];
+            const XMMATRIX world = XMMatrixMultiply(NodeMatrix(json), XMLoadFloat4x4(&pending.parent));
+            XMFLOAT4X4 stored;
+            XMStoreFloat4x4(&stored, world);
+
+            const int64_t mesh = json.Index("mesh");
+            if (mesh >= 0 && static_cast<size_t>(mesh) < model.meshes.size()) {
+                Node node;
+                if (const std::string* name = json.String("name"))
+                    node.name = *name;
+                node.mesh = static_cast<int>(mesh);
+                node.world = stored;
+                if (options.leftHanded)
+                    ConvertToLeftHanded(node.world);
+                model.nodes.push_back(node);
+            }
+
+            if (const JsonValue* children = json.Find("children")) {
+                for (size_t c = children->items.size(); c-- > 0;) {
+                    const JsonValue& child = children->items[c];
+                    if (child.type == JsonValue::JSON_NUMBER && child.number >= 0.0 && child.number < static_cast<double>(count))
+                        stack.push_back({ static_cast<size_t>(child.number), stored });
+                }
+            }
+        }
+    }
+
+    bool ImportGLTF(const uint8_t* data, size_t size, const std::string& baseDir, Model& model,
+        const Options& options, JobSystem* jobs, std::string* error)
+    {
+        model = Model();
+        model.sourceBytes = size;
+        if (!data || size == 0)
+            return SetError(error, "gltf: empty file");
+
+        // GLB: header (magic, version, length), then the JSON and optional BIN chunk
+        const char* jsonBegin = reinterpret_cast<const char*>(data);
+        const char* jsonEnd = jsonBegin + size;
+        const uint8_t* bin = nullptr;
+        size_t binSize = 0;
+
+        uint32_t magic = 0;
+        if (size >= 4)
+            memcpy(&magic, data, 4);
+        if (magic == 0x46546C67u) {     // "glTF"
+            uint32_t header[3];
+            if (size < 20)
+                return SetError(error, "glb: truncated header");
+            memcpy(header, data, sizeof(header));
+            if (header[1] != 2)
+                return SetError(error, "glb: unsupported version");
+            if (header[2] > size)
+                return SetError(error, "glb: truncated file");
+
+            size_t offset = 12;
+            jsonBegin = jsonEnd = nullptr;
+            while (offset + 8 <= header[2]) {
+                uint32_t chunk[2];
+                memcpy(chunk, data + offset, sizeof(chunk));
+                offset += 8;
+                if (chunk[0] > header[2] - offset)
+                    return SetError(error, "glb: chunk outside file");
+                if (chunk[1] == 0x4E4F534Au && !jsonBegin) {        // "JSON"
+                    jsonBegin = reinterpret_cast<const char*>(data + offset);
+                    jsonEnd = jsonBegin + chunk[0];
+                }
+                else if (chunk[1] == 0x004E4942u && !bin) {         // "BIN\0"
+                    bin = data + offset;
+                    binSize = chunk[0];
+                }
+                offset += (static_cast<size_t>(chunk[0]) + 3) & ~static_cast<size_t>(3);
+            }
+            if (!jsonBegin)
+                return SetError(error, "glb: no JSON chunk");
+        }
+
+        GltfContext context;
+        context.baseDir = baseDir;
+        JsonParser parser(jsonBegin, jsonEnd);
+        if (!parser.Parse(context.json))
+            return SetError(error, parser.GetError());
+        if (context.json.type != JsonValue::JSON_OBJECT)
+            return SetError(error, "gltf: root is not an object");
+
+        if (const JsonValue* required = context.json.Find("extensionsRequired")) {
+            if (required->Size() > 0)
+                return SetError(error, "gltf: required extension " + required->items[0].string);
+        }
+
+        if (!LoadBuffers(context, bin, binSize, model, error))
+            return false;
+
+        ReadMaterials(context, model);
+
+        // All primitives of all meshes as one list, read in parallel
+        struct Task { size_t mesh; const JsonValue* json; int material; };
+        std::vector<Task> tasks;
+        const JsonValue* meshes = context.json.Find("meshes");
+        const size_t meshCount = meshes ? meshes->Size() : 0;
+        model.meshes.resize(meshCount);
+        for (size_t m = 0; m < meshCount; ++m) {
+            const JsonValue& mesh = meshes->items[m];
+            if (const std::string* name = mesh.String("name"))
+                model.meshes[m].name = *name;
+            if (const JsonValue* primitives = mesh.Find("primitives")) {
+                for (const JsonValue& primitive : primitives->items) {
+                    int64_t material = primitive.Index("material");
+                    if (material >= static_cast<int64_t>(model.materials.size()))
+                        material = -1;
+                    tasks.push_back({ m, &primitive, static_cast<int>(material) });
+                }
+            }
+        }
+
+        std::vector<Primitive> primitives(tasks.size());
+        std::vector<std::string> errors(tasks.size());
+        auto read = [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; ++i) {
+                primitives[i].material = tasks[i].material;
+                ReadPrimitive(context, *tasks[i].json, options, primitives[i], errors[i]);
+            }
+        };
+        if (jobs)
+            jobs->ParallelFor(tasks.size(), 1, read);
+        else
+            read(0, tasks.size());
+
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (!errors[i].empty())
+                return SetError(error, errors[i]);
+            if (!primitives[i].indices.empty())
+                model.meshes[tasks[i].mesh].primitives.push_back(std::move(primitives[i]));
+        }
+
+        ReadNodes(context, options, model);
+        return true;
+    }
+}
@@ -1,4 +1,5 @@
 #include "InputLayoutManager.h"
+#include "VertexPacking.h"
 
 InputLayoutManager::InputLayoutManager() : m_device(nullptr) {}
 
@@ -9,7 +10,8 @@ void InputLayoutManager::Init(ID3D11Device* device)
     m_device = device;
 }
 
-HRESULT InputLayoutManager::CreateInputLayoutVertex(ID3D11InputLayout** layout, SHADER* shader, DWORD& saveFlags, DWORD flags)
+HRESULT InputLayoutManager::CreateInputLayoutVertex(ID3D11InputLayout** layout, SHADER* shader, DWORD& saveFlags, DWORD flags, bool perInstanceWorld,
+    DXGI_FORMAT positionFormat)
 {
     std::vector<D3D11_INPUT_ELEMENT_DESC> layoutElements;
 
@@ -22,7 +24,7 @@ HRESULT InputLayoutManager::CreateInputLayoutVertex(ID3D11InputLayout** layout,
     saveFlags = flags;
 
     if (flags & D3DVERTEX_POSITION) {
-        layoutElements.push_back({ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, currentOffset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        layoutElements.push_back({ "POSITION", 0, positionFormat, 0, currentOffset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         currentOffset += sizeof(DirectX::XMFLOAT3); 
         cnt++;
     }
@@ -51,6 +53,12 @@ HRESULT InputLayoutManager::CreateInputLayoutVertex(ID3D11InputLayout** layout,
         cnt++;
     }
 
+    // Instancing: world matrix as 4 rows, one element per instance
+    if (perInstanceWorld) {
+        AppendInstanceWorld(layoutElements, cnt);
+        cnt++;
+    }
+
     void* bytecode = shader->blobVS->GetBufferPointer();
     unsigned int size = (unsigned int)shader->blobVS->GetBufferSize();
 
@@ -62,4 +70,63 @@ HRESULT InputLayoutManager::CreateInputLayoutVertex(ID3D11InputLayout** layout,
     }
 
     return hr;
-}
\ No newline at end of file
+}
+
+HRESULT InputLayoutManager::CreateInputLayoutPacked(ID3D11InputLayout** layout, SHADER* shader, DWORD flags, bool perInstanceWorld,
+    bool quantizedPosition)
+{
+    if (!shader || !shader->blobVS)
+        return E_INVALIDARG;
+
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layoutElements;
+
+    // One stream with fixed offsets instead of one stream per attribute
+    VertexPacking::MakeInputElements(VertexPacking::MakeLayout(flags, quantizedPosition), 0, layoutElements);
+
+    if (perInstanceWorld)
+        AppendInstanceWorld(layoutElements, 1);
+
+    void* bytecode = shader->blobVS->GetBufferPointer();
+    unsigned int size = (unsigned int)shader->blobVS->GetBufferSize();
+
+    HRESULT hr = m_device->CreateInputLayout(layoutElements.data(), (unsigned int)layoutElements.size(), bytecode, size, layout);
+    if (FAILED(hr))
+    {
+        Debug::LogHr(__FILE__, __LINE__, hr);
+        return hr;
+    }
+
+    return hr;
+}
+
+HRESULT InputLayoutManager::CreateInputLayoutFormats(SHADER* shader, DWORD flags, bool perInstanceWorld)
+{
+    if (!shader || !shader->blobVS)
+        return E_INVALIDARG;
+
+    // Each variant separately: a missing layout only makes this format fall back to float/separate
+    DWORD savedFlags = 0;
+    HRESULT hr = CreateInputLayoutPacked(&shader->inputlayoutFormats[VERTEX_FORMAT_INTERLEAVED],
+        shader, flags, perInstanceWorld);
+
+    HRESULT hrQuantized = CreateInputLayoutVertex(&shader->inputlayoutFormats[VERTEX_FORMAT_QUANTIZED],
+        shader, savedFlags, flags, perInstanceWorld, DXGI_FORMAT_R16G16B16A16_UNORM);
+    if (SUCCEEDED(hr))
+        hr = hrQuantized;
+
+    HRESULT hrBoth = CreateInputLayoutPacked(&shader->inputlayoutFormats[VERTEX_FORMAT_INTERLEAVED | VERTEX_FORMAT_QUANTIZED],
+        shader, flags, perInstanceWorld, true);
+    if (SUCCEEDED(hr))
+        hr = hrBoth;
+
+    return hr;
+}
+
+void InputLayoutManager::AppendInstanceWorld(std::vector<D3D11_INPUT_ELEMENT_DESC>& layoutElements, UINT slot)
+{
+    // INSTANCE_WORLD0..3, one row (float4) each, step rate 1 instance
+    for (UINT row = 0; row < 4; ++row) {
+        layoutElements.push_back({ "INSTANCE_WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, slot,
+            row == 0 ? 0u : D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+    }
+}
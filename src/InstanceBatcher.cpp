@@ -0,0 +1,70 @@
+#include "InstanceBatcher.h"
+#include "gdxdevice.h"
+
+static constexpr UINT MIN_INSTANCE_CAPACITY = 1024;
+
+InstanceBatcher::InstanceBatcher() :
+    m_buffer(nullptr),
+    m_capacity(0)
+{
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+    Release();
+}
+
+void InstanceBatcher::Release()
+{
+    Memory::SafeRelease(m_buffer);
+    m_capacity = 0;
+}
+
+HRESULT InstanceBatcher::Upload(const GDXDevice* device)
+{
+    if (!device)
+        return E_INVALIDARG;
+
+    if (m_instances.empty())
+        return S_OK;
+
+    const UINT required = static_cast<UINT>(m_instances.size());
+
+    if (!m_buffer || required > m_capacity)
+    {
+        UINT capacity = m_capacity ? m_capacity : MIN_INSTANCE_CAPACITY;
+        while (capacity < required)
+            capacity *= 2;
+
+        Memory::SafeRelease(m_buffer);
+        m_capacity = 0;
+
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = capacity * sizeof(DirectX::XMFLOAT4X4);
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        HRESULT hr = device->CreateBuffer(&desc, nullptr, &m_buffer);
+        if (FAILED(hr))
+        {
+            Debug::LogHr(__FILE__, __LINE__, hr);
+            return hr;
+        }
+
+        m_capacity = capacity;
+        Debug::Log("InstanceBatcher.cpp: capacity ", capacity, " instances");
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    HRESULT hr = device->Map(m_buffer, D3D11_MAP_WRITE_DISCARD, &mapped);
+    if (FAILED(hr))
+    {
+        Debug::LogHr(__FILE__, __LINE__, hr);
+        return hr;
+    }
+
+    memcpy(mapped.pData, m_instances.data(), m_instances.size() * sizeof(DirectX::XMFLOAT4X4));
+    device->Unmap(m_buffer);
+    return S_OK;
+}
@@ -0,0 +1,221 @@
+#include "JobSystem.h"
+#include "gdxdebug.h"
+
+// Queue of the current thread. Threads not created by the JobSystem use queue 0.
+static thread_local unsigned int s_queueIndex = 0;
+
+JobSystem::JobSystem() :
+    m_queuedJobs(0),
+    m_running(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+    Shutdown();
+}
+
+void JobSystem::Init(unsigned int workerCount)
+{
+    if (m_running.load())
+        return;
+
+    if (workerCount == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = (cores > 1) ? cores - 1 : 0;
+    }
+
+    m_queues.clear();
+    for (unsigned int i = 0; i < workerCount + 1; ++i)
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+
+    m_running.store(true);
+
+    m_threads.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+        m_threads.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+
+    Debug::Log("JobSystem.cpp: Init - ", workerCount, " worker threads");
+}
+
+void JobSystem::Shutdown()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    m_threads.clear();
+    m_queues.clear();
+    m_queuedJobs.store(0);
+}
+
+void JobSystem::Run(JobFunction function, JobCounter* counter)
+{
+    if (counter)
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    Job job{ std::move(function), counter };
+
+    // No worker: run immediately
+    if (m_threads.empty())
+    {
+        Execute(job);
+        return;
+    }
+
+    Push(std::move(job));
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, JobFunction function, JobCounter* counter)
+{
+    if (counter)
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(dependency.m_mutex);
+        if (dependency.m_pending.load(std::memory_order_acquire) != 0)
+        {
+            dependency.m_continuations.push_back({ std::move(function), counter });
+            return;
+        }
+    }
+
+    // Dependency already satisfied
+    Job job{ std::move(function), counter };
+    if (m_threads.empty())
+        Execute(job);
+    else
+        Push(std::move(job));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        Job job;
+        if (!m_queues.empty() && PopOrSteal(s_queueIndex, job))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+
+    // Finish() still holds the mutex until the continuations are taken.
+    // Only then may the counter (often a stack variable) be destroyed.
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+void JobSystem::WorkerLoop(unsigned int queueIndex)
+{
+    s_queueIndex = queueIndex;
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+        Job job;
+        if (PopOrSteal(queueIndex, job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() {
+            return !m_running.load(std::memory_order_acquire) || m_queuedJobs.load(std::memory_order_acquire) > 0;
+            });
+    }
+}
+
+void JobSystem::Push(Job&& job)
+{
+    unsigned int index = s_queueIndex < m_queues.size() ? s_queueIndex : 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->jobs.push_back(std::move(job));
+    }
+
+    m_queuedJobs.fetch_add(1, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::PopOrSteal(unsigned int queueIndex, Job& job)
+{
+    const size_t queueCount = m_queues.size();
+    if (queueIndex >= queueCount)
+        queueIndex = 0;
+
+    // Own queue: from the back (scheduled last, data still in cache)
+    {
+        WorkerQueue& own = *m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal: from the front of the other queues
+    for (size_t i = 1; i < queueCount; ++i)
+    {
+        WorkerQueue& victim = *m_queues[(queueIndex + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    if (job.function)
+        job.function();
+
+    if (job.counter)
+        Finish(job.counter);
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+    std::vector<JobCounter::Continuation> continuations;
+
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        continuations.swap(counter->m_continuations);
+    }
+
+    // From here on the counter is not touched anymore
+    for (auto& continuation : continuations)
+    {
+        Job job{ std::move(continuation.function), continuation.counter };
+        if (m_threads.empty())
+            Execute(job);
+        else
+            Push(std::move(job));
+    }
+}
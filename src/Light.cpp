@@ -1,8 +1,8 @@
 ﻿#include "Light.h"
-#include "Memory.h"
+#include <cstring>
 using namespace DirectX;
 
-Light::Light() : Entity(), lightType(LightType::Directional)
+Light::Light(TransformSystem& transformSystem) : Entity(transformSystem), lightType(LightType::Directional)
 {
     lightBuffer = nullptr;
 
@@ -189,9 +189,7 @@ void Light::UpdateLight(const GDXDevice* device, XMVECTOR position, XMVECTOR loo
 
     // Kopiere die Daten in den lightBuffer
     D3D11_MAPPED_SUBRESOURCE mappedResource;
-    hr = device->GetDeviceContext()->Map(lightBuffer, 0,
-        D3D11_MAP_WRITE_DISCARD, 0,
-        &mappedResource);
+    hr = device->Map(lightBuffer, D3D11_MAP_WRITE_DISCARD, &mappedResource);
 
     if (FAILED(hr)) {
         Debug::Log("Light.cpp: Failed to map light buffer");
@@ -199,9 +197,9 @@ void Light::UpdateLight(const GDXDevice* device, XMVECTOR position, XMVECTOR loo
     }
 
     memcpy(mappedResource.pData, &cbLight, sizeof(LightBufferData));
-    device->GetDeviceContext()->Unmap(lightBuffer, 0);
+    device->Unmap(lightBuffer);
 
     // Setze den lightBuffer im Shader
-    device->GetDeviceContext()->VSSetConstantBuffers(1, 1, &lightBuffer);
-    device->GetDeviceContext()->PSSetConstantBuffers(1, 1, &lightBuffer);
+    device->VSSetConstantBuffers(1, 1, &lightBuffer);
+    device->PSSetConstantBuffers(1, 1, &lightBuffer);
 }
\ No newline at end of file
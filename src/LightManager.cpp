@@ -1,10 +1,12 @@
 ﻿#include "LightManager.h"
 #include "gdxengine.h"
 #include "Camera.h"
-#include "Memory.h"
+#include <cstring>
 using namespace DirectX;
 
-LightManager::LightManager() : lightBuffer(nullptr)
+LightManager::LightManager(TransformSystem& transforms) :
+    m_transforms(transforms),
+    lightBuffer(nullptr)
 {
     ZeroMemory(&lightCBData, sizeof(LightArrayBuffer));
 }
@@ -44,7 +46,7 @@ Light* LightManager::CreateLight(LightType type)
         return nullptr;
     }
 
-    Light* light = new Light;
+    Light* light = new Light(m_transforms);
     light->SetLightType(type);
 
     // Setze Default-Radius für Point-Lichter
@@ -93,7 +95,7 @@ void LightManager::InitializeLightBuffer(const GDXDevice* device)
     bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
     bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;  // ← KORRIGIERT: war D3D11_ACCESS_WRITE
 
-    HRESULT hr = device->GetDevice()->CreateBuffer(&bufferDesc, nullptr, &lightBuffer);
+    HRESULT hr = device->CreateBuffer(&bufferDesc, nullptr, &lightBuffer);
     if (FAILED(hr))
     {
         Debug::LogHr(__FILE__, __LINE__, hr);
@@ -142,8 +144,7 @@ void LightManager::Update(const GDXDevice* device)
 
     // Nur EINMAL alle Lichter auf einmal hochladen!
     D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = device->GetDeviceContext()->Map(lightBuffer, 0,
-        D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    HRESULT hr = device->Map(lightBuffer, D3D11_MAP_WRITE_DISCARD, &mappedResource);
 
     if (FAILED(hr))
     {
@@ -152,9 +153,9 @@ void LightManager::Update(const GDXDevice* device)
     }
 
     memcpy(mappedResource.pData, &lightCBData, sizeof(LightArrayBuffer));
-    device->GetDeviceContext()->Unmap(lightBuffer, 0);
+    device->Unmap(lightBuffer);
 
     // Buffer nur EINMAL an Shader binden (für VS und PS)
-    device->GetDeviceContext()->VSSetConstantBuffers(1, 1, &lightBuffer);
-    device->GetDeviceContext()->PSSetConstantBuffers(1, 1, &lightBuffer);
+    device->VSSetConstantBuffers(1, 1, &lightBuffer);
+    device->PSSetConstantBuffers(1, 1, &lightBuffer);
 }
\ No newline at end of file
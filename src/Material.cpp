@@ -32,8 +32,8 @@ Material::~Material() {
 void Material::SetTexture(const GDXDevice* device)
 {
     if (m_textureView && m_imageSamplerState) {
-        device->GetDeviceContext()->PSSetShaderResources(0, 1, &m_textureView);
-        device->GetDeviceContext()->PSSetSamplers(0, 1, &m_imageSamplerState);
+        device->PSSetShaderResources(0, 1, &m_textureView);
+        device->PSSetSamplers(0, 1, &m_imageSamplerState);
     }
 }
 
@@ -52,10 +52,10 @@ void Material::SetTexture(ID3D11Texture2D* texture, ID3D11ShaderResourceView* te
     if (m_imageSamplerState) m_imageSamplerState->AddRef();
 }
 
-void Material::UpdateConstantBuffer(ID3D11DeviceContext* context)
+void Material::UpdateConstantBuffer(const GDXDevice* device)
 {
-    if (materialBuffer != nullptr && context != nullptr) {
-        context->UpdateSubresource(materialBuffer, 0, nullptr, &properties, 0, 0);
-        context->PSSetConstantBuffers(2, 1, &materialBuffer);
+    if (materialBuffer != nullptr && device != nullptr) {
+        device->UpdateSubresource(materialBuffer, &properties);
+        device->PSSetConstantBuffers(2, 1, &materialBuffer);
     }
 }
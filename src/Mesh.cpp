@@ -1,11 +1,16 @@
-﻿#include "Memory.h"
+﻿#include <cstring>
 #include "Mesh.h"
+#include <cfloat>
+#include <cstdint>
 using namespace DirectX;
 
-Mesh::Mesh() :
-    Entity(),
+Mesh::Mesh(TransformSystem& transformSystem) :
+    Entity(transformSystem),
     pMaterial(nullptr),
-    collisionType(COLLISION::NONE)
+    collisionType(COLLISION::NONE),
+    boundsVersion(0xFFFFFFFFu),
+    geometryRevision(0xFFFFFFFFu),
+    hasLocalBounds(false)
 {
 }
 
@@ -20,45 +25,48 @@ void Mesh::Update(const GDXDevice* device)
     Entity::Update(device);
 
     // Mesh-spezifisch: Collision Box aktualisieren
-    if (collisionType != COLLISION::NONE) {
-        CalculateOBB(0);
-    }
+    UpdateBounds();
 }
 
 // ← Version 2: Rendering-Update mit Custom MatrixSet
-void Mesh::Update(const GDXDevice* device, const MatrixSet* inMatrixSet)
+void Mesh::Update(const GDXDevice* device, const MatrixSet* inMatrixSet, const XMMATRIX* localMatrix)
 {
     if (!isActive) return;
     if (!device || !inMatrixSet) return;
 
-    // Collision Box aktualisieren
-    if (collisionType != COLLISION::NONE) {
-        CalculateOBB(0);
-    }
+    // Collision box is updated in GDXEngine::UpdateWorld, not per pass
 
     // Lokales Copy (verhindert, dass du externen Speicher “brauchst”)
     MatrixSet ms = *inMatrixSet;
 
-    // World kommt IMMER aus dem Mesh-Transform
-    ms.worldMatrix = transform.GetLocalTransformationMatrix();
+    // World ALWAYS comes from the mesh transform (cached in the TransformSystem)
+    ms.worldMatrix = transform.GetWorldMatrix();
+    // The local (dequantize) matrix only applies to positions
+    ms.normalMatrix = ms.worldMatrix;
+    if (localMatrix)
+        ms.worldMatrix = XMMatrixMultiply(*localMatrix, ms.worldMatrix);
 
-    if (constantBuffer)
-    {
-        D3D11_MAPPED_SUBRESOURCE mapped{};
-        HRESULT hr = device->GetDeviceContext()->Map(
-            constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+    Upload(device, ms);
+}
 
-        if (FAILED(hr)) {
-            Debug::LogHr(__FILE__, __LINE__, hr);
-            return;
-        }
+void Mesh::Upload(const GDXDevice* device, const MatrixSet& matrixSet)
+{
+    if (!device || !constantBuffer)
+        return;
 
-        memcpy(mapped.pData, &ms, sizeof(MatrixSet));
-        device->GetDeviceContext()->Unmap(constantBuffer, 0);
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    HRESULT hr = device->Map(constantBuffer, D3D11_MAP_WRITE_DISCARD, &mapped);
 
-        device->GetDeviceContext()->VSSetConstantBuffers(0, 1, &constantBuffer);
-        device->GetDeviceContext()->PSSetConstantBuffers(0, 1, &constantBuffer);
+    if (FAILED(hr)) {
+        Debug::LogHr(__FILE__, __LINE__, hr);
+        return;
     }
+
+    memcpy(mapped.pData, &matrixSet, sizeof(MatrixSet));
+    device->Unmap(constantBuffer);
+
+    device->VSSetConstantBuffers(0, 1, &constantBuffer);
+    device->PSSetConstantBuffers(0, 1, &constantBuffer);
 }
 
 
@@ -78,50 +86,137 @@ Surface* Mesh::GetSurface(unsigned int n)
 void Mesh::AddSurfaceToMesh(Surface* surface)
 {
     this->surfaces.push_back(surface);
+    InvalidateBounds();
 }
 
 void Mesh::SetCollisionMode(COLLISION collision)
 {
     collisionType = collision;
+    InvalidateBounds();
 }
 
-void Mesh::CalculateOBB(unsigned int index)
+void Mesh::UpdateBounds()
 {
-    using namespace DirectX;
-    XMFLOAT3 minSize{ 0.0f, 0.0f, 0.0f };
-    XMFLOAT3 maxSize{ 0.0f, 0.0f, 0.0f };
-
-    if (this->surfaces.empty()) return;
-
-    this->GetSurface(0)->CalculateSize(XMMatrixIdentity(), minSize, maxSize);
-
-    // Center und Extents
-    XMFLOAT3 extents{
-        (maxSize.x - minSize.x) / 2.0f,
-        (maxSize.y - minSize.y) / 2.0f,
-        (maxSize.z - minSize.z) / 2.0f
-    };
-
-    // Extrahiere Skalierungsfaktoren
-    XMMATRIX scalingMatrix = transform.GetScaling();
-    float scaleX = XMVectorGetX(scalingMatrix.r[0]);
-    float scaleY = XMVectorGetY(scalingMatrix.r[1]);
-    float scaleZ = XMVectorGetZ(scalingMatrix.r[2]);
-
-    // Wende Skalierung auf Extents an
-    extents.x *= scaleX;
-    extents.y *= scaleY;
-    extents.z *= scaleZ;
-
-    XMFLOAT3 pos;
-    XMStoreFloat3(&pos, transform.GetPosition());
-    XMVECTOR quat = XMQuaternionRotationMatrix(transform.GetRotation());
-    XMFLOAT4 quatFloat;
-    XMStoreFloat4(&quatFloat, quat);
-
-    obb = BoundingOrientedBox(pos, extents,
-        XMFLOAT4(quatFloat.x, quatFloat.y, quatFloat.z, quatFloat.w)
-    );
+    // Not swept yet? Do it now so the version is current
+    TransformSystem& ts = transform.GetSystem();
+    const TransformSystem::Handle handle = transform.GetHandle();
+    if (ts.IsDirty(handle))
+        ts.GetWorldMatrix(handle);
+
+    // Geometry: only compare the surfaces' revisions (O(surfaces), no vertices)
+    const uint32_t geometry = GetGeometryRevision();
+    const uint32_t version = ts.GetVersion(handle);
+    if (version == boundsVersion && geometry == geometryRevision)
+        return;
+
+    if (geometry != geometryRevision)
+    {
+        MergeLocalBounds();
+        geometryRevision = geometry;
+    }
+
+    CalculateAABB();
+
+    if (collisionType != COLLISION::NONE)
+        CalculateOBB();
+
+    boundsVersion = version;
+}
+
+// boost::hash_combine: order-dependent, so swapped or replaced surfaces
+// change the result even when the revisions add up to the same sum
+static void HashCombine(uint32_t& seed, uint32_t value)
+{
+    seed ^= value + 0x9e3779b9u + (seed << 6) + (seed >> 2);
+}
+
+uint32_t Mesh::GetGeometryRevision() const
+{
+    uint32_t revision = static_cast<uint32_t>(surfaces.size());
+    for (const Surface* surface : surfaces)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(surface);
+        HashCombine(revision, static_cast<uint32_t>(address));
+        HashCombine(revision, static_cast<uint32_t>(static_cast<uint64_t>(address) >> 32));
+        HashCombine(revision, surface ? surface->GetBoundsRevision() : 0u);
+    }
+
+    // 0xFFFFFFFF marks invalidated bounds (InvalidateBounds)
+    return revision == 0xFFFFFFFFu ? 0xFFFFFFFEu : revision;
+}
+
+void Mesh::MergeLocalBounds()
+{
+    hasLocalBounds = false;
+
+    XMVECTOR localMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR localMax = XMVectorReplicate(-FLT_MAX);
+
+    for (const Surface* surface : surfaces)
+    {
+        if (!surface || !surface->HasLocalBounds())
+            continue;
+
+        const BoundingBox& box = surface->GetLocalBox();
+        const XMVECTOR center = XMLoadFloat3(&box.Center);
+        const XMVECTOR extents = XMLoadFloat3(&box.Extents);
+        localMin = XMVectorMin(localMin, XMVectorSubtract(center, extents));
+        localMax = XMVectorMax(localMax, XMVectorAdd(center, extents));
+
+        if (!hasLocalBounds)
+            localSphere = surface->GetLocalSphere();
+        else
+            BoundingSphere::CreateMerged(localSphere, localSphere, surface->GetLocalSphere());
+
+        hasLocalBounds = true;
+    }
+
+    if (!hasLocalBounds)
+    {
+        localBox = BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+        localSphere = BoundingSphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f);
+        return;
+    }
+
+    XMStoreFloat3(&localBox.Center, XMVectorScale(XMVectorAdd(localMin, localMax), 0.5f));
+    XMStoreFloat3(&localBox.Extents, XMVectorScale(XMVectorSubtract(localMax, localMin), 0.5f));
+}
+
+void Mesh::CalculateAABB()
+{
+    XMMATRIX world = transform.GetWorldMatrix();
+
+    if (!hasLocalBounds)
+    {
+        XMStoreFloat3(&aabb.Center, world.r[3]);
+        aabb.Extents = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    // Arvo: transform the center, combine the extents with |M| (3x3)
+    XMVECTOR center = XMLoadFloat3(&localBox.Center);
+    XMVECTOR extents = XMLoadFloat3(&localBox.Extents);
+
+    XMVECTOR worldCenter = XMVector3Transform(center, world);
+    XMVECTOR worldExtents = XMVectorMultiply(XMVectorAbs(world.r[0]), XMVectorSplatX(extents));
+    worldExtents = XMVectorMultiplyAdd(XMVectorAbs(world.r[1]), XMVectorSplatY(extents), worldExtents);
+    worldExtents = XMVectorMultiplyAdd(XMVectorAbs(world.r[2]), XMVectorSplatZ(extents), worldExtents);
+
+    XMStoreFloat3(&aabb.Center, worldCenter);
+    XMStoreFloat3(&aabb.Extents, worldExtents);
+}
+
+void Mesh::CalculateOBB()
+{
+    if (!hasLocalBounds) return;
+
+    // Transform the local box with the world matrix: this covers rotation, per-axis
+    // scale and a box center away from the pivot
+    const XMMATRIX world = transform.GetWorldMatrix();
+
+    const BoundingOrientedBox localObb(localBox.Center, localBox.Extents, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+    localObb.Transform(obb, world);
+    localSphere.Transform(sphere, world);
 }
 
 bool Mesh::CheckCollision(Mesh* mesh)
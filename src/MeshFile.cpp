@@ -0,0 +1,388 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MeshFile
+{
+    static uint64_t AlignUp(uint64_t value)
+    {
+        return (value + ALIGNMENT - 1) & ~static_cast<uint64_t>(ALIGNMENT - 1);
+    }
+
+    static bool SetError(std::string* error, const char* message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    }
+
+    // ==================== WRITER ====================
+
+    void Writer::AddLevel(float screenSize, float error)
+    {
+        LevelRecord level = {};
+        level.firstSurface = static_cast<uint32_t>(m_surfaces.size());
+        level.screenSize = screenSize;
+        level.error = error;
+        m_levels.push_back(level);
+    }
+
+    void Writer::AddSurface(CookedSurface&& surface)
+    {
+        if (m_levels.empty())
+            AddLevel(0.0f, 0.0f);
+
+        surface.record.alias = NO_ALIAS;
+        m_surfaces.push_back(std::move(surface));
+        ++m_levels.back().surfaceCount;
+    }
+
+    void Writer::AddAlias(uint32_t surfaceIndex)
+    {
+        if (m_levels.empty())
+            AddLevel(0.0f, 0.0f);
+
+        CookedSurface alias;
+        alias.record.alias = surfaceIndex;
+        m_surfaces.push_back(std::move(alias));
+        ++m_levels.back().surfaceCount;
+    }
+
+    bool Writer::Serialize(std::vector<uint8_t>& out, std::string* error) const
+    {
+        if (m_levels.empty() || m_levels[0].surfaceCount == 0)
+            return SetError(error, "no surfaces");
+        if (m_material.size() >= MAX_NAME)
+            return SetError(error, "material name too long");
+
+        // Every level replaces the base surfaces 1:1 (Mesh::lods)
+        const uint32_t perLevel = m_levels[0].surfaceCount;
+        for (const LevelRecord& level : m_levels) {
+            if (level.surfaceCount != perLevel)
+                return SetError(error, "levels differ in surface count");
+        }
+
+        for (size_t i = 0; i < m_surfaces.size(); ++i) {
+            const uint32_t alias = m_surfaces[i].record.alias;
+            if (alias != NO_ALIAS && (alias >= i || m_surfaces[alias].record.alias != NO_ALIAS))
+                return SetError(error, "invalid surface alias");
+        }
+
+        // Layout: header | levels | surfaces | streams (each ALIGNMENT)
+        Header header = {};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.levelCount = static_cast<uint32_t>(m_levels.size());
+        header.surfaceCount = static_cast<uint32_t>(m_surfaces.size());
+        header.levelOffset = sizeof(Header);
+        header.surfaceOffset = header.levelOffset + m_levels.size() * sizeof(LevelRecord);
+        std::memcpy(header.material, m_material.c_str(), m_material.size());
+
+        std::vector<SurfaceRecord> records(m_surfaces.size());
+        uint64_t offset = AlignUp(header.surfaceOffset + records.size() * sizeof(SurfaceRecord));
+
+        for (size_t i = 0; i < m_surfaces.size(); ++i) {
+            records[i] = m_surfaces[i].record;
+            for (uint32_t s = 0; s < STREAM_COUNT; ++s) {
+                StreamRecord& stream = records[i].streams[s];
+                const std::vector<uint8_t>& data = m_surfaces[i].streams[s];
+                stream.offset = data.empty() ? 0 : offset;
+                stream.size = data.size();
+                stream.reserved = 0;
+                if (data.empty())
+                    stream.stride = 0;
+                offset = AlignUp(offset + data.size());
+            }
+        }
+        header.fileSize = offset;
+
+        // Overall box of the base surfaces (level 0)
+        float lo[3] = { 0.0f, 0.0f, 0.0f }, hi[3] = { 0.0f, 0.0f, 0.0f };
+        for (uint32_t i = 0; i < perLevel; ++i) {
+            const SurfaceRecord& record = records[i];
+            for (int a = 0; a < 3; ++a) {
+                const float minA = record.boxCenter[a] - record.boxExtents[a];
+                const float maxA = record.boxCenter[a] + record.boxExtents[a];
+                lo[a] = i == 0 ? minA : (std::min)(lo[a], minA);
+                hi[a] = i == 0 ? maxA : (std::max)(hi[a], maxA);
+            }
+        }
+        for (int a = 0; a < 3; ++a) {
+            header.boxCenter[a] = (lo[a] + hi[a]) * 0.5f;
+            header.boxExtents[a] = (hi[a] - lo[a]) * 0.5f;
+        }
+
+        out.assign(static_cast<size_t>(header.fileSize), 0);
+        std::memcpy(out.data(), &header, sizeof(Header));
+        std::memcpy(out.data() + header.levelOffset, m_levels.data(), m_levels.size() * sizeof(LevelRecord));
+        std::memcpy(out.data() + header.surfaceOffset, records.data(), records.size() * sizeof(SurfaceRecord));
+
+        for (size_t i = 0; i < m_surfaces.size(); ++i) {
+            for (uint32_t s = 0; s < STREAM_COUNT; ++s) {
+                const std::vector<uint8_t>& data = m_surfaces[i].streams[s];
+                if (!data.empty())
+                    std::memcpy(out.data() + records[i].streams[s].offset, data.data(), data.size());
+            }
+        }
+        return true;
+    }
+
+    bool Writer::Save(const char* path, std::string* error) const
+    {
+        std::vector<uint8_t> bytes;
+        if (!Serialize(bytes, error))
+            return false;
+
+        FILE* file = std::fopen(path, "wb");
+        if (!file)
+            return SetError(error, "cannot open file for writing");
+
+        const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        const bool closed = std::fclose(file) == 0;
+        if (!written || !closed)
+            return SetError(error, "write failed");
+        return true;
+    }
+
+    // ==================== MAPPED FILE ====================
+
+#ifdef _WIN32
+    bool MappedFile::Open(const char* path)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file = file;
+        m_mapping = mapping;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(static_cast<HANDLE>(m_mapping));
+        if (m_file)
+            CloseHandle(static_cast<HANDLE>(m_file));
+        m_data = nullptr;
+        m_size = 0;
+        m_file = nullptr;
+        m_mapping = nullptr;
+    }
+#else
+    bool MappedFile::Open(const char* path)
+    {
+        Close();
+
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping stays valid without an open descriptor
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data)
+            ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
+
+    // ==================== READER ====================
+
+    bool Reader::Open(const char* path)
+    {
+        Close();
+        if (!m_file.Open(path))
+            return Fail("cannot map file");
+        return Open(m_file.GetData(), m_file.GetSize());
+    }
+
+    bool Reader::Open(const uint8_t* data, size_t size)
+    {
+        m_data = data;
+        m_size = size;
+        if (!Validate()) {
+            m_data = nullptr;
+            m_size = 0;
+            m_header = nullptr;
+            m_levels = nullptr;
+            m_surfaces = nullptr;
+            m_file.Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Reader::Close()
+    {
+        m_file.Close();
+        m_data = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+        m_levels = nullptr;
+        m_surfaces = nullptr;
+        m_error.clear();
+    }
+
+    const void* Reader::GetStream(const SurfaceRecord& surface, Stream stream) const
+    {
+        const StreamRecord& record = surface.streams[stream];
+        return record.size ? m_data + record.offset : nullptr;
+    }
+
+    bool Reader::Fail(const char* message)
+    {
+        m_error = message;
+        return false;
+    }
+
+    bool Reader::Validate()
+    {
+        if (m_size < sizeof(Header))
+            return Fail("file too small");
+
+        // The mapping starts page-aligned, all records sit on 8 bytes
+        if (reinterpret_cast<uintptr_t>(m_data) % alignof(SurfaceRecord) != 0)
+            return Fail("data not aligned");
+
+        const Header* header = reinterpret_cast<const Header*>(m_data);
+        if (header->magic != MAGIC)
+            return Fail("not a mesh file");
+        if (header->version != VERSION)
+            return Fail("unsupported version (recook)");
+        if (header->fileSize != m_size)
+            return Fail("file size mismatch");
+        if (header->material[MAX_NAME - 1] != 0)
+            return Fail("material name not terminated");
+        if (header->levelCount == 0 || header->surfaceCount == 0)
+            return Fail("no surfaces");
+
+        // Records inside the file (counts are 32 bits, no overflow in 64 bits)
+        const uint64_t levelBytes = uint64_t(header->levelCount) * sizeof(LevelRecord);
+        const uint64_t surfaceBytes = uint64_t(header->surfaceCount) * sizeof(SurfaceRecord);
+        if (header->levelOffset % alignof(LevelRecord) != 0 || header->surfaceOffset % alignof(SurfaceRecord) != 0 ||
+            header->levelOffset > m_size || levelBytes > m_size - header->levelOffset ||
+            header->surfaceOffset > m_size || surfaceBytes > m_size - header->surfaceOffset)
+            return Fail("records out of range");
+
+        const LevelRecord* levels = reinterpret_cast<const LevelRecord*>(m_data + header->levelOffset);
+        const SurfaceRecord* surfaces = reinterpret_cast<const SurfaceRecord*>(m_data + header->surfaceOffset);
+
+        const uint32_t perLevel = levels[0].surfaceCount;
+        if (perLevel == 0 || uint64_t(perLevel) * header->levelCount != header->surfaceCount)
+            return Fail("level surface count mismatch");
+        for (uint32_t i = 0; i < header->levelCount; ++i) {
+            if (levels[i].surfaceCount != perLevel || levels[i].firstSurface != i * perLevel)
+                return Fail("level surface count mismatch");
+        }
+
+        for (uint32_t i = 0; i < header->surfaceCount; ++i) {
+            const SurfaceRecord& surface = surfaces[i];
+
+            if (surface.alias != NO_ALIAS) {
+                if (surface.alias >= i || surfaces[surface.alias].alias != NO_ALIAS)
+                    return Fail("invalid surface alias");
+                for (uint32_t s = 0; s < STREAM_COUNT; ++s) {
+                    if (surface.streams[s].size != 0)
+                        return Fail("alias with streams");
+                }
+                continue;
+            }
+
+            // Bits of VertexFormat (interleaved, quantized)
+            if (surface.vertexFormat > 3u)
+                return Fail("unknown vertex format");
+            if (surface.vertexCount == 0 || surface.indexCount == 0 || surface.indexCount % 3 != 0)
+                return Fail("empty surface");
+            if (surface.indexSize != 2 && surface.indexSize != 4)
+                return Fail("invalid index size");
+            if (surface.indexSize == 2 && surface.vertexCount > 0x10000u)
+                return Fail("16-bit indices for too many vertices");
+
+            const bool interleaved = (surface.vertexFormat & 1u) != 0;
+            for (uint32_t s = 0; s < STREAM_COUNT; ++s) {
+                const StreamRecord& stream = surface.streams[s];
+                if (stream.size == 0)
+                    continue;
+
+                if (stream.offset % ALIGNMENT != 0 || stream.offset > m_size || stream.size > m_size - stream.offset)
+                    return Fail("stream out of range");
+
+                const uint64_t count = s == STREAM_INDEX ? surface.indexCount : surface.vertexCount;
+                if (s == STREAM_INDEX && stream.stride != surface.indexSize)
+                    return Fail("index stride mismatch");
+                if (stream.stride == 0 || uint64_t(stream.stride) * count != stream.size)
+                    return Fail("stream size mismatch");
+
+                // Either one packed buffer or separate streams
+                if (interleaved ? (s >= STREAM_POSITION && s <= STREAM_UV2) : s == STREAM_VERTEX)
+                    return Fail("stream does not match vertex format");
+            }
+
+            if (surface.streams[STREAM_INDEX].size == 0 || (interleaved && surface.streams[STREAM_VERTEX].size == 0))
+                return Fail("missing stream");
+        }
+
+        m_header = header;
+        m_levels = levels;
+        m_surfaces = surfaces;
+        return true;
+    }
+}
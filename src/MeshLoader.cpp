@@ -0,0 +1,248 @@
+#include "MeshLoader.h"
+#include "Mesh.h"
+#include "Surface.h"
+#include "Material.h"
+#include "Shader.h"
+#include "ObjectManager.h"
+#include "BufferManager.h"
+#include "VertexPacking.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace MeshLoader
+{
+    static const DWORD STREAM_FLAGS[] = {
+        D3DVERTEX_POSITION, D3DVERTEX_NORMAL, D3DVERTEX_COLOR, D3DVERTEX_TEX1, D3DVERTEX_TEX2
+    };
+
+    bool HasVertexLayout(const Shader* shader, uint32_t format, bool nullDevice)
+    {
+        return nullDevice || shader->inputlayoutFormats[format] != nullptr;
+    }
+
+    uint32_t ResolveVertexFormat(const Surface* surface, const Shader* shader, bool nullDevice)
+    {
+        if (surface->dynamic)
+            return VERTEX_FORMAT_SEPARATE;
+
+        const bool interleaved = surface->interleaved && HasVertexLayout(shader, VERTEX_FORMAT_INTERLEAVED |
+            (surface->quantizePositions ? VERTEX_FORMAT_QUANTIZED : 0u), nullDevice);
+        const bool quantized = surface->quantizePositions && (shader->flagsVertex & D3DVERTEX_POSITION) &&
+            HasVertexLayout(shader, (interleaved ? VERTEX_FORMAT_INTERLEAVED : 0u) | VERTEX_FORMAT_QUANTIZED, nullDevice);
+
+        return (interleaved ? VERTEX_FORMAT_INTERLEAVED : 0u) | (quantized ? VERTEX_FORMAT_QUANTIZED : 0u);
+    }
+
+    bool Save(const Mesh* mesh, const char* path, bool nullDevice, std::string* error)
+    {
+        const Shader* shader = mesh->pMaterial ? mesh->pMaterial->pRenderShader : nullptr;
+        if (!shader) {
+            if (error) *error = "cannot resolve shader";
+            return false;
+        }
+
+        MeshFile::Writer writer;
+        writer.SetMaterial(mesh->pMaterial->name);
+
+        // Surfaces shared by several levels (not reducible) are written once
+        std::vector<const Surface*> written;
+        auto addSurface = [&](const Surface* surface) {
+            for (size_t i = 0; i < written.size(); ++i) {
+                if (written[i] == surface) {
+                    writer.AddAlias(static_cast<uint32_t>(i));
+                    written.push_back(surface);
+                    return true;
+                }
+            }
+
+            MeshFile::CookedSurface cooked;
+            if (!surface || !surface->Cook(shader->flagsVertex, ResolveVertexFormat(surface, shader, nullDevice), cooked))
+                return false;
+            writer.AddSurface(std::move(cooked));
+            written.push_back(surface);
+            return true;
+        };
+
+        for (const Surface* surface : mesh->surfaces) {
+            if (!addSurface(surface)) {
+                if (error) *error = "surface cannot be cooked (lines or no triangles)";
+                return false;
+            }
+        }
+        for (const MeshLOD& lod : mesh->lods) {
+            writer.AddLevel(lod.screenSize, lod.error);
+            for (const Surface* surface : lod.surfaces) {
+                if (!addSurface(surface)) {
+                    if (error) *error = "LOD surface cannot be cooked";
+                    return false;
+                }
+            }
+        }
+
+        std::string saveError;
+        if (!writer.Save(path, &saveError)) {
+            if (error) *error = std::string(path) + ": " + saveError;
+            return false;
+        }
+        return true;
+    }
+
+    bool MatchesLayout(const MeshFile::Reader& reader, const Shader* shader, bool nullDevice)
+    {
+        static const UINT streamStrides[] = {
+            sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT4), sizeof(DirectX::XMFLOAT2), sizeof(DirectX::XMFLOAT2)
+        };
+
+        const MeshFile::Header& header = reader.GetHeader();
+        for (uint32_t i = 0; i < header.surfaceCount; ++i) {
+            const MeshFile::SurfaceRecord& record = reader.GetSurface(i);
+            if (record.alias != MeshFile::NO_ALIAS)
+                continue;
+
+            const bool packed = (record.vertexFormat & VERTEX_FORMAT_INTERLEAVED) != 0;
+            const bool quantized = (record.vertexFormat & VERTEX_FORMAT_QUANTIZED) != 0;
+            bool matches = HasVertexLayout(shader, record.vertexFormat, nullDevice);
+
+            if (packed) {
+                matches = matches && record.attributes == shader->flagsVertex &&
+                    record.streams[MeshFile::STREAM_VERTEX].stride == VertexPacking::MakeLayout(record.attributes, quantized).stride;
+            }
+            else {
+                for (UINT s = 0; s < 5; ++s) {
+                    if (!(shader->flagsVertex & STREAM_FLAGS[s]))
+                        continue;
+                    const MeshFile::StreamRecord& stream = record.streams[MeshFile::STREAM_POSITION + s];
+                    const UINT stride = (s == 0 && quantized) ? 4 * sizeof(uint16_t) : streamStrides[s];
+                    matches = matches && stream.size != 0 && stream.stride == stride;
+                }
+            }
+
+            if (!matches)
+                return false;
+        }
+        return true;
+    }
+
+    void Build(ObjectManager& objects, BufferManager& buffers, Mesh* mesh,
+        const MeshFile::Reader& reader, const Shader* shader, bool keepGeometry)
+    {
+        const MeshFile::Header& header = reader.GetHeader();
+
+        std::vector<Surface*> loaded(header.surfaceCount, nullptr);
+        for (uint32_t i = 0; i < header.surfaceCount; ++i) {
+            const MeshFile::SurfaceRecord& record = reader.GetSurface(i);
+            if (record.alias != MeshFile::NO_ALIAS) {
+                loaded[i] = loaded[record.alias];
+                continue;
+            }
+
+            Surface* surface = objects.CreateSurface();
+            surface->pMesh = mesh;
+            loaded[i] = surface;
+
+            const bool packed = (record.vertexFormat & VERTEX_FORMAT_INTERLEAVED) != 0;
+            const bool quantized = (record.vertexFormat & VERTEX_FORMAT_QUANTIZED) != 0;
+            surface->interleaved = packed;
+            surface->quantizePositions = quantized;
+            surface->positionsQuantized = quantized;
+            memcpy(&surface->quantization.offset, record.quantizationOffset, sizeof(record.quantizationOffset));
+            memcpy(&surface->quantization.scale, record.quantizationScale, sizeof(record.quantizationScale));
+
+            // GPU buffers straight from the mapped file
+            if (packed) {
+                buffers.CreateBuffer(reader.GetStream(record, MeshFile::STREAM_VERTEX),
+                    record.streams[MeshFile::STREAM_VERTEX].stride, record.vertexCount,
+                    D3D11_BIND_VERTEX_BUFFER, &surface->vertexBuffer);
+                surface->vertexStride = record.streams[MeshFile::STREAM_VERTEX].stride;
+                surface->vertexFlags = record.attributes;
+            }
+            else {
+                ID3D11Buffer** streamBuffers[] = {
+                    &surface->positionBuffer, &surface->normalBuffer, &surface->colorBuffer, &surface->uv1Buffer, &surface->uv2Buffer
+                };
+                for (UINT s = 0; s < 5; ++s) {
+                    if (!(shader->flagsVertex & STREAM_FLAGS[s]))
+                        continue;
+                    const MeshFile::Stream stream = static_cast<MeshFile::Stream>(MeshFile::STREAM_POSITION + s);
+                    buffers.CreateBuffer(reader.GetStream(record, stream), record.streams[stream].stride,
+                        record.vertexCount, D3D11_BIND_VERTEX_BUFFER, streamBuffers[s]);
+                }
+            }
+            surface->size_position = sizeof(DirectX::XMFLOAT3);
+            surface->size_normal = sizeof(DirectX::XMFLOAT3);
+            surface->size_color = sizeof(DirectX::XMFLOAT4);
+            surface->size_uv1 = sizeof(DirectX::XMFLOAT2);
+            surface->size_uv2 = sizeof(DirectX::XMFLOAT2);
+
+            buffers.CreateBuffer(reader.GetStream(record, MeshFile::STREAM_INDEX), record.indexSize,
+                record.indexCount, D3D11_BIND_INDEX_BUFFER, &surface->indexBuffer);
+            surface->indexFormat = record.indexSize == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+            surface->size_listIndex = record.indexCount;
+
+            // CPU copy of positions and indices only
+            if (keepGeometry) {
+                const uint8_t* source = nullptr;
+                UINT stride = sizeof(DirectX::XMFLOAT3);
+                if (record.streams[MeshFile::STREAM_CPU_POSITION].size) {
+                    source = static_cast<const uint8_t*>(reader.GetStream(record, MeshFile::STREAM_CPU_POSITION));
+                }
+                else if (packed) {
+                    const VertexPacking::Layout layout = VertexPacking::MakeLayout(record.attributes, quantized);
+                    if (!quantized && layout.offsetPosition != VertexPacking::NOT_PRESENT) {
+                        source = static_cast<const uint8_t*>(reader.GetStream(record, MeshFile::STREAM_VERTEX)) + layout.offsetPosition;
+                        stride = layout.stride;
+                    }
+                }
+                else if (record.streams[MeshFile::STREAM_POSITION].stride == sizeof(DirectX::XMFLOAT3)) {
+                    source = static_cast<const uint8_t*>(reader.GetStream(record, MeshFile::STREAM_POSITION));
+                }
+
+                if (source) {
+                    surface->position.resize(record.vertexCount);
+                    if (stride == sizeof(DirectX::XMFLOAT3)) {
+                        memcpy(surface->position.data(), source, record.vertexCount * sizeof(DirectX::XMFLOAT3));
+                    }
+                    else {
+                        for (uint32_t v = 0; v < record.vertexCount; ++v)
+                            memcpy(&surface->position[v], source + size_t(v) * stride, sizeof(DirectX::XMFLOAT3));
+                    }
+                }
+
+                surface->indices.resize(record.indexCount);
+                if (record.indexSize == sizeof(uint16_t)) {
+                    const uint16_t* indices = static_cast<const uint16_t*>(reader.GetStream(record, MeshFile::STREAM_INDEX));
+                    for (uint32_t n = 0; n < record.indexCount; ++n)
+                        surface->indices[n] = indices[n];
+                }
+                else {
+                    memcpy(surface->indices.data(), reader.GetStream(record, MeshFile::STREAM_INDEX), record.indexCount * sizeof(uint32_t));
+                }
+                surface->size_listPosition = static_cast<unsigned int>(surface->position.size());
+            }
+
+            DirectX::BoundingBox box;
+            DirectX::BoundingSphere sphere;
+            memcpy(&box.Center, record.boxCenter, sizeof(record.boxCenter));
+            memcpy(&box.Extents, record.boxExtents, sizeof(record.boxExtents));
+            memcpy(&sphere.Center, record.sphereCenter, sizeof(record.sphereCenter));
+            sphere.Radius = record.sphereRadius;
+            surface->SetLocalBounds(box, sphere);
+        }
+
+        // Level 0 = the surfaces of the mesh, then the LOD levels
+        const uint32_t perLevel = reader.GetLevel(0).surfaceCount;
+        for (uint32_t i = 0; i < perLevel; ++i) {
+            objects.AddSurfaceToMesh(mesh, loaded[i]);
+        }
+        for (uint32_t level = 1; level < header.levelCount; ++level) {
+            const MeshFile::LevelRecord& record = reader.GetLevel(level);
+            const std::vector<Surface*> surfaces(loaded.begin() + record.firstSurface,
+                loaded.begin() + record.firstSurface + record.surfaceCount);
+            objects.AddMeshLOD(mesh, surfaces, record.screenSize, record.error);
+        }
+
+        mesh->InvalidateBounds();
+    }
+}
@@ -0,0 +1,435 @@
+#include "MeshOptimizer.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace MeshOptimizer
+{
+    // ==================== ANALYSIS ====================
+
+    CacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+    {
+        CacheStats stats;
+        if (indexCount < 3 || vertexCount == 0)
+            return stats;
+
+        // FIFO via timestamps: a vertex is in the cache as long as fewer than
+        // cacheSize misses happened since it was added
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        uint32_t timestamp = cacheSize + 1;
+        size_t misses = 0;
+        size_t unique = 0;
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            const uint32_t v = indices[i];
+            if (timestamp - cacheTime[v] > cacheSize)
+            {
+                cacheTime[v] = timestamp++;
+                ++misses;
+            }
+
+            if (!referenced[v])
+            {
+                referenced[v] = 1;
+                ++unique;
+            }
+        }
+
+        stats.acmr = float(misses) / float(indexCount / 3);
+        stats.atvr = unique ? float(misses) / float(unique) : 0.0f;
+        return stats;
+    }
+
+    // ==================== VERTEX CACHE (FORSYTH) ====================
+
+    namespace
+    {
+        constexpr int   MAX_CACHE = 32;             // simulated LRU cache for scoring
+        constexpr int   MAX_VALENCE = 32;           // table for the valence bonus
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float LAST_TRI_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+        struct ScoreTables
+        {
+            float cache[MAX_CACHE];
+            float valence[MAX_VALENCE + 1];
+
+            ScoreTables()
+            {
+                for (int i = 0; i < MAX_CACHE; ++i)
+                {
+                    // The 3 vertices of the last triangle get a fixed score,
+                    // otherwise the same triangle strip would always be preferred
+                    cache[i] = (i < 3) ? LAST_TRI_SCORE
+                        : std::pow(1.0f - float(i - 3) / float(MAX_CACHE - 3), CACHE_DECAY_POWER);
+                }
+
+                valence[0] = 0.0f;
+                for (int i = 1; i <= MAX_VALENCE; ++i)
+                    valence[i] = VALENCE_BOOST_SCALE * std::pow(float(i), -VALENCE_BOOST_POWER);
+            }
+        };
+
+        const ScoreTables& Tables()
+        {
+            static const ScoreTables tables;
+            return tables;
+        }
+
+        float VertexScore(int cachePosition, uint32_t remaining)
+        {
+            // No open triangles left: vertex does not count
+            if (remaining == 0)
+                return -1.0f;
+
+            const ScoreTables& tables = Tables();
+            float score = (cachePosition >= 0) ? tables.cache[cachePosition] : 0.0f;
+            score += tables.valence[std::min<uint32_t>(remaining, MAX_VALENCE)];
+            return score;
+        }
+    }
+
+    void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+    {
+        const size_t triCount = indexCount / 3;
+        if (triCount == 0 || vertexCount == 0)
+            return;
+
+        // In place allowed: save the input
+        std::vector<uint32_t> input(indices, indices + triCount * 3);
+
+        // Triangles per vertex (CSR: offset + live count)
+        std::vector<uint32_t> adjOffset(vertexCount + 1, 0);
+        for (uint32_t v : input)
+            ++adjOffset[v + 1];
+        for (size_t v = 0; v < vertexCount; ++v)
+            adjOffset[v + 1] += adjOffset[v];
+
+        std::vector<uint32_t> adjCount(vertexCount, 0);
+        std::vector<uint32_t> adjacency(input.size());
+        for (size_t t = 0; t < triCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = input[t * 3 + k];
+                adjacency[adjOffset[v] + adjCount[v]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            vertexScore[v] = VertexScore(-1, adjCount[v]);
+
+        std::vector<float> triScore(triCount);
+        std::vector<uint8_t> emitted(triCount, 0);
+        for (size_t t = 0; t < triCount; ++t)
+            triScore[t] = vertexScore[input[t * 3]] + vertexScore[input[t * 3 + 1]] + vertexScore[input[t * 3 + 2]];
+
+        uint32_t cache[MAX_CACHE + 3];
+        uint32_t newCache[MAX_CACHE + 3];
+        int cacheCount = 0;
+
+        uint32_t best = static_cast<uint32_t>(std::max_element(triScore.begin(), triScore.end()) - triScore.begin());
+        size_t scanCursor = 0;
+
+        for (size_t out = 0; out < triCount; ++out)
+        {
+            const uint32_t* tri = &input[best * 3];
+            destination[out * 3 + 0] = tri[0];
+            destination[out * 3 + 1] = tri[1];
+            destination[out * 3 + 2] = tri[2];
+            emitted[best] = 1;
+
+            // Remove the triangle from its vertices' adjacency lists
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = tri[k];
+                uint32_t* list = &adjacency[adjOffset[v]];
+                const uint32_t count = adjCount[v];
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (list[i] == best)
+                    {
+                        list[i] = list[count - 1];
+                        break;
+                    }
+                }
+                --adjCount[v];
+            }
+
+            // LRU: new vertices to the front, shift the rest back
+            int newCount = 0;
+            newCache[newCount++] = tri[0];
+            newCache[newCount++] = tri[1];
+            newCache[newCount++] = tri[2];
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t v = cache[i];
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    newCache[newCount++] = v;
+            }
+
+            // Vertices that fell out lose their cache bonus
+            for (int i = MAX_CACHE; i < newCount; ++i)
+                cachePosition[newCache[i]] = -1;
+
+            cacheCount = std::min(newCount, MAX_CACHE);
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                cache[i] = newCache[i];
+                cachePosition[cache[i]] = i;
+            }
+
+            // Update the scores of the affected vertices and their open triangles
+            for (int i = 0; i < newCount; ++i)
+            {
+                const uint32_t v = newCache[i];
+                const float score = VertexScore(cachePosition[v], adjCount[v]);
+                const float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+
+                const uint32_t* list = &adjacency[adjOffset[v]];
+                for (uint32_t a = 0; a < adjCount[v]; ++a)
+                    triScore[list[a]] += delta;
+            }
+
+            // Next triangle: best among the triangles of the cache vertices
+            float bestScore = -1.0f;
+            best = UINT32_MAX;
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t v = cache[i];
+                const uint32_t* list = &adjacency[adjOffset[v]];
+                for (uint32_t a = 0; a < adjCount[v]; ++a)
+                {
+                    if (triScore[list[a]] > bestScore)
+                    {
+                        bestScore = triScore[list[a]];
+                        best = list[a];
+                    }
+                }
+            }
+
+            // Cache without open triangles (new island): first open one in input order
+            if (best == UINT32_MAX)
+            {
+                while (scanCursor < triCount && emitted[scanCursor])
+                    ++scanCursor;
+                if (scanCursor == triCount)
+                    break;
+                best = static_cast<uint32_t>(scanCursor);
+            }
+        }
+    }
+
+    // ==================== OVERDRAW ====================
+
+    namespace
+    {
+        struct Cluster
+        {
+            size_t begin;       // first triangle
+            size_t end;
+            float sortKey;
+        };
+
+        const float* Position(const float* positions, size_t stride, uint32_t v)
+        {
+            return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * stride);
+        }
+    }
+
+    void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+        const float* positions, size_t vertexCount, size_t positionStride, float threshold)
+    {
+        const size_t triCount = indexCount / 3;
+        if (triCount == 0 || vertexCount == 0 || !positions)
+            return;
+
+        std::vector<uint32_t> input(indices, indices + triCount * 3);
+
+        constexpr uint32_t CACHE_SIZE = 16;
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t timestamp = CACHE_SIZE + 1;
+
+        auto triangleMisses = [&](size_t t) -> uint32_t
+            {
+                uint32_t misses = 0;
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t v = input[t * 3 + k];
+                    if (timestamp - cacheTime[v] > CACHE_SIZE)
+                    {
+                        cacheTime[v] = timestamp++;
+                        ++misses;
+                    }
+                }
+                return misses;
+            };
+
+        // Hard boundaries: all 3 vertices miss the cache, the cache is
+        // "cold" there anyway, reordering costs nothing
+        std::vector<size_t> hard;
+        for (size_t t = 0; t < triCount; ++t)
+        {
+            if (triangleMisses(t) == 3)
+                hard.push_back(t);
+        }
+        hard.push_back(triCount);
+
+        // Soft boundaries: split inside a hard cluster as soon as the part so far
+        // reaches at most threshold * ACMR of the whole cluster with a cold cache
+        std::vector<Cluster> clusters;
+        for (size_t h = 0; h + 1 < hard.size(); ++h)
+        {
+            const size_t begin = hard[h];
+            const size_t end = hard[h + 1];
+
+            timestamp += CACHE_SIZE + 1;
+            size_t clusterMisses = 0;
+            for (size_t t = begin; t < end; ++t)
+                clusterMisses += triangleMisses(t);
+
+            const float clusterThreshold = threshold * float(clusterMisses) / float(end - begin);
+
+            timestamp += CACHE_SIZE + 1;
+            size_t start = begin;
+            size_t misses = 0;
+            for (size_t t = begin; t < end; ++t)
+            {
+                misses += triangleMisses(t);
+
+                const float acmr = float(misses) / float(t + 1 - start);
+                if (t + 1 < end && acmr <= clusterThreshold)
+                {
+                    clusters.push_back({ start, t + 1, 0.0f });
+                    start = t + 1;
+                    misses = 0;
+                    timestamp += CACHE_SIZE + 1;
+                }
+            }
+            clusters.push_back({ start, end, 0.0f });
+        }
+
+        // Centroid and normal per cluster (area-weighted)
+        std::vector<float> centroids(clusters.size() * 3);
+        std::vector<float> normals(clusters.size() * 3);
+        float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+        float meshArea = 0.0f;
+
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            float cx = 0.0f, cy = 0.0f, cz = 0.0f;
+            float nx = 0.0f, ny = 0.0f, nz = 0.0f;
+            float area = 0.0f;
+
+            for (size_t t = clusters[c].begin; t < clusters[c].end; ++t)
+            {
+                const float* a = Position(positions, positionStride, input[t * 3 + 0]);
+                const float* b = Position(positions, positionStride, input[t * 3 + 1]);
+                const float* p = Position(positions, positionStride, input[t * 3 + 2]);
+
+                const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                const float e2[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+                const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                const float w = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                cx += (a[0] + b[0] + p[0]) * w;
+                cy += (a[1] + b[1] + p[1]) * w;
+                cz += (a[2] + b[2] + p[2]) * w;
+                nx += n[0]; ny += n[1]; nz += n[2];
+                area += w;
+            }
+
+            const float inv = area > 0.0f ? 1.0f / (3.0f * area) : 0.0f;
+            centroids[c * 3 + 0] = cx * inv;
+            centroids[c * 3 + 1] = cy * inv;
+            centroids[c * 3 + 2] = cz * inv;
+
+            const float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+            const float invLen = len > 0.0f ? 1.0f / len : 0.0f;
+            normals[c * 3 + 0] = nx * invLen;
+            normals[c * 3 + 1] = ny * invLen;
+            normals[c * 3 + 2] = nz * invLen;
+
+            meshCentroid[0] += cx / 3.0f;
+            meshCentroid[1] += cy / 3.0f;
+            meshCentroid[2] += cz / 3.0f;
+            meshArea += area;
+        }
+
+        if (meshArea > 0.0f)
+        {
+            meshCentroid[0] /= meshArea;
+            meshCentroid[1] /= meshArea;
+            meshCentroid[2] /= meshArea;
+        }
+
+        // Outward-facing clusters first: from most directions they occlude the rest
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            clusters[c].sortKey =
+                (centroids[c * 3 + 0] - meshCentroid[0]) * normals[c * 3 + 0] +
+                (centroids[c * 3 + 1] - meshCentroid[1]) * normals[c * 3 + 1] +
+                (centroids[c * 3 + 2] - meshCentroid[2]) * normals[c * 3 + 2];
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(),
+            [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        size_t out = 0;
+        for (const Cluster& cluster : clusters)
+        {
+            const size_t count = (cluster.end - cluster.begin) * 3;
+            memcpy(destination + out, &input[cluster.begin * 3], count * sizeof(uint32_t));
+            out += count;
+        }
+    }
+
+    // ==================== VERTEX FETCH ====================
+
+    size_t OptimizeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+    {
+        std::fill(remap, remap + vertexCount, UINT32_MAX);
+
+        uint32_t next = 0;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            const uint32_t v = indices[i];
+            if (remap[v] == UINT32_MAX)
+                remap[v] = next++;
+        }
+
+        const size_t referenced = next;
+
+        // Keep unreferenced vertices, but behind all used ones
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            if (remap[v] == UINT32_MAX)
+                remap[v] = next++;
+        }
+
+        return referenced;
+    }
+
+    void RemapIndices(uint32_t* destination, const uint32_t* indices, size_t indexCount, const uint32_t* remap)
+    {
+        for (size_t i = 0; i < indexCount; ++i)
+            destination[i] = remap[indices[i]];
+    }
+
+    void RemapVertices(void* destination, const void* vertices, size_t vertexCount, size_t elementSize, const uint32_t* remap)
+    {
+        const uint8_t* src = static_cast<const uint8_t*>(vertices);
+        uint8_t* dst = static_cast<uint8_t*>(destination);
+
+        for (size_t v = 0; v < vertexCount; ++v)
+            memcpy(dst + size_t(remap[v]) * elementSize, src + v * elementSize, elementSize);
+    }
+}
@@ -0,0 +1,385 @@
+#include "MeshSimplifier.h"
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+namespace MeshSimplifier
+{
+    namespace
+    {
+        constexpr float BORDER_WEIGHT = 10.0f;      // border planes weigh more than faces
+        constexpr float FLIP_COS = 0.5f;            // a triangle normal may turn by at most 60°
+        constexpr int   MAX_PASSES = 64;
+
+        enum VertexKind : uint8_t
+        {
+            KIND_MANIFOLD,      // interior, may collapse into any neighbor
+            KIND_BORDER,        // open border, only along the border
+            KIND_LOCKED,        // seam, non-manifold or corner of several borders
+        };
+
+        struct Vec3
+        {
+            float x, y, z;
+        };
+
+        inline Vec3 Sub(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        inline Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+        inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+        // Symmetric 4x4 quadric of a plane sum, w = sum of the weights
+        struct Quadric
+        {
+            float a00, a11, a22, a01, a12, a02;
+            float b0, b1, b2, c;
+            float w;
+        };
+
+        // Plane n * p + d = 0 (n normalized), weight w
+        Quadric PlaneQuadric(const Vec3& n, float d, float w)
+        {
+            Quadric q;
+            q.a00 = n.x * n.x * w; q.a11 = n.y * n.y * w; q.a22 = n.z * n.z * w;
+            q.a01 = n.x * n.y * w; q.a12 = n.y * n.z * w; q.a02 = n.x * n.z * w;
+            q.b0 = n.x * d * w; q.b1 = n.y * d * w; q.b2 = n.z * d * w;
+            q.c = d * d * w;
+            q.w = w;
+            return q;
+        }
+
+        void AddQuadric(Quadric& q, const Quadric& r)
+        {
+            q.a00 += r.a00; q.a11 += r.a11; q.a22 += r.a22;
+            q.a01 += r.a01; q.a12 += r.a12; q.a02 += r.a02;
+            q.b0 += r.b0; q.b1 += r.b1; q.b2 += r.b2;
+            q.c += r.c;
+            q.w += r.w;
+        }
+
+        // Weighted mean of the squared plane distances of p
+        float QuadricError(const Quadric& q, const Vec3& p)
+        {
+            const float e =
+                q.a00 * p.x * p.x + q.a11 * p.y * p.y + q.a22 * p.z * p.z +
+                2.0f * (q.a01 * p.x * p.y + q.a12 * p.y * p.z + q.a02 * p.x * p.z) +
+                2.0f * (q.b0 * p.x + q.b1 * p.y + q.b2 * p.z) + q.c;
+            return std::fabs(e) / (q.w > 0.0f ? q.w : 1.0f);
+        }
+
+        struct PositionKey
+        {
+            uint32_t x, y, z;
+            bool operator==(const PositionKey& o) const { return x == o.x && y == o.y && z == o.z; }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const PositionKey& k) const
+            {
+                return (size_t(k.x) * 73856093u) ^ (size_t(k.y) * 19349663u) ^ (size_t(k.z) * 83492791u);
+            }
+        };
+
+        inline uint64_t EdgeKey(uint32_t a, uint32_t b) { return (uint64_t(a) << 32) | b; }
+
+        struct Collapse
+        {
+            uint32_t v;         // disappears
+            uint32_t t;         // takes over the triangles of v
+            float cost;
+        };
+    }
+
+    size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+        const float* positions, size_t vertexCount, size_t positionStride,
+        size_t targetIndexCount, float targetError, float* resultError)
+    {
+        if (resultError)
+            *resultError = 0.0f;
+
+        std::vector<uint32_t> result(indices, indices + indexCount);
+        auto finish = [&]() -> size_t
+            {
+                if (!result.empty())
+                    memmove(destination, result.data(), result.size() * sizeof(uint32_t));
+                return result.size();
+            };
+
+        if (indexCount < 3 || indexCount % 3 != 0 || targetIndexCount >= indexCount)
+            return finish();
+
+        for (uint32_t index : result)
+        {
+            if (index >= vertexCount)
+                return finish();
+        }
+
+        // ---- Normalize positions to the largest extent (relative error) ----
+        std::vector<Vec3> pos(vertexCount);
+        Vec3 lower = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Vec3 upper = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + i * positionStride);
+            pos[i] = { p[0], p[1], p[2] };
+            lower = { (std::min)(lower.x, p[0]), (std::min)(lower.y, p[1]), (std::min)(lower.z, p[2]) };
+            upper = { (std::max)(upper.x, p[0]), (std::max)(upper.y, p[1]), (std::max)(upper.z, p[2]) };
+        }
+
+        const float extent = (std::max)((std::max)(upper.x - lower.x, upper.y - lower.y), upper.z - lower.z);
+        const float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+        for (Vec3& p : pos)
+            p = { (p.x - lower.x) * scale, (p.y - lower.y) * scale, (p.z - lower.z) * scale };
+
+        // ---- Merge equal positions (seams: several indices, one position) ----
+        std::vector<uint32_t> posId(vertexCount);
+        std::vector<uint32_t> posUsers;         // referenced vertices per position
+        {
+            std::unordered_map<PositionKey, uint32_t, PositionHash> ids;
+            ids.reserve(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                PositionKey key;
+                const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + i * positionStride);
+                memcpy(&key, p, sizeof(key));
+                posId[i] = ids.emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+            }
+            posUsers.assign(ids.size(), 0);
+
+            std::vector<uint8_t> referenced(vertexCount, 0);
+            for (uint32_t index : result)
+            {
+                if (!referenced[index])
+                {
+                    referenced[index] = 1;
+                    posUsers[posId[index]]++;
+                }
+            }
+        }
+
+        // ---- Edge topology over positions: border = edge without an opposite edge ----
+        std::unordered_map<uint64_t, uint32_t> edges;
+        edges.reserve(indexCount);
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                const uint32_t a = posId[result[i + e]];
+                const uint32_t b = posId[result[i + (e + 1) % 3]];
+                edges[EdgeKey(a, b)]++;
+            }
+        }
+
+        auto isBorderEdge = [&edges](uint32_t a, uint32_t b)
+            {
+                return edges.find(EdgeKey(a, b)) != edges.end() && edges.find(EdgeKey(b, a)) == edges.end();
+            };
+
+        const size_t positionCount = posUsers.size();
+        std::vector<uint32_t> borderOut(positionCount, 0), borderIn(positionCount, 0);
+        std::vector<uint8_t> complex(positionCount, 0);
+        for (const auto& edge : edges)
+        {
+            const uint32_t a = static_cast<uint32_t>(edge.first >> 32);
+            const uint32_t b = static_cast<uint32_t>(edge.first & 0xFFFFFFFFu);
+            if (edge.second > 1)
+            {
+                complex[a] = complex[b] = 1;    // non-manifold edge
+            }
+            else if (edges.find(EdgeKey(b, a)) == edges.end())
+            {
+                borderOut[a]++;
+                borderIn[b]++;
+            }
+        }
+
+        std::vector<uint8_t> kind(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            const uint32_t p = posId[i];
+            if (posUsers[p] > 1 || complex[p])
+                kind[i] = KIND_LOCKED;
+            else if (borderOut[p] == 0 && borderIn[p] == 0)
+                kind[i] = KIND_MANIFOLD;
+            else
+                kind[i] = (borderOut[p] == 1 && borderIn[p] == 1) ? KIND_BORDER : KIND_LOCKED;
+        }
+
+        // ---- Quadrics: triangle planes (area-weighted) + planes perpendicular to borders ----
+        std::vector<Quadric> quadrics(vertexCount, Quadric{});
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            const uint32_t tri[3] = { result[i], result[i + 1], result[i + 2] };
+            Vec3 n = Cross(Sub(pos[tri[1]], pos[tri[0]]), Sub(pos[tri[2]], pos[tri[0]]));
+            const float length = std::sqrt(Dot(n, n));
+            if (length == 0.0f)
+                continue;
+            n = { n.x / length, n.y / length, n.z / length };
+
+            const Quadric plane = PlaneQuadric(n, -Dot(n, pos[tri[0]]), length * 0.5f);
+            for (uint32_t v : tri)
+                AddQuadric(quadrics[v], plane);
+
+            for (int e = 0; e < 3; ++e)
+            {
+                const uint32_t a = tri[e], b = tri[(e + 1) % 3];
+                if (!isBorderEdge(posId[a], posId[b]))
+                    continue;
+
+                const Vec3 edge = Sub(pos[b], pos[a]);
+                Vec3 side = Cross(edge, n);
+                const float sideLength = std::sqrt(Dot(side, side));
+                if (sideLength == 0.0f)
+                    continue;
+                side = { side.x / sideLength, side.y / sideLength, side.z / sideLength };
+
+                const Quadric border = PlaneQuadric(side, -Dot(side, pos[a]), Dot(edge, edge) * BORDER_WEIGHT);
+                AddQuadric(quadrics[a], border);
+                AddQuadric(quadrics[b], border);
+            }
+        }
+
+        auto canCollapse = [&](uint32_t v, uint32_t t)
+            {
+                if (kind[v] == KIND_MANIFOLD)
+                    return true;
+                if (kind[v] == KIND_BORDER)
+                    return isBorderEdge(posId[v], posId[t]) || isBorderEdge(posId[t], posId[v]);
+                return false;
+            };
+
+        // ---- Passes: cheapest collapses first, every vertex at most once per pass ----
+        const float errorLimit = targetError * targetError;
+        float maxError = 0.0f;
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t> locked(vertexCount);
+
+        for (int pass = 0; pass < MAX_PASSES && result.size() > targetIndexCount; ++pass)
+        {
+            const size_t triangleCount = result.size() / 3;
+
+            // Triangles per vertex (CSR)
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+            for (uint32_t index : result)
+                adjacencyOffsets[index + 1]++;
+            for (size_t i = 0; i < vertexCount; ++i)
+                adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+            adjacency.resize(result.size());
+            {
+                std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t i = 0; i < result.size(); ++i)
+                    adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            // Per edge the cheaper allowed direction
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int e = 0; e < 3; ++e)
+                {
+                    const uint32_t a = result[i + e], b = result[i + (e + 1) % 3];
+                    const bool ab = canCollapse(a, b);
+                    const bool ba = canCollapse(b, a);
+                    if (!ab && !ba)
+                        continue;
+
+                    const float costAB = ab ? QuadricError(quadrics[a], pos[b]) : FLT_MAX;
+                    const float costBA = ba ? QuadricError(quadrics[b], pos[a]) : FLT_MAX;
+                    if (costAB <= costBA)
+                        collapses.push_back({ a, b, costAB });
+                    else
+                        collapses.push_back({ b, a, costBA });
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(),
+                [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+            for (size_t i = 0; i < vertexCount; ++i)
+                remap[i] = static_cast<uint32_t>(i);
+            std::fill(locked.begin(), locked.end(), uint8_t(0));
+
+            const size_t goal = (result.size() - targetIndexCount) / 3;
+            size_t removed = 0;
+            size_t applied = 0;
+
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse.cost > errorLimit || removed >= goal)
+                    break;
+
+                const uint32_t v = collapse.v;
+                const uint32_t t = collapse.t;
+                if (locked[v] || locked[t])
+                    continue;
+
+                // Triangles around v: which ones disappear, does one of the others flip?
+                const Vec3& target = pos[t];
+                size_t vanishing = 0;
+                bool flips = false;
+
+                for (uint32_t k = adjacencyOffsets[v]; k < adjacencyOffsets[v + 1] && !flips; ++k)
+                {
+                    const uint32_t* tri = &result[adjacency[k] * 3];
+                    const uint32_t c[3] = { remap[tri[0]], remap[tri[1]], remap[tri[2]] };
+                    if (c[0] == c[1] || c[1] == c[2] || c[2] == c[0])
+                        continue;   // already degenerate in this pass
+                    if (c[0] == t || c[1] == t || c[2] == t)
+                    {
+                        ++vanishing;
+                        continue;
+                    }
+
+                    const int corner = c[0] == v ? 0 : (c[1] == v ? 1 : 2);
+                    const Vec3& p1 = pos[c[(corner + 1) % 3]];
+                    const Vec3& p2 = pos[c[(corner + 2) % 3]];
+
+                    const Vec3 before = Cross(Sub(p1, pos[v]), Sub(p2, pos[v]));
+                    const Vec3 after = Cross(Sub(p1, target), Sub(p2, target));
+                    const float lengths = std::sqrt(Dot(before, before) * Dot(after, after));
+                    flips = Dot(before, after) <= FLIP_COS * lengths;
+                }
+
+                if (flips)
+                    continue;
+
+                remap[v] = t;
+                AddQuadric(quadrics[t], quadrics[v]);
+                locked[v] = locked[t] = 1;
+                maxError = (std::max)(maxError, collapse.cost);
+                removed += vanishing;
+                ++applied;
+            }
+
+            if (applied == 0)
+                break;
+
+            // Rewrite indices, remove degenerate triangles (via equal positions too)
+            size_t write = 0;
+            for (size_t i = 0; i < triangleCount; ++i)
+            {
+                const uint32_t a = remap[result[i * 3]];
+                const uint32_t b = remap[result[i * 3 + 1]];
+                const uint32_t c = remap[result[i * 3 + 2]];
+                if (posId[a] == posId[b] || posId[b] == posId[c] || posId[c] == posId[a])
+                    continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        if (resultError)
+            *resultError = std::sqrt(maxError);
+        return finish();
+    }
+}
@@ -0,0 +1,311 @@
+#include "MipGenerator.h"
+#include "JobSystem.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace DirectX;
+
+namespace MipGenerator
+{
+    namespace
+    {
+        // sRGB <-> linear: 256 entries for decoding, 65536 for encoding (linear in
+        // 1/65535 steps, fine enough that every byte survives the round trip)
+        struct ColorTables
+        {
+            float decode[256];
+            float decodeLinear[256];
+            uint8_t encode[65536];
+
+            ColorTables()
+            {
+                for (int i = 0; i < 256; ++i) {
+                    const double c = i / 255.0;
+                    decode[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+                    decodeLinear[i] = static_cast<float>(c);
+                }
+                for (int i = 0; i < 65536; ++i) {
+                    const double l = i / 65535.0;
+                    const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+                    encode[i] = static_cast<uint8_t>(std::lround((std::min)(1.0, (std::max)(0.0, c)) * 255.0));
+                }
+            }
+        };
+
+        const ColorTables& Tables()
+        {
+            static const ColorTables tables;
+            return tables;
+        }
+
+        // Weights of one axis: target pixel i reads index[start[i] .. start[i + 1]) with weight
+        struct Axis
+        {
+            std::vector<uint32_t> start;
+            std::vector<uint32_t> index;
+            std::vector<float> weight;
+        };
+
+        double BesselI0(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 32; ++k) {
+                term *= (x * 0.5 / k) * (x * 0.5 / k);
+                sum += term;
+                if (term < sum * 1e-12)
+                    break;
+            }
+            return sum;
+        }
+
+        double Kaiser(double t)
+        {
+            const double RADIUS = 1.5, ALPHA = 4.0;
+            if (std::fabs(t) >= RADIUS)
+                return 0.0;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(3.14159265358979323846 * t) / (3.14159265358979323846 * t);
+            const double x = t / RADIUS;
+            return sinc * BesselI0(ALPHA * std::sqrt(1.0 - x * x)) / BesselI0(ALPHA);
+        }
+
+        uint32_t Address(int64_t i, uint32_t size, bool wrap)
+        {
+            if (wrap)
+                return static_cast<uint32_t>(((i % size) + size) % size);
+            return static_cast<uint32_t>((std::min)((std::max)(i, int64_t(0)), int64_t(size) - 1));
+        }
+
+        Axis BuildAxis(uint32_t source, uint32_t target, Filter filter, bool wrap)
+        {
+            Axis axis;
+            axis.start.reserve(target + 1);
+            const double scale = double(source) / target;   // source pixels per target pixel
+
+            for (uint32_t i = 0; i < target; ++i) {
+                axis.start.push_back(static_cast<uint32_t>(axis.index.size()));
+                const size_t first = axis.weight.size();
+
+                if (filter == Filter::Box) {
+                    // Area share in [i * scale, (i + 1) * scale)
+                    const double begin = i * scale, end = (i + 1) * scale;
+                    for (int64_t s = static_cast<int64_t>(std::floor(begin)); s < end; ++s) {
+                        const double overlap = (std::min)(end, double(s + 1)) - (std::max)(begin, double(s));
+                        if (overlap <= 1e-9)
+                            continue;
+                        axis.index.push_back(Address(s, source, wrap));
+                        axis.weight.push_back(static_cast<float>(overlap));
+                    }
+                }
+                else {
+                    // Distance in target pixels between the pixel centers
+                    const double center = (i + 0.5) * scale;
+                    const double radius = 1.5 * scale;
+                    for (int64_t s = static_cast<int64_t>(std::floor(center - radius)); s <= static_cast<int64_t>(std::ceil(center + radius)); ++s) {
+                        const double w = Kaiser((s + 0.5 - center) / scale);
+                        if (w == 0.0)
+                            continue;
+                        axis.index.push_back(Address(s, source, wrap));
+                        axis.weight.push_back(static_cast<float>(w));
+                    }
+                }
+
+                double sum = 0.0;
+                for (size_t k = first; k < axis.weight.size(); ++k)
+                    sum += axis.weight[k];
+                for (size_t k = first; k < axis.weight.size(); ++k)
+                    axis.weight[k] = static_cast<float>(axis.weight[k] / sum);
+            }
+            axis.start.push_back(static_cast<uint32_t>(axis.index.size()));
+            return axis;
+        }
+
+        // Source of a level: level 0 as bytes (decoded while reading), then float linear
+        struct Source
+        {
+            const uint8_t* bytes;
+            const XMFLOAT4A* floats;
+            const float* decode;
+            uint32_t width;
+            uint32_t height;
+
+            void AccumulateRow(uint32_t y, float weight, XMFLOAT4A* row, bool first) const
+            {
+                const XMVECTOR w = XMVectorReplicate(weight);
+                if (bytes) {
+                    const uint8_t* p = bytes + size_t(y) * width * 4;
+                    for (uint32_t x = 0; x < width; ++x, p += 4) {
+                        const XMVECTOR v = XMVectorSet(decode[p[0]], decode[p[1]], decode[p[2]], p[3] * (1.0f / 255.0f));
+                        XMStoreFloat4A(&row[x], first ? XMVectorMultiply(v, w) : XMVectorMultiplyAdd(v, w, XMLoadFloat4A(&row[x])));
+                    }
+                }
+                else {
+                    const XMFLOAT4A* p = floats + size_t(y) * width;
+                    for (uint32_t x = 0; x < width; ++x) {
+                        const XMVECTOR v = XMLoadFloat4A(&p[x]);
+                        XMStoreFloat4A(&row[x], first ? XMVectorMultiply(v, w) : XMVectorMultiplyAdd(v, w, XMLoadFloat4A(&row[x])));
+                    }
+                }
+            }
+        };
+
+        // One level linear in float: per target row first vertical (whole source rows,
+        // memory-friendly), then horizontal
+        void FilterLevel(const Source& source, uint32_t width, uint32_t height, const Options& options,
+            std::vector<XMFLOAT4A>& target, JobSystem* jobs)
+        {
+            const Axis horizontal = BuildAxis(source.width, width, options.filter, options.wrap);
+            const Axis vertical = BuildAxis(source.height, height, options.filter, options.wrap);
+            target.resize(size_t(width) * height);
+
+            auto rows = [&](size_t begin, size_t end) {
+                std::vector<XMFLOAT4A> row(source.width);
+                for (size_t y = begin; y < end; ++y) {
+                    for (uint32_t k = vertical.start[y]; k < vertical.start[y + 1]; ++k)
+                        source.AccumulateRow(vertical.index[k], vertical.weight[k], row.data(), k == vertical.start[y]);
+
+                    XMFLOAT4A* out = target.data() + y * width;
+                    for (uint32_t x = 0; x < width; ++x) {
+                        XMVECTOR sum = XMVectorZero();
+                        for (uint32_t k = horizontal.start[x]; k < horizontal.start[x + 1]; ++k)
+                            sum = XMVectorMultiplyAdd(XMLoadFloat4A(&row[horizontal.index[k]]), XMVectorReplicate(horizontal.weight[k]), sum);
+                        // Kaiser overshoots/undershoots
+                        XMStoreFloat4A(&out[x], XMVectorSaturate(sum));
+                    }
+                }
+            };
+
+            // Blocks of about 64K target pixels, small levels in one piece
+            const size_t grain = (std::max)(size_t(1), size_t(65536) / width);
+            if (jobs && height > grain)
+                jobs->ParallelFor(height, grain, rows);
+            else
+                rows(0, height);
+        }
+
+        // Alpha scale with which as many pixels as in level 0 pass the alpha test:
+        // the k-th largest alpha (k = coverage * pixels) is placed exactly on the threshold
+        float CoverageScale(const std::vector<XMFLOAT4A>& level, float coverage, float cutoff)
+        {
+            const size_t count = level.size();
+            const size_t covered = static_cast<size_t>(std::lround(double(coverage) * count));
+            if (covered == 0 || count == 0)
+                return 1.0f;
+
+            std::vector<float> alpha(count);
+            for (size_t i = 0; i < count; ++i)
+                alpha[i] = level[i].w;
+            std::nth_element(alpha.begin(), alpha.begin() + (covered - 1), alpha.end(), std::greater<float>());
+            float kth = alpha[covered - 1];
+
+            // Equal values only pass together: if "all with kth" is farther from the target
+            // than "only the larger ones", the next larger value is placed on the threshold
+            size_t above = 0, atLeast = 0;
+            float next = 2.0f;
+            for (float a : alpha) {
+                above += a > kth;
+                atLeast += a >= kth;
+                if (a > kth)
+                    next = (std::min)(next, a);
+            }
+            if (above > 0 && atLeast - covered > covered - above)
+                kth = next;
+            if (kth <= 0.0f)
+                return 1.0f;
+
+            // Byte = round(alpha * 255) passes from B = ceil(cutoff * 255) on; kth lands at
+            // B - 0.25, safely above the rounding boundary B - 0.5
+            const float threshold = (std::ceil(cutoff * 255.0f) - 0.25f) / 255.0f;
+            return threshold / kth;
+        }
+
+        void EncodeLevel(const std::vector<XMFLOAT4A>& level, uint8_t* out, bool srgb, float alphaScale, uint32_t width, JobSystem* jobs)
+        {
+            const ColorTables& tables = Tables();
+            auto encode = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const XMFLOAT4A& p = level[i];
+                    uint8_t* o = out + i * 4;
+                    if (srgb) {
+                        o[0] = tables.encode[static_cast<uint32_t>(p.x * 65535.0f + 0.5f)];
+                        o[1] = tables.encode[static_cast<uint32_t>(p.y * 65535.0f + 0.5f)];
+                        o[2] = tables.encode[static_cast<uint32_t>(p.z * 65535.0f + 0.5f)];
+                    }
+                    else {
+                        o[0] = static_cast<uint8_t>(p.x * 255.0f + 0.5f);
+                        o[1] = static_cast<uint8_t>(p.y * 255.0f + 0.5f);
+                        o[2] = static_cast<uint8_t>(p.z * 255.0f + 0.5f);
+                    }
+                    o[3] = static_cast<uint8_t>((std::min)(p.w * alphaScale, 1.0f) * 255.0f + 0.5f);
+                }
+            };
+
+            const size_t grain = (std::max)(size_t(1), size_t(65536) / width) * width;
+            if (jobs && level.size() > grain)
+                jobs->ParallelFor(level.size(), grain, encode);
+            else
+                encode(0, level.size());
+        }
+    }
+
+    uint32_t CountLevels(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = (std::max)(width, height); size > 1; size >>= 1)
+            ++levels;
+        return levels;
+    }
+
+    float AlphaCoverage(const uint8_t* rgba, uint32_t width, uint32_t height, float cutoff)
+    {
+        const size_t count = size_t(width) * height;
+        if (count == 0)
+            return 0.0f;
+        const uint32_t threshold = static_cast<uint32_t>(std::ceil(cutoff * 255.0f));
+        size_t covered = 0;
+        for (size_t i = 0; i < count; ++i)
+            covered += rgba[i * 4 + 3] >= threshold;
+        return static_cast<float>(double(covered) / count);
+    }
+
+    void Generate(const uint8_t* rgba, uint32_t width, uint32_t height, MipChain& chain, const Options& options, JobSystem* jobs)
+    {
+        chain.data.clear();
+        chain.levels.clear();
+        if (!rgba || width == 0 || height == 0)
+            return;
+
+        uint32_t levelCount = CountLevels(width, height);
+        if (options.maxLevels != 0)
+            levelCount = (std::min)(levelCount, options.maxLevels);
+
+        size_t bytes = 0;
+        for (uint32_t level = 1, w = width, h = height; level < levelCount; ++level) {
+            w = (std::max)(w / 2, 1u);
+            h = (std::max)(h / 2, 1u);
+            chain.levels.push_back({ w, h, bytes });
+            bytes += size_t(w) * h * 4;
+        }
+        chain.data.resize(bytes);
+        if (chain.levels.empty())
+            return;
+
+        const ColorTables& tables = Tables();
+        const float coverage = options.preserveCoverage ? AlphaCoverage(rgba, width, height, options.alphaCutoff) : 0.0f;
+
+        std::vector<XMFLOAT4A> current, next;
+        Source source = { rgba, nullptr, options.srgb ? tables.decode : tables.decodeLinear, width, height };
+
+        for (const Level& level : chain.levels) {
+            FilterLevel(source, level.width, level.height, options, next, jobs);
+
+            const float scale = options.preserveCoverage ? CoverageScale(next, coverage, options.alphaCutoff) : 1.0f;
+            EncodeLevel(next, chain.data.data() + level.offset, options.srgb, scale, level.width, jobs);
+
+            // Next level from the unrounded, unscaled values
+            current.swap(next);
+            source = { nullptr, current.data(), nullptr, level.width, level.height };
+        }
+    }
+}
@@ -0,0 +1,962 @@
+#include "ModelImporter.h"
+#include "JobSystem.h"
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+
+using namespace DirectX;
+
+namespace ModelImporter
+{
+    static bool SetError(std::string* error, const std::string& message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    }
+
+    static size_t NextPowerOfTwo(size_t value)
+    {
+        size_t result = 16;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    static inline uint64_t HashWord(uint64_t hash, uint32_t word)
+    {
+        return (hash ^ word) * 0x100000001B3ull;
+    }
+
+    template<typename T>
+    static uint64_t HashValue(uint64_t hash, const T& value)
+    {
+        uint32_t words[sizeof(T) / 4];
+        memcpy(words, &value, sizeof(T));
+        for (uint32_t word : words)
+            hash = HashWord(hash, word);
+        return hash;
+    }
+
+    // ==================== NUMBERS ====================
+
+    // 1e0 .. 1e22 are exact as double
+    static const double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    static inline bool IsDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    const char* ParseNumber(const char* p, const char* end, double& value)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0;         // significant digits in mantissa
+        int exponent = 0;
+        bool any = false;
+
+        for (; p < end && IsDigit(*p); ++p) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa)
+                    ++digits;
+            }
+            else {
+                ++exponent;
+            }
+        }
+        if (p < end && *p == '.') {
+            for (++p; p < end && IsDigit(*p); ++p) {
+                any = true;
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    if (mantissa)
+                        ++digits;
+                    --exponent;
+                }
+            }
+        }
+        if (!any)
+            return nullptr;
+
+        // Take the exponent only when digits follow ("1e" is 1 followed by "e")
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* q = p + 1;
+            bool negativeExponent = false;
+            if (q < end && (*q == '-' || *q == '+')) {
+                negativeExponent = *q == '-';
+                ++q;
+            }
+            if (q < end && IsDigit(*q)) {
+                int e = 0;
+                for (; q < end && IsDigit(*q); ++q) {
+                    if (e < 10000)
+                        e = e * 10 + (*q - '0');
+                }
+                exponent += negativeExponent ? -e : e;
+                p = q;
+            }
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (mantissa != 0) {
+            exponent = (std::max)(-400, (std::min)(400, exponent));
+            if (exponent < 0) {
+                int e = -exponent;
+                for (; e > 22; e -= 22)
+                    result /= POW10[22];
+                result /= POW10[e];
+            }
+            else {
+                int e = exponent;
+                for (; e > 22; e -= 22)
+                    result *= POW10[22];
+                result *= POW10[e];
+            }
+        }
+        value = negative ? -result : result;
+        return p;
+    }
+
+    const char* ParseFloat(const char* p, const char* end, float& value)
+    {
+        double result;
+        p = ParseNumber(p, end, result);
+        if (p)
+            value = static_cast<float>(result);
+        return p;
+    }
+
+    // ==================== PRIMITIVES ====================
+
+    void GenerateNormals(Primitive& primitive)
+    {
+        const std::vector<XMFLOAT3>& positions = primitive.positions;
+        std::vector<XMFLOAT3>& normals = primitive.normals;
+        normals.assign(positions.size(), XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+        const std::vector<unsigned int>& indices = primitive.indices;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const unsigned int i0 = indices[i], i1 = indices[i + 1], i2 = indices[i + 2];
+            if (i0 >= positions.size() || i1 >= positions.size() || i2 >= positions.size())
+                continue;
+
+            const XMFLOAT3& a = positions[i0];
+            const XMFLOAT3& b = positions[i1];
+            const XMFLOAT3& c = positions[i2];
+            const float ex = b.x - a.x, ey = b.y - a.y, ez = b.z - a.z;
+            const float fx = c.x - a.x, fy = c.y - a.y, fz = c.z - a.z;
+
+            // Cross product not normalized = twice the area as weight
+            const float nx = ey * fz - ez * fy;
+            const float ny = ez * fx - ex * fz;
+            const float nz = ex * fy - ey * fx;
+            for (unsigned int index : { i0, i1, i2 }) {
+                normals[index].x += nx;
+                normals[index].y += ny;
+                normals[index].z += nz;
+            }
+        }
+
+        for (XMFLOAT3& n : normals) {
+            const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+            if (length > 1e-20f) {
+                n.x /= length;
+                n.y /= length;
+                n.z /= length;
+            }
+            else {
+                n = XMFLOAT3(0.0f, 1.0f, 0.0f);
+            }
+        }
+    }
+
+    void WeldVertices(Primitive& primitive)
+    {
+        const size_t count = primitive.positions.size();
+        if (count == 0)
+            return;
+
+        if (primitive.indices.empty()) {
+            primitive.indices.resize(count);
+            for (size_t i = 0; i < count; ++i)
+                primitive.indices[i] = static_cast<unsigned int>(i);
+        }
+
+        std::vector<XMFLOAT3>& positions = primitive.positions;
+        std::vector<XMFLOAT3>& normals = primitive.normals;
+        std::vector<XMFLOAT4>& colors = primitive.colors;
+        std::vector<XMFLOAT2>& uv1 = primitive.uv1;
+        std::vector<XMFLOAT2>& uv2 = primitive.uv2;
+        const bool hasNormals = normals.size() == count;
+        const bool hasColors = colors.size() == count;
+        const bool hasUV1 = uv1.size() == count;
+        const bool hasUV2 = uv2.size() == count;
+
+        auto hashOf = [&](size_t i) {
+            uint64_t hash = HashValue(0xCBF29CE484222325ull, positions[i]);
+            if (hasNormals) hash = HashValue(hash, normals[i]);
+            if (hasColors) hash = HashValue(hash, colors[i]);
+            if (hasUV1) hash = HashValue(hash, uv1[i]);
+            if (hasUV2) hash = HashValue(hash, uv2[i]);
+            return hash ^ (hash >> 29);
+        };
+        auto equal = [&](size_t a, size_t b) {
+            return memcmp(&positions[a], &positions[b], sizeof(XMFLOAT3)) == 0
+                && (!hasNormals || memcmp(&normals[a], &normals[b], sizeof(XMFLOAT3)) == 0)
+                && (!hasColors || memcmp(&colors[a], &colors[b], sizeof(XMFLOAT4)) == 0)
+                && (!hasUV1 || memcmp(&uv1[a], &uv1[b], sizeof(XMFLOAT2)) == 0)
+                && (!hasUV2 || memcmp(&uv2[a], &uv2[b], sizeof(XMFLOAT2)) == 0);
+        };
+
+        // Open addressing, entries = new index + 1 (0 = free). The streams are
+        // compacted in place: new indices are never larger than the one just read.
+        const size_t capacity = NextPowerOfTwo(count * 2);
+        const size_t mask = capacity - 1;
+        std::vector<uint32_t> table(capacity, 0);
+        std::vector<unsigned int> remap(count);
+        size_t unique = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            size_t slot = static_cast<size_t>(hashOf(i)) & mask;
+            for (;;) {
+                const uint32_t entry = table[slot];
+                if (entry == 0) {
+                    if (unique != i) {
+                        positions[unique] = positions[i];
+                        if (hasNormals) normals[unique] = normals[i];
+                        if (hasColors) colors[unique] = colors[i];
+                        if (hasUV1) uv1[unique] = uv1[i];
+                        if (hasUV2) uv2[unique] = uv2[i];
+                    }
+                    table[slot] = static_cast<uint32_t>(unique + 1);
+                    remap[i] = static_cast<unsigned int>(unique++);
+                    break;
+                }
+                if (equal(entry - 1, i)) {
+                    remap[i] = entry - 1;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+
+        positions.resize(unique);
+        if (hasNormals) normals.resize(unique);
+        if (hasColors) colors.resize(unique);
+        if (hasUV1) uv1.resize(unique);
+        if (hasUV2) uv2.resize(unique);
+
+        for (unsigned int& index : primitive.indices)
+            index = index < count ? remap[index] : 0;
+    }
+
+    void ConvertToLeftHanded(Primitive& primitive)
+    {
+        for (XMFLOAT3& p : primitive.positions)
+            p.z = -p.z;
+        for (XMFLOAT3& n : primitive.normals)
+            n.z = -n.z;
+        std::vector<unsigned int>& indices = primitive.indices;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            std::swap(indices[i + 1], indices[i + 2]);
+    }
+
+    void ConvertToLeftHanded(XMFLOAT4X4& world)
+    {
+        // C = diag(1, 1, -1, 1): element (i, j) changes sign when exactly one of i, j = 2
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                if ((i == 2) != (j == 2))
+                    world.m[i][j] = -world.m[i][j];
+            }
+        }
+    }
+
+    size_t Model::GetTriangleCount() const
+    {
+        size_t triangles = 0;
+        for (const MeshData& mesh : meshes) {
+            for (const Primitive& primitive : mesh.primitives)
+                triangles += primitive.indices.size() / 3;
+        }
+        return triangles;
+    }
+
+    size_t Model::GetVertexCount() const
+    {
+        size_t vertices = 0;
+        for (const MeshData& mesh : meshes) {
+            for (const Primitive& primitive : mesh.primitives)
+                vertices += primitive.positions.size();
+        }
+        return vertices;
+    }
+
+    // ==================== OBJ ====================
+
+    namespace
+    {
+        struct ObjFace
+        {
+            uint32_t firstCorner;
+            uint32_t cornerCount;
+            // Counts of the block before this face (for negative indices)
+            uint32_t positions;
+            uint32_t uvs;
+            uint32_t normals;
+        };
+
+        enum ObjEventType { OBJ_OBJECT, OBJ_MATERIAL, OBJ_LIBRARY };
+
+        // usemtl/o/g/mtllib before face 'face' of the block
+        struct ObjEvent
+        {
+            uint32_t face;
+            ObjEventType type;
+            std::string name;
+        };
+
+        struct ObjChunk
+        {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+
+            std::vector<XMFLOAT3> positions;
+            std::vector<XMFLOAT4> colors;       // empty or parallel to positions
+            std::vector<XMFLOAT2> uvs;
+            std::vector<XMFLOAT3> normals;
+            std::vector<int32_t> corners;       // v, vt, vn per corner (raw, then absolute, -1 = missing)
+            std::vector<ObjFace> faces;
+            std::vector<ObjEvent> events;
+
+            size_t positionBase = 0;
+            size_t uvBase = 0;
+            size_t normalBase = 0;
+            std::string error;
+        };
+
+        // Face range of a block that belongs to one primitive
+        struct ObjRun
+        {
+            uint32_t chunk;
+            uint32_t faceBegin;
+            uint32_t faceEnd;
+        };
+
+        struct ObjPrimitive
+        {
+            int mesh;
+            int material;
+            std::vector<ObjRun> runs;
+        };
+
+        struct CornerKey
+        {
+            int32_t v, t, n;
+        };
+    }
+
+    static inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static inline const char* SkipSpaces(const char* p, const char* end)
+    {
+        while (p < end && IsSpace(*p))
+            ++p;
+        return p;
+    }
+
+    static inline const char* LineEnd(const char* p, const char* end)
+    {
+        const void* newline = memchr(p, '\n', static_cast<size_t>(end - p));
+        return newline ? static_cast<const char*>(newline) : end;
+    }
+
+    // Rest of the line without whitespace at the ends
+    static std::string RestOfLine(const char* p, const char* end)
+    {
+        p = SkipSpaces(p, end);
+        while (end > p && IsSpace(end[-1]))
+            --end;
+        return std::string(p, end);
+    }
+
+    // Keyword at the start of the line; returns the character after it or nullptr
+    static inline const char* MatchKeyword(const char* p, const char* end, const char* keyword)
+    {
+        for (; *keyword; ++keyword, ++p) {
+            if (p >= end || *p != *keyword)
+                return nullptr;
+        }
+        if (p < end && !IsSpace(*p))
+            return nullptr;
+        return p;
+    }
+
+    static const char* ParseInt(const char* p, const char* end, int32_t& value)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        if (p >= end || !IsDigit(*p))
+            return nullptr;
+        int64_t result = 0;
+        for (; p < end && IsDigit(*p); ++p) {
+            if (result < INT32_MAX)
+                result = result * 10 + (*p - '0');
+        }
+        result = (std::min)(result, static_cast<int64_t>(INT32_MAX));
+        value = static_cast<int32_t>(negative ? -result : result);
+        return p;
+    }
+
+    // Up to count floats; returns the number of values read
+    static int ParseFloats(const char*& p, const char* end, float* values, int count)
+    {
+        int read = 0;
+        while (read < count) {
+            p = SkipSpaces(p, end);
+            const char* next = ParseFloat(p, end, values[read]);
+            if (!next)
+                break;
+            p = next;
+            ++read;
+        }
+        return read;
+    }
+
+    static void ParseObjChunk(ObjChunk& chunk)
+    {
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+
+        while (p < end) {
+            const char* lineEnd = LineEnd(p, end);
+            const char* q = SkipSpaces(p, lineEnd);
+            const char* next = lineEnd < end ? lineEnd + 1 : end;
+
+            if (q >= lineEnd || *q == '#') {
+                p = next;
+                continue;
+            }
+
+            const char* args;
+            if ((args = MatchKeyword(q, lineEnd, "v")) != nullptr) {
+                float values[6];
+                const int read = ParseFloats(args, lineEnd, values, 6);
+                if (read < 3) {
+                    chunk.error = "obj: invalid vertex position";
+                    return;
+                }
+                chunk.positions.emplace_back(values[0], values[1], values[2]);
+                // Vertex colors (v x y z r g b): fill earlier non-color vertices with white
+                if (read >= 6) {
+                    chunk.colors.resize(chunk.positions.size() - 1, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+                    chunk.colors.emplace_back(values[3], values[4], values[5], 1.0f);
+                }
+                else if (!chunk.colors.empty()) {
+                    chunk.colors.emplace_back(1.0f, 1.0f, 1.0f, 1.0f);
+                }
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "vt")) != nullptr) {
+                float values[2] = { 0.0f, 0.0f };
+                if (ParseFloats(args, lineEnd, values, 2) < 1) {
+                    chunk.error = "obj: invalid texture coordinate";
+                    return;
+                }
+                chunk.uvs.emplace_back(values[0], values[1]);
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "vn")) != nullptr) {
+                float values[3];
+                if (ParseFloats(args, lineEnd, values, 3) < 3) {
+                    chunk.error = "obj: invalid normal";
+                    return;
+                }
+                chunk.normals.emplace_back(values[0], values[1], values[2]);
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "f")) != nullptr) {
+                ObjFace face;
+                face.firstCorner = static_cast<uint32_t>(chunk.corners.size() / 3);
+                face.cornerCount = 0;
+                face.positions = static_cast<uint32_t>(chunk.positions.size());
+                face.uvs = static_cast<uint32_t>(chunk.uvs.size());
+                face.normals = static_cast<uint32_t>(chunk.normals.size());
+
+                // v, v/vt, v//vn, v/vt/vn
+                for (;;) {
+                    args = SkipSpaces(args, lineEnd);
+                    if (args >= lineEnd)
+                        break;
+                    int32_t v = 0, t = 0, n = 0;
+                    args = ParseInt(args, lineEnd, v);
+                    if (!args || v == 0) {
+                        chunk.error = "obj: invalid face";
+                        return;
+                    }
+                    if (args < lineEnd && *args == '/') {
+                        ++args;
+                        if (args < lineEnd && *args != '/') {
+                            args = ParseInt(args, lineEnd, t);
+                            if (!args) {
+                                chunk.error = "obj: invalid face";
+                                return;
+                            }
+                        }
+                        if (args < lineEnd && *args == '/') {
+                            args = ParseInt(args + 1, lineEnd, n);
+                            if (!args) {
+                                chunk.error = "obj: invalid face";
+                                return;
+                            }
+                        }
+                    }
+                    chunk.corners.push_back(v);
+                    chunk.corners.push_back(t);
+                    chunk.corners.push_back(n);
+                    ++face.cornerCount;
+                }
+
+                // Ignore lines/points as faces (< 3 corners)
+                if (face.cornerCount >= 3)
+                    chunk.faces.push_back(face);
+                else
+                    chunk.corners.resize(static_cast<size_t>(face.firstCorner) * 3);
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "usemtl")) != nullptr) {
+                chunk.events.push_back({ static_cast<uint32_t>(chunk.faces.size()), OBJ_MATERIAL, RestOfLine(args, lineEnd) });
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "o")) != nullptr ||
+                     (args = MatchKeyword(q, lineEnd, "g")) != nullptr) {
+                chunk.events.push_back({ static_cast<uint32_t>(chunk.faces.size()), OBJ_OBJECT, RestOfLine(args, lineEnd) });
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "mtllib")) != nullptr) {
+                chunk.events.push_back({ static_cast<uint32_t>(chunk.faces.size()), OBJ_LIBRARY, RestOfLine(args, lineEnd) });
+            }
+            // s, l, p, vp and anything unknown: skip
+
+            p = next;
+        }
+
+        if (!chunk.colors.empty())
+            chunk.colors.resize(chunk.positions.size(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+    }
+
+    // Convert raw indices (1-based, negative = relative) into absolute 0-based ones
+    static void ResolveObjChunk(ObjChunk& chunk, size_t positionCount, size_t uvCount, size_t normalCount)
+    {
+        auto resolve = [](int32_t raw, size_t base, uint32_t local, size_t total, int32_t& out) {
+            if (raw == 0) {
+                out = -1;
+                return true;
+            }
+            const int64_t index = raw > 0
+                ? static_cast<int64_t>(raw) - 1
+                : static_cast<int64_t>(base) + local + raw;
+            if (index < 0 || index >= static_cast<int64_t>(total))
+                return false;
+            out = static_cast<int32_t>(index);
+            return true;
+        };
+
+        for (const ObjFace& face : chunk.faces) {
+            int32_t* corner = chunk.corners.data() + static_cast<size_t>(face.firstCorner) * 3;
+            for (uint32_t c = 0; c < face.cornerCount; ++c, corner += 3) {
+                if (!resolve(corner[0], chunk.positionBase, face.positions, positionCount, corner[0]) ||
+                    !resolve(corner[1], chunk.uvBase, face.uvs, uvCount, corner[1]) ||
+                    !resolve(corner[2], chunk.normalBase, face.normals, normalCount, corner[2])) {
+                    chunk.error = "obj: face index out of range";
+                    return;
+                }
+            }
+        }
+    }
+
+    static void ParseMtl(const char* p, const char* end, const std::string& baseDir, Model& model)
+    {
+        MaterialData* material = nullptr;
+
+        while (p < end) {
+            const char* lineEnd = LineEnd(p, end);
+            const char* q = SkipSpaces(p, lineEnd);
+            const char* next = lineEnd < end ? lineEnd + 1 : end;
+            const char* args;
+            float values[3];
+
+            if ((args = MatchKeyword(q, lineEnd, "newmtl")) != nullptr) {
+                MaterialData data;
+                data.name = RestOfLine(args, lineEnd);
+                model.materials.push_back(data);
+                material = &model.materials.back();
+            }
+            else if (!material) {
+                // Ignore lines before the first newmtl
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "Kd")) != nullptr) {
+                if (ParseFloats(args, lineEnd, values, 3) == 3)
+                    material->diffuse = XMFLOAT4(values[0], values[1], values[2], 1.0f);
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "Ks")) != nullptr) {
+                if (ParseFloats(args, lineEnd, values, 3) == 3)
+                    material->specular = XMFLOAT4(values[0], values[1], values[2], 1.0f);
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "Ns")) != nullptr) {
+                if (ParseFloats(args, lineEnd, values, 1) == 1)
+                    material->shininess = values[0];
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "d")) != nullptr) {
+                if (ParseFloats(args, lineEnd, values, 1) == 1) {
+                    material->transparency = values[0];
+                    material->blend = values[0] < 1.0f;
+                }
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "Tr")) != nullptr) {
+                if (ParseFloats(args, lineEnd, values, 1) == 1) {
+                    material->transparency = 1.0f - values[0];
+                    material->blend = values[0] > 0.0f;
+                }
+            }
+            else if ((args = MatchKeyword(q, lineEnd, "map_Kd")) != nullptr) {
+                // Options (-s, -o, ...) before the file name: then the last word counts
+                std::string file = RestOfLine(args, lineEnd);
+                if (!file.empty() && file[0] == '-') {
+                    const size_t space = file.find_last_of(" \t");
+                    file = space == std::string::npos ? std::string() : file.substr(space + 1);
+                }
+                if (!file.empty())
+                    material->texture = baseDir + file;
+            }
+
+            p = next;
+        }
+    }
+
+    static int FindMaterial(Model& model, const std::string& name)
+    {
+        for (size_t i = 0; i < model.materials.size(); ++i) {
+            if (model.materials[i].name == name)
+                return static_cast<int>(i);
+        }
+        // usemtl without an entry in an MTL: default values under this name
+        MaterialData data;
+        data.name = name;
+        model.materials.push_back(data);
+        return static_cast<int>(model.materials.size() - 1);
+    }
+
+    // Weld the corners of a primitive into vertices, split polygons as fans
+    static void BuildObjPrimitive(const ObjPrimitive& build, const std::vector<ObjChunk>& chunks,
+        const std::vector<XMFLOAT3>& positions, const std::vector<XMFLOAT4>& colors,
+        const std::vector<XMFLOAT2>& uvs, const std::vector<XMFLOAT3>& normals,
+        const Options& options, Primitive& primitive)
+    {
+        // Take over UVs/normals only when every corner has them
+        size_t cornerCount = 0;
+        size_t triangleCount = 0;
+        bool allUVs = true;
+        bool allNormals = true;
+        for (const ObjRun& run : build.runs) {
+            const ObjChunk& chunk = chunks[run.chunk];
+            for (uint32_t f = run.faceBegin; f < run.faceEnd; ++f) {
+                const ObjFace& face = chunk.faces[f];
+                const int32_t* corner = chunk.corners.data() + static_cast<size_t>(face.firstCorner) * 3;
+                for (uint32_t c = 0; c < face.cornerCount; ++c, corner += 3) {
+                    allUVs = allUVs && corner[1] >= 0;
+                    allNormals = allNormals && corner[2] >= 0;
+                }
+                cornerCount += face.cornerCount;
+                triangleCount += face.cornerCount - 2;
+            }
+        }
+        const bool hasColors = !colors.empty();
+
+        primitive.material = build.material;
+        primitive.positions.reserve(cornerCount);
+        if (allNormals) primitive.normals.reserve(cornerCount);
+        if (allUVs) primitive.uv1.reserve(cornerCount);
+        if (hasColors) primitive.colors.reserve(cornerCount);
+        primitive.indices.reserve(triangleCount * 3);
+
+        const size_t capacity = NextPowerOfTwo(cornerCount * 2);
+        const size_t mask = capacity - 1;
+        std::vector<CornerKey> keys(capacity, CornerKey{ -1, -1, -1 });
+        std::vector<unsigned int> values(capacity);
+        std::vector<unsigned int> polygon;
+
+        for (const ObjRun& run : build.runs) {
+            const ObjChunk& chunk = chunks[run.chunk];
+            for (uint32_t f = run.faceBegin; f < run.faceEnd; ++f) {
+                const ObjFace& face = chunk.faces[f];
+                const int32_t* corner = chunk.corners.data() + static_cast<size_t>(face.firstCorner) * 3;
+                polygon.clear();
+
+                for (uint32_t c = 0; c < face.cornerCount; ++c, corner += 3) {
+                    const CornerKey key = { corner[0], allUVs ? corner[1] : -1, allNormals ? corner[2] : -1 };
+                    uint64_t hash = HashWord(HashWord(HashWord(0xCBF29CE484222325ull,
+                        static_cast<uint32_t>(key.v)), static_cast<uint32_t>(key.t)), static_cast<uint32_t>(key.n));
+                    size_t slot = static_cast<size_t>(hash ^ (hash >> 29)) & mask;
+
+                    for (;;) {
+                        CornerKey& entry = keys[slot];
+                        if (entry.v < 0) {
+                            entry = key;
+                            values[slot] = static_cast<unsigned int>(primitive.positions.size());
+                            primitive.positions.push_back(positions[key.v]);
+                            if (hasColors)
+                                primitive.colors.push_back(colors[key.v]);
+                            if (allUVs) {
+                                // OBJ: v = 0 at the bottom, D3D: at the top
+                                const XMFLOAT2& uv = uvs[key.t];
+                                primitive.uv1.emplace_back(uv.x, 1.0f - uv.y);
+                            }
+                            if (allNormals)
+                                primitive.normals.push_back(normals[key.n]);
+                            break;
+                        }
+                        if (entry.v == key.v && entry.t == key.t && entry.n == key.n)
+                            break;
+                        slot = (slot + 1) & mask;
+                    }
+                    polygon.push_back(values[slot]);
+                }
+
+                for (size_t c = 1; c + 1 < polygon.size(); ++c) {
+                    primitive.indices.push_back(polygon[0]);
+                    primitive.indices.push_back(polygon[c]);
+                    primitive.indices.push_back(polygon[c + 1]);
+                }
+            }
+        }
+
+        if (!allNormals && options.generateNormals)
+            GenerateNormals(primitive);
+        if (options.leftHanded)
+            ConvertToLeftHanded(primitive);
+    }
+
+    bool ImportOBJ(const char* text, size_t size, const std::string& baseDir, Model& model,
+        const Options& options, JobSystem* jobs, std::string* error)
+    {
+        model = Model();
+        model.sourceBytes = size;
+        if (!text || size == 0)
+            return SetError(error, "obj: empty file");
+
+        // 1. Blocks at line boundaries, parse in parallel
+        std::vector<ObjChunk> chunks;
+        const size_t chunkSize = (std::max)(options.chunkSize, static_cast<size_t>(4096));
+        const char* end = text + size;
+        for (const char* p = text; p < end;) {
+            const char* chunkEnd = p + (std::min)(chunkSize, static_cast<size_t>(end - p));
+            if (chunkEnd < end) {
+                const void* newline = memchr(chunkEnd, '\n', static_cast<size_t>(end - chunkEnd));
+                chunkEnd = newline ? static_cast<const char*>(newline) + 1 : end;
+            }
+            ObjChunk chunk;
+            chunk.begin = p;
+            chunk.end = chunkEnd;
+            chunks.push_back(std::move(chunk));
+            p = chunkEnd;
+        }
+
+        auto parse = [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; ++i)
+                ParseObjChunk(chunks[i]);
+        };
+        if (jobs)
+            jobs->ParallelFor(chunks.size(), 1, parse);
+        else
+            parse(0, chunks.size());
+
+        for (const ObjChunk& chunk : chunks) {
+            if (!chunk.error.empty())
+                return SetError(error, chunk.error);
+        }
+
+        // 2. Sum up the bases, merge the vertex data, resolve the indices
+        size_t positionCount = 0, uvCount = 0, normalCount = 0;
+        bool hasColors = false;
+        for (ObjChunk& chunk : chunks) {
+            chunk.positionBase = positionCount;
+            chunk.uvBase = uvCount;
+            chunk.normalBase = normalCount;
+            positionCount += chunk.positions.size();
+            uvCount += chunk.uvs.size();
+            normalCount += chunk.normals.size();
+            hasColors = hasColors || !chunk.colors.empty();
+        }
+        if (positionCount > static_cast<size_t>(INT32_MAX) || uvCount > static_cast<size_t>(INT32_MAX) ||
+            normalCount > static_cast<size_t>(INT32_MAX))
+            return SetError(error, "obj: too many vertices");
+
+        std::vector<XMFLOAT3> positions, normals;
+        std::vector<XMFLOAT4> colors;
+        std::vector<XMFLOAT2> uvs;
+        positions.reserve(positionCount);
+        uvs.reserve(uvCount);
+        normals.reserve(normalCount);
+        if (hasColors)
+            colors.reserve(positionCount);
+        for (ObjChunk& chunk : chunks) {
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+            if (hasColors) {
+                if (chunk.colors.empty())
+                    colors.resize(colors.size() + chunk.positions.size(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+                else
+                    colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+            }
+            std::vector<XMFLOAT3>().swap(chunk.positions);
+            std::vector<XMFLOAT2>().swap(chunk.uvs);
+            std::vector<XMFLOAT3>().swap(chunk.normals);
+            std::vector<XMFLOAT4>().swap(chunk.colors);
+        }
+
+        auto resolve = [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; ++i)
+                ResolveObjChunk(chunks[i], positionCount, uvCount, normalCount);
+        };
+        if (jobs)
+            jobs->ParallelFor(chunks.size(), 1, resolve);
+        else
+            resolve(0, chunks.size());
+
+        for (const ObjChunk& chunk : chunks) {
+            if (!chunk.error.empty())
+                return SetError(error, chunk.error);
+        }
+
+        // Material libraries before the assignment so usemtl finds the entries
+        for (const ObjChunk& chunk : chunks) {
+            for (const ObjEvent& event : chunk.events) {
+                if (event.type != OBJ_LIBRARY)
+                    continue;
+                MeshFile::MappedFile mtl;
+                if (!mtl.Open((baseDir + event.name).c_str()))
+                    continue;   // missing MTL: materials with default values
+                model.sourceBytes += mtl.GetSize();
+                const char* data = reinterpret_cast<const char*>(mtl.GetData());
+                ParseMtl(data, data + mtl.GetSize(), baseDir, model);
+            }
+        }
+
+        // 3. Assign the faces to the primitives serially: o/g picks the mesh (same name =
+        //    same mesh), usemtl the material and thus the primitive in the mesh
+        std::vector<ObjPrimitive> builds;
+        std::map<std::string, int> meshByName;
+        std::map<std::pair<int, int>, int> buildByKey;
+        std::string meshName;
+        int material = -1;
+        int current = -1;
+
+        auto emit = [&](uint32_t chunk, uint32_t faceBegin, uint32_t faceEnd) {
+            if (faceBegin >= faceEnd)
+                return;
+            if (current < 0) {
+                auto mesh = meshByName.find(meshName);
+                if (mesh == meshByName.end()) {
+                    mesh = meshByName.emplace(meshName, static_cast<int>(model.meshes.size())).first;
+                    MeshData data;
+                    data.name = meshName;
+                    model.meshes.push_back(std::move(data));
+                }
+                const std::pair<int, int> key(mesh->second, material);
+                auto build = buildByKey.find(key);
+                if (build == buildByKey.end()) {
+                    build = buildByKey.emplace(key, static_cast<int>(builds.size())).first;
+                    builds.push_back({ mesh->second, material, {} });
+                }
+                current = build->second;
+            }
+            std::vector<ObjRun>& runs = builds[current].runs;
+            if (!runs.empty() && runs.back().chunk == chunk && runs.back().faceEnd == faceBegin)
+                runs.back().faceEnd = faceEnd;
+            else
+                runs.push_back({ chunk, faceBegin, faceEnd });
+        };
+
+        for (uint32_t c = 0; c < chunks.size(); ++c) {
+            const ObjChunk& chunk = chunks[c];
+            uint32_t faceStart = 0;
+            for (const ObjEvent& event : chunk.events) {
+                if (event.type == OBJ_LIBRARY)
+                    continue;
+                emit(c, faceStart, event.face);
+                faceStart = event.face;
+                if (event.type == OBJ_OBJECT)
+                    meshName = event.name;
+                else
+                    material = FindMaterial(model, event.name);
+                current = -1;
+            }
+            emit(c, faceStart, static_cast<uint32_t>(chunk.faces.size()));
+        }
+
+        // Weld per primitive in parallel
+        std::vector<Primitive> primitives(builds.size());
+        auto build = [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; ++i)
+                BuildObjPrimitive(builds[i], chunks, positions, colors, uvs, normals, options, primitives[i]);
+        };
+        if (jobs)
+            jobs->ParallelFor(builds.size(), 1, build);
+        else
+            build(0, builds.size());
+
+        for (size_t i = 0; i < builds.size(); ++i)
+            model.meshes[builds[i].mesh].primitives.push_back(std::move(primitives[i]));
+
+        XMFLOAT4X4 identity;
+        XMStoreFloat4x4(&identity, XMMatrixIdentity());
+        for (size_t i = 0; i < model.meshes.size(); ++i)
+            model.nodes.push_back({ model.meshes[i].name, static_cast<int>(i), identity });
+
+        return true;
+    }
+
+    // ==================== FILE ====================
+
+    bool Import(const char* path, Model& model, const Options& options, JobSystem* jobs, std::string* error)
+    {
+        if (!path)
+            return SetError(error, "no path");
+
+        std::string file(path);
+        const size_t slash = file.find_last_of("/\\");
+        const std::string baseDir = slash == std::string::npos ? std::string() : file.substr(0, slash + 1);
+        const size_t dot = file.find_last_of('.');
+        std::string extension = dot == std::string::npos || (slash != std::string::npos && dot < slash)
+            ? std::string() : file.substr(dot + 1);
+        for (char& c : extension)
+            c = static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+
+        MeshFile::MappedFile mapped;
+        if (!mapped.Open(path))
+            return SetError(error, "cannot open " + file);
+
+        if (extension == "obj")
+            return ImportOBJ(reinterpret_cast<const char*>(mapped.GetData()), mapped.GetSize(), baseDir, model, options, jobs, error);
+        if (extension == "gltf" || extension == "glb")
+            return ImportGLTF(mapped.GetData(), mapped.GetSize(), baseDir, model, options, jobs, error);
+        return SetError(error, "unknown model format: " + file);
+    }
+}
@@ -0,0 +1,180 @@
+#include "ModelLoader.h"
+#include "gidx.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace ModelLoader
+{
+    bool Load(std::vector<Entity*>& entities, const char* path, Shader* shader, bool optimize)
+    {
+        using namespace Engine;
+
+        entities.clear();
+
+        ModelImporter::Model model;
+        std::string error;
+        if (path == nullptr || !ModelImporter::Import(path, model, ModelImporter::Options(), &engine->GetJS(), &error)) {
+            Debug::Log("ModelLoader.cpp: ERROR - ", path ? path : "(null)", ": ", error.c_str());
+            return false;
+        }
+
+        ObjectManager& om = engine->GetOM();
+
+        // Everything created so far; on failure deleted again (meshes take their surfaces along)
+        std::vector<MATERIAL*> materials(model.materials.size(), nullptr);
+        std::vector<Mesh*> meshes;
+        auto fail = [&](const char* what) {
+            Debug::Log("ModelLoader.cpp: ERROR - ", path, ": ", what);
+            for (Mesh* mesh : meshes)
+                om.DeleteMesh(mesh);
+            for (MATERIAL* material : materials)
+                om.DeleteMaterial(material);
+            entities.clear();
+            return false;
+        };
+
+        // Materials; load the same texture file only once
+        std::vector<std::pair<std::string, LPTEXTURE>> textures;
+        for (size_t i = 0; i < model.materials.size(); ++i) {
+            const ModelImporter::MaterialData& data = model.materials[i];
+            CreateMaterial(&materials[i], shader);
+            MATERIAL* material = materials[i];
+            if (!material)
+                return fail("cannot create material");
+
+            MaterialName(material, data.name.c_str());
+            material->SetDiffuseColor(data.diffuse.x, data.diffuse.y, data.diffuse.z, data.diffuse.w);
+            material->SetSpecularColor(data.specular.x, data.specular.y, data.specular.z, data.specular.w);
+            material->SetShininess(data.shininess);
+            material->SetTransparency(data.transparency);
+            if (data.blend)
+                material->SetRenderQueue(RenderQueueType::Transparent);
+            material->UpdateConstantBuffer(&engine->m_device);
+
+            if (!data.texture.empty()) {
+                LPTEXTURE texture = nullptr;
+                for (const auto& loaded : textures) {
+                    if (loaded.first == data.texture)
+                        texture = loaded.second;
+                }
+                if (!texture) {
+                    const std::wstring file = GXUTIL::Utf8ToWide(data.texture);
+                    LoadTexture(&texture, file.c_str());
+                    textures.emplace_back(data.texture, texture);
+                }
+                if (texture && texture->m_textureView)
+                    MaterialTexture(material, texture);
+            }
+        }
+
+        // Create meshes only when a node uses them: one engine mesh per material
+        struct PendingSurface { Surface* surface; ModelImporter::Primitive* primitive; Shader* shader; };
+        std::vector<PendingSurface> pending;
+        std::vector<std::vector<LPENTITY>> prototypes(model.meshes.size());
+        std::vector<bool> created(model.meshes.size(), false);
+
+        for (const ModelImporter::Node& node : model.nodes) {
+            if (node.mesh < 0 || created[node.mesh])
+                continue;
+            created[node.mesh] = true;
+
+            ModelImporter::MeshData& data = model.meshes[node.mesh];
+            std::vector<int> groups;
+            for (const ModelImporter::Primitive& primitive : data.primitives) {
+                if (std::find(groups.begin(), groups.end(), primitive.material) == groups.end())
+                    groups.push_back(primitive.material);
+            }
+
+            for (int group : groups) {
+                MATERIAL* material = group >= 0 ? materials[group] : om.GetStandardMaterial();
+                LPENTITY entity = nullptr;
+                CreateMesh(&entity, material);
+                if (!entity)
+                    return fail("cannot create mesh");
+                meshes.push_back(static_cast<Mesh*>(entity));
+                prototypes[node.mesh].push_back(entity);
+
+                for (ModelImporter::Primitive& primitive : data.primitives) {
+                    if (primitive.material != group)
+                        continue;
+                    LPSURFACE surface = nullptr;
+                    CreateSurface(&surface, entity);
+                    if (!surface)
+                        return fail("cannot create surface");
+                    pending.push_back({ surface, &primitive, material->pRenderShader });
+                }
+            }
+        }
+
+        // Take over the streams (move), fill in missing shader attributes, optimize: independent per
+        // surface, so on the worker threads. FillBuffer then creates the GPU buffers serially.
+        engine->GetJS().ParallelFor(pending.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Surface* surface = pending[i].surface;
+                ModelImporter::Primitive& primitive = *pending[i].primitive;
+                const DWORD flags = pending[i].shader ? pending[i].shader->flagsVertex : 0;
+                const size_t count = primitive.positions.size();
+
+                if ((flags & D3DVERTEX_NORMAL) && primitive.normals.size() != count)
+                    primitive.normals.assign(count, DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f));
+                if ((flags & D3DVERTEX_COLOR) && primitive.colors.size() != count)
+                    primitive.colors.assign(count, DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+                if ((flags & D3DVERTEX_TEX1) && primitive.uv1.size() != count)
+                    primitive.uv1.assign(count, DirectX::XMFLOAT2(0.0f, 0.0f));
+                if ((flags & D3DVERTEX_TEX2) && primitive.uv2.size() != count)
+                    primitive.uv2.assign(count, DirectX::XMFLOAT2(0.0f, 0.0f));
+
+                surface->SetPositions(std::move(primitive.positions));
+                if (!primitive.normals.empty()) surface->SetNormals(std::move(primitive.normals));
+                if (!primitive.colors.empty()) surface->SetColors(std::move(primitive.colors));
+                if (!primitive.uv1.empty()) surface->SetTexCoords(std::move(primitive.uv1));
+                if (!primitive.uv2.empty()) surface->SetTexCoords2(std::move(primitive.uv2));
+                surface->SetIndices(std::move(primitive.indices));
+
+                if (optimize)
+                    surface->Optimize();
+            }
+        });
+
+        for (const PendingSurface& surface : pending)
+            FillBuffer(surface.surface);
+
+        // Instances: decompose the node's world matrix into position/rotation/scale
+        std::vector<bool> used(model.meshes.size(), false);
+        for (const ModelImporter::Node& node : model.nodes) {
+            if (node.mesh < 0)
+                continue;
+
+            const DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&node.world);
+            DirectX::XMVECTOR scale, rotation, translation;
+            if (!DirectX::XMMatrixDecompose(&scale, &rotation, &translation, world)) {
+                Debug::Log("ModelLoader.cpp: node '", node.name.c_str(), "' has a non-decomposable matrix, using identity");
+                scale = DirectX::XMVectorSplatOne();
+                rotation = DirectX::XMQuaternionIdentity();
+                translation = DirectX::XMVectorZero();
+            }
+
+            for (LPENTITY prototype : prototypes[node.mesh]) {
+                LPENTITY entity = prototype;
+                if (used[node.mesh]) {
+                    entity = nullptr;
+                    CopyEntity(&entity, prototype);
+                    if (!entity)
+                        return fail("cannot copy mesh");
+                    meshes.push_back(static_cast<Mesh*>(entity));
+                }
+                PositionEntity(entity, translation);
+                RotateEntity(entity, rotation);
+                ScaleEntity(entity, DirectX::XMVectorGetX(scale), DirectX::XMVectorGetY(scale), DirectX::XMVectorGetZ(scale));
+                entities.push_back(entity);
+            }
+            used[node.mesh] = true;
+        }
+
+        Debug::Log("ModelLoader.cpp: ", path, ": ", model.nodes.size(), " nodes, ", entities.size(), " meshes, ",
+            model.GetTriangleCount(), " triangles");
+        return true;
+    }
+}
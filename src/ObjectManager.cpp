@@ -1,8 +1,11 @@
 ﻿#include "ObjectManager.h"
+#include "JobSystem.h"
 #include <algorithm>
 using namespace DirectX;
 
-ObjectManager::ObjectManager() {
+ObjectManager::ObjectManager(TransformSystem& transforms) :
+    m_transforms(transforms)
+{
 }
 
 ObjectManager::~ObjectManager()
@@ -57,14 +60,16 @@ Surface* ObjectManager::CreateSurface() {
 }
 
 Mesh* ObjectManager::CreateMesh() {
-    Mesh* mesh = new Mesh;
+    Mesh* mesh = new Mesh(m_transforms);
+    mesh->generation = ++m_meshGeneration;
+    mesh->sceneProxy = m_sceneTree.CreateProxy(mesh->aabb, mesh);
     m_meshes.push_back(mesh);
     m_entities.push_back(mesh);
     return mesh;
 }
 
 Camera* ObjectManager::CreateCamera() {
-    Camera* camera = new Camera;
+    Camera* camera = new Camera(m_transforms);
     m_cameras.push_back(camera);
     m_entities.push_back(camera);
     return camera;
@@ -86,16 +91,166 @@ void ObjectManager::AddSurfaceToMesh(Mesh* mesh, Surface* surface)
 {
     if (!mesh || !surface) return;
 
-    surface->pMesh = mesh;
+    // First assignment = owner, further meshes share the surface (instancing)
+    if (!surface->pMesh)
+        surface->pMesh = mesh;
+    surface->userCount++;
+
     mesh->AddSurfaceToMesh(surface);
+    m_renderQueue.AddSurface(mesh, surface);
 
     // optional (Übergang): surface->pShader weiter setzen, bis alles umgebaut ist
     // surface->pShader = mesh->pShader;
 }
 
+Mesh* ObjectManager::CopyMesh(Mesh* source)
+{
+    if (!source) return nullptr;
+
+    Mesh* copy = CreateMesh();
+    copy->transform = source->transform;
+    copy->SetActive(source->IsActive());
+    copy->SetCollisionMode(source->GetCollisionMode());
+    copy->occluder = source->occluder;
+
+    if (source->pMaterial)
+        AddMeshToMaterial(source->pMaterial, copy);
+
+    // Geometry is not copied: same surface -> one instancing group
+    for (Surface* surface : source->surfaces)
+    {
+        if (surface)
+            AddSurfaceToMesh(copy, surface);
+    }
+
+    // LOD surfaces likewise (same level of several copies -> instancing group)
+    for (const MeshLOD& lod : source->lods)
+        AddMeshLOD(copy, lod.surfaces, lod.screenSize, lod.error);
+
+    return copy;
+}
+
+void ObjectManager::AddMeshLOD(Mesh* mesh, const std::vector<Surface*>& surfaces, float screenSize, float error)
+{
+    if (!mesh) return;
+
+    if (surfaces.size() != mesh->surfaces.size()) {
+        Debug::Log("ERROR: ObjectManager::AddMeshLOD - surface count does not match the mesh");
+        return;
+    }
+
+    // userCount counts meshes: a surface the mesh already uses (not reducible,
+    // in several levels) does not count again
+    auto usedBy = [mesh](Surface* surface)
+        {
+            if (std::find(mesh->surfaces.begin(), mesh->surfaces.end(), surface) != mesh->surfaces.end())
+                return true;
+            for (const MeshLOD& lod : mesh->lods)
+            {
+                if (std::find(lod.surfaces.begin(), lod.surfaces.end(), surface) != lod.surfaces.end())
+                    return true;
+            }
+            return false;
+        };
+
+    for (Surface* surface : surfaces)
+    {
+        if (!surface || usedBy(surface))
+            continue;
+
+        if (!surface->pMesh)
+            surface->pMesh = mesh;
+        surface->userCount++;
+    }
+
+    MeshLOD lod;
+    lod.surfaces = surfaces;
+    lod.screenSize = screenSize;
+    lod.error = error;
+    mesh->lods.push_back(std::move(lod));
+
+    // Rebuild the RenderManager's candidate list
+    m_renderQueue.version++;
+}
+
+void ObjectManager::ClearMeshLODs(Mesh* mesh)
+{
+    if (!mesh || mesh->lods.empty()) return;
+
+    // Give up every LOD surface once (base surfaces stay with the mesh)
+    std::vector<Surface*> released;
+    for (const MeshLOD& lod : mesh->lods)
+    {
+        for (Surface* surface : lod.surfaces)
+        {
+            if (!surface ||
+                std::find(mesh->surfaces.begin(), mesh->surfaces.end(), surface) != mesh->surfaces.end() ||
+                std::find(released.begin(), released.end(), surface) != released.end())
+                continue;
+            released.push_back(surface);
+        }
+    }
+
+    mesh->lods.clear();
+    mesh->lodLevel = 0;
+
+    for (Surface* surface : released)
+        ReleaseSurface(mesh, surface);
+
+    m_renderQueue.version++;
+}
+
+void ObjectManager::ReleaseSurface(Mesh* mesh, Surface* surface)
+{
+    // Shared surface: only drop the reference, switch owners if needed
+    if (surface->userCount > 1)
+    {
+        surface->userCount--;
+        if (surface->pMesh == mesh)
+            surface->pMesh = FindSurfaceUser(surface, mesh);
+        return;
+    }
+
+    surface->pMesh = nullptr;
+
+    auto it = std::find(m_surfaces.begin(), m_surfaces.end(), surface);
+    if (it != m_surfaces.end())
+        m_surfaces.erase(it);
+
+    Memory::SafeDelete(surface);
+}
+
+Mesh* ObjectManager::FindSurfaceUser(Surface* surface, Mesh* except) const
+{
+    for (Mesh* mesh : m_meshes)
+    {
+        if (!mesh || mesh == except)
+            continue;
+
+        if (std::find(mesh->surfaces.begin(), mesh->surfaces.end(), surface) != mesh->surfaces.end())
+            return mesh;
+
+        for (const MeshLOD& lod : mesh->lods)
+        {
+            if (std::find(lod.surfaces.begin(), lod.surfaces.end(), surface) != lod.surfaces.end())
+                return mesh;
+        }
+    }
+    return nullptr;
+}
+
 void ObjectManager::AddMeshToMaterial(Material* material, Mesh* mesh) {
     if (!material || !mesh) return;
 
+    // Mesh changes material: detach it from the old material
+    Material* old = mesh->pMaterial;
+    if (old && old != material)
+    {
+        m_renderQueue.RemoveMesh(old, mesh);
+        auto& v = old->meshes;
+        v.erase(std::remove(v.begin(), v.end(), mesh), v.end());
+    }
+
     // Keep the relationship consistent.
     mesh->pMaterial = material;
 
@@ -106,6 +261,8 @@ void ObjectManager::AddMeshToMaterial(Material* material, Mesh* mesh) {
     // (Rendering walks: shader -> materials -> meshes -> surfaces)
     if (material->pRenderShader)
         AssignShaderToMaterial(material->pRenderShader, material);
+
+    m_renderQueue.AddMesh(material, mesh);
 }
 
 void ObjectManager::AddMaterialToShader(Shader* shader, Material* material)
@@ -116,26 +273,31 @@ void ObjectManager::AddMaterialToShader(Shader* shader, Material* material)
 void ObjectManager::DeleteSurface(Surface* surface) {
     if (!surface) return;
 
-    // Fast path: surface knows its mesh.
-    if (surface->pMesh)
+    // Fast path: surface knows its mesh (not shared).
+    if (surface->pMesh && surface->userCount <= 1)
     {
+        m_renderQueue.RemoveSurface(surface->pMesh, surface);
+
         auto& v = surface->pMesh->surfaces;
         v.erase(std::remove(v.begin(), v.end(), surface), v.end());
         surface->pMesh = nullptr;
     }
     else
     {
-        // Fallback (legacy): search all meshes.
+        // Fallback (legacy / geteilte Surface): search all meshes.
         for (auto& mesh : m_meshes) {
             auto& surfaces = mesh->surfaces;
             for (auto it = surfaces.begin(); it != surfaces.end(); ++it) {
                 if (*it == surface) {
+                    m_renderQueue.RemoveSurface(mesh, surface);
                     surfaces.erase(it);
                     break;
                 }
             }
         }
+        surface->pMesh = nullptr;
     }
+    surface->userCount = 0;
 
     auto it = std::find(m_surfaces.begin(), m_surfaces.end(), surface);
     if (it != m_surfaces.end()) {
@@ -148,6 +310,7 @@ void ObjectManager::DeleteMesh(Mesh* mesh) {
     if (!mesh) return;
 
     UnregisterRenderable(mesh);
+    m_renderQueue.RemoveMesh(mesh->pMaterial, mesh);
 
     // Detach from all materials
     for (auto& material : m_materials) {
@@ -160,16 +323,11 @@ void ObjectManager::DeleteMesh(Mesh* mesh) {
     }
 
     // ObjectManager owns surfaces -> delete all surfaces of this mesh here.
+    ClearMeshLODs(mesh);
     for (auto* s : mesh->surfaces)
     {
-        if (!s) continue;
-        s->pMesh = nullptr;
-
-        auto sit = std::find(m_surfaces.begin(), m_surfaces.end(), s);
-        if (sit != m_surfaces.end())
-            m_surfaces.erase(sit);
-
-        Memory::SafeDelete(s);
+        if (s)
+            ReleaseSurface(mesh, s);
     }
     mesh->surfaces.clear();
 
@@ -182,6 +340,7 @@ void ObjectManager::DeleteMesh(Mesh* mesh) {
     // Remove and delete mesh
     auto it = std::find(m_meshes.begin(), m_meshes.end(), mesh);
     if (it != m_meshes.end()) {
+        m_sceneTree.DestroyProxy(mesh->sceneProxy);
         m_meshes.erase(it);
         Memory::SafeDelete(mesh);
     }
@@ -204,6 +363,8 @@ void ObjectManager::DeleteMaterial(Material* material)
 {
     if (!material) return;
 
+    m_renderQueue.RemoveMaterial(material);
+
     // Detach meshes
     for (auto* mesh : material->meshes) {
         if (mesh && mesh->pMaterial == material)
@@ -226,16 +387,24 @@ void ObjectManager::DeleteMaterial(Material* material)
 }
 
 void ObjectManager::RemoveSurfaceFromMesh(Mesh* mesh, Surface* surface) {
+    m_renderQueue.RemoveSurface(mesh, surface);
+
     auto& surfaces = mesh->surfaces;
     for (auto it = surfaces.begin(); it != surfaces.end(); ++it) {
         if (*it == surface) {
             surfaces.erase(it);
+            if (surface->userCount > 0)
+                surface->userCount--;
+            if (surface->pMesh == mesh)
+                surface->pMesh = FindSurfaceUser(surface, mesh);
             break;
         }
     }
 }
 
 void ObjectManager::RemoveMeshFromMaterial(Material* material, Mesh* mesh) {
+    m_renderQueue.RemoveMesh(material, mesh);
+
     auto& meshes = material->meshes;
     for (auto it = meshes.begin(); it != meshes.end(); ++it) {
         if (*it == mesh) {
@@ -246,6 +415,9 @@ void ObjectManager::RemoveMeshFromMaterial(Material* material, Mesh* mesh) {
 }
 
 void ObjectManager::RemoveMaterialFromShader(Shader* shader, Material* material) {
+    if (material && material->pRenderShader == shader)
+        m_renderQueue.RemoveMaterial(material);
+
     auto& materials = shader->materials;
     for (auto it = materials.begin(); it != materials.end(); ++it) {
         if (*it == material) {
@@ -332,6 +504,26 @@ Material* ObjectManager::GetStandardMaterial() const
     return nullptr;
 }
 
+bool ObjectManager::IsMeshAlive(const Mesh* mesh, uint32_t generation) const
+{
+    if (!mesh)
+        return false;
+    auto it = std::find(m_meshes.begin(), m_meshes.end(), mesh);
+    return it != m_meshes.end() && (*it)->generation == generation;
+}
+
+Material* ObjectManager::FindMaterial(const std::string& name) const
+{
+    if (name.empty())
+        return nullptr;
+
+    for (Material* material : m_materials) {
+        if (material && material->name == name)
+            return material;
+    }
+    return nullptr;
+}
+
 Shader* ObjectManager::GetShader(const Surface& surface) const
 {
     if (surface.pMesh && surface.pMesh->pMaterial)
@@ -363,6 +555,15 @@ void ObjectManager::DeleteShader(Shader* shader)
 {
     if (!shader) return;
 
+    m_renderQueue.RemoveShader(shader);
+
+    // Was the shader registered as an instancing variant? Clear the references
+    for (auto* other : m_shaders)
+    {
+        if (other && other->instancedVariant == shader)
+            other->instancedVariant = nullptr;
+    }
+
     // Alle Materialien, die im Bucket hängen, vom Shader lösen
     for (auto* mat : shader->materials)
     {
@@ -398,6 +599,90 @@ void ObjectManager::AssignShaderToMaterial(Shader* shader, Material* material)
         if (std::find(v.begin(), v.end(), material) == v.end())
             v.push_back(material);
     }
+
+    m_renderQueue.AssignMaterial(shader, material);
+}
+
+// Meshes per block in the parallel bounds update
+static constexpr size_t BOUNDS_GRAIN = 256;
+
+void ObjectManager::UpdateBounds(JobSystem* jobs)
+{
+    const size_t count = m_meshes.size();
+    m_movedMeshes.resize((count + BOUNDS_GRAIN - 1) / BOUNDS_GRAIN);
+    for (auto& moved : m_movedMeshes)
+        moved.clear();
+
+    // Surfaces edited with AddVertex: recompute serially, a surface can belong
+    // to meshes of several blocks
+    for (Surface* surface : m_surfaces)
+        surface->RefreshLocalBounds();
+
+    // Every mesh writes only its own AABB/OBB, the tree is only read.
+    // Each block collects the leaves that left their fat box on its own.
+    auto update = [this](size_t begin, size_t end)
+        {
+            std::vector<Mesh*>& moved = m_movedMeshes[begin / BOUNDS_GRAIN];
+            for (size_t i = begin; i < end; ++i)
+            {
+                Mesh* mesh = m_meshes[i];
+                if (!mesh) continue;
+
+                mesh->UpdateBounds();
+                if (mesh->sceneProxy != AABBTree::NULL_NODE && m_sceneTree.NeedsMove(mesh->sceneProxy, mesh->aabb))
+                    moved.push_back(mesh);
+            }
+        };
+
+    if (jobs)
+        jobs->ParallelFor(count, BOUNDS_GRAIN, update);
+    else
+        update(0, count);
+
+    // Tree changes serially: usually only a few leaves
+    for (const auto& moved : m_movedMeshes)
+    {
+        for (Mesh* mesh : moved)
+            m_sceneTree.MoveProxy(mesh->sceneProxy, mesh->aabb);
+    }
+
+    m_sceneTree.RebuildIfDegraded();
+}
+
+size_t ObjectManager::QueryBox(const BoundingBox& box, std::vector<Mesh*>& out) const
+{
+    out.clear();
+    m_sceneTree.QueryBox(box, [this, &box, &out](uint32_t proxy)
+        {
+            Mesh* mesh = static_cast<Mesh*>(m_sceneTree.GetUserData(proxy));
+            if (mesh->aabb.Intersects(box))
+                out.push_back(mesh);
+        });
+    return out.size();
+}
+
+size_t ObjectManager::QuerySphere(const BoundingSphere& sphere, std::vector<Mesh*>& out) const
+{
+    out.clear();
+    m_sceneTree.QuerySphere(sphere, [this, &sphere, &out](uint32_t proxy)
+        {
+            Mesh* mesh = static_cast<Mesh*>(m_sceneTree.GetUserData(proxy));
+            if (mesh->aabb.Intersects(sphere))
+                out.push_back(mesh);
+        });
+    return out.size();
+}
+
+size_t ObjectManager::QueryFrustum(const Frustum& frustum, std::vector<Mesh*>& out) const
+{
+    out.clear();
+    m_sceneTree.QueryFrustum(frustum, [this, &frustum, &out](uint32_t proxy, bool inside)
+        {
+            Mesh* mesh = static_cast<Mesh*>(m_sceneTree.GetUserData(proxy));
+            if (inside || frustum.IntersectsAABB(mesh->aabb.Center, mesh->aabb.Extents))
+                out.push_back(mesh);
+        });
+    return out.size();
 }
 
 void ObjectManager::RegisterRenderable(Mesh* mesh)
@@ -0,0 +1,407 @@
+#include "OcclusionBuffer.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+// Target rectangle [x0, x1) x [y0, y1) of a Hi-Z level from the previous level (2x2 -> max).
+// Odd sizes: the last column/row is read twice.
+static void Downsample(const float* source, uint32_t sourceWidth, uint32_t sourceHeight,
+    float* target, uint32_t width, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    for (uint32_t y = y0; y < y1; ++y)
+    {
+        const float* row0 = source + size_t(2 * y) * sourceWidth;
+        const float* row1 = source + size_t((std::min)(2 * y + 1, sourceHeight - 1)) * sourceWidth;
+        float* out = target + size_t(y) * width;
+
+        for (uint32_t x = x0; x < x1; ++x)
+        {
+            const uint32_t a = 2 * x;
+            const uint32_t b = (std::min)(a + 1, sourceWidth - 1);
+            out[x] = (std::max)((std::max)(row0[a], row0[b]), (std::max)(row1[a], row1[b]));
+        }
+    }
+}
+
+OcclusionBuffer::OcclusionBuffer()
+{
+    XMStoreFloat4x4(&m_viewProjection, XMMatrixIdentity());
+    Resize(256, 128);
+}
+
+void OcclusionBuffer::Resize(uint32_t width, uint32_t height)
+{
+    m_requestedWidth = width;
+    m_requestedHeight = height;
+
+    m_tilesX = (std::max)(1u, (width + TILE_WIDTH - 1) / TILE_WIDTH);
+    m_tilesY = (std::max)(1u, (height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+    m_width = m_tilesX * TILE_WIDTH;
+    m_height = m_tilesY * TILE_HEIGHT;
+
+    m_depth.assign(size_t(m_width) * m_height, 1.0f);
+    m_bins.resize(size_t(m_tilesX) * m_tilesY);
+
+    // Hi-Z down to 1x1
+    m_levels.clear();
+    size_t offset = 0;
+    uint32_t w = m_width, h = m_height;
+    while (w > 1 || h > 1)
+    {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        m_levels.push_back({ offset, w, h });
+        offset += size_t(w) * h;
+    }
+    m_hiz.assign(offset, 1.0f);
+    m_ready = false;
+}
+
+void OcclusionBuffer::Begin(FXMMATRIX viewProjection)
+{
+    XMStoreFloat4x4(&m_viewProjection, viewProjection);
+    m_occluders.clear();
+    m_stats = OcclusionStats();
+    m_ready = false;
+}
+
+void OcclusionBuffer::AddOccluder(const XMFLOAT3* positions, size_t vertexCount,
+    const unsigned int* indices, size_t indexCount, FXMMATRIX world)
+{
+    if (positions == nullptr || indices == nullptr || vertexCount == 0 || indexCount < 3)
+        return;
+
+    Occluder occluder;
+    occluder.positions = positions;
+    occluder.indices = indices;
+    occluder.vertexCount = vertexCount;
+    occluder.indexCount = indexCount;
+    occluder.firstVertex = 0;
+    occluder.firstTriangle = 0;
+    occluder.triangleCount = 0;
+    if (!m_occluders.empty())
+    {
+        const Occluder& last = m_occluders.back();
+        occluder.firstVertex = last.firstVertex + last.vertexCount;
+        occluder.firstTriangle = last.firstTriangle + last.indexCount / 3 * 2;
+    }
+    XMStoreFloat4x4(&occluder.worldViewProjection, XMMatrixMultiply(world, XMLoadFloat4x4(&m_viewProjection)));
+    m_occluders.push_back(occluder);
+
+    m_stats.occluders++;
+    m_stats.triangles += indexCount / 3;
+}
+
+void OcclusionBuffer::Rasterize(JobSystem* jobs)
+{
+    // Room for all occluders: only grows, no allocation in the steady state
+    if (!m_occluders.empty())
+    {
+        const Occluder& last = m_occluders.back();
+        const size_t vertices = last.firstVertex + last.vertexCount;
+        const size_t triangles = last.firstTriangle + last.indexCount / 3 * 2;
+        if (m_clip.size() < vertices)
+            m_clip.resize(vertices);
+        if (m_triangles.size() < triangles)
+            m_triangles.resize(triangles);
+    }
+
+    const size_t occluderCount = m_occluders.size();
+    auto setup = [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                SetupOccluder(m_occluders[i]);
+        };
+    if (jobs)
+        jobs->ParallelFor(occluderCount, 1, setup);
+    else
+        setup(0, occluderCount);
+
+    // Bin into tiles (serial, one rectangle test per triangle)
+    for (std::vector<uint32_t>& bin : m_bins)
+        bin.clear();
+
+    m_stats.rasterized = 0;
+    for (const Occluder& occluder : m_occluders)
+    {
+        m_stats.rasterized += occluder.triangleCount;
+        for (size_t t = occluder.firstTriangle; t < occluder.firstTriangle + occluder.triangleCount; ++t)
+        {
+            const Triangle& tri = m_triangles[t];
+            for (int ty = tri.minY / int(TILE_HEIGHT); ty <= tri.maxY / int(TILE_HEIGHT); ++ty)
+                for (int tx = tri.minX / int(TILE_WIDTH); tx <= tri.maxX / int(TILE_WIDTH); ++tx)
+                    m_bins[size_t(ty) * m_tilesX + tx].push_back(static_cast<uint32_t>(t));
+        }
+    }
+
+    const size_t tileCount = m_bins.size();
+    auto raster = [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                RasterizeTile(static_cast<uint32_t>(i));
+        };
+    if (jobs)
+        jobs->ParallelFor(tileCount, 1, raster);
+    else
+        raster(0, tileCount);
+
+    // Level 1 comes from the tile jobs, from level 2 on serial (together < 1/3 of level 0)
+    for (size_t l = 1; l < m_levels.size(); ++l)
+    {
+        const Level& source = m_levels[l - 1];
+        const Level& target = m_levels[l];
+        Downsample(m_hiz.data() + source.offset, source.width, source.height,
+            m_hiz.data() + target.offset, target.width, 0, 0, target.width, target.height);
+    }
+    m_ready = true;
+}
+
+void OcclusionBuffer::SetupOccluder(Occluder& occluder)
+{
+    const XMMATRIX matrix = XMLoadFloat4x4(&occluder.worldViewProjection);
+    XMFLOAT4* clip = m_clip.data() + occluder.firstVertex;
+    for (size_t v = 0; v < occluder.vertexCount; ++v)
+        XMStoreFloat4(&clip[v], XMVector3Transform(XMLoadFloat3(&occluder.positions[v]), matrix));
+
+    occluder.triangleCount = 0;
+    for (size_t i = 0; i + 2 < occluder.indexCount; i += 3)
+    {
+        const unsigned int* tri = occluder.indices + i;
+        if (tri[0] >= occluder.vertexCount || tri[1] >= occluder.vertexCount || tri[2] >= occluder.vertexCount)
+            continue;
+
+        const XMFLOAT4 v[3] = { clip[tri[0]], clip[tri[1]], clip[tri[2]] };
+
+        // All three corners outside the same frustum plane
+        if ((v[0].x > v[0].w && v[1].x > v[1].w && v[2].x > v[2].w) ||
+            (v[0].x < -v[0].w && v[1].x < -v[1].w && v[2].x < -v[2].w) ||
+            (v[0].y > v[0].w && v[1].y > v[1].w && v[2].y > v[2].w) ||
+            (v[0].y < -v[0].w && v[1].y < -v[1].w && v[2].y < -v[2].w) ||
+            (v[0].z > v[0].w && v[1].z > v[1].w && v[2].z > v[2].w) ||
+            (v[0].z < 0.0f && v[1].z < 0.0f && v[2].z < 0.0f))
+            continue;
+
+        if (v[0].z >= 0.0f && v[1].z >= 0.0f && v[2].z >= 0.0f)
+        {
+            EmitTriangle(occluder, v);
+            continue;
+        }
+
+        // Clip at the near plane (z = 0): 3 or 4 corners, the winding is preserved
+        XMFLOAT4 polygon[4];
+        int count = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const XMFLOAT4& a = v[k];
+            const XMFLOAT4& b = v[(k + 1) % 3];
+            if (a.z >= 0.0f)
+                polygon[count++] = a;
+            if ((a.z >= 0.0f) != (b.z >= 0.0f))
+            {
+                const float t = a.z / (a.z - b.z);
+                polygon[count++] = XMFLOAT4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, 0.0f, a.w + (b.w - a.w) * t);
+            }
+        }
+
+        for (int k = 1; k + 1 < count; ++k)
+        {
+            const XMFLOAT4 fan[3] = { polygon[0], polygon[k], polygon[k + 1] };
+            EmitTriangle(occluder, fan);
+        }
+    }
+}
+
+void OcclusionBuffer::EmitTriangle(Occluder& occluder, const XMFLOAT4* clip)
+{
+    // Pixel coordinates in double: after near clipping corners can lie very far
+    // outside the screen, so the edge functions are converted to float only relative
+    // to the first pixel on screen
+    double x[3], y[3], z[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        const double invW = 1.0 / clip[k].w;
+        x[k] = (clip[k].x * invW * 0.5 + 0.5) * m_width;
+        y[k] = (0.5 - clip[k].y * invW * 0.5) * m_height;
+        z[k] = clip[k].z * invW;
+    }
+
+    // Screen y points down: clockwise (D3D front face) = positive area
+    const double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area > 0.0))
+        return;
+
+    // Pixels whose center lies in the bounding rectangle
+    const double left = (std::min)((std::min)(x[0], x[1]), x[2]) - 0.5;
+    const double right = (std::max)((std::max)(x[0], x[1]), x[2]) - 0.5;
+    const double top = (std::min)((std::min)(y[0], y[1]), y[2]) - 0.5;
+    const double bottom = (std::max)((std::max)(y[0], y[1]), y[2]) - 0.5;
+
+    const int minX = static_cast<int>(std::ceil((std::max)(left, 0.0)));
+    const int minY = static_cast<int>(std::ceil((std::max)(top, 0.0)));
+    const int maxX = static_cast<int>(std::floor((std::min)(right, double(m_width - 1))));
+    const int maxY = static_cast<int>(std::floor((std::min)(bottom, double(m_height - 1))));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    Triangle& tri = m_triangles[occluder.firstTriangle + occluder.triangleCount++];
+    tri.minX = minX;
+    tri.minY = minY;
+    tri.maxX = maxX;
+    tri.maxY = maxY;
+
+    const double originX = minX + 0.5;
+    const double originY = minY + 0.5;
+    for (int k = 0; k < 3; ++k)
+    {
+        const int n = (k + 1) % 3;
+        const double a = y[k] - y[n];
+        const double b = x[n] - x[k];
+        tri.edgeA[k] = static_cast<float>(a);
+        tri.edgeB[k] = static_cast<float>(b);
+        tri.edgeC[k] = static_cast<float>(a * (originX - x[k]) + b * (originY - y[k]));
+    }
+
+    // z/w is linear in screen space: plane through the three corners
+    const double depthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    const double depthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    tri.depthX = static_cast<float>(depthX);
+    tri.depthY = static_cast<float>(depthY);
+    tri.depth = static_cast<float>(z[0] + depthX * (originX - x[0]) + depthY * (originY - y[0]));
+}
+
+void OcclusionBuffer::RasterizeTile(uint32_t tile)
+{
+    const int tileX = int(tile % m_tilesX) * int(TILE_WIDTH);
+    const int tileY = int(tile / m_tilesX) * int(TILE_HEIGHT);
+    const size_t stride = m_width;
+
+    for (int y = tileY; y < tileY + int(TILE_HEIGHT); ++y)
+        std::fill_n(m_depth.data() + size_t(y) * stride + tileX, TILE_WIDTH, 1.0f);
+
+    const XMVECTOR lanes = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+    const XMVECTOR zero = XMVectorZero();
+
+    for (uint32_t index : m_bins[tile])
+    {
+        const Triangle& tri = m_triangles[index];
+
+        // Start aligned to 4 pixels (rows and tiles are multiples of 4);
+        // lanes left/right of the triangle drop out through the edge functions
+        const int x0 = (std::max)(tri.minX, tileX) & ~3;
+        const int x1 = (std::min)(tri.maxX, tileX + int(TILE_WIDTH) - 1);
+        const int y0 = (std::max)(tri.minY, tileY);
+        const int y1 = (std::min)(tri.maxY, tileY + int(TILE_HEIGHT) - 1);
+
+        const XMVECTOR dx = XMVectorAdd(XMVectorReplicate(float(x0 - tri.minX)), lanes);
+        const float dy = float(y0 - tri.minY);
+
+        XMVECTOR rowEdge[3], stepX[3], stepY[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            const XMVECTOR a = XMVectorReplicate(tri.edgeA[k]);
+            rowEdge[k] = XMVectorAdd(XMVectorMultiply(a, dx), XMVectorReplicate(tri.edgeB[k] * dy + tri.edgeC[k]));
+            stepX[k] = XMVectorScale(a, 4.0f);
+            stepY[k] = XMVectorReplicate(tri.edgeB[k]);
+        }
+        const XMVECTOR depthA = XMVectorReplicate(tri.depthX);
+        XMVECTOR rowDepth = XMVectorAdd(XMVectorMultiply(depthA, dx), XMVectorReplicate(tri.depthY * dy + tri.depth));
+        const XMVECTOR depthStepX = XMVectorScale(depthA, 4.0f);
+        const XMVECTOR depthStepY = XMVectorReplicate(tri.depthY);
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            XMVECTOR e0 = rowEdge[0], e1 = rowEdge[1], e2 = rowEdge[2];
+            XMVECTOR depth = rowDepth;
+            float* row = m_depth.data() + size_t(y) * stride;
+
+            for (int x = x0; x <= x1; x += 4)
+            {
+                const XMVECTOR inside = XMVectorAndInt(XMVectorAndInt(
+                    XMVectorGreaterOrEqual(e0, zero), XMVectorGreaterOrEqual(e1, zero)), XMVectorGreaterOrEqual(e2, zero));
+
+                XMFLOAT4A* pixels = reinterpret_cast<XMFLOAT4A*>(row + x);
+                const XMVECTOR current = XMLoadFloat4A(pixels);
+                XMStoreFloat4A(pixels, XMVectorSelect(current, XMVectorMin(current, depth), inside));
+
+                e0 = XMVectorAdd(e0, stepX[0]);
+                e1 = XMVectorAdd(e1, stepX[1]);
+                e2 = XMVectorAdd(e2, stepX[2]);
+                depth = XMVectorAdd(depth, depthStepX);
+            }
+
+            for (int k = 0; k < 3; ++k)
+                rowEdge[k] = XMVectorAdd(rowEdge[k], stepY[k]);
+            rowDepth = XMVectorAdd(rowDepth, depthStepY);
+        }
+    }
+
+    // First Hi-Z level of the tile (tile sizes are even)
+    const Level& level = m_levels[0];
+    Downsample(m_depth.data(), m_width, m_height, m_hiz.data() + level.offset, level.width,
+        tileX / 2, tileY / 2, (tileX + TILE_WIDTH) / 2, (tileY + TILE_HEIGHT) / 2);
+}
+
+bool OcclusionBuffer::IsVisible(const XMFLOAT3& center, const XMFLOAT3& extents) const
+{
+    if (!m_ready)
+        return true;
+
+    // Corners = center +- axes in clip space (one transform instead of eight)
+    const XMMATRIX matrix = XMLoadFloat4x4(&m_viewProjection);
+    const XMVECTOR c = XMVector3Transform(XMLoadFloat3(&center), matrix);
+    const XMVECTOR ax = XMVectorScale(matrix.r[0], extents.x);
+    const XMVECTOR ay = XMVectorScale(matrix.r[1], extents.y);
+    const XMVECTOR az = XMVectorScale(matrix.r[2], extents.z);
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    for (int i = 0; i < 8; ++i)
+    {
+        XMVECTOR corner = (i & 1) ? XMVectorAdd(c, ax) : XMVectorSubtract(c, ax);
+        corner = (i & 2) ? XMVectorAdd(corner, ay) : XMVectorSubtract(corner, ay);
+        corner = (i & 4) ? XMVectorAdd(corner, az) : XMVectorSubtract(corner, az);
+
+        XMFLOAT4 p;
+        XMStoreFloat4(&p, corner);
+
+        // Corner in front of the near plane: the box reaches up to the camera
+        if (p.z < 0.0f || p.w <= 0.0f)
+            return true;
+
+        const float invW = 1.0f / p.w;
+        const float sx = (p.x * invW * 0.5f + 0.5f) * m_width;
+        const float sy = (0.5f - p.y * invW * 0.5f) * m_height;
+        minX = (std::min)(minX, sx);
+        maxX = (std::max)(maxX, sx);
+        minY = (std::min)(minY, sy);
+        maxY = (std::max)(maxY, sy);
+        minZ = (std::min)(minZ, p.z * invW);
+    }
+
+    if (maxX < 0.0f || maxY < 0.0f || minX >= float(m_width) || minY >= float(m_height))
+        return true;
+
+    // All pixels touching the rectangle
+    const int x0 = static_cast<int>((std::max)(minX, 0.0f));
+    const int y0 = static_cast<int>((std::max)(minY, 0.0f));
+    const int x1 = static_cast<int>((std::min)(maxX, float(m_width - 1)));
+    const int y1 = static_cast<int>((std::min)(maxY, float(m_height - 1)));
+
+    // Finest level at which the rectangle covers at most 4x4 texels
+    uint32_t level = 0;
+    while (level < m_levels.size() && (((x1 >> level) - (x0 >> level)) > 3 || ((y1 >> level) - (y0 >> level)) > 3))
+        ++level;
+
+    const float* texels = GetLevel(level);
+    const size_t width = level == 0 ? m_width : m_levels[level - 1].width;
+    for (int y = y0 >> level; y <= (y1 >> level); ++y)
+        for (int x = x0 >> level; x <= (x1 >> level); ++x)
+        {
+            // Somewhere the farthest occluder lies behind the box
+            if (texels[size_t(y) * width + x] >= minZ)
+                return true;
+        }
+    return false;
+}
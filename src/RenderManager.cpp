@@ -1,6 +1,11 @@
 ﻿#include "gdxengine.h"
 #include "RenderManager.h"
 #include "Light.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 RenderManager::RenderManager(ObjectManager& objectManager, LightManager& lightManager, GDXDevice& device)
     : m_objectManager(objectManager), m_lightManager(lightManager), m_device(device),
@@ -28,8 +33,7 @@ void RenderManager::UpdateShadowMatrixBuffer(const DirectX::XMMATRIX& viewMatrix
         return;
 
     D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = m_device.GetDeviceContext()->Map(
-        shadowMatrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    HRESULT hr = m_device.Map(shadowMatrixBuffer, D3D11_MAP_WRITE_DISCARD, &mappedResource);
 
     if (FAILED(hr))
         return;
@@ -57,7 +61,7 @@ void RenderManager::UpdateShadowMatrixBuffer(const DirectX::XMMATRIX& viewMatrix
         bufferData->lightProjectionMatrix = DirectX::XMMatrixTranspose(projMatrix);
     }
 
-    m_device.GetDeviceContext()->Unmap(shadowMatrixBuffer, 0);
+    m_device.Unmap(shadowMatrixBuffer);
 }
 
 void RenderManager::RenderShadowPass()
@@ -65,24 +69,24 @@ void RenderManager::RenderShadowPass()
     if (!m_currentCam || !m_directionLight || !m_device.IsInitialized())
         return;
 
-    ID3D11DeviceContext* ctx = m_device.GetDeviceContext();
+    // Null backend: no real views, the calls are only recorded
     ID3D11DepthStencilView* shadowDSV = m_device.GetShadowMapDepthView();
-    if (!ctx || !shadowDSV)
+    if (!m_device.IsNull() && (!m_device.GetDeviceContext() || !shadowDSV))
         return;
 
     // ---- PASS 1 STATE (deterministisch) ----
-    ctx->OMSetRenderTargets(0, nullptr, shadowDSV);
+    m_device.OMSetRenderTargets(0, nullptr, shadowDSV);
 
     // Hazard vermeiden (ShadowMap wird als SRV später gelesen)
     constexpr UINT SHADOW_TEX_SLOT = 7;
     ID3D11ShaderResourceView* nullSRV[1] = { nullptr };
-    ctx->PSSetShaderResources(SHADOW_TEX_SLOT, 1, nullSRV);
-    ctx->VSSetShaderResources(SHADOW_TEX_SLOT, 1, nullSRV);
+    m_device.PSSetShaderResources(SHADOW_TEX_SLOT, 1, nullSRV);
+    m_device.VSSetShaderResources(SHADOW_TEX_SLOT, 1, nullSRV);
 
-    ctx->ClearDepthStencilView(shadowDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+    m_device.ClearDepthStencilView(shadowDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
 
     if (ID3D11RasterizerState* rsShadow = m_device.GetShadowRasterState())
-        ctx->RSSetState(rsShadow);
+        m_device.RSSetState(rsShadow);
 
     UINT smW = 0, smH = 0;
     m_device.GetShadowMapSize(smW, smH);
@@ -94,10 +98,10 @@ void RenderManager::RenderShadowPass()
     vp.Height = (float)smH;
     vp.MinDepth = 0.0f;
     vp.MaxDepth = 1.0f;
-    ctx->RSSetViewports(1, &vp);
+    m_device.RSSetViewports(1, &vp);
 
     // Depth-only
-    ctx->PSSetShader(nullptr, nullptr, 0);
+    m_device.PSSetShader(nullptr);
 
     // ---- Shadow Matrices updaten/binden (b3) ----
     Light* light = dynamic_cast<Light*>(m_directionLight);
@@ -110,39 +114,87 @@ void RenderManager::RenderShadowPass()
     UpdateShadowMatrixBuffer(lightViewMatrix, lightProjMatrix);
 
     if (ID3D11Buffer* shadowMatrixBuffer = m_device.GetShadowMatrixBuffer())
-        ctx->VSSetConstantBuffers(3, 1, &shadowMatrixBuffer);
+        m_device.VSSetConstantBuffers(3, 1, &shadowMatrixBuffer);
 
     // ---- Draw depth into shadow map ----
-    for (Shader* shader : m_objectManager.GetShaders())
+    // Flat list from CullScene, sorted by shader and light depth
+    Shader* currentShader = nullptr;
+    Mesh* currentMesh = nullptr;
+    Surface* currentDequant = nullptr;
+    uint32_t currentFormat = VERTEX_FORMAT_SEPARATE;
+
+    MatrixSet ms = m_currentCam->matrixSet; // nur als Container
+    ms.viewMatrix = lightViewMatrix;
+    ms.projectionMatrix = lightProjMatrix;
+    // Mesh::Update sets worldMatrix from the TransformSystem cache
+
+    for (size_t di = 0; di < m_shadowDraws.size(); ++di)
     {
-        if (!shader || shader->materials.empty())
-            continue;
-
-        shader->UpdateShader(&m_device, ShaderBindMode::VS_ONLY);
+        const DrawItem& item = m_candidates[m_shadowDraws[di].index];
 
-        for (Material* material : shader->materials)
+        if (item.shader != currentShader)
         {
-            if (!material || material->meshes.empty())
-                continue;
+            currentShader = item.shader;
+            currentShader->UpdateShader(&m_device, ShaderBindMode::VS_ONLY);
+            currentFormat = VERTEX_FORMAT_SEPARATE;
+        }
 
-            // CPU-side Filter: dieses Material wirft keinen Schatten
-            if (!material->castShadows)
-                continue;
+        // Interleaved/quantized surfaces need the shader's matching layout
+        if (item.surface->GetVertexFormat() != currentFormat)
+        {
+            currentFormat = item.surface->GetVertexFormat();
+            currentShader->BindLayout(&m_device, currentFormat);
+        }
 
-            for (Mesh* mesh : material->meshes)
+        // Several surfaces of one mesh: bind the matrix only once
+        // (quantized surfaces have their own, extended by the dequantization)
+        Surface* dequant = item.surface->IsQuantized() ? item.surface : nullptr;
+        if (item.mesh != currentMesh || dequant != currentDequant)
+        {
+            currentMesh = item.mesh;
+            currentDequant = dequant;
+            if (m_ringActive)
+                m_objectRing.Bind(&m_device, 0, m_shadowConstants[di], sizeof(MatrixSet));
+            else if (dequant)
             {
-                if (!mesh) continue;
+                const DirectX::XMMATRIX local = dequant->GetDequantizeMatrix();
+                currentMesh->Update(&m_device, &ms, &local);
+            }
+            else
+                currentMesh->Update(&m_device, &ms);
+        }
+
+        item.surface->Draw(&m_device, currentShader->flagsVertex);
+    }
 
-                MatrixSet ms = m_currentCam->matrixSet; // nur als Container
-                ms.viewMatrix = lightViewMatrix;
-                ms.projectionMatrix = lightProjMatrix;
-                ms.worldMatrix = mesh->transform.GetLocalTransformationMatrix();
+    // Instance groups: bind the light's view/projection once, world comes from the instance buffer
+    if (!m_shadowGroups.empty())
+    {
+        if (m_ringActive)
+            m_objectRing.Bind(&m_device, 0, m_shadowGroupConstant, sizeof(MatrixSet));
+        else
+            m_candidates[m_shadowGroups.front().candidate].mesh->Update(&m_device, &ms);
+
+        for (const InstanceGroup& group : m_shadowGroups)
+        {
+            const DrawItem& item = m_candidates[group.candidate];
+            Shader* variant = item.shader->instancedVariant;
 
-                mesh->Update(&m_device, &ms);
+            if (variant != currentShader)
+            {
+                currentShader = variant;
+                currentShader->UpdateShader(&m_device, ShaderBindMode::VS_ONLY);
+                currentFormat = VERTEX_FORMAT_SEPARATE;
+            }
 
-                for (Surface* s : mesh->surfaces)
-                    if (s) s->Draw(&m_device, shader->flagsVertex);
+            if (item.surface->GetVertexFormat() != currentFormat)
+            {
+                currentFormat = item.surface->GetVertexFormat();
+                currentShader->BindLayout(&m_device, currentFormat);
             }
+
+            item.surface->DrawInstanced(&m_device, currentShader->flagsVertex,
+                m_instances.GetBuffer(), group.instanceCount, group.startInstance);
         }
     }
 }
@@ -152,33 +204,29 @@ void RenderManager::RenderNormalPass()
     if (!m_currentCam || !m_device.IsInitialized())
         return;
 
-    ID3D11DeviceContext* ctx = m_device.GetDeviceContext();
-    if (!ctx)
-        return;
-
     // ---- PASS 2 STATE (deterministisch) ----
     ID3D11RenderTargetView* rtv = m_device.GetRenderTargetView();
     ID3D11DepthStencilView* dsv = m_device.GetDepthStencilView();
-    if (!rtv || !dsv)
+    if (!m_device.IsNull() && (!m_device.GetDeviceContext() || !rtv || !dsv))
         return;
 
-    ctx->OMSetRenderTargets(1, &rtv, dsv);
+    m_device.OMSetRenderTargets(1, &rtv, dsv);
 
     if (ID3D11RasterizerState* rsDefault = m_device.GetRasterizerState())
-        ctx->RSSetState(rsDefault);
+        m_device.RSSetState(rsDefault);
     else
-        ctx->RSSetState(nullptr);
+        m_device.RSSetState(nullptr);
 
     // Kamera-Viewport ist Pflicht (sonst “Shadow VP” bleibt aktiv)
-    ctx->RSSetViewports(1, &m_currentCam->viewport);
+    m_device.RSSetViewports(1, &m_currentCam->viewport);
 
     // ---- Shadow resources (t7/s7) – vorbereitet für späteren echten Shadow-PS ----
     constexpr UINT SHADOW_TEX_SLOT = 7;
     ID3D11ShaderResourceView* shadowSRV = m_device.GetShadowMapSRV();
     ID3D11SamplerState* shadowSampler = m_device.GetComparisonSampler();
 
-    ctx->PSSetShaderResources(SHADOW_TEX_SLOT, 1, &shadowSRV);
-    ctx->PSSetSamplers(SHADOW_TEX_SLOT, 1, &shadowSampler);
+    m_device.PSSetShaderResources(SHADOW_TEX_SLOT, 1, &shadowSRV);
+    m_device.PSSetSamplers(SHADOW_TEX_SLOT, 1, &shadowSampler);
 
     // Optional, aber konsistent: Shadow-Matrixbuffer auch im Normalpass binden
     if (m_directionLight)
@@ -189,165 +237,765 @@ void RenderManager::RenderNormalPass()
             UpdateShadowMatrixBuffer(light->GetLightViewMatrix(), light->GetLightProjectionMatrix());
 
             if (ID3D11Buffer* shadowMatrixBuffer = m_device.GetShadowMatrixBuffer())
-                ctx->VSSetConstantBuffers(3, 1, &shadowMatrixBuffer);
+                m_device.VSSetConstantBuffers(3, 1, &shadowMatrixBuffer);
         }
     }
 }
 
-void RenderManager::RenderScene()
+void RenderManager::BuildCandidates()
 {
-    if (!m_currentCam) {
-        Debug::LogOnce("RenderScene_NoCamera",
-            "WARNING: RenderManager::RenderScene - Camera not set");
-        return;
+    const RenderQueue& queue = m_objectManager.GetRenderQueue();
+
+    // Structural change (mesh/material/shader added or removed): rebuild the flat list
+    if (queue.version != m_queueVersion)
+    {
+        m_candidates.clear();
+
+        // Dense surface ids for the instancing key (only on structural change)
+        std::unordered_map<Surface*, uint32_t> surfaceIds;
+
+        for (size_t si = 0; si < queue.shaders.size(); ++si)
+        {
+            const ShaderBatch& shaderBatch = queue.shaders[si];
+            if (!shaderBatch.shader)
+                continue;
+
+            for (size_t mi = 0; mi < shaderBatch.materials.size(); ++mi)
+            {
+                const MaterialBatch& materialBatch = shaderBatch.materials[mi];
+                if (!materialBatch.material)
+                    continue;
+
+                for (const DrawEntry& entry : materialBatch.draws)
+                {
+                    if (!entry.mesh || !entry.surface)
+                        continue;
+
+                    // LOD levels right behind the base surface, CullScene keeps one per pass
+                    const std::vector<Surface*>& surfaces = entry.mesh->surfaces;
+                    const size_t slot = std::find(surfaces.begin(), surfaces.end(), entry.surface) - surfaces.begin();
+
+                    for (uint32_t lod = 0; lod <= entry.mesh->lods.size(); ++lod)
+                    {
+                        Surface* surface = entry.surface;
+                        if (lod > 0)
+                        {
+                            const MeshLOD& level = entry.mesh->lods[lod - 1];
+                            if (slot < level.surfaces.size() && level.surfaces[slot])
+                                surface = level.surfaces[slot];
+                        }
+
+                        const uint32_t surfaceId = surfaceIds.emplace(surface,
+                            static_cast<uint32_t>(surfaceIds.size())).first->second;
+
+                        m_candidates.push_back({ shaderBatch.shader, materialBatch.material,
+                            entry.mesh, surface,
+                            static_cast<uint32_t>(si), static_cast<uint32_t>(mi), surfaceId,
+                            entry.mesh->sceneProxy, lod });
+                    }
+                }
+            }
+        }
+
+        m_queueVersion = queue.version;
     }
 
-    // PASS 1
-    RenderShadowPass();
+    // Per frame only gather the bounds
+    m_bounds.Clear();
+    m_bounds.Reserve(m_candidates.size());
 
-    // PASS 2
-    RenderNormalPass();
+    AABBTree& tree = m_objectManager.GetSceneTree();
+    const bool useTree = m_cullingEnabled && m_treeCullingEnabled;
 
-    // Lights
-    m_lightManager.Update(&m_device);
+    for (const DrawItem& item : m_candidates)
+    {
+        // LOD levels share the bounds of the base surface before them
+        if (item.lod > 0)
+        {
+            m_bounds.Add(item.mesh->aabb.Center, item.mesh->aabb.Extents);
+            continue;
+        }
 
-    Debug::LogOnce("RenderScene_BEGIN",
-        "=== RenderScene BEGIN ===");
+        // After UpdateWorld a plain version compare
+        item.mesh->UpdateBounds();
+        m_bounds.Add(item.mesh->aabb.Center, item.mesh->aabb.Extents);
 
-    Debug::LogOnce("RenderScene_Camera",
-        "Camera: ", Ptr(m_currentCam).c_str());
+        // Moved without UpdateWorld: follow up the leaf here, otherwise the mesh is missing from tree culling
+        if (useTree && item.proxy != AABBTree::NULL_NODE && tree.NeedsMove(item.proxy, item.mesh->aabb))
+            tree.MoveProxy(item.proxy, item.mesh->aabb);
+    }
+}
 
-    Debug::LogOnce("RenderScene_ShaderCount",
-        "Shader count: ", m_objectManager.GetShaders().size());
+void RenderManager::CullPass(const Frustum& frustum, std::vector<uint8_t>& flags)
+{
+    const size_t count = m_candidates.size();
+    flags.resize(count);
 
-    for (size_t si = 0; si < m_objectManager.GetShaders().size(); ++si)
+    if (m_treeCullingEnabled)
     {
-        Shader* shader = m_objectManager.GetShaders()[si];
+        CullTree(frustum, flags);
+        return;
+    }
 
-        if (!shader)
+    // Every block writes only its own range of the flags
+    auto cull = [this, &frustum, &flags](size_t begin, size_t end)
         {
-            std::string key = "Shader_NULL_" + std::to_string(si);
-            Debug::LogOnce(key.c_str(),
-                "Shader[", si, "] = NULL");
+            frustum.CullAABBs(m_bounds, begin, end, flags.data());
+        };
+
+    if (m_jobs)
+        m_jobs->ParallelFor(count, 1024, cull);
+    else
+        cull(0, count);
+}
+
+size_t RenderManager::OcclusionPass(const DirectX::XMMATRIX& viewProjection)
+{
+    const size_t count = m_candidates.size();
+    m_occlusion.Begin(viewProjection);
+
+    // Occluders: visible opaque base surfaces of marked meshes (positions live on the CPU)
+    for (size_t i = 0; i < count; ++i)
+    {
+        const DrawItem& item = m_candidates[i];
+        if (item.lod != 0 || !item.mesh->occluder || !m_mainFlags[i] ||
+            item.material->renderQueue != RenderQueueType::Opaque)
             continue;
+
+        const Surface* surface = item.surface;
+        const size_t indexCount = size_t(surface->GetTriangleCount()) * 3;
+        if (indexCount == 0 || surface->indices.size() < indexCount)
+            continue;
+
+        m_occlusion.AddOccluder(surface->position.data(), surface->position.size(),
+            surface->indices.data(), indexCount, item.mesh->transform.GetWorldMatrix());
+    }
+
+    if (m_occlusion.GetStats().occluders == 0)
+        return 0;
+
+    m_occlusion.Rasterize(m_jobs);
+
+    // Remaining candidates against the Hi-Z pyramid, every block writes only its own flags.
+    // Occluders themselves stay visible (their box never lies behind themselves).
+    std::atomic<size_t> occluded(0);
+    auto test = [this, &occluded](size_t begin, size_t end)
+        {
+            size_t hidden = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!m_mainFlags[i] || m_candidates[i].mesh->occluder)
+                    continue;
+
+                const DirectX::XMFLOAT3 center(m_bounds.centerX[i], m_bounds.centerY[i], m_bounds.centerZ[i]);
+                const DirectX::XMFLOAT3 extents(m_bounds.extentX[i], m_bounds.extentY[i], m_bounds.extentZ[i]);
+                if (!m_occlusion.IsVisible(center, extents))
+                {
+                    m_mainFlags[i] = 0;
+                    hidden += m_candidates[i].lod == 0 ? 1 : 0;
+                }
+            }
+            occluded.fetch_add(hidden, std::memory_order_relaxed);
+        };
+
+    if (m_jobs)
+        m_jobs->ParallelFor(count, 256, test);
+    else
+        test(0, count);
+
+    return occluded.load(std::memory_order_relaxed);
+}
+
+void RenderManager::CullTree(const Frustum& frustum, std::vector<uint8_t>& flags)
+{
+    // Hierarchical: subtrees outside drop out as a whole, subtrees fully inside
+    // the frustum are taken over without further plane tests
+    const AABBTree& tree = m_objectManager.GetSceneTree();
+    m_proxyFlags.assign(tree.GetNodeCapacity(), 0);
+    tree.QueryFrustum(frustum, [this](uint32_t proxy, bool inside)
+        {
+            m_proxyFlags[proxy] = inside ? 2 : 1;
+        });
+
+    // Leaves on the edge (fat box intersects a plane): gather the real AABBs
+    // Capacity for all candidates: the edge count changes every frame, the buffers do not grow
+    m_edgeItems.clear();
+    m_edgeItems.reserve(flags.size());
+    m_edgeBounds.Clear();
+    m_edgeBounds.Reserve(flags.size());
+    m_edgeFlags.reserve(flags.size());
+    for (size_t i = 0; i < flags.size(); ++i)
+    {
+        const uint32_t proxy = m_candidates[i].proxy;
+        const uint8_t state = proxy < m_proxyFlags.size() ? m_proxyFlags[proxy] : 1;
+        if (state == 1)
+        {
+            m_edgeItems.push_back(static_cast<uint32_t>(i));
+            m_edgeBounds.Add(
+                DirectX::XMFLOAT3(m_bounds.centerX[i], m_bounds.centerY[i], m_bounds.centerZ[i]),
+                DirectX::XMFLOAT3(m_bounds.extentX[i], m_bounds.extentY[i], m_bounds.extentZ[i]));
         }
+        flags[i] = state ? 1 : 0;
+    }
+
+    // ...and test them exactly, 4 per iteration like the path without the tree
+    const size_t edges = m_edgeItems.size();
+    m_edgeFlags.resize(edges);
+    auto cull = [this, &frustum](size_t begin, size_t end)
+        {
+            frustum.CullAABBs(m_edgeBounds, begin, end, m_edgeFlags.data());
+        };
+
+    if (m_jobs)
+        m_jobs->ParallelFor(edges, 1024, cull);
+    else
+        cull(0, edges);
 
+    for (size_t e = 0; e < edges; ++e)
+        flags[m_edgeItems[e]] = m_edgeFlags[e];
+}
+
+void RenderManager::CullScene()
+{
+    BuildCandidates();
+
+    const size_t count = m_candidates.size();
+    const MatrixSet& cam = m_currentCam->matrixSet;
+
+    Light* light = m_directionLight ? dynamic_cast<Light*>(m_directionLight) : nullptr;
+    DirectX::XMMATRIX lightView = light ? light->GetLightViewMatrix() : DirectX::XMMatrixIdentity();
+
+    size_t occluded = 0;
+
+    if (m_cullingEnabled)
+    {
+        const DirectX::XMMATRIX viewProjection = DirectX::XMMatrixMultiply(cam.viewMatrix, cam.projectionMatrix);
+        Frustum cameraFrustum;
+        cameraFrustum.ExtractFromMatrix(viewProjection);
+        CullPass(cameraFrustum, m_mainFlags);
+
+        if (m_occlusionEnabled)
+            occluded = OcclusionPass(viewProjection);
+
+        if (light)
+        {
+            Frustum lightFrustum;
+            lightFrustum.ExtractFromMatrix(DirectX::XMMatrixMultiply(
+                lightView, light->GetLightProjectionMatrix()));
+            CullPass(lightFrustum, m_shadowFlags);
+        }
+        else
         {
-            std::string key = "Shader_" + std::to_string(si);
-            Debug::LogOnce(key.c_str(),
-                "Shader[", si, "]: ",
-                Ptr(shader).c_str(),
-                ", Materials: ",
-                shader->materials.size());
+            m_shadowFlags.assign(count, 1);
         }
+    }
+    else
+    {
+        m_mainFlags.assign(count, 1);
+        m_shadowFlags.assign(count, 1);
+    }
 
-        if (shader->materials.empty())
-            continue;
+    // View-space depth = row 3 of the view matrix (row vectors)
+    DirectX::XMFLOAT4X4 camView, shadowView, camProjection;
+    DirectX::XMStoreFloat4x4(&camView, cam.viewMatrix);
+    DirectX::XMStoreFloat4x4(&shadowView, lightView);
+    DirectX::XMStoreFloat4x4(&camProjection, cam.projectionMatrix);
+
+    m_opaqueDraws.clear();
+    m_shadowDraws.clear();
+    m_instanceDraws.clear();
+    m_shadowInstanceDraws.clear();
+    m_transFrame.clear();
+
+    size_t baseCandidates = 0;
+    size_t shadowCandidates = 0;
+    size_t trianglesMain = 0;
+    size_t trianglesShadow = 0;
+    size_t lodDraws = 0;
+    uint32_t mainLod = 0;
+    uint32_t shadowLod = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const DrawItem& item = m_candidates[i];
+        const bool instanced = CanInstance(item);
+        const float cx = m_bounds.centerX[i];
+        const float cy = m_bounds.centerY[i];
+        const float cz = m_bounds.centerZ[i];
+        const float depth = cx * camView._13 + cy * camView._23 + cz * camView._33 + camView._43;
+
+        // Choose the LOD once per mesh surface at the base, the levels follow right behind it.
+        // Screen size = projected diameter of the AABB sphere / screen height (w = z or 1 ortho)
+        if (item.lod == 0)
+        {
+            ++baseCandidates;
+            mainLod = shadowLod = 0;
+
+            const uint32_t levels = static_cast<uint32_t>(item.mesh->lods.size());
+            if (m_lodEnabled && levels > 0)
+            {
+                const float ex = m_bounds.extentX[i], ey = m_bounds.extentY[i], ez = m_bounds.extentZ[i];
+                const float radius = std::sqrt(ex * ex + ey * ey + ez * ez);
+                const float w = depth * camProjection._34 + camProjection._44;
+                const float screenSize = w > radius * 1e-3f ? radius * camProjection._22 / w : FLT_MAX;
+
+                mainLod = SelectLOD(*item.mesh, screenSize);
+                shadowLod = (std::min)(mainLod + m_shadowLodBias, levels);
+            }
+        }
 
-        shader->UpdateShader(&m_device);
+        const bool drawMain = m_mainFlags[i] && item.lod == mainLod;
+        const bool drawShadow = m_shadowFlags[i] && item.lod == shadowLod;
 
-        for (size_t mi = 0; mi < shader->materials.size(); ++mi)
+        if (drawMain)
         {
-            Material* material = shader->materials[mi];
+            trianglesMain += item.surface->GetTriangleCount();
+            lodDraws += item.lod > 0 ? 1 : 0;
 
-            if (!material)
+            if (item.material->IsTransparent())
             {
-                std::string key = "Material_NULL_" + std::to_string(si) + "_" + std::to_string(mi);
-                Debug::LogOnce(key.c_str(),
-                    "Material[", mi, "] = NULL");
-                continue;
+                m_transFrame.push_back({ depth, DrawEntry{ item.mesh, item.surface } });
+            }
+            else
+            {
+                const uint32_t pass = (item.material->renderQueue == RenderQueueType::AlphaTest)
+                    ? RenderSortKey::PASS_ALPHATEST : RenderSortKey::PASS_OPAQUE;
+
+                if (instanced)
+                    m_instanceDraws.push_back({ RenderSortKey::MakeInstanced(pass, item.shaderIndex, item.materialIndex, item.surfaceIndex),
+                        static_cast<uint32_t>(i) });
+                else
+                    m_opaqueDraws.push_back({ RenderSortKey::Make(pass, item.shaderIndex, item.materialIndex, depth),
+                        static_cast<uint32_t>(i) });
+            }
+        }
+
+        if (item.material->castShadows && item.lod == shadowLod)
+        {
+            ++shadowCandidates;
+            if (drawShadow)
+            {
+                trianglesShadow += item.surface->GetTriangleCount();
+                lodDraws += item.lod > 0 ? 1 : 0;
             }
 
+            if (drawShadow && instanced)
+            {
+                m_shadowInstanceDraws.push_back({ RenderSortKey::MakeInstanced(RenderSortKey::PASS_OPAQUE, item.shaderIndex, 0, item.surfaceIndex),
+                    static_cast<uint32_t>(i) });
+            }
+            else if (drawShadow)
             {
-                std::string key = "  Material_" + std::to_string(si) + "_" + std::to_string(mi);
-                Debug::LogOnce(key.c_str(),
-                    "Material[", mi, "]: ",
-                    Ptr(material).c_str(),
-                    ", Meshes: ",
-                    material->meshes.size());
+                // Depth only: the material does not matter, only shader and light depth
+                const float lightDepth = cx * shadowView._13 + cy * shadowView._23 + cz * shadowView._33 + shadowView._43;
+                m_shadowDraws.push_back({ RenderSortKey::Make(RenderSortKey::PASS_OPAQUE, item.shaderIndex, 0, lightDepth),
+                    static_cast<uint32_t>(i) });
             }
+        }
+    }
+
+    // Opak: Shader -> Material -> front-to-back
+    RadixSortDraws(m_opaqueDraws, m_sortScratch);
+    RadixSortDraws(m_shadowDraws, m_sortScratch);
+
+    // Instancing: equal keys are adjacent afterwards
+    RadixSortDraws(m_instanceDraws, m_sortScratch);
+    RadixSortDraws(m_shadowInstanceDraws, m_sortScratch);
+    BuildInstanceGroups();
+
+    // Transparent: back-to-front
+    std::sort(m_transFrame.begin(), m_transFrame.end(),
+        [](const std::pair<float, DrawEntry>& a, const std::pair<float, DrawEntry>& b) { return a.first > b.first; });
+
+    m_cullStats.candidates = baseCandidates;
+    m_cullStats.visibleMain = m_opaqueDraws.size() + m_instanceDraws.size() + m_transFrame.size();
+    m_cullStats.visibleTransparent = m_transFrame.size();
+    m_cullStats.shadowCandidates = shadowCandidates;
+    m_cullStats.visibleShadow = m_shadowDraws.size() + m_shadowInstanceDraws.size();
+    m_cullStats.instanceGroups = m_mainGroups.size() + m_shadowGroups.size();
+    m_cullStats.instances = m_instances.GetInstanceCount();
+    m_cullStats.trianglesMain = trianglesMain;
+    m_cullStats.trianglesShadow = trianglesShadow;
+    m_cullStats.lodDraws = lodDraws;
+    const bool occlusion = m_cullingEnabled && m_occlusionEnabled;
+    m_cullStats.occluders = occlusion ? m_occlusion.GetStats().occluders : 0;
+    m_cullStats.occluderTriangles = occlusion ? m_occlusion.GetStats().triangles : 0;
+    m_cullStats.occluded = occluded;
+}
+
+uint32_t RenderManager::SelectLOD(Mesh& mesh, float screenSize) const
+{
+    // Level n applies below lods[n - 1].screenSize. Definitely coarser (lowest) only well
+    // below a threshold, at most this coarse (highest) until just above it - in between
+    // the last level stays, no flicker at the boundary.
+    const float below = screenSize * (1.0f + m_lodHysteresis);
+    const float above = screenSize * (1.0f - m_lodHysteresis);
+
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    for (uint32_t n = 0; n < mesh.lods.size(); ++n)
+    {
+        if (below < mesh.lods[n].screenSize)
+            lowest = n + 1;
+        if (above < mesh.lods[n].screenSize)
+            highest = n + 1;
+    }
+
+    mesh.lodLevel = (std::min)((std::max)(mesh.lodLevel, lowest), highest);
+    return mesh.lodLevel;
+}
+
+bool RenderManager::CanInstance(const DrawItem& item) const
+{
+    // Only surfaces of several meshes; lines (test) and shaders without a variant are drawn singly
+    return m_instancingEnabled &&
+        item.surface->userCount > 1 &&
+        !item.surface->test &&
+        item.shader->instancedVariant != nullptr;
+}
+
+void RenderManager::BuildInstanceGroups()
+{
+    m_instances.Clear();
+
+    auto worldOf = [this](uint32_t index)
+        {
+            const DrawItem& item = m_candidates[index];
+            if (item.surface->IsQuantized())
+                return DirectX::XMMatrixMultiply(item.surface->GetDequantizeMatrix(), item.mesh->transform.GetWorldMatrix());
+            return item.mesh->transform.GetWorldMatrix();
+        };
+
+    // Both passes into the same instance buffer (one Map per frame)
+    m_instances.Build(m_shadowInstanceDraws, m_shadowGroups, worldOf);
+    m_instances.Build(m_instanceDraws, m_mainGroups, worldOf);
+}
+
+DirectX::XMMATRIX RenderManager::GroupNormalMatrix(const InstanceGroup& group) const
+{
+    const Surface* surface = m_candidates[group.candidate].surface;
+    return surface->IsQuantized() ? surface->GetNormalMatrix() : DirectX::XMMatrixIdentity();
+}
+
+void RenderManager::DropInstanceGroups()
+{
+    m_opaqueDraws.insert(m_opaqueDraws.end(), m_instanceDraws.begin(), m_instanceDraws.end());
+    m_shadowDraws.insert(m_shadowDraws.end(), m_shadowInstanceDraws.begin(), m_shadowInstanceDraws.end());
+    RadixSortDraws(m_opaqueDraws, m_sortScratch);
+    RadixSortDraws(m_shadowDraws, m_sortScratch);
+
+    m_instanceDraws.clear();
+    m_shadowInstanceDraws.clear();
+    m_mainGroups.clear();
+    m_shadowGroups.clear();
+    m_instances.Clear();
+
+    m_cullStats.instanceGroups = 0;
+    m_cullStats.instances = 0;
+}
+
+void RenderManager::UploadObjectConstants()
+{
+    m_ringActive = false;
+
+    if (!m_device.SupportsConstantBufferOffsets())
+        return;
+
+    // + View/Projection for the instance groups: one block for the shadow pass, one per main group
+    const size_t drawCount = m_shadowDraws.size() + m_opaqueDraws.size() + m_transFrame.size() +
+        (m_shadowGroups.empty() ? 0 : 1) + m_mainGroups.size();
+    if (drawCount == 0)
+        return;
+
+    // Upper bound: one block per draw (surfaces of a mesh share one)
+    const uint32_t blockSize = UploadRingAllocator::AlignUp(sizeof(MatrixSet));
+    if (FAILED(m_objectRing.BeginFrame(&m_device, static_cast<uint32_t>(drawCount * blockSize))))
+        return;
 
-            material->SetTexture(&m_device);
-            material->UpdateConstantBuffer(
-                m_device.GetDeviceContext());
+    bool ok = true;
+    Mesh* lastMesh = nullptr;
+    Surface* lastDequant = nullptr;
+    uint32_t lastConstant = 0;
 
-            for (size_t mei = 0; mei < material->meshes.size(); ++mei)
+    // Key as when binding: mesh + quantized surface (dequantization before the world)
+    auto upload = [&](Mesh* mesh, Surface* surface, const MatrixSet& viewProjection) -> uint32_t
+        {
+            Surface* dequant = surface->IsQuantized() ? surface : nullptr;
+            if ((mesh == lastMesh && dequant == lastDequant) || !ok)
+                return lastConstant;
+
+            lastMesh = mesh;
+            lastDequant = dequant;
+            MatrixSet* data = static_cast<MatrixSet*>(m_objectRing.Allocate(sizeof(MatrixSet), lastConstant));
+            if (!data)
             {
-                Mesh* mesh = material->meshes[mei];
+                ok = false;
+                return 0;
+            }
 
-                if (!mesh)
-                {
-                    std::string key = "Mesh_NULL_" + std::to_string(si) + "_" +
-                        std::to_string(mi) + "_" + std::to_string(mei);
+            data->viewMatrix = viewProjection.viewMatrix;
+            data->projectionMatrix = viewProjection.projectionMatrix;
+            data->worldMatrix = mesh->transform.GetWorldMatrix();
+            data->normalMatrix = data->worldMatrix;
+            if (dequant)
+                data->worldMatrix = DirectX::XMMatrixMultiply(dequant->GetDequantizeMatrix(), data->worldMatrix);
+            return lastConstant;
+        };
+
+    // Instance groups: only view/projection, the shader reads the world matrix per instance
+    auto uploadPass = [&](const MatrixSet& viewProjection, const DirectX::XMMATRIX& normalMatrix) -> uint32_t
+        {
+            uint32_t firstConstant = 0;
+            MatrixSet* data = static_cast<MatrixSet*>(m_objectRing.Allocate(sizeof(MatrixSet), firstConstant));
+            if (!data)
+            {
+                ok = false;
+                return 0;
+            }
 
-                    Debug::LogOnce(key.c_str(),
-                        " Mesh[", mei, "] = NULL");
+            data->viewMatrix = viewProjection.viewMatrix;
+            data->projectionMatrix = viewProjection.projectionMatrix;
+            data->worldMatrix = DirectX::XMMatrixIdentity();
+            data->normalMatrix = normalMatrix;
+            return firstConstant;
+        };
 
-                    continue;
-                }
+    // Shadow pass: the light's view/projection
+    MatrixSet lightSet = m_currentCam->matrixSet;
+    if (Light* light = dynamic_cast<Light*>(m_directionLight))
+    {
+        lightSet.viewMatrix = light->GetLightViewMatrix();
+        lightSet.projectionMatrix = light->GetLightProjectionMatrix();
+    }
 
-                {
-                    std::string key =
-                        "Mesh_" + std::to_string(si) + "_" +
-                        std::to_string(mi) + "_" +
-                        std::to_string(mei);
-
-                    Debug::LogOnce(key.c_str(),
-                        " Mesh[", mei, "]: ",
-                        Ptr(mesh).c_str(),
-                        ", Surfaces: ",
-                        mesh->surfaces.size(),
-                        ", Active: ",
-                        mesh->IsActive());
-                }
+    m_shadowConstants.resize(m_shadowDraws.size());
+    for (size_t di = 0; di < m_shadowDraws.size(); ++di)
+    {
+        const DrawItem& item = m_candidates[m_shadowDraws[di].index];
+        m_shadowConstants[di] = upload(item.mesh, item.surface, lightSet);
+    }
 
-                mesh->Update(&m_device,
-                    &m_currentCam->matrixSet);
+    if (!m_shadowGroups.empty())
+        m_shadowGroupConstant = uploadPass(lightSet, DirectX::XMMatrixIdentity());   // depth only, no normals
 
-                for (size_t sui = 0; sui < mesh->surfaces.size(); ++sui)
-                {
-                    Surface* surface = mesh->surfaces[sui];
+    // Main pass: same order as in RenderScene
+    lastMesh = nullptr;
+    lastDequant = nullptr;
+    const MatrixSet& camSet = m_currentCam->matrixSet;
 
-                    if (!surface)
-                    {
-                        std::string key =
-                            "Surface_NULL_" +
-                            std::to_string(si) + "_" +
-                            std::to_string(mi) + "_" +
-                            std::to_string(mei) + "_" +
-                            std::to_string(sui);
+    m_mainConstants.resize(m_opaqueDraws.size() + m_transFrame.size());
+    for (size_t di = 0; di < m_opaqueDraws.size(); ++di)
+    {
+        const DrawItem& item = m_candidates[m_opaqueDraws[di].index];
+        m_mainConstants[di] = upload(item.mesh, item.surface, camSet);
+    }
 
-                        Debug::LogOnce(key.c_str(),
-                            "   Surface[", sui, "] = NULL");
+    for (size_t ti = 0; ti < m_transFrame.size(); ++ti)
+    {
+        const DrawEntry& entry = m_transFrame[ti].second;
+        m_mainConstants[m_opaqueDraws.size() + ti] = upload(entry.mesh, entry.surface, camSet);
+    }
 
-                        continue;
-                    }
+    // One block per group: quantized surfaces need their own normal correction
+    m_mainGroupConstants.resize(m_mainGroups.size());
+    for (size_t gi = 0; gi < m_mainGroups.size(); ++gi)
+        m_mainGroupConstants[gi] = uploadPass(camSet, GroupNormalMatrix(m_mainGroups[gi]));
 
-                    {
-                        std::string key =
-                            "Surface_" +
-                            std::to_string(si) + "_" +
-                            std::to_string(mi) + "_" +
-                            std::to_string(mei) + "_" +
-                            std::to_string(sui);
-
-                        Debug::LogOnce(key.c_str(),
-                            "   Surface[", sui, "]: ",
-                            Ptr(surface).c_str(),
-                            ", Active: ",
-                            surface->isActive);
-                    }
+    // Release again before the first draw
+    m_objectRing.EndFrame(&m_device);
+    m_ringActive = ok;
+}
+
+void RenderManager::UploadDynamicSurfaces()
+{
+    m_cullStats.dynamicUploads = 0;
+    m_cullStats.uploadBytes = 0;
+
+    // Surfaces of several draws upload only once (no changes pending afterwards)
+    auto upload = [this](Surface* surface)
+        {
+            if (!surface->IsDynamic())
+                return;
 
-                    surface->Draw(
-                        &m_device,
-                        shader->flagsVertex);
+            UINT bytes = 0;
+            surface->UploadDynamic(&m_device, bytes);
+            if (bytes > 0)
+            {
+                m_cullStats.dynamicUploads++;
+                m_cullStats.uploadBytes += bytes;
+            }
+        };
+
+    for (const SortedDraw& draw : m_shadowDraws)
+        upload(m_candidates[draw.index].surface);
+    for (const SortedDraw& draw : m_shadowInstanceDraws)
+        upload(m_candidates[draw.index].surface);
+    for (const SortedDraw& draw : m_opaqueDraws)
+        upload(m_candidates[draw.index].surface);
+    for (const SortedDraw& draw : m_instanceDraws)
+        upload(m_candidates[draw.index].surface);
+    for (const auto& entry : m_transFrame)
+        upload(entry.second.surface);
+}
+
+void RenderManager::RenderScene()
+{
+    if (!m_currentCam) {
+        Debug::LogOnce("RenderScene_NoCamera",
+            "WARNING: RenderManager::RenderScene - Camera not set");
+        return;
+    }
+
+    // CULLING: find the visible meshes for both passes
+    CullScene();
+
+    // Upload all instance matrices with one Map (before the object constants,
+    // so a failure can still put the groups back into single draws)
+    if (m_instances.GetInstanceCount() > 0 && FAILED(m_instances.Upload(&m_device)))
+        DropInstanceGroups();
+
+    // Dynamic vertex streams: only changed ranges, into the next ring segment
+    UploadDynamicSurfaces();
+
+    // Upload all object matrices with one Map
+    UploadObjectConstants();
+
+    // PASS 1
+    RenderShadowPass();
+
+    // PASS 2
+    RenderNormalPass();
+
+    // Lights
+    m_lightManager.Update(&m_device);
+
+    // Diagnostics only with GDX_RENDER_TRACE (no allocations, no lock in the draw path)
+    GDX_TRACE_ONCE("=== RenderScene BEGIN ===");
+    GDX_TRACE_ONCE("Camera: ", Ptr(m_currentCam).c_str());
+    GDX_TRACE_ONCE("Shader count: ", m_objectManager.GetShaders().size());
+    GDX_TRACE_ONCE("Visible: ", m_cullStats.visibleMain, " / ", m_cullStats.candidates);
+    GDX_TRACE_ONCE("Instance groups: ", m_mainGroups.size(), ", Instances: ", m_cullStats.instances);
+
+    // Flat submission: walk the sorted arrays, bind shader/material/matrix only on change
+    Shader* currentShader = nullptr;
+    Material* currentMaterial = nullptr;
+    Mesh* currentMesh = nullptr;
+    Surface* currentDequant = nullptr;
+    uint32_t currentFormat = VERTEX_FORMAT_SEPARATE;
+
+    auto bindState = [&](Shader* shader, Material* material, Surface* surface)
+        {
+            if (shader != currentShader)
+            {
+                currentShader = shader;
+                currentMaterial = nullptr;
+                currentFormat = VERTEX_FORMAT_SEPARATE;
+
+                GDX_TRACE_FIRST(8, "Shader: ", Ptr(currentShader).c_str(),
+                    ", Materials: ", currentShader->materials.size());
+
+                currentShader->UpdateShader(&m_device);
+            }
+
+            if (material != currentMaterial)
+            {
+                currentMaterial = material;
+
+                GDX_TRACE_FIRST(16, "  Material: ", Ptr(currentMaterial).c_str(),
+                    ", Meshes: ", currentMaterial->meshes.size());
+
+                currentMaterial->SetTexture(&m_device);
+                currentMaterial->UpdateConstantBuffer(&m_device);
+            }
+
+            // Interleaved/quantized surfaces: matching layout of the same shader
+            if (surface->GetVertexFormat() != currentFormat)
+            {
+                currentFormat = surface->GetVertexFormat();
+                currentShader->BindLayout(&m_device, currentFormat);
+            }
+        };
+
+    auto submit = [&](Shader* shader, Material* material, Mesh* mesh, Surface* surface, size_t di)
+        {
+            bindState(shader, material, surface);
+
+            Surface* dequant = surface->IsQuantized() ? surface : nullptr;
+            if (mesh != currentMesh || dequant != currentDequant)
+            {
+                currentMesh = mesh;
+                currentDequant = dequant;
+
+                GDX_TRACE_FIRST(16, "   Mesh[", di, "]: ", Ptr(mesh).c_str(),
+                    ", Surfaces: ", mesh->surfaces.size(), ", Active: ", mesh->IsActive());
+
+                if (m_ringActive)
+                    m_objectRing.Bind(&m_device, 0, m_mainConstants[di], sizeof(MatrixSet));
+                else if (dequant)
+                {
+                    const DirectX::XMMATRIX local = dequant->GetDequantizeMatrix();
+                    mesh->Update(&m_device, &m_currentCam->matrixSet, &local);
                 }
+                else
+                    mesh->Update(&m_device, &m_currentCam->matrixSet);
+            }
+
+            GDX_TRACE_FIRST(16, "    Surface[", di, "]: ", Ptr(surface).c_str(),
+                ", Active: ", surface->isActive);
+
+            surface->Draw(&m_device, currentShader->flagsVertex);
+        };
+
+    // Opaque + AlphaTest (radix sorted)
+    for (size_t di = 0; di < m_opaqueDraws.size(); ++di)
+    {
+        const DrawItem& item = m_candidates[m_opaqueDraws[di].index];
+        submit(item.shader, item.material, item.mesh, item.surface, di);
+    }
+
+    // Instance groups (shader -> material -> surface), one DrawIndexedInstanced per group
+    if (!m_mainGroups.empty())
+    {
+        // b0 then holds only view/projection: the next single draw must rebind
+        currentMesh = nullptr;
+
+        MatrixSet groupSet = m_currentCam->matrixSet;
+        groupSet.worldMatrix = DirectX::XMMatrixIdentity();
+
+        for (size_t gi = 0; gi < m_mainGroups.size(); ++gi)
+        {
+            const InstanceGroup& group = m_mainGroups[gi];
+            const DrawItem& item = m_candidates[group.candidate];
+            bindState(item.shader->instancedVariant, item.material, item.surface);
+
+            // Normal correction of the shared surface (identity unless quantized)
+            if (m_ringActive)
+                m_objectRing.Bind(&m_device, 0, m_mainGroupConstants[gi], sizeof(MatrixSet));
+            else
+            {
+                groupSet.normalMatrix = GroupNormalMatrix(group);
+                item.mesh->Upload(&m_device, groupSet);
             }
+
+            GDX_TRACE_FIRST(16, "   Instances: ", group.instanceCount, ", Surface: ", Ptr(item.surface).c_str());
+
+            item.surface->DrawInstanced(&m_device, currentShader->flagsVertex,
+                m_instances.GetBuffer(), group.instanceCount, group.startInstance);
         }
     }
 
-    Debug::LogOnce("RenderScene_END",
-        "=== RenderScene END ===");
+    // Transparent (back-to-front)
+    for (size_t ti = 0; ti < m_transFrame.size(); ++ti)
+    {
+        const DrawEntry& entry = m_transFrame[ti].second;
+        Material* material = entry.mesh->pMaterial;
+        if (!material || !material->pRenderShader)
+            continue;
+
+        submit(material->pRenderShader, material, entry.mesh, entry.surface, m_opaqueDraws.size() + ti);
+    }
+
+    GDX_TRACE_ONCE("=== RenderScene END ===");
 }
 
 
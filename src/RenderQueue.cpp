@@ -0,0 +1,262 @@
+#include "RenderQueue.h"
+#include "Shader.h"
+#include <algorithm>
+
+// ==================== QUEUE MAINTENANCE ====================
+
+MaterialBatch* RenderQueue::FindBatch(Material* material)
+{
+    auto it = m_materialShader.find(material);
+    if (it == m_materialShader.end())
+        return nullptr;
+
+    auto sh = shIndex.find(it->second);
+    if (sh == shIndex.end())
+        return nullptr;
+
+    ShaderBatch& batch = shaders[sh->second];
+    auto mi = batch.matIndex.find(material);
+    if (mi == batch.matIndex.end())
+        return nullptr;
+
+    return &batch.materials[mi->second];
+}
+
+void RenderQueue::EraseMaterialBatch(Shader* shader, Material* material)
+{
+    auto sh = shIndex.find(shader);
+    if (sh == shIndex.end())
+        return;
+
+    ShaderBatch& batch = shaders[sh->second];
+    auto mi = batch.matIndex.find(material);
+    if (mi == batch.matIndex.end())
+        return;
+
+    // Swap-and-pop, fix up the index of the moved material
+    const size_t index = mi->second;
+    const size_t last = batch.materials.size() - 1;
+    if (index != last)
+    {
+        batch.materials[index] = std::move(batch.materials[last]);
+        batch.matIndex[batch.materials[index].material] = index;
+    }
+
+    batch.materials.pop_back();
+    batch.matIndex.erase(material);
+}
+
+void RenderQueue::AssignMaterial(Shader* shader, Material* material)
+{
+    if (!material)
+        return;
+
+    MaterialBatch materialBatch;
+
+    auto it = m_materialShader.find(material);
+    if (it != m_materialShader.end())
+    {
+        if (it->second == shader)
+            return;     // already filed
+
+        // Move the existing batch to the new shader
+        if (MaterialBatch* existing = FindBatch(material))
+            materialBatch = std::move(*existing);
+
+        EraseMaterialBatch(it->second, material);
+        m_materialShader.erase(it);
+    }
+    else
+    {
+        // New: take over all meshes/surfaces of the material
+        materialBatch.material = material;
+        for (Mesh* mesh : material->meshes)
+        {
+            if (!mesh) continue;
+            for (Surface* surface : mesh->surfaces)
+            {
+                if (surface)
+                    materialBatch.draws.push_back({ mesh, surface });
+            }
+        }
+    }
+
+    ++version;
+
+    if (!shader)
+        return;
+
+    size_t shaderIndex;
+    auto sh = shIndex.find(shader);
+    if (sh == shIndex.end())
+    {
+        shaderIndex = shaders.size();
+        shaders.emplace_back();
+        shaders.back().shader = shader;
+        shIndex[shader] = shaderIndex;
+    }
+    else
+    {
+        shaderIndex = sh->second;
+    }
+
+    ShaderBatch& batch = shaders[shaderIndex];
+    batch.flagsVertex = static_cast<int>(shader->flagsVertex);
+    batch.matIndex[material] = batch.materials.size();
+    batch.materials.push_back(std::move(materialBatch));
+
+    m_materialShader[material] = shader;
+}
+
+void RenderQueue::RemoveMaterial(Material* material)
+{
+    auto it = m_materialShader.find(material);
+    if (it == m_materialShader.end())
+        return;
+
+    EraseMaterialBatch(it->second, material);
+    m_materialShader.erase(it);
+    ++version;
+}
+
+void RenderQueue::RemoveShader(Shader* shader)
+{
+    auto sh = shIndex.find(shader);
+    if (sh == shIndex.end())
+        return;
+
+    const size_t index = sh->second;
+    for (MaterialBatch& materialBatch : shaders[index].materials)
+        m_materialShader.erase(materialBatch.material);
+
+    const size_t last = shaders.size() - 1;
+    if (index != last)
+    {
+        shaders[index] = std::move(shaders[last]);
+        shIndex[shaders[index].shader] = index;
+    }
+
+    shaders.pop_back();
+    shIndex.erase(shader);
+    ++version;
+}
+
+void RenderQueue::AddMesh(Material* material, Mesh* mesh)
+{
+    // Material without shader yet: meshes are taken over in AssignMaterial
+    MaterialBatch* batch = FindBatch(material);
+    if (!batch || !mesh)
+        return;
+
+    for (const DrawEntry& entry : batch->draws)
+    {
+        if (entry.mesh == mesh)
+            return;
+    }
+
+    for (Surface* surface : mesh->surfaces)
+    {
+        if (surface)
+            batch->draws.push_back({ mesh, surface });
+    }
+    ++version;
+}
+
+void RenderQueue::RemoveMesh(Material* material, Mesh* mesh)
+{
+    MaterialBatch* batch = FindBatch(material);
+    if (!batch)
+        return;
+
+    auto& draws = batch->draws;
+    draws.erase(std::remove_if(draws.begin(), draws.end(),
+        [mesh](const DrawEntry& entry) { return entry.mesh == mesh; }), draws.end());
+    ++version;
+}
+
+void RenderQueue::AddSurface(Mesh* mesh, Surface* surface)
+{
+    if (!mesh || !surface || !mesh->pMaterial)
+        return;
+
+    MaterialBatch* batch = FindBatch(mesh->pMaterial);
+    if (!batch)
+        return;
+
+    // Surfaces of a mesh stay together (one matrix update per mesh)
+    auto& draws = batch->draws;
+    auto last = std::find_if(draws.rbegin(), draws.rend(),
+        [mesh](const DrawEntry& entry) { return entry.mesh == mesh; });
+
+    draws.insert(last.base(), { mesh, surface });
+    ++version;
+}
+
+void RenderQueue::RemoveSurface(Mesh* mesh, Surface* surface)
+{
+    if (!mesh || !mesh->pMaterial)
+        return;
+
+    MaterialBatch* batch = FindBatch(mesh->pMaterial);
+    if (!batch)
+        return;
+
+    // Only this mesh's entry: shared surfaces also belong to other meshes
+    auto& draws = batch->draws;
+    draws.erase(std::remove_if(draws.begin(), draws.end(),
+        [mesh, surface](const DrawEntry& entry) { return entry.mesh == mesh && entry.surface == surface; }), draws.end());
+    ++version;
+}
+
+void RenderQueue::Clear()
+{
+    shaders.clear();
+    shIndex.clear();
+    m_materialShader.clear();
+    ++version;
+}
+
+// ==================== SORTING ====================
+
+void RadixSortDraws(std::vector<SortedDraw>& draws, std::vector<SortedDraw>& scratch)
+{
+    const size_t count = draws.size();
+    if (count < 2)
+        return;
+
+    scratch.resize(count);
+    SortedDraw* src = draws.data();
+    SortedDraw* dst = scratch.data();
+    bool swapped = false;
+
+    for (int pass = 0; pass < 8; ++pass)
+    {
+        const int shift = pass * 8;
+
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; ++i)
+            ++histogram[(src[i].key >> shift) & 0xFF];
+
+        // All keys share the same byte here (e.g. pass/shader with few shaders)
+        if (histogram[(src[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+        std::swap(src, dst);
+        swapped = !swapped;
+    }
+
+    // Result is in the scratch buffer: swap the vectors instead of copying
+    if (swapped)
+        draws.swap(scratch);
+}
@@ -5,6 +5,7 @@ Shader::Shader() :
     isActive(false),
     flagsVertex(0),
     inputlayoutVertex(nullptr),
+    inputlayoutFormats{},
     vertexShader(nullptr),
     pixelShader(nullptr),
     blobVS(nullptr),
@@ -16,6 +17,8 @@ Shader::Shader() :
 Shader::~Shader() {
     // Gib alle COM-Objekte frei
     Memory::SafeRelease(inputlayoutVertex);
+    for (ID3D11InputLayout*& layout : inputlayoutFormats)
+        Memory::SafeRelease(layout);
     Memory::SafeRelease(vertexShader);
     Memory::SafeRelease(pixelShader);
     Memory::SafeRelease(blobVS);
@@ -34,14 +37,14 @@ void Shader::UpdateShader(const GDXDevice* device, ShaderBindMode mode)
         return;
     }
 
-    ID3D11DeviceContext* context = device->GetDeviceContext();
-    if (context == nullptr) {
+    if (!device->IsNull() && device->GetDeviceContext() == nullptr) {
         Debug::Log("ERROR: Shader::UpdateShader - device context is nullptr");
         return;
     }
 
     // Prüfe ob Shader für den gewünschten Bind-Mode gültig ist
-    if (!IsValid(mode)) {
+    // (Null backend: no compiled shaders, binds are only recorded)
+    if (!device->IsNull() && !IsValid(mode)) {
         Debug::Log("WARNING: Shader::UpdateShader - Shader not valid for requested bind mode");
         Debug::Log("  mode: ", (mode == ShaderBindMode::VS_ONLY ? "VS_ONLY" : "VS_PS"));
         Debug::Log("  inputlayoutVertex: ", (inputlayoutVertex != nullptr ? "OK" : "MISSING"));
@@ -51,24 +54,29 @@ void Shader::UpdateShader(const GDXDevice* device, ShaderBindMode mode)
     }
 
     // Setze Input Layout
-    context->IASetInputLayout(inputlayoutVertex);
+    device->IASetInputLayout(inputlayoutVertex);
 
     // Setze Vertex Shader (immer)
-    context->VSSetShader(vertexShader, nullptr, 0);
+    device->VSSetShader(vertexShader);
 
     // Pixel Shader abhängig vom Pass
     if (mode == ShaderBindMode::VS_ONLY)
     {
         // deterministisch: Depth/Shadow Pass ohne Pixel Shader
-        context->PSSetShader(nullptr, nullptr, 0);
+        device->PSSetShader(nullptr);
     }
     else
     {
-        context->PSSetShader(pixelShader, nullptr, 0);
+        device->PSSetShader(pixelShader);
     }
 
     // Markiere als aktiv
     isActive = true;
 }
 
+void Shader::BindLayout(const GDXDevice* device, uint32_t vertexFormat) const
+{
+    device->IASetInputLayout(vertexFormat == VERTEX_FORMAT_SEPARATE ? inputlayoutVertex : inputlayoutFormats[vertexFormat]);
+}
+
 
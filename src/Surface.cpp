@@ -1,4 +1,9 @@
 ﻿#include "Surface.h"
+#include "TriangleBVH.h"
+#include "MeshSimplifier.h"
+#include "MeshFile.h"
+#include <algorithm>
+#include <cstring>
 using namespace DirectX;
 
 Surface::Surface() :
@@ -15,6 +20,9 @@ Surface::Surface() :
     normalBuffer(nullptr),
     uv1Buffer(nullptr),
     uv2Buffer(nullptr),
+    vertexBuffer(nullptr),
+    vertexStride(0),
+    vertexFlags(0),
     size_listUV1(0),
     size_listUV2(0),
     size_uv1(0),
@@ -34,6 +42,7 @@ Surface::~Surface() {
     Memory::SafeRelease(normalBuffer);      
     Memory::SafeRelease(uv1Buffer);         
     Memory::SafeRelease(uv2Buffer);
+    Memory::SafeRelease(vertexBuffer);
 }
 
 float Surface::GetVertexX(unsigned int index) const
@@ -63,10 +72,20 @@ void Surface::AddVertex(unsigned int index, float x, float y, float z)
         position[index] = DirectX::XMFLOAT3(x, y, z);
     }
     else {
+        index = static_cast<unsigned int>(position.size());
         position.push_back(DirectX::XMFLOAT3(x, y, z));
     }
+    dynamicStreams[DYNAMIC_STREAM_POSITION].MarkDirty(index, 1);
     size_listPosition = (unsigned int)position.size();
     size_position = sizeof(DirectX::XMFLOAT3);
+
+    // Per-vertex edits stay O(1): new revision now (stale BVH is not handed out),
+    // the bounds once in RefreshLocalBounds
+    if (!boundsDirty)
+    {
+        boundsDirty = true;
+        ++boundsRevision;
+    }
 }
 
 void Surface::VertexColor(unsigned int index, float r, float g, float b)
@@ -75,8 +94,10 @@ void Surface::VertexColor(unsigned int index, float r, float g, float b)
         color[index] = DirectX::XMFLOAT4(r, g, b, 1.0f);
     }
     else {
+        index = static_cast<unsigned int>(color.size());
         color.push_back(DirectX::XMFLOAT4(r, g, b, 1.0f));
     }
+    dynamicStreams[DYNAMIC_STREAM_COLOR].MarkDirty(index, 1);
     size_listColor = static_cast<unsigned int>(color.size());
     size_color = sizeof(DirectX::XMFLOAT4);
 }
@@ -87,8 +108,10 @@ void Surface::VertexNormal(unsigned int index, float x, float y, float z)
         normal[index] = DirectX::XMFLOAT3(x, y, z);
     }
     else {
+        index = static_cast<unsigned int>(normal.size());
         normal.push_back(DirectX::XMFLOAT3(x, y, z));
     }
+    dynamicStreams[DYNAMIC_STREAM_NORMAL].MarkDirty(index, 1);
     size_listNormal = (unsigned int)normal.size();
     size_normal = sizeof(DirectX::XMFLOAT3);
 }
@@ -99,8 +122,10 @@ void Surface::VertexTexCoords(unsigned int index, float u, float v)
         uv1[index] = DirectX::XMFLOAT2(u, v);
     }
     else {
+        index = static_cast<unsigned int>(uv1.size());
         uv1.push_back(DirectX::XMFLOAT2(u, v));
     }
+    dynamicStreams[DYNAMIC_STREAM_UV1].MarkDirty(index, 1);
     size_listUV1 = (unsigned int)uv1.size();
     size_uv1 = sizeof(DirectX::XMFLOAT2);
 }
@@ -111,46 +136,370 @@ void Surface::AddIndex(UINT index)
     size_listIndex = (unsigned int)indices.size();
 }
 
-void Surface::Draw(const GDXDevice* device, const DWORD flagsVertex)
+void Surface::Reserve(size_t vertexCount, size_t indexCount)
+{
+    position.reserve(vertexCount);
+    normal.reserve(vertexCount);
+    color.reserve(vertexCount);
+    uv1.reserve(vertexCount);
+    uv2.reserve(vertexCount);
+    indices.reserve(indexCount);
+}
+
+void Surface::SetPositions(const XMFLOAT3* data, size_t count)
+{
+    position.assign(data, data + count);
+    dynamicStreams[DYNAMIC_STREAM_POSITION].MarkAllDirty();
+    UpdateStreamSizes();
+    // New array: box, sphere and revision (mesh bounds, triangle BVH) follow
+    UpdateLocalBounds();
+}
+
+void Surface::SetPositions(std::vector<XMFLOAT3>&& data)
+{
+    position = std::move(data);
+    dynamicStreams[DYNAMIC_STREAM_POSITION].MarkAllDirty();
+    UpdateStreamSizes();
+    UpdateLocalBounds();
+}
+
+void Surface::SetNormals(const XMFLOAT3* data, size_t count)
+{
+    normal.assign(data, data + count);
+    dynamicStreams[DYNAMIC_STREAM_NORMAL].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetNormals(std::vector<XMFLOAT3>&& data)
+{
+    normal = std::move(data);
+    dynamicStreams[DYNAMIC_STREAM_NORMAL].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetColors(const XMFLOAT4* data, size_t count)
+{
+    color.assign(data, data + count);
+    dynamicStreams[DYNAMIC_STREAM_COLOR].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetColors(std::vector<XMFLOAT4>&& data)
+{
+    color = std::move(data);
+    dynamicStreams[DYNAMIC_STREAM_COLOR].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetTexCoords(const XMFLOAT2* data, size_t count)
+{
+    uv1.assign(data, data + count);
+    dynamicStreams[DYNAMIC_STREAM_UV1].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetTexCoords(std::vector<XMFLOAT2>&& data)
+{
+    uv1 = std::move(data);
+    dynamicStreams[DYNAMIC_STREAM_UV1].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetTexCoords2(const XMFLOAT2* data, size_t count)
+{
+    uv2.assign(data, data + count);
+    dynamicStreams[DYNAMIC_STREAM_UV2].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetTexCoords2(std::vector<XMFLOAT2>&& data)
+{
+    uv2 = std::move(data);
+    dynamicStreams[DYNAMIC_STREAM_UV2].MarkAllDirty();
+    UpdateStreamSizes();
+}
+
+void Surface::SetIndices(const unsigned int* data, size_t count)
+{
+    indices.assign(data, data + count);
+    UpdateStreamSizes();
+}
+
+void Surface::SetIndices(std::vector<unsigned int>&& data)
+{
+    indices = std::move(data);
+    UpdateStreamSizes();
+}
+
+void Surface::MarkDirty(DWORD attributes, UINT first, UINT count)
+{
+    if (attributes & D3DVERTEX_POSITION) dynamicStreams[DYNAMIC_STREAM_POSITION].MarkDirty(first, count);
+    if (attributes & D3DVERTEX_NORMAL)   dynamicStreams[DYNAMIC_STREAM_NORMAL].MarkDirty(first, count);
+    if (attributes & D3DVERTEX_COLOR)    dynamicStreams[DYNAMIC_STREAM_COLOR].MarkDirty(first, count);
+    if (attributes & D3DVERTEX_TEX1)     dynamicStreams[DYNAMIC_STREAM_UV1].MarkDirty(first, count);
+    if (attributes & D3DVERTEX_TEX2)     dynamicStreams[DYNAMIC_STREAM_UV2].MarkDirty(first, count);
+
+    // Whole box, not just the range: moved vertices may also shrink it
+    if (attributes & D3DVERTEX_POSITION)
+        UpdateLocalBounds();
+}
+
+HRESULT Surface::UploadDynamic(const GDXDevice* device, UINT& uploadedBytes)
+{
+    uploadedBytes = 0;
+
+    const void* data[DYNAMIC_STREAM_COUNT] = { position.data(), normal.data(), color.data(), uv1.data(), uv2.data() };
+    const size_t count[DYNAMIC_STREAM_COUNT] = { position.size(), normal.size(), color.size(), uv1.size(), uv2.size() };
+
+    HRESULT result = S_OK;
+    for (UINT i = 0; i < DYNAMIC_STREAM_COUNT; ++i)
+    {
+        DynamicVertexStream& stream = dynamicStreams[i];
+        if (!stream.IsCreated() || !stream.HasChanges())
+            continue;
+
+        UINT bytes = 0;
+        HRESULT hr = stream.Upload(device, data[i], static_cast<UINT>(count[i]), bytes);
+        uploadedBytes += bytes;
+        if (FAILED(hr))
+            result = hr;
+    }
+    return result;
+}
+
+void Surface::UpdateStreamSizes()
+{
+    size_listPosition = static_cast<unsigned int>(position.size());
+    size_listNormal = static_cast<unsigned int>(normal.size());
+    size_listColor = static_cast<unsigned int>(color.size());
+    size_listUV1 = static_cast<unsigned int>(uv1.size());
+    size_listUV2 = static_cast<unsigned int>(uv2.size());
+    size_listIndex = static_cast<unsigned int>(indices.size());
+
+    // Element sizes as in AddVertex & co., only for filled streams
+    if (!position.empty()) size_position = sizeof(XMFLOAT3);
+    if (!normal.empty())   size_normal = sizeof(XMFLOAT3);
+    if (!color.empty())    size_color = sizeof(XMFLOAT4);
+    if (!uv1.empty())      size_uv1 = sizeof(XMFLOAT2);
+    if (!uv2.empty())      size_uv2 = sizeof(XMFLOAT2);
+}
+
+template<typename T>
+static void RemapStream(std::vector<T>& stream, const std::vector<uint32_t>& remap)
+{
+    if (stream.size() != remap.size())
+        return;
+
+    std::vector<T> remapped(stream.size());
+    MeshOptimizer::RemapVertices(remapped.data(), stream.data(), stream.size(), sizeof(T), remap.data());
+    stream.swap(remapped);
+}
+
+MeshOptimizer::Report Surface::Optimize(float overdrawThreshold)
+{
+    MeshOptimizer::Report report;
+
+    const size_t vertexCount = position.size();
+    const size_t indexCount = indices.size();
+
+    // Leave lines (test) and incomplete triangles alone
+    if (test || vertexCount == 0 || indexCount < 3 || indexCount % 3 != 0)
+        return report;
+
+    for (unsigned int index : indices)
+    {
+        if (index >= vertexCount) {
+            Debug::Log("Surface.cpp: Optimize - index out of range, skipped");
+            return report;
+        }
+    }
+
+    // All streams must have the same vertex count, otherwise the remap does not fit
+    if ((!normal.empty() && normal.size() != vertexCount) ||
+        (!color.empty() && color.size() != vertexCount) ||
+        (!uv1.empty() && uv1.size() != vertexCount) ||
+        (!uv2.empty() && uv2.size() != vertexCount)) {
+        Debug::Log("Surface.cpp: Optimize - attribute streams differ in size, skipped");
+        return report;
+    }
+
+    report.before = MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+
+    MeshOptimizer::OptimizeVertexCache(indices.data(), indices.data(), indexCount, vertexCount);
+
+    if (overdrawThreshold > 0.0f)
+    {
+        MeshOptimizer::OptimizeOverdraw(indices.data(), indices.data(), indexCount,
+            &position[0].x, vertexCount, sizeof(XMFLOAT3), overdrawThreshold);
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+    MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), indices.data(), indexCount, vertexCount);
+    MeshOptimizer::RemapIndices(indices.data(), indices.data(), indexCount, remap.data());
+
+    RemapStream(position, remap);
+    RemapStream(normal, remap);
+    RemapStream(color, remap);
+    RemapStream(uv1, remap);
+    RemapStream(uv2, remap);
+
+    report.after = MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+    return report;
+}
+
+// Take over only the vertices used via remap (remap[old] < used) in the new order
+template<typename T>
+static void CompactStream(std::vector<T>& destination, const std::vector<T>& source,
+    const std::vector<uint32_t>& remap, size_t used)
+{
+    destination.clear();
+    if (source.size() != remap.size())
+        return;
+
+    destination.resize(used);
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        if (remap[i] < used)
+            destination[remap[i]] = source[i];
+    }
+}
+
+bool Surface::SimplifyFrom(const Surface& source, size_t targetIndexCount, float targetError, float* resultError)
+{
+    const size_t vertexCount = source.position.size();
+    const size_t indexCount = source.indices.size();
+
+    // Do not simplify lines (test), dynamic geometry and incomplete triangles
+    if (&source == this || source.test || source.dynamic || vertexCount == 0 || indexCount < 3 || indexCount % 3 != 0)
+        return false;
+
+    for (unsigned int index : source.indices)
+    {
+        if (index >= vertexCount) {
+            Debug::Log("Surface.cpp: SimplifyFrom - index out of range, skipped");
+            return false;
+        }
+    }
+
+    if ((!source.normal.empty() && source.normal.size() != vertexCount) ||
+        (!source.color.empty() && source.color.size() != vertexCount) ||
+        (!source.uv1.empty() && source.uv1.size() != vertexCount) ||
+        (!source.uv2.empty() && source.uv2.size() != vertexCount)) {
+        Debug::Log("Surface.cpp: SimplifyFrom - attribute streams differ in size, skipped");
+        return false;
+    }
+
+    std::vector<uint32_t> lod(indexCount);
+    const size_t lodCount = MeshSimplifier::Simplify(lod.data(), source.indices.data(), indexCount,
+        &source.position[0].x, vertexCount, sizeof(XMFLOAT3), targetIndexCount, targetError, resultError);
+    if (lodCount == 0 || lodCount >= indexCount)
+        return false;
+    lod.resize(lodCount);
+
+    // Remove dropped vertices from all streams, the rest in order of use
+    std::vector<uint32_t> remap(vertexCount);
+    const size_t used = MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), lod.data(), lodCount, vertexCount);
+    MeshOptimizer::RemapIndices(lod.data(), lod.data(), lodCount, remap.data());
+
+    CompactStream(position, source.position, remap, used);
+    CompactStream(normal, source.normal, remap, used);
+    CompactStream(color, source.color, remap, used);
+    CompactStream(uv1, source.uv1, remap, used);
+    CompactStream(uv2, source.uv2, remap, used);
+    indices = std::move(lod);
+
+    interleaved = source.interleaved;
+    quantizePositions = source.quantizePositions;
+    UpdateStreamSizes();
+    return true;
+}
+
+unsigned int Surface::BindVertexStreams(const GDXDevice* device, const DWORD flagsVertex)
 {
     unsigned int offset = 0;
     unsigned int cnt = 0;
 
+    // Interleaved: one stream, the shader's layout (inputlayoutFormats) knows the offsets
+    if (vertexBuffer) {
+        device->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &offset);
+        device->IASetIndexBuffer(indexBuffer, indexFormat, 0);
+        return 1;
+    }
+
+    // Dynamic: active segment of the ring via the offset
+    if (IsDynamic()) {
+        static const DWORD streamFlags[DYNAMIC_STREAM_COUNT] = {
+            D3DVERTEX_POSITION, D3DVERTEX_NORMAL, D3DVERTEX_COLOR, D3DVERTEX_TEX1, D3DVERTEX_TEX2
+        };
+        for (UINT i = 0; i < DYNAMIC_STREAM_COUNT; ++i) {
+            if (!(flagsVertex & streamFlags[i]))
+                continue;
+            ID3D11Buffer* buffer = dynamicStreams[i].GetBuffer();
+            UINT stride = dynamicStreams[i].GetStride();
+            UINT streamOffset = dynamicStreams[i].GetOffset();
+            device->IASetVertexBuffers(cnt, 1, &buffer, &stride, &streamOffset);
+            cnt++;
+        }
+        device->IASetIndexBuffer(indexBuffer, indexFormat, 0);
+        return cnt;
+    }
+
     if (flagsVertex & D3DVERTEX_POSITION) {
-        device->GetDeviceContext()->IASetVertexBuffers(cnt, 1, &positionBuffer, &size_position, &offset);
+        // Quantized: 4 x UNORM16 instead of float3
+        UINT stride = positionsQuantized ? 4 * sizeof(uint16_t) : size_position;
+        device->IASetVertexBuffers(cnt, 1, &positionBuffer, &stride, &offset);
         cnt++;
     }
     if (flagsVertex & D3DVERTEX_NORMAL) {
-        device->GetDeviceContext()->IASetVertexBuffers(cnt, 1, &normalBuffer, &size_normal, &offset);
+        device->IASetVertexBuffers(cnt, 1, &normalBuffer, &size_normal, &offset);
         cnt++;
     }
     if (flagsVertex & D3DVERTEX_COLOR) {
-        device->GetDeviceContext()->IASetVertexBuffers(cnt, 1, &colorBuffer, &size_color, &offset);
+        device->IASetVertexBuffers(cnt, 1, &colorBuffer, &size_color, &offset);
         cnt++;
     }
     if (flagsVertex & D3DVERTEX_TEX1) {
-        device->GetDeviceContext()->IASetVertexBuffers(cnt, 1, &uv1Buffer, &size_uv1, &offset);
+        device->IASetVertexBuffers(cnt, 1, &uv1Buffer, &size_uv1, &offset);
         cnt++;
     }
     if (flagsVertex & D3DVERTEX_TEX2) {
-        device->GetDeviceContext()->IASetVertexBuffers(cnt, 1, &uv2Buffer, &size_uv2, &offset);
+        device->IASetVertexBuffers(cnt, 1, &uv2Buffer, &size_uv2, &offset);
         cnt++;
     }
 
-    device->GetDeviceContext()->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+    device->IASetIndexBuffer(indexBuffer, indexFormat, 0);
+    return cnt;
+}
+
+void Surface::Draw(const GDXDevice* device, const DWORD flagsVertex)
+{
+    BindVertexStreams(device, flagsVertex);
 
     if (!test)
     {
-        device->GetDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        device->GetDeviceContext()->DrawIndexed(size_listIndex, 0, 0);
+        device->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        device->DrawIndexed(size_listIndex, 0, 0);
     }
     else
     {
-        device->GetDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-        device->GetDeviceContext()->Draw(size_listIndex, 0);  // ← Bleibt Draw()
+        device->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+        device->Draw(size_listIndex, 0);  // ← Bleibt Draw()
     }
 }
 
+void Surface::DrawInstanced(const GDXDevice* device, const DWORD flagsVertex, ID3D11Buffer* instanceBuffer, UINT instanceCount, UINT startInstance)
+{
+    const unsigned int slot = BindVertexStreams(device, flagsVertex);
+
+    // One world matrix (4 x float4) per instance
+    UINT stride = sizeof(DirectX::XMFLOAT4X4);
+    UINT offset = 0;
+    device->IASetVertexBuffers(slot, 1, &instanceBuffer, &stride, &offset);
+
+    device->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    device->DrawIndexedInstanced(size_listIndex, instanceCount, 0, 0, startInstance);
+}
+
 void Surface::CalculateSize(XMMATRIX rotationMatrix, XMFLOAT3& minSize, XMFLOAT3& maxSize)
 {
     minPoint.x = FLT_MAX;
@@ -184,3 +533,219 @@ void Surface::CalculateSize(XMMATRIX rotationMatrix, XMFLOAT3& minSize, XMFLOAT3
     minSize = minPoint;
     maxSize = maxPoint;
 }
+
+// Box from min/max, sphere around the box center (count > 0)
+static void ComputeBounds(const XMFLOAT3* position, size_t count, BoundingBox& box, BoundingSphere& sphere)
+{
+    // 4 vertices (12 floats) = 3 unshuffled loads:
+    //   a = x0 y0 z0 x1   b = y1 z1 x2 y2   c = z2 x3 y3 z3
+    // Three min/max pairs run independently, the lanes are merged only at the end.
+    const float* p = &position[0].x;
+    XMVECTOR minA = XMVectorReplicate(FLT_MAX), minB = minA, minC = minA;
+    XMVECTOR maxA = XMVectorReplicate(-FLT_MAX), maxB = maxA, maxC = maxA;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, p += 12)
+    {
+        const XMVECTOR a = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p));
+        const XMVECTOR b = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p + 4));
+        const XMVECTOR c = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p + 8));
+        minA = XMVectorMin(minA, a); maxA = XMVectorMax(maxA, a);
+        minB = XMVectorMin(minB, b); maxB = XMVectorMax(maxB, b);
+        minC = XMVectorMin(minC, c); maxC = XMVectorMax(maxC, c);
+    }
+
+    // x: a.x a.w b.z c.y   y: a.y b.x b.w c.z   z: a.z b.y c.x c.w
+    XMFLOAT4 lo[3], hi[3];
+    XMStoreFloat4(&lo[0], minA); XMStoreFloat4(&lo[1], minB); XMStoreFloat4(&lo[2], minC);
+    XMStoreFloat4(&hi[0], maxA); XMStoreFloat4(&hi[1], maxB); XMStoreFloat4(&hi[2], maxC);
+
+    XMVECTOR vMin = XMVectorMin(
+        XMVectorMin(XMVectorSet(lo[0].x, lo[0].y, lo[0].z, 0.0f), XMVectorSet(lo[0].w, lo[1].x, lo[1].y, 0.0f)),
+        XMVectorMin(XMVectorSet(lo[1].z, lo[1].w, lo[2].x, 0.0f), XMVectorSet(lo[2].y, lo[2].z, lo[2].w, 0.0f)));
+    XMVECTOR vMax = XMVectorMax(
+        XMVectorMax(XMVectorSet(hi[0].x, hi[0].y, hi[0].z, 0.0f), XMVectorSet(hi[0].w, hi[1].x, hi[1].y, 0.0f)),
+        XMVectorMax(XMVectorSet(hi[1].z, hi[1].w, hi[2].x, 0.0f), XMVectorSet(hi[2].y, hi[2].z, hi[2].w, 0.0f)));
+
+    for (; i < count; ++i)
+    {
+        const XMVECTOR v = XMLoadFloat3(&position[i]);
+        vMin = XMVectorMin(vMin, v);
+        vMax = XMVectorMax(vMax, v);
+    }
+
+    const XMVECTOR center = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+    XMStoreFloat3(&box.Center, center);
+    XMStoreFloat3(&box.Extents, XMVectorScale(XMVectorSubtract(vMax, vMin), 0.5f));
+
+    // Sphere around the box center, radius = farthest vertex (tighter than half the diagonal)
+    XMVECTOR maxDistSq = XMVectorZero();
+    for (i = 0; i < count; ++i)
+        maxDistSq = XMVectorMax(maxDistSq, XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&position[i]), center)));
+
+    sphere.Center = box.Center;
+    sphere.Radius = XMVectorGetX(XMVectorSqrt(maxDistSq));
+}
+
+void Surface::UpdateLocalBounds()
+{
+    boundsDirty = false;
+
+    const size_t count = position.size();
+    if (count == 0)
+    {
+        ++boundsRevision;
+        hasLocalBounds = false;
+        localBox = BoundingBox();
+        localSphere = BoundingSphere();
+        minPoint = maxPoint = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    BoundingBox box;
+    BoundingSphere sphere;
+    ComputeBounds(position.data(), count, box, sphere);
+    SetLocalBounds(box, sphere);
+}
+
+void Surface::SetLocalBounds(const BoundingBox& box, const BoundingSphere& sphere)
+{
+    ++boundsRevision;
+
+    localBox = box;
+    localSphere = sphere;
+    XMStoreFloat3(&minPoint, XMVectorSubtract(XMLoadFloat3(&box.Center), XMLoadFloat3(&box.Extents)));
+    XMStoreFloat3(&maxPoint, XMVectorAdd(XMLoadFloat3(&box.Center), XMLoadFloat3(&box.Extents)));
+    hasLocalBounds = true;
+}
+
+void Surface::GetLocalBounds(XMFLOAT3& minSize, XMFLOAT3& maxSize) const
+{
+    XMStoreFloat3(&minSize, XMVectorSubtract(XMLoadFloat3(&localBox.Center), XMLoadFloat3(&localBox.Extents)));
+    XMStoreFloat3(&maxSize, XMVectorAdd(XMLoadFloat3(&localBox.Center), XMLoadFloat3(&localBox.Extents)));
+}
+
+const TriangleBVH* Surface::GetTriangleBVH()
+{
+    // Lines have no triangles
+    if (test)
+        return nullptr;
+
+    RefreshLocalBounds();
+    if (!triangleBVH || triangleBVHRevision != boundsRevision)
+    {
+        if (!triangleBVH)
+            triangleBVH = std::make_unique<TriangleBVH>();
+
+        triangleBVH->Build(position.data(), position.size(),
+            indices.empty() ? nullptr : indices.data(), indices.size());
+        triangleBVHRevision = boundsRevision;
+    }
+
+    return triangleBVH->Empty() ? nullptr : triangleBVH.get();
+}
+
+const TriangleBVH* Surface::GetCachedTriangleBVH() const
+{
+    if (test || !triangleBVH || triangleBVHRevision != boundsRevision || triangleBVH->Empty())
+        return nullptr;
+    return triangleBVH.get();
+}
+
+// Stream with count elements, missing entries get fallback (like VertexPacking::Pack)
+template<typename T>
+static void CookStream(const std::vector<T>& source, size_t count, const T& fallback,
+    MeshFile::CookedSurface& out, MeshFile::Stream stream)
+{
+    std::vector<uint8_t>& destination = out.streams[stream];
+    destination.resize(count * sizeof(T));
+
+    const size_t copied = (std::min)(source.size(), count);
+    if (copied)
+        memcpy(destination.data(), source.data(), copied * sizeof(T));
+    for (size_t i = copied; i < count; ++i)
+        memcpy(destination.data() + i * sizeof(T), &fallback, sizeof(T));
+
+    out.record.streams[stream].stride = sizeof(T);
+}
+
+bool Surface::Cook(DWORD flagsVertex, uint32_t vertexFormat, MeshFile::CookedSurface& out) const
+{
+    if (test || position.empty() || indices.size() < 3)
+        return false;
+
+    out = MeshFile::CookedSurface();
+    MeshFile::SurfaceRecord& record = out.record;
+
+    const size_t count = position.size();
+    const bool packed = (vertexFormat & VERTEX_FORMAT_INTERLEAVED) != 0;
+    const bool quantized = (vertexFormat & VERTEX_FORMAT_QUANTIZED) != 0 && (flagsVertex & D3DVERTEX_POSITION);
+
+    record.vertexCount = static_cast<uint32_t>(count);
+    record.indexCount = static_cast<uint32_t>(indices.size() / 3 * 3);
+    record.attributes = flagsVertex;
+    record.vertexFormat = (packed ? VERTEX_FORMAT_INTERLEAVED : 0u) | (quantized ? VERTEX_FORMAT_QUANTIZED : 0u);
+
+    // Quantization like FillBuffer from the current positions
+    VertexPacking::Quantization quantization;
+    if (quantized)
+        quantization = VertexPacking::ComputeQuantization(position.data(), count);
+    memcpy(record.quantizationOffset, &quantization.offset, sizeof(record.quantizationOffset));
+    memcpy(record.quantizationScale, &quantization.scale, sizeof(record.quantizationScale));
+
+    if (packed) {
+        const VertexPacking::Layout layout = VertexPacking::MakeLayout(flagsVertex, quantized);
+        VertexPacking::Pack(*this, layout, quantization, out.streams[MeshFile::STREAM_VERTEX]);
+        record.streams[MeshFile::STREAM_VERTEX].stride = layout.stride;
+    }
+    else {
+        if (quantized) {
+            std::vector<uint16_t> positions;
+            VertexPacking::QuantizePositions(position.data(), count, quantization, positions);
+            out.streams[MeshFile::STREAM_POSITION].resize(positions.size() * sizeof(uint16_t));
+            memcpy(out.streams[MeshFile::STREAM_POSITION].data(), positions.data(), positions.size() * sizeof(uint16_t));
+            record.streams[MeshFile::STREAM_POSITION].stride = 4 * sizeof(uint16_t);
+        }
+        else if (flagsVertex & D3DVERTEX_POSITION) {
+            CookStream(position, count, XMFLOAT3(0.0f, 0.0f, 0.0f), out, MeshFile::STREAM_POSITION);
+        }
+        if (flagsVertex & D3DVERTEX_NORMAL)
+            CookStream(normal, count, XMFLOAT3(0.0f, 0.0f, 1.0f), out, MeshFile::STREAM_NORMAL);
+        if (flagsVertex & D3DVERTEX_COLOR)
+            CookStream(color, count, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), out, MeshFile::STREAM_COLOR);
+        if (flagsVertex & D3DVERTEX_TEX1)
+            CookStream(uv1, count, XMFLOAT2(0.0f, 0.0f), out, MeshFile::STREAM_UV1);
+        if (flagsVertex & D3DVERTEX_TEX2)
+            CookStream(uv2, count, XMFLOAT2(0.0f, 0.0f), out, MeshFile::STREAM_UV2);
+    }
+
+    // Exact float positions for raycasts/occlusion/collision when the GPU has none
+    const bool gpuFloatPositions = (flagsVertex & D3DVERTEX_POSITION) && !quantized;
+    if (!gpuFloatPositions)
+        CookStream(position, count, XMFLOAT3(0.0f, 0.0f, 0.0f), out, MeshFile::STREAM_CPU_POSITION);
+
+    // Index buffer like FillBuffer: 16 bits as long as every vertex is addressable
+    std::vector<uint8_t>& indexStream = out.streams[MeshFile::STREAM_INDEX];
+    if (count <= 0xFFFF) {
+        record.indexSize = sizeof(uint16_t);
+        indexStream.resize(record.indexCount * sizeof(uint16_t));
+        uint16_t* destination = reinterpret_cast<uint16_t*>(indexStream.data());
+        for (uint32_t i = 0; i < record.indexCount; ++i)
+            destination[i] = static_cast<uint16_t>(indices[i]);
+    }
+    else {
+        record.indexSize = sizeof(uint32_t);
+        indexStream.resize(record.indexCount * sizeof(uint32_t));
+        memcpy(indexStream.data(), indices.data(), indexStream.size());
+    }
+    record.streams[MeshFile::STREAM_INDEX].stride = record.indexSize;
+
+    BoundingBox box;
+    BoundingSphere sphere;
+    ComputeBounds(position.data(), count, box, sphere);
+    memcpy(record.boxCenter, &box.Center, sizeof(record.boxCenter));
+    memcpy(record.boxExtents, &box.Extents, sizeof(record.boxExtents));
+    memcpy(record.sphereCenter, &sphere.Center, sizeof(record.sphereCenter));
+    record.sphereRadius = sphere.Radius;
+    return true;
+}
@@ -1,11 +1,10 @@
 #include "Texture.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "../stb_image.h"
+#include "../third_party/stb_image.h"
 
 #define RGBA(r, g, b, a) ((r << 24) | (g << 16) | (b << 8) | a)
 
-Texture::Texture() : m_texture(nullptr), m_textureView(nullptr), m_isLocked(false)
+Texture::Texture() : m_pixels(nullptr), m_isLocked(false), m_texture(nullptr), m_textureView(nullptr), m_imageSamplerState(nullptr), m_asset(INVALID_ASSET)
 {
     m_sFilename = L"";
 }
@@ -19,14 +18,38 @@ Texture::~Texture()
     m_isLocked = false;
 }
 
-HRESULT Texture::AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const wchar_t* filename)
+HRESULT Texture::AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const wchar_t* filename,
+    const MipGenerator::Options& mipOptions, JobSystem* jobs)
 {
-    Memory::SafeRelease(m_imageSamplerState);
-    Memory::SafeRelease(m_textureView);
-    Memory::SafeRelease(m_texture);
-
     // Bilddaten laden
-    int imageWidth, imageHeight, imageChannels;
+    int imageWidth, imageHeight;
+    unsigned char* imageData = LoadPixels(filename, imageWidth, imageHeight);
+
+    if (!imageData)
+    {
+        Debug::Log("FAIL LOAD IMAGE ", __FILE__, __LINE__);
+        return E_FAIL;
+    }
+
+    // Mip chain on the CPU, all levels go along as initial data
+    MipGenerator::MipChain mips;
+    MipGenerator::Generate(imageData, imageWidth, imageHeight, mips, mipOptions, jobs);
+
+    HRESULT hr = CreateFromPixels(device, imageData, imageWidth, imageHeight, &mips);
+    FreePixels(imageData);
+    if (FAILED(hr))
+        return hr;
+
+    // Dateinamen speichern
+    m_sFilename = filename;
+
+    return S_OK; // Erfolg
+
+}
+
+unsigned char* Texture::LoadPixels(const wchar_t* filename, int& width, int& height, std::string* error)
+{
+    int imageChannels;
     int desiredChannels = 4;
 
     char* narrowFilename = nullptr;
@@ -34,24 +57,78 @@ HRESULT Texture::AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceCon
     narrowFilename = new char[length];
     size_t convertedChars = 0;
     wcstombs_s(&convertedChars, narrowFilename, length, filename, length);
-    unsigned char* imageData = stbi_load(narrowFilename, &imageWidth, &imageHeight, &imageChannels, desiredChannels);
+    // stb_image's error text is thread-local, decoding on the loader threads works
+    unsigned char* imageData = stbi_load(narrowFilename, &width, &height, &imageChannels, desiredChannels);
     delete[] narrowFilename;
 
-    if (!imageData)
+    if (!imageData && error)
+        *error = stbi_failure_reason() ? stbi_failure_reason() : "cannot load image";
+
+    return imageData;
+}
+
+void Texture::FreePixels(unsigned char* pixels)
+{
+    if (pixels)
+        stbi_image_free(pixels);
+}
+
+HRESULT Texture::CreateFromPixels(ID3D11Device* device, const void* pixels, int width, int height,
+    const MipGenerator::MipChain* mips)
+{
+    const UINT mipLevels = 1 + (mips ? static_cast<UINT>(mips->levels.size()) : 0);
+
+    // Set up the subresource data: level 0 = input, then the mip chain
+    std::vector<D3D11_SUBRESOURCE_DATA> subresourceData(mipLevels);
+    subresourceData[0].pSysMem = pixels;
+    subresourceData[0].SysMemPitch = width * 4;
+    for (UINT i = 1; i < mipLevels; ++i)
     {
-        Debug::Log("FAIL LOAD IMAGE ", __FILE__, __LINE__);
-        return E_FAIL;
+        subresourceData[i].pSysMem = mips->GetLevel(i - 1);
+        subresourceData[i].SysMemPitch = mips->levels[i - 1].width * 4;
+    }
+
+    return CreateResources(device, DXGI_FORMAT_R8G8B8A8_UNORM, width, height, subresourceData.data(), mipLevels);
+}
+
+HRESULT Texture::CreateFromCooked(ID3D11Device* device, const CookedTexture& cooked)
+{
+    if (cooked.levels.empty())
+        return E_INVALIDARG;
+
+    DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    switch (cooked.format)
+    {
+    case TextureFormat::BC1: format = DXGI_FORMAT_BC1_UNORM; break;
+    case TextureFormat::BC3: format = DXGI_FORMAT_BC3_UNORM; break;
+    case TextureFormat::BC7: format = DXGI_FORMAT_BC7_UNORM; break;
+    default: break;
+    }
+
+    // The levels point directly into the cache entry or the encoder buffer
+    std::vector<D3D11_SUBRESOURCE_DATA> subresourceData(cooked.levels.size());
+    for (size_t i = 0; i < cooked.levels.size(); ++i)
+    {
+        subresourceData[i].pSysMem = cooked.GetLevel(i);
+        subresourceData[i].SysMemPitch = cooked.levels[i].rowPitch;
     }
 
-    // Berechnung der maximalen Gre
-    UINT maxSize = imageWidth > imageHeight ? imageWidth : imageHeight;
+    return CreateResources(device, format, cooked.width, cooked.height, subresourceData.data(), static_cast<UINT>(cooked.levels.size()));
+}
+
+HRESULT Texture::CreateResources(ID3D11Device* device, DXGI_FORMAT format, int width, int height,
+    const D3D11_SUBRESOURCE_DATA* subresourceData, UINT mipLevels)
+{
+    Memory::SafeRelease(m_imageSamplerState);
+    Memory::SafeRelease(m_textureView);
+    Memory::SafeRelease(m_texture);
 
     // Texturbeschreibung erstellen
-    m_desc.Width = imageWidth;
-    m_desc.Height = imageHeight;
-    m_desc.MipLevels = 1;
+    m_desc.Width = width;
+    m_desc.Height = height;
+    m_desc.MipLevels = mipLevels;
     m_desc.ArraySize = 1;
-    m_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    m_desc.Format = format; // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
     m_desc.SampleDesc.Count = 1;
     m_desc.SampleDesc.Quality = 0;
     m_desc.Usage = D3D11_USAGE_DEFAULT;
@@ -59,17 +136,11 @@ HRESULT Texture::AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceCon
     m_desc.CPUAccessFlags = 0;
     m_desc.MiscFlags = 0;
 
-    // Subressource-Daten einrichten
-    D3D11_SUBRESOURCE_DATA subresourceData = {};
-    subresourceData.pSysMem = imageData;
-    subresourceData.SysMemPitch = imageWidth * 4;
-
     // Textur erstellen
-    HRESULT hr = device->CreateTexture2D(&m_desc, &subresourceData, &m_texture);
+    HRESULT hr = device->CreateTexture2D(&m_desc, subresourceData, &m_texture);
     if (FAILED(hr))
     {
         Debug::LogHr(__FILE__, __LINE__, hr);
-        stbi_image_free(imageData); 
         return hr; 
     }
 
@@ -77,14 +148,13 @@ HRESULT Texture::AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceCon
     D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Format = m_desc.Format;
     srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.MipLevels = mipLevels;
 
     hr = device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureView);
     if (FAILED(hr))
     {
         Debug::LogHr(__FILE__, __LINE__, hr);
         Memory::SafeRelease(m_texture); 
-        stbi_image_free(imageData); 
         return hr; 
     }
 
@@ -108,18 +178,12 @@ HRESULT Texture::AddTexture(ID3D11Device* device, ID3D11DeviceContext* deviceCon
     if (FAILED(hr))
     {
         Debug::LogHr(__FILE__, __LINE__, hr);
+        Memory::SafeRelease(m_textureView);
         Memory::SafeRelease(m_texture);
-        stbi_image_free(imageData); 
         return hr; 
     }
 
-    stbi_image_free(imageData); 
-
-    // Dateinamen speichern
-    m_sFilename = filename;
-
-    return S_OK; // Erfolg
-
+    return S_OK;
 }
 
 HRESULT Texture::CreateTexture(ID3D11Device* device, int width, int height) 
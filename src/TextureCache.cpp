@@ -0,0 +1,390 @@
+#include "TextureCache.h"
+#include "gdxdebug.h"
+#include "../third_party/stb_image.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+namespace
+{
+    // Bump on every change to MipGenerator/BlockCompressor: old entries are no longer hit
+    constexpr uint32_t ENCODER_VERSION = 1;
+
+    constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+    inline uint64_t Rotate(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+    inline uint64_t Read64(const uint8_t* p)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, 8);
+        return value;
+    }
+
+    inline uint32_t Read32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, 4);
+        return value;
+    }
+
+    inline uint64_t Round(uint64_t accumulator, uint64_t input)
+    {
+        return Rotate(accumulator + input * PRIME2, 31) * PRIME1;
+    }
+
+    inline uint64_t Merge(uint64_t hash, uint64_t value)
+    {
+        return (hash ^ Round(0, value)) * PRIME1 + PRIME4;
+    }
+
+    uint64_t AlignUp(uint64_t value)
+    {
+        return (value + TextureFile::ALIGNMENT - 1) & ~static_cast<uint64_t>(TextureFile::ALIGNMENT - 1);
+    }
+
+    bool SetError(std::string* error, const char* message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    }
+
+    BlockCompressor::Format ToBlockFormat(TextureFormat format)
+    {
+        switch (format) {
+        case TextureFormat::BC1:
+            return BlockCompressor::Format::BC1;
+        case TextureFormat::BC3:
+            return BlockCompressor::Format::BC3;
+        default:
+            return BlockCompressor::Format::BC7;
+        }
+    }
+
+    // Row pitch and size of a level in the respective format
+    void LevelLayout(TextureFormat format, uint32_t width, uint32_t height, uint32_t& rowPitch, size_t& size)
+    {
+        if (format == TextureFormat::RGBA8) {
+            rowPitch = width * 4;
+            size = size_t(width) * height * 4;
+            return;
+        }
+        rowPitch = static_cast<uint32_t>(BlockCompressor::RowPitch(ToBlockFormat(format), width));
+        size = BlockCompressor::CompressedSize(ToBlockFormat(format), width, height);
+    }
+}
+
+// ==================== COOKED TEXTURE ====================
+
+size_t CookedTexture::GetDataSize() const
+{
+    size_t size = 0;
+    for (const Level& level : levels)
+        size += level.size;
+    return size;
+}
+
+void CookedTexture::Reset()
+{
+    levels.clear();
+    m_storage.clear();
+    m_storage.shrink_to_fit();
+    m_file.Close();
+    m_data = nullptr;
+    width = height = 0;
+}
+
+void CookedTexture::Build(const uint8_t* rgba, uint32_t imageWidth, uint32_t imageHeight, const MipGenerator::MipChain& mips,
+    TextureFormat textureFormat, JobSystem* jobs)
+{
+    Reset();
+    format = textureFormat;
+    width = imageWidth;
+    height = imageHeight;
+
+    size_t offset = 0;
+    for (size_t i = 0; i <= mips.levels.size(); ++i) {
+        Level level = {};
+        level.width = i == 0 ? width : mips.levels[i - 1].width;
+        level.height = i == 0 ? height : mips.levels[i - 1].height;
+        LevelLayout(format, level.width, level.height, level.rowPitch, level.size);
+        level.offset = offset;
+        offset = static_cast<size_t>(AlignUp(offset + level.size));
+        levels.push_back(level);
+    }
+
+    m_storage.resize(offset);
+    m_data = m_storage.data();
+
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const uint8_t* source = i == 0 ? rgba : mips.GetLevel(i - 1);
+        uint8_t* target = m_storage.data() + levels[i].offset;
+        if (format == TextureFormat::RGBA8)
+            std::memcpy(target, source, levels[i].size);
+        else
+            BlockCompressor::Compress(source, levels[i].width, levels[i].height, ToBlockFormat(format), target, jobs);
+    }
+}
+
+// ==================== TEXTURE CACHE ====================
+
+uint64_t TextureCache::Hash(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        // Four independent lanes, 32 bytes per round
+        uint64_t v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+        for (const uint8_t* limit = end - 32; p <= limit; p += 32) {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+        }
+        hash = Rotate(v1, 1) + Rotate(v2, 7) + Rotate(v3, 12) + Rotate(v4, 18);
+        hash = Merge(hash, v1);
+        hash = Merge(hash, v2);
+        hash = Merge(hash, v3);
+        hash = Merge(hash, v4);
+    }
+    else {
+        hash = seed + PRIME5;
+    }
+
+    hash += size;
+    for (; p + 8 <= end; p += 8)
+        hash = Rotate(hash ^ Round(0, Read64(p)), 27) * PRIME1 + PRIME4;
+    if (p + 4 <= end) {
+        hash = Rotate(hash ^ (uint64_t(Read32(p)) * PRIME1), 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+        hash = Rotate(hash ^ (*p * PRIME5), 11) * PRIME1;
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t TextureCache::MakeKey(const void* source, size_t size, TextureCompression compression,
+    const MipGenerator::Options& mipOptions)
+{
+    uint32_t cutoff;
+    std::memcpy(&cutoff, &mipOptions.alphaCutoff, 4);
+
+    const uint32_t settings[] = {
+        ENCODER_VERSION,
+        TextureFile::VERSION,
+        static_cast<uint32_t>(compression),
+        static_cast<uint32_t>(mipOptions.filter),
+        mipOptions.srgb,
+        mipOptions.wrap,
+        mipOptions.preserveCoverage,
+        cutoff,
+        mipOptions.maxLevels,
+    };
+    return Hash(settings, sizeof(settings), Hash(source, size));
+}
+
+TextureFormat TextureCache::ChooseFormat(TextureCompression compression, const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+    if (compression == TextureCompression::None || width % 4 != 0 || height % 4 != 0)
+        return TextureFormat::RGBA8;
+
+    switch (compression) {
+    case TextureCompression::Auto:
+        return BlockCompressor::IsOpaque(rgba, size_t(width) * height) ? TextureFormat::BC1 : TextureFormat::BC3;
+    case TextureCompression::BC1:
+        return TextureFormat::BC1;
+    case TextureCompression::BC3:
+        return TextureFormat::BC3;
+    default:
+        return TextureFormat::BC7;
+    }
+}
+
+std::string TextureCache::GetPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.gdxt", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+bool TextureCache::Find(uint64_t key, CookedTexture& out)
+{
+    out.Reset();
+    if (m_directory.empty() || !out.m_file.Open(GetPath(key).c_str()))
+        return false;
+
+    const uint8_t* data = out.m_file.GetData();
+    const size_t size = out.m_file.GetSize();
+
+    // Validate everything before a pointer into the file is handed out
+    auto reject = [&]() {
+        out.Reset();
+        ++m_rejected;
+        return false;
+    };
+
+    if (size < sizeof(TextureFile::Header))
+        return reject();
+    const TextureFile::Header* header = reinterpret_cast<const TextureFile::Header*>(data);
+    if (header->magic != TextureFile::MAGIC || header->version != TextureFile::VERSION || header->key != key ||
+        header->fileSize != size || header->format > static_cast<uint32_t>(TextureFormat::BC7) ||
+        header->width == 0 || header->height == 0 || header->levelCount == 0 ||
+        header->levelCount > MipGenerator::CountLevels(header->width, header->height) ||
+        header->levelOffset % 8 != 0 || header->levelOffset > size ||
+        (size - header->levelOffset) / sizeof(TextureFile::LevelRecord) < header->levelCount)
+        return reject();
+
+    const TextureFile::LevelRecord* records = reinterpret_cast<const TextureFile::LevelRecord*>(data + header->levelOffset);
+    const uint64_t dataStart = header->levelOffset + uint64_t(header->levelCount) * sizeof(TextureFile::LevelRecord);
+
+    out.format = static_cast<TextureFormat>(header->format);
+    out.width = header->width;
+    out.height = header->height;
+
+    uint32_t width = header->width, height = header->height;
+    for (uint32_t i = 0; i < header->levelCount; ++i) {
+        const TextureFile::LevelRecord& record = records[i];
+        CookedTexture::Level level = {};
+        level.width = width;
+        level.height = height;
+        LevelLayout(out.format, width, height, level.rowPitch, level.size);
+
+        if (record.width != width || record.height != height || record.rowPitch != level.rowPitch ||
+            record.size != level.size || record.offset % TextureFile::ALIGNMENT != 0 ||
+            record.offset < dataStart || record.offset > size || size - record.offset < record.size)
+            return reject();
+
+        level.offset = static_cast<size_t>(record.offset);
+        out.levels.push_back(level);
+        width = (std::max)(width / 2, 1u);
+        height = (std::max)(height / 2, 1u);
+    }
+
+    out.m_data = data;
+    ++m_hits;
+    return true;
+}
+
+bool TextureCache::Store(uint64_t key, const CookedTexture& texture, std::string* error)
+{
+    if (m_directory.empty())
+        return SetError(error, "no cache directory");
+    if (texture.levels.empty())
+        return SetError(error, "empty texture");
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    TextureFile::Header header = {};
+    header.magic = TextureFile::MAGIC;
+    header.version = TextureFile::VERSION;
+    header.key = key;
+    header.format = static_cast<uint32_t>(texture.format);
+    header.width = texture.width;
+    header.height = texture.height;
+    header.levelCount = static_cast<uint32_t>(texture.levels.size());
+    header.levelOffset = sizeof(TextureFile::Header);
+
+    std::vector<TextureFile::LevelRecord> records(texture.levels.size());
+    uint64_t offset = AlignUp(header.levelOffset + records.size() * sizeof(TextureFile::LevelRecord));
+    for (size_t i = 0; i < records.size(); ++i) {
+        const CookedTexture::Level& level = texture.levels[i];
+        records[i].width = level.width;
+        records[i].height = level.height;
+        records[i].rowPitch = level.rowPitch;
+        records[i].size = level.size;
+        records[i].offset = offset;
+        offset = AlignUp(offset + level.size);
+    }
+    header.fileSize = offset;
+
+    // Unique name per thread and call, only the rename makes the entry visible
+    const std::string path = GetPath(key);
+    const std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+        "." + std::to_string(m_storeCounter++) + ".tmp";
+
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+        return SetError(error, "cannot open cache file for writing");
+
+    static const uint8_t padding[TextureFile::ALIGNMENT] = {};
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(records.data(), sizeof(TextureFile::LevelRecord), records.size(), file) == records.size();
+    uint64_t position = header.levelOffset + records.size() * sizeof(TextureFile::LevelRecord);
+    for (size_t i = 0; i < records.size() && written; ++i) {
+        written = std::fwrite(padding, 1, static_cast<size_t>(records[i].offset - position), file) == records[i].offset - position &&
+            std::fwrite(texture.GetLevel(i), 1, texture.levels[i].size, file) == texture.levels[i].size;
+        position = records[i].offset + records[i].size;
+    }
+    if (written)
+        written = std::fwrite(padding, 1, static_cast<size_t>(header.fileSize - position), file) == header.fileSize - position;
+    const bool closed = std::fclose(file) == 0;
+
+    if (written && closed)
+        std::filesystem::rename(temporary, path, ec);
+    if (!written || !closed || ec) {
+        std::filesystem::remove(temporary, ec);
+        return SetError(error, "cannot write cache file");
+    }
+
+    ++m_stored;
+    return true;
+}
+
+bool TextureCache::Load(const char* path, TextureCompression compression, const MipGenerator::Options& mipOptions,
+    CookedTexture& out, JobSystem* jobs, std::string* error)
+{
+    out.Reset();
+
+    // Only map and hash the source; decoding happens only without a hit
+    MeshFile::MappedFile source;
+    if (!source.Open(path))
+        return SetError(error, "cannot open file");
+
+    const uint64_t key = MakeKey(source.GetData(), source.GetSize(), compression, mipOptions);
+    if (Find(key, out))
+        return true;
+    ++m_misses;
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()), &width, &height, &channels, 4);
+    if (!pixels)
+        return SetError(error, stbi_failure_reason() ? stbi_failure_reason() : "cannot decode image");
+
+    MipGenerator::MipChain mips;
+    MipGenerator::Generate(pixels, width, height, mips, mipOptions, jobs);
+    out.Build(pixels, width, height, mips, ChooseFormat(compression, pixels, width, height), jobs);
+    stbi_image_free(pixels);
+
+    std::string storeError;
+    if (!m_directory.empty() && !Store(key, out, &storeError))
+        Debug::Log("TextureCache.cpp: Store - ", path, ": ", storeError.c_str());
+    return true;
+}
+
+TextureCacheStats TextureCache::GetStats() const
+{
+    TextureCacheStats stats;
+    stats.hits = m_hits.load();
+    stats.misses = m_misses.load();
+    stats.stored = m_stored.load();
+    stats.rejected = m_rejected.load();
+    return stats;
+}
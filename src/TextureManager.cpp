@@ -2,7 +2,98 @@
 
 using namespace DirectX;
 
-TextureManager::TextureManager() {}
+namespace
+{
+    // Like Texture::LoadPixels: TextureCache works with narrow paths
+    std::string NarrowPath(const wchar_t* filename)
+    {
+        size_t length = wcslen(filename) + 1;
+        std::string narrowFilename(length, '\0');
+        size_t convertedChars = 0;
+        wcstombs_s(&convertedChars, &narrowFilename[0], length, filename, length);
+        narrowFilename.resize(convertedChars > 0 ? convertedChars - 1 : 0);
+        return narrowFilename;
+    }
+
+    // Decode on the loader thread, replace texture/view/sampler in the upload
+    class TextureRequest : public AssetRequest
+    {
+    public:
+        TextureRequest(ID3D11Device* device, Texture* texture, const wchar_t* filename, const MipGenerator::Options& mipOptions,
+            TextureCompression compression, TextureCache& cache, TextureManager::TextureReadyCallback onReady) :
+            m_device(device), m_texture(texture), m_filename(filename), m_mipOptions(mipOptions),
+            m_compression(compression), m_cache(cache), m_onReady(std::move(onReady)) {}
+
+        ~TextureRequest() override { Texture::FreePixels(m_pixels); }
+
+        bool Load() override
+        {
+            // Cache hit or encoding on the loader thread (without JobSystem)
+            if (m_compression != TextureCompression::None)
+                return m_cache.Load(NarrowPath(m_filename.c_str()).c_str(), m_compression, m_mipOptions, m_cooked, nullptr, &error);
+
+            m_pixels = Texture::LoadPixels(m_filename.c_str(), m_width, m_height, &error);
+            if (!m_pixels)
+                return false;
+
+            // Mips right here: the JobSystem belongs to the frame
+            MipGenerator::Generate(m_pixels, m_width, m_height, m_mips, m_mipOptions);
+            return true;
+        }
+
+        size_t GetUploadBytes() const override
+        {
+            if (m_compression != TextureCompression::None)
+                return m_cooked.GetDataSize();
+            return size_t(m_width) * m_height * 4 + m_mips.data.size();
+        }
+
+        bool Upload() override
+        {
+            if (!m_device)
+                return true;
+
+            // Hold on to the placeholder until the materials are rebound: its address must
+            // not be handed out to the new view
+            ID3D11ShaderResourceView* placeholder = m_texture->m_textureView;
+            if (placeholder)
+                placeholder->AddRef();
+
+            HRESULT hr = m_compression != TextureCompression::None ?
+                m_texture->CreateFromCooked(m_device, m_cooked) :
+                m_texture->CreateFromPixels(m_device, m_pixels, m_width, m_height, &m_mips);
+            if (SUCCEEDED(hr) && m_onReady)
+                m_onReady(m_texture, placeholder);
+
+            Memory::SafeRelease(placeholder);
+            Texture::FreePixels(m_pixels);
+            m_pixels = nullptr;
+            m_cooked.Reset();
+
+            if (FAILED(hr)) {
+                error = "cannot create texture";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        ID3D11Device* m_device;
+        Texture* m_texture;
+        std::wstring m_filename;
+        MipGenerator::Options m_mipOptions;
+        TextureCompression m_compression;
+        TextureCache& m_cache;
+        TextureManager::TextureReadyCallback m_onReady;
+        unsigned char* m_pixels = nullptr;
+        MipGenerator::MipChain m_mips;
+        CookedTexture m_cooked;
+        int m_width = 0;
+        int m_height = 0;
+    };
+}
+
+TextureManager::TextureManager() : m_jobSystem(nullptr), m_compression(TextureCompression::None) {}
 
 TextureManager::~TextureManager() {
     this->ReleaseTexture();
@@ -32,7 +123,10 @@ HRESULT TextureManager::LoadTexture(ID3D11Device* device, ID3D11DeviceContext* d
     if (textureIndex == -1) 
     {
         (*lpTexture) = new TEXTURE;
-        (*lpTexture)->AddTexture(device, deviceContext, filename);
+        if (m_compression == TextureCompression::None)
+            (*lpTexture)->AddTexture(device, deviceContext, filename, m_mipOptions, m_jobSystem);
+        else
+            this->LoadCooked(device, filename, *lpTexture);
         this->tc.push_back(*lpTexture);
     }
     else
@@ -44,6 +138,53 @@ HRESULT TextureManager::LoadTexture(ID3D11Device* device, ID3D11DeviceContext* d
     return hr;
 }
 
+AssetHandle TextureManager::LoadTextureAsync(ID3D11Device* device, const wchar_t* filename, LPLPTEXTURE lpTexture,
+    AssetLoader& loader, TextureReadyCallback onReady, UINT32 placeholder) {
+
+    int textureIndex = this->CheckTexture(filename);
+    if (textureIndex != -1)
+    {
+        (*lpTexture) = this->tc[textureIndex];
+        return (*lpTexture)->m_asset;
+    }
+
+    (*lpTexture) = new TEXTURE;
+    (*lpTexture)->m_sFilename = filename;
+    this->tc.push_back(*lpTexture);
+
+    if (device) {
+        HRESULT hr = (*lpTexture)->CreateFromPixels(device, &placeholder, 1, 1);
+        if (FAILED(hr))
+            Debug::Log("TextureManager.cpp: LoadTextureAsync - cannot create placeholder");
+    }
+
+    (*lpTexture)->m_asset = loader.Submit(std::make_unique<TextureRequest>(device, *lpTexture, filename, m_mipOptions,
+        EffectiveCompression(device), m_cache, std::move(onReady)));
+    return (*lpTexture)->m_asset;
+}
+
+HRESULT TextureManager::LoadCooked(ID3D11Device* device, const wchar_t* filename, LPTEXTURE texture) {
+    CookedTexture cooked;
+    std::string error;
+    if (!m_cache.Load(NarrowPath(filename).c_str(), EffectiveCompression(device), m_mipOptions, cooked, m_jobSystem, &error))
+    {
+        Debug::Log("TextureManager.cpp: LoadTexture - ", error.c_str());
+        return E_FAIL;
+    }
+
+    HRESULT hr = texture->CreateFromCooked(device, cooked);
+    if (SUCCEEDED(hr))
+        texture->m_sFilename = filename;
+    return hr;
+}
+
+TextureCompression TextureManager::EffectiveCompression(ID3D11Device* device) const {
+    // BC7 is only available from feature level 11.0
+    if (m_compression == TextureCompression::BC7 && device && device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0)
+        return TextureCompression::Auto;
+    return m_compression;
+}
+
 int TextureManager::CheckTexture(std::wstring sFilename) {
     int textureIndex = -1;
 
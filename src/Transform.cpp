@@ -7,64 +7,58 @@ static const XMVECTOR upVector = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
 static const XMVECTOR rightVector = XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
 
 // =========== KONSTRUKTOREN ===========
-Transform::Transform() :
-    position(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f)),
-    rotationQuat(XMQuaternionIdentity()),
-    scale(XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f)),
-    matricesDirty(true),
-    worldMatrix(nullptr),
-    vectorsDirty(true)
+Transform::Transform(TransformSystem& transformSystem) :
+    handle(transformSystem.Allocate()),
+    system(&transformSystem),
+    worldMatrix(nullptr)
 {
-    rotationMatrix = XMMatrixIdentity();
-    translationMatrix = XMMatrixIdentity();
-    scalingMatrix = XMMatrixIdentity();
-    lookAt = forwardVector;
-    up = upVector;
-    right = rightVector;
 }
 
-Transform::Transform(XMMATRIX* world) : Transform()
+Transform::Transform(TransformSystem& transformSystem, XMMATRIX* world) : Transform(transformSystem)
 {
     worldMatrix = world;
 }
 
-Transform::~Transform()
+Transform::Transform(const Transform& other) :
+    handle(other.system->Allocate()),
+    system(other.system),
+    worldMatrix(nullptr)    // external matrix belongs to the other object
 {
-    // Keine dynamisch allozierten Ressourcen - worldMatrix wird extern verwaltet
+    *this = other;
 }
 
-// =========== PRIVATE HELPER ===========
-void Transform::UpdateMatrices() const
+Transform::Transform(Transform&& other) noexcept :
+    handle(other.handle),
+    system(other.system),
+    worldMatrix(other.worldMatrix)
 {
-    if (!matricesDirty) return;
-
-    // Ändern von mutable Membern ist in const-Funktion erlaubt
-    scalingMatrix = XMMatrixScalingFromVector(scale);
-    rotationMatrix = XMMatrixRotationQuaternion(rotationQuat);
-    translationMatrix = XMMatrixTranslationFromVector(position);
-
-    matricesDirty = false;
-    vectorsDirty = true;
-
-    // Update externe World Matrix
-    if (worldMatrix) {
-        *worldMatrix = scalingMatrix * rotationMatrix * translationMatrix;
-    }
+    other.handle = TransformSystem::INVALID_HANDLE;
+    other.worldMatrix = nullptr;
 }
 
-void Transform::UpdateDirectionVectors() const
+Transform& Transform::operator=(const Transform& other)
 {
-    if (!vectorsDirty) return;
+    if (this == &other) return *this;
 
-    XMMATRIX rot = GetRotation();
+    // A moved-from Transform becomes valid again when assigned to
+    if (handle == TransformSystem::INVALID_HANDLE)
+        handle = System().Allocate();
 
-    lookAt = XMVector3Normalize(XMVector3TransformNormal(forwardVector, rot));
-    up = XMVector3Normalize(XMVector3TransformNormal(upVector, rot));
-    right = XMVector3Normalize(XMVector3TransformNormal(rightVector, rot));
+    TransformSystem& ts = System();
+    ts.StorePosition(handle, other.GetPosition());
+    ts.StoreRotation(handle, other.GetRotationQuaternion());
+    ts.StoreScale(handle, other.GetScaleVector());
+    return *this;
+}
 
-    vectorsDirty = false;
+Transform::~Transform()
+{
+    // worldMatrix is managed externally, only release the pool slot
+    if (handle != TransformSystem::INVALID_HANDLE)
+        System().Release(handle);
 }
 
+// =========== PRIVATE HELPER ===========
 XMVECTOR Transform::EulerToQuaternion(float pitch, float yaw, float roll) const
 {
     pitch = XMConvertToRadians(pitch);
@@ -101,6 +95,7 @@ void Transform::QuaternionToEuler(const XMVECTOR& quat, float& pitch, float& yaw
 void Transform::Rotate(float fRotateX, float fRotateY, float fRotateZ, Space space)
 {
     XMVECTOR delta = EulerToQuaternion(fRotateX, fRotateY, fRotateZ);
+    XMVECTOR rotationQuat = GetRotationQuaternion();
 
     if (space == Space::World) {
         rotationQuat = XMQuaternionMultiply(delta, rotationQuat);
@@ -109,8 +104,7 @@ void Transform::Rotate(float fRotateX, float fRotateY, float fRotateZ, Space spa
         rotationQuat = XMQuaternionMultiply(rotationQuat, delta);
     }
 
-    rotationQuat = XMQuaternionNormalize(rotationQuat);
-    matricesDirty = true;
+    System().StoreRotation(handle, XMQuaternionNormalize(rotationQuat));
 }
 
 void Transform::Turn(float fRotateX, float fRotateY, float fRotateZ, Space space)
@@ -120,8 +114,7 @@ void Transform::Turn(float fRotateX, float fRotateY, float fRotateZ, Space space
 
 void Transform::Position(float x, float y, float z)
 {
-    position = XMVectorSet(x, y, z, 1.0f);
-    matricesDirty = true;
+    System().StorePosition(handle, XMVectorSet(x, y, z, 1.0f));
 }
 
 void Transform::Move(float x, float y, float z, Space space)
@@ -129,22 +122,20 @@ void Transform::Move(float x, float y, float z, Space space)
     XMVECTOR trans = XMVectorSet(x, y, z, 0.0f);
 
     if (space == Space::Local) {
-        trans = XMVector3Rotate(trans, rotationQuat);
+        trans = XMVector3Rotate(trans, GetRotationQuaternion());
     }
 
-    position = XMVectorAdd(position, trans);
-    matricesDirty = true;
+    System().StorePosition(handle, XMVectorAdd(GetPosition(), trans));
 }
 
 void Transform::Scale(float x, float y, float z)
 {
-    scale = XMVectorSet(x, y, z, 0.0f);
-    matricesDirty = true;
+    System().StoreScale(handle, XMVectorSet(x, y, z, 0.0f));
 }
 
 void Transform::LookAt(const XMVECTOR& target, const XMVECTOR& upVec)
 {
-    XMVECTOR forward = XMVector3Normalize(XMVectorSubtract(target, position));
+    XMVECTOR forward = XMVector3Normalize(XMVectorSubtract(target, GetPosition()));
 
     XMVECTOR up = upVec;
 
@@ -167,57 +158,49 @@ void Transform::LookAt(const XMVECTOR& target, const XMVECTOR& upVec)
     rotMatrix.r[2] = XMVectorSetW(forward, 0.0f);
     rotMatrix.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
 
-    rotationQuat = XMQuaternionNormalize(XMQuaternionRotationMatrix(rotMatrix));
-    matricesDirty = true;
-    vectorsDirty = true;  // ← WICHTIG: Vektoren müssen neu berechnet werden!
+    System().StoreRotation(handle, XMQuaternionNormalize(XMQuaternionRotationMatrix(rotMatrix)));
 }
 
 float Transform::Distance(const XMVECTOR& target) const
 {
-    XMVECTOR difference = XMVectorSubtract(target, position);
+    XMVECTOR difference = XMVectorSubtract(target, GetPosition());
     return XMVectorGetX(XMVector3Length(difference));
 }
 
 XMMATRIX Transform::GetLocalTransformationMatrix() const
 {
-    UpdateMatrices();
-    return scalingMatrix * rotationMatrix * translationMatrix;
+    return GetWorldMatrix();
 }
 
+// Direction vectors straight from the quaternion (no cache needed, the quaternion is normalized)
 XMVECTOR Transform::GetLookAt() const
 {
-    UpdateDirectionVectors();
-    return lookAt;
+    return XMVector3Rotate(forwardVector, GetRotationQuaternion());
 }
 
 XMVECTOR Transform::GetUp() const
 {
-    UpdateDirectionVectors();
-    return up;
+    return XMVector3Rotate(upVector, GetRotationQuaternion());
 }
 
 XMVECTOR Transform::GetRight() const
 {
-    UpdateDirectionVectors();
-    return right;
+    return XMVector3Rotate(rightVector, GetRotationQuaternion());
 }
 
 XMMATRIX Transform::GetRotation() const
 {
-    UpdateMatrices();
-    return rotationMatrix;
+    return XMMatrixRotationQuaternion(GetRotationQuaternion());
 }
 
 XMMATRIX Transform::GetTranslation() const
 {
-    UpdateMatrices();
-    return translationMatrix;
+    return XMMatrixTranslationFromVector(GetPosition());
 }
 
 XMMATRIX Transform::GetScaling() const
 {
-    UpdateMatrices();
-    return scalingMatrix;
+    return XMMatrixScalingFromVector(GetScaleVector());
 }
 
 // Legacy-Methoden
@@ -246,13 +229,13 @@ float Transform::GetPitch(const XMMATRIX* XMMatrix_p_Rotation) const
 
 void Transform::SetRotationQuaternion(const XMVECTOR& quaternion)
 {
-    rotationQuat = XMQuaternionNormalize(quaternion);
-    matricesDirty = true;
+    System().StoreRotation(handle, XMQuaternionNormalize(quaternion));
 }
 
 void Transform::RotateQuaternion(const XMVECTOR& quaternion, Space space)
 {
     XMVECTOR q = XMQuaternionNormalize(quaternion);
+    XMVECTOR rotationQuat = GetRotationQuaternion();
 
     if (space == Space::World) {
         rotationQuat = XMQuaternionMultiply(q, rotationQuat);
@@ -261,154 +244,165 @@ void Transform::RotateQuaternion(const XMVECTOR& quaternion, Space space)
         rotationQuat = XMQuaternionMultiply(rotationQuat, q);
     }
 
-    rotationQuat = XMQuaternionNormalize(rotationQuat);
-    matricesDirty = true;
+    System().StoreRotation(handle, XMQuaternionNormalize(rotationQuat));
 }
 
 // 2. EULER-WINKEL GETTER
 float Transform::GetPitch() const
 {
     float pitch, yaw, roll;
-    QuaternionToEuler(rotationQuat, pitch, yaw, roll);
+    QuaternionToEuler(GetRotationQuaternion(), pitch, yaw, roll);
     return pitch;
 }
 
 float Transform::GetYaw() const
 {
     float pitch, yaw, roll;
-    QuaternionToEuler(rotationQuat, pitch, yaw, roll);
+    QuaternionToEuler(GetRotationQuaternion(), pitch, yaw, roll);
     return yaw;
 }
 
 float Transform::GetRoll() const
 {
     float pitch, yaw, roll;
-    QuaternionToEuler(rotationQuat, pitch, yaw, roll);
+    QuaternionToEuler(GetRotationQuaternion(), pitch, yaw, roll);
     return roll;
 }
 
 // 3. SKALIERUNG GETTER/SETTER
 void Transform::SetScale(float x, float y, float z)
 {
-    scale = XMVectorSet(x, y, z, 0.0f);
-    matricesDirty = true;
+    System().StoreScale(handle, XMVectorSet(x, y, z, 0.0f));
 }
 
 void Transform::SetScale(float uniformScale)
 {
-    scale = XMVectorSet(uniformScale, uniformScale, uniformScale, 0.0f);
-    matricesDirty = true;
+    System().StoreScale(handle, XMVectorSet(uniformScale, uniformScale, uniformScale, 0.0f));
 }
 
 // 4. TRANSFORM OPERATIONEN
 void Transform::Translate(const XMVECTOR& translation, Space space)
 {
     if (space == Space::Local) {
-        position = XMVectorAdd(position, XMVector3Rotate(translation, rotationQuat));
+        System().StorePosition(handle, XMVectorAdd(GetPosition(), XMVector3Rotate(translation, GetRotationQuaternion())));
     }
     else {
-        position = XMVectorAdd(position, translation);
+        System().StorePosition(handle, XMVectorAdd(GetPosition(), translation));
     }
-    matricesDirty = true;
 }
 
 void Transform::SetPosition(const XMVECTOR& pos)
 {
-    position = XMVectorSetW(pos, 1.0f);
-    matricesDirty = true;
+    System().StorePosition(handle, XMVectorSetW(pos, 1.0f));
 }
 
 // 5. INTERPOLATION
 void Transform::Lerp(const Transform& target, float t)
 {
     // Linear interpolation für Position, Scale und Rotation
-    position = XMVectorLerp(position, target.position, t);
-    scale = XMVectorLerp(scale, target.scale, t);
-    rotationQuat = XMQuaternionSlerp(rotationQuat, target.rotationQuat, t);
-    matricesDirty = true;
+    System().StorePosition(handle, XMVectorLerp(GetPosition(), target.GetPosition(), t));
+    System().StoreScale(handle, XMVectorLerp(GetScaleVector(), target.GetScaleVector(), t));
+    System().StoreRotation(handle, XMQuaternionSlerp(GetRotationQuaternion(), target.GetRotationQuaternion(), t));
 }
 
 void Transform::Slerp(const Transform& target, float t)
 {
     // Spherical linear interpolation für alle (Position, Scale und Rotation)
     // Position: Slerp für gleichmäßigere Bewegung
-    XMVECTOR posLength = XMVector3Length(XMVectorSubtract(target.position, position));
+    XMVECTOR position = GetPosition();
+    XMVECTOR targetPosition = target.GetPosition();
+    XMVECTOR posLength = XMVector3Length(XMVectorSubtract(targetPosition, position));
     float distance = XMVectorGetX(posLength);
 
     if (distance > 0.0001f) {
-        XMVECTOR direction = XMVector3Normalize(XMVectorSubtract(target.position, position));
+        XMVECTOR direction = XMVector3Normalize(XMVectorSubtract(targetPosition, position));
         position = XMVectorAdd(position, XMVectorScale(direction, distance * t));
     }
     else {
-        position = XMVectorLerp(position, target.position, t);
+        position = XMVectorLerp(position, targetPosition, t);
     }
 
     // Scale: Slerp für konsistente Skalierung
     XMFLOAT3 currentScale, targetScale;
-    XMStoreFloat3(&currentScale, scale);
-    XMStoreFloat3(&targetScale, target.scale);
+    XMStoreFloat3(&currentScale, GetScaleVector());
+    XMStoreFloat3(&targetScale, target.GetScaleVector());
 
     float scaleX = currentScale.x + (targetScale.x - currentScale.x) * t;
     float scaleY = currentScale.y + (targetScale.y - currentScale.y) * t;
     float scaleZ = currentScale.z + (targetScale.z - currentScale.z) * t;
-    scale = XMVectorSet(scaleX, scaleY, scaleZ, 0.0f);
+
+    TransformSystem& ts = System();
+    ts.StorePosition(handle, position);
+    ts.StoreScale(handle, XMVectorSet(scaleX, scaleY, scaleZ, 0.0f));
 
     // Rotation: Slerp
-    rotationQuat = XMQuaternionSlerp(rotationQuat, target.rotationQuat, t);
-    matricesDirty = true;
+    ts.StoreRotation(handle, XMQuaternionSlerp(GetRotationQuaternion(), target.GetRotationQuaternion(), t));
 }
 
 // 6. HELPER
 XMMATRIX Transform::GetWorldMatrix() const
 {
-    UpdateMatrices();
-    return scalingMatrix * rotationMatrix * translationMatrix;
+    // Cached S*R*T from the pool, recomputed only when dirty
+    XMMATRIX world = System().GetWorldMatrix(handle);
+    if (worldMatrix)
+        *worldMatrix = world;
+    return world;
+}
+
+void Transform::SetChanged(bool changed)
+{
+    if (changed)
+        System().MarkDirty(handle);
+    else
+        System().GetWorldMatrix(handle);    // recompute now, clears the flag
 }
 
 // 7. TRANSFORM COMBINATIONS
 Transform Transform::Combine(const Transform& other) const
 {
-    Transform result;
+    Transform result(System());
+    TransformSystem& ts = System();
 
-    result.position = XMVectorAdd(position,
-        XMVector3Rotate(other.position, rotationQuat));
-    result.rotationQuat = XMQuaternionMultiply(rotationQuat, other.rotationQuat);
+    XMVECTOR rotationQuat = GetRotationQuaternion();
+    ts.StorePosition(result.handle, XMVectorAdd(GetPosition(),
+        XMVector3Rotate(other.GetPosition(), rotationQuat)));
+    ts.StoreRotation(result.handle, XMQuaternionMultiply(rotationQuat, other.GetRotationQuaternion()));
 
     XMFLOAT3 thisScale, otherScale;
-    XMStoreFloat3(&thisScale, scale);
-    XMStoreFloat3(&otherScale, other.scale);
+    XMStoreFloat3(&thisScale, GetScaleVector());
+    XMStoreFloat3(&otherScale, other.GetScaleVector());
 
-    result.scale = XMVectorSet(
+    ts.StoreScale(result.handle, XMVectorSet(
         thisScale.x * otherScale.x,
         thisScale.y * otherScale.y,
         thisScale.z * otherScale.z,
         0.0f
-    );
+    ));
 
-    result.matricesDirty = true;
     return result;
 }
 
 Transform Transform::Inverse() const
 {
-    Transform result;
+    Transform result(System());
+    TransformSystem& ts = System();
 
-    result.position = XMVector3Rotate(XMVectorNegate(position),
-        XMQuaternionConjugate(rotationQuat));
-    result.rotationQuat = XMQuaternionConjugate(rotationQuat);
+    XMVECTOR rotationQuat = GetRotationQuaternion();
+    ts.StorePosition(result.handle, XMVector3Rotate(XMVectorNegate(GetPosition()),
+        XMQuaternionConjugate(rotationQuat)));
+    ts.StoreRotation(result.handle, XMQuaternionConjugate(rotationQuat));
 
     XMFLOAT3 s;
-    XMStoreFloat3(&s, scale);
+    XMStoreFloat3(&s, GetScaleVector());
 
     // Validierung gegen Division durch Zero
-    result.scale = XMVectorSet(
+    ts.StoreScale(result.handle, XMVectorSet(
         (s.x != 0.0f) ? 1.0f / s.x : 1.0f,
         (s.y != 0.0f) ? 1.0f / s.y : 1.0f,
         (s.z != 0.0f) ? 1.0f / s.z : 1.0f,
         0.0f
-    );
+    ));
 
-    result.matricesDirty = true;
     return result;
 }
 
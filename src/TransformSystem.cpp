@@ -0,0 +1,203 @@
+#include "TransformSystem.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+using namespace DirectX;
+
+TransformSystem::Handle TransformSystem::Allocate()
+{
+    Handle handle;
+
+    if (!m_freeList.empty())
+    {
+        handle = m_freeList.back();
+        m_freeList.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(m_positions.size());
+        m_positions.emplace_back();
+        m_rotations.emplace_back();
+        m_scales.emplace_back();
+        m_worldMatrices.emplace_back();
+        m_dirty.push_back(0);
+        m_versions.push_back(0);
+    }
+
+    // Identity: position 0, no rotation, scale 1
+    m_positions[handle] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    m_rotations[handle] = XMFLOAT4A(0.0f, 0.0f, 0.0f, 1.0f);
+    m_scales[handle] = XMFLOAT3(1.0f, 1.0f, 1.0f);
+    XMStoreFloat4x4A(&m_worldMatrices[handle], XMMatrixIdentity());
+    m_dirty[handle] = 0;
+    ++m_versions[handle];   // reused slot: old caches invalid
+
+    return handle;
+}
+
+void TransformSystem::Release(Handle handle)
+{
+    if (!IsValid(handle))
+        return;
+
+    // A leftover entry in m_dirtyList is skipped by the sweep
+    m_dirty[handle] = 0;
+    m_freeList.push_back(handle);
+}
+
+XMVECTOR TransformSystem::LoadPosition(Handle handle) const
+{
+    if (!IsValid(handle))
+        return g_XMIdentityR3;
+    return XMVectorSetW(XMLoadFloat3(&m_positions[handle]), 1.0f);
+}
+
+XMVECTOR TransformSystem::LoadRotation(Handle handle) const
+{
+    if (!IsValid(handle))
+        return XMQuaternionIdentity();
+    return XMLoadFloat4A(&m_rotations[handle]);
+}
+
+XMVECTOR TransformSystem::LoadScale(Handle handle) const
+{
+    if (!IsValid(handle))
+        return XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+    return XMLoadFloat3(&m_scales[handle]);
+}
+
+void TransformSystem::StorePosition(Handle handle, FXMVECTOR position)
+{
+    if (!IsValid(handle))
+        return;
+    XMStoreFloat3(&m_positions[handle], position);
+    MarkDirty(handle);
+}
+
+void TransformSystem::StoreRotation(Handle handle, FXMVECTOR rotation)
+{
+    if (!IsValid(handle))
+        return;
+    XMStoreFloat4A(&m_rotations[handle], rotation);
+    MarkDirty(handle);
+}
+
+void TransformSystem::StoreScale(Handle handle, FXMVECTOR scale)
+{
+    if (!IsValid(handle))
+        return;
+    XMStoreFloat3(&m_scales[handle], scale);
+    MarkDirty(handle);
+}
+
+void TransformSystem::MarkDirty(Handle handle)
+{
+    if (!IsValid(handle) || m_dirty[handle])
+        return;
+
+    m_dirty[handle] = 1;
+    m_dirtyList.push_back(handle);
+}
+
+XMMATRIX TransformSystem::ComposeWorld(FXMVECTOR position, FXMVECTOR rotation, FXMVECTOR scale)
+{
+    // S * R * T without three full matrix multiplications:
+    // scale the rows of the rotation matrix, translation into the last row
+    XMMATRIX world = XMMatrixRotationQuaternion(rotation);
+    world.r[0] = XMVectorMultiply(world.r[0], XMVectorSplatX(scale));
+    world.r[1] = XMVectorMultiply(world.r[1], XMVectorSplatY(scale));
+    world.r[2] = XMVectorMultiply(world.r[2], XMVectorSplatZ(scale));
+    world.r[3] = XMVectorSelect(g_XMIdentityR3, position, g_XMSelect1110);
+    return world;
+}
+
+void TransformSystem::UpdateEntry(Handle handle)
+{
+    XMMATRIX world = ComposeWorld(
+        XMLoadFloat3(&m_positions[handle]),
+        XMLoadFloat4A(&m_rotations[handle]),
+        XMLoadFloat3(&m_scales[handle]));
+
+    XMStoreFloat4x4A(&m_worldMatrices[handle], world);
+    m_dirty[handle] = 0;
+    ++m_versions[handle];
+}
+
+XMMATRIX TransformSystem::GetWorldMatrix(Handle handle)
+{
+    if (!IsValid(handle))
+        return XMMatrixIdentity();
+
+    if (m_dirty[handle])
+        UpdateEntry(handle);
+
+    return XMLoadFloat4x4A(&m_worldMatrices[handle]);
+}
+
+size_t TransformSystem::UpdateWorldMatrices(JobSystem* jobs)
+{
+    if (m_dirtyList.empty())
+        return 0;
+
+    // Below this count spreading over threads does not pay off
+    const size_t PARALLEL_THRESHOLD = 2048;
+    const size_t GRAIN_SIZE = 1024;
+
+    const bool parallel = jobs && jobs->IsParallel() && m_dirtyList.size() >= PARALLEL_THRESHOLD;
+    const size_t count = m_positions.size();
+    std::atomic<size_t> updated(0);
+
+    if (m_dirtyList.size() * 8 >= count)
+    {
+        // Many dirty entries: one linear pass over all flags,
+        // the pools are read and written strictly sequentially
+        auto sweep = [this, &updated](size_t begin, size_t end)
+        {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!m_dirty[i])
+                    continue;
+
+                UpdateEntry(static_cast<Handle>(i));
+                ++local;
+            }
+            updated.fetch_add(local, std::memory_order_relaxed);
+        };
+
+        if (parallel)
+            jobs->ParallelFor(count, GRAIN_SIZE * 4, sweep);
+        else
+            sweep(0, count);
+    }
+    else
+    {
+        // Few dirty entries: sort the list so access stays monotonic.
+        // Remove duplicates, otherwise two threads could write the same entry.
+        std::sort(m_dirtyList.begin(), m_dirtyList.end());
+        m_dirtyList.erase(std::unique(m_dirtyList.begin(), m_dirtyList.end()), m_dirtyList.end());
+
+        auto sweep = [this, &updated](size_t begin, size_t end)
+        {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                Handle handle = m_dirtyList[i];
+                if (!m_dirty[handle])
+                    continue;   // released or lazily updated in the meantime
+
+                UpdateEntry(handle);
+                ++local;
+            }
+            updated.fetch_add(local, std::memory_order_relaxed);
+        };
+
+        if (parallel)
+            jobs->ParallelFor(m_dirtyList.size(), GRAIN_SIZE, sweep);
+        else
+            sweep(0, m_dirtyList.size());
+    }
+
+    m_dirtyList.clear();
+    return updated.load();
+}
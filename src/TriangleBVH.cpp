@@ -0,0 +1,585 @@
+#include "TriangleBVH.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+// Binned SAH build as in the AABBTree; cost: visiting a node = 1, triangle test = 1
+static constexpr int SAH_BINS = 16;
+static constexpr float TRAVERSAL_COST = 1.0f;
+// Leaves up to this size stay when no split is cheaper
+static constexpr size_t MAX_LEAF_SIZE = 16;
+// Slab test: enlarge the exit distance slightly so rounding does not discard
+// a hit on a box edge (boxes are exactly as large as their triangles)
+static constexpr float SLAB_ROBUST_SCALE = 1.0000004f;
+
+static float SurfaceArea(const XMFLOAT3& lower, const XMFLOAT3& upper)
+{
+    const float dx = upper.x - lower.x;
+    const float dy = upper.y - lower.y;
+    const float dz = upper.z - lower.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void Union(const XMFLOAT3& lowerA, const XMFLOAT3& upperA, const XMFLOAT3& lowerB, const XMFLOAT3& upperB,
+    XMFLOAT3& lower, XMFLOAT3& upper)
+{
+    lower = XMFLOAT3((std::min)(lowerA.x, lowerB.x), (std::min)(lowerA.y, lowerB.y), (std::min)(lowerA.z, lowerB.z));
+    upper = XMFLOAT3((std::max)(upperA.x, upperB.x), (std::max)(upperA.y, upperB.y), (std::max)(upperA.z, upperB.z));
+}
+
+static float Axis(const XMFLOAT3& v, int axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// Face normal of a stored triangle (e1 x e2, not normalized)
+static XMFLOAT3 FaceNormal(const XMFLOAT3& e1, const XMFLOAT3& e2)
+{
+    return XMFLOAT3(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+}
+
+// 1 / d, a large finite number for d ~ 0: (lower - origin) * inverse never becomes NaN
+static float SafeInverse(float d)
+{
+    if (std::fabs(d) > 1e-20f)
+        return 1.0f / d;
+    return d >= 0.0f ? 1e20f : -1e20f;
+}
+
+void RayPacket::Set(int lane, const XMFLOAT3& rayOrigin, const XMFLOAT3& rayDirection)
+{
+    origin[0][lane] = rayOrigin.x;
+    origin[1][lane] = rayOrigin.y;
+    origin[2][lane] = rayOrigin.z;
+    direction[0][lane] = rayDirection.x;
+    direction[1][lane] = rayDirection.y;
+    direction[2][lane] = rayDirection.z;
+    inverse[0][lane] = SafeInverse(rayDirection.x);
+    inverse[1][lane] = SafeInverse(rayDirection.y);
+    inverse[2][lane] = SafeInverse(rayDirection.z);
+}
+
+void TriangleBVH::Clear()
+{
+    m_nodes.clear();
+    m_triangles.clear();
+    m_triangleIds.clear();
+    m_depth = 0;
+}
+
+size_t TriangleBVH::GetMemoryUsage() const
+{
+    return m_nodes.capacity() * sizeof(Node) +
+        m_triangles.capacity() * sizeof(Triangle) +
+        m_triangleIds.capacity() * sizeof(uint32_t);
+}
+
+void TriangleBVH::Build(const XMFLOAT3* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount)
+{
+    Clear();
+
+    const size_t triangleCount = indices ? indexCount / 3 : vertexCount / 3;
+    if (positions == nullptr || triangleCount == 0)
+        return;
+
+    auto corner = [&](size_t triangle, int i) -> size_t
+        {
+            return indices ? indices[triangle * 3 + i] : triangle * 3 + i;
+        };
+
+    // Build data only during construction, the finished BVH holds only nodes and triangles
+    std::vector<BuildItem> items;
+    items.reserve(triangleCount);
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const size_t i0 = corner(t, 0), i1 = corner(t, 1), i2 = corner(t, 2);
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+            continue;
+
+        const XMFLOAT3& a = positions[i0];
+        const XMFLOAT3& b = positions[i1];
+        const XMFLOAT3& c = positions[i2];
+
+        // Without area (determinant always 0) the triangle can never be hit
+        XMFLOAT3 normal;
+        XMStoreFloat3(&normal, XMVector3Cross(
+            XMVectorSubtract(XMLoadFloat3(&b), XMLoadFloat3(&a)),
+            XMVectorSubtract(XMLoadFloat3(&c), XMLoadFloat3(&a))));
+        if (normal.x == 0.0f && normal.y == 0.0f && normal.z == 0.0f)
+            continue;
+
+        BuildItem item;
+        Union(a, a, b, b, item.lower, item.upper);
+        Union(item.lower, item.upper, c, c, item.lower, item.upper);
+        item.centroid = XMFLOAT3(
+            (item.lower.x + item.upper.x) * 0.5f,
+            (item.lower.y + item.upper.y) * 0.5f,
+            (item.lower.z + item.upper.z) * 0.5f);
+        item.triangle = static_cast<uint32_t>(t);
+        items.push_back(item);
+    }
+
+    if (items.empty())
+        return;
+
+    // At most 2N - 1 nodes: no reallocation, references into m_nodes stay valid
+    m_nodes.reserve(items.size() * 2);
+    m_nodes.push_back(Node{});
+
+    struct Work
+    {
+        uint32_t node;
+        size_t begin;
+        size_t count;
+        int depth;
+    };
+    std::vector<Work> work;
+    work.push_back({ 0, 0, items.size(), 1 });
+
+    while (!work.empty())
+    {
+        const Work w = work.back();
+        work.pop_back();
+
+        Node& node = m_nodes[w.node];
+        node.lower = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+        node.upper = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (size_t i = w.begin; i < w.begin + w.count; ++i)
+            Union(node.lower, node.upper, items[i].lower, items[i].upper, node.lower, node.upper);
+
+        m_depth = (std::max)(m_depth, w.depth);
+
+        size_t split = 0;
+        if (w.count > LEAF_SIZE && w.depth < MAX_DEPTH)
+            split = SplitRange(items.data() + w.begin, w.count, node);
+
+        if (split == 0)
+        {
+            node.first = static_cast<uint32_t>(w.begin);
+            node.count = static_cast<uint32_t>(w.count);
+            continue;
+        }
+
+        const uint32_t left = static_cast<uint32_t>(m_nodes.size());
+        node.first = left;
+        node.count = 0;
+        m_nodes.push_back(Node{});
+        m_nodes.push_back(Node{});
+
+        work.push_back({ left + 1, w.begin + split, w.count - split, w.depth + 1 });
+        work.push_back({ left, w.begin, split, w.depth + 1 });
+    }
+
+    // Triangles in leaf order: a leaf reads one contiguous range
+    m_triangles.resize(items.size());
+    m_triangleIds.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const uint32_t t = items[i].triangle;
+        const XMFLOAT3& a = positions[corner(t, 0)];
+        const XMFLOAT3& b = positions[corner(t, 1)];
+        const XMFLOAT3& c = positions[corner(t, 2)];
+
+        Triangle& triangle = m_triangles[i];
+        triangle.v0 = a;
+        triangle.e1 = XMFLOAT3(b.x - a.x, b.y - a.y, b.z - a.z);
+        triangle.e2 = XMFLOAT3(c.x - a.x, c.y - a.y, c.z - a.z);
+        m_triangleIds[i] = t;
+    }
+    m_nodes.shrink_to_fit();
+}
+
+size_t TriangleBVH::SplitRange(BuildItem* items, size_t count, const Node& node)
+{
+    XMFLOAT3 cMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    XMFLOAT3 cMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < count; ++i)
+        Union(cMin, cMax, items[i].centroid, items[i].centroid, cMin, cMax);
+
+    const XMFLOAT3 size(cMax.x - cMin.x, cMax.y - cMin.y, cMax.z - cMin.z);
+    const int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+    const float axisMin = Axis(cMin, axis);
+    const float axisSize = Axis(size, axis);
+
+    auto byAxis = [axis](const BuildItem& a, const BuildItem& b) { return Axis(a.centroid, axis) < Axis(b.centroid, axis); };
+
+    // All centroids equal: SAH cannot split, halve large leaves anyway
+    if (axisSize <= 0.0f)
+        return count > MAX_LEAF_SIZE ? count / 2 : 0;
+
+    const float scale = SAH_BINS / axisSize;
+    auto binOf = [&](const BuildItem& item)
+        {
+            const int bin = static_cast<int>((Axis(item.centroid, axis) - axisMin) * scale);
+            return (std::min)(bin, SAH_BINS - 1);
+        };
+
+    struct Bin
+    {
+        XMFLOAT3 lower = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+        XMFLOAT3 upper = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        size_t count = 0;
+    };
+    Bin bins[SAH_BINS];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Bin& bin = bins[binOf(items[i])];
+        Union(bin.lower, bin.upper, items[i].lower, items[i].upper, bin.lower, bin.upper);
+        ++bin.count;
+    }
+
+    float rightCost[SAH_BINS] = {};
+    {
+        XMFLOAT3 lower(FLT_MAX, FLT_MAX, FLT_MAX), upper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        size_t n = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b)
+        {
+            if (bins[b].count)
+                Union(lower, upper, bins[b].lower, bins[b].upper, lower, upper);
+            n += bins[b].count;
+            rightCost[b] = n ? SurfaceArea(lower, upper) * n : 0.0f;
+        }
+    }
+
+    float bestCost = FLT_MAX;
+    int bestBin = -1;
+    XMFLOAT3 lower(FLT_MAX, FLT_MAX, FLT_MAX), upper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    size_t n = 0;
+    for (int b = 0; b < SAH_BINS - 1; ++b)
+    {
+        if (bins[b].count)
+            Union(lower, upper, bins[b].lower, bins[b].upper, lower, upper);
+        n += bins[b].count;
+        if (n == 0 || n == count)
+            continue;
+
+        const float cost = SurfaceArea(lower, upper) * n + rightCost[b + 1];
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestBin = b;
+        }
+    }
+
+    // Split does not pay off: stay a leaf as long as it does not get too large
+    const float nodeArea = SurfaceArea(node.lower, node.upper);
+    const float leafCost = nodeArea * count;
+    if (bestCost + TRAVERSAL_COST * nodeArea >= leafCost && count <= MAX_LEAF_SIZE)
+        return 0;
+
+    size_t split = 0;
+    if (bestBin >= 0)
+    {
+        BuildItem* middle = std::partition(items, items + count,
+            [&](const BuildItem& item) { return binOf(item) <= bestBin; });
+        split = static_cast<size_t>(middle - items);
+    }
+
+    if (split == 0 || split == count)
+    {
+        split = count / 2;
+        std::nth_element(items, items + split, items + count, byAxis);
+    }
+    return split;
+}
+
+// Ray against box: entry distance in tNear, false if missed or farther than tMax
+static bool SlabTest(const XMFLOAT3& lower, const XMFLOAT3& upper, const float origin[3], const float inverse[3],
+    float tMax, float& tNear)
+{
+    const float x0 = (lower.x - origin[0]) * inverse[0], x1 = (upper.x - origin[0]) * inverse[0];
+    const float y0 = (lower.y - origin[1]) * inverse[1], y1 = (upper.y - origin[1]) * inverse[1];
+    const float z0 = (lower.z - origin[2]) * inverse[2], z1 = (upper.z - origin[2]) * inverse[2];
+
+    tNear = (std::max)((std::max)((std::min)(x0, x1), (std::min)(y0, y1)), (std::max)((std::min)(z0, z1), 0.0f));
+    const float tFar = (std::min)((std::min)((std::max)(x0, x1), (std::max)(y0, y1)), (std::max)(z0, z1)) * SLAB_ROBUST_SCALE;
+    return tNear <= (std::min)(tFar, tMax);
+}
+
+bool TriangleBVH::Intersect(const XMFLOAT3& origin, const XMFLOAT3& direction, TriangleHit& hit, bool anyHit) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float inverse[3] = { SafeInverse(direction.x), SafeInverse(direction.y), SafeInverse(direction.z) };
+    const float dx = direction.x, dy = direction.y, dz = direction.z;
+
+    float best = hit.distance;
+    bool found = false;
+
+    struct Entry
+    {
+        uint32_t node;
+        float tNear;
+    };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+
+    float tNear;
+    if (!SlabTest(m_nodes[0].lower, m_nodes[0].upper, o, inverse, best, tNear))
+        return false;
+    stack[top++] = { 0, tNear };
+
+    while (top > 0)
+    {
+        const Entry entry = stack[--top];
+        if (entry.tNear > best)
+            continue;
+
+        const Node& node = m_nodes[entry.node];
+        if (node.count == 0)
+        {
+            float nearA, nearB;
+            const Node& a = m_nodes[node.first];
+            const Node& b = m_nodes[node.first + 1];
+            const bool hitA = SlabTest(a.lower, a.upper, o, inverse, best, nearA);
+            const bool hitB = SlabTest(b.lower, b.upper, o, inverse, best, nearB);
+
+            // Push the nearer child last -> it is visited first
+            if (hitA && hitB)
+            {
+                if (nearA <= nearB)
+                {
+                    stack[top++] = { node.first + 1, nearB };
+                    stack[top++] = { node.first, nearA };
+                }
+                else
+                {
+                    stack[top++] = { node.first, nearA };
+                    stack[top++] = { node.first + 1, nearB };
+                }
+            }
+            else if (hitA)
+                stack[top++] = { node.first, nearA };
+            else if (hitB)
+                stack[top++] = { node.first + 1, nearB };
+            continue;
+        }
+
+        // Möller-Trumbore, two-sided. Order of operations as in Intersect4
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            const Triangle& tri = m_triangles[i];
+
+            const float px = dy * tri.e2.z - dz * tri.e2.y;
+            const float py = dz * tri.e2.x - dx * tri.e2.z;
+            const float pz = dx * tri.e2.y - dy * tri.e2.x;
+            const float det = tri.e1.x * px + tri.e1.y * py + tri.e1.z * pz;
+            if (det == 0.0f)
+                continue;
+            const float invDet = 1.0f / det;
+
+            const float sx = o[0] - tri.v0.x;
+            const float sy = o[1] - tri.v0.y;
+            const float sz = o[2] - tri.v0.z;
+            const float u = (sx * px + sy * py + sz * pz) * invDet;
+            if (!(u >= 0.0f && u <= 1.0f))
+                continue;
+
+            const float qx = sy * tri.e1.z - sz * tri.e1.y;
+            const float qy = sz * tri.e1.x - sx * tri.e1.z;
+            const float qz = sx * tri.e1.y - sy * tri.e1.x;
+            const float v = (dx * qx + dy * qy + dz * qz) * invDet;
+            if (!(v >= 0.0f && u + v <= 1.0f))
+                continue;
+
+            const float t = (tri.e2.x * qx + tri.e2.y * qy + tri.e2.z * qz) * invDet;
+            if (!(t >= 0.0f && t < best))
+                continue;
+
+            best = t;
+            hit.u = u;
+            hit.v = v;
+            hit.triangle = m_triangleIds[i];
+            hit.normal = FaceNormal(tri.e1, tri.e2);
+            found = true;
+
+            if (anyHit)
+            {
+                hit.distance = best;
+                return true;
+            }
+        }
+    }
+
+    if (found)
+        hit.distance = best;
+    return found;
+}
+
+uint32_t TriangleBVH::Intersect4(const RayPacket& packet, TriangleHit hits[4], uint32_t activeMask, bool anyHit) const
+{
+    activeMask &= 0xF;
+    if (m_nodes.empty() || activeMask == 0)
+        return 0;
+
+    const XMVECTOR ox = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.origin[0]));
+    const XMVECTOR oy = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.origin[1]));
+    const XMVECTOR oz = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.origin[2]));
+    const XMVECTOR dx = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.direction[0]));
+    const XMVECTOR dy = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.direction[1]));
+    const XMVECTOR dz = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.direction[2]));
+    const XMVECTOR ix = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.inverse[0]));
+    const XMVECTOR iy = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.inverse[1]));
+    const XMVECTOR iz = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(packet.inverse[2]));
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR one = XMVectorSplatOne();
+    const XMVECTOR robust = XMVectorReplicate(SLAB_ROBUST_SCALE);
+
+    // Inactive (and, with anyHit, finished) lanes: maximum distance -1, they hit nothing anymore
+    float bestDistance[4];
+    for (int lane = 0; lane < 4; ++lane)
+        bestDistance[lane] = (activeMask & (1u << lane)) ? hits[lane].distance : -1.0f;
+    XMVECTOR best = XMVectorSet(bestDistance[0], bestDistance[1], bestDistance[2], bestDistance[3]);
+    float bestMax = (std::max)((std::max)(bestDistance[0], bestDistance[1]), (std::max)(bestDistance[2], bestDistance[3]));
+
+    TriangleHit result[4];
+    uint32_t hitMask = 0;
+
+    // Box against all lanes: smallest entry distance of the hitting lanes, false if none hits
+    auto slab4 = [&](const Node& node, float& tNear) -> bool
+        {
+            const XMVECTOR x0 = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.lower.x), ox), ix);
+            const XMVECTOR x1 = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.upper.x), ox), ix);
+            const XMVECTOR y0 = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.lower.y), oy), iy);
+            const XMVECTOR y1 = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.upper.y), oy), iy);
+            const XMVECTOR z0 = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.lower.z), oz), iz);
+            const XMVECTOR z1 = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.upper.z), oz), iz);
+
+            const XMVECTOR nearV = XMVectorMax(XMVectorMax(XMVectorMin(x0, x1), XMVectorMin(y0, y1)), XMVectorMax(XMVectorMin(z0, z1), zero));
+            const XMVECTOR farV = XMVectorMin(XMVectorMultiply(
+                XMVectorMin(XMVectorMin(XMVectorMax(x0, x1), XMVectorMax(y0, y1)), XMVectorMax(z0, z1)), robust), best);
+
+            const XMVECTOR inside = XMVectorLessOrEqual(nearV, farV);
+            XMFLOAT4A nearLanes;
+            XMStoreFloat4A(&nearLanes, XMVectorSelect(XMVectorReplicate(FLT_MAX), nearV, inside));
+            tNear = (std::min)((std::min)(nearLanes.x, nearLanes.y), (std::min)(nearLanes.z, nearLanes.w));
+            return tNear != FLT_MAX;
+        };
+
+    struct Entry
+    {
+        uint32_t node;
+        float tNear;
+    };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+
+    float tNear;
+    if (!slab4(m_nodes[0], tNear))
+        return 0;
+    stack[top++] = { 0, tNear };
+
+    while (top > 0)
+    {
+        const Entry entry = stack[--top];
+        if (entry.tNear > bestMax)
+            continue;
+
+        const Node& node = m_nodes[entry.node];
+        if (node.count == 0)
+        {
+            float nearA, nearB;
+            const bool hitA = slab4(m_nodes[node.first], nearA);
+            const bool hitB = slab4(m_nodes[node.first + 1], nearB);
+
+            if (hitA && hitB)
+            {
+                if (nearA <= nearB)
+                {
+                    stack[top++] = { node.first + 1, nearB };
+                    stack[top++] = { node.first, nearA };
+                }
+                else
+                {
+                    stack[top++] = { node.first, nearA };
+                    stack[top++] = { node.first + 1, nearB };
+                }
+            }
+            else if (hitA)
+                stack[top++] = { node.first, nearA };
+            else if (hitB)
+                stack[top++] = { node.first + 1, nearB };
+            continue;
+        }
+
+        bool improved = false;
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            const Triangle& tri = m_triangles[i];
+            const XMVECTOR e1x = XMVectorReplicate(tri.e1.x), e1y = XMVectorReplicate(tri.e1.y), e1z = XMVectorReplicate(tri.e1.z);
+            const XMVECTOR e2x = XMVectorReplicate(tri.e2.x), e2y = XMVectorReplicate(tri.e2.y), e2z = XMVectorReplicate(tri.e2.z);
+
+            const XMVECTOR px = XMVectorSubtract(XMVectorMultiply(dy, e2z), XMVectorMultiply(dz, e2y));
+            const XMVECTOR py = XMVectorSubtract(XMVectorMultiply(dz, e2x), XMVectorMultiply(dx, e2z));
+            const XMVECTOR pz = XMVectorSubtract(XMVectorMultiply(dx, e2y), XMVectorMultiply(dy, e2x));
+            const XMVECTOR det = XMVectorAdd(XMVectorAdd(XMVectorMultiply(e1x, px), XMVectorMultiply(e1y, py)), XMVectorMultiply(e1z, pz));
+            const XMVECTOR invDet = XMVectorDivide(one, det);
+
+            const XMVECTOR sx = XMVectorSubtract(ox, XMVectorReplicate(tri.v0.x));
+            const XMVECTOR sy = XMVectorSubtract(oy, XMVectorReplicate(tri.v0.y));
+            const XMVECTOR sz = XMVectorSubtract(oz, XMVectorReplicate(tri.v0.z));
+            const XMVECTOR u = XMVectorMultiply(XMVectorAdd(XMVectorAdd(XMVectorMultiply(sx, px), XMVectorMultiply(sy, py)), XMVectorMultiply(sz, pz)), invDet);
+
+            const XMVECTOR qx = XMVectorSubtract(XMVectorMultiply(sy, e1z), XMVectorMultiply(sz, e1y));
+            const XMVECTOR qy = XMVectorSubtract(XMVectorMultiply(sz, e1x), XMVectorMultiply(sx, e1z));
+            const XMVECTOR qz = XMVectorSubtract(XMVectorMultiply(sx, e1y), XMVectorMultiply(sy, e1x));
+            const XMVECTOR v = XMVectorMultiply(XMVectorAdd(XMVectorAdd(XMVectorMultiply(dx, qx), XMVectorMultiply(dy, qy)), XMVectorMultiply(dz, qz)), invDet);
+            const XMVECTOR t = XMVectorMultiply(XMVectorAdd(XMVectorAdd(XMVectorMultiply(e2x, qx), XMVectorMultiply(e2y, qy)), XMVectorMultiply(e2z, qz)), invDet);
+
+            // Comparisons with NaN are false: det == 0 drops out via u/v/t
+            XMVECTOR mask = XMVectorNotEqual(det, zero);
+            mask = XMVectorAndInt(mask, XMVectorAndInt(XMVectorGreaterOrEqual(u, zero), XMVectorLessOrEqual(u, one)));
+            mask = XMVectorAndInt(mask, XMVectorAndInt(XMVectorGreaterOrEqual(v, zero), XMVectorLessOrEqual(XMVectorAdd(u, v), one)));
+            mask = XMVectorAndInt(mask, XMVectorAndInt(XMVectorGreaterOrEqual(t, zero), XMVectorLess(t, best)));
+
+            uint32_t lanes[4];
+            XMStoreInt4(lanes, mask);
+            if ((lanes[0] | lanes[1] | lanes[2] | lanes[3]) == 0)
+                continue;
+
+            XMFLOAT4A tLanes, uLanes, vLanes;
+            XMStoreFloat4A(&tLanes, t);
+            XMStoreFloat4A(&uLanes, u);
+            XMStoreFloat4A(&vLanes, v);
+            const float* tl = &tLanes.x;
+            const float* ul = &uLanes.x;
+            const float* vl = &vLanes.x;
+
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (lanes[lane] == 0)
+                    continue;
+                result[lane].distance = tl[lane];
+                result[lane].u = ul[lane];
+                result[lane].v = vl[lane];
+                result[lane].triangle = m_triangleIds[i];
+                result[lane].normal = FaceNormal(tri.e1, tri.e2);
+                hitMask |= 1u << lane;
+            }
+
+            best = anyHit ? XMVectorSelect(best, XMVectorReplicate(-1.0f), mask) : XMVectorSelect(best, t, mask);
+            improved = true;
+        }
+
+        if (improved)
+        {
+            XMFLOAT4A bestLanes;
+            XMStoreFloat4A(&bestLanes, best);
+            bestMax = (std::max)((std::max)(bestLanes.x, bestLanes.y), (std::max)(bestLanes.z, bestLanes.w));
+            if (bestMax < 0.0f)
+                break;      // anyHit: all lanes done
+        }
+    }
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        if (hitMask & (1u << lane))
+            hits[lane] = result[lane];
+    }
+    return hitMask;
+}
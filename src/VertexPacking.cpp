@@ -0,0 +1,103 @@
+#include "VertexPacking.h"
+#include "Surface.h"
+#include <DirectXPackedVector.h>
+#include <cstring>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace VertexPacking
+{
+    Layout MakeLayout(DWORD flags, bool quantizedPosition)
+    {
+        Layout layout;
+        layout.flags = flags;
+        layout.quantizedPosition = quantizedPosition;
+
+        UINT offset = 0;
+        if (flags & D3DVERTEX_POSITION) {
+            layout.offsetPosition = offset;
+            offset += quantizedPosition ? sizeof(XMUSHORTN4) : sizeof(XMFLOAT3);
+        }
+        if (flags & D3DVERTEX_NORMAL)   { layout.offsetNormal = offset;   offset += sizeof(XMSHORTN4); }
+        if (flags & D3DVERTEX_COLOR)    { layout.offsetColor = offset;    offset += sizeof(XMUBYTEN4); }
+        if (flags & D3DVERTEX_TEX1)     { layout.offsetUV1 = offset;      offset += sizeof(XMHALF2); }
+        if (flags & D3DVERTEX_TEX2)     { layout.offsetUV2 = offset;      offset += sizeof(XMHALF2); }
+
+        layout.stride = offset;
+        return layout;
+    }
+
+    void MakeInputElements(const Layout& layout, UINT slot, std::vector<D3D11_INPUT_ELEMENT_DESC>& elements)
+    {
+        if (layout.offsetPosition != NOT_PRESENT)
+            elements.push_back({ "POSITION", 0, layout.quantizedPosition ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT,
+                slot, layout.offsetPosition, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        if (layout.offsetNormal != NOT_PRESENT)
+            elements.push_back({ "NORMAL", 0, DXGI_FORMAT_R16G16B16A16_SNORM, slot, layout.offsetNormal, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        if (layout.offsetColor != NOT_PRESENT)
+            elements.push_back({ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, slot, layout.offsetColor, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        if (layout.offsetUV1 != NOT_PRESENT)
+            elements.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, slot, layout.offsetUV1, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        // UV2 on TEXCOORD1 (CreateInputLayout rejects TEXCOORD0 twice)
+        if (layout.offsetUV2 != NOT_PRESENT)
+            elements.push_back({ "TEXCOORD", 1, DXGI_FORMAT_R16G16_FLOAT, slot, layout.offsetUV2, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+    }
+
+    void Pack(const Surface& surface, const Layout& layout, std::vector<uint8_t>& out)
+    {
+        Pack(surface, layout, surface.quantization, out);
+    }
+
+    void Pack(const Surface& surface, const Layout& layout, const Quantization& quantization, std::vector<uint8_t>& out)
+    {
+        const size_t count = surface.position.size();
+        out.resize(count * layout.stride);
+
+        std::vector<uint16_t> quantized;
+        if (layout.quantizedPosition && layout.offsetPosition != NOT_PRESENT)
+            QuantizePositions(surface.position.data(), count, quantization, quantized);
+
+        uint8_t* dst = out.data();
+        for (size_t i = 0; i < count; ++i, dst += layout.stride)
+        {
+            if (layout.offsetPosition != NOT_PRESENT)
+            {
+                if (layout.quantizedPosition)
+                    memcpy(dst + layout.offsetPosition, &quantized[i * 4], sizeof(XMUSHORTN4));
+                else
+                    memcpy(dst + layout.offsetPosition, &surface.position[i], sizeof(XMFLOAT3));
+            }
+
+            if (layout.offsetNormal != NOT_PRESENT)
+            {
+                const XMFLOAT3 n = i < surface.normal.size() ? surface.normal[i] : XMFLOAT3(0.0f, 0.0f, 1.0f);
+                XMSHORTN4 packed;
+                XMStoreShortN4(&packed, XMVectorSet(n.x, n.y, n.z, 0.0f));
+                memcpy(dst + layout.offsetNormal, &packed, sizeof(packed));
+            }
+
+            if (layout.offsetColor != NOT_PRESENT)
+            {
+                const XMFLOAT4 c = i < surface.color.size() ? surface.color[i] : XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+                XMUBYTEN4 packed;
+                XMStoreUByteN4(&packed, XMLoadFloat4(&c));
+                memcpy(dst + layout.offsetColor, &packed, sizeof(packed));
+            }
+
+            if (layout.offsetUV1 != NOT_PRESENT)
+            {
+                const XMFLOAT2 uv = i < surface.uv1.size() ? surface.uv1[i] : XMFLOAT2(0.0f, 0.0f);
+                const XMHALF2 packed(uv.x, uv.y);
+                memcpy(dst + layout.offsetUV1, &packed, sizeof(packed));
+            }
+
+            if (layout.offsetUV2 != NOT_PRESENT)
+            {
+                const XMFLOAT2 uv = i < surface.uv2.size() ? surface.uv2[i] : XMFLOAT2(0.0f, 0.0f);
+                const XMHALF2 packed(uv.x, uv.y);
+                memcpy(dst + layout.offsetUV2, &packed, sizeof(packed));
+            }
+        }
+    }
+}
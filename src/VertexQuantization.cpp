@@ -0,0 +1,77 @@
+#include "VertexQuantization.h"
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cfloat>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace VertexPacking
+{
+    // Zero or near-zero extents (planar surfaces) would make the
+    // dequantization singular
+    static XMFLOAT3 ClampedScale(const Quantization& quantization)
+    {
+        const XMFLOAT3& s = quantization.scale;
+        return XMFLOAT3(std::max(s.x, MIN_EXTENT), std::max(s.y, MIN_EXTENT), std::max(s.z, MIN_EXTENT));
+    }
+
+    Quantization ComputeQuantization(const XMFLOAT3* positions, size_t count)
+    {
+        Quantization quantization;
+        if (!positions || count == 0)
+            return quantization;
+
+        XMVECTOR vMin = XMVectorReplicate(FLT_MAX);
+        XMVECTOR vMax = XMVectorReplicate(-FLT_MAX);
+        for (size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR v = XMLoadFloat3(&positions[i]);
+            vMin = XMVectorMin(vMin, v);
+            vMax = XMVectorMax(vMax, v);
+        }
+
+        XMStoreFloat3(&quantization.offset, vMin);
+        XMStoreFloat3(&quantization.scale, XMVectorSubtract(vMax, vMin));
+        quantization.scale = ClampedScale(quantization);
+        return quantization;
+    }
+
+    void QuantizePositions(const XMFLOAT3* positions, size_t count, const Quantization& quantization, std::vector<uint16_t>& out)
+    {
+        out.resize(count * 4);
+
+        // Flat axis: every value 0, the dequantization yields offset
+        const XMFLOAT3 s = ClampedScale(quantization);
+        const XMVECTOR invScale = XMVectorSet(1.0f / s.x, 1.0f / s.y, 1.0f / s.z, 0.0f);
+        const XMVECTOR offset = XMLoadFloat3(&quantization.offset);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR q = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&positions[i]), offset), invScale);
+            q = XMVectorSetW(q, 0.0f);
+
+            XMUSHORTN4 packed;
+            XMStoreUShortN4(&packed, q);
+            out[i * 4 + 0] = packed.x;
+            out[i * 4 + 1] = packed.y;
+            out[i * 4 + 2] = packed.z;
+            out[i * 4 + 3] = packed.w;
+        }
+    }
+
+    XMMATRIX DequantizeMatrix(const Quantization& quantization)
+    {
+        // Clamped as well: cooked files may still carry a scale of 0
+        const XMFLOAT3 s = ClampedScale(quantization);
+        return XMMatrixMultiply(
+            XMMatrixScaling(s.x, s.y, s.z),
+            XMMatrixTranslation(quantization.offset.x, quantization.offset.y, quantization.offset.z));
+    }
+
+    XMMATRIX NormalMatrix(const Quantization& quantization)
+    {
+        const XMFLOAT3 s = ClampedScale(quantization);
+        return XMMatrixScaling(1.0f / s.x, 1.0f / s.y, 1.0f / s.z);
+    }
+}
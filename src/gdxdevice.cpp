@@ -1,10 +1,121 @@
 ﻿#include "gdxutil.h"
 #include "gdxdevice.h"
 
+#include <memory>
+
+namespace
+{
+    // COM face of a GDXNullBuffer, so null buffers fit into the engine's
+    // ID3D11Buffer* slots and Memory::SafeRelease works unchanged. A buffer
+    // is recognized as ours only through QueryInterface with this private
+    // IID; foreign ID3D11Buffer pointers are never cast.
+    // {6F1C2A4E-93B7-4D0A-8E25-3C7B9D1F0A52}
+    const IID IID_GDXNullBuffer =
+        { 0x6f1c2a4e, 0x93b7, 0x4d0a, { 0x8e, 0x25, 0x3c, 0x7b, 0x9d, 0x1f, 0x0a, 0x52 } };
+
+    class GDXNullBufferCom : public ID3D11Buffer
+    {
+    public:
+        GDXNullBufferCom(const D3D11_BUFFER_DESC& desc, const void* initData) :
+            m_refCount(1),
+            m_desc(desc),
+            m_buffer(std::make_unique<GDXNullBuffer>(desc.ByteWidth, initData))
+        {
+        }
+
+        GDXNullBuffer* GetBuffer() const { return m_buffer.get(); }
+
+        // IUnknown
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+        {
+            if (!ppvObject)
+                return E_POINTER;
+
+            if (riid == IID_GDXNullBuffer ||
+                riid == __uuidof(IUnknown) ||
+                riid == __uuidof(ID3D11DeviceChild) ||
+                riid == __uuidof(ID3D11Resource) ||
+                riid == __uuidof(ID3D11Buffer))
+            {
+                *ppvObject = static_cast<ID3D11Buffer*>(this);
+                AddRef();
+                return S_OK;
+            }
+
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return ++m_refCount;
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            ULONG count = --m_refCount;
+            if (count == 0)
+                delete this;
+            return count;
+        }
+
+        // ID3D11DeviceChild
+        void STDMETHODCALLTYPE GetDevice(ID3D11Device** ppDevice) override
+        {
+            if (ppDevice) *ppDevice = nullptr;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return DXGI_ERROR_NOT_FOUND; }
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return S_OK; }
+
+        // ID3D11Resource
+        void STDMETHODCALLTYPE GetType(D3D11_RESOURCE_DIMENSION* pResourceDimension) override
+        {
+            if (pResourceDimension) *pResourceDimension = D3D11_RESOURCE_DIMENSION_BUFFER;
+        }
+
+        void STDMETHODCALLTYPE SetEvictionPriority(UINT) override {}
+        UINT STDMETHODCALLTYPE GetEvictionPriority() override { return 0; }
+
+        // ID3D11Buffer
+        void STDMETHODCALLTYPE GetDesc(D3D11_BUFFER_DESC* pDesc) override
+        {
+            if (pDesc) *pDesc = m_desc;
+        }
+
+    private:
+        ~GDXNullBufferCom() = default;
+
+        std::atomic<ULONG> m_refCount;
+        D3D11_BUFFER_DESC m_desc;
+        std::unique_ptr<GDXNullBuffer> m_buffer;
+    };
+
+    GDXNullBuffer* ResolveNullBuffer(ID3D11Buffer* buffer)
+    {
+        if (!buffer)
+            return nullptr;
+
+        GDXNullBufferCom* com = nullptr;
+        if (FAILED(buffer->QueryInterface(IID_GDXNullBuffer, reinterpret_cast<void**>(&com))) || !com)
+            return nullptr;
+
+        GDXNullBuffer* result = com->GetBuffer();
+        com->Release();
+        return result;
+    }
+}
+
 
 GDXDevice::GDXDevice() : m_bInitialized(false),
+m_backend(GDXBackend::D3D11),
+m_nullShadowWidth(0),
+m_nullShadowHeight(0),
 m_pd3dDevice(nullptr),
 m_pContext(nullptr),
+m_pContext1(nullptr),
+m_constantBufferOffsets(false),
 m_pSwapChain(nullptr),
 m_depthStencilBuffer(nullptr),
 m_depthStencilView(nullptr),
@@ -35,6 +146,7 @@ void GDXDevice::Release()
             m_pSwapChain->SetFullscreenState(FALSE, NULL);
 
         Memory::SafeRelease(m_pd3dDevice);
+        Memory::SafeRelease(m_pContext1);
         Memory::SafeRelease(m_pContext);
         Memory::SafeRelease(m_pSwapChain);
         Memory::SafeRelease(m_pBackBuffer);
@@ -51,6 +163,7 @@ void GDXDevice::Release()
         Memory::SafeRelease(m_shadowMatrixBuffer);
     }
 
+    m_constantBufferOffsets = false;
     m_bInitialized = false;
 }
 
@@ -59,6 +172,28 @@ HRESULT GDXDevice::Init()
     return EnumerateSystemDevices();
 }
 
+HRESULT GDXDevice::InitNull()
+{
+    // No DXGI, no D3D11: the context is only recorded
+    m_backend = GDXBackend::Null;
+    m_nullDevice.Reset();
+    m_bInitialized = true;
+
+    Debug::Log("gdxdevice.cpp: Null device initialized (headless, commands are recorded)");
+    return S_OK;
+}
+
+HRESULT GDXDevice::CreateNullResources(UINT shadowWidth, UINT shadowHeight)
+{
+    if (m_backend != GDXBackend::Null)
+        return E_FAIL;
+
+    m_nullShadowWidth = shadowWidth;
+    m_nullShadowHeight = shadowHeight;
+
+    return CreateShadowMatrixBuffer();
+}
+
 HRESULT GDXDevice::EnumerateSystemDevices()
 {
     Debug::Log("EnumerateSystemDevices START...");
@@ -178,6 +313,18 @@ HRESULT GDXDevice::InitializeDirectX(IDXGIAdapter* adapter, D3D_FEATURE_LEVEL* f
         return hr;
     }
 
+    // D3D11.1 optional: constant buffer offsets for the per-frame upload ring.
+    // Without it (Windows 7 without Platform Update) it stays at one Map per mesh.
+    m_constantBufferOffsets = false;
+    if (SUCCEEDED(m_pContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&m_pContext1))))
+    {
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+        if (SUCCEEDED(m_pd3dDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+            m_constantBufferOffsets = options.ConstantBufferOffsetting != FALSE;
+    }
+
+    Debug::Log("gdxdevice.cpp: Constant buffer offsets ", m_constantBufferOffsets ? "supported" : "not supported");
+
     return hr;
 }
 
@@ -254,6 +401,9 @@ HRESULT GDXDevice::CreateRenderTarget(unsigned int width, unsigned int height)
 
 HRESULT GDXDevice::Flip(int syncInterval)
 {
+    if (m_backend == GDXBackend::Null)
+        return S_OK;
+
     if (!m_pSwapChain)
         return E_INVALIDARG;
 
@@ -277,6 +427,7 @@ void GDXDevice::ResizeWindow(HWND hwnd, unsigned int x, unsigned int y, bool win
     if (!hwnd || x == 0 || y == 0)
         return;
 
+#ifdef _WIN32
     RECT rc;
     SetRect(&rc, 0, 0, x, y);
 
@@ -297,6 +448,9 @@ void GDXDevice::ResizeWindow(HWND hwnd, unsigned int x, unsigned int y, bool win
 
     ShowWindow(hwnd, SW_SHOWNORMAL);
     UpdateWindow(hwnd);
+#else
+    (void)windowed;
+#endif
 }
 
 HRESULT GDXDevice::CreateDepthBuffer(unsigned int width, unsigned int height)
@@ -668,7 +822,7 @@ HRESULT GDXDevice::CreateRenderStats()
 
 HRESULT GDXDevice::CreateShadowMatrixBuffer()
 {
-    if (!m_pd3dDevice)
+    if (!m_pd3dDevice && m_backend != GDXBackend::Null)
         return E_INVALIDARG;
 
     // Two matrices (view + projection) = 2 * 64 bytes = 128 bytes (16-byte aligned)
@@ -684,7 +838,7 @@ HRESULT GDXDevice::CreateShadowMatrixBuffer()
         m_shadowMatrixBuffer = nullptr;
     }
 
-    HRESULT hr = m_pd3dDevice->CreateBuffer(&bd, nullptr, &m_shadowMatrixBuffer);
+    HRESULT hr = CreateBuffer(&bd, nullptr, &m_shadowMatrixBuffer);
     if (FAILED(hr))
     {
         Debug::LogError("Failed to create Shadow Matrix constant buffer: ", hr);
@@ -693,4 +847,320 @@ HRESULT GDXDevice::CreateShadowMatrixBuffer()
 
     Debug::Log("gdxdevice.cpp: Shadow Matrix constant buffer created successfully (b3)");
     return S_OK;
-}
\ No newline at end of file
+}
+
+// ==================== RESOURCE / CONTEXT WRAPPERS ====================
+
+HRESULT GDXDevice::CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Buffer** buffer) const
+{
+    if (!desc || !buffer)
+        return E_INVALIDARG;
+
+    if (m_backend == GDXBackend::Null)
+    {
+        *buffer = new GDXNullBufferCom(*desc, initData ? initData->pSysMem : nullptr);
+        return S_OK;
+    }
+
+    if (!m_pd3dDevice)
+        return E_POINTER;
+
+    return m_pd3dDevice->CreateBuffer(desc, initData, buffer);
+}
+
+HRESULT GDXDevice::Map(ID3D11Buffer* buffer, D3D11_MAP mapType, D3D11_MAPPED_SUBRESOURCE* mapped) const
+{
+    if (!buffer || !mapped)
+        return E_INVALIDARG;
+
+    if (m_backend == GDXBackend::Null)
+    {
+        GDXNullBuffer* nullBuffer = ResolveNullBuffer(buffer);
+        if (!nullBuffer)
+        {
+            Debug::LogError("gdxdevice.cpp: Map on a buffer that was not created by the null device");
+            return E_INVALIDARG;
+        }
+
+        mapped->pData = m_nullDevice.Map(nullBuffer, buffer);
+        mapped->RowPitch = nullBuffer->GetByteWidth();
+        mapped->DepthPitch = nullBuffer->GetByteWidth();
+        return S_OK;
+    }
+
+    return m_pContext->Map(buffer, 0, mapType, 0, mapped);
+}
+
+void GDXDevice::Unmap(ID3D11Buffer* buffer) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Unmap(ResolveNullBuffer(buffer), buffer);
+        return;
+    }
+
+    m_pContext->Unmap(buffer, 0);
+}
+
+void GDXDevice::UpdateSubresource(ID3D11Buffer* buffer, const void* data, UINT rowPitch) const
+{
+    if (!buffer || !data)
+        return;
+
+    if (m_backend == GDXBackend::Null)
+    {
+        GDXNullBuffer* nullBuffer = ResolveNullBuffer(buffer);
+        if (!nullBuffer)
+        {
+            Debug::LogError("gdxdevice.cpp: UpdateSubresource on a buffer that was not created by the null device");
+            return;
+        }
+
+        m_nullDevice.UpdateSubresource(nullBuffer, data, buffer);
+        return;
+    }
+
+    m_pContext->UpdateSubresource(buffer, 0, nullptr, data, rowPitch, 0);
+}
+
+void GDXDevice::IASetInputLayout(ID3D11InputLayout* layout) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::IASetInputLayout, 0, 1, layout);
+        return;
+    }
+
+    m_pContext->IASetInputLayout(layout);
+}
+
+void GDXDevice::IASetVertexBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::IASetVertexBuffers, startSlot, numBuffers, buffers ? buffers[0] : nullptr);
+        return;
+    }
+
+    m_pContext->IASetVertexBuffers(startSlot, numBuffers, buffers, strides, offsets);
+}
+
+void GDXDevice::IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::IASetIndexBuffer, 0, 1, buffer);
+        return;
+    }
+
+    m_pContext->IASetIndexBuffer(buffer, format, offset);
+}
+
+void GDXDevice::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::IASetPrimitiveTopology, 0, static_cast<UINT>(topology), nullptr);
+        return;
+    }
+
+    m_pContext->IASetPrimitiveTopology(topology);
+}
+
+void GDXDevice::VSSetShader(ID3D11VertexShader* shader) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::VSSetShader, 0, 1, shader);
+        return;
+    }
+
+    m_pContext->VSSetShader(shader, nullptr, 0);
+}
+
+void GDXDevice::PSSetShader(ID3D11PixelShader* shader) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::PSSetShader, 0, 1, shader);
+        return;
+    }
+
+    m_pContext->PSSetShader(shader, nullptr, 0);
+}
+
+void GDXDevice::VSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::VSSetConstantBuffers, startSlot, numBuffers, buffers ? buffers[0] : nullptr);
+        return;
+    }
+
+    m_pContext->VSSetConstantBuffers(startSlot, numBuffers, buffers);
+}
+
+void GDXDevice::PSSetConstantBuffers(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::PSSetConstantBuffers, startSlot, numBuffers, buffers ? buffers[0] : nullptr);
+        return;
+    }
+
+    m_pContext->PSSetConstantBuffers(startSlot, numBuffers, buffers);
+}
+
+void GDXDevice::VSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::VSSetConstantBuffers1, startSlot, numBuffers, buffers ? buffers[0] : nullptr);
+        return;
+    }
+
+    if (m_pContext1)
+        m_pContext1->VSSetConstantBuffers1(startSlot, numBuffers, buffers, firstConstant, numConstants);
+}
+
+void GDXDevice::PSSetConstantBuffers1(UINT startSlot, UINT numBuffers, ID3D11Buffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::PSSetConstantBuffers1, startSlot, numBuffers, buffers ? buffers[0] : nullptr);
+        return;
+    }
+
+    if (m_pContext1)
+        m_pContext1->PSSetConstantBuffers1(startSlot, numBuffers, buffers, firstConstant, numConstants);
+}
+
+void GDXDevice::VSSetShaderResources(UINT startSlot, UINT numViews, ID3D11ShaderResourceView* const* views) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::VSSetShaderResources, startSlot, numViews, views ? views[0] : nullptr);
+        return;
+    }
+
+    m_pContext->VSSetShaderResources(startSlot, numViews, views);
+}
+
+void GDXDevice::PSSetShaderResources(UINT startSlot, UINT numViews, ID3D11ShaderResourceView* const* views) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::PSSetShaderResources, startSlot, numViews, views ? views[0] : nullptr);
+        return;
+    }
+
+    m_pContext->PSSetShaderResources(startSlot, numViews, views);
+}
+
+void GDXDevice::PSSetSamplers(UINT startSlot, UINT numSamplers, ID3D11SamplerState* const* samplers) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::PSSetSamplers, startSlot, numSamplers, samplers ? samplers[0] : nullptr);
+        return;
+    }
+
+    m_pContext->PSSetSamplers(startSlot, numSamplers, samplers);
+}
+
+void GDXDevice::OMSetRenderTargets(UINT numViews, ID3D11RenderTargetView* const* rtvs, ID3D11DepthStencilView* dsv) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::OMSetRenderTargets, 0, numViews, dsv);
+        return;
+    }
+
+    m_pContext->OMSetRenderTargets(numViews, rtvs, dsv);
+}
+
+void GDXDevice::RSSetState(ID3D11RasterizerState* state) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::RSSetState, 0, 1, state);
+        return;
+    }
+
+    m_pContext->RSSetState(state);
+}
+
+void GDXDevice::RSSetViewports(UINT numViewports, const D3D11_VIEWPORT* viewports) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::RSSetViewports, 0, numViewports, viewports);
+        return;
+    }
+
+    m_pContext->RSSetViewports(numViewports, viewports);
+}
+
+void GDXDevice::ClearRenderTargetView(ID3D11RenderTargetView* rtv, const float color[4]) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::ClearRenderTargetView, 0, 1, rtv);
+        return;
+    }
+
+    m_pContext->ClearRenderTargetView(rtv, color);
+}
+
+void GDXDevice::ClearDepthStencilView(ID3D11DepthStencilView* dsv, UINT clearFlags, float depth, UINT8 stencil) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::ClearDepthStencilView, 0, clearFlags, dsv);
+        return;
+    }
+
+    m_pContext->ClearDepthStencilView(dsv, clearFlags, depth, stencil);
+}
+
+void GDXDevice::Draw(UINT vertexCount, UINT startVertex) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::Draw, startVertex, vertexCount, nullptr);
+        return;
+    }
+
+    m_pContext->Draw(vertexCount, startVertex);
+}
+
+void GDXDevice::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        m_nullDevice.Record(GDXCommandType::DrawIndexed, startIndex, indexCount, nullptr);
+        return;
+    }
+
+    m_pContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void GDXDevice::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) const
+{
+    if (m_backend == GDXBackend::Null)
+    {
+        // count = indices * instances, so the log reflects the amount of geometry
+        m_nullDevice.Record(GDXCommandType::DrawIndexedInstanced, startInstance, indexCount * instanceCount, nullptr);
+        return;
+    }
+
+    m_pContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+const GDXNullBuffer* GDXDevice::GetNullBuffer(ID3D11Buffer* buffer) const
+{
+    if (m_backend != GDXBackend::Null)
+        return nullptr;
+
+    return ResolveNullBuffer(buffer);
+}
@@ -1,7 +1,9 @@
 ﻿#include "gdxengine.h"
 #include "gdxdevice.h"   
+#ifdef _WIN32
 #include "gdxwin.h"      
 #include "core.h"
+#endif
 #include <fstream>
 
 namespace Engine
@@ -32,6 +34,31 @@ namespace Engine
 		return 0;
 	}
 
+	int CreateHeadlessEngine(int width, int height)
+	{
+		if (engine)
+			return 0;
+
+		int result = 0;
+		engine = new GDXEngine(
+			nullptr, nullptr,
+			32,
+			(unsigned)width,
+			(unsigned)height,
+			&result,
+			GDXBackend::Null
+		);
+
+		if (result != 0 || !engine)
+		{
+			delete engine;
+			engine = nullptr;
+			return (result != 0) ? result : -1;
+		}
+
+		return 0;
+	}
+
 	void ReleaseEngine()
 	{
 		delete engine;
@@ -52,10 +79,11 @@ GDXEngine* GDXEngine::s_instance = nullptr;
 // GetExeDir() und ResolveAbsolutePath() entfernt.
 
 //
-GDXEngine::GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int screenX, unsigned int screenY, int* result) :
-	m_objectManager(),
-	m_lightManager(),
-	m_renderManager(m_objectManager, m_lightManager, m_device)
+GDXEngine::GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int screenX, unsigned int screenY, int* result, GDXBackend backend) :
+	m_objectManager(m_transformSystem),
+	m_lightManager(m_transformSystem),
+	m_renderManager(m_objectManager, m_lightManager, m_device),
+	m_uploadBudget(8u << 20)
 {
 	m_colorDepth = bpp;
 	m_screenWidth = screenX;
@@ -63,7 +91,28 @@ GDXEngine::GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int
 	m_hwnd = hwnd;
 
 	m_globalAmbient = DirectX::XMFLOAT4(0.2f, 0.2f, 0.2f, 1.0f);  // Standard Ambient
+	// Worker threads: number of cores - 1, the main thread helps in Wait()
+	m_jobSystem.Init();
+	m_renderManager.SetJobSystem(&m_jobSystem);
+	m_collisionManager.SetJobSystem(&m_jobSystem);
+	m_texturManager.SetJobSystem(&m_jobSystem);
+
 	s_instance = this;  // Singleton setzen
+
+	// Loader threads for LoadTextureAsync/LoadMeshAsync
+	m_assetLoader.Init();
+
+	// Headless: no DXGI, no adapters, no shader files
+	if (backend == GDXBackend::Null)
+	{
+		m_device.InitNull();
+		m_adapterIndex = 0;
+		m_monitorIndex = 0;
+		m_bInitialized = true;
+		return;
+	}
+
+#ifdef _WIN32
 	m_device.Init();
 
 	m_interface.Init(bpp);
@@ -71,11 +120,12 @@ GDXEngine::GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int
 	int bestAdapter = FindBestAdapter();
 	this->SetAdapter(bestAdapter); 
 
-	// Shader-Pfade ueber Core aufloesen
+	// Resolve shader paths through Core
 	vs = Core::ResolvePath(L"..\\..\\shaders\\VertexShader.hlsl");
 	ps = Core::ResolvePath(L"..\\..\\shaders\\PixelShader.hlsl");
+	vsInstanced = Core::ResolvePath(L"..\\..\\shaders\\VertexShaderInstanced.hlsl");
 
-	// Prüfe ob Dateien existieren
+	// Check whether the files exist
 	std::wifstream vsFile(vs);
 	std::wifstream psFile(ps);
 
@@ -94,6 +144,10 @@ GDXEngine::GDXEngine(HWND hwnd, HINSTANCE hinst, unsigned int bpp, unsigned int
 	}
 
 	m_bInitialized = true;
+#else
+	Debug::LogError("gdxengine.cpp: D3D11 backend needs Windows, use CreateHeadlessEngine");
+	if (result) *result = -1;
+#endif
 }
 
 int GDXEngine::FindBestAdapter()
@@ -133,7 +187,9 @@ void GDXEngine::Cleanup()
 {
 	if (m_bInitialized)
 	{
-		// Clean-up operations
+		// Clean-up operations: discard open load requests before textures/meshes go away
+		m_assetLoader.Shutdown();
+		m_jobSystem.Shutdown();
 	}
 
 	m_bInitialized = false;
@@ -143,6 +199,9 @@ HRESULT GDXEngine::Graphic(unsigned int width, unsigned int height, bool windowe
 {
 	HRESULT hr = S_OK;
 
+	if (m_device.IsNull())
+		return GraphicNull(width, height);
+
 	// Index of current adapter (0 = Primary)
 	int index = GetAdapterIndex();
 
@@ -212,7 +271,7 @@ HRESULT GDXEngine::Graphic(unsigned int width, unsigned int height, bool windowe
 	m_objectManager.Init();
 
 	// Initialize Buffer Manager
-	m_bufferManager.Init(m_device.GetDevice(), m_device.GetDeviceContext());
+	m_bufferManager.Init(&m_device);
 
 	// Initialize Shader Manager
 	m_shaderManager.Init(m_device.GetDevice());
@@ -263,18 +322,110 @@ HRESULT GDXEngine::Graphic(unsigned int width, unsigned int height, bool windowe
 		return hr;
 	}
 
+	// Layouts for interleaved/quantized surfaces (optional, otherwise they keep the default format)
+	GetILM().CreateInputLayoutFormats(GetSM().GetShader(), GetSM().GetShader()->flagsVertex);
+
+	// Optional: without the instancing variant every mesh is drawn singly
+	CreateInstancedShader();
+
 	m_screenHeight = height;
 	m_screenWidth = width;
 
 	return hr;
 }
 
+HRESULT GDXEngine::CreateInstancedShader()
+{
+	Shader* standard = GetSM().GetShader();
+	if (!standard)
+		return E_FAIL;
+
+	Shader* variant = m_objectManager.CreateShader();
+
+	// Null backend: nothing to compile, only take over the vertex flags
+	if (m_device.IsNull())
+	{
+		variant->flagsVertex = standard->flagsVertex;
+		standard->instancedVariant = variant;
+		return S_OK;
+	}
+
+	HRESULT hr = GetSM().CreateShader(variant, vsInstanced.c_str(), "main", ps.c_str(), "main");
+	if (SUCCEEDED(hr))
+	{
+		hr = GetILM().CreateInputLayoutVertex(&variant->inputlayoutVertex,
+			variant,
+			variant->flagsVertex,
+			standard->flagsVertex,
+			true);
+	}
+	if (SUCCEEDED(hr))
+	{
+		GetILM().CreateInputLayoutFormats(variant, variant->flagsVertex, true);
+	}
+
+	if (FAILED(hr))
+	{
+		Debug::Log("gdxengine.cpp: Instanced shader not available, instancing disabled");
+		m_objectManager.DeleteShader(variant);
+		return hr;
+	}
+
+	standard->instancedVariant = variant;
+	return hr;
+}
+
+HRESULT GDXEngine::GraphicNull(unsigned int width, unsigned int height)
+{
+	HRESULT hr = S_OK;
+
+	// Shadow map size as in the D3D11 path, so both passes run identically
+	hr = m_device.CreateNullResources(2048, 2048);
+	if (FAILED(hr))
+	{
+		Debug::LogHr(__FILE__, __LINE__, hr);
+		return hr;
+	}
+
+	m_objectManager.Init();
+	m_bufferManager.Init(&m_device);
+
+	// Default shaders without compiling: there is no D3D11 to compile with
+	GetSM().SetShader(m_objectManager.CreateShader());
+	GetSM().GetShader()->flagsVertex = D3DVERTEX_POSITION | D3DVERTEX_COLOR | D3DVERTEX_NORMAL | D3DVERTEX_TEX1;
+
+	GetOM().AddMaterialToShader(GetSM().GetShader(), GetOM().CreateMaterial());
+
+	LPMATERIAL standardMaterial = GetSM().GetShader()->materials.front();
+
+	hr = GetBM().CreateBuffer(
+		&standardMaterial->properties,
+		sizeof(Material::MaterialData),
+		1,
+		D3D11_BIND_CONSTANT_BUFFER,
+		&standardMaterial->materialBuffer
+	);
+
+	if (FAILED(hr))
+	{
+		Debug::LogHr(__FILE__, __LINE__, hr);
+		return hr;
+	}
+
+	m_screenHeight = height;
+	m_screenWidth = width;
+
+	CreateInstancedShader();
+
+	Debug::Log("gdxengine.cpp: Headless graphics initialized (", width, "x", height, ")");
+	return hr;
+}
+
 HRESULT GDXEngine::RenderWorld()
 {
 	HRESULT hr = S_OK;
 
-	auto* pContext = this->m_device.GetDeviceContext();
-	if (!pContext)
+	if (!m_device.IsInitialized() || (!m_device.IsNull() && !m_device.GetDeviceContext()))
 	{
 		Debug::Log("gdxengine.cpp: RenderWorld - Device Context is null.");
 		return E_FAIL;
@@ -289,10 +440,10 @@ HRESULT GDXEngine::RenderWorld()
 
 	// Clear
 	ID3D11DepthStencilView* dsv = this->m_device.GetDepthStencilView();
-	if (!dsv)
+	if (!dsv && !m_device.IsNull())
 		return E_POINTER;
 
-	pContext->ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	m_device.ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
 	// Wichtig: RenderManager bekommt deterministisch die Camera
 	m_renderManager.SetCamera(pCamera);
@@ -305,6 +456,10 @@ HRESULT GDXEngine::RenderWorld()
 
 void GDXEngine::UpdateWorld()
 {
+	// Upload finished textures/meshes (budget per frame), before the bounds:
+	// a streamed mesh gets its surfaces here
+	m_assetLoader.Update(m_uploadBudget);
+
 	auto* cam = m_cameraManager.GetCurrentCam();
 
 	if (cam == nullptr) {
@@ -319,6 +474,15 @@ void GDXEngine::UpdateWorld()
 	// Funktioniert - cam ist Camera*
 	cam->UpdateCamera(position, forward, up);
 
+	// Transforms: rebuild all dirty world matrices once per frame in a single
+	// pass. Shadow and main pass then only read the cache.
+	// Static scene: dirty list empty, no matrix math.
+	m_transformSystem.UpdateWorldMatrices(&m_jobSystem);
+
+	// Bounds only for meshes whose transform changed (block-wise in parallel),
+	// then the scene tree leaves whose AABB left the fat box
+	m_objectManager.UpdateBounds(&m_jobSystem);
+
 	// Light
 	m_lightManager.Update(&m_device);
 }
@@ -330,7 +494,10 @@ HRESULT GDXEngine::Cls(float r, float g, float b, float a)
 	//Clear our backbuffer to the updated color
 	float color[4] = { r, g, b, a };
 
-	m_device.GetDeviceContext()->ClearRenderTargetView(m_device.GetTargetView(), color);
+	m_device.ClearRenderTargetView(m_device.GetTargetView(), color);
+
+	if (m_device.IsNull())
+		return hr;
 
 	hr = m_device.GetDevice()->GetDeviceRemovedReason(); // Check for device error
 	if (FAILED(hr))
@@ -400,6 +567,22 @@ CameraManager& GDXEngine::GetCam() {
 	return m_cameraManager;
 }
 
+JobSystem& GDXEngine::GetJS() {
+	return m_jobSystem;
+}
+
+AssetLoader& GDXEngine::GetAL() {
+	return m_assetLoader;
+}
+
+RenderManager& GDXEngine::GetRM() {
+	return m_renderManager;
+}
+
+CollisionManager& GDXEngine::GetCM() {
+	return m_collisionManager;
+}
+
 void GDXEngine::SetAdapter(unsigned int index)
 {
 	m_adapterIndex = index;
@@ -456,3 +639,7 @@ int GDXEngine::GetVSyncInterval() const noexcept
 	return m_vsyncInterval;
 }
 
+TransformSystem& GDXEngine::GetTransformSystem() {
+	return m_transformSystem;
+}
+
@@ -0,0 +1,150 @@
+#include "gdxnulldevice.h"
+#include "gdxdebug.h"
+#include <cstring>
+
+// ==================== GDXCommandLog ====================
+
+GDXCommandLog::GDXCommandLog() :
+    m_totalCount(0),
+    m_keepCommands(true)
+{
+    Reset();
+}
+
+void GDXCommandLog::Reset()
+{
+    m_commands.clear();     // keeps its capacity -> no allocation per frame
+    for (size_t& c : m_counts) c = 0;
+    m_totalCount = 0;
+}
+
+void GDXCommandLog::Record(GDXCommandType type, uint32_t slot, uint32_t count, const void* object)
+{
+    ++m_counts[static_cast<size_t>(type)];
+    ++m_totalCount;
+
+    if (m_keepCommands)
+        m_commands.push_back(GDXCommand{ type, slot, count, object });
+}
+
+void GDXCommandLog::SetKeepCommands(bool keep)
+{
+    m_keepCommands = keep;
+}
+
+size_t GDXCommandLog::GetCount(GDXCommandType type) const
+{
+    return m_counts[static_cast<size_t>(type)];
+}
+
+size_t GDXCommandLog::GetTotalCount() const
+{
+    return m_totalCount;
+}
+
+const char* GDXCommandLog::GetCommandName(GDXCommandType type)
+{
+    switch (type)
+    {
+    case GDXCommandType::Map:                    return "Map";
+    case GDXCommandType::Unmap:                  return "Unmap";
+    case GDXCommandType::UpdateSubresource:      return "UpdateSubresource";
+    case GDXCommandType::IASetInputLayout:       return "IASetInputLayout";
+    case GDXCommandType::IASetVertexBuffers:     return "IASetVertexBuffers";
+    case GDXCommandType::IASetIndexBuffer:       return "IASetIndexBuffer";
+    case GDXCommandType::IASetPrimitiveTopology: return "IASetPrimitiveTopology";
+    case GDXCommandType::VSSetShader:            return "VSSetShader";
+    case GDXCommandType::PSSetShader:            return "PSSetShader";
+    case GDXCommandType::VSSetConstantBuffers:   return "VSSetConstantBuffers";
+    case GDXCommandType::PSSetConstantBuffers:   return "PSSetConstantBuffers";
+    case GDXCommandType::VSSetConstantBuffers1:  return "VSSetConstantBuffers1";
+    case GDXCommandType::PSSetConstantBuffers1:  return "PSSetConstantBuffers1";
+    case GDXCommandType::VSSetShaderResources:   return "VSSetShaderResources";
+    case GDXCommandType::PSSetShaderResources:   return "PSSetShaderResources";
+    case GDXCommandType::PSSetSamplers:          return "PSSetSamplers";
+    case GDXCommandType::OMSetRenderTargets:     return "OMSetRenderTargets";
+    case GDXCommandType::RSSetState:             return "RSSetState";
+    case GDXCommandType::RSSetViewports:         return "RSSetViewports";
+    case GDXCommandType::ClearRenderTargetView:  return "ClearRenderTargetView";
+    case GDXCommandType::ClearDepthStencilView:  return "ClearDepthStencilView";
+    case GDXCommandType::Draw:                   return "Draw";
+    case GDXCommandType::DrawIndexed:            return "DrawIndexed";
+    case GDXCommandType::DrawIndexedInstanced:   return "DrawIndexedInstanced";
+    default:                                     return "Unknown";
+    }
+}
+
+// ==================== GDXNullBuffer ====================
+
+GDXNullBuffer::GDXNullBuffer(uint32_t byteWidth, const void* initData) :
+    m_data(byteWidth, 0),
+    m_mapped(false)
+{
+    if (initData && byteWidth > 0)
+        memcpy(m_data.data(), initData, byteWidth);
+}
+
+// ==================== GDXNullDevice ====================
+
+GDXNullDevice::GDXNullDevice() :
+    m_errorCount(0)
+{
+}
+
+void GDXNullDevice::Reset()
+{
+    m_commandLog.Reset();
+    m_errorCount = 0;
+}
+
+void GDXNullDevice::ReportError(const char* message)
+{
+    ++m_errorCount;
+    Debug::LogOnce(message, "gdxnulldevice.cpp: ", message);
+}
+
+void* GDXNullDevice::Map(GDXNullBuffer* buffer, const void* object)
+{
+    if (!buffer)
+    {
+        ReportError("Map on a null buffer");
+        return nullptr;
+    }
+
+    if (buffer->m_mapped)
+        ReportError("Map on a buffer that is already mapped");
+    buffer->m_mapped = true;
+
+    m_commandLog.Record(GDXCommandType::Map, 0, buffer->GetByteWidth(), object ? object : buffer);
+    return buffer->GetData();
+}
+
+void GDXNullDevice::Unmap(GDXNullBuffer* buffer, const void* object)
+{
+    if (!buffer)
+    {
+        ReportError("Unmap on a null buffer");
+        return;
+    }
+
+    if (!buffer->m_mapped)
+        ReportError("Unmap on a buffer that is not mapped");
+    buffer->m_mapped = false;
+
+    m_commandLog.Record(GDXCommandType::Unmap, 0, 0, object ? object : buffer);
+}
+
+void GDXNullDevice::UpdateSubresource(GDXNullBuffer* buffer, const void* data, const void* object)
+{
+    if (!buffer || !data)
+    {
+        ReportError("UpdateSubresource without buffer or data");
+        return;
+    }
+
+    if (buffer->IsMapped())
+        ReportError("UpdateSubresource on a mapped buffer");
+
+    memcpy(buffer->GetData(), data, buffer->GetByteWidth());
+    m_commandLog.Record(GDXCommandType::UpdateSubresource, 0, buffer->GetByteWidth(), object ? object : buffer);
+}
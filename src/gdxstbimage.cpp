@@ -0,0 +1,4 @@
+// stb_image implementation, compiled exactly once. Texture, TextureCache and
+// the tools include the header only.
+#define STB_IMAGE_IMPLEMENTATION
+#include "../third_party/stb_image.h"
@@ -0,0 +1,154 @@
+// AssetLoaderTest.cpp
+//
+// Background loading without D3D: states from Submit to Ready/Failed,
+// upload order and the per-frame byte budget, Flush with loader threads,
+// and Release dropping the per-handle state (also while pending).
+
+#include "AssetLoader.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FakeRequest : public AssetRequest
+{
+public:
+    FakeRequest(size_t bytes, bool loadOk, bool uploadOk, std::vector<int>* order = nullptr, int id = 0) :
+        m_bytes(bytes), m_loadOk(loadOk), m_uploadOk(uploadOk), m_order(order), m_id(id) {}
+
+    bool Load() override
+    {
+        if (!m_loadOk)
+            error = "load failed";
+        return m_loadOk;
+    }
+
+    size_t GetUploadBytes() const override { return m_bytes; }
+
+    bool Upload() override
+    {
+        if (m_order)
+            m_order->push_back(m_id);
+        if (!m_uploadOk)
+            error = "upload failed";
+        return m_uploadOk;
+    }
+
+private:
+    size_t m_bytes;
+    bool m_loadOk;
+    bool m_uploadOk;
+    std::vector<int>* m_order;
+    int m_id;
+};
+
+static void TestStates()
+{
+    AssetLoader loader;     // no Init: Load runs inside Submit
+
+    const AssetHandle ok = loader.Submit(std::make_unique<FakeRequest>(100, true, true));
+    const AssetHandle loadFails = loader.Submit(std::make_unique<FakeRequest>(100, false, true));
+    const AssetHandle uploadFails = loader.Submit(std::make_unique<FakeRequest>(100, true, false));
+    CHECK(ok != INVALID_ASSET && loadFails != ok && uploadFails != ok);
+    CHECK(loader.Submit(nullptr) == INVALID_ASSET);
+    CHECK(loader.GetState(ok) == AssetState::Pending);
+    CHECK(loader.GetPendingCount() == 3);
+
+    loader.Update(SIZE_MAX);
+    CHECK(loader.GetState(ok) == AssetState::Ready);
+    CHECK(loader.GetState(loadFails) == AssetState::Failed);
+    CHECK(loader.GetState(uploadFails) == AssetState::Failed);
+    CHECK(std::string(loader.GetError(loadFails)) == "load failed");
+    CHECK(std::string(loader.GetError(uploadFails)) == "upload failed");
+    CHECK(std::string(loader.GetError(ok)).empty());
+    CHECK(loader.GetPendingCount() == 0);
+    CHECK(loader.GetStats().uploaded == 1 && loader.GetStats().failed == 2);
+    CHECK(loader.GetState(12345) == AssetState::Unknown);
+}
+
+static void TestBudget()
+{
+    AssetLoader loader;
+    std::vector<int> order;
+    for (int i = 0; i < 4; ++i)
+        loader.Submit(std::make_unique<FakeRequest>(60, true, true, &order, i));
+
+    // 100 bytes: one request of 60 fits, the second would exceed the budget
+    CHECK(loader.Update(100) == 60);
+    CHECK(order.size() == 1);
+
+    // At least one request per frame, even if it alone is larger than the budget
+    CHECK(loader.Update(10) == 60);
+    CHECK(order.size() == 2);
+
+    loader.Update(SIZE_MAX);
+    CHECK((order == std::vector<int>{ 0, 1, 2, 3 }));
+}
+
+static void TestFlush()
+{
+    AssetLoader loader;
+    loader.Init(2);
+    CHECK(loader.GetThreadCount() == 2);
+
+    std::vector<AssetHandle> handles;
+    for (int i = 0; i < 32; ++i)
+        handles.push_back(loader.Submit(std::make_unique<FakeRequest>(1000, i % 5 != 0, true)));
+
+    loader.Flush();
+    CHECK(loader.GetPendingCount() == 0);
+    bool finished = true;
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        const AssetState expected = i % 5 != 0 ? AssetState::Ready : AssetState::Failed;
+        finished = finished && loader.GetState(handles[i]) == expected;
+    }
+    CHECK(finished);
+    loader.Shutdown();
+}
+
+static void TestRelease()
+{
+    AssetLoader loader;
+    const AssetHandle ready = loader.Submit(std::make_unique<FakeRequest>(10, true, true));
+    const AssetHandle failed = loader.Submit(std::make_unique<FakeRequest>(10, false, true));
+    loader.Update(SIZE_MAX);
+
+    loader.Release(ready);
+    loader.Release(failed);
+    CHECK(loader.GetState(ready) == AssetState::Unknown);
+    CHECK(loader.GetState(failed) == AssetState::Unknown);
+    CHECK(std::string(loader.GetError(failed)).empty());
+
+    // Released while pending: the upload still runs, the entry is gone afterwards
+    std::vector<int> order;
+    const AssetHandle pending = loader.Submit(std::make_unique<FakeRequest>(10, true, true, &order, 7));
+    loader.Release(pending);
+    CHECK(loader.GetState(pending) == AssetState::Pending);
+    loader.Update(SIZE_MAX);
+    CHECK(order.size() == 1);
+    CHECK(loader.GetState(pending) == AssetState::Unknown);
+
+    // Unknown handles and double release are ignored
+    loader.Release(pending);
+    loader.Release(INVALID_ASSET);
+
+    // Released while queued and dropped by Shutdown
+    AssetLoader threaded;
+    threaded.Init(1);
+    const AssetHandle queued = threaded.Submit(std::make_unique<FakeRequest>(10, true, true));
+    threaded.Release(queued);
+    threaded.Shutdown();
+    CHECK(threaded.GetState(queued) == AssetState::Unknown);
+}
+
+int main()
+{
+    TestStates();
+    TestBudget();
+    TestFlush();
+    TestRelease();
+    return Test::Result("AssetLoaderTest");
+}
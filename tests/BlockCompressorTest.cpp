@@ -0,0 +1,188 @@
+// BlockCompressorTest.cpp
+//
+// BC1/BC3/BC7 encoder on the CPU: block sizes and pitches, exact solid
+// colors, error bounds on gradients (BC7 better than BC1), alpha in BC3
+// and BC7, edge blocks of small mips, and bit-identical output with and
+// without the JobSystem.
+
+#include "BlockCompressor.h"
+#include "JobSystem.h"
+#include "TestCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+using BlockCompressor::Format;
+
+static std::vector<uint8_t> Solid(uint32_t width, uint32_t height, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        rgba[i + 0] = r;
+        rgba[i + 1] = g;
+        rgba[i + 2] = b;
+        rgba[i + 3] = a;
+    }
+    return rgba;
+}
+
+// Smooth color ramp with an alpha ramp in the other direction
+static std::vector<uint8_t> Gradient(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* p = &rgba[(size_t(y) * width + x) * 4];
+            p[0] = static_cast<uint8_t>(x * 255 / (width - 1));
+            p[1] = static_cast<uint8_t>(y * 255 / (height - 1));
+            p[2] = static_cast<uint8_t>(128 + (x + y) % 32);
+            p[3] = static_cast<uint8_t>(255 - y * 255 / (height - 1));
+        }
+    }
+    return rgba;
+}
+
+static std::vector<uint8_t> RoundTrip(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, Format format,
+    JobSystem* jobs = nullptr)
+{
+    std::vector<uint8_t> blocks(BlockCompressor::CompressedSize(format, width, height));
+    BlockCompressor::Compress(rgba.data(), width, height, format, blocks.data(), jobs);
+    std::vector<uint8_t> decoded(rgba.size());
+    BlockCompressor::Decompress(blocks.data(), width, height, format, decoded.data());
+    return decoded;
+}
+
+// Root mean square error over the channels in [first, first + count)
+static double Rmse(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int first, int count)
+{
+    double sum = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = first; c < first + count; ++c) {
+            const double d = double(a[i + c]) - double(b[i + c]);
+            sum += d * d;
+            ++n;
+        }
+    }
+    return std::sqrt(sum / double(n));
+}
+
+static int MaxError(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int first, int count)
+{
+    int largest = 0;
+    for (size_t i = 0; i < a.size(); i += 4)
+        for (int c = first; c < first + count; ++c)
+            largest = (std::max)(largest, std::abs(int(a[i + c]) - int(b[i + c])));
+    return largest;
+}
+
+static void TestSizes()
+{
+    CHECK(BlockCompressor::BlockBytes(Format::BC1) == 8);
+    CHECK(BlockCompressor::BlockBytes(Format::BC3) == 16);
+    CHECK(BlockCompressor::BlockBytes(Format::BC7) == 16);
+
+    CHECK(BlockCompressor::RowPitch(Format::BC1, 256) == 64 * 8);
+    CHECK(BlockCompressor::CompressedSize(Format::BC3, 256, 128) == 64 * 32 * 16);
+
+    // At least one block in each direction, partial blocks round up
+    CHECK(BlockCompressor::CompressedSize(Format::BC1, 1, 1) == 8);
+    CHECK(BlockCompressor::CompressedSize(Format::BC7, 2, 2) == 16);
+    CHECK(BlockCompressor::RowPitch(Format::BC7, 5) == 2 * 16);
+    CHECK(BlockCompressor::CompressedSize(Format::BC1, 5, 9) == 2 * 3 * 8);
+}
+
+static void TestSolid()
+{
+    // Colors representable in RGB 565 come back exactly from BC1 and BC3
+    const uint8_t colors[][4] = { { 255, 0, 0, 255 }, { 0, 0, 0, 255 }, { 255, 255, 255, 255 }, { 0, 255, 0, 255 } };
+    for (const uint8_t* c : colors) {
+        const std::vector<uint8_t> rgba = Solid(8, 8, c[0], c[1], c[2], c[3]);
+        CHECK(MaxError(RoundTrip(rgba, 8, 8, Format::BC1), rgba, 0, 3) == 0);
+        CHECK(MaxError(RoundTrip(rgba, 8, 8, Format::BC3), rgba, 0, 4) == 0);
+        CHECK(MaxError(RoundTrip(rgba, 8, 8, Format::BC7), rgba, 0, 4) <= 1);
+    }
+
+    // Any other color: within the 565 step in BC1, near exact in BC7
+    const std::vector<uint8_t> odd = Solid(4, 4, 77, 150, 33, 200);
+    CHECK(MaxError(RoundTrip(odd, 4, 4, Format::BC1), odd, 0, 3) <= 4);
+    CHECK(MaxError(RoundTrip(odd, 4, 4, Format::BC3), odd, 0, 3) <= 4);
+    CHECK(MaxError(RoundTrip(odd, 4, 4, Format::BC3), odd, 3, 1) == 0);
+    CHECK(MaxError(RoundTrip(odd, 4, 4, Format::BC7), odd, 0, 4) <= 1);
+}
+
+static void TestGradient()
+{
+    const uint32_t size = 64;
+    const std::vector<uint8_t> rgba = Gradient(size, size);
+
+    const double bc1 = Rmse(RoundTrip(rgba, size, size, Format::BC1), rgba, 0, 3);
+    const double bc3 = Rmse(RoundTrip(rgba, size, size, Format::BC3), rgba, 0, 3);
+    const double bc7 = Rmse(RoundTrip(rgba, size, size, Format::BC7), rgba, 0, 3);
+    CHECK(bc1 < 6.0);
+    CHECK(bc3 < 6.0);
+    CHECK(bc7 < 3.0);
+    CHECK(bc7 < bc1);
+
+    // Alpha: BC3 interpolates 8 levels per block, BC7 16 together with the color
+    CHECK(Rmse(RoundTrip(rgba, size, size, Format::BC3), rgba, 3, 1) < 2.0);
+    CHECK(Rmse(RoundTrip(rgba, size, size, Format::BC7), rgba, 3, 1) < 4.0);
+
+    // BC1 has no alpha: always opaque after decoding
+    const std::vector<uint8_t> bc1Decoded = RoundTrip(rgba, size, size, Format::BC1);
+    CHECK(BlockCompressor::IsOpaque(bc1Decoded.data(), size_t(size) * size));
+}
+
+static void TestEdges()
+{
+    // Small mips and sizes that are not a multiple of 4: edge pixels are repeated
+    const uint32_t sizes[][2] = { { 1, 1 }, { 2, 2 }, { 2, 1 }, { 6, 5 }, { 13, 7 } };
+    const Format formats[] = { Format::BC1, Format::BC3, Format::BC7 };
+    for (const uint32_t* s : sizes) {
+        const std::vector<uint8_t> rgba = Solid(s[0], s[1], 255, 0, 255, 255);
+        for (Format format : formats)
+            CHECK(MaxError(RoundTrip(rgba, s[0], s[1], format), rgba, 0, 4) <= 1);
+    }
+}
+
+static void TestJobs()
+{
+    JobSystem jobs;
+    jobs.Init(3);
+
+    const uint32_t width = 96, height = 40;
+    const std::vector<uint8_t> rgba = Gradient(width, height);
+    const Format formats[] = { Format::BC1, Format::BC3, Format::BC7 };
+    for (Format format : formats) {
+        std::vector<uint8_t> serial(BlockCompressor::CompressedSize(format, width, height));
+        std::vector<uint8_t> parallel(serial.size());
+        BlockCompressor::Compress(rgba.data(), width, height, format, serial.data());
+        BlockCompressor::Compress(rgba.data(), width, height, format, parallel.data(), &jobs);
+        CHECK(serial == parallel);
+    }
+
+    jobs.Shutdown();
+}
+
+static void TestOpaque()
+{
+    std::vector<uint8_t> rgba = Solid(4, 4, 10, 20, 30, 255);
+    CHECK(BlockCompressor::IsOpaque(rgba.data(), 16));
+    rgba[15 * 4 + 3] = 254;
+    CHECK(!BlockCompressor::IsOpaque(rgba.data(), 16));
+    CHECK(BlockCompressor::IsOpaque(rgba.data(), 15));
+}
+
+int main()
+{
+    TestSizes();
+    TestSolid();
+    TestGradient();
+    TestEdges();
+    TestJobs();
+    TestOpaque();
+    return Test::Result("BlockCompressorTest");
+}
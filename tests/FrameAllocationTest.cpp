@@ -0,0 +1,190 @@
+// Steady-state frames must not touch the heap: neither UpdateWorld,
+// CollideAll, RaycastBatch nor RenderWorld may allocate once the scene has
+// been seen. The animation is periodic; the first period is the warm-up
+// (buffers grow to the scene's high-water mark), the second one repeats the
+// same frames and must not allocate at all.
+// Counts every global operator new; runs the engine on the null backend
+// (Engine::CreateHeadlessEngine), so it also runs on the Linux CI job.
+
+#include "gidx.h"
+#include "TestCheck.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static std::atomic<size_t> g_allocCount{ 0 };
+
+void* operator new(size_t size)
+{
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static const int PERIOD = 24;       // frames per animation cycle (15 degrees per frame)
+
+struct Scene
+{
+    LPENTITY camera = nullptr;
+    std::vector<LPENTITY> cubes;
+    std::vector<Ray> rays;
+    std::vector<RaycastHit> hits;
+};
+
+static void CreateCube(LPENTITY* mesh, LPMATERIAL material)
+{
+    Engine::CreateMesh(mesh, material);
+
+    LPSURFACE surface = nullptr;
+    Engine::CreateSurface(&surface, *mesh);
+
+    const float s = 1.0f;
+    const DirectX::XMFLOAT3 corners[8] = {
+        {-s, -s, -s}, {-s, +s, -s}, {+s, +s, -s}, {+s, -s, -s},
+        {-s, -s, +s}, {-s, +s, +s}, {+s, +s, +s}, {+s, -s, +s}
+    };
+    const DirectX::XMFLOAT4 colors[8] = {
+        {1, 1, 1, 1}, {1, 1, 1, 1}, {1, 1, 1, 1}, {1, 1, 1, 1},
+        {1, 1, 1, 1}, {1, 1, 1, 1}, {1, 1, 1, 1}, {1, 1, 1, 1}
+    };
+    const unsigned int indices[36] = {
+        0, 1, 2, 0, 2, 3,   7, 6, 5, 7, 5, 4,   4, 5, 1, 4, 1, 0,
+        3, 2, 6, 3, 6, 7,   1, 5, 6, 1, 6, 2,   4, 0, 3, 4, 3, 7
+    };
+
+    // Corner normals: the cube only has to be lit, not look right
+    Engine::SetSurfacePositions(surface, corners, 8);
+    Engine::SetSurfaceNormals(surface, corners, 8);
+    Engine::SetSurfaceColors(surface, colors, 8);
+    Engine::SetSurfaceIndices(surface, indices, 36);
+    Engine::FillBuffer(surface);
+}
+
+// Grid of 16 x 4 x 16 cubes: one real cube, the rest CopyEntity copies (instancing),
+// every cube a collider, one ray from the camera to every 8th cube
+static void CreateScene(Scene& scene)
+{
+    LPMATERIAL material = nullptr;
+    Engine::CreateMaterial(&material);
+
+    Engine::CreateCamera(&scene.camera);
+    Engine::PositionEntity(scene.camera, 0.0f, 20.0f, -40.0f);
+    Engine::RotateEntity(scene.camera, 20.0f, 0.0f, 0.0f);
+
+    LPENTITY light = nullptr;
+    Engine::CreateLight(&light, D3DLIGHT_DIRECTIONAL);
+    Engine::RotateEntity(light, -90, 0, 0);
+    Engine::SetDirectionalLight(light);
+
+    const int SIDE = 16;
+    const float SPACING = 3.0f;
+    for (int i = 0; i < SIDE * SIDE * 4; ++i)
+    {
+        LPENTITY cube = nullptr;
+        if (scene.cubes.empty())
+            CreateCube(&cube, material);
+        else
+            Engine::CopyEntity(&cube, scene.cubes.front());
+
+        const float x = (i % SIDE - SIDE / 2.0f) * SPACING;
+        const float y = (i / (SIDE * SIDE)) * SPACING;
+        const float z = ((i / SIDE) % SIDE - SIDE / 2.0f) * SPACING;
+        Engine::PositionEntity(cube, x, y, z);
+        Engine::EntityCollisionMode(cube, COLLISION::BOX);
+        scene.cubes.push_back(cube);
+
+        if (i % 8 == 0)
+        {
+            Ray ray;
+            ray.origin = DirectX::XMFLOAT3(0.0f, 20.0f, -40.0f);
+            ray.direction = DirectX::XMFLOAT3(x, y - 20.0f, z + 40.0f);
+            scene.rays.push_back(ray);
+        }
+    }
+    scene.hits.resize(scene.rays.size());
+}
+
+// Turns the cubes and swings the camera, so pairs, ray candidates, the visible
+// set and the frustum-edge leaves change from frame to frame
+static size_t RunFrames(Scene& scene, const char* name)
+{
+    size_t allocations = 0;
+    for (int frame = 0; frame < 2 * PERIOD; ++frame)
+    {
+        Engine::GetCommandLog().Reset();
+        const size_t before = g_allocCount.load(std::memory_order_relaxed);
+
+        const float angle = 15.0f * (frame % PERIOD);
+        for (LPENTITY cube : scene.cubes)
+            Engine::RotateEntity(cube, angle, 2.0f * angle, 0.0f);
+        Engine::RotateEntity(scene.camera, 20.0f, 30.0f * std::sin(DirectX::XMConvertToRadians(angle)), 0.0f);
+
+        Engine::Cls(0, 0, 0);
+        Engine::UpdateWorld();
+        Engine::CollideAll();
+        const size_t hits = Engine::RaycastBatch(scene.rays.data(), scene.rays.size(), scene.hits.data());
+        Engine::RenderWorld();
+        Engine::Flip();
+
+        if (frame >= PERIOD)
+            allocations += g_allocCount.load(std::memory_order_relaxed) - before;
+
+        // Every ray ends inside a cube: the raycast path really ran
+        CHECK(hits == scene.rays.size());
+    }
+
+    if (allocations > 0)
+        printf("%s: %zu allocations in %d frames\n", name, allocations, PERIOD);
+    return allocations;
+}
+
+int main()
+{
+    if (Engine::CreateHeadlessEngine(640, 480) != 0)
+    {
+        printf("CreateHeadlessEngine failed\n");
+        return 1;
+    }
+    Engine::Graphics(640, 480);
+    Engine::GetCommandLog().SetKeepCommands(false);
+
+    Scene scene;
+    CreateScene(scene);
+
+    CHECK(RunFrames(scene, "scene tree, instancing") == 0);
+
+    Engine::SetHierarchicalCulling(false);
+    CHECK(RunFrames(scene, "brute-force culling") == 0);
+
+    Engine::SetHierarchicalCulling(true);
+    Engine::SetInstancing(false);
+    CHECK(RunFrames(scene, "without instancing") == 0);
+
+    Engine::ReleaseEngine();
+    return Test::Result("FrameAllocationTest");
+}
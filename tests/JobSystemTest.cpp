@@ -0,0 +1,79 @@
+// JobSystemTest.cpp
+//
+// Work-stealing scheduler with explicit worker threads (independent of
+// the core count of the build machine): ParallelFor coverage, counters,
+// continuations and the inline path without workers.
+
+#include "JobSystem.h"
+#include "TestCheck.h"
+
+#include <atomic>
+#include <vector>
+
+static void TestParallelFor(JobSystem& jobs)
+{
+    const size_t COUNT = 100000;
+    std::vector<int> hits(COUNT, 0);
+
+    // Every index exactly once, blocks never overlap
+    jobs.ParallelFor(COUNT, 1000, [&hits](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                ++hits[i];
+        });
+
+    size_t wrong = 0;
+    for (int h : hits)
+        wrong += (h != 1);
+    CHECK(wrong == 0);
+
+    // Grain larger than count and grain 0 run as a single block
+    size_t calls = 0;
+    jobs.ParallelFor(10, 64, [&calls](size_t begin, size_t end) { calls += (begin == 0 && end == 10); });
+    CHECK(calls == 1);
+
+    std::atomic<size_t> covered{ 0 };
+    jobs.ParallelFor(7, 0, [&covered](size_t begin, size_t end) { covered += end - begin; });
+    CHECK(covered == 7);
+}
+
+static void TestCounters(JobSystem& jobs)
+{
+    std::atomic<int> sum{ 0 };
+    JobCounter counter;
+    for (int i = 1; i <= 100; ++i)
+        jobs.Run([&sum, i]() { sum += i; }, &counter);
+    jobs.Wait(counter);
+    CHECK(counter.IsDone());
+    CHECK(sum == 5050);
+
+    // Continuation starts only after its dependency finished
+    std::atomic<int> stage{ 0 };
+    std::atomic<bool> ordered{ true };
+    JobCounter first;
+    JobCounter second;
+    for (int i = 0; i < 8; ++i)
+        jobs.Run([&stage]() { ++stage; }, &first);
+    jobs.RunAfter(first, [&stage, &ordered]() { ordered = (stage.load() == 8); ++stage; }, &second);
+    jobs.Wait(second);
+    CHECK(ordered);
+    CHECK(stage == 9);
+}
+
+int main()
+{
+    JobSystem parallel;
+    parallel.Init(3);
+    CHECK(parallel.GetWorkerCount() == 3);
+    TestParallelFor(parallel);
+    TestCounters(parallel);
+    parallel.Shutdown();
+
+    // Not initialized: no workers, everything runs inline on the caller
+    JobSystem inlineJobs;
+    CHECK(!inlineJobs.IsParallel());
+    TestParallelFor(inlineJobs);
+    TestCounters(inlineJobs);
+
+    return Test::Result("JobSystemTest");
+}
@@ -0,0 +1,204 @@
+// MeshOptimizerTest.cpp
+//
+// Index optimizations on a shuffled grid: every pass must keep the
+// same triangles (including winding) and the same vertices, the cache
+// pass has to lower the ACMR and the fetch remap must renumber in order
+// of first use.
+
+#include "MeshOptimizer.h"
+#include "TestCheck.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+typedef std::array<uint32_t, 3> Triangle;
+
+struct Grid
+{
+    std::vector<float> positions;   // 3 floats per vertex
+    std::vector<uint32_t> indices;
+    size_t vertexCount = 0;
+};
+
+// side x side quads, triangles in random order
+static Grid CreateShuffledGrid(uint32_t side)
+{
+    Grid grid;
+    const uint32_t row = side + 1;
+    grid.vertexCount = static_cast<size_t>(row) * row;
+    for (uint32_t z = 0; z < row; ++z)
+    {
+        for (uint32_t x = 0; x < row; ++x)
+        {
+            grid.positions.push_back(static_cast<float>(x));
+            grid.positions.push_back(0.0f);
+            grid.positions.push_back(static_cast<float>(z));
+        }
+    }
+
+    std::vector<Triangle> triangles;
+    for (uint32_t z = 0; z < side; ++z)
+    {
+        for (uint32_t x = 0; x < side; ++x)
+        {
+            const uint32_t v0 = z * row + x;
+            triangles.push_back({ v0, v0 + row, v0 + 1 });
+            triangles.push_back({ v0 + 1, v0 + row, v0 + row + 1 });
+        }
+    }
+
+    std::mt19937 random(1234);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    for (const Triangle& t : triangles)
+        grid.indices.insert(grid.indices.end(), t.begin(), t.end());
+    return grid;
+}
+
+// Rotated so the smallest index comes first: same triangle, same winding
+static Triangle Canonical(uint32_t a, uint32_t b, uint32_t c)
+{
+    if (b < a && b < c) return { b, c, a };
+    if (c < a && c < b) return { c, a, b };
+    return { a, b, c };
+}
+
+static std::vector<Triangle> SortedTriangles(const std::vector<uint32_t>& indices)
+{
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        triangles.push_back(Canonical(indices[i], indices[i + 1], indices[i + 2]));
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void TestVertexCache()
+{
+    const Grid grid = CreateShuffledGrid(32);
+    const MeshOptimizer::CacheStats before =
+        MeshOptimizer::AnalyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+
+    std::vector<uint32_t> optimized(grid.indices.size());
+    MeshOptimizer::OptimizeVertexCache(optimized.data(), grid.indices.data(), grid.indices.size(), grid.vertexCount);
+
+    CHECK(SortedTriangles(optimized) == SortedTriangles(grid.indices));
+
+    const MeshOptimizer::CacheStats after =
+        MeshOptimizer::AnalyzeVertexCache(optimized.data(), optimized.size(), grid.vertexCount);
+    CHECK(after.acmr < before.acmr);
+    CHECK(after.acmr <= 1.0f);      // regular grid: well below one miss per triangle
+    CHECK(after.atvr >= 1.0f);
+
+    // In place gives the same result
+    std::vector<uint32_t> inPlace = grid.indices;
+    MeshOptimizer::OptimizeVertexCache(inPlace.data(), inPlace.data(), inPlace.size(), grid.vertexCount);
+    CHECK(inPlace == optimized);
+}
+
+static void TestOverdraw()
+{
+    const Grid grid = CreateShuffledGrid(32);
+    std::vector<uint32_t> cacheOptimized(grid.indices.size());
+    MeshOptimizer::OptimizeVertexCache(cacheOptimized.data(), grid.indices.data(), grid.indices.size(), grid.vertexCount);
+    const float cacheAcmr =
+        MeshOptimizer::AnalyzeVertexCache(cacheOptimized.data(), cacheOptimized.size(), grid.vertexCount).acmr;
+
+    std::vector<uint32_t> optimized(cacheOptimized.size());
+    const float threshold = 1.05f;
+    MeshOptimizer::OptimizeOverdraw(optimized.data(), cacheOptimized.data(), cacheOptimized.size(),
+        grid.positions.data(), grid.vertexCount, 3 * sizeof(float), threshold);
+
+    CHECK(SortedTriangles(optimized) == SortedTriangles(grid.indices));
+
+    // Cluster boundaries may cost at most the allowed ACMR degradation
+    const float acmr =
+        MeshOptimizer::AnalyzeVertexCache(optimized.data(), optimized.size(), grid.vertexCount).acmr;
+    CHECK(acmr <= cacheAcmr * threshold + 1e-4f);
+}
+
+static void TestVertexFetch()
+{
+    Grid grid = CreateShuffledGrid(16);
+
+    // Two vertices no triangle uses
+    const size_t referencedCount = grid.vertexCount;
+    grid.positions.insert(grid.positions.end(), { -1.0f, -1.0f, -1.0f, -2.0f, -2.0f, -2.0f });
+    grid.vertexCount += 2;
+
+    std::vector<uint32_t> remap(grid.vertexCount);
+    const size_t used = MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), grid.indices.data(),
+        grid.indices.size(), grid.vertexCount);
+    CHECK(used == referencedCount);
+
+    // remap is a permutation, unreferenced vertices go to the end
+    std::vector<uint32_t> sortedRemap = remap;
+    std::sort(sortedRemap.begin(), sortedRemap.end());
+    bool permutation = true;
+    for (size_t i = 0; i < sortedRemap.size(); ++i)
+        permutation = permutation && sortedRemap[i] == i;
+    CHECK(permutation);
+    CHECK(remap[grid.vertexCount - 2] >= used);
+    CHECK(remap[grid.vertexCount - 1] >= used);
+
+    std::vector<uint32_t> indices(grid.indices.size());
+    MeshOptimizer::RemapIndices(indices.data(), grid.indices.data(), grid.indices.size(), remap.data());
+
+    std::vector<float> positions(grid.positions.size());
+    MeshOptimizer::RemapVertices(positions.data(), grid.positions.data(), grid.vertexCount,
+        3 * sizeof(float), remap.data());
+
+    // New numbers appear in ascending order of first use
+    uint32_t next = 0;
+    bool firstUseOrder = true;
+    for (uint32_t index : indices)
+    {
+        if (index == next)
+            ++next;
+        else if (index > next)
+            firstUseOrder = false;
+    }
+    CHECK(firstUseOrder);
+    CHECK(next == used);
+
+    // Every corner still points at the same position
+    bool samePositions = true;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            samePositions = samePositions &&
+                positions[indices[i] * 3 + c] == grid.positions[grid.indices[i] * 3 + c];
+        }
+    }
+    CHECK(samePositions);
+
+    // Vertex set preserved, including the unreferenced ones
+    std::vector<float> before = grid.positions;
+    std::vector<float> after = positions;
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    CHECK(before == after);
+}
+
+static void TestDegenerate()
+{
+    // Fewer than three indices: nothing to optimize, nothing to crash on
+    const uint32_t single[2] = { 0, 1 };
+    const MeshOptimizer::CacheStats stats = MeshOptimizer::AnalyzeVertexCache(single, 2, 2);
+    CHECK(stats.acmr == 0.0f);
+
+    uint32_t remap[2] = { 99, 99 };
+    CHECK(MeshOptimizer::OptimizeVertexFetchRemap(remap, nullptr, 0, 2) == 0);
+    CHECK((remap[0] == 0 && remap[1] == 1) || (remap[0] == 1 && remap[1] == 0));
+}
+
+int main()
+{
+    TestVertexCache();
+    TestOverdraw();
+    TestVertexFetch();
+    TestDegenerate();
+    return Test::Result("MeshOptimizerTest");
+}
@@ -0,0 +1,262 @@
+// MeshSimplifierTest.cpp
+//
+// Edge collapse with quadric error metric: target triangle count on a
+// flat grid, the error bound on a curved one, open borders and UV seams
+// (duplicated vertices) that must survive, and degenerate input.
+
+#include "MeshSimplifier.h"
+#include "TestCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct Grid
+{
+    std::vector<float> positions;   // 3 floats per vertex
+    std::vector<uint32_t> indices;
+    size_t vertexCount = 0;
+};
+
+static void AddVertex(Grid& grid, float x, float y, float z)
+{
+    grid.positions.push_back(x);
+    grid.positions.push_back(y);
+    grid.positions.push_back(z);
+    ++grid.vertexCount;
+}
+
+// side x side quads in the xz plane, height(x, z) on y, counter-clockwise seen from +y
+template<typename HeightFunc>
+static Grid CreateGrid(uint32_t side, HeightFunc&& height)
+{
+    Grid grid;
+    const uint32_t row = side + 1;
+    for (uint32_t z = 0; z < row; ++z)
+        for (uint32_t x = 0; x < row; ++x)
+            AddVertex(grid, static_cast<float>(x), height(static_cast<float>(x), static_cast<float>(z)), static_cast<float>(z));
+
+    for (uint32_t z = 0; z < side; ++z)
+    {
+        for (uint32_t x = 0; x < side; ++x)
+        {
+            const uint32_t v0 = z * row + x;
+            grid.indices.insert(grid.indices.end(), { v0, v0 + row, v0 + 1, v0 + 1, v0 + row, v0 + row + 1 });
+        }
+    }
+    return grid;
+}
+
+static Grid CreateFlatGrid(uint32_t side)
+{
+    return CreateGrid(side, [](float, float) { return 0.0f; });
+}
+
+static bool ValidTriangles(const std::vector<uint32_t>& indices, size_t count, size_t vertexCount)
+{
+    if (count % 3 != 0)
+        return false;
+    for (size_t i = 0; i < count; i += 3)
+    {
+        const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c)
+            return false;
+    }
+    return true;
+}
+
+// Signed area in the xz plane (positive = facing +y like the input)
+static float SignedAreaXZ(const Grid& grid, uint32_t a, uint32_t b, uint32_t c)
+{
+    const float* pa = &grid.positions[a * 3];
+    const float* pb = &grid.positions[b * 3];
+    const float* pc = &grid.positions[c * 3];
+    const float abx = pb[0] - pa[0], abz = pb[2] - pa[2];
+    const float acx = pc[0] - pa[0], acz = pc[2] - pa[2];
+    return 0.5f * (abz * acx - abx * acz);
+}
+
+static void TestTargetCount()
+{
+    const Grid grid = CreateFlatGrid(32);
+    const size_t target = 200 * 3;
+
+    std::vector<uint32_t> result(grid.indices.size());
+    float error = -1.0f;
+    const size_t count = MeshSimplifier::Simplify(result.data(), grid.indices.data(), grid.indices.size(),
+        grid.positions.data(), grid.vertexCount, 3 * sizeof(float), target, 0.01f, &error);
+
+    // A flat grid reduces to the target without error
+    CHECK(count > 0);
+    CHECK(count <= target);
+    CHECK(ValidTriangles(result, count, grid.vertexCount));
+    CHECK(error >= 0.0f && error < 1e-4f);
+
+    // In place gives the same result
+    std::vector<uint32_t> inPlace = grid.indices;
+    const size_t inPlaceCount = MeshSimplifier::Simplify(inPlace.data(), inPlace.data(), inPlace.size(),
+        grid.positions.data(), grid.vertexCount, 3 * sizeof(float), target, 0.01f);
+    CHECK(inPlaceCount == count);
+    CHECK(std::equal(result.begin(), result.begin() + count, inPlace.begin()));
+
+    // Target above the input: nothing to do
+    std::vector<uint32_t> unchanged(grid.indices.size());
+    CHECK(MeshSimplifier::Simplify(unchanged.data(), grid.indices.data(), grid.indices.size(),
+        grid.positions.data(), grid.vertexCount, 3 * sizeof(float), grid.indices.size() * 2, 0.01f) == grid.indices.size());
+}
+
+static void TestErrorBound()
+{
+    // Bumpy height field, extent 32: 1% error = 0.32 units
+    const Grid grid = CreateGrid(32, [](float x, float z) { return 2.0f * std::sin(x * 0.4f) * std::cos(z * 0.3f); });
+
+    size_t previous = 0;
+    float previousError = 0.0f;
+    const float bounds[] = { 0.002f, 0.01f, 0.05f };
+    for (float bound : bounds)
+    {
+        std::vector<uint32_t> result(grid.indices.size());
+        float error = -1.0f;
+        const size_t count = MeshSimplifier::Simplify(result.data(), grid.indices.data(), grid.indices.size(),
+            grid.positions.data(), grid.vertexCount, 3 * sizeof(float), 0, bound, &error);
+
+        // Stops at the error bound, long before the target of 0
+        CHECK(count > 0);
+        CHECK(count < grid.indices.size());
+        CHECK(error <= bound);
+        CHECK(ValidTriangles(result, count, grid.vertexCount));
+
+        // A looser bound never keeps more triangles
+        if (previous > 0)
+        {
+            CHECK(count <= previous);
+            CHECK(error >= previousError);
+        }
+        previous = count;
+        previousError = error;
+    }
+}
+
+static void TestBorder()
+{
+    const uint32_t side = 16;
+    const Grid grid = CreateFlatGrid(side);
+
+    std::vector<uint32_t> result(grid.indices.size());
+    const size_t count = MeshSimplifier::Simplify(result.data(), grid.indices.data(), grid.indices.size(),
+        grid.positions.data(), grid.vertexCount, 3 * sizeof(float), 0, 0.01f);
+    CHECK(count < grid.indices.size() / 4);
+
+    // Same covered area and no flipped triangle: the outline is intact
+    float area = 0.0f;
+    bool flipped = false;
+    for (size_t i = 0; i < count; i += 3)
+    {
+        const float a = SignedAreaXZ(grid, result[i], result[i + 1], result[i + 2]);
+        flipped = flipped || a <= 0.0f;
+        area += a;
+    }
+    CHECK(!flipped);
+    CHECK(std::fabs(area - static_cast<float>(side * side)) < 1e-3f);
+
+    // The four corners are still there
+    const uint32_t row = side + 1;
+    const uint32_t corners[4] = { 0, side, side * row, side * row + side };
+    for (uint32_t corner : corners)
+        CHECK(std::find(result.begin(), result.begin() + count, corner) != result.begin() + count);
+}
+
+static void TestSeam()
+{
+    // Flat grid split at x = 8: the right half uses its own copies of the
+    // seam vertices (same position, different UV in a real mesh)
+    const uint32_t side = 16, seam = 8, row = side + 1;
+    Grid grid = CreateFlatGrid(side);
+
+    std::vector<uint32_t> copies(row);
+    for (uint32_t z = 0; z < row; ++z)
+    {
+        copies[z] = static_cast<uint32_t>(grid.vertexCount);
+        AddVertex(grid, static_cast<float>(seam), 0.0f, static_cast<float>(z));
+    }
+
+    auto isSeam = [&](uint32_t v) { return v < row * row && v % row == seam; };
+    for (size_t i = 0; i < grid.indices.size(); i += 3)
+    {
+        // Triangles right of the seam switch to the copies
+        bool right = false;
+        for (int k = 0; k < 3; ++k)
+            right = right || (grid.indices[i + k] < row * row && grid.indices[i + k] % row > seam);
+        if (!right)
+            continue;
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t& v = grid.indices[i + k];
+            if (isSeam(v))
+                v = copies[v / row];
+        }
+    }
+
+    std::vector<uint32_t> result(grid.indices.size());
+    const size_t count = MeshSimplifier::Simplify(result.data(), grid.indices.data(), grid.indices.size(),
+        grid.positions.data(), grid.vertexCount, 3 * sizeof(float), 0, 0.01f);
+    CHECK(count < grid.indices.size());
+    CHECK(ValidTriangles(result, count, grid.vertexCount));
+
+    // No triangle mixes both sides, and every seam vertex of both sides survives
+    bool mixed = false;
+    for (size_t i = 0; i < count; i += 3)
+    {
+        bool left = false, right = false;
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = result[i + k];
+            const bool copy = v >= row * row;
+            left = left || (!copy && v % row < seam);
+            right = right || copy || (v % row > seam);
+        }
+        mixed = mixed || (left && right);
+    }
+    CHECK(!mixed);
+
+    bool seamKept = true;
+    for (uint32_t z = 0; z < row; ++z)
+    {
+        seamKept = seamKept &&
+            std::find(result.begin(), result.begin() + count, z * row + seam) != result.begin() + count &&
+            std::find(result.begin(), result.begin() + count, copies[z]) != result.begin() + count;
+    }
+    CHECK(seamKept);
+}
+
+static void TestDegenerate()
+{
+    const float positions[9] = { 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    uint32_t out[6] = {};
+
+    // Nothing to simplify
+    CHECK(MeshSimplifier::Simplify(out, nullptr, 0, positions, 3, 3 * sizeof(float), 0) == 0);
+
+    // A single triangle cannot collapse without vanishing
+    const uint32_t single[3] = { 0, 1, 2 };
+    const size_t count = MeshSimplifier::Simplify(out, single, 3, positions, 3, 3 * sizeof(float), 0, 1.0f);
+    CHECK(count == 0 || count == 3);
+
+    // Zero-area triangles and repeated indices do not crash and never come out degenerate
+    const float line[9] = { 0, 0, 0, 1, 0, 0, 2, 0, 0 };
+    const uint32_t degenerate[6] = { 0, 1, 2, 0, 0, 1 };
+    std::vector<uint32_t> result(6);
+    const size_t degenerateCount = MeshSimplifier::Simplify(result.data(), degenerate, 6, line, 3, 3 * sizeof(float), 0, 0.01f);
+    CHECK(ValidTriangles(result, degenerateCount, 3));
+}
+
+int main()
+{
+    TestTargetCount();
+    TestErrorBound();
+    TestBorder();
+    TestSeam();
+    TestDegenerate();
+    return Test::Result("MeshSimplifierTest");
+}
@@ -0,0 +1,154 @@
+// NullDeviceTest.cpp
+//
+// Null device backend without Windows: command log counting, buffer
+// contents, Map/Unmap validation and concurrent recording.
+
+#include "gdxnulldevice.h"
+#include "TestCheck.h"
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static void TestCommandLog()
+{
+    GDXCommandLog log;
+    int shader = 0;
+
+    log.Record(GDXCommandType::VSSetShader, 0, 1, &shader);
+    log.Record(GDXCommandType::DrawIndexed, 0, 36, nullptr);
+    log.Record(GDXCommandType::DrawIndexed, 36, 36, nullptr);
+
+    CHECK(log.GetTotalCount() == 3);
+    CHECK(log.GetCount(GDXCommandType::DrawIndexed) == 2);
+    CHECK(log.GetCount(GDXCommandType::Draw) == 0);
+
+    const std::vector<GDXCommand>& commands = log.GetCommands();
+    CHECK(commands.size() == 3);
+    CHECK(commands[0].type == GDXCommandType::VSSetShader && commands[0].object == &shader);
+    CHECK(commands[2].slot == 36 && commands[2].count == 36);
+
+    // Counting only: totals keep running, the command list stays empty
+    log.Reset();
+    log.SetKeepCommands(false);
+    log.Record(GDXCommandType::Draw, 0, 3, nullptr);
+    CHECK(log.GetTotalCount() == 1);
+    CHECK(log.GetCount(GDXCommandType::Draw) == 1);
+    CHECK(log.GetCommands().empty());
+
+    CHECK(std::strcmp(GDXCommandLog::GetCommandName(GDXCommandType::DrawIndexedInstanced), "DrawIndexedInstanced") == 0);
+}
+
+static void TestBuffers()
+{
+    GDXNullDevice device;
+
+    const uint32_t init[4] = { 1, 2, 3, 4 };
+    GDXNullBuffer buffer(sizeof(init), init);
+    GDXNullBuffer empty(64, nullptr);
+
+    CHECK(buffer.GetByteWidth() == sizeof(init));
+    CHECK(std::memcmp(buffer.GetData(), init, sizeof(init)) == 0);
+    CHECK(empty.GetData()[0] == 0 && empty.GetData()[63] == 0);
+
+    // Map hands out the buffer memory, the log records the caller's handle
+    int handle = 0;
+    void* data = device.Map(&buffer, &handle);
+    CHECK(data == buffer.GetData());
+    CHECK(buffer.IsMapped());
+    static_cast<uint32_t*>(data)[0] = 42;
+    device.Unmap(&buffer, &handle);
+    CHECK(!buffer.IsMapped());
+    CHECK(reinterpret_cast<const uint32_t*>(buffer.GetData())[0] == 42);
+
+    const std::vector<GDXCommand>& commands = device.GetCommandLog().GetCommands();
+    CHECK(commands.size() == 2);
+    CHECK(commands[0].type == GDXCommandType::Map && commands[0].object == &handle && commands[0].count == sizeof(init));
+    CHECK(commands[1].type == GDXCommandType::Unmap && commands[1].object == &handle);
+
+    const uint32_t update[4] = { 9, 8, 7, 6 };
+    device.UpdateSubresource(&buffer, update);
+    CHECK(std::memcmp(buffer.GetData(), update, sizeof(update)) == 0);
+    CHECK(device.GetCommandLog().GetCount(GDXCommandType::UpdateSubresource) == 1);
+    CHECK(device.GetCommandLog().GetCommands().back().object == &buffer);
+    CHECK(device.GetErrorCount() == 0);
+}
+
+static void TestValidation()
+{
+    GDXNullDevice device;
+    GDXNullBuffer buffer(16, nullptr);
+    const uint8_t data[16] = {};
+
+    device.Map(&buffer);
+    device.Map(&buffer);                        // already mapped
+    CHECK(device.GetErrorCount() == 1);
+    device.UpdateSubresource(&buffer, data);    // update while mapped
+    CHECK(device.GetErrorCount() == 2);
+    device.Unmap(&buffer);
+    device.Unmap(&buffer);                      // not mapped
+    CHECK(device.GetErrorCount() == 3);
+    CHECK(device.Map(nullptr) == nullptr);      // no buffer
+    device.UpdateSubresource(&buffer, nullptr); // no data
+    CHECK(device.GetErrorCount() == 5);
+
+    device.Reset();
+    CHECK(device.GetErrorCount() == 0);
+    CHECK(device.GetCommandLog().GetTotalCount() == 0);
+}
+
+// One context per thread: no shared state, no locking
+static void TestContextPerThread()
+{
+    const int THREADS = 4;
+    const int COMMANDS = 20000;
+
+    std::vector<std::unique_ptr<GDXNullDevice>> devices;
+    std::vector<std::unique_ptr<GDXNullBuffer>> buffers;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        devices.push_back(std::make_unique<GDXNullDevice>());
+        buffers.push_back(std::make_unique<GDXNullBuffer>(256, nullptr));
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&devices, &buffers, t]()
+            {
+                GDXNullDevice& device = *devices[t];
+                GDXNullBuffer& buffer = *buffers[t];
+                for (int i = 0; i < COMMANDS; ++i)
+                {
+                    uint8_t* data = static_cast<uint8_t*>(device.Map(&buffer));
+                    data[i % 256] = static_cast<uint8_t>(t);
+                    device.Unmap(&buffer);
+                    device.Record(GDXCommandType::DrawIndexed, 0, 36, nullptr);
+                }
+            });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (int t = 0; t < THREADS; ++t)
+    {
+        const GDXCommandLog& log = devices[t]->GetCommandLog();
+        const size_t expected = size_t(COMMANDS);
+        CHECK(log.GetCount(GDXCommandType::Map) == expected);
+        CHECK(log.GetCount(GDXCommandType::Unmap) == expected);
+        CHECK(log.GetCount(GDXCommandType::DrawIndexed) == expected);
+        CHECK(log.GetTotalCount() == expected * 3);
+        CHECK(log.GetCommands().size() == expected * 3);
+        CHECK(devices[t]->GetErrorCount() == 0);
+    }
+}
+
+int main()
+{
+    TestCommandLog();
+    TestBuffers();
+    TestValidation();
+    TestContextPerThread();
+    return Test::Result("NullDeviceTest");
+}
@@ -0,0 +1,124 @@
+// Bounds and raycasts follow vertices moved after FillBuffer, through
+// AddVertex (per vertex, lazy bounds) and Surface::SetPositions (whole array).
+// Runs the engine on the null backend (Engine::CreateHeadlessEngine).
+
+#include "gidx.h"
+#include "TestCheck.h"
+
+#include <cmath>
+
+static bool Near(float a, float b)
+{
+    return std::fabs(a - b) < 1e-4f;
+}
+
+// Quad on z = 0 around the origin, half size 1, dynamic vertex buffer
+static LPSURFACE CreateQuad(LPENTITY* mesh, LPMATERIAL material)
+{
+    Engine::CreateMesh(mesh, material);
+
+    LPSURFACE surface = nullptr;
+    Engine::CreateSurface(&surface, *mesh);
+    Engine::SetSurfaceDynamic(surface);
+
+    Engine::AddVertex(surface, -1.0f, -1.0f, 0.0f);
+    Engine::AddVertex(surface, -1.0f, +1.0f, 0.0f);
+    Engine::AddVertex(surface, +1.0f, +1.0f, 0.0f);
+    Engine::AddVertex(surface, +1.0f, -1.0f, 0.0f);
+    Engine::AddTriangle(surface, 0, 1, 2);
+    Engine::AddTriangle(surface, 0, 2, 3);
+    Engine::FillBuffer(surface);
+    return surface;
+}
+
+// Ray along +z through (x, y)
+static LPENTITY Shoot(float x, float y, RaycastHit* hit = nullptr)
+{
+    return Engine::RaycastEntity(DirectX::XMFLOAT3(x, y, -10.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), FLT_MAX, hit);
+}
+
+static void TestInitial(LPENTITY mesh)
+{
+    Engine::UpdateWorld();
+
+    const Mesh* m = static_cast<const Mesh*>(mesh);
+    CHECK(Near(m->aabb.Center.x, 0.0f) && Near(m->aabb.Center.y, 0.0f));
+    CHECK(Near(m->aabb.Extents.x, 1.0f) && Near(m->aabb.Extents.y, 1.0f));
+
+    RaycastHit hit;
+    CHECK(Shoot(0.0f, 0.0f, &hit) == mesh);
+    CHECK(Near(hit.distance, 10.0f));
+    CHECK(Shoot(3.0f, 0.0f) == nullptr);
+}
+
+static void TestAddVertex(LPENTITY mesh, LPSURFACE surface)
+{
+    // Move the quad by +3 on x, vertex by vertex
+    const uint32_t revision = surface->GetBoundsRevision();
+    for (int i = 0; i < 4; ++i)
+    {
+        DirectX::XMFLOAT3 p(surface->GetVertexX(i) + 3.0f, surface->GetVertexY(i), surface->GetVertexZ(i));
+        Engine::AddVertex(i, surface, p);
+    }
+    CHECK(surface->GetBoundsRevision() != revision);
+    CHECK(surface->GetCachedTriangleBVH() == nullptr);  // the old BVH is not handed out
+
+    Engine::UpdateWorld();
+
+    const Mesh* m = static_cast<const Mesh*>(mesh);
+    CHECK(Near(m->aabb.Center.x, 3.0f) && Near(m->aabb.Extents.x, 1.0f));
+
+    RaycastHit hit;
+    CHECK(Shoot(3.0f, 0.0f, &hit) == mesh);
+    CHECK(Near(hit.point.x, 3.0f) && Near(hit.normal.z, -1.0f));
+    CHECK(Shoot(0.0f, 0.0f) == nullptr);
+}
+
+static void TestSetPositions(LPENTITY mesh, LPSURFACE surface)
+{
+    // Shorter array: one triangle at y = 5, z = 2
+    const DirectX::XMFLOAT3 triangle[3] = { { -1.0f, 4.0f, 2.0f }, { 0.0f, 6.0f, 2.0f }, { 1.0f, 4.0f, 2.0f } };
+    const unsigned int indices[3] = { 0, 1, 2 };
+    surface->SetPositions(triangle, 3);
+    surface->SetIndices(indices, 3);
+
+    Engine::UpdateWorld();
+
+    const Mesh* m = static_cast<const Mesh*>(mesh);
+    CHECK(Near(m->aabb.Center.x, 0.0f) && Near(m->aabb.Center.y, 5.0f) && Near(m->aabb.Center.z, 2.0f));
+
+    RaycastHit hit;
+    CHECK(Shoot(0.0f, 5.0f, &hit) == mesh);
+    CHECK(Near(hit.distance, 12.0f) && hit.triangle == 0);
+    CHECK(Shoot(3.0f, 0.0f) == nullptr);
+}
+
+int main()
+{
+    if (Engine::CreateHeadlessEngine(640, 480) != 0)
+    {
+        printf("CreateHeadlessEngine failed\n");
+        return 1;
+    }
+    Engine::Graphics(640, 480);
+
+    LPENTITY camera = nullptr;
+    Engine::CreateCamera(&camera);
+
+    LPMATERIAL material = nullptr;
+    Engine::CreateMaterial(&material);
+
+    LPENTITY mesh = nullptr;
+    LPSURFACE surface = CreateQuad(&mesh, material);
+    CHECK(mesh != nullptr && surface != nullptr);
+
+    if (mesh && surface)
+    {
+        TestInitial(mesh);
+        TestAddVertex(mesh, surface);
+        TestSetPositions(mesh, surface);
+    }
+
+    Engine::ReleaseEngine();
+    return Test::Result("SurfaceBoundsTest");
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the test programs (no test framework).
+// CHECK records a failure and keeps going, so one run reports every
+// broken expectation; main returns Test::Result().
+
+namespace Test
+{
+    inline int s_failures = 0;
+
+    inline void Check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (condition)
+            return;
+        ++s_failures;
+        printf("FAILED: %s (%s:%d)\n", expression, file, line);
+    }
+
+    inline int Result(const char* name)
+    {
+        if (s_failures > 0)
+        {
+            printf("%s: %d check(s) failed\n", name, s_failures);
+            return 1;
+        }
+        printf("%s: all checks passed\n", name);
+        return 0;
+    }
+}
+
+#define CHECK(condition) Test::Check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,292 @@
+// TextureCacheTest.cpp
+//
+// Encoded textures on disk: XXH64 reference values, keys over content and
+// settings, format choice, miss -> store -> mapped hit with identical
+// bytes, hits for copied files, rejected (corrupt) entries, no cache
+// directory, unreadable sources and parallel loads of the same file.
+
+#include "TextureCache.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const fs::path ROOT = "TextureCacheTest.data";
+
+// Uncompressed 32-bit TGA (BGRA, top-left origin), decoded by stb_image
+static bool WriteTga(const fs::path& path, uint32_t width, uint32_t height, uint8_t alpha)
+{
+    uint8_t header[18] = {};
+    header[2] = 2;
+    header[12] = static_cast<uint8_t>(width);
+    header[13] = static_cast<uint8_t>(width >> 8);
+    header[14] = static_cast<uint8_t>(height);
+    header[15] = static_cast<uint8_t>(height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;
+
+    std::vector<uint8_t> pixels(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* p = &pixels[(size_t(y) * width + x) * 4];
+            p[0] = static_cast<uint8_t>(x * 7);
+            p[1] = static_cast<uint8_t>(y * 5);
+            p[2] = static_cast<uint8_t>((x ^ y) * 3);
+            p[3] = alpha;
+        }
+    }
+
+    FILE* file = std::fopen(path.string().c_str(), "wb");
+    if (!file)
+        return false;
+    const bool written = std::fwrite(header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(pixels.data(), 1, pixels.size(), file) == pixels.size();
+    return std::fclose(file) == 0 && written;
+}
+
+static bool SameLevels(const CookedTexture& a, const CookedTexture& b)
+{
+    if (a.format != b.format || a.width != b.width || a.height != b.height || a.levels.size() != b.levels.size())
+        return false;
+    for (size_t i = 0; i < a.levels.size(); ++i) {
+        if (a.levels[i].size != b.levels[i].size || a.levels[i].rowPitch != b.levels[i].rowPitch ||
+            std::memcmp(a.GetLevel(i), b.GetLevel(i), a.levels[i].size) != 0)
+            return false;
+    }
+    return true;
+}
+
+static size_t CountFiles(const fs::path& directory, const char* extension)
+{
+    size_t count = 0;
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, ec))
+        count += entry.path().extension() == extension;
+    return count;
+}
+
+static void TestHash()
+{
+    // Reference values of XXH64
+    CHECK(TextureCache::Hash("", 0) == 0xEF46DB3751D8E999ull);
+    CHECK(TextureCache::Hash("abc", 3) == 0x44BC2CF5AD770999ull);
+
+    // Long input (32-byte stripes) and the seed change the result
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i * 31);
+    CHECK(TextureCache::Hash(data.data(), data.size()) == TextureCache::Hash(data.data(), data.size()));
+    CHECK(TextureCache::Hash(data.data(), data.size()) != TextureCache::Hash(data.data(), data.size(), 1));
+    CHECK(TextureCache::Hash(data.data(), data.size()) != TextureCache::Hash(data.data(), data.size() - 1));
+}
+
+static void TestKey()
+{
+    const uint8_t source[] = { 1, 2, 3, 4, 5 };
+    const MipGenerator::Options options;
+    const uint64_t key = TextureCache::MakeKey(source, sizeof(source), TextureCompression::BC3, options);
+    CHECK(key == TextureCache::MakeKey(source, sizeof(source), TextureCompression::BC3, options));
+    CHECK(key != TextureCache::MakeKey(source, sizeof(source), TextureCompression::BC7, options));
+
+    MipGenerator::Options other = options;
+    other.srgb = !other.srgb;
+    CHECK(key != TextureCache::MakeKey(source, sizeof(source), TextureCompression::BC3, other));
+    other = options;
+    other.alphaCutoff = 0.25f;
+    CHECK(key != TextureCache::MakeKey(source, sizeof(source), TextureCompression::BC3, other));
+
+    const uint8_t changed[] = { 1, 2, 3, 4, 6 };
+    CHECK(key != TextureCache::MakeKey(changed, sizeof(changed), TextureCompression::BC3, options));
+}
+
+static void TestChooseFormat()
+{
+    std::vector<uint8_t> opaque(8 * 8 * 4, 255);
+    std::vector<uint8_t> transparent = opaque;
+    transparent[3] = 0;
+
+    CHECK(TextureCache::ChooseFormat(TextureCompression::None, opaque.data(), 8, 8) == TextureFormat::RGBA8);
+    CHECK(TextureCache::ChooseFormat(TextureCompression::Auto, opaque.data(), 8, 8) == TextureFormat::BC1);
+    CHECK(TextureCache::ChooseFormat(TextureCompression::Auto, transparent.data(), 8, 8) == TextureFormat::BC3);
+    CHECK(TextureCache::ChooseFormat(TextureCompression::BC7, opaque.data(), 8, 8) == TextureFormat::BC7);
+
+    // Level 0 must be a multiple of 4 for BC formats
+    CHECK(TextureCache::ChooseFormat(TextureCompression::BC1, opaque.data(), 6, 8) == TextureFormat::RGBA8);
+    CHECK(TextureCache::ChooseFormat(TextureCompression::BC7, opaque.data(), 8, 2) == TextureFormat::RGBA8);
+}
+
+static void TestLoad()
+{
+    const fs::path cacheDir = ROOT / "cache";
+    const fs::path image = ROOT / "image.tga";
+    CHECK(WriteTga(image, 32, 16, 255));
+
+    const MipGenerator::Options options;
+    TextureCache cache;
+    cache.SetDirectory(cacheDir.string());
+
+    // Miss: encoded and stored
+    CookedTexture first;
+    std::string error;
+    CHECK(cache.Load(image.string().c_str(), TextureCompression::Auto, options, first, nullptr, &error));
+    CHECK(error.empty());
+    CHECK(!first.IsMapped());
+    CHECK(first.format == TextureFormat::BC1);
+    CHECK(first.width == 32 && first.height == 16);
+    CHECK(first.levels.size() == MipGenerator::CountLevels(32, 16));
+    CHECK(cache.GetStats().misses == 1 && cache.GetStats().stored == 1);
+    CHECK(CountFiles(cacheDir, ".gdxt") == 1);
+
+    // Hit from a new cache object: mapped, same bytes
+    TextureCache reopened;
+    reopened.SetDirectory(cacheDir.string());
+    CookedTexture hit;
+    CHECK(reopened.Load(image.string().c_str(), TextureCompression::Auto, options, hit));
+    CHECK(hit.IsMapped());
+    CHECK(SameLevels(first, hit));
+    CHECK(reopened.GetStats().hits == 1 && reopened.GetStats().misses == 0);
+
+    // A copy under another name hits the same entry
+    const fs::path copy = ROOT / "copy of image.tga";
+    fs::copy_file(image, copy, fs::copy_options::overwrite_existing);
+    CookedTexture copied;
+    CHECK(reopened.Load(copy.string().c_str(), TextureCompression::Auto, options, copied));
+    CHECK(copied.IsMapped() && SameLevels(first, copied));
+    CHECK(CountFiles(cacheDir, ".gdxt") == 1);
+
+    // Other settings: a second entry
+    CookedTexture bc7;
+    CHECK(reopened.Load(image.string().c_str(), TextureCompression::BC7, options, bc7));
+    CHECK(!bc7.IsMapped() && bc7.format == TextureFormat::BC7);
+    CHECK(CountFiles(cacheDir, ".gdxt") == 2);
+    bc7.Reset();
+
+    // Corrupt entry: rejected, encoded again and overwritten
+    const uint64_t key = [&]() {
+        FILE* file = std::fopen(image.string().c_str(), "rb");
+        std::vector<uint8_t> bytes(static_cast<size_t>(fs::file_size(image)));
+        const bool read = file && std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if (file)
+            std::fclose(file);
+        return read ? TextureCache::MakeKey(bytes.data(), bytes.size(), TextureCompression::Auto, options) : 0;
+    }();
+    hit.Reset();
+    copied.Reset();
+    const fs::path entry = reopened.GetPath(key);
+    CHECK(fs::exists(entry));
+    fs::resize_file(entry, fs::file_size(entry) / 2);
+
+    TextureCache repaired;
+    repaired.SetDirectory(cacheDir.string());
+    CookedTexture again;
+    CHECK(repaired.Load(image.string().c_str(), TextureCompression::Auto, options, again));
+    CHECK(!again.IsMapped() && SameLevels(first, again));
+    CHECK(repaired.GetStats().rejected == 1 && repaired.GetStats().stored == 1);
+    again.Reset();
+    CHECK(repaired.Find(key, again) && SameLevels(first, again));
+    again.Reset();
+}
+
+static void TestSpecialCases()
+{
+    const MipGenerator::Options options;
+
+    // Size not a multiple of 4: RGBA8 with mips, alpha kept
+    const fs::path odd = ROOT / "odd.tga";
+    CHECK(WriteTga(odd, 6, 10, 128));
+    TextureCache cache;
+    cache.SetDirectory((ROOT / "cache").string());
+    CookedTexture texture;
+    CHECK(cache.Load(odd.string().c_str(), TextureCompression::Auto, options, texture));
+    CHECK(texture.format == TextureFormat::RGBA8);
+    CHECK(texture.levels.size() == MipGenerator::CountLevels(6, 10));
+    CHECK(texture.levels[0].size == 6 * 10 * 4 && texture.GetLevel(0)[3] == 128);
+    texture.Reset();
+
+    // No directory: encoded every time, nothing stored
+    TextureCache memoryOnly;
+    CHECK(memoryOnly.Load(odd.string().c_str(), TextureCompression::Auto, options, texture));
+    CHECK(memoryOnly.GetStats().misses == 1 && memoryOnly.GetStats().stored == 0);
+    std::string storeError;
+    CHECK(!memoryOnly.Store(1, texture, &storeError) && !storeError.empty());
+    texture.Reset();
+
+    // Missing file and a file that is no image
+    std::string error;
+    CHECK(!cache.Load((ROOT / "missing.tga").string().c_str(), TextureCompression::Auto, options, texture, nullptr, &error));
+    CHECK(!error.empty());
+
+    const fs::path garbage = ROOT / "garbage.png";
+    FILE* file = std::fopen(garbage.string().c_str(), "wb");
+    CHECK(file != nullptr);
+    if (file) {
+        std::fputs("not an image", file);
+        std::fclose(file);
+    }
+    error.clear();
+    CHECK(!cache.Load(garbage.string().c_str(), TextureCompression::Auto, options, texture, nullptr, &error));
+    CHECK(!error.empty());
+}
+
+static void TestParallel()
+{
+    // Loader threads encoding the same file at once: every load succeeds, one valid
+    // entry remains and no temporary file is left behind
+    const fs::path cacheDir = ROOT / "parallel";
+    const fs::path image = ROOT / "parallel.tga";
+    CHECK(WriteTga(image, 64, 64, 255));
+
+    TextureCache cache;
+    cache.SetDirectory(cacheDir.string());
+    const MipGenerator::Options options;
+
+    const int THREADS = 4;
+    std::vector<CookedTexture> results(THREADS);
+    std::vector<int> ok(THREADS, 0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&, i]() {
+            ok[i] = cache.Load(image.string().c_str(), TextureCompression::BC3, options, results[i]) ? 1 : 0;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    bool allOk = true, same = true;
+    for (int i = 0; i < THREADS; ++i) {
+        allOk = allOk && ok[i] == 1;
+        same = same && SameLevels(results[0], results[i]);
+    }
+    CHECK(allOk);
+    CHECK(same);
+    CHECK(CountFiles(cacheDir, ".gdxt") == 1);
+    CHECK(CountFiles(cacheDir, ".tmp") == 0);
+
+    CookedTexture hit;
+    CHECK(cache.Load(image.string().c_str(), TextureCompression::BC3, options, hit));
+    CHECK(hit.IsMapped() && SameLevels(results[0], hit));
+}
+
+int main()
+{
+    std::error_code ec;
+    fs::remove_all(ROOT, ec);
+    fs::create_directories(ROOT, ec);
+
+    TestHash();
+    TestKey();
+    TestChooseFormat();
+    TestLoad();
+    TestSpecialCases();
+    TestParallel();
+
+    fs::remove_all(ROOT, ec);
+    return Test::Result("TextureCacheTest");
+}
@@ -0,0 +1,159 @@
+// TransformTest.cpp
+//
+// Transform handles in an engine-owned TransformSystem: copy and move,
+// the moved-from state (identity values, ignored setters), Combine /
+// Inverse and the per-frame rebuild of dirty world matrices.
+
+#include "Transform.h"
+#include "JobSystem.h"
+#include "TestCheck.h"
+
+#include <utility>
+#include <vector>
+
+using namespace DirectX;
+
+static bool Near(FXMVECTOR a, FXMVECTOR b, float epsilon = 1e-4f)
+{
+    return XMVector4NearEqual(a, b, XMVectorReplicate(epsilon));
+}
+
+static bool NearMatrix(const XMMATRIX& a, const XMMATRIX& b, float epsilon = 1e-4f)
+{
+    for (int row = 0; row < 4; ++row)
+    {
+        if (!Near(a.r[row], b.r[row], epsilon))
+            return false;
+    }
+    return true;
+}
+
+static void TestOwnership()
+{
+    TransformSystem systemA;
+    TransformSystem systemB;
+    {
+        Transform a(systemA);
+        Transform b(systemB);
+        CHECK(&a.GetSystem() == &systemA);
+        CHECK(&b.GetSystem() == &systemB);
+        CHECK(systemA.GetCount() == 1);
+        CHECK(systemB.GetCount() == 1);
+
+        // Copies allocate from the system of their source
+        Transform c(a);
+        CHECK(&c.GetSystem() == &systemA);
+        CHECK(systemA.GetCount() == 2);
+        CHECK(c.GetHandle() != a.GetHandle());
+
+        // Assignment across systems copies the values, not the handle
+        b.Position(1.0f, 2.0f, 3.0f);
+        a = b;
+        CHECK(&a.GetSystem() == &systemA);
+        CHECK(Near(a.GetPosition(), XMVectorSet(1.0f, 2.0f, 3.0f, 1.0f)));
+    }
+    CHECK(systemA.GetCount() == 0);
+    CHECK(systemB.GetCount() == 0);
+}
+
+static void TestMovedFrom()
+{
+    TransformSystem system;
+    Transform source(system);
+    source.Position(4.0f, 5.0f, 6.0f);
+    source.SetScale(2.0f);
+
+    Transform target(std::move(source));
+    CHECK(target.IsValid());
+    CHECK(Near(target.GetPosition(), XMVectorSet(4.0f, 5.0f, 6.0f, 1.0f)));
+    CHECK(system.GetCount() == 1);
+
+    // Accessors of the moved-from object stay in bounds and report identity
+    CHECK(!source.IsValid());
+    CHECK(Near(source.GetPosition(), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f)));
+    CHECK(Near(source.GetRotationQuaternion(), XMQuaternionIdentity()));
+    CHECK(Near(source.GetScaleVector(), XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f)));
+    CHECK(NearMatrix(source.GetWorldMatrix(), XMMatrixIdentity()));
+    CHECK(!source.HasChanged());
+
+    // Setters are ignored and must not touch the live entry
+    source.Position(9.0f, 9.0f, 9.0f);
+    source.SetScale(3.0f);
+    source.Rotate(10.0f, 20.0f, 30.0f);
+    CHECK(Near(source.GetPosition(), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f)));
+    CHECK(Near(target.GetPosition(), XMVectorSet(4.0f, 5.0f, 6.0f, 1.0f)));
+    CHECK(Near(target.GetScaleVector(), XMVectorSet(2.0f, 2.0f, 2.0f, 0.0f)));
+
+    // Assigning to a moved-from Transform gives it a new handle
+    source = target;
+    CHECK(source.IsValid());
+    CHECK(source.GetHandle() != target.GetHandle());
+    CHECK(Near(source.GetPosition(), target.GetPosition()));
+    CHECK(system.GetCount() == 2);
+}
+
+static void TestCombineInverse()
+{
+    TransformSystem system;
+    Transform parent(system);
+    parent.Position(1.0f, 0.0f, 0.0f);
+    parent.Rotate(0.0f, 90.0f, 0.0f);
+
+    Transform child(system);
+    child.Position(0.0f, 0.0f, 2.0f);
+
+    // parent.Combine(child): child expressed in the space of parent
+    const Transform combined = parent.Combine(child);
+    CHECK(&combined.GetSystem() == &system);
+    CHECK(NearMatrix(combined.GetLocalTransformationMatrix(),
+        child.GetLocalTransformationMatrix() * parent.GetLocalTransformationMatrix()));
+
+    const Transform inverse = parent.Inverse();
+    CHECK(NearMatrix(parent.GetLocalTransformationMatrix() * inverse.GetLocalTransformationMatrix(),
+        XMMatrixIdentity()));
+}
+
+static void TestWorldMatrices()
+{
+    TransformSystem system;
+    JobSystem jobs;
+    jobs.Init(2);
+
+    std::vector<Transform> transforms;
+    transforms.reserve(64);
+    for (int i = 0; i < 64; ++i)
+    {
+        transforms.emplace_back(system);
+        transforms.back().Position(static_cast<float>(i), 0.0f, 0.0f);
+    }
+
+    CHECK(system.GetDirtyCount() == 64);
+    system.UpdateWorldMatrices(&jobs);
+    CHECK(system.GetDirtyCount() == 0);
+
+    // The cache is current, GetWorldMatrix only reads it
+    bool cached = true;
+    for (int i = 0; i < 64; ++i)
+    {
+        const TransformSystem::Handle handle = transforms[i].GetHandle();
+        cached = cached && !system.IsDirty(handle) &&
+            NearMatrix(system.GetWorldMatrix(handle), XMMatrixTranslation(static_cast<float>(i), 0.0f, 0.0f));
+    }
+    CHECK(cached);
+
+    // Static scene: nothing dirty, version stays
+    const uint32_t version = system.GetVersion(transforms[5].GetHandle());
+    system.UpdateWorldMatrices(&jobs);
+    CHECK(system.GetVersion(transforms[5].GetHandle()) == version);
+
+    jobs.Shutdown();
+}
+
+int main()
+{
+    TestOwnership();
+    TestMovedFrom();
+    TestCombineInverse();
+    TestWorldMatrices();
+    return Test::Result("TransformTest");
+}
@@ -0,0 +1,154 @@
+// VertexQuantizationTest.cpp
+//
+// UNORM16 positions against the surface box: round trip through the
+// dequantize matrix, and normals on a non-cubic and a planar surface.
+// The shader math is replayed on the CPU: normals go through
+// NormalMatrix before the instance matrix (Dequantize * World) and must
+// come out as normal * World.
+
+#include "VertexQuantization.h"
+#include "TestCheck.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+static bool Near(FXMVECTOR a, FXMVECTOR b, float epsilon)
+{
+    return XMVector3NearEqual(a, b, XMVectorReplicate(epsilon));
+}
+
+static bool IsFinite(const XMMATRIX& m)
+{
+    XMFLOAT4X4 f;
+    XMStoreFloat4x4(&f, m);
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+            if (!std::isfinite(f.m[r][c]))
+                return false;
+    return true;
+}
+
+// What the vertex shader sees for vertex i: float4(q, 1) * Dequantize
+static XMVECTOR Dequantize(const std::vector<uint16_t>& quantized, size_t i, const XMMATRIX& dequantize)
+{
+    const XMVECTOR q = XMVectorSet(
+        quantized[i * 4 + 0] / 65535.0f,
+        quantized[i * 4 + 1] / 65535.0f,
+        quantized[i * 4 + 2] / 65535.0f, 1.0f);
+    return XMVector3TransformCoord(q, dequantize);
+}
+
+// VertexShaderInstanced.hlsl: normalize(n * (float3x3)_normalMatrix * (float3x3)instanceWorld)
+static XMVECTOR InstancedNormal(FXMVECTOR normal, const VertexPacking::Quantization& quantization, const XMMATRIX& world)
+{
+    const XMMATRIX instance = XMMatrixMultiply(VertexPacking::DequantizeMatrix(quantization), world);
+    const XMVECTOR corrected = XMVector3TransformNormal(normal, VertexPacking::NormalMatrix(quantization));
+    return XMVector3Normalize(XMVector3TransformNormal(corrected, instance));
+}
+
+static XMMATRIX TestWorld()
+{
+    return XMMatrixMultiply(XMMatrixRotationRollPitchYaw(0.3f, 1.1f, -0.4f), XMMatrixTranslation(10.0f, -2.0f, 5.0f));
+}
+
+static void TestNonCubic()
+{
+    // Long, flat box: extents 20 x 0.5 x 2
+    const std::vector<XMFLOAT3> positions = {
+        { -10.0f, 0.0f, -1.0f }, { 10.0f, 0.0f, -1.0f }, { 10.0f, 0.5f, 1.0f },
+        { -10.0f, 0.5f, 1.0f }, { 3.7f, 0.21f, -0.3f }, { -6.2f, 0.44f, 0.9f }
+    };
+
+    const VertexPacking::Quantization quantization =
+        VertexPacking::ComputeQuantization(positions.data(), positions.size());
+    CHECK(quantization.offset.x == -10.0f && quantization.offset.y == 0.0f && quantization.offset.z == -1.0f);
+    CHECK(quantization.scale.x == 20.0f && quantization.scale.y == 0.5f && quantization.scale.z == 2.0f);
+
+    std::vector<uint16_t> quantized;
+    VertexPacking::QuantizePositions(positions.data(), positions.size(), quantization, quantized);
+    CHECK(quantized.size() == positions.size() * 4);
+
+    // Round trip within half a step of the largest extent
+    const XMMATRIX dequantize = VertexPacking::DequantizeMatrix(quantization);
+    bool roundTrip = true;
+    for (size_t i = 0; i < positions.size(); ++i)
+        roundTrip = roundTrip && Near(Dequantize(quantized, i, dequantize), XMLoadFloat3(&positions[i]), 20.0f / 65535.0f);
+    CHECK(roundTrip);
+
+    // Slanted normals keep their direction in world space
+    const XMMATRIX world = TestWorld();
+    const XMVECTOR normals[] = {
+        XMVector3Normalize(XMVectorSet(1.0f, 1.0f, 0.0f, 0.0f)),
+        XMVector3Normalize(XMVectorSet(0.2f, -0.5f, 0.8f, 0.0f)),
+        XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f)
+    };
+    for (const XMVECTOR& n : normals)
+    {
+        const XMVECTOR expected = XMVector3Normalize(XMVector3TransformNormal(n, world));
+        CHECK(Near(InstancedNormal(n, quantization, world), expected, 1e-5f));
+    }
+
+    // Without the correction the box scale bends the normal (the bug this guards against)
+    const XMMATRIX instance = XMMatrixMultiply(dequantize, world);
+    const XMVECTOR bent = XMVector3Normalize(XMVector3TransformNormal(normals[0], instance));
+    CHECK(!Near(bent, XMVector3Normalize(XMVector3TransformNormal(normals[0], world)), 1e-2f));
+}
+
+static void TestPlanar()
+{
+    // Ground quad at y = 2: the y extent is 0
+    const std::vector<XMFLOAT3> positions = {
+        { -4.0f, 2.0f, -4.0f }, { 4.0f, 2.0f, -4.0f }, { 4.0f, 2.0f, 4.0f }, { -4.0f, 2.0f, 4.0f }
+    };
+
+    const VertexPacking::Quantization quantization =
+        VertexPacking::ComputeQuantization(positions.data(), positions.size());
+    CHECK(quantization.scale.y >= VertexPacking::MIN_EXTENT);
+
+    const XMMATRIX dequantize = VertexPacking::DequantizeMatrix(quantization);
+    CHECK(XMVectorGetX(XMMatrixDeterminant(dequantize)) != 0.0f);
+    CHECK(IsFinite(VertexPacking::NormalMatrix(quantization)));
+
+    std::vector<uint16_t> quantized;
+    VertexPacking::QuantizePositions(positions.data(), positions.size(), quantization, quantized);
+    bool flat = true;
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        flat = flat && quantized[i * 4 + 1] == 0 &&
+            Near(Dequantize(quantized, i, dequantize), XMLoadFloat3(&positions[i]), 8.0f / 65535.0f);
+    }
+    CHECK(flat);
+
+    const XMMATRIX world = TestWorld();
+    const XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+    const XMVECTOR normal = InstancedNormal(up, quantization, world);
+    CHECK(!XMVector3IsNaN(normal));
+    CHECK(Near(normal, XMVector3Normalize(XMVector3TransformNormal(up, world)), 1e-5f));
+
+    // Quantization from an older cooked file: a stored scale of 0 is clamped too
+    VertexPacking::Quantization stored = quantization;
+    stored.scale.y = 0.0f;
+    CHECK(IsFinite(VertexPacking::NormalMatrix(stored)));
+    CHECK(XMVectorGetX(XMMatrixDeterminant(VertexPacking::DequantizeMatrix(stored))) != 0.0f);
+}
+
+static void TestEmpty()
+{
+    const VertexPacking::Quantization quantization = VertexPacking::ComputeQuantization(nullptr, 0);
+    CHECK(quantization.scale.x == 1.0f && quantization.scale.y == 1.0f && quantization.scale.z == 1.0f);
+
+    std::vector<uint16_t> quantized(8, 1);
+    VertexPacking::QuantizePositions(nullptr, 0, quantization, quantized);
+    CHECK(quantized.empty());
+}
+
+int main()
+{
+    TestNonCubic();
+    TestPlanar();
+    TestEmpty();
+    return Test::Result("VertexQuantizationTest");
+}